@@ -0,0 +1,231 @@
+/******************************************************************************
+ * @file:        bench.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        19/10/2026 11:30 AM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the harness shared by the microbenchmarks:
+ *               command line parsing, the problem size sweep and the table or
+ *               JSON reporter.
+ *
+ *               Functions in this file:
+ *                 - bench_parse_args
+ *                 - bench_sizes
+ *                 - bench_fd_limit
+ *                 - bench_report_begin
+ *                 - bench_report
+ *                 - bench_report_end
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 19/10/2026 Marko Trickovic
+ * Initial version with timers, argument parsing and table/JSON reporting.
+ *
+ * Revision 0.2: 21/10/2026 Marko Trickovic
+ * Added bench_fd_limit.
+ *****************************************************************************/
+
+#ifndef BENCH_C
+#define BENCH_C
+
+#include "bench.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+/**
+ * @brief      Parses a count with an optional k/M/G suffix.
+ *
+ * @param[in]  str  String to parse.
+ * @param[out] val  Parsed value.
+ *
+ * @return     0 on success, -1 on malformed input.
+ */
+static int bench_parse_count(const char *str, uint64_t *val)
+{
+    char *end = NULL;
+    unsigned long long v = strtoull(str, &end, 10);
+
+    if (end == str)
+        return -1;
+
+    switch (*end) {
+    case 'k': case 'K': v *= 1000ull; end++; break;
+    case 'm': case 'M': v *= 1000000ull; end++; break;
+    case 'g': case 'G': v *= 1000000000ull; end++; break;
+    default: break;
+    }
+
+    if (*end)
+        return -1;
+
+    *val = v;
+    return 0;
+}
+
+/**
+ * @brief      Parses the common command line options.
+ *
+ * @param[in]  argc      Argument count from main().
+ * @param[in]  argv      Argument vector from main().
+ * @param[out] opts      Parsed options, preloaded with defaults.
+ * @param[in]  max_size  Default largest problem size of the suite.
+ *
+ * @return     0 on success, -1 after printing usage on bad input.
+ */
+int bench_parse_args(int argc, char **argv, bench_opts_t *opts,
+                     uint64_t max_size)
+{
+    uint64_t v = 0;
+    int i;
+
+    opts->json = 0;
+    opts->min_size = 10;
+    opts->max_size = max_size;
+    opts->min_ns = 200ull * 1000000ull;
+    opts->threads = 0;
+
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--json")) {
+            opts->json = 1;
+            continue;
+        }
+
+        if (i + 1 >= argc || bench_parse_count(argv[i + 1], &v) < 0)
+            goto usage;
+
+        if (!strcmp(argv[i], "--min-size"))
+            opts->min_size = v;
+        else if (!strcmp(argv[i], "--max-size"))
+            opts->max_size = v;
+        else if (!strcmp(argv[i], "--min-time-ms"))
+            opts->min_ns = v * 1000000ull;
+        else if (!strcmp(argv[i], "--threads"))
+            opts->threads = (unsigned int)v;
+        else
+            goto usage;
+        i++;
+    }
+
+    return 0;
+
+usage:
+    fprintf(stderr,
+            "usage: %s [--json] [--min-size N] [--max-size N]"
+            " [--min-time-ms N] [--threads N]\n", argv[0]);
+    return -1;
+}
+
+/**
+ * @brief      Produces the next problem size of a decade sweep.
+ *
+ * @param[in]  opts  Parsed options.
+ * @param[in,out] size  Previous size on entry, next size on exit.
+ *
+ * @return     1 while there is a next size, 0 when the sweep is done.
+ */
+int bench_sizes(const bench_opts_t *opts, uint64_t *size)
+{
+    uint64_t next = *size ? *size * 10 : 10;
+
+    while (next < opts->min_size)
+        next *= 10;
+
+    if (next > opts->max_size)
+        return 0;
+
+    *size = next;
+    return 1;
+}
+
+/**
+ * @brief      Raises the soft limit on open files to the hard one.
+ *
+ * @return     Files the process may have open, UINT64_MAX for no limit.
+ */
+uint64_t bench_fd_limit(void)
+{
+    struct rlimit rl;
+
+    if (getrlimit(RLIMIT_NOFILE, &rl) < 0)
+        return UINT64_MAX;
+
+    // Keeps the soft limit if the hard one cannot be taken
+    if (rl.rlim_cur < rl.rlim_max) {
+        rl.rlim_cur = rl.rlim_max;
+        if (setrlimit(RLIMIT_NOFILE, &rl) < 0)
+            getrlimit(RLIMIT_NOFILE, &rl);
+    }
+    return rl.rlim_cur == RLIM_INFINITY ? UINT64_MAX : (uint64_t)rl.rlim_cur;
+}
+
+/**
+ * @brief      Starts a report and prints its header.
+ *
+ * @param[out] rep    Report to initialise.
+ * @param[in]  opts   Parsed options.
+ * @param[in]  suite  Name of the benchmark suite.
+ */
+void bench_report_begin(bench_report_t *rep, const bench_opts_t *opts,
+                        const char *suite)
+{
+    rep->opts = opts;
+    rep->suite = suite;
+    rep->results = 0;
+
+    if (opts->json) {
+        printf("{\n  \"suite\": \"%s\",\n  \"results\": [", suite);
+        return;
+    }
+
+    printf("# %s\n", suite);
+    printf("%-32s %12s %14s %12s %12s\n",
+           "benchmark", "size", "ops", "ns/op", "cycles/op");
+}
+
+/**
+ * @brief      Prints one measurement.
+ *
+ * @param[in]  rep     Report to print into.
+ * @param[in]  name    Name of the measured operation.
+ * @param[in]  size    Problem size (list length, thread count, ...).
+ * @param[in]  ops     Number of operations that were measured.
+ * @param[in]  ns      Nanoseconds the operations took in total.
+ * @param[in]  cycles  Cycles the operations took in total.
+ */
+void bench_report(bench_report_t *rep, const char *name, uint64_t size,
+                  uint64_t ops, uint64_t ns, uint64_t cycles)
+{
+    double ns_op = ops ? (double)ns / (double)ops : 0.0;
+    double cyc_op = ops ? (double)cycles / (double)ops : 0.0;
+
+    if (rep->opts->json) {
+        printf("%s\n    {\"name\": \"%s\", \"size\": %llu, \"ops\": %llu, "
+               "\"ns_per_op\": %.3f, \"cycles_per_op\": %.3f}",
+               rep->results ? "," : "", name, (unsigned long long)size,
+               (unsigned long long)ops, ns_op, cyc_op);
+    } else {
+        printf("%-32s %12llu %14llu %12.3f %12.3f\n", name,
+               (unsigned long long)size, (unsigned long long)ops,
+               ns_op, cyc_op);
+    }
+
+    rep->results++;
+    fflush(stdout);
+}
+
+/**
+ * @brief      Finishes a report.
+ *
+ * @param[in]  rep  Report to finish.
+ */
+void bench_report_end(bench_report_t *rep)
+{
+    if (rep->opts->json)
+        printf("\n  ]\n}\n");
+}
+
+#endif    // BENCH_C
@@ -0,0 +1,192 @@
+/* -----------------------------------------------------------------------------
+ * @file:        bench.h
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        19/10/2026 11:30 AM
+ * @license:     MIT
+ * @description: This header file declares the small harness shared by the
+ *               microbenchmarks under bench/. It provides clocks, command line
+ *               handling and a reporter that prints either a table or one JSON
+ *               document per run. The contents are organized into three
+ *               groups:
+ *
+ *                 1. Structs:
+ *                    - struct bench_opts_t
+ *                    - struct bench_report_t
+ *
+ *                 2. Functions:
+ *                    - bench_parse_args
+ *                    - bench_report_begin
+ *                    - bench_report
+ *                    - bench_report_end
+ *                    - bench_sizes
+ *                    - bench_fd_limit
+ *
+ *                 3. Macros / inline helpers:
+ *                    - bench_now_ns
+ *                    - bench_cycles
+ *                    - BENCH_DO_NOT_OPTIMIZE
+ *
+ * @note:        This code is part of the tcpip-stack project, which is a course
+ *               on network development.
+ *
+ * Revision History:
+ *
+ * Revision 0.1: 19/10/2026 Marko Trickovic
+ * Initial version with timers, argument parsing and table/JSON reporting.
+ *
+ * Revision 0.2: 21/10/2026 Marko Trickovic
+ * Added bench_fd_limit for suites that open a descriptor per interface.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * @brief      Options shared by every benchmark executable.
+ *
+ * @struct                bench_opts_t
+ *
+ * @param[out] json       Print a JSON document instead of a table.
+ * @param[out] min_size   Smallest problem size to run.
+ * @param[out] max_size   Largest problem size to run.
+ * @param[out] min_ns     Minimum measured time per data point.
+ * @param[out] threads    Upper bound on threads for scaling benchmarks,
+ *                        0 means every online CPU.
+ */
+typedef struct bench_opts_ {
+    int json;
+    uint64_t min_size;
+    uint64_t max_size;
+    uint64_t min_ns;
+    unsigned int threads;
+} bench_opts_t;
+
+/**
+ * @brief      State of one benchmark report.
+ *
+ * @struct                bench_report_t
+ *
+ * @param[in]  opts       Options the run was started with.
+ * @param[in]  suite      Name of the benchmark suite.
+ * @param[in]  results    Number of results printed so far.
+ */
+typedef struct bench_report_ {
+    const bench_opts_t *opts;
+    const char *suite;
+    unsigned int results;
+} bench_report_t;
+
+/**
+ * @brief      Reads a monotonic clock.
+ *
+ * @return     Nanoseconds since an arbitrary point in the past.
+ */
+static inline uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief      Reads the time stamp counter.
+ *
+ * @return     TSC ticks on x86, nanoseconds elsewhere.
+ */
+static inline uint64_t bench_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return bench_now_ns();
+#endif
+}
+
+/**
+ * @brief      Keeps the compiler from discarding a computed value.
+ *
+ * @param[in]  val  Value that must be treated as used.
+ */
+#define BENCH_DO_NOT_OPTIMIZE(val)  __asm__ volatile("" : : "g"(val) : "memory")
+
+/**
+ * @brief      Parses the common command line options.
+ *
+ * @details    Recognised options are --json, --min-size N, --max-size N,
+ *             --min-time-ms N and --threads N. Sizes accept k/M suffixes.
+ *
+ * @param[in]  argc      Argument count from main().
+ * @param[in]  argv      Argument vector from main().
+ * @param[out] opts      Parsed options, preloaded with defaults.
+ * @param[in]  max_size  Default largest problem size of the suite.
+ *
+ * @return     0 on success, -1 after printing usage on bad input.
+ */
+int bench_parse_args(int argc, char **argv, bench_opts_t *opts,
+                     uint64_t max_size);
+
+/**
+ * @brief      Produces the next problem size of a decade sweep.
+ *
+ * @details    Sizes go 10, 100, 1000 ... clamped to the [min_size, max_size]
+ *             range of the options. Start with *size = 0.
+ *
+ * @param[in]  opts  Parsed options.
+ * @param[in,out] size  Previous size on entry, next size on exit.
+ *
+ * @return     1 while there is a next size, 0 when the sweep is done.
+ */
+int bench_sizes(const bench_opts_t *opts, uint64_t *size);
+
+/**
+ * @brief      Raises the soft limit on open files to the hard one.
+ *
+ * @details    Suites that open descriptors per node or interface call it
+ *             once and skip the sizes that would not fit, rather than fail
+ *             the run with EMFILE.
+ *
+ * @return     Files the process may have open, UINT64_MAX for no limit.
+ */
+uint64_t bench_fd_limit(void);
+
+/**
+ * @brief      Starts a report and prints its header.
+ *
+ * @param[out] rep    Report to initialise.
+ * @param[in]  opts   Parsed options.
+ * @param[in]  suite  Name of the benchmark suite.
+ */
+void bench_report_begin(bench_report_t *rep, const bench_opts_t *opts,
+                        const char *suite);
+
+/**
+ * @brief      Prints one measurement.
+ *
+ * @param[in]  rep     Report to print into.
+ * @param[in]  name    Name of the measured operation.
+ * @param[in]  size    Problem size (list length, thread count, ...).
+ * @param[in]  ops     Number of operations that were measured.
+ * @param[in]  ns      Nanoseconds the operations took in total.
+ * @param[in]  cycles  Cycles the operations took in total.
+ */
+void bench_report(bench_report_t *rep, const char *name, uint64_t size,
+                  uint64_t ops, uint64_t ns, uint64_t cycles);
+
+/**
+ * @brief      Finishes a report.
+ *
+ * @param[in]  rep  Report to finish.
+ */
+void bench_report_end(bench_report_t *rep);
+
+#endif    // BENCH_H
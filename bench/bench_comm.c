@@ -0,0 +1,207 @@
+/******************************************************************************
+ * @file:        bench_comm.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        21/10/2026 01:00 PM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the benchmark of the loopback UDP link
+ *               transport across the link of a two-node topology, for frames
+ *               of 64 bytes up to --max-size (default 1500) bytes; size is
+ *               the frame length and ops is frames received, so 1e9 / ns/op
+ *               is the packet rate:
+ *
+ *                 - stream:    R0 queues windows of BENCH_WINDOW frames
+ *                              with comm_enqueue and flushes them, the
+ *                              receive thread of R1 queues them and the main
+ *                              thread drains the queue of R1 after each
+ *                              window
+ *                 - pingpong:  one frame R0 to R1 and back, waiting for each;
+ *                              ns/op is the round trip
+ *
+ *               Each runs with COMM_SINGLE_IO (/single, one sendmsg or
+ *               recvmsg per frame) and with sendmmsg and recvmmsg (/mmsg).
+ *               The syscalls per frame, sends, receives and epoll_waits of
+ *               both nodes over frames received, go to stderr with Mpps.
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 21/10/2026 Marko Trickovic
+ * Initial version.
+ *
+ * Revision 0.2: 21/10/2026 Marko Trickovic
+ * Stream through comm_enqueue and comm_flush, single and mmsg variants and
+ * syscalls per frame.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "bench.h"
+#include "../src/comm/comm.h"
+#include "../src/graph/topologies.h"
+
+#define BENCH_WINDOW    256
+#define BENCH_BLKS      4096
+#define BENCH_BLK_SIZE  2048
+#define BENCH_HEADROOM  128
+#define BENCH_WAIT_MS   100
+
+typedef struct bench_ctx_ {
+    comm_t *comm;
+    pkt_pool_t *pool;
+    interface_t *tx;
+    interface_t *rx;
+    uint32_t len;
+    uint64_t lost;
+} bench_ctx_t;
+
+static int bench_send(bench_ctx_t *ctx, interface_t *intf)
+{
+    pkt_buf_t *pkt = pkt_buf_alloc(ctx->pool);
+
+    if (!pkt)
+        return -1;
+    memset(pkt_buf_put(pkt, ctx->len), 0x5a, ctx->len);
+    return comm_send(ctx->comm, intf, pkt);
+}
+
+// Sends one window and drains it, returns the frames received
+static uint64_t stream(bench_ctx_t *ctx)
+{
+    pkt_queue_t out;
+    uint32_t i, got = 0;
+
+    pkt_queue_init(&out, PKT_QUEUE_UNBOUNDED);
+    for (i = 0; i < BENCH_WINDOW; i++) {
+        pkt_buf_t *pkt = pkt_buf_alloc(ctx->pool);
+
+        if (!pkt)
+            break;
+        memset(pkt_buf_put(pkt, ctx->len), 0x5a, ctx->len);
+        if (comm_enqueue(ctx->comm, ctx->tx, pkt) < 0)
+            break;
+    }
+    comm_flush(ctx->comm, ctx->tx);
+    while (got < i && comm_recv_burst(ctx->comm, ctx->rx, &out, BENCH_WAIT_MS))
+        got = out.count;
+
+    ctx->lost += i - got;
+    pkt_queue_flush(&out);
+    return got;
+}
+
+// Bounces one frame across the link and back
+static uint64_t pingpong(bench_ctx_t *ctx)
+{
+    pkt_buf_t *pkt;
+
+    if (bench_send(ctx, ctx->tx) < 0)
+        return 0;
+    pkt = comm_recv(ctx->comm, ctx->rx, BENCH_WAIT_MS);
+    if (!pkt) {
+        ctx->lost++;
+        return 0;
+    }
+    if (comm_send(ctx->comm, ctx->rx, pkt) < 0)
+        return 0;
+    pkt = comm_recv(ctx->comm, ctx->tx, BENCH_WAIT_MS);
+    if (!pkt) {
+        ctx->lost++;
+        return 0;
+    }
+    pkt_buf_free(pkt);
+    return 1;
+}
+
+// Sends, receives and epoll_waits made so far by the whole transport
+static uint64_t syscalls(const comm_t *comm)
+{
+    uint64_t n = 0;
+    uint32_t i;
+
+    for (i = 0; i < comm->nintfs; i++)
+        n += __atomic_load_n(&comm->intfs[i].tx_syscalls, __ATOMIC_RELAXED) +
+             __atomic_load_n(&comm->intfs[i].rx_syscalls, __ATOMIC_RELAXED);
+    for (i = 0; i < comm->nnodes; i++)
+        n += __atomic_load_n(&comm->nodes[i].polls, __ATOMIC_RELAXED);
+    return n;
+}
+
+static void bench_run(bench_report_t *rep, bench_ctx_t *ctx, const char *name,
+                      uint64_t (*fn)(bench_ctx_t *ctx))
+{
+    uint64_t ns = 0, cycles = 0, ops = 0, t0, c0, sys0;
+
+    ctx->lost = 0;
+    sys0 = syscalls(ctx->comm);
+    do {
+        t0 = bench_now_ns();
+        c0 = bench_cycles();
+        ops += fn(ctx);
+        cycles += bench_cycles() - c0;
+        ns += bench_now_ns() - t0;
+    } while (ns < rep->opts->min_ns);
+
+    bench_report(rep, name, ctx->len, ops ? ops : 1, ns, cycles);
+    fprintf(stderr, "%s/%u: %.2f syscalls/frame, %.3f Mpps\n", name, ctx->len,
+            (double)(syscalls(ctx->comm) - sys0) / (ops ? ops : 1),
+            ns ? (double)ops * 1e3 / ns : 0.0);
+    if (ctx->lost)
+        fprintf(stderr, "%s/%u: %llu frames lost\n", name, ctx->len,
+                (unsigned long long)ctx->lost);
+}
+
+int main(int argc, char **argv)
+{
+    static const uint32_t lens[] = { 64, 512, 1500 };
+    static const struct {
+        const char *stream;
+        const char *pingpong;
+        uint32_t flags;
+    } modes[] = {
+        { "stream/single", "pingpong/single", COMM_SINGLE_IO },
+        { "stream/mmsg", "pingpong/mmsg", 0 },
+    };
+    bench_opts_t opts;
+    bench_report_t rep;
+    bench_ctx_t ctx;
+    graph_t *topo;
+    unsigned int i, m;
+
+    if (bench_parse_args(argc, argv, &opts, 1500) < 0)
+        return 1;
+
+    topo = build_line_topo(2);
+    ctx.pool = pkt_pool_create(BENCH_BLKS, BENCH_BLK_SIZE, BENCH_HEADROOM,
+                               PKT_POOL_MT);
+    if (!topo || !ctx.pool)
+        return 1;
+    ctx.tx = get_node_intf_by_name(get_node_by_node_name(topo, "R0"), "eth0");
+    ctx.rx = get_node_intf_by_name(get_node_by_node_name(topo, "R1"), "eth0");
+
+    bench_report_begin(&rep, &opts, "comm");
+
+    for (m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        ctx.comm = comm_create(topo, ctx.pool, 0, modes[m].flags);
+        if (!ctx.comm || comm_start(ctx.comm) < 0) {
+            perror("comm");
+            return 1;
+        }
+        for (i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) {
+            if (lens[i] < opts.min_size || lens[i] > opts.max_size)
+                continue;
+            ctx.len = lens[i];
+            bench_run(&rep, &ctx, modes[m].stream, stream);
+            bench_run(&rep, &ctx, modes[m].pingpong, pingpong);
+        }
+        comm_destroy(ctx.comm);
+    }
+
+    bench_report_end(&rep);
+
+    pkt_pool_destroy(ctx.pool);
+    destroy_graph(topo);
+    return 0;
+}
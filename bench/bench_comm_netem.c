@@ -0,0 +1,176 @@
+/******************************************************************************
+ * @file:        bench_comm_netem.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        21/10/2026 09:00 PM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the benchmark of link impairment
+ *               emulation on one direction of a two-node topology, on
+ *               virtual time. A round sends size frames of BENCH_LEN bytes,
+ *               10 up to --max-size (default 10k), one every BENCH_GAP_NS,
+ *               so all of them are held at once, then takes them out once
+ *               they are due; ops is frames sent:
+ *
+ *                 - netem/pass:     no impairment
+ *                 - netem/wan:      100 Mbit/s, 20 ms delay, 2 ms jitter,
+ *                                   0.1% random and Gilbert-Elliott burst
+ *                                   loss and 1% reordering
+ *                 - netem/reorder:  20 ms delay, 25% of frames reordered
+ *
+ *               Frames delivered, lost and reordered in the first round go
+ *               to stderr with a hash of its delivered order, identical
+ *               across runs with the same seed.
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 21/10/2026 Marko Trickovic
+ * Initial version.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "bench.h"
+#include "../src/comm/comm_netem.h"
+#include "../src/graph/topologies.h"
+
+#define BENCH_LEN       64
+#define BENCH_GAP_NS    1000
+#define BENCH_BLKS      16384
+#define BENCH_BLK_SIZE  256
+#define BENCH_HEADROOM  64
+#define BENCH_SEED      1
+
+typedef struct bench_ctx_ {
+    pkt_pool_t *pool;
+    graph_t *topo;
+    interface_t *tx;
+    uint64_t now;
+    int first;
+    uint64_t hash;
+} bench_ctx_t;
+
+// Sends size frames and takes them all out again
+static uint64_t round_trip(bench_ctx_t *ctx, comm_netem_t *nm, uint64_t size)
+{
+    pkt_queue_t out;
+    pkt_buf_t *pkt;
+    uint32_t seq;
+    uint64_t i;
+
+    pkt_queue_init(&out, PKT_QUEUE_UNBOUNDED);
+    for (i = 0; i < size; i++, ctx->now += BENCH_GAP_NS) {
+        pkt = pkt_buf_alloc(ctx->pool);
+        if (!pkt)
+            return i;
+        seq = (uint32_t)i;
+        memcpy(pkt_buf_put(pkt, BENCH_LEN), &seq, sizeof(seq));
+        comm_netem_enqueue(nm, ctx->tx, pkt, ctx->now);
+    }
+
+    ctx->now = comm_netem_next(nm, ctx->tx);
+    while (ctx->now != UINT64_MAX) {
+        comm_netem_dequeue(nm, ctx->tx, ctx->now, &out);
+        while ((pkt = pkt_queue_pop(&out))) {
+            memcpy(&seq, pkt->data, sizeof(seq));
+            if (ctx->first)
+                ctx->hash = (ctx->hash ^ seq) * 0x100000001b3ull;
+            pkt_buf_free(pkt);
+        }
+        ctx->now = comm_netem_next(nm, ctx->tx);
+    }
+    return size;
+}
+
+static int bench_run(bench_report_t *rep, bench_ctx_t *ctx, const char *name,
+                     const comm_netem_cfg_t *cfg, uint64_t size)
+{
+    uint64_t ns = 0, cycles = 0, ops = 0, t0, c0, clock = 0;
+    uint64_t delivered = 0, lost = 0, reordered = 0;
+    comm_netem_cfg_t sized = *cfg;
+    comm_netem_intf_t *ni;
+    comm_netem_t *nm;
+
+    nm = comm_netem_create(ctx->topo, BENCH_SEED);
+    sized.limit = (uint32_t)size;
+    if (!nm || comm_netem_set(nm, ctx->tx, &sized) < 0)
+        return -1;
+    ni = comm_netem_get_intf(nm, ctx->tx);
+
+    ctx->hash = 0xcbf29ce484222325ull;
+    ctx->first = 1;
+    do {
+        ctx->now = clock;
+        t0 = bench_now_ns();
+        c0 = bench_cycles();
+        ops += round_trip(ctx, nm, size);
+        cycles += bench_cycles() - c0;
+        ns += bench_now_ns() - t0;
+        // Next round starts once the link has drained
+        clock = ni->last_due > ni->busy_until ? ni->last_due : ni->busy_until;
+        clock += BENCH_GAP_NS;
+        if (ctx->first) {
+            delivered = ni->delivered;
+            lost = ni->lost + ni->ge_lost + ni->overlimit;
+            reordered = ni->reordered;
+            ctx->first = 0;
+        }
+    } while (ns < rep->opts->min_ns);
+
+    bench_report(rep, name, size, ops ? ops : 1, ns, cycles);
+    fprintf(stderr, "%s/%llu: %.2f%% delivered, %llu lost, %llu reordered, "
+            "order hash %016llx\n", name, (unsigned long long)size,
+            size ? 100.0 * delivered / size : 0.0,
+            (unsigned long long)lost, (unsigned long long)reordered,
+            (unsigned long long)ctx->hash);
+
+    comm_netem_destroy(nm);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    static const comm_netem_cfg_t pass = { 0 };
+    static const comm_netem_cfg_t wan = {
+        .rate_bps = 100000000, .delay_ns = 20000000, .jitter_ns = 2000000,
+        .loss = 0.001, .ge_p = 0.001, .ge_r = 0.25, .ge_bad = 0.5,
+        .reorder = 0.01,
+    };
+    static const comm_netem_cfg_t reorder = {
+        .delay_ns = 20000000, .reorder = 0.25,
+    };
+    bench_opts_t opts;
+    bench_report_t rep;
+    bench_ctx_t ctx;
+    uint64_t size = 0;
+    int rc = 0;
+
+    if (bench_parse_args(argc, argv, &opts, 10000) < 0)
+        return 1;
+
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.topo = build_line_topo(2);
+    ctx.pool = pkt_pool_create(BENCH_BLKS, BENCH_BLK_SIZE, BENCH_HEADROOM, 0);
+    if (!ctx.topo || !ctx.pool)
+        return 1;
+    ctx.tx = get_node_intf_by_name(get_node_by_node_name(ctx.topo, "R0"),
+                                   "eth0");
+
+    bench_report_begin(&rep, &opts, "comm_netem");
+
+    while (!rc && bench_sizes(&opts, &size)) {
+        if (size > BENCH_BLKS)
+            break;
+        rc |= bench_run(&rep, &ctx, "netem/pass", &pass, size);
+        rc |= bench_run(&rep, &ctx, "netem/wan", &wan, size);
+        rc |= bench_run(&rep, &ctx, "netem/reorder", &reorder, size);
+    }
+
+    bench_report_end(&rep);
+
+    pkt_pool_destroy(ctx.pool);
+    destroy_graph(ctx.topo);
+    return rc ? 1 : 0;
+}
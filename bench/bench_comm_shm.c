@@ -0,0 +1,213 @@
+/******************************************************************************
+ * @file:        bench_comm_shm.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        21/10/2026 07:00 PM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the benchmark of the shared-memory link
+ *               transport across the link of a two-node topology whose nodes
+ *               run in two processes: R1 is a forked child that sends every
+ *               frame back out of the interface it came in on. size is the
+ *               frame length, 64 bytes up to --max-size (default 1500), and
+ *               ops is frames back at R0:
+ *
+ *                 - stream:    R0 sends windows of BENCH_WINDOW frames in
+ *                              bursts of BENCH_BURST and takes the echoes
+ *                 - pingpong:  one frame R0 to R1 and back, waiting for each;
+ *                              ns/op is the round trip
+ *
+ *               The syscalls per frame, eventfd writes and blocking polls of
+ *               both nodes over frames back, go to stderr with Mpps.
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 21/10/2026 Marko Trickovic
+ * Initial version.
+ *****************************************************************************/
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "bench.h"
+#include "../src/comm/comm_shm.h"
+#include "../src/graph/topologies.h"
+
+#define BENCH_WINDOW    256
+#define BENCH_BURST     32
+#define BENCH_BLKS      4096
+#define BENCH_BLK_SIZE  2048
+#define BENCH_HEADROOM  128
+#define BENCH_WAIT_MS   1000
+
+typedef struct bench_ctx_ {
+    comm_shm_t *sh;
+    pkt_pool_t *pool;
+    interface_t *tx;
+    interface_t *rx;
+    comm_shm_node_t *tx_node;
+    comm_shm_node_t *rx_node;
+    uint32_t len;
+    uint64_t lost;
+} bench_ctx_t;
+
+// Body of the R1 process, returns when it has been idle for BENCH_WAIT_MS
+static void echo(bench_ctx_t *ctx)
+{
+    pkt_buf_t *pkts[BENCH_BURST];
+    uint32_t n;
+
+    while (comm_shm_wait(ctx->sh, ctx->rx_node, BENCH_WAIT_MS)) {
+        n = comm_shm_recv_burst(ctx->sh, ctx->rx, pkts, BENCH_BURST);
+        comm_shm_send_burst(ctx->sh, ctx->rx, pkts, n);
+        comm_shm_flush(ctx->sh, ctx->rx);
+    }
+}
+
+// Waits for frames back at R0 until got reaches want, returns got
+static uint32_t collect(bench_ctx_t *ctx, uint32_t got, uint32_t want)
+{
+    pkt_buf_t *pkts[BENCH_BURST];
+    uint32_t n;
+
+    while (got < want && comm_shm_wait(ctx->sh, ctx->tx_node, BENCH_WAIT_MS)) {
+        n = comm_shm_recv_burst(ctx->sh, ctx->tx, pkts, BENCH_BURST);
+        got += n;
+        while (n)
+            pkt_buf_free(pkts[--n]);
+    }
+    return got;
+}
+
+// Sends one window and takes it back, returns the frames received
+static uint64_t stream(bench_ctx_t *ctx)
+{
+    pkt_buf_t *pkts[BENCH_BURST];
+    uint32_t sent = 0, got = 0, n, i;
+
+    while (sent < BENCH_WINDOW) {
+        n = pkt_buf_alloc_bulk(ctx->pool, pkts, BENCH_BURST);
+        if (!n)
+            break;
+        for (i = 0; i < n; i++)
+            memset(pkt_buf_put(pkts[i], ctx->len), 0x5a, ctx->len);
+        comm_shm_send_burst(ctx->sh, ctx->tx, pkts, n);
+        sent += n;
+    }
+    comm_shm_flush(ctx->sh, ctx->tx);
+    got = collect(ctx, got, sent);
+
+    ctx->lost += sent - got;
+    return got;
+}
+
+// Bounces one frame across the link and back
+static uint64_t pingpong(bench_ctx_t *ctx)
+{
+    pkt_buf_t *pkt = pkt_buf_alloc(ctx->pool);
+
+    if (!pkt)
+        return 0;
+    memset(pkt_buf_put(pkt, ctx->len), 0x5a, ctx->len);
+    comm_shm_send(ctx->sh, ctx->tx, pkt);
+    if (!collect(ctx, 0, 1)) {
+        ctx->lost++;
+        return 0;
+    }
+    return 1;
+}
+
+// Eventfd writes and blocking polls made so far by both nodes
+static uint64_t syscalls(const bench_ctx_t *ctx)
+{
+    return __atomic_load_n(&ctx->tx_node->wakeups, __ATOMIC_RELAXED) +
+           __atomic_load_n(&ctx->tx_node->sleeps, __ATOMIC_RELAXED) +
+           __atomic_load_n(&ctx->rx_node->wakeups, __ATOMIC_RELAXED) +
+           __atomic_load_n(&ctx->rx_node->sleeps, __ATOMIC_RELAXED);
+}
+
+static void bench_run(bench_report_t *rep, bench_ctx_t *ctx, const char *name,
+                      uint64_t (*fn)(bench_ctx_t *ctx))
+{
+    uint64_t ns = 0, cycles = 0, ops = 0, t0, c0, sys0;
+
+    ctx->lost = 0;
+    sys0 = syscalls(ctx);
+    do {
+        t0 = bench_now_ns();
+        c0 = bench_cycles();
+        ops += fn(ctx);
+        cycles += bench_cycles() - c0;
+        ns += bench_now_ns() - t0;
+    } while (ns < rep->opts->min_ns);
+
+    bench_report(rep, name, ctx->len, ops ? ops : 1, ns, cycles);
+    fprintf(stderr, "%s/%u: %.3f syscalls/frame, %.3f Mpps\n", name, ctx->len,
+            (double)(syscalls(ctx) - sys0) / (ops ? ops : 1),
+            ns ? (double)ops * 1e3 / ns : 0.0);
+    if (ctx->lost)
+        fprintf(stderr, "%s/%u: %llu frames lost\n", name, ctx->len,
+                (unsigned long long)ctx->lost);
+}
+
+int main(int argc, char **argv)
+{
+    static const uint32_t lens[] = { 64, 512, 1500 };
+    bench_opts_t opts;
+    bench_report_t rep;
+    bench_ctx_t ctx;
+    graph_t *topo;
+    unsigned int i;
+    pid_t pid;
+
+    if (bench_parse_args(argc, argv, &opts, 1500) < 0)
+        return 1;
+
+    topo = build_line_topo(2);
+    ctx.pool = pkt_pool_create(BENCH_BLKS, BENCH_BLK_SIZE, BENCH_HEADROOM,
+                               PKT_POOL_SHARED);
+    if (!topo || !ctx.pool)
+        return 1;
+    ctx.sh = comm_shm_create(topo, ctx.pool, 0);
+    if (!ctx.sh) {
+        perror("comm_shm");
+        return 1;
+    }
+    ctx.tx = get_node_intf_by_name(get_node_by_node_name(topo, "R0"), "eth0");
+    ctx.rx = get_node_intf_by_name(get_node_by_node_name(topo, "R1"), "eth0");
+    ctx.tx_node = comm_shm_get_node(ctx.sh, ctx.tx->att_node);
+    ctx.rx_node = comm_shm_get_node(ctx.sh, ctx.rx->att_node);
+
+    pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        return 1;
+    }
+    if (!pid) {
+        echo(&ctx);
+        _exit(0);
+    }
+
+    bench_report_begin(&rep, &opts, "comm_shm");
+
+    for (i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) {
+        if (lens[i] < opts.min_size || lens[i] > opts.max_size)
+            continue;
+        ctx.len = lens[i];
+        bench_run(&rep, &ctx, "stream", stream);
+        bench_run(&rep, &ctx, "pingpong", pingpong);
+    }
+
+    bench_report_end(&rep);
+
+    kill(pid, SIGTERM);
+    waitpid(pid, NULL, 0);
+    comm_shm_destroy(ctx.sh);
+    pkt_pool_destroy(ctx.pool);
+    destroy_graph(topo);
+    return 0;
+}
@@ -0,0 +1,269 @@
+/******************************************************************************
+ * @file:        bench_comm_spsc.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        21/10/2026 05:00 PM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the benchmark of the in-process link
+ *               transport against the socket one. A wave of frames enters a
+ *               line topology at R0 and is forwarded node by node to the last
+ *               one, which frees it. size is the number of nodes, 10 up to
+ *               --max-size (default 100), and ops is hops, so the reported
+ *               time is ns per hop:
+ *
+ *                 - line/spsc-1:   one frame per wave, comm_spsc_send and
+ *                                  comm_spsc_recv
+ *                 - line/spsc-32:  BENCH_BURST frames per wave,
+ *                                  comm_spsc_send_burst and
+ *                                  comm_spsc_recv_burst
+ *                 - line/socket:   one frame per wave over the UDP
+ *                                  transport, comm_send and comm_recv,
+ *                                  skipped with a note for lines needing
+ *                                  more descriptors than the process may
+ *                                  open
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 21/10/2026 Marko Trickovic
+ * Initial version.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "../src/comm/comm.h"
+#include "../src/comm/comm_spsc.h"
+#include "../src/graph/topologies.h"
+
+#define BENCH_BURST     32
+#define BENCH_LEN       64
+#define BENCH_BLKS      4096
+#define BENCH_BLK_SIZE  256
+#define BENCH_HEADROOM  64
+#define BENCH_WAIT_MS   1000
+#define BENCH_FD_SLACK  32
+
+typedef struct bench_ctx_ {
+    pkt_pool_t *pool;
+    graph_t *topo;
+    comm_spsc_t *sp;
+    comm_t *comm;
+    interface_t **in;
+    interface_t **out;
+    uint32_t nnodes;
+    uint64_t lost;
+    uint64_t fd_limit;
+} bench_ctx_t;
+
+// Descriptors the socket transport takes on a line of size nodes: a socket
+// per interface, an epoll instance and an eventfd per node
+static uint64_t fds_needed(uint64_t size)
+{
+    return 2 * (size - 1) + 2 * size + BENCH_FD_SLACK;
+}
+
+// Looks up the interfaces a frame enters and leaves each node through
+static int bench_setup(bench_ctx_t *ctx, uint32_t nnodes)
+{
+    char name[NODE_NAME_SIZE];
+    node_t *node;
+    uint32_t i;
+
+    ctx->topo = build_line_topo(nnodes);
+    ctx->in = calloc(nnodes, sizeof(interface_t *));
+    ctx->out = calloc(nnodes, sizeof(interface_t *));
+    if (!ctx->topo || !ctx->in || !ctx->out)
+        return -1;
+    ctx->nnodes = nnodes;
+
+    for (i = 0; i < nnodes; i++) {
+        snprintf(name, sizeof(name), "R%u", i);
+        node = get_node_by_node_name(ctx->topo, name);
+        if (i)
+            ctx->in[i] = get_node_intf_by_name(node, "eth0");
+        ctx->out[i] = get_node_intf_by_name(node, i ? "eth1" : "eth0");
+    }
+    return 0;
+}
+
+static void bench_teardown(bench_ctx_t *ctx)
+{
+    free(ctx->in);
+    free(ctx->out);
+    destroy_graph(ctx->topo);
+}
+
+static pkt_buf_t *bench_frame(bench_ctx_t *ctx)
+{
+    pkt_buf_t *pkt = pkt_buf_alloc(ctx->pool);
+
+    if (pkt)
+        memset(pkt_buf_put(pkt, BENCH_LEN), 0x5a, BENCH_LEN);
+    return pkt;
+}
+
+// Forwards one frame down the line, returns the hops it made
+static uint64_t wave_spsc_1(bench_ctx_t *ctx)
+{
+    pkt_buf_t *pkt = bench_frame(ctx);
+    uint32_t i;
+
+    if (!pkt)
+        return 0;
+    comm_spsc_send(ctx->sp, ctx->out[0], pkt);
+    for (i = 1; i < ctx->nnodes; i++) {
+        pkt = comm_spsc_recv(ctx->sp, ctx->in[i]);
+        if (!pkt) {
+            ctx->lost++;
+            return i - 1;
+        }
+        if (i + 1 < ctx->nnodes)
+            comm_spsc_send(ctx->sp, ctx->out[i], pkt);
+        else
+            pkt_buf_free(pkt);
+    }
+    return ctx->nnodes - 1;
+}
+
+// Forwards BENCH_BURST frames down the line, returns the hops they made
+static uint64_t wave_spsc_burst(bench_ctx_t *ctx)
+{
+    pkt_buf_t *pkts[BENCH_BURST];
+    uint64_t hops = 0;
+    uint32_t i, n;
+
+    n = pkt_buf_alloc_bulk(ctx->pool, pkts, BENCH_BURST);
+    for (i = 0; i < n; i++)
+        memset(pkt_buf_put(pkts[i], BENCH_LEN), 0x5a, BENCH_LEN);
+    comm_spsc_send_burst(ctx->sp, ctx->out[0], pkts, n);
+
+    for (i = 1; i < ctx->nnodes; i++) {
+        n = comm_spsc_recv_burst(ctx->sp, ctx->in[i], pkts, BENCH_BURST);
+        hops += n;
+        if (i + 1 < ctx->nnodes) {
+            comm_spsc_send_burst(ctx->sp, ctx->out[i], pkts, n);
+            continue;
+        }
+        while (n)
+            pkt_buf_free(pkts[--n]);
+    }
+    return hops;
+}
+
+// Forwards one frame down the line over sockets, returns the hops it made
+static uint64_t wave_socket(bench_ctx_t *ctx)
+{
+    pkt_buf_t *pkt = bench_frame(ctx);
+    uint32_t i;
+
+    if (!pkt)
+        return 0;
+    comm_send(ctx->comm, ctx->out[0], pkt);
+    for (i = 1; i < ctx->nnodes; i++) {
+        pkt = comm_recv(ctx->comm, ctx->in[i], BENCH_WAIT_MS);
+        if (!pkt) {
+            ctx->lost++;
+            return i - 1;
+        }
+        if (i + 1 < ctx->nnodes)
+            comm_send(ctx->comm, ctx->out[i], pkt);
+        else
+            pkt_buf_free(pkt);
+    }
+    return ctx->nnodes - 1;
+}
+
+static int bench_run(bench_report_t *rep, bench_ctx_t *ctx, const char *name,
+                     uint64_t (*wave)(bench_ctx_t *), uint64_t size)
+{
+    uint64_t ns = 0, cycles = 0, ops = 0, t0, c0;
+
+    if (wave == wave_socket && fds_needed(size) > ctx->fd_limit) {
+        fprintf(stderr, "%s/%llu: skipped, needs %llu open files, limit %llu\n",
+                name, (unsigned long long)size,
+                (unsigned long long)fds_needed(size),
+                (unsigned long long)ctx->fd_limit);
+        return 0;
+    }
+
+    if (bench_setup(ctx, (uint32_t)size) < 0) {
+        bench_teardown(ctx);
+        return -1;
+    }
+    if (wave == wave_socket) {
+        ctx->comm = comm_create(ctx->topo, ctx->pool, 0, 0);
+        if (!ctx->comm || comm_start(ctx->comm) < 0) {
+            perror("comm");
+            comm_destroy(ctx->comm);
+            ctx->comm = NULL;
+            bench_teardown(ctx);
+            return -1;
+        }
+    } else {
+        ctx->sp = comm_spsc_create(ctx->topo, 0);
+        if (!ctx->sp) {
+            perror("comm_spsc");
+            bench_teardown(ctx);
+            return -1;
+        }
+    }
+
+    ctx->lost = 0;
+    do {
+        t0 = bench_now_ns();
+        c0 = bench_cycles();
+        ops += wave(ctx);
+        cycles += bench_cycles() - c0;
+        ns += bench_now_ns() - t0;
+    } while (ns < rep->opts->min_ns);
+
+    bench_report(rep, name, size, ops ? ops : 1, ns, cycles);
+    if (ctx->lost)
+        fprintf(stderr, "%s/%llu: %llu waves lost\n", name,
+                (unsigned long long)size, (unsigned long long)ctx->lost);
+
+    comm_spsc_destroy(ctx->sp);
+    comm_destroy(ctx->comm);
+    ctx->sp = NULL;
+    ctx->comm = NULL;
+    bench_teardown(ctx);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    bench_opts_t opts;
+    bench_report_t rep;
+    bench_ctx_t ctx;
+    uint64_t size = 0;
+    int rc = 0;
+
+    if (bench_parse_args(argc, argv, &opts, 100) < 0)
+        return 1;
+
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.pool = pkt_pool_create(BENCH_BLKS, BENCH_BLK_SIZE, BENCH_HEADROOM,
+                               PKT_POOL_MT);
+    if (!ctx.pool)
+        return 1;
+    ctx.fd_limit = bench_fd_limit();
+
+    bench_report_begin(&rep, &opts, "comm_spsc");
+
+    while (!rc && bench_sizes(&opts, &size)) {
+        if (size < 2)
+            continue;
+        rc |= bench_run(&rep, &ctx, "line/spsc-1", wave_spsc_1, size);
+        rc |= bench_run(&rep, &ctx, "line/spsc-32", wave_spsc_burst, size);
+        rc |= bench_run(&rep, &ctx, "line/socket", wave_socket, size);
+    }
+
+    bench_report_end(&rep);
+
+    pkt_pool_destroy(ctx.pool);
+    return rc ? 1 : 0;
+}
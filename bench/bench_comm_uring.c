@@ -0,0 +1,197 @@
+/******************************************************************************
+ * @file:        bench_comm_uring.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        21/10/2026 03:00 PM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the benchmark of the io_uring backend of
+ *               the link transport against the epoll one, on line topologies
+ *               of 10 up to --max-size (default 1000) nodes, so up to about
+ *               two thousand interfaces. size is the number of nodes and ops
+ *               is frames received:
+ *
+ *                 - sweep/epoll:  a receive thread and an epoll instance per
+ *                                 node, frames sent with sendmmsg from the
+ *                                 caller
+ *                 - sweep/uring:  one ring thread for every interface
+ *
+ *               A sweep queues BENCH_DEPTH frames of BENCH_LEN bytes on every
+ *               interface, flushes every interface and then takes them all
+ *               from the interface at the other end of each link. The
+ *               syscalls per frame of the whole transport go to stderr.
+ *               Sizes needing more descriptors than the process may open
+ *               are skipped with a note.
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 21/10/2026 Marko Trickovic
+ * Initial version.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "bench.h"
+#include "../src/comm/comm_uring.h"
+#include "../src/graph/topologies.h"
+
+#define BENCH_DEPTH     8
+#define BENCH_LEN       64
+#define BENCH_BLKS      65536
+#define BENCH_BLK_SIZE  256
+#define BENCH_HEADROOM  64
+#define BENCH_WAIT_MS   1000
+#define BENCH_FD_SLACK  32
+
+typedef struct bench_ctx_ {
+    comm_t *comm;
+    pkt_pool_t *pool;
+    graph_t *topo;
+    uint64_t lost;
+    uint64_t fd_limit;
+} bench_ctx_t;
+
+// Descriptors a line of size nodes takes: a socket per interface, an epoll
+// instance and an eventfd per node, which covers the ring's own
+static uint64_t fds_needed(uint64_t size)
+{
+    return 2 * (size - 1) + 2 * size + BENCH_FD_SLACK;
+}
+
+// Sends, receives, epoll_waits and io_uring_enters made so far
+static uint64_t syscalls(const comm_t *comm)
+{
+    uint64_t n = 0;
+    uint32_t i;
+
+    for (i = 0; i < comm->nintfs; i++)
+        n += __atomic_load_n(&comm->intfs[i].tx_syscalls, __ATOMIC_RELAXED) +
+             __atomic_load_n(&comm->intfs[i].rx_syscalls, __ATOMIC_RELAXED);
+    for (i = 0; i < comm->nnodes; i++)
+        n += __atomic_load_n(&comm->nodes[i].polls, __ATOMIC_RELAXED);
+    if (comm->uring)
+        n += __atomic_load_n(&comm->uring->enters, __ATOMIC_RELAXED) +
+             __atomic_load_n(&comm->uring->kicks, __ATOMIC_RELAXED);
+    return n;
+}
+
+// Queues and flushes BENCH_DEPTH frames on every interface, then takes them
+// all at the far ends, returns the frames received
+static uint64_t sweep(bench_ctx_t *ctx)
+{
+    comm_t *comm = ctx->comm;
+    interface_t *intf;
+    pkt_queue_t out;
+    pkt_buf_t *pkt;
+    uint64_t got = 0;
+    uint32_t i, d, n;
+
+    for (i = 1; i < comm->nintfs; i++) {
+        intf = ctx->topo->ifindex_tbl[i];
+        for (d = 0; d < BENCH_DEPTH; d++) {
+            pkt = pkt_buf_alloc(ctx->pool);
+            if (!pkt)
+                break;
+            memset(pkt_buf_put(pkt, BENCH_LEN), 0x5a, BENCH_LEN);
+            comm_enqueue(comm, intf, pkt);
+        }
+        comm_flush(comm, intf);
+    }
+
+    pkt_queue_init(&out, PKT_QUEUE_UNBOUNDED);
+    for (i = 1; i < comm->nintfs; i++) {
+        intf = ctx->topo->ifindex_tbl[i];
+        n = 0;
+        while (n < BENCH_DEPTH &&
+               comm_recv_burst(comm, intf, &out, BENCH_WAIT_MS))
+            n = out.count;
+        got += out.count;
+        ctx->lost += BENCH_DEPTH - out.count;
+        pkt_queue_flush(&out);
+    }
+    return got;
+}
+
+static int bench_run(bench_report_t *rep, bench_ctx_t *ctx, const char *name,
+                     uint32_t flags, uint64_t size)
+{
+    uint64_t ns = 0, cycles = 0, ops = 0, t0, c0, sys0;
+
+    if (fds_needed(size) > ctx->fd_limit) {
+        fprintf(stderr, "%s/%llu: skipped, needs %llu open files, limit %llu\n",
+                name, (unsigned long long)size,
+                (unsigned long long)fds_needed(size),
+                (unsigned long long)ctx->fd_limit);
+        return 0;
+    }
+
+    ctx->topo = build_line_topo((uint32_t)size);
+    if (!ctx->topo)
+        return -1;
+    ctx->comm = comm_create(ctx->topo, ctx->pool, 0, flags);
+    if (!ctx->comm || comm_start(ctx->comm) < 0) {
+        perror("comm");
+        comm_destroy(ctx->comm);
+        destroy_graph(ctx->topo);
+        return -1;
+    }
+    if ((flags & COMM_URING) && !ctx->comm->uring)
+        fprintf(stderr, "%s: io_uring unavailable, measuring epoll\n", name);
+
+    ctx->lost = 0;
+    sys0 = syscalls(ctx->comm);
+    do {
+        t0 = bench_now_ns();
+        c0 = bench_cycles();
+        ops += sweep(ctx);
+        cycles += bench_cycles() - c0;
+        ns += bench_now_ns() - t0;
+    } while (ns < rep->opts->min_ns);
+
+    bench_report(rep, name, size, ops ? ops : 1, ns, cycles);
+    fprintf(stderr, "%s/%llu: %.3f syscalls/frame, %.3f Mpps\n", name,
+            (unsigned long long)size,
+            (double)(syscalls(ctx->comm) - sys0) / (ops ? ops : 1),
+            ns ? (double)ops * 1e3 / ns : 0.0);
+    if (ctx->lost)
+        fprintf(stderr, "%s/%llu: %llu frames lost\n", name,
+                (unsigned long long)size, (unsigned long long)ctx->lost);
+
+    comm_destroy(ctx->comm);
+    destroy_graph(ctx->topo);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    bench_opts_t opts;
+    bench_report_t rep;
+    bench_ctx_t ctx;
+    uint64_t size = 0;
+    int rc = 0;
+
+    if (bench_parse_args(argc, argv, &opts, 1000) < 0)
+        return 1;
+
+    ctx.pool = pkt_pool_create(BENCH_BLKS, BENCH_BLK_SIZE, BENCH_HEADROOM,
+                               PKT_POOL_MT);
+    if (!ctx.pool)
+        return 1;
+    ctx.fd_limit = bench_fd_limit();
+
+    bench_report_begin(&rep, &opts, "comm_uring");
+
+    while (!rc && bench_sizes(&opts, &size)) {
+        if (size < 2)
+            continue;
+        rc |= bench_run(&rep, &ctx, "sweep/epoll", 0, size);
+        rc |= bench_run(&rep, &ctx, "sweep/uring", COMM_URING, size);
+    }
+
+    bench_report_end(&rep);
+
+    pkt_pool_destroy(ctx.pool);
+    return rc ? 1 : 0;
+}
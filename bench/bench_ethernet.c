@@ -0,0 +1,185 @@
+/******************************************************************************
+ * @file:        bench_ethernet.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        22/10/2026 03:00 AM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the benchmark of Ethernet header parsing
+ *               and rewriting with 10 to --max-size (default 100k) 64-byte
+ *               frames on a pkt_queue_t. A round takes every frame off the
+ *               receive queue, works on its header and puts it on the
+ *               transmit queue, which becomes the receive queue of the next
+ *               round; ops is frames:
+ *
+ *                 - parse+rewrite/view:  ethernet_parse, then
+ *                                        ethernet_rewrite of both addresses
+ *                                        through the view
+ *                 - parse+rewrite/copy:  the header copied out into a
+ *                                        struct, the addresses changed there
+ *                                        and the struct copied back, as a
+ *                                        parser without views would
+ *                 - strip+build:         the header pulled off and a new
+ *                                        one built in the headroom
+ *
+ *               One frame in 4 is 802.1Q tagged until strip+build, which
+ *               runs last, drops the tags.
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 22/10/2026 Marko Trickovic
+ * Initial version.
+ *****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "../src/net/ethernet.h"
+
+#define BENCH_LEN       64
+#define BENCH_BLK_SIZE  256
+#define BENCH_HEADROOM  64
+
+static const uint8_t mac_a[6] = { 0x02, 0, 0, 0, 0, 0x0a };
+static const uint8_t mac_b[6] = { 0x02, 0, 0, 0, 0, 0x0b };
+
+typedef struct bench_ctx_ {
+    pkt_queue_t rxq;
+    pkt_queue_t txq;
+    uint64_t size;
+} bench_ctx_t;
+
+typedef int (*bench_fn_t)(pkt_buf_t *pkt);
+
+static int parse_view(pkt_buf_t *pkt)
+{
+    ethernet_frame_t frame;
+
+    if (ethernet_parse(pkt, &frame) < 0)
+        return -1;
+    ethernet_rewrite(frame.eth, frame.eth->src, mac_b);
+    return frame.type == ETHERNET_TYPE_IP4 ? 0 : -1;
+}
+
+static int parse_copy(pkt_buf_t *pkt)
+{
+    ethernet_vlan_hdr_t hdr;
+    uint32_t hlen = ETHERNET_HDR_LEN;
+    uint16_t type;
+
+    if (pkt->len < ETHERNET_VLAN_HDR_LEN)
+        return -1;
+    memcpy(&hdr, pkt->data, sizeof(hdr));
+    type = ntohs(hdr.tpid);
+    if (type == ETHERNET_TYPE_VLAN) {
+        hlen = ETHERNET_VLAN_HDR_LEN;
+        type = ntohs(hdr.type);
+    }
+    memcpy(hdr.dst, hdr.src, ETHERNET_ADDR_LEN);
+    memcpy(hdr.src, mac_b, ETHERNET_ADDR_LEN);
+    memcpy(pkt->data, &hdr, hlen);
+    return type == ETHERNET_TYPE_IP4 ? 0 : -1;
+}
+
+static int strip_build(pkt_buf_t *pkt)
+{
+    ethernet_frame_t frame;
+
+    if (ethernet_parse(pkt, &frame) < 0 || !pkt_buf_pull(pkt, frame.hlen))
+        return -1;
+    return ethernet_build(pkt, mac_a, mac_b, frame.type) ? 0 : -1;
+}
+
+static int bench_run(bench_report_t *rep, bench_ctx_t *ctx, const char *name,
+                     bench_fn_t fn)
+{
+    uint64_t ns = 0, cycles = 0, ops = 0, t0, c0;
+    pkt_buf_t *pkt;
+    int rc = 0;
+
+    do {
+        t0 = bench_now_ns();
+        c0 = bench_cycles();
+        while ((pkt = pkt_queue_pop(&ctx->rxq))) {
+            rc |= fn(pkt);
+            pkt_queue_push(&ctx->txq, pkt);
+        }
+        cycles += bench_cycles() - c0;
+        ns += bench_now_ns() - t0;
+        ops += ctx->size;
+        pkt_queue_splice(&ctx->rxq, &ctx->txq);
+    } while (ns < rep->opts->min_ns);
+
+    // Every frame carries IPv4, so a wrong type means a broken parse
+    if (rc)
+        return -1;
+    bench_report(rep, name, ctx->size, ops, ns, cycles);
+    return 0;
+}
+
+// Fills the receive queue with size frames, one in 4 tagged
+static int build_frames(bench_ctx_t *ctx, pkt_pool_t *pool)
+{
+    unsigned char *p;
+    pkt_buf_t *pkt;
+    uint64_t i;
+
+    for (i = 0; i < ctx->size; i++) {
+        pkt = pkt_buf_alloc(pool);
+        if (!pkt)
+            return -1;
+        p = pkt_buf_put(pkt, BENCH_LEN);
+        if (!p) {
+            pkt_buf_free(pkt);
+            return -1;
+        }
+        memset(p, 0, BENCH_LEN);
+        memcpy(p, mac_a, ETHERNET_ADDR_LEN);
+        memcpy(p + 6, mac_b, ETHERNET_ADDR_LEN);
+        if (i % 4 == 3) {
+            p[12] = 0x81;
+            p[15] = 100;
+            p += 4;
+        }
+        p[12] = 0x08;
+        pkt_queue_push(&ctx->rxq, pkt);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    bench_opts_t opts;
+    bench_report_t rep;
+    bench_ctx_t ctx;
+    pkt_pool_t *pool;
+    int rc = 0;
+
+    if (bench_parse_args(argc, argv, &opts, 100000ull) < 0)
+        return 1;
+
+    pool = pkt_pool_create(opts.max_size, BENCH_BLK_SIZE, BENCH_HEADROOM, 0);
+    if (!pool)
+        return 1;
+    pkt_queue_init(&ctx.rxq, PKT_QUEUE_UNBOUNDED);
+    pkt_queue_init(&ctx.txq, PKT_QUEUE_UNBOUNDED);
+
+    bench_report_begin(&rep, &opts, "ethernet");
+
+    while (!rc && bench_sizes(&opts, &ctx.size)) {
+        rc |= build_frames(&ctx, pool);
+        if (rc)
+            break;
+        rc |= bench_run(&rep, &ctx, "parse+rewrite/view", parse_view);
+        rc |= bench_run(&rep, &ctx, "parse+rewrite/copy", parse_copy);
+        rc |= bench_run(&rep, &ctx, "strip+build", strip_build);
+        pkt_queue_flush(&ctx.rxq);
+    }
+
+    bench_report_end(&rep);
+
+    pkt_pool_destroy(pool);
+    return rc ? 1 : 0;
+}
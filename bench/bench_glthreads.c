@@ -0,0 +1,278 @@
+/******************************************************************************
+ * @file:        bench_glthreads.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        19/10/2026 11:30 AM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the microbenchmarks for glthreads. Every
+ *               operation is measured at list sizes from 10 up to 10M in
+ *               decades. Small sizes are measured over a batch of independent
+ *               lists so that the clock is never read for fewer than ~64k
+ *               operations.
+ *
+ *               Benchmarks in this file:
+ *                 - init_glthread
+ *                 - glthread_add
+ *                 - glthread_add_next
+ *                 - glthread_remove (head first and in random order)
+ *                 - ITERATE_GL_THREADS_BEGIN (sequential and shuffled nodes)
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 19/10/2026 Marko Trickovic
+ * Initial version.
+ *
+ * Revision 0.2: 19/10/2026 Marko Trickovic
+ * Random-order remove runs at every size now that glthread_remove is O(1).
+ *****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "../src/glthreads/glthreads.h"
+
+/* Operations measured between two clock reads for small list sizes. */
+#define BENCH_BATCH_OPS                 65536ull
+
+typedef struct bench_data_ {
+    uint64_t data;
+    glthread_node_t glnode;
+} bench_data_t;
+
+typedef struct bench_ctx_ {
+    bench_data_t *nodes;
+    glthread_t *lists;
+    uint32_t *perm;
+    uint64_t size;
+    uint64_t batch;
+} bench_ctx_t;
+
+typedef void (*bench_fn_t)(bench_ctx_t *ctx);
+
+static uint64_t bench_rand_state = 0x9e3779b97f4a7c15ull;
+
+static uint64_t bench_rand(void)
+{
+    uint64_t x = bench_rand_state;
+
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return bench_rand_state = x;
+}
+
+/**
+ * @brief      Fills ctx->perm with a random permutation of [0, size).
+ */
+static void bench_shuffle(bench_ctx_t *ctx)
+{
+    uint64_t i, j;
+    uint32_t tmp;
+
+    for (i = 0; i < ctx->size; i++)
+        ctx->perm[i] = (uint32_t)i;
+
+    for (i = ctx->size - 1; i > 0; i--) {
+        j = bench_rand() % (i + 1);
+        tmp = ctx->perm[i];
+        ctx->perm[i] = ctx->perm[j];
+        ctx->perm[j] = tmp;
+    }
+}
+
+static inline bench_data_t *bench_node(bench_ctx_t *ctx, uint64_t list,
+                                       uint64_t i)
+{
+    return &ctx->nodes[list * ctx->size + i];
+}
+
+static void setup_clear(bench_ctx_t *ctx)
+{
+    uint64_t j;
+
+    memset(ctx->nodes, 0, ctx->size * ctx->batch * sizeof(*ctx->nodes));
+    for (j = 0; j < ctx->batch; j++)
+        init_glthread(&ctx->lists[j], offset(bench_data_t, glnode));
+}
+
+static void setup_build_seq(bench_ctx_t *ctx)
+{
+    uint64_t i, j;
+
+    setup_clear(ctx);
+    for (j = 0; j < ctx->batch; j++)
+        for (i = 0; i < ctx->size; i++)
+            glthread_add(&ctx->lists[j], &bench_node(ctx, j, i)->glnode);
+}
+
+static void setup_build_shuffled(bench_ctx_t *ctx)
+{
+    uint64_t i, j;
+
+    setup_clear(ctx);
+    for (j = 0; j < ctx->batch; j++)
+        for (i = 0; i < ctx->size; i++)
+            glthread_add(&ctx->lists[j],
+                         &bench_node(ctx, j, ctx->perm[i])->glnode);
+}
+
+static void body_init(bench_ctx_t *ctx)
+{
+    uint64_t i, n = ctx->size * ctx->batch;
+
+    // ctx->lists has room for one list per node
+    for (i = 0; i < n; i++)
+        init_glthread(&ctx->lists[i], offset(bench_data_t, glnode));
+    BENCH_DO_NOT_OPTIMIZE(ctx->lists);
+}
+
+static void body_add(bench_ctx_t *ctx)
+{
+    uint64_t i, j;
+
+    for (j = 0; j < ctx->batch; j++)
+        for (i = 0; i < ctx->size; i++)
+            glthread_add(&ctx->lists[j], &bench_node(ctx, j, i)->glnode);
+}
+
+static void body_add_next(bench_ctx_t *ctx)
+{
+    glthread_node_t *prev;
+    uint64_t i, j;
+
+    for (j = 0; j < ctx->batch; j++) {
+        prev = &bench_node(ctx, j, 0)->glnode;
+        for (i = 1; i < ctx->size; i++) {
+            glthread_add_next(prev, &bench_node(ctx, j, i)->glnode);
+            prev = prev->right;
+        }
+    }
+}
+
+static void body_remove_head(bench_ctx_t *ctx)
+{
+    glthread_t *lst;
+    uint64_t j;
+
+    for (j = 0; j < ctx->batch; j++) {
+        lst = &ctx->lists[j];
+        while (lst->head)
+            glthread_remove(lst, lst->head);
+    }
+}
+
+static void body_remove_random(bench_ctx_t *ctx)
+{
+    uint64_t i, j;
+
+    for (j = 0; j < ctx->batch; j++)
+        for (i = 0; i < ctx->size; i++)
+            glthread_remove(&ctx->lists[j],
+                            &bench_node(ctx, j, ctx->perm[i])->glnode);
+}
+
+static void body_iterate(bench_ctx_t *ctx)
+{
+    bench_data_t *elem = NULL;
+    glthread_t *lst;
+    uint64_t sum = 0, j;
+
+    for (j = 0; j < ctx->batch; j++) {
+        lst = &ctx->lists[j];
+        ITERATE_GL_THREADS_BEGIN(lst, bench_data_t, elem)
+        {
+            sum += elem->data;
+        }
+        ITERATE_GL_THREADS_ENDS;
+    }
+    BENCH_DO_NOT_OPTIMIZE(sum);
+}
+
+/**
+ * @brief      Measures one operation at the current size until the minimum
+ *             measured time is reached and reports the result.
+ *
+ * @param[in]  rep          Report to print into.
+ * @param[in]  ctx          Benchmark context with size and batch set.
+ * @param[in]  name         Name of the benchmark.
+ * @param[in]  setup        Untimed preparation run before every sample, or
+ *                          NULL when the body can simply be repeated.
+ * @param[in]  body         Timed operation.
+ * @param[in]  ops_per_list Operations the body performs on each list.
+ */
+static void bench_run(bench_report_t *rep, bench_ctx_t *ctx, const char *name,
+                      bench_fn_t setup, bench_fn_t body, uint64_t ops_per_list)
+{
+    uint64_t ns = 0, cycles = 0, ops = 0, t0, c0;
+
+    do {
+        if (setup)
+            setup(ctx);
+
+        t0 = bench_now_ns();
+        c0 = bench_cycles();
+        body(ctx);
+        cycles += bench_cycles() - c0;
+        ns += bench_now_ns() - t0;
+        ops += ops_per_list * ctx->batch;
+    } while (ns < rep->opts->min_ns);
+
+    bench_report(rep, name, ctx->size, ops, ns, cycles);
+}
+
+int main(int argc, char **argv)
+{
+    bench_opts_t opts;
+    bench_report_t rep;
+    bench_ctx_t ctx;
+    uint64_t size = 0, max_nodes;
+
+    if (bench_parse_args(argc, argv, &opts, 10000000ull) < 0)
+        return 1;
+
+    max_nodes = opts.max_size > BENCH_BATCH_OPS ? opts.max_size
+                                                : BENCH_BATCH_OPS;
+    ctx.nodes = malloc(max_nodes * sizeof(*ctx.nodes));
+    ctx.lists = malloc(max_nodes * sizeof(*ctx.lists));
+    ctx.perm = malloc(max_nodes * sizeof(*ctx.perm));
+    if (!ctx.nodes || !ctx.lists || !ctx.perm) {
+        fprintf(stderr, "out of memory for %llu nodes\n",
+                (unsigned long long)max_nodes);
+        return 1;
+    }
+
+    bench_report_begin(&rep, &opts, "glthreads");
+
+    while (bench_sizes(&opts, &size)) {
+        ctx.size = size;
+        ctx.batch = size < BENCH_BATCH_OPS ? BENCH_BATCH_OPS / size : 1;
+        bench_shuffle(&ctx);
+
+        bench_run(&rep, &ctx, "init_glthread", NULL, body_init, ctx.size);
+        bench_run(&rep, &ctx, "glthread_add", setup_clear, body_add,
+                  ctx.size);
+        bench_run(&rep, &ctx, "glthread_add_next", setup_clear,
+                  body_add_next, ctx.size - 1);
+        bench_run(&rep, &ctx, "glthread_remove/head", setup_build_seq,
+                  body_remove_head, ctx.size);
+        bench_run(&rep, &ctx, "glthread_remove/random", setup_build_seq,
+                  body_remove_random, ctx.size);
+
+        setup_build_seq(&ctx);
+        bench_run(&rep, &ctx, "iterate/sequential", NULL, body_iterate,
+                  ctx.size);
+        setup_build_shuffled(&ctx);
+        bench_run(&rep, &ctx, "iterate/shuffled", NULL, body_iterate,
+                  ctx.size);
+    }
+
+    bench_report_end(&rep);
+
+    free(ctx.nodes);
+    free(ctx.lists);
+    free(ctx.perm);
+    return 0;
+}
@@ -0,0 +1,183 @@
+/******************************************************************************
+ * @file:        bench_graph.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        20/10/2026 04:00 PM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the benchmark of the topology graph on
+ *               topologies of 1k to --max-size (default 100k) nodes. Each node
+ *               is linked to the next one in a ring and nodes of the first
+ *               half to their opposite in the second half, giving three
+ *               interfaces per node:
+ *
+ *                 - build:           create the graph, its nodes and links;
+ *                                    ops is nodes
+ *                 - walk:            follow every interface of every node to
+ *                                    its neighbour; ops is interfaces
+ *                 - lookup/name:     random node and interface name lookups
+ *                 - lookup/ifindex:  random ifindex lookups
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 20/10/2026 Marko Trickovic
+ * Initial version.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench.h"
+#include "../src/graph/graph.h"
+
+#define BENCH_LOOKUPS   (1u << 16)
+
+typedef char bench_name_t[NODE_NAME_SIZE];
+
+static uint64_t bench_rand_state = 0x853c49e6748fea9bull;
+
+static uint64_t bench_rand(void)
+{
+    uint64_t x = bench_rand_state;
+
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return bench_rand_state = x;
+}
+
+static graph_t *bench_build(const bench_name_t *names, node_t **nodes,
+                            uint64_t n)
+{
+    graph_t *topo = create_new_graph("bench");
+    uint64_t i;
+
+    for (i = 0; i < n; i++)
+        nodes[i] = create_graph_node(topo, names[i]);
+
+    for (i = 0; i < n; i++)
+        insert_link_between_two_nodes(nodes[i], nodes[(i + 1) % n],
+                                      "ring/r", "ring/l", 1);
+    for (i = 0; i < n / 2; i++)
+        insert_link_between_two_nodes(nodes[i], nodes[i + n / 2],
+                                      "chord", "chord", 2);
+
+    return topo;
+}
+
+static uint64_t bench_walk(graph_t *topo)
+{
+    glthread_t *lst = &topo->node_list;
+    interface_t *intf;
+    node_t *node;
+    uint64_t sum = 0;
+
+    ITERATE_GL_THREADS_BEGIN(lst, node_t, node) {
+        ITERATE_NODE_INTERFACES_BEGIN(node, intf) {
+            sum += get_nbr_node(intf)->node_id;
+        } ITERATE_NODE_INTERFACES_ENDS;
+    } ITERATE_GL_THREADS_ENDS;
+
+    return sum;
+}
+
+int main(int argc, char **argv)
+{
+    bench_opts_t opts;
+    bench_report_t rep;
+    bench_name_t *names;
+    node_t **nodes;
+    graph_t *topo;
+    uint32_t *picks;
+    uint64_t size = 0, ns, cycles, ops, t0, c0, i, sum, intfs;
+
+    if (bench_parse_args(argc, argv, &opts, 100000ull) < 0)
+        return 1;
+    if (opts.min_size < 1000)
+        opts.min_size = 1000;
+    // Node counts are 32-bit, which also keeps "R<n>" in NODE_NAME_SIZE
+    if (opts.max_size > UINT32_MAX)
+        opts.max_size = UINT32_MAX;
+
+    names = malloc(opts.max_size * sizeof(*names));
+    nodes = malloc(opts.max_size * sizeof(*nodes));
+    picks = malloc(BENCH_LOOKUPS * sizeof(*picks));
+    if (!names || !nodes || !picks)
+        return 1;
+    for (i = 0; i < opts.max_size; i++)
+        snprintf(names[i], NODE_NAME_SIZE, "R%u", (uint32_t)i);
+
+    bench_report_begin(&rep, &opts, "graph");
+
+    while (bench_sizes(&opts, &size)) {
+        ns = cycles = ops = 0;
+        do {
+            t0 = bench_now_ns();
+            c0 = bench_cycles();
+            topo = bench_build(names, nodes, size);
+            cycles += bench_cycles() - c0;
+            ns += bench_now_ns() - t0;
+            ops += size;
+            destroy_graph(topo);
+        } while (ns < opts.min_ns);
+        bench_report(&rep, "build", size, ops, ns, cycles);
+
+        topo = bench_build(names, nodes, size);
+        intfs = topo->ifindex_next - 1;
+
+        ns = cycles = ops = 0;
+        do {
+            t0 = bench_now_ns();
+            c0 = bench_cycles();
+            sum = bench_walk(topo);
+            cycles += bench_cycles() - c0;
+            ns += bench_now_ns() - t0;
+            ops += intfs;
+            BENCH_DO_NOT_OPTIMIZE(sum);
+        } while (ns < opts.min_ns);
+        bench_report(&rep, "walk", size, ops, ns, cycles);
+
+        for (i = 0; i < BENCH_LOOKUPS; i++)
+            picks[i] = (uint32_t)(bench_rand() % size);
+
+        ns = cycles = ops = sum = 0;
+        do {
+            t0 = bench_now_ns();
+            c0 = bench_cycles();
+            for (i = 0; i < BENCH_LOOKUPS; i++)
+                sum += (uintptr_t)get_node_intf_by_name(
+                    get_node_by_node_name(topo, names[picks[i]]), "ring/l");
+            cycles += bench_cycles() - c0;
+            ns += bench_now_ns() - t0;
+            ops += BENCH_LOOKUPS;
+        } while (ns < opts.min_ns);
+        BENCH_DO_NOT_OPTIMIZE(sum);
+        bench_report(&rep, "lookup/name", size, ops, ns, cycles);
+
+        for (i = 0; i < BENCH_LOOKUPS; i++)
+            picks[i] = (uint32_t)(1 + bench_rand() % intfs);
+
+        ns = cycles = ops = sum = 0;
+        do {
+            t0 = bench_now_ns();
+            c0 = bench_cycles();
+            for (i = 0; i < BENCH_LOOKUPS; i++)
+                sum += get_intf_by_ifindex(topo, picks[i])->att_node->node_id;
+            cycles += bench_cycles() - c0;
+            ns += bench_now_ns() - t0;
+            ops += BENCH_LOOKUPS;
+        } while (ns < opts.min_ns);
+        BENCH_DO_NOT_OPTIMIZE(sum);
+        bench_report(&rep, "lookup/ifindex", size, ops, ns, cycles);
+
+        destroy_graph(topo);
+    }
+
+    bench_report_end(&rep);
+
+    free(names);
+    free(nodes);
+    free(picks);
+    return 0;
+}
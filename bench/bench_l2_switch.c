@@ -0,0 +1,397 @@
+/******************************************************************************
+ * @file:        bench_l2_switch.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        22/10/2026 07:00 AM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the benchmark of switch forwarding with
+ *               8 to --max-size (default 256) ports, doubling. Even ports
+ *               are in VLAN 1 and odd ports in VLAN 2, so a frame in VLAN 1
+ *               floods to half the ports but the one it came in by; VLAN 3
+ *               has port 0 and three others. Rounds of 64 frames of 64
+ *               bytes come in by port 0 and the transmit queues are emptied
+ *               between rounds; ops is frames:
+ *
+ *                 - flood/bitmap:       broadcasts through l2_switch_input
+ *                 - flood/scan:         the same with every port checked
+ *                                       for being up and in the VLAN per
+ *                                       frame, as a switch without flood
+ *                                       bitmaps would
+ *                 - flood/copy:         the flood bitmap walked but every
+ *                                       port given its own copy of the
+ *                                       frame
+ *                 - sparse/bitmap,
+ *                   sparse/scan:        the first two in VLAN 3
+ *                 - flood/bitmap-1514,
+ *                   flood/copy-1514:    flood/bitmap and flood/copy with
+ *                                       full-size frames
+ *                 - fwd/untagged:       frames to an address learnt on
+ *                                       port 2, access to access
+ *
+ *               Ports 1 and 3 then become trunks sending VLAN 1 tagged:
+ *
+ *                 - fwd/tagged:         trunk to trunk, the tag kept
+ *                 - fwd/push:           access to trunk, a tag pushed
+ *                 - fwd/pop:            trunk to access, the tag popped
+ *                 - flood/mixed:        flood/bitmap with the two trunks,
+ *                                       one copy of each frame tagged
+ *
+ *               Last, with the frame length as size, one tag pushed and
+ *               popped per frame:
+ *
+ *                 - tag/inplace:        ethernet_vlan_push and
+ *                                       ethernet_vlan_pop, the addresses
+ *                                       moved
+ *                 - tag/shift:          the same done by moving everything
+ *                                       after the addresses, as inserting
+ *                                       a tag at the tail end would
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 22/10/2026 Marko Trickovic
+ * Initial version.
+ *
+ * Revision 0.2: 22/10/2026 Marko Trickovic
+ * Added tagged forwarding and tag push and pop.
+ *****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "../src/l2/l2_switch.h"
+#include "../src/net/ethernet.h"
+
+#define BENCH_FRAMES    64
+#define BENCH_BLKS      16384
+#define BENCH_SPARSE    3
+
+static const uint8_t mac_a[6] = { 0x02, 0, 0, 0, 0, 0x0a };
+static const uint8_t mac_b[6] = { 0x02, 0, 0, 0, 0, 0x0b };
+static const uint8_t mac_c[6] = { 0x02, 0, 0, 0, 0, 0x0c };
+static const uint8_t mac_d[6] = { 0x02, 0, 0, 0, 0, 0x0d };
+static const uint8_t bcast[6] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+
+typedef enum bench_op_ {
+    OP_INPUT,
+    OP_FLOOD_SCAN,
+    OP_FLOOD_COPY,
+    OP_TAG_INPLACE,
+    OP_TAG_SHIFT
+} bench_op_t;
+
+typedef struct bench_ctx_ {
+    pkt_pool_t *pool;
+    l2_switch_t *sw;
+    uint64_t size;
+    uint32_t in;
+    const uint8_t *dst;
+    const uint8_t *src;
+    uint16_t vid;
+    uint32_t len;
+    pkt_buf_t *pkts[BENCH_FRAMES];
+    volatile uint32_t sink;
+} bench_ctx_t;
+
+static void tx(l2_switch_t *sw, uint32_t port, pkt_buf_t *pkt)
+{
+    pkt->tx_ifindex = port;
+    if (pkt_queue_push(&sw->ports[port].txq, pkt) < 0) {
+        pkt_buf_free(pkt);
+        sw->drops++;
+    }
+}
+
+// Floods from port 0 checking every port for being up and in the VLAN
+static void flood_scan(l2_switch_t *sw, pkt_buf_t **pkts, uint32_t n)
+{
+    ethernet_frame_t frame;
+    pkt_buf_t *pkt, *clone;
+    uint32_t i, p, prev;
+    uint16_t vlan;
+
+    for (i = 0; i < n; i++) {
+        pkt = pkts[i];
+        ethernet_parse(pkt, &frame);
+        vlan = frame.vlan ? frame.vid : sw->ports[0].pvid;
+        mac_table_learn(sw->macs, vlan, frame.eth->src, 0);
+        prev = 0;
+        for (p = 1; p < sw->nports; p++) {
+            if (!sw->ports[p].up || !l2_switch_is_member(sw, vlan, p))
+                continue;
+            if (prev) {
+                clone = pkt_buf_clone(pkt);
+                if (clone)
+                    tx(sw, prev, clone);
+            }
+            prev = p;
+        }
+        tx(sw, prev, pkt);
+    }
+}
+
+// Floods from port 0 over the flood bitmap with a copy for every port
+static void flood_copy(l2_switch_t *sw, pkt_buf_t **pkts, uint32_t n)
+{
+    const uint64_t *flood;
+    ethernet_frame_t frame;
+    pkt_buf_t *pkt, *copy;
+    uint32_t i, w;
+    uint64_t bits;
+    uint16_t vlan;
+
+    for (i = 0; i < n; i++) {
+        pkt = pkts[i];
+        ethernet_parse(pkt, &frame);
+        vlan = frame.vlan ? frame.vid : sw->ports[0].pvid;
+        mac_table_learn(sw->macs, vlan, frame.eth->src, 0);
+        flood = l2_switch_flood_map(sw, vlan);
+        for (w = 0; w < sw->words; w++) {
+            bits = w ? flood[w] : flood[w] & ~1ull;
+            for (; bits; bits &= bits - 1) {
+                copy = pkt_buf_copy(pkt);
+                if (copy)
+                    tx(sw, w * 64 + (uint32_t)__builtin_ctzll(bits), copy);
+            }
+        }
+        pkt_buf_free(pkt);
+    }
+}
+
+// Pushes a tag and pops it again, moving the bytes after the addresses
+static uint32_t tag_shift(pkt_buf_t *pkt)
+{
+    uint32_t len = pkt->len, tail = len - 2 * ETHERNET_ADDR_LEN;
+    unsigned char *p = pkt->data + 2 * ETHERNET_ADDR_LEN;
+
+    if (!pkt_buf_put(pkt, ETHERNET_VLAN_TAG_LEN))
+        return 0;
+    memmove(p + ETHERNET_VLAN_TAG_LEN, p, tail);
+    p[0] = 0x81;
+    p[1] = 0x00;
+    p[2] = 0x00;
+    p[3] = 0x01;
+    memmove(p, p + ETHERNET_VLAN_TAG_LEN, tail);
+    pkt_buf_trim(pkt, len);
+    return p[0];
+}
+
+static uint32_t tag_inplace(pkt_buf_t *pkt)
+{
+    if (!ethernet_vlan_push(pkt, 1))
+        return 0;
+    return (uint32_t)ethernet_vlan_pop(pkt);
+}
+
+// Fills ctx->pkts with frames of ctx->len bytes from ctx->src to ctx->dst,
+// tagged with ctx->vid unless it is 0
+static int make_frames(bench_ctx_t *ctx)
+{
+    unsigned char *p;
+    uint32_t i;
+
+    for (i = 0; i < BENCH_FRAMES; i++) {
+        ctx->pkts[i] = pkt_buf_alloc(ctx->pool);
+        if (!ctx->pkts[i])
+            return -1;
+        p = pkt_buf_put(ctx->pkts[i], ctx->len);
+        if (!p)
+            return -1;
+        memset(p, 0, ctx->len);
+        memcpy(p, ctx->dst, 6);
+        memcpy(p + 6, ctx->src, 6);
+        if (ctx->vid) {
+            p[12] = 0x81;
+            p[15] = (unsigned char)ctx->vid;
+            p += 4;
+        }
+        p[12] = 0x08;
+    }
+    return 0;
+}
+
+static void drain(l2_switch_t *sw)
+{
+    uint32_t p;
+
+    for (p = 0; p < sw->nports; p++)
+        pkt_queue_flush(&sw->ports[p].txq);
+}
+
+static int bench_run(bench_report_t *rep, bench_ctx_t *ctx, const char *name,
+                     bench_op_t op)
+{
+    uint64_t ns = 0, cycles = 0, ops = 0, t0, c0;
+    uint32_t i, sum = 0;
+
+    do {
+        if (make_frames(ctx) < 0)
+            return -1;
+        t0 = bench_now_ns();
+        c0 = bench_cycles();
+        switch (op) {
+        case OP_INPUT:
+            l2_switch_input(ctx->sw, ctx->in, ctx->pkts, BENCH_FRAMES);
+            break;
+        case OP_FLOOD_SCAN:
+            flood_scan(ctx->sw, ctx->pkts, BENCH_FRAMES);
+            break;
+        case OP_FLOOD_COPY:
+            flood_copy(ctx->sw, ctx->pkts, BENCH_FRAMES);
+            break;
+        case OP_TAG_INPLACE:
+            for (i = 0; i < BENCH_FRAMES; i++)
+                sum += tag_inplace(ctx->pkts[i]);
+            break;
+        case OP_TAG_SHIFT:
+            for (i = 0; i < BENCH_FRAMES; i++)
+                sum += tag_shift(ctx->pkts[i]);
+            break;
+        }
+        cycles += bench_cycles() - c0;
+        ns += bench_now_ns() - t0;
+        ops += BENCH_FRAMES;
+        if (ctx->sw) {
+            drain(ctx->sw);
+        } else {
+            for (i = 0; i < BENCH_FRAMES; i++)
+                pkt_buf_free(ctx->pkts[i]);
+        }
+    } while (ns < rep->opts->min_ns);
+
+    ctx->sink = sum;
+    bench_report(rep, name, ctx->size, ops, ns, cycles);
+    return 0;
+}
+
+// Makes port learn src in VLAN vid, tagged unless vid is 0
+static int learn(bench_ctx_t *ctx, uint32_t port, const uint8_t *src,
+                 uint16_t vid)
+{
+    uint32_t i;
+
+    ctx->dst = bcast;
+    ctx->src = src;
+    ctx->vid = vid;
+    if (make_frames(ctx) < 0)
+        return -1;
+    l2_switch_input(ctx->sw, port, ctx->pkts, 1);
+    for (i = 1; i < BENCH_FRAMES; i++)
+        pkt_buf_free(ctx->pkts[i]);
+    drain(ctx->sw);
+    return 0;
+}
+
+// Runs op from port in, src to dst tagged with vid unless it is 0
+static int bench_fwd(bench_report_t *rep, bench_ctx_t *ctx, const char *name,
+                     uint32_t in, const uint8_t *src, const uint8_t *dst,
+                     uint16_t vid)
+{
+    ctx->in = in;
+    ctx->src = src;
+    ctx->dst = dst;
+    ctx->vid = vid;
+    return bench_run(rep, ctx, name, OP_INPUT);
+}
+
+static int bench_ports(bench_report_t *rep, bench_ctx_t *ctx, uint32_t nports)
+{
+    uint32_t p;
+    int rc = 0;
+
+    ctx->sw = l2_switch_create(nports, 1024, 0);
+    if (!ctx->sw)
+        return -1;
+    for (p = 0; p < nports; p++) {
+        l2_switch_port_set(ctx->sw, p, 1, (uint16_t)(1 + (p & 1)));
+        l2_switch_vlan_add(ctx->sw, (uint16_t)(1 + (p & 1)), p);
+    }
+    for (p = 0; p < nports; p += nports / 4)
+        l2_switch_vlan_add(ctx->sw, BENCH_SPARSE, p);
+
+    ctx->size = nports;
+    ctx->len = 64;
+    ctx->in = 0;
+    ctx->src = mac_a;
+    ctx->dst = bcast;
+    rc |= bench_run(rep, ctx, "flood/bitmap", OP_INPUT);
+    rc |= bench_run(rep, ctx, "flood/scan", OP_FLOOD_SCAN);
+    rc |= bench_run(rep, ctx, "flood/copy", OP_FLOOD_COPY);
+    ctx->vid = BENCH_SPARSE;
+    rc |= bench_run(rep, ctx, "sparse/bitmap", OP_INPUT);
+    rc |= bench_run(rep, ctx, "sparse/scan", OP_FLOOD_SCAN);
+    ctx->vid = 0;
+    ctx->len = 1514;
+    rc |= bench_run(rep, ctx, "flood/bitmap-1514", OP_INPUT);
+    rc |= bench_run(rep, ctx, "flood/copy-1514", OP_FLOOD_COPY);
+    ctx->len = 64;
+
+    if (learn(ctx, 2, mac_b, 0) < 0)
+        return -1;
+    rc |= bench_fwd(rep, ctx, "fwd/untagged", 0, mac_a, mac_b, 0);
+
+    for (p = 1; p <= 3; p += 2) {
+        l2_switch_port_mode(ctx->sw, p, L2_PORT_TRUNK);
+        l2_switch_port_set(ctx->sw, p, 1, 0);
+        l2_switch_vlan_add(ctx->sw, 1, p);
+    }
+    if (learn(ctx, 1, mac_c, 1) < 0 || learn(ctx, 3, mac_d, 1) < 0)
+        return -1;
+    rc |= bench_fwd(rep, ctx, "fwd/tagged", 3, mac_d, mac_c, 1);
+    rc |= bench_fwd(rep, ctx, "fwd/push", 0, mac_a, mac_c, 0);
+    rc |= bench_fwd(rep, ctx, "fwd/pop", 1, mac_c, mac_a, 1);
+    rc |= bench_fwd(rep, ctx, "flood/mixed", 0, mac_a, bcast, 0);
+
+    l2_switch_destroy(ctx->sw);
+    ctx->sw = NULL;
+    return rc;
+}
+
+static int bench_tags(bench_report_t *rep, bench_ctx_t *ctx)
+{
+    static const uint32_t lens[] = { 64, 512, 1514 };
+    uint32_t i;
+    int rc = 0;
+
+    ctx->src = mac_a;
+    ctx->dst = mac_b;
+    ctx->vid = 0;
+    for (i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) {
+        ctx->len = ctx->size = lens[i];
+        rc |= bench_run(rep, ctx, "tag/inplace", OP_TAG_INPLACE);
+        rc |= bench_run(rep, ctx, "tag/shift", OP_TAG_SHIFT);
+    }
+    return rc;
+}
+
+int main(int argc, char **argv)
+{
+    bench_opts_t opts;
+    bench_report_t rep;
+    bench_ctx_t ctx;
+    uint32_t nports;
+    int rc = 0;
+
+    if (bench_parse_args(argc, argv, &opts, L2_SWITCH_MAX_PORTS) < 0)
+        return 1;
+
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.pool = pkt_pool_create(BENCH_BLKS, 2048, 64, 0);
+    if (!ctx.pool)
+        return 1;
+
+    bench_report_begin(&rep, &opts, "l2_switch");
+
+    for (nports = 8; !rc && nports <= opts.max_size &&
+         nports <= L2_SWITCH_MAX_PORTS; nports *= 2)
+        rc |= bench_ports(&rep, &ctx, nports);
+    if (!rc)
+        rc |= bench_tags(&rep, &ctx);
+
+    bench_report_end(&rep);
+
+    pkt_pool_destroy(ctx.pool);
+    return rc ? 1 : 0;
+}
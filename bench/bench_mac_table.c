@@ -0,0 +1,290 @@
+/******************************************************************************
+ * @file:        bench_mac_table.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        22/10/2026 05:00 AM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the benchmark of the MAC learning table
+ *               with 10 to --max-size (default 1M) random addresses spread
+ *               over 16 VLANs, in a table sized for exactly that many; ops
+ *               is addresses:
+ *
+ *                 - learn/new:      learning every address into an empty
+ *                                   table
+ *                 - learn/refresh:  learning them again one tick later,
+ *                                   which moves each to another aging list
+ *                 - lookup/hit:     looking each up, in another order than
+ *                                   they were learnt
+ *                 - lookup/miss:    looking up as many unknown addresses
+ *                 - age/all:        one mac_table_advance that ages every
+ *                                   address out
+ *                 - age/1pct:       the same when all but one address in a
+ *                                   hundred was refreshed; ops is the
+ *                                   addresses aged out, so ns/op would be
+ *                                   a hundred times age/all if the others
+ *                                   were looked at
+ *                 - lookup/list:    a glthread of entries scanned for each
+ *                                   lookup, up to 10k addresses
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 22/10/2026 Marko Trickovic
+ * Initial version.
+ *****************************************************************************/
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "../src/l2/mac_table.h"
+
+#define BENCH_AGE       300
+#define BENCH_VLANS     16
+#define BENCH_LIST_MAX  10000
+
+typedef struct bench_addr_ {
+    uint8_t mac[6];
+    uint16_t vlan;
+} bench_addr_t;
+
+typedef struct bench_list_entry_ {
+    glthread_node_t glue;
+    uint64_t key;
+    uint32_t ifindex;
+} bench_list_entry_t;
+
+typedef struct bench_ctx_ {
+    mac_table_t *tbl;
+    uint32_t now;
+    glthread_t lst;
+    bench_addr_t *addrs;
+    bench_addr_t *probe;
+    bench_addr_t *unknown;
+    bench_list_entry_t *list_entries;
+    uint64_t size;
+    volatile uint32_t sink;
+} bench_ctx_t;
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15ull;
+
+static uint64_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static void random_addr(bench_addr_t *a)
+{
+    uint64_t r = rng();
+
+    memcpy(a->mac, &r, 6);
+    a->mac[0] &= 0xfe;
+    a->vlan = (uint16_t)(1 + (r >> 56) % BENCH_VLANS);
+}
+
+// Fills the addresses, a shuffled copy of them and as many unknown ones
+static void make_addrs(bench_ctx_t *ctx, uint64_t n)
+{
+    bench_addr_t tmp;
+    uint64_t i, j;
+
+    for (i = 0; i < n; i++) {
+        random_addr(&ctx->addrs[i]);
+        random_addr(&ctx->unknown[i]);
+    }
+    memcpy(ctx->probe, ctx->addrs, n * sizeof(bench_addr_t));
+    for (i = n; i > 1; i--) {
+        j = rng() % i;
+        tmp = ctx->probe[i - 1];
+        ctx->probe[i - 1] = ctx->probe[j];
+        ctx->probe[j] = tmp;
+    }
+}
+
+typedef enum bench_op_ {
+    OP_LEARN_NEW,
+    OP_LEARN_REFRESH,
+    OP_LOOKUP_HIT,
+    OP_LOOKUP_MISS,
+    OP_AGE_ALL,
+    OP_AGE_1PCT,
+    OP_LOOKUP_LIST
+} bench_op_t;
+
+static void learn_all(mac_table_t *tbl, const bench_addr_t *a, uint64_t n)
+{
+    uint64_t i;
+
+    for (i = 0; i < n; i++)
+        mac_table_learn(tbl, a[i].vlan, a[i].mac, (uint32_t)(i & 63));
+}
+
+static uint64_t lookup_all(bench_ctx_t *ctx, const bench_addr_t *a)
+{
+    uint32_t sum = 0;
+    uint64_t i;
+
+    for (i = 0; i < ctx->size; i++)
+        sum += mac_table_lookup(ctx->tbl, a[i].vlan, a[i].mac);
+    ctx->sink = sum;
+    return ctx->size;
+}
+
+// Looks each address up by scanning a glthread of all of them
+static uint64_t lookup_list(bench_ctx_t *ctx)
+{
+    glthread_t *lst = &ctx->lst;
+    bench_list_entry_t *e;
+    uint32_t sum = 0;
+    uint64_t i, key;
+
+    for (i = 0; i < ctx->size; i++) {
+        key = mac_table_key(ctx->probe[i].vlan, ctx->probe[i].mac);
+        ITERATE_GL_THREADS_BEGIN(lst, bench_list_entry_t, e) {
+            if (e->key == key) {
+                sum += e->ifindex;
+                break;
+            }
+        } ITERATE_GL_THREADS_ENDS;
+    }
+    ctx->sink = sum;
+    return ctx->size;
+}
+
+// Empties the table, learns every address and moves the clock one tick on,
+// where the first keep addresses are learnt again
+static void age_setup(bench_ctx_t *ctx, uint64_t keep)
+{
+    mac_table_advance(ctx->tbl, ctx->now += BENCH_AGE);
+    learn_all(ctx->tbl, ctx->addrs, ctx->size);
+    mac_table_advance(ctx->tbl, ++ctx->now);
+    learn_all(ctx->tbl, ctx->addrs, keep);
+}
+
+static void bench_setup(bench_ctx_t *ctx, bench_op_t op)
+{
+    switch (op) {
+    case OP_LEARN_NEW:
+        mac_table_advance(ctx->tbl, ctx->now += BENCH_AGE);
+        break;
+    case OP_LEARN_REFRESH:
+        mac_table_advance(ctx->tbl, ++ctx->now);
+        break;
+    case OP_AGE_ALL:
+        age_setup(ctx, 0);
+        break;
+    case OP_AGE_1PCT:
+        age_setup(ctx, ctx->size - ctx->size / 100);
+        break;
+    default:
+        break;
+    }
+}
+
+static uint64_t bench_op(bench_ctx_t *ctx, bench_op_t op)
+{
+    switch (op) {
+    case OP_LEARN_NEW:
+    case OP_LEARN_REFRESH:
+        learn_all(ctx->tbl, ctx->addrs, ctx->size);
+        return ctx->size;
+    case OP_LOOKUP_HIT:
+        return lookup_all(ctx, ctx->probe);
+    case OP_LOOKUP_MISS:
+        return lookup_all(ctx, ctx->unknown);
+    case OP_AGE_ALL:
+    case OP_AGE_1PCT:
+        // The addresses not learnt again were learnt BENCH_AGE ticks ago
+        return mac_table_advance(ctx->tbl, ctx->now += BENCH_AGE - 1);
+    case OP_LOOKUP_LIST:
+        return lookup_list(ctx);
+    }
+    return 0;
+}
+
+static void bench_run(bench_report_t *rep, bench_ctx_t *ctx, const char *name,
+                      bench_op_t op)
+{
+    uint64_t ns = 0, cycles = 0, ops = 0, t0, c0;
+
+    do {
+        bench_setup(ctx, op);
+        t0 = bench_now_ns();
+        c0 = bench_cycles();
+        ops += bench_op(ctx, op);
+        cycles += bench_cycles() - c0;
+        ns += bench_now_ns() - t0;
+    } while (ns < rep->opts->min_ns);
+
+    bench_report(rep, name, ctx->size, ops, ns, cycles);
+}
+
+static int bench_size(bench_report_t *rep, bench_ctx_t *ctx)
+{
+    uint64_t n = ctx->size, i;
+
+    ctx->tbl = mac_table_create((uint32_t)n, BENCH_AGE);
+    if (!ctx->tbl)
+        return -1;
+    ctx->now = 0;
+    make_addrs(ctx, n);
+
+    bench_run(rep, ctx, "learn/new", OP_LEARN_NEW);
+    bench_run(rep, ctx, "learn/refresh", OP_LEARN_REFRESH);
+    bench_run(rep, ctx, "lookup/hit", OP_LOOKUP_HIT);
+    bench_run(rep, ctx, "lookup/miss", OP_LOOKUP_MISS);
+    bench_run(rep, ctx, "age/all", OP_AGE_ALL);
+    if (n >= 100)
+        bench_run(rep, ctx, "age/1pct", OP_AGE_1PCT);
+
+    if (n <= BENCH_LIST_MAX) {
+        init_glthread(&ctx->lst, offsetof(bench_list_entry_t, glue));
+        for (i = 0; i < n; i++) {
+            ctx->list_entries[i].key = mac_table_key(ctx->addrs[i].vlan,
+                                                     ctx->addrs[i].mac);
+            ctx->list_entries[i].ifindex = (uint32_t)(i & 63);
+            glthread_add(&ctx->lst, &ctx->list_entries[i].glue);
+        }
+        bench_run(rep, ctx, "lookup/list", OP_LOOKUP_LIST);
+    }
+
+    mac_table_destroy(ctx->tbl);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    bench_opts_t opts;
+    bench_report_t rep;
+    bench_ctx_t ctx;
+    int rc = 0;
+
+    if (bench_parse_args(argc, argv, &opts, 1000000ull) < 0)
+        return 1;
+
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.addrs = malloc(opts.max_size * sizeof(bench_addr_t));
+    ctx.probe = malloc(opts.max_size * sizeof(bench_addr_t));
+    ctx.unknown = malloc(opts.max_size * sizeof(bench_addr_t));
+    ctx.list_entries = malloc(BENCH_LIST_MAX * sizeof(bench_list_entry_t));
+    if (!ctx.addrs || !ctx.probe || !ctx.unknown || !ctx.list_entries)
+        return 1;
+
+    bench_report_begin(&rep, &opts, "mac_table");
+
+    while (!rc && bench_sizes(&opts, &ctx.size))
+        rc |= bench_size(&rep, &ctx);
+
+    bench_report_end(&rep);
+
+    free(ctx.list_entries);
+    free(ctx.unknown);
+    free(ctx.probe);
+    free(ctx.addrs);
+    return rc ? 1 : 0;
+}
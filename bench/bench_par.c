@@ -0,0 +1,181 @@
+/******************************************************************************
+ * @file:        bench_par.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        20/10/2026 09:00 AM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the speedup benchmark for the parallel
+ *               glthread iteration. The workload is an aging sweep over a
+ *               list of --max-size elements (default 10M) allocated in
+ *               shuffled order: every element's timer is decremented, expired
+ *               elements are counted and byte totals are summed. The sweep
+ *               runs once with ITERATE_GL_THREADS_BEGIN as the reference and
+ *               then with glthread_par_for_each at 1, 2, 4 ... threads up to
+ *               --threads (default all online CPUs). ns/op is wall time per
+ *               element and the size column is the thread count.
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 20/10/2026 Marko Trickovic
+ * Initial version.
+ *****************************************************************************/
+
+#include <stdlib.h>
+#include <unistd.h>
+#include "bench.h"
+#include "../src/glthreads/glthreads.h"
+#include "../src/glthreads/glthreads_par.h"
+
+typedef struct bench_entry_ {
+    uint32_t timer;
+    uint32_t bytes;
+    glthread_node_t glnode;
+} bench_entry_t;
+
+typedef struct bench_acc_ {
+    uint64_t expired;
+    uint64_t bytes;
+} bench_acc_t;
+
+static inline void bench_age(bench_entry_t *e, bench_acc_t *acc)
+{
+    if (e->timer && --e->timer == 0)
+        acc->expired++;
+    acc->bytes += e->bytes;
+}
+
+static void bench_visit(void *elem, void *acc, void *arg)
+{
+    (void)arg;
+    bench_age(elem, acc);
+}
+
+static void bench_reduce(void *result, const void *acc, void *arg)
+{
+    bench_acc_t *r = result;
+    const bench_acc_t *a = acc;
+
+    (void)arg;
+    r->expired += a->expired;
+    r->bytes += a->bytes;
+}
+
+static uint64_t bench_rand_state = 0x2545f4914f6cdd1dull;
+
+static uint64_t bench_rand(void)
+{
+    uint64_t x = bench_rand_state;
+
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return bench_rand_state = x;
+}
+
+int main(int argc, char **argv)
+{
+    bench_opts_t opts;
+    bench_report_t rep;
+    bench_entry_t *entries, *e = NULL;
+    glthread_pool_t *pool;
+    glthread_t lst;
+    bench_acc_t acc;
+    uint32_t *perm, tmp;
+    uint64_t n, i, j, t0, c0, reps, r;
+    unsigned int threads, max_threads;
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (bench_parse_args(argc, argv, &opts, 10000000ull) < 0)
+        return 1;
+
+    n = opts.max_size;
+    max_threads = opts.threads ? opts.threads
+                               : (ncpu > 0 ? (unsigned int)ncpu : 1);
+
+    entries = malloc(n * sizeof(*entries));
+    perm = malloc(n * sizeof(*perm));
+    if (!entries || !perm)
+        return 1;
+
+    // Link the entries in shuffled order, as a long-lived table would be
+    for (i = 0; i < n; i++)
+        perm[i] = (uint32_t)i;
+    for (i = n - 1; i > 0; i--) {
+        j = bench_rand() % (i + 1);
+        tmp = perm[i];
+        perm[i] = perm[j];
+        perm[j] = tmp;
+    }
+
+    init_glthread(&lst, offset(bench_entry_t, glnode));
+    for (i = 0; i < n; i++) {
+        entries[perm[i]].timer = (uint32_t)(bench_rand() % 1000) + 1;
+        entries[perm[i]].bytes = (uint32_t)(bench_rand() % 1500);
+        glthread_node_init((&entries[perm[i]].glnode));
+        glthread_add(&lst, &entries[perm[i]].glnode);
+    }
+    free(perm);
+
+    // Enough sweeps per data point to reach the minimum measuring time
+    reps = 1;
+    acc.expired = acc.bytes = 0;
+    t0 = bench_now_ns();
+    ITERATE_GL_THREADS_BEGIN((&lst), bench_entry_t, e)
+    {
+        acc.bytes += e->bytes;
+    }
+    ITERATE_GL_THREADS_ENDS;
+    t0 = bench_now_ns() - t0;
+    if (t0 && t0 < opts.min_ns)
+        reps = opts.min_ns / t0 + 1;
+
+    bench_report_begin(&rep, &opts, "glthreads_par");
+
+    acc.expired = acc.bytes = 0;
+    t0 = bench_now_ns();
+    c0 = bench_cycles();
+    for (r = 0; r < reps; r++) {
+        ITERATE_GL_THREADS_BEGIN((&lst), bench_entry_t, e)
+        {
+            bench_age(e, &acc);
+        }
+        ITERATE_GL_THREADS_ENDS;
+    }
+    bench_report(&rep, "sweep/iterate", 1, n * reps, bench_now_ns() - t0,
+                 bench_cycles() - c0);
+    BENCH_DO_NOT_OPTIMIZE(acc.bytes);
+
+    for (threads = 1; ; threads *= 2) {
+        if (threads > max_threads)
+            threads = max_threads;
+
+        pool = glthread_pool_create(threads - 1);
+        if (!pool)
+            return 1;
+
+        t0 = bench_now_ns();
+        c0 = bench_cycles();
+        for (r = 0; r < reps; r++) {
+            acc.expired = acc.bytes = 0;
+            glthread_par_for_each(threads > 1 ? pool : NULL, &lst,
+                                  bench_visit, NULL, &acc, sizeof(acc),
+                                  bench_reduce);
+        }
+        bench_report(&rep, "sweep/par_for_each", threads, n * reps,
+                     bench_now_ns() - t0, bench_cycles() - c0);
+        BENCH_DO_NOT_OPTIMIZE(acc.bytes);
+
+        glthread_pool_destroy(pool);
+
+        if (threads == max_threads)
+            break;
+    }
+
+    bench_report_end(&rep);
+
+    free(entries);
+    return 0;
+}
@@ -0,0 +1,271 @@
+/******************************************************************************
+ * @file:        bench_pheap.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        20/10/2026 11:00 AM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the benchmark of the pairing heap against
+ *               an array-based binary heap that tracks each element's slot
+ *               index for decrease-key. Two workloads run at sizes from 1k to
+ *               --max-size (default 1M):
+ *
+ *                 - sort:     insert n random keys, then delete-min all of
+ *                             them; ops is n
+ *                 - schedule: insert n keys, then n times delete-min and
+ *                             lower the keys of two random queued elements,
+ *                             as SPF relaxation does; ops is n
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 20/10/2026 Marko Trickovic
+ * Initial version.
+ *****************************************************************************/
+
+#include <stdlib.h>
+#include "bench.h"
+#include "../src/pheap/pheap.h"
+
+typedef struct bench_item_ {
+    uint64_t key;
+    uint32_t bh_idx;        // slot in the binary heap, UINT32_MAX if out
+    uint32_t queued;
+    pheap_node_t hnode;
+} bench_item_t;
+
+typedef struct bench_bheap_ {
+    bench_item_t **slots;
+    uint32_t count;
+} bench_bheap_t;
+
+static uint64_t bench_rand_state = 0x853c49e6748fea9bull;
+
+static uint64_t bench_rand(void)
+{
+    uint64_t x = bench_rand_state;
+
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return bench_rand_state = x;
+}
+
+static int bench_cmp(const void *a, const void *b)
+{
+    const bench_item_t *x = a, *y = b;
+
+    return (x->key > y->key) - (x->key < y->key);
+}
+
+/* Binary heap reference implementation */
+
+static inline void bh_set(bench_bheap_t *h, uint32_t i, bench_item_t *it)
+{
+    h->slots[i] = it;
+    it->bh_idx = i;
+}
+
+static void bh_sift_up(bench_bheap_t *h, uint32_t i)
+{
+    bench_item_t *it = h->slots[i];
+    uint32_t parent;
+
+    while (i) {
+        parent = (i - 1) / 2;
+        if (h->slots[parent]->key <= it->key)
+            break;
+        bh_set(h, i, h->slots[parent]);
+        i = parent;
+    }
+    bh_set(h, i, it);
+}
+
+static void bh_sift_down(bench_bheap_t *h, uint32_t i)
+{
+    bench_item_t *it = h->slots[i];
+    uint32_t child;
+
+    for (;;) {
+        child = 2 * i + 1;
+        if (child >= h->count)
+            break;
+        if (child + 1 < h->count &&
+            h->slots[child + 1]->key < h->slots[child]->key)
+            child++;
+        if (it->key <= h->slots[child]->key)
+            break;
+        bh_set(h, i, h->slots[child]);
+        i = child;
+    }
+    bh_set(h, i, it);
+}
+
+static void bh_insert(bench_bheap_t *h, bench_item_t *it)
+{
+    h->slots[h->count] = it;
+    bh_sift_up(h, h->count++);
+}
+
+static bench_item_t *bh_delete_min(bench_bheap_t *h)
+{
+    bench_item_t *min = h->slots[0];
+
+    if (--h->count) {
+        h->slots[0] = h->slots[h->count];
+        bh_sift_down(h, 0);
+    }
+    min->bh_idx = UINT32_MAX;
+    return min;
+}
+
+/* Workloads */
+
+typedef struct bench_ctx_ {
+    bench_item_t *items;
+    uint64_t *keys;
+    uint64_t n;
+    bench_bheap_t bh;
+    pheap_t ph;
+} bench_ctx_t;
+
+static void bench_reset(bench_ctx_t *ctx)
+{
+    uint64_t i;
+
+    for (i = 0; i < ctx->n; i++) {
+        ctx->items[i].key = ctx->keys[i];
+        ctx->items[i].queued = 1;
+    }
+    ctx->bh.count = 0;
+    init_pheap(&ctx->ph, offsetof(bench_item_t, hnode), bench_cmp);
+}
+
+static void sort_bheap(bench_ctx_t *ctx)
+{
+    uint64_t i, sum = 0;
+
+    for (i = 0; i < ctx->n; i++)
+        bh_insert(&ctx->bh, &ctx->items[i]);
+    for (i = 0; i < ctx->n; i++)
+        sum += bh_delete_min(&ctx->bh)->key;
+    BENCH_DO_NOT_OPTIMIZE(sum);
+}
+
+static void sort_pheap(bench_ctx_t *ctx)
+{
+    uint64_t i, sum = 0;
+    bench_item_t *it;
+
+    for (i = 0; i < ctx->n; i++)
+        pheap_insert(&ctx->ph, &ctx->items[i].hnode);
+    for (i = 0; i < ctx->n; i++) {
+        it = PHEAP_GET_USER_DATA_FROM_OFFSET(pheap_delete_min(&ctx->ph),
+                                             offsetof(bench_item_t, hnode));
+        sum += it->key;
+    }
+    BENCH_DO_NOT_OPTIMIZE(sum);
+}
+
+static void schedule_bheap(bench_ctx_t *ctx)
+{
+    bench_item_t *it;
+    uint64_t i, k;
+
+    for (i = 0; i < ctx->n; i++)
+        bh_insert(&ctx->bh, &ctx->items[i]);
+
+    for (i = 0; i < ctx->n; i++) {
+        it = bh_delete_min(&ctx->bh);
+        it->queued = 0;
+
+        for (k = 0; k < 2; k++) {
+            it = &ctx->items[bench_rand() % ctx->n];
+            if (!it->queued || it->key < 16)
+                continue;
+            it->key -= it->key / 16;
+            bh_sift_up(&ctx->bh, it->bh_idx);
+        }
+    }
+}
+
+static void schedule_pheap(bench_ctx_t *ctx)
+{
+    bench_item_t *it;
+    uint64_t i, k;
+
+    for (i = 0; i < ctx->n; i++)
+        pheap_insert(&ctx->ph, &ctx->items[i].hnode);
+
+    for (i = 0; i < ctx->n; i++) {
+        it = PHEAP_GET_USER_DATA_FROM_OFFSET(pheap_delete_min(&ctx->ph),
+                                             offsetof(bench_item_t, hnode));
+        it->queued = 0;
+
+        for (k = 0; k < 2; k++) {
+            it = &ctx->items[bench_rand() % ctx->n];
+            if (!it->queued || it->key < 16)
+                continue;
+            it->key -= it->key / 16;
+            pheap_decrease_key(&ctx->ph, &it->hnode);
+        }
+    }
+}
+
+static void bench_run(bench_report_t *rep, bench_ctx_t *ctx, const char *name,
+                      void (*fn)(bench_ctx_t *ctx))
+{
+    uint64_t ns = 0, cycles = 0, ops = 0, t0, c0;
+
+    do {
+        bench_reset(ctx);
+        t0 = bench_now_ns();
+        c0 = bench_cycles();
+        fn(ctx);
+        cycles += bench_cycles() - c0;
+        ns += bench_now_ns() - t0;
+        ops += ctx->n;
+    } while (ns < rep->opts->min_ns);
+
+    bench_report(rep, name, ctx->n, ops, ns, cycles);
+}
+
+int main(int argc, char **argv)
+{
+    bench_opts_t opts;
+    bench_report_t rep;
+    bench_ctx_t ctx;
+    uint64_t size = 0, i;
+
+    if (bench_parse_args(argc, argv, &opts, 1000000ull) < 0)
+        return 1;
+    if (opts.min_size < 1000)
+        opts.min_size = 1000;
+
+    ctx.items = malloc(opts.max_size * sizeof(*ctx.items));
+    ctx.keys = malloc(opts.max_size * sizeof(*ctx.keys));
+    ctx.bh.slots = malloc(opts.max_size * sizeof(*ctx.bh.slots));
+    if (!ctx.items || !ctx.keys || !ctx.bh.slots)
+        return 1;
+
+    for (i = 0; i < opts.max_size; i++)
+        ctx.keys[i] = bench_rand() >> 16;
+
+    bench_report_begin(&rep, &opts, "pheap");
+
+    while (bench_sizes(&opts, &size)) {
+        ctx.n = size;
+        bench_run(&rep, &ctx, "sort/binary_heap", sort_bheap);
+        bench_run(&rep, &ctx, "sort/pairing_heap", sort_pheap);
+        bench_run(&rep, &ctx, "schedule/binary_heap", schedule_bheap);
+        bench_run(&rep, &ctx, "schedule/pairing_heap", schedule_pheap);
+    }
+
+    bench_report_end(&rep);
+
+    free(ctx.items);
+    free(ctx.keys);
+    free(ctx.bh.slots);
+    return 0;
+}
@@ -0,0 +1,343 @@
+/******************************************************************************
+ * @file:        bench_pkt_buf.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        21/10/2026 09:00 AM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the benchmark of the packet buffer pool
+ *               with 10 to --max-size (default 100k) packets in flight. Each
+ *               round builds every packet, a 64 byte payload behind a 20 byte
+ *               IPv4 and a 14 byte Ethernet header, then strips both headers
+ *               and frees it; ops is packets:
+ *
+ *                 - cycle/pool:     pkt_buf alloc, put, push, push, pull,
+ *                                   pull, free
+ *                 - cycle/pool_mt:  the same on a PKT_POOL_MT pool
+ *                 - cycle/malloc:   an exactly sized malloc'ed frame, grown
+ *                                   by realloc and memmove for each header
+ *                                   and shrunk by memmove when stripping
+ *                 - clone/pool:     one clone and free per packet in flight
+ *
+ *               Then large packets, one per op, size being the packet length:
+ *
+ *                 - jumbo/chain:    a 9000 byte frame received into a segment
+ *                                   chain through its iovec, its headers
+ *                                   read in place, then freed
+ *                 - jumbo/linear:   the same, linearized into one buffer
+ *                 - reasm/chain:    a 65535 byte datagram reassembled from
+ *                                   1480 byte fragments by appending them
+ *                 - reasm/linear:   the same, copied into one buffer
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 21/10/2026 Marko Trickovic
+ * Initial version.
+ *
+ * Revision 0.2: 21/10/2026 Marko Trickovic
+ * Added the jumbo frame and reassembly cases.
+ *****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "../src/pkt/pkt_buf.h"
+
+#define BENCH_PAYLOAD   64
+#define BENCH_IP_HDR    20
+#define BENCH_ETH_HDR   14
+#define BENCH_BLK_SIZE  2048
+#define BENCH_HEADROOM  128
+#define BENCH_JUMBO     9000
+#define BENCH_DATAGRAM  65535
+#define BENCH_FRAG      1480
+#define BENCH_MAX_SEGS  64
+
+typedef struct bench_frame_ {
+    unsigned char *data;
+    uint32_t len;
+} bench_frame_t;
+
+typedef struct bench_ctx_ {
+    pkt_pool_t *pool;
+    pkt_buf_t **pkts;
+    bench_frame_t *frames;
+    unsigned char *linear;
+    uint64_t n;
+    uint64_t size;
+} bench_ctx_t;
+
+static int cycle_pool(bench_ctx_t *ctx)
+{
+    pkt_buf_t *pkt;
+    uint64_t i, sum = 0;
+
+    for (i = 0; i < ctx->n; i++) {
+        pkt = pkt_buf_alloc(ctx->pool);
+        if (!pkt)
+            return -1;
+        pkt_buf_put(pkt, BENCH_PAYLOAD)[0] = (unsigned char)i;
+        pkt_buf_push(pkt, BENCH_IP_HDR)[0] = 0x45;
+        pkt_buf_push(pkt, BENCH_ETH_HDR)[12] = 0x08;
+        ctx->pkts[i] = pkt;
+    }
+    for (i = 0; i < ctx->n; i++) {
+        pkt = ctx->pkts[i];
+        sum += pkt->data[12];
+        sum += pkt_buf_pull(pkt, BENCH_ETH_HDR)[0];
+        sum += pkt_buf_pull(pkt, BENCH_IP_HDR)[0];
+        pkt_buf_free(pkt);
+    }
+    BENCH_DO_NOT_OPTIMIZE(sum);
+    return 0;
+}
+
+static int frame_push(bench_frame_t *f, uint32_t len)
+{
+    unsigned char *data = realloc(f->data, f->len + len);
+
+    if (!data)
+        return -1;
+    memmove(data + len, data, f->len);
+    f->data = data;
+    f->len += len;
+    return 0;
+}
+
+static void frame_pull(bench_frame_t *f, uint32_t len)
+{
+    f->len -= len;
+    memmove(f->data, f->data + len, f->len);
+}
+
+static int cycle_malloc(bench_ctx_t *ctx)
+{
+    bench_frame_t *f;
+    uint64_t i, sum = 0;
+
+    for (i = 0; i < ctx->n; i++) {
+        f = &ctx->frames[i];
+        f->data = malloc(BENCH_PAYLOAD);
+        if (!f->data)
+            return -1;
+        f->len = BENCH_PAYLOAD;
+        f->data[0] = (unsigned char)i;
+        if (frame_push(f, BENCH_IP_HDR) < 0)
+            return -1;
+        f->data[0] = 0x45;
+        if (frame_push(f, BENCH_ETH_HDR) < 0)
+            return -1;
+        f->data[12] = 0x08;
+    }
+    for (i = 0; i < ctx->n; i++) {
+        f = &ctx->frames[i];
+        sum += f->data[12];
+        frame_pull(f, BENCH_ETH_HDR);
+        sum += f->data[0];
+        frame_pull(f, BENCH_IP_HDR);
+        sum += f->data[0];
+        free(f->data);
+    }
+    BENCH_DO_NOT_OPTIMIZE(sum);
+    return 0;
+}
+
+static int clone_pool(bench_ctx_t *ctx)
+{
+    pkt_buf_t *clone;
+    uint64_t i, sum = 0;
+
+    for (i = 0; i < ctx->n; i++) {
+        clone = pkt_buf_clone(ctx->pkts[i]);
+        if (!clone)
+            return -1;
+        sum += clone->len;
+        pkt_buf_free(clone);
+    }
+    BENCH_DO_NOT_OPTIMIZE(sum);
+    return 0;
+}
+
+// Receives a jumbo frame into a chain, as recvmsg would through the iovec
+static pkt_buf_t *jumbo_rx(bench_ctx_t *ctx)
+{
+    struct iovec iov[BENCH_MAX_SEGS];
+    pkt_buf_t *pkt = pkt_buf_alloc_len(ctx->pool, BENCH_JUMBO);
+    int n, i;
+
+    if (!pkt)
+        return NULL;
+    n = pkt_buf_to_iovec(pkt, iov, BENCH_MAX_SEGS);
+    for (i = 0; i < n; i++)
+        memset(iov[i].iov_base, i, iov[i].iov_len);
+    return pkt;
+}
+
+static int jumbo_chain(bench_ctx_t *ctx)
+{
+    pkt_buf_t *pkt = jumbo_rx(ctx);
+    uint64_t sum;
+
+    if (!pkt)
+        return -1;
+    sum = pkt_buf_may_pull(pkt, BENCH_ETH_HDR + BENCH_IP_HDR)[12];
+    sum += pkt_buf_pull(pkt, BENCH_ETH_HDR)[0];
+    BENCH_DO_NOT_OPTIMIZE(sum);
+    pkt_buf_free(pkt);
+    return 0;
+}
+
+static int jumbo_linear(bench_ctx_t *ctx)
+{
+    pkt_buf_t *pkt = jumbo_rx(ctx), *seg;
+    uint32_t off = 0;
+    uint64_t sum;
+
+    if (!pkt)
+        return -1;
+    ITERATE_PKT_SEGS_BEGIN(pkt, seg) {
+        memcpy(ctx->linear + off, seg->data, seg->len);
+        off += seg->len;
+    } ITERATE_PKT_SEGS_ENDS;
+    sum = ctx->linear[12] + ctx->linear[BENCH_ETH_HDR];
+    BENCH_DO_NOT_OPTIMIZE(sum);
+    pkt_buf_free(pkt);
+    return 0;
+}
+
+// Receives the next fragment of a datagram into a fresh buffer
+static pkt_buf_t *reasm_frag(bench_ctx_t *ctx, uint32_t off)
+{
+    uint32_t len = BENCH_DATAGRAM - off < BENCH_FRAG ? BENCH_DATAGRAM - off
+                                                     : BENCH_FRAG;
+    pkt_buf_t *frag = pkt_buf_alloc(ctx->pool);
+
+    if (frag)
+        memset(pkt_buf_put(frag, len), (int)off, len);
+    return frag;
+}
+
+static int reasm_chain(bench_ctx_t *ctx)
+{
+    struct iovec iov[BENCH_MAX_SEGS];
+    pkt_buf_t *pkt = NULL, *frag;
+    uint32_t off;
+
+    for (off = 0; off < BENCH_DATAGRAM; off += BENCH_FRAG) {
+        frag = reasm_frag(ctx, off);
+        if (!frag) {
+            pkt_buf_free(pkt);
+            return -1;
+        }
+        if (pkt)
+            pkt_buf_append(pkt, frag);
+        else
+            pkt = frag;
+    }
+    BENCH_DO_NOT_OPTIMIZE(pkt_buf_to_iovec(pkt, iov, BENCH_MAX_SEGS));
+    pkt_buf_free(pkt);
+    return 0;
+}
+
+static int reasm_linear(bench_ctx_t *ctx)
+{
+    pkt_buf_t *frag;
+    uint32_t off;
+
+    for (off = 0; off < BENCH_DATAGRAM; off += BENCH_FRAG) {
+        frag = reasm_frag(ctx, off);
+        if (!frag)
+            return -1;
+        memcpy(ctx->linear + off, frag->data, frag->len);
+        pkt_buf_free(frag);
+    }
+    BENCH_DO_NOT_OPTIMIZE(ctx->linear[0]);
+    return 0;
+}
+
+static int bench_run(bench_report_t *rep, bench_ctx_t *ctx, const char *name,
+                     int (*fn)(bench_ctx_t *ctx))
+{
+    uint64_t ns = 0, cycles = 0, ops = 0, t0, c0;
+    int rc;
+
+    do {
+        t0 = bench_now_ns();
+        c0 = bench_cycles();
+        rc = fn(ctx);
+        cycles += bench_cycles() - c0;
+        ns += bench_now_ns() - t0;
+        if (rc < 0)
+            return -1;
+        ops += ctx->n;
+    } while (ns < rep->opts->min_ns);
+
+    bench_report(rep, name, ctx->size, ops, ns, cycles);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    bench_opts_t opts;
+    bench_report_t rep;
+    bench_ctx_t ctx;
+    pkt_pool_t *pool_st, *pool_mt;
+    uint64_t size = 0, i;
+    int rc = 0;
+
+    if (bench_parse_args(argc, argv, &opts, 100000ull) < 0)
+        return 1;
+    if (opts.min_size < 10)
+        opts.min_size = 10;
+
+    pool_st = pkt_pool_create(opts.max_size, BENCH_BLK_SIZE, BENCH_HEADROOM, 0);
+    pool_mt = pkt_pool_create(opts.max_size, BENCH_BLK_SIZE, BENCH_HEADROOM,
+                              PKT_POOL_MT);
+    ctx.pkts = malloc(opts.max_size * sizeof(*ctx.pkts));
+    ctx.frames = malloc(opts.max_size * sizeof(*ctx.frames));
+    ctx.linear = malloc(BENCH_DATAGRAM);
+    if (!pool_st || !pool_mt || !ctx.pkts || !ctx.frames || !ctx.linear)
+        return 1;
+
+    bench_report_begin(&rep, &opts, "pkt_buf");
+
+    while (!rc && bench_sizes(&opts, &size)) {
+        ctx.n = ctx.size = size;
+        ctx.pool = pool_st;
+        rc |= bench_run(&rep, &ctx, "cycle/pool", cycle_pool);
+        ctx.pool = pool_mt;
+        rc |= bench_run(&rep, &ctx, "cycle/pool_mt", cycle_pool);
+        rc |= bench_run(&rep, &ctx, "cycle/malloc", cycle_malloc);
+
+        ctx.pool = pool_st;
+        for (i = 0; i < size; i++) {
+            ctx.pkts[i] = pkt_buf_alloc(pool_st);
+            pkt_buf_put(ctx.pkts[i], BENCH_PAYLOAD);
+        }
+        rc |= bench_run(&rep, &ctx, "clone/pool", clone_pool);
+        for (i = 0; i < size; i++)
+            pkt_buf_free(ctx.pkts[i]);
+    }
+
+    ctx.n = 1;
+    ctx.pool = pool_st;
+    if (!rc && opts.max_size >= BENCH_MAX_SEGS) {
+        ctx.size = BENCH_JUMBO;
+        rc |= bench_run(&rep, &ctx, "jumbo/chain", jumbo_chain);
+        rc |= bench_run(&rep, &ctx, "jumbo/linear", jumbo_linear);
+        ctx.size = BENCH_DATAGRAM;
+        rc |= bench_run(&rep, &ctx, "reasm/chain", reasm_chain);
+        rc |= bench_run(&rep, &ctx, "reasm/linear", reasm_linear);
+    }
+
+    bench_report_end(&rep);
+
+    pkt_pool_destroy(pool_st);
+    pkt_pool_destroy(pool_mt);
+    free(ctx.pkts);
+    free(ctx.frames);
+    free(ctx.linear);
+    return rc ? 1 : 0;
+}
@@ -0,0 +1,191 @@
+/******************************************************************************
+ * @file:        bench_reloc.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        20/10/2026 02:00 PM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the warm restart benchmark for relocatable
+ *               glthread arenas. For each size from 1k to --max-size (default
+ *               1M) an arena file with that many linked 64-byte objects is
+ *               written once, then two ways of getting the list back are
+ *               timed:
+ *
+ *                 - restart/rebuild:  malloc and glthread_add every object,
+ *                                     then walk the list, as a process
+ *                                     rebuilding its state from scratch
+ *                 - restart/arena:    mmap the arena file privately, find the
+ *                                     list root and walk it
+ *
+ *               ops is the number of objects, so ns/op is the restart cost
+ *               per object. The file is read from the page cache; a cold
+ *               start adds the disk read on top of restart/arena.
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 20/10/2026 Marko Trickovic
+ * Initial version.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "bench.h"
+#include "../src/glthreads/glthreads.h"
+#include "../src/glthreads/glthreads_reloc.h"
+
+typedef struct bench_obj_ {
+    uint64_t key;
+    uint64_t pad[5];
+    glthread_rel_node_t glnode;
+} bench_obj_t;
+
+typedef struct bench_heap_obj_ {
+    uint64_t key;
+    uint64_t pad[5];
+    glthread_node_t glnode;
+} bench_heap_obj_t;
+
+static int bench_write_arena(const char *path, uint64_t n)
+{
+    glthread_arena_t arena;
+    glthread_rel_t *lst;
+    bench_obj_t *obj;
+    uint64_t i;
+
+    if (glthread_arena_create(&arena, path,
+                              4096 + (n + 1) * sizeof(bench_obj_t)) < 0)
+        return -1;
+
+    lst = glthread_arena_alloc(&arena, sizeof(*lst));
+    init_glthread_rel(lst, offsetof(bench_obj_t, glnode));
+    glthread_arena_set_root(&arena, 0, lst);
+
+    for (i = 0; i < n; i++) {
+        obj = glthread_arena_alloc(&arena, sizeof(*obj));
+        obj->key = i;
+        glthread_rel_add(lst, &obj->glnode);
+    }
+
+    glthread_arena_sync(&arena);
+    glthread_arena_close(&arena);
+    return 0;
+}
+
+static glthread_node_t *restart_rebuild(uint64_t n)
+{
+    glthread_t lst, *lstp = &lst;
+    bench_heap_obj_t *obj;
+    uint64_t i, sum = 0;
+
+    init_glthread(&lst, offset(bench_heap_obj_t, glnode));
+    for (i = 0; i < n; i++) {
+        obj = calloc(1, sizeof(*obj));
+        obj->key = i;
+        glthread_add(&lst, &obj->glnode);
+    }
+
+    ITERATE_GL_THREADS_BEGIN(lstp, bench_heap_obj_t, obj) {
+        sum += obj->key;
+    } ITERATE_GL_THREADS_ENDS;
+
+    // Teardown is not part of a restart
+    BENCH_DO_NOT_OPTIMIZE(sum);
+    return lst.head;
+}
+
+static void rebuild_free(glthread_node_t *head)
+{
+    glthread_node_t *next;
+
+    for (; head; head = next) {
+        next = head->right;
+        free(GLTHREAD_GET_USER_DATA_FROM_OFFSET(
+            head, offset(bench_heap_obj_t, glnode)));
+    }
+}
+
+static int restart_arena(const char *path, glthread_arena_t *arena)
+{
+    glthread_rel_t *lst;
+    bench_obj_t *obj;
+    uint64_t sum = 0;
+
+    if (glthread_arena_open(arena, path, GLTHREAD_ARENA_PRIVATE) < 0)
+        return -1;
+
+    lst = glthread_arena_get_root(arena, 0);
+    ITERATE_GL_THREADS_REL_BEGIN(lst, bench_obj_t, obj) {
+        sum += obj->key;
+    } ITERATE_GL_THREADS_REL_ENDS;
+
+    BENCH_DO_NOT_OPTIMIZE(sum);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    char path[] = "/tmp/bench_reloc_XXXXXX";
+    glthread_arena_t arena;
+    bench_opts_t opts;
+    bench_report_t rep;
+    uint64_t size = 0, ns, cycles, ops, t0, c0;
+    glthread_node_t *head;
+    int fd;
+
+    if (bench_parse_args(argc, argv, &opts, 1000000ull) < 0)
+        return 1;
+    if (opts.min_size < 1000)
+        opts.min_size = 1000;
+
+    fd = mkstemp(path);
+    if (fd < 0) {
+        perror("mkstemp");
+        return 1;
+    }
+    close(fd);
+
+    bench_report_begin(&rep, &opts, "reloc");
+
+    while (bench_sizes(&opts, &size)) {
+        if (bench_write_arena(path, size) < 0) {
+            perror(path);
+            unlink(path);
+            return 1;
+        }
+
+        ns = cycles = ops = 0;
+        do {
+            t0 = bench_now_ns();
+            c0 = bench_cycles();
+            head = restart_rebuild(size);
+            cycles += bench_cycles() - c0;
+            ns += bench_now_ns() - t0;
+            ops += size;
+            rebuild_free(head);
+        } while (ns < opts.min_ns);
+        bench_report(&rep, "restart/rebuild", size, ops, ns, cycles);
+
+        ns = cycles = ops = 0;
+        do {
+            t0 = bench_now_ns();
+            c0 = bench_cycles();
+            if (restart_arena(path, &arena) < 0) {
+                perror(path);
+                unlink(path);
+                return 1;
+            }
+            cycles += bench_cycles() - c0;
+            ns += bench_now_ns() - t0;
+            ops += size;
+            glthread_arena_close(&arena);
+        } while (ns < opts.min_ns);
+        bench_report(&rep, "restart/arena", size, ops, ns, cycles);
+    }
+
+    bench_report_end(&rep);
+    unlink(path);
+    return 0;
+}
@@ -0,0 +1,175 @@
+/******************************************************************************
+ * @file:        bench_shard.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        19/10/2026 04:00 PM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the scaling benchmark for the sharded
+ *               glthread pool. Each thread repeatedly pops an object from the
+ *               pool and pushes it back, first on a single glthread_t behind
+ *               one mutex and then on a glthread_sharded_t. The size column is
+ *               the thread count and ns/op is wall time divided by the total
+ *               number of pop+push pairs, so perfect scaling halves it every
+ *               time the thread count doubles.
+ *
+ *               --max-size sets the pop+push pairs per thread (default 1M),
+ *               --threads caps the thread count (default all online CPUs).
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 19/10/2026 Marko Trickovic
+ * Initial version.
+ *****************************************************************************/
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "bench.h"
+#include "../src/glthreads/glthreads.h"
+#include "../src/glthreads/glthreads_shard.h"
+
+#define BENCH_OBJECTS_PER_THREAD    256
+
+typedef struct bench_obj_ {
+    uint64_t payload[4];
+    glthread_node_t glnode;
+} bench_obj_t;
+
+typedef struct bench_shared_ {
+    pthread_mutex_t lock;
+    glthread_t list;
+    glthread_sharded_t sharded;
+    pthread_barrier_t start;
+    uint64_t ops;
+    int use_sharded;
+} bench_shared_t;
+
+static bench_shared_t shared;
+
+static glthread_node_t *bench_pop(void)
+{
+    glthread_node_t *node;
+
+    if (shared.use_sharded)
+        return glthread_sharded_pop(&shared.sharded);
+
+    pthread_mutex_lock(&shared.lock);
+    node = shared.list.head;
+    if (node)
+        glthread_remove(&shared.list, node);
+    pthread_mutex_unlock(&shared.lock);
+    return node;
+}
+
+static void bench_push(glthread_node_t *node)
+{
+    if (shared.use_sharded) {
+        glthread_sharded_push(&shared.sharded, node);
+        return;
+    }
+
+    pthread_mutex_lock(&shared.lock);
+    glthread_add(&shared.list, node);
+    pthread_mutex_unlock(&shared.lock);
+}
+
+static void *bench_worker(void *arg)
+{
+    glthread_node_t *node;
+    uint64_t i;
+
+    (void)arg;
+    pthread_barrier_wait(&shared.start);
+
+    for (i = 0; i < shared.ops; i++) {
+        node = bench_pop();
+        if (!node)
+            continue;
+        ((bench_obj_t *)GLTHREAD_GET_USER_DATA_FROM_OFFSET(
+            node, offset(bench_obj_t, glnode)))->payload[0]++;
+        bench_push(node);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief      Runs one configuration with a given number of threads.
+ */
+static void bench_run(bench_report_t *rep, const char *name,
+                      unsigned int threads, bench_obj_t *objs)
+{
+    pthread_t *tid = calloc(threads, sizeof(*tid));
+    uint64_t t0, c0, ns, cycles;
+    unsigned int i, nobjs = threads * BENCH_OBJECTS_PER_THREAD;
+
+    init_glthread(&shared.list, offset(bench_obj_t, glnode));
+    glthread_sharded_init(&shared.sharded, offset(bench_obj_t, glnode), 0);
+    for (i = 0; i < nobjs; i++) {
+        glthread_node_init((&objs[i].glnode));
+        bench_push(&objs[i].glnode);
+    }
+
+    pthread_barrier_init(&shared.start, NULL, threads + 1);
+    for (i = 0; i < threads; i++)
+        pthread_create(&tid[i], NULL, bench_worker, NULL);
+
+    t0 = bench_now_ns();
+    c0 = bench_cycles();
+    pthread_barrier_wait(&shared.start);
+    for (i = 0; i < threads; i++)
+        pthread_join(tid[i], NULL);
+    cycles = bench_cycles() - c0;
+    ns = bench_now_ns() - t0;
+
+    bench_report(rep, name, threads, shared.ops * threads, ns, cycles);
+
+    pthread_barrier_destroy(&shared.start);
+    glthread_sharded_destroy(&shared.sharded);
+    free(tid);
+}
+
+int main(int argc, char **argv)
+{
+    bench_opts_t opts;
+    bench_report_t rep;
+    bench_obj_t *objs;
+    unsigned int max_threads, threads;
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (bench_parse_args(argc, argv, &opts, 1000000ull) < 0)
+        return 1;
+
+    max_threads = opts.threads ? opts.threads
+                               : (ncpu > 0 ? (unsigned int)ncpu : 1);
+    shared.ops = opts.max_size;
+    pthread_mutex_init(&shared.lock, NULL);
+
+    objs = calloc((size_t)max_threads * BENCH_OBJECTS_PER_THREAD,
+                  sizeof(*objs));
+    if (!objs)
+        return 1;
+
+    bench_report_begin(&rep, &opts, "glthreads_shard");
+
+    for (threads = 1; ; threads *= 2) {
+        if (threads > max_threads)
+            threads = max_threads;
+
+        shared.use_sharded = 0;
+        bench_run(&rep, "pool/single-mutex", threads, objs);
+        shared.use_sharded = 1;
+        bench_run(&rep, "pool/sharded", threads, objs);
+
+        if (threads == max_threads)
+            break;
+    }
+
+    bench_report_end(&rep);
+
+    free(objs);
+    return 0;
+}
@@ -0,0 +1,107 @@
+/******************************************************************************
+ * @file:        bench_topo_loader.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        20/10/2026 06:00 PM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the benchmark of the topology file loader.
+ *               For each size from 1k to --max-size (default 1M) links, a file
+ *               with size / 5 nodes is written once, each node linked to the
+ *               five that follow it around a ring, then load_topology_file is
+ *               timed reading it from the page cache. ops is links, so the
+ *               time to load 1M links is 1M x ns/op.
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 20/10/2026 Marko Trickovic
+ * Initial version.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "bench.h"
+#include "../src/graph/topo_loader.h"
+
+#define BENCH_DEGREE    5
+
+static int bench_write_topology(const char *path, uint64_t nlinks)
+{
+    uint64_t nnodes = nlinks / BENCH_DEGREE, i, k;
+    FILE *fp = fopen(path, "w");
+
+    if (!fp)
+        return -1;
+
+    fprintf(fp, "topology bench %llu %llu\n", (unsigned long long)nnodes,
+            (unsigned long long)nlinks);
+    for (i = 0; i < nnodes; i++)
+        fprintf(fp, "node %llu R%llu\n", (unsigned long long)i,
+                (unsigned long long)i);
+    for (i = 0; i < nnodes; i++)
+        for (k = 1; k <= BENCH_DEGREE; k++)
+            fprintf(fp, "link %llu eth0/%llu %llu eth1/%llu %llu\n",
+                    (unsigned long long)i, (unsigned long long)k,
+                    (unsigned long long)((i + k) % nnodes),
+                    (unsigned long long)k, (unsigned long long)k);
+
+    return fclose(fp);
+}
+
+int main(int argc, char **argv)
+{
+    char path[] = "/tmp/bench_topo_XXXXXX";
+    topo_load_err_t err;
+    bench_opts_t opts;
+    bench_report_t rep;
+    graph_t *topo;
+    uint64_t size = 0, ns, cycles, ops, t0, c0;
+    int fd;
+
+    if (bench_parse_args(argc, argv, &opts, 1000000ull) < 0)
+        return 1;
+    if (opts.min_size < 1000)
+        opts.min_size = 1000;
+
+    fd = mkstemp(path);
+    if (fd < 0) {
+        perror("mkstemp");
+        return 1;
+    }
+    close(fd);
+
+    bench_report_begin(&rep, &opts, "topo_loader");
+
+    while (bench_sizes(&opts, &size)) {
+        if (bench_write_topology(path, size) < 0) {
+            perror(path);
+            break;
+        }
+
+        ns = cycles = ops = 0;
+        do {
+            t0 = bench_now_ns();
+            c0 = bench_cycles();
+            topo = load_topology_file(path, &err);
+            cycles += bench_cycles() - c0;
+            ns += bench_now_ns() - t0;
+            ops += size;
+
+            if (!topo) {
+                fprintf(stderr, "%s:%lu: %s\n", path, err.line, err.msg);
+                unlink(path);
+                return 1;
+            }
+            destroy_graph(topo);
+        } while (ns < opts.min_ns);
+
+        bench_report(&rep, "load", size, ops, ns, cycles);
+    }
+
+    bench_report_end(&rep);
+    unlink(path);
+    return 0;
+}
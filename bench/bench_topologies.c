@@ -0,0 +1,110 @@
+/******************************************************************************
+ * @file:        bench_topologies.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        20/10/2026 08:00 PM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the benchmark of the topology generators
+ *               for sizes from 1k to --max-size (default 1M) nodes. ops is
+ *               nodes, so ns/op is the build cost per node:
+ *
+ *                 - line, ring:        n nodes
+ *                 - grid:              the largest square of at most n nodes
+ *                 - random_regular/4:  n nodes of degree 4, seed 1
+ *                 - fat_tree:          k = MAX_INTF_PER_NODE, whatever n is
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 20/10/2026 Marko Trickovic
+ * Initial version.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include "bench.h"
+#include "../src/graph/topologies.h"
+
+typedef enum bench_kind_ {
+    BENCH_LINE,
+    BENCH_RING,
+    BENCH_GRID,
+    BENCH_RANDOM_REGULAR,
+    BENCH_FAT_TREE,
+} bench_kind_t;
+
+static graph_t *bench_build(bench_kind_t kind, uint64_t n)
+{
+    uint32_t side;
+
+    switch (kind) {
+    case BENCH_LINE:
+        return build_line_topo((uint32_t)n);
+    case BENCH_RING:
+        return build_ring_topo((uint32_t)n);
+    case BENCH_GRID:
+        for (side = 1; (uint64_t)(side + 1) * (side + 1) <= n; side++)
+            ;
+        return build_grid_topo(side, side);
+    case BENCH_RANDOM_REGULAR:
+        return build_random_regular_topo((uint32_t)n, 4, 1);
+    case BENCH_FAT_TREE:
+        return build_fat_tree_topo(MAX_INTF_PER_NODE & ~1u);
+    }
+    return NULL;
+}
+
+static int bench_run(bench_report_t *rep, const char *name, bench_kind_t kind,
+                     uint64_t n)
+{
+    uint64_t ns = 0, cycles = 0, ops = 0, t0, c0;
+    graph_t *topo;
+
+    do {
+        t0 = bench_now_ns();
+        c0 = bench_cycles();
+        topo = bench_build(kind, n);
+        cycles += bench_cycles() - c0;
+        ns += bench_now_ns() - t0;
+
+        if (!topo) {
+            fprintf(stderr, "%s: cannot build %llu nodes\n", name,
+                    (unsigned long long)n);
+            return -1;
+        }
+        ops += topo->node_count;
+        destroy_graph(topo);
+    } while (ns < rep->opts->min_ns);
+
+    bench_report(rep, name, n, ops, ns, cycles);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    bench_opts_t opts;
+    bench_report_t rep;
+    uint64_t size = 0, k = MAX_INTF_PER_NODE & ~1u;
+    int rc = 0;
+
+    if (bench_parse_args(argc, argv, &opts, 1000000ull) < 0)
+        return 1;
+    if (opts.min_size < 1000)
+        opts.min_size = 1000;
+
+    bench_report_begin(&rep, &opts, "topologies");
+
+    while (!rc && bench_sizes(&opts, &size)) {
+        rc |= bench_run(&rep, "line", BENCH_LINE, size);
+        rc |= bench_run(&rep, "ring", BENCH_RING, size);
+        rc |= bench_run(&rep, "grid", BENCH_GRID, size);
+        rc |= bench_run(&rep, "random_regular/4", BENCH_RANDOM_REGULAR, size);
+    }
+    if (!rc)
+        rc = bench_run(&rep, "fat_tree", BENCH_FAT_TREE,
+                       5 * k * k / 4 + k * k * k / 4);
+
+    bench_report_end(&rep);
+    return rc ? 1 : 0;
+}
@@ -0,0 +1,224 @@
+/******************************************************************************
+ * @file:        bench_vnet_dp.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        22/10/2026 01:00 AM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the scaling benchmark of the multi-worker
+ *               dataplane. Every worker forwards through its own vnet_t of a
+ *               router with two interfaces, as in bench_vnet. A round builds
+ *               BENCH_FRAMES 64-byte UDP frames of BENCH_FLOWS flows,
+ *               untimed, and times dispatching, flushing and waiting for
+ *               them; ops is frames and the size column is the worker
+ *               count, so perfect scaling halves ns/op every time the
+ *               workers double:
+ *
+ *                 - vnet_dp/ip4:  IPv4 frames forwarded out of the other
+ *                                 interface
+ *
+ *               --threads caps the worker count (default all online CPUs).
+ *               The speedup over one worker and the frames each worker got
+ *               go to stderr.
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 22/10/2026 Marko Trickovic
+ * Initial version.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "bench.h"
+#include "../src/vnet/vnet.h"
+#include "../src/vnet/vnet_dp.h"
+#include "../src/graph/topologies.h"
+
+#define BENCH_FRAMES    4096
+#define BENCH_FLOWS     1024
+#define BENCH_LEN       64
+#define BENCH_BLKS      8192
+#define BENCH_BLK_SIZE  256
+#define BENCH_HEADROOM  64
+#define BENCH_MAX_WORKERS 64
+#define IP(a, b, c, d)  ((uint32_t)(a) << 24 | (b) << 16 | (c) << 8 | (d))
+
+static const uint8_t mac0[6] = { 0x02, 0, 0, 0, 1, 0 };
+static const uint8_t mac1[6] = { 0x02, 0, 0, 0, 1, 1 };
+static const uint8_t peer0[6] = { 0x02, 0, 0, 0, 0, 1 };
+static const uint8_t peer2[6] = { 0x02, 0, 0, 0, 2, 0 };
+
+typedef struct bench_ctx_ {
+    pkt_pool_t *pool;
+    node_t *r1;
+    interface_t *rx;
+    interface_t *tx;
+    vnet_t *vn[BENCH_MAX_WORKERS];
+    unsigned char frame[BENCH_LEN];
+    pkt_buf_t *pkts[BENCH_FRAMES];
+} bench_ctx_t;
+
+static void put16(unsigned char *p, uint16_t v)
+{
+    p[0] = (unsigned char)(v >> 8);
+    p[1] = (unsigned char)v;
+}
+
+static void put32(unsigned char *p, uint32_t v)
+{
+    put16(p, (uint16_t)(v >> 16));
+    put16(p + 2, (uint16_t)v);
+}
+
+// Fills in the frame template, IPv4 checksum included
+static void make_template(bench_ctx_t *ctx)
+{
+    unsigned char *p = ctx->frame, *ip = p + 14;
+    uint32_t sum = 0, i;
+
+    memcpy(p, mac0, 6);
+    memcpy(p + 6, peer0, 6);
+    put16(p + 12, 0x0800);
+    ip[0] = 0x45;
+    put16(ip + 2, 46);
+    ip[8] = 64;
+    ip[9] = 17;
+    put32(ip + 12, IP(10, 0, 0, 2));
+    put32(ip + 16, IP(10, 2, 0, 1));
+    for (i = 0; i < 20; i += 2)
+        sum += (uint32_t)(ip[i] << 8 | ip[i + 1]);
+    sum = (sum & 0xffff) + (sum >> 16);
+    put16(ip + 10, (uint16_t)~sum);
+    put16(ip + 22, 53);
+    put16(ip + 24, 26);
+}
+
+// Forwards a vector on the worker's router and frees what it sent
+static void forward(void *arg, uint32_t worker, pkt_buf_t **pkts, uint32_t n)
+{
+    bench_ctx_t *ctx = arg;
+    vnet_t *vn = ctx->vn[worker];
+
+    vnet_input(vn, ctx->rx, pkts, n);
+    pkt_queue_flush(&vnet_get_intf(vn, ctx->rx)->txq);
+    pkt_queue_flush(&vnet_get_intf(vn, ctx->tx)->txq);
+}
+
+// Allocates the frames of a round, flow i % BENCH_FLOWS in source port
+static int build_round(bench_ctx_t *ctx)
+{
+    unsigned char *p;
+    uint32_t i;
+
+    if (pkt_buf_alloc_bulk(ctx->pool, ctx->pkts, BENCH_FRAMES) !=
+        BENCH_FRAMES)
+        return -1;
+
+    for (i = 0; i < BENCH_FRAMES; i++) {
+        p = pkt_buf_put(ctx->pkts[i], BENCH_LEN);
+        memcpy(p, ctx->frame, BENCH_LEN);
+        put16(p + 34, (uint16_t)(1024 + i % BENCH_FLOWS));
+    }
+    return 0;
+}
+
+static int bench_run(bench_report_t *rep, bench_ctx_t *ctx, const char *name,
+                     uint32_t workers, double *base)
+{
+    uint64_t ns = 0, cycles = 0, ops = 0, t0, c0;
+    vnet_dp_t *dp;
+    uint32_t i;
+
+    for (i = 0; i < workers; i++) {
+        ctx->vn[i] = vnet_create(ctx->r1, BENCH_FRAMES);
+        if (!ctx->vn[i] ||
+            vnet_intf_set(ctx->vn[i], ctx->rx, mac0, IP(10, 0, 0, 1),
+                          24) < 0 ||
+            vnet_intf_set(ctx->vn[i], ctx->tx, mac1, IP(10, 0, 1, 1),
+                          24) < 0 ||
+            vnet_route_add(ctx->vn[i], IP(10, 2, 0, 0), 16, ctx->tx,
+                           peer2) < 0)
+            return -1;
+    }
+    dp = vnet_dp_create(workers, forward, ctx, 0);
+    if (!dp)
+        return -1;
+
+    do {
+        if (build_round(ctx) < 0)
+            return -1;
+        t0 = bench_now_ns();
+        c0 = bench_cycles();
+        vnet_dp_dispatch(dp, ctx->pkts, BENCH_FRAMES);
+        vnet_dp_flush(dp);
+        vnet_dp_wait(dp);
+        cycles += bench_cycles() - c0;
+        ns += bench_now_ns() - t0;
+        ops += BENCH_FRAMES;
+    } while (ns < rep->opts->min_ns);
+
+    bench_report(rep, name, workers, ops, ns, cycles);
+    if (workers == 1)
+        *base = (double)ns / ops;
+    fprintf(stderr, "%s/%u: x%.2f against 1 worker, frames", name,
+            workers, *base * ops / ns);
+    for (i = 0; i < workers; i++)
+        fprintf(stderr, " %llu",
+                (unsigned long long)dp->workers[i].done);
+    fprintf(stderr, "\n");
+
+    vnet_dp_destroy(dp);
+    for (i = 0; i < workers; i++)
+        vnet_destroy(ctx->vn[i]);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned int max_workers, workers;
+    bench_opts_t opts;
+    bench_report_t rep;
+    bench_ctx_t ctx;
+    graph_t *topo;
+    double base = 0;
+    int rc = 0;
+
+    if (bench_parse_args(argc, argv, &opts, BENCH_FRAMES) < 0)
+        return 1;
+
+    max_workers = opts.threads ? opts.threads
+                               : (ncpu > 0 ? (unsigned int)ncpu : 1);
+    if (max_workers > BENCH_MAX_WORKERS)
+        max_workers = BENCH_MAX_WORKERS;
+
+    memset(&ctx, 0, sizeof(ctx));
+    topo = build_line_topo(3);
+    ctx.pool = pkt_pool_create(BENCH_BLKS, BENCH_BLK_SIZE, BENCH_HEADROOM,
+                               PKT_POOL_MT);
+    if (!topo || !ctx.pool)
+        return 1;
+    ctx.r1 = get_node_by_node_name(topo, "R1");
+    ctx.rx = get_node_intf_by_name(ctx.r1, "eth0");
+    ctx.tx = get_node_intf_by_name(ctx.r1, "eth1");
+    make_template(&ctx);
+
+    bench_report_begin(&rep, &opts, "vnet_dp");
+
+    for (workers = 1; !rc; workers *= 2) {
+        if (workers > max_workers)
+            workers = max_workers;
+        rc |= bench_run(&rep, &ctx, "vnet_dp/ip4", workers, &base);
+        if (workers == max_workers)
+            break;
+    }
+
+    bench_report_end(&rep);
+
+    pkt_pool_destroy(ctx.pool);
+    destroy_graph(topo);
+    return rc ? 1 : 0;
+}
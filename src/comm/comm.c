@@ -0,0 +1,837 @@
+/******************************************************************************
+ * @file:        comm.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        21/10/2026 11:00 AM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the loopback UDP link transport. Sockets
+ *               are non-blocking and watched level-triggered, so a receive
+ *               thread reads at most COMM_RX_BUDGET frames from a socket
+ *               before going back to epoll_wait, which keeps one busy link
+ *               from starving the other interfaces of the node. Frames are
+ *               read straight into pool buffers through their iovec,
+ *               gathered in a local queue and spliced onto the interface
+ *               queue under one lock acquisition per burst. The consumer is
+ *               only signalled when the queue goes from empty to non-empty.
+ *               A burst is one recvmmsg over buffers taken from the pool
+ *               under one lock; the number offered grows while bursts come
+ *               back full and shrinks when they do not, so an idle link does
+ *               not churn 64 buffers per frame. Queued TX frames are sent by
+ *               peeking at the head of the queue, so frames the socket
+ *               refuses with EAGAIN keep their place. With COMM_URING the
+ *               node threads and epoll instances are not created and start,
+ *               stop and flush go to comm_uring.c.
+ *
+ *               Functions in this file:
+ *                 - comm_create
+ *                 - comm_start
+ *                 - comm_stop
+ *                 - comm_destroy
+ *                 - comm_send
+ *                 - comm_enqueue
+ *                 - comm_flush
+ *                 - comm_recv
+ *                 - comm_recv_burst
+ *                 - comm_rx_deliver
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 21/10/2026 Marko Trickovic
+ * Initial version with UDP sockets per interface and an epoll receive thread
+ * per node.
+ *
+ * Revision 0.2: 21/10/2026 Marko Trickovic
+ * Added TX queues flushed with sendmmsg, recvmmsg receive bursts and syscall
+ * counters.
+ *
+ * Revision 0.3: 21/10/2026 Marko Trickovic
+ * Dispatch to the io_uring backend with COMM_URING, comm_rx_deliver shared
+ * with it.
+ *****************************************************************************/
+
+#ifndef COMM_C
+#define COMM_C
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include "comm.h"
+#include "comm_uring.h"
+
+/* recvmmsg vectors of one receive thread, max_segs iovecs per message. */
+typedef struct comm_rx_batch_ {
+    struct mmsghdr msgs[COMM_RX_BUDGET];
+    pkt_buf_t *pkts[COMM_RX_BUDGET];
+    uint32_t want;
+    struct iovec iov[];
+} comm_rx_batch_t;
+
+/**
+ * @brief      Opens the socket of an interface and binds it to an ephemeral
+ *             loopback port.
+ *
+ * @param[in]  ci  Interface state.
+ *
+ * @return     0 on success, -1 with errno set.
+ */
+static int comm_intf_open(comm_intf_t *ci)
+{
+    struct sockaddr_in addr = { .sin_family = AF_INET };
+    socklen_t addrlen = sizeof(addr);
+    int size = COMM_SOCK_BUF;
+
+    ci->fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (ci->fd < 0)
+        return -1;
+
+    // Best effort, without privileges the size is capped by rmem_max
+    setsockopt(ci->fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    setsockopt(ci->fd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(ci->fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        getsockname(ci->fd, (struct sockaddr *)&addr, &addrlen) < 0)
+        return -1;
+
+    ci->port = ntohs(addr.sin_port);
+    return 0;
+}
+
+/**
+ * @brief      Connects the socket of an interface to its neighbour's, so that
+ *             it sends without an address and only receives from there.
+ *
+ * @param[in]  ci   Interface state.
+ * @param[in]  nbr  State of the interface at the other end of the link.
+ *
+ * @return     0 on success, -1 with errno set.
+ */
+static int comm_intf_connect(comm_intf_t *ci, const comm_intf_t *nbr)
+{
+    struct sockaddr_in addr = { .sin_family = AF_INET };
+
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(nbr->port);
+    return connect(ci->fd, (struct sockaddr *)&addr, sizeof(addr));
+}
+
+/**
+ * @brief      Creates the epoll instance and stop eventfd of a node and
+ *             registers its interface sockets.
+ *
+ * @param[in]  comm  Transport.
+ * @param[in]  cn    Node state.
+ *
+ * @return     0 on success, -1 with errno set.
+ */
+static int comm_node_open(comm_t *comm, comm_node_t *cn)
+{
+    struct epoll_event ev = { .events = EPOLLIN };
+    interface_t *intf;
+    comm_intf_t *ci;
+
+    cn->epfd = epoll_create1(EPOLL_CLOEXEC);
+    cn->stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (cn->epfd < 0 || cn->stop_fd < 0)
+        return -1;
+
+    if (!(comm->flags & COMM_SINGLE_IO)) {
+        cn->batch = malloc(sizeof(comm_rx_batch_t) + (size_t)COMM_RX_BUDGET *
+                           comm->max_segs * sizeof(struct iovec));
+        if (!cn->batch)
+            return -1;
+        cn->batch->want = COMM_RX_MIN_BATCH;
+    }
+
+    // The stop eventfd is told apart by its NULL pointer
+    ev.data.ptr = NULL;
+    if (epoll_ctl(cn->epfd, EPOLL_CTL_ADD, cn->stop_fd, &ev) < 0)
+        return -1;
+
+    ITERATE_NODE_INTERFACES_BEGIN(cn->node, intf) {
+        ci = comm_get_intf(comm, intf);
+        ev.data.ptr = ci;
+        if (epoll_ctl(cn->epfd, EPOLL_CTL_ADD, ci->fd, &ev) < 0)
+            return -1;
+    } ITERATE_NODE_INTERFACES_ENDS;
+
+    return 0;
+}
+
+/**
+ * @brief      Creates the transport of a topology.
+ *
+ * @param[in]  graph      Topology.
+ * @param[in]  pool       A PKT_POOL_MT pool to receive into.
+ * @param[in]  max_frame  Largest frame received, 0 for one pool block.
+ * @param[in]  flags      COMM_SINGLE_IO or 0.
+ *
+ * @return     The transport, or NULL with errno set.
+ */
+comm_t *comm_create(graph_t *graph, pkt_pool_t *pool, uint32_t max_frame,
+                    uint32_t flags)
+{
+    uint32_t tailroom = pool->blk_size - pool->headroom, i, segs;
+    glthread_t *lst = &graph->node_list;
+    pthread_condattr_t cattr;
+    comm_intf_t *ci;
+    node_t *node;
+    comm_t *comm;
+    int err;
+
+    if (!max_frame)
+        max_frame = tailroom;
+    segs = max_frame <= tailroom
+               ? 1 : 1 + (max_frame - tailroom + pool->blk_size - 1) /
+                         pool->blk_size;
+    if (!(pool->flags & PKT_POOL_MT) || !tailroom || segs > COMM_MAX_IOV) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    comm = calloc(1, sizeof(*comm));
+    if (!comm)
+        return NULL;
+
+    comm->graph = graph;
+    comm->pool = pool;
+    comm->max_frame = max_frame;
+    comm->max_segs = segs;
+    comm->flags = flags;
+    comm->nintfs = graph->ifindex_next;
+    comm->intfs = aligned_alloc(64, comm->nintfs * sizeof(comm_intf_t));
+    comm->nodes = calloc(graph->node_count ? graph->node_count : 1,
+                         sizeof(comm_node_t));
+    if (!comm->intfs || !comm->nodes) {
+        free(comm->intfs);
+        free(comm->nodes);
+        free(comm);
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    pthread_condattr_init(&cattr);
+    pthread_condattr_setclock(&cattr, CLOCK_MONOTONIC);
+    memset(comm->intfs, 0, comm->nintfs * sizeof(comm_intf_t));
+    for (i = 0; i < comm->nintfs; i++) {
+        ci = &comm->intfs[i];
+        ci->fd = -1;
+        pthread_mutex_init(&ci->lock, NULL);
+        pthread_cond_init(&ci->rx_cond, &cattr);
+        pkt_queue_init(&ci->rxq, COMM_RXQ_LIMIT);
+        pthread_mutex_init(&ci->tx_lock, NULL);
+        pkt_queue_init(&ci->txq, COMM_TXQ_LIMIT);
+    }
+    pthread_condattr_destroy(&cattr);
+
+    ITERATE_GL_THREADS_BEGIN(lst, node_t, node) {
+        comm->nodes[comm->nnodes].node = node;
+        comm->nodes[comm->nnodes].comm = comm;
+        comm->nodes[comm->nnodes].epfd = -1;
+        comm->nodes[comm->nnodes].stop_fd = -1;
+        comm->nnodes++;
+    } ITERATE_GL_THREADS_ENDS;
+
+    // ifindex 0 is never assigned, every other one belongs to a link
+    for (i = 1; i < comm->nintfs; i++)
+        if (comm_intf_open(&comm->intfs[i]) < 0)
+            goto fail;
+    for (i = 1; i < comm->nintfs; i++) {
+        ci = comm_get_intf(comm, graph->ifindex_tbl[i]->nbr);
+        if (comm_intf_connect(&comm->intfs[i], ci) < 0)
+            goto fail;
+    }
+
+    if (flags & COMM_URING) {
+        comm->uring = comm_uring_create(comm);
+        if (!comm->uring)
+            comm->flags &= ~COMM_URING;
+    }
+    if (!comm->uring)
+        for (i = 0; i < comm->nnodes; i++)
+            if (comm_node_open(comm, &comm->nodes[i]) < 0)
+                goto fail;
+
+    return comm;
+
+fail:
+    err = errno;
+    comm_destroy(comm);
+    errno = err;
+    return NULL;
+}
+
+/**
+ * @brief      Moves a burst of received frames to the queue of an interface
+ *             and wakes its consumer if the queue was empty.
+ *
+ * @param[in]  ci        Interface state.
+ * @param[in]  burst     Received frames, empty afterwards.
+ * @param[in]  errs      Frames already lost in the burst.
+ */
+void comm_rx_deliver(comm_intf_t *ci, pkt_queue_t *burst, uint32_t errs)
+{
+    pkt_buf_t *pkt;
+    uint32_t was_empty;
+
+    pthread_mutex_lock(&ci->lock);
+    was_empty = pkt_queue_empty(&ci->rxq);
+    ci->rx_pkts += burst->count;
+    if (ci->rxq.count + burst->count <= ci->rxq.limit) {
+        pkt_queue_splice(&ci->rxq, burst);
+    } else {
+        while ((pkt = pkt_queue_pop(burst)))
+            if (pkt_queue_push(&ci->rxq, pkt) < 0) {
+                pkt_buf_free(pkt);
+                ci->rx_pkts--;
+                errs++;
+            }
+    }
+    ci->rx_errs += errs;
+    if (was_empty && !pkt_queue_empty(&ci->rxq))
+        pthread_cond_broadcast(&ci->rx_cond);
+    pthread_mutex_unlock(&ci->lock);
+}
+
+/**
+ * @brief      Reads one frame and drops it, used when the pool is empty so
+ *             that the level-triggered socket does not keep the thread
+ *             spinning.
+ *
+ * @param[in]  ci  Interface state.
+ *
+ * @return     0 when a frame was dropped, -1 when the socket was empty.
+ */
+static int comm_rx_discard(comm_intf_t *ci)
+{
+    unsigned char discard[1];
+
+    return recv(ci->fd, discard, sizeof(discard), MSG_DONTWAIT) < 0 ? -1 : 0;
+}
+
+/**
+ * @brief      Reads up to COMM_RX_BUDGET frames from the socket of an
+ *             interface with one recvmsg each and queues them.
+ *
+ * @param[in]  comm  Transport.
+ * @param[in]  ci    Interface state.
+ */
+static void comm_rx_single(comm_t *comm, comm_intf_t *ci)
+{
+    struct iovec iov[COMM_MAX_IOV];
+    struct msghdr msg;
+    pkt_queue_t burst;
+    uint32_t budget, errs = 0, syscalls = 0;
+    pkt_buf_t *pkt;
+    ssize_t n;
+
+    pkt_queue_init(&burst, PKT_QUEUE_UNBOUNDED);
+
+    for (budget = 0; budget < COMM_RX_BUDGET; budget++) {
+        syscalls++;
+        pkt = pkt_buf_alloc_len(comm->pool, comm->max_frame);
+        if (!pkt) {
+            if (comm_rx_discard(ci) < 0)
+                break;
+            errs++;
+            continue;
+        }
+
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = pkt_buf_to_iovec(pkt, iov, COMM_MAX_IOV);
+        n = recvmsg(ci->fd, &msg, MSG_DONTWAIT);
+        if (n < 0) {
+            pkt_buf_free(pkt);
+            break;
+        }
+        if (msg.msg_flags & MSG_TRUNC) {
+            pkt_buf_free(pkt);
+            errs++;
+            continue;
+        }
+        pkt_buf_trim(pkt, (uint32_t)n);
+        pkt_queue_push(&burst, pkt);
+    }
+
+    __atomic_add_fetch(&ci->rx_syscalls, syscalls, __ATOMIC_RELAXED);
+    if (!pkt_queue_empty(&burst) || errs)
+        comm_rx_deliver(ci, &burst, errs);
+}
+
+/**
+ * @brief      Takes up to n receive buffers of max_frame bytes from the pool.
+ *
+ * @param[in]  comm  Transport.
+ * @param[out] pkts  The buffers.
+ * @param[in]  n     Buffers wanted.
+ *
+ * @return     The number of buffers taken.
+ */
+static uint32_t comm_rx_alloc(comm_t *comm, pkt_buf_t **pkts, uint32_t n)
+{
+    uint32_t i;
+
+    if (comm->max_segs > 1) {
+        for (i = 0; i < n; i++)
+            if (!(pkts[i] = pkt_buf_alloc_len(comm->pool, comm->max_frame)))
+                break;
+        return i;
+    }
+
+    n = pkt_buf_alloc_bulk(comm->pool, pkts, n);
+    for (i = 0; i < n; i++)
+        pkt_buf_put(pkts[i], comm->max_frame);
+    return n;
+}
+
+/**
+ * @brief      Reads up to COMM_RX_BUDGET frames from the socket of an
+ *             interface with recvmmsg bursts and queues them.
+ *
+ * @param[in]  comm   Transport.
+ * @param[in]  batch  recvmmsg vectors of the receive thread.
+ * @param[in]  ci     Interface state.
+ */
+static void comm_rx_mmsg(comm_t *comm, comm_rx_batch_t *batch,
+                         comm_intf_t *ci)
+{
+    struct msghdr *hdr;
+    pkt_queue_t burst;
+    uint32_t budget = 0, errs = 0, syscalls = 0, want, n, i;
+    int got;
+
+    pkt_queue_init(&burst, PKT_QUEUE_UNBOUNDED);
+
+    while (budget < COMM_RX_BUDGET) {
+        want = batch->want;
+        if (want > COMM_RX_BUDGET - budget)
+            want = COMM_RX_BUDGET - budget;
+
+        syscalls++;
+        n = comm_rx_alloc(comm, batch->pkts, want);
+        if (!n) {
+            if (comm_rx_discard(ci) < 0)
+                break;
+            errs++;
+            budget++;
+            continue;
+        }
+
+        for (i = 0; i < n; i++) {
+            hdr = &batch->msgs[i].msg_hdr;
+            memset(hdr, 0, sizeof(*hdr));
+            hdr->msg_iov = &batch->iov[i * comm->max_segs];
+            hdr->msg_iovlen = pkt_buf_to_iovec(batch->pkts[i], hdr->msg_iov,
+                                               comm->max_segs);
+        }
+
+        got = recvmmsg(ci->fd, batch->msgs, n, MSG_DONTWAIT, NULL);
+        if (got < 0)
+            got = 0;
+        for (i = 0; i < (uint32_t)got; i++) {
+            if (batch->msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+                pkt_buf_free(batch->pkts[i]);
+                errs++;
+                continue;
+            }
+            pkt_buf_trim(batch->pkts[i], batch->msgs[i].msg_len);
+            pkt_queue_push(&burst, batch->pkts[i]);
+        }
+        for (; i < n; i++)
+            pkt_buf_free(batch->pkts[i]);
+
+        // A full burst means more is waiting, offer more buffers next time
+        if ((uint32_t)got == n) {
+            if (n == batch->want && batch->want < COMM_RX_BUDGET)
+                batch->want *= 2;
+        } else if (batch->want > COMM_RX_MIN_BATCH &&
+                   (uint32_t)got < batch->want / 2) {
+            batch->want /= 2;
+        }
+
+        budget += n;
+        if ((uint32_t)got < n)
+            break;
+    }
+
+    __atomic_add_fetch(&ci->rx_syscalls, syscalls, __ATOMIC_RELAXED);
+    if (!pkt_queue_empty(&burst) || errs)
+        comm_rx_deliver(ci, &burst, errs);
+}
+
+/**
+ * @brief      Receive thread of a node.
+ *
+ * @param[in]  arg  Node state.
+ *
+ * @return     NULL.
+ */
+static void *comm_rx_thread(void *arg)
+{
+    struct epoll_event ev[COMM_RX_BUDGET];
+    comm_node_t *cn = arg;
+    int n, i;
+
+    for (;;) {
+        n = epoll_wait(cn->epfd, ev, COMM_RX_BUDGET, -1);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return NULL;
+        }
+        cn->polls++;
+        for (i = 0; i < n; i++) {
+            if (!ev[i].data.ptr)
+                return NULL;
+            if (cn->batch)
+                comm_rx_mmsg(cn->comm, cn->batch, ev[i].data.ptr);
+            else
+                comm_rx_single(cn->comm, ev[i].data.ptr);
+        }
+    }
+}
+
+/**
+ * @brief      Starts the receive thread of every node.
+ *
+ * @param[in]  comm  Transport.
+ *
+ * @return     0 on success, -1 with errno set.
+ */
+int comm_start(comm_t *comm)
+{
+    char name[16];
+    comm_node_t *cn;
+    uint32_t i;
+    int err;
+
+    if (comm->uring)
+        return comm_uring_start(comm->uring);
+
+    for (i = 0; i < comm->nnodes; i++) {
+        cn = &comm->nodes[i];
+        if (cn->running)
+            continue;
+
+        err = pthread_create(&cn->thread, NULL, comm_rx_thread, cn);
+        if (err) {
+            comm_stop(comm);
+            errno = err;
+            return -1;
+        }
+        cn->running = 1;
+        // Thread names are 15 bytes at most, the rest of the node name goes
+        snprintf(name, sizeof(name), "rx-%.12s", cn->node->node_name);
+        pthread_setname_np(cn->thread, name);
+    }
+    return 0;
+}
+
+/**
+ * @brief      Stops and joins the receive threads.
+ *
+ * @param[in]  comm  Transport.
+ */
+void comm_stop(comm_t *comm)
+{
+    comm_node_t *cn;
+    eventfd_t val;
+    uint32_t i;
+
+    if (comm->uring) {
+        comm_uring_stop(comm->uring);
+        return;
+    }
+
+    for (i = 0; i < comm->nnodes; i++) {
+        cn = &comm->nodes[i];
+        if (!cn->running || eventfd_write(cn->stop_fd, 1) < 0)
+            continue;
+
+        pthread_join(cn->thread, NULL);
+        cn->running = 0;
+
+        // Cleared so that a restarted thread does not exit straight away
+        eventfd_read(cn->stop_fd, &val);
+    }
+}
+
+/**
+ * @brief      Stops the transport and frees it.
+ *
+ * @param[in]  comm  Transport, may be NULL.
+ */
+void comm_destroy(comm_t *comm)
+{
+    comm_intf_t *ci;
+    uint32_t i;
+
+    if (!comm)
+        return;
+
+    comm_stop(comm);
+    comm_uring_destroy(comm->uring);
+    for (i = 0; i < comm->nnodes; i++) {
+        if (comm->nodes[i].epfd >= 0)
+            close(comm->nodes[i].epfd);
+        if (comm->nodes[i].stop_fd >= 0)
+            close(comm->nodes[i].stop_fd);
+        free(comm->nodes[i].batch);
+    }
+    for (i = 0; i < comm->nintfs; i++) {
+        ci = &comm->intfs[i];
+        if (ci->fd >= 0)
+            close(ci->fd);
+        pkt_queue_flush(&ci->rxq);
+        pkt_queue_flush(&ci->txq);
+        pthread_mutex_destroy(&ci->lock);
+        pthread_cond_destroy(&ci->rx_cond);
+        pthread_mutex_destroy(&ci->tx_lock);
+    }
+    free(comm->intfs);
+    free(comm->nodes);
+    free(comm);
+}
+
+/**
+ * @brief      Sends a frame out of an interface to its neighbour.
+ *
+ * @param[in]  comm  Transport.
+ * @param[in]  intf  Interface of the sending node.
+ * @param[in]  pkt   Frame, consumed.
+ *
+ * @return     0 on success, -1 with errno set.
+ */
+int comm_send(comm_t *comm, interface_t *intf, pkt_buf_t *pkt)
+{
+    comm_intf_t *ci = comm_get_intf(comm, intf);
+    struct iovec iov[COMM_MAX_IOV];
+    struct msghdr msg = { 0 };
+    int n, rc = -1;
+
+    n = pkt_buf_to_iovec(pkt, iov, COMM_MAX_IOV);
+    if (n < 0) {
+        errno = EMSGSIZE;
+    } else {
+        msg.msg_iov = iov;
+        msg.msg_iovlen = n;
+        if (sendmsg(ci->fd, &msg, 0) >= 0)
+            rc = 0;
+    }
+
+    __atomic_add_fetch(rc ? &ci->tx_errs : &ci->tx_pkts, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&ci->tx_syscalls, 1, __ATOMIC_RELAXED);
+    pkt_buf_free(pkt);
+    return rc;
+}
+
+/**
+ * @brief      Queues a frame for sending out of an interface.
+ *
+ * @param[in]  comm  Transport.
+ * @param[in]  intf  Interface of the sending node.
+ * @param[in]  pkt   Frame, consumed.
+ *
+ * @return     0 when the frame was queued, -1 when it was dropped.
+ */
+int comm_enqueue(comm_t *comm, interface_t *intf, pkt_buf_t *pkt)
+{
+    comm_intf_t *ci = comm_get_intf(comm, intf);
+    uint32_t count;
+    int rc;
+
+    pthread_mutex_lock(&ci->tx_lock);
+    rc = pkt_queue_push(&ci->txq, pkt);
+    count = ci->txq.count;
+    pthread_mutex_unlock(&ci->tx_lock);
+
+    if (rc < 0) {
+        __atomic_add_fetch(&ci->tx_errs, 1, __ATOMIC_RELAXED);
+        pkt_buf_free(pkt);
+        return -1;
+    }
+    if (count >= COMM_TX_BATCH)
+        comm_flush(comm, intf);
+    return 0;
+}
+
+/**
+ * @brief      Sends the frames at the head of a TX queue with one sendmmsg,
+ *             or one sendmsg under COMM_SINGLE_IO, and frees those sent. The
+ *             caller holds the TX lock.
+ *
+ * @param[in]  comm  Transport.
+ * @param[in]  ci    Interface state.
+ *
+ * @return     The number of frames sent, -1 when the socket has no room.
+ */
+static int comm_tx_batch(comm_t *comm, comm_intf_t *ci)
+{
+    struct iovec iov[COMM_MAX_IOV + COMM_TX_BATCH];
+    struct mmsghdr msgs[COMM_TX_BATCH];
+    uint32_t max, n = 0, used = 0, i;
+    glthread_node_t *glue;
+    int segs, sent;
+
+    max = comm->flags & COMM_SINGLE_IO ? 1 : COMM_TX_BATCH;
+
+    // Frames stay on the queue until sent, a batch ends where the iovecs do
+    for (glue = ci->txq.lst.head; glue && n < max; glue = glue->right) {
+        segs = pkt_buf_to_iovec(PKT_BUF_FROM_GLUE(glue), &iov[used],
+                                COMM_MAX_IOV + COMM_TX_BATCH - used);
+        if (segs < 0 || segs > COMM_MAX_IOV)
+            break;
+        memset(&msgs[n], 0, sizeof(msgs[n]));
+        msgs[n].msg_hdr.msg_iov = &iov[used];
+        msgs[n].msg_hdr.msg_iovlen = segs;
+        used += segs;
+        n++;
+    }
+
+    if (!n) {
+        // The head frame has too many segments to ever be sent
+        errno = EMSGSIZE;
+        sent = -1;
+    } else if (n == 1) {
+        sent = sendmsg(ci->fd, &msgs[0].msg_hdr, 0) < 0 ? -1 : 1;
+    } else {
+        sent = sendmmsg(ci->fd, msgs, n, 0);
+    }
+    if (n)
+        __atomic_add_fetch(&ci->tx_syscalls, 1, __ATOMIC_RELAXED);
+
+    if (sent < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS)
+            return -1;
+        // Any other error is the head frame's, drop it and carry on
+        pkt_buf_free(pkt_queue_pop(&ci->txq));
+        __atomic_add_fetch(&ci->tx_errs, 1, __ATOMIC_RELAXED);
+        return 0;
+    }
+
+    for (i = 0; i < (uint32_t)sent; i++)
+        pkt_buf_free(pkt_queue_pop(&ci->txq));
+    __atomic_add_fetch(&ci->tx_pkts, sent, __ATOMIC_RELAXED);
+    return sent;
+}
+
+/**
+ * @brief      Sends the frames queued on an interface.
+ *
+ * @param[in]  comm  Transport.
+ * @param[in]  intf  Interface of the sending node.
+ *
+ * @return     The number of frames sent.
+ */
+uint32_t comm_flush(comm_t *comm, interface_t *intf)
+{
+    comm_intf_t *ci = comm_get_intf(comm, intf);
+    uint32_t n = 0;
+    int sent;
+
+    if (comm->uring) {
+        comm_uring_kick(comm->uring, ci);
+        return 0;
+    }
+
+    pthread_mutex_lock(&ci->tx_lock);
+    while (!pkt_queue_empty(&ci->txq)) {
+        sent = comm_tx_batch(comm, ci);
+        if (sent < 0)
+            break;
+        n += sent;
+    }
+    pthread_mutex_unlock(&ci->tx_lock);
+    return n;
+}
+
+/**
+ * @brief      Waits until frames are queued on an interface or the timeout
+ *             expires. The caller holds the queue lock.
+ *
+ * @param[in]  ci          Interface state.
+ * @param[in]  timeout_ms  0 not to wait, -1 to wait for ever.
+ */
+static void comm_wait_rx(comm_intf_t *ci, int timeout_ms)
+{
+    struct timespec ts;
+
+    if (!timeout_ms || !pkt_queue_empty(&ci->rxq))
+        return;
+
+    if (timeout_ms < 0) {
+        while (pkt_queue_empty(&ci->rxq))
+            pthread_cond_wait(&ci->rx_cond, &ci->lock);
+        return;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec += timeout_ms / 1000;
+    ts.tv_nsec += (long)(timeout_ms % 1000) * 1000000;
+    if (ts.tv_nsec >= 1000000000) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+    }
+    while (pkt_queue_empty(&ci->rxq))
+        if (pthread_cond_timedwait(&ci->rx_cond, &ci->lock, &ts) == ETIMEDOUT)
+            break;
+}
+
+/**
+ * @brief      Takes the oldest frame received on an interface.
+ *
+ * @param[in]  comm        Transport.
+ * @param[in]  intf        Interface.
+ * @param[in]  timeout_ms  How long to wait for a frame.
+ *
+ * @return     The frame, or NULL when none arrived in time.
+ */
+pkt_buf_t *comm_recv(comm_t *comm, interface_t *intf, int timeout_ms)
+{
+    comm_intf_t *ci = comm_get_intf(comm, intf);
+    pkt_buf_t *pkt;
+
+    pthread_mutex_lock(&ci->lock);
+    comm_wait_rx(ci, timeout_ms);
+    pkt = pkt_queue_pop(&ci->rxq);
+    pthread_mutex_unlock(&ci->lock);
+    return pkt;
+}
+
+/**
+ * @brief      Moves every frame received on an interface to out.
+ *
+ * @param[in]  comm        Transport.
+ * @param[in]  intf        Interface.
+ * @param[out] out         Queue to move the frames to.
+ * @param[in]  timeout_ms  How long to wait for a first frame.
+ *
+ * @return     The number of frames moved.
+ */
+uint32_t comm_recv_burst(comm_t *comm, interface_t *intf, pkt_queue_t *out,
+                         int timeout_ms)
+{
+    comm_intf_t *ci = comm_get_intf(comm, intf);
+    uint32_t n;
+
+    pthread_mutex_lock(&ci->lock);
+    comm_wait_rx(ci, timeout_ms);
+    n = ci->rxq.count;
+    pkt_queue_splice(out, &ci->rxq);
+    pthread_mutex_unlock(&ci->lock);
+    return n;
+}
+
+#endif    // COMM_C
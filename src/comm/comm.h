@@ -0,0 +1,317 @@
+/* -----------------------------------------------------------------------------
+ * @file:        comm.h
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        21/10/2026 11:00 AM
+ * @license:     MIT
+ * @description: This header file declares the link transport between the
+ *               nodes of a topology. Every interface owns a UDP socket on the
+ *               loopback address, connected to the socket of the interface
+ *               at the other end of its link, so sending a frame out of an
+ *               interface is one sendmsg, or frames are queued on the
+ *               interface and flushed in batches with sendmmsg. Each node
+ *               runs a receive thread
+ *               that waits on all of its interface sockets with one epoll
+ *               instance and delivers received frames, as pkt_buf_t from a
+ *               shared pool, to a queue per interface. Sockets are read with
+ *               recvmmsg unless COMM_SINGLE_IO asks for one syscall per
+ *               frame. COMM_URING replaces the threads and epoll instances
+ *               with the io_uring backend of comm_uring.h.
+ *               The contents are organized into three groups:
+ *
+ *                 1. Structs:
+ *                    - struct comm_intf_t
+ *                    - struct comm_node_t
+ *                    - struct comm_t
+ *
+ *                 2. Functions:
+ *                    - comm_create
+ *                    - comm_start
+ *                    - comm_stop
+ *                    - comm_destroy
+ *                    - comm_send
+ *                    - comm_enqueue
+ *                    - comm_flush
+ *                    - comm_recv
+ *                    - comm_recv_burst
+ *                    - comm_get_intf
+ *
+ *                 3. Macros:
+ *                    - COMM_RXQ_LIMIT
+ *                    - COMM_RX_BUDGET
+ *                    - COMM_MAX_IOV
+ *                    - COMM_SOCK_BUF
+ *                    - COMM_TXQ_LIMIT
+ *                    - COMM_TX_BATCH
+ *                    - COMM_RX_MIN_BATCH
+ *                    - COMM_SINGLE_IO
+ *                    - COMM_URING
+ *
+ * @note:        This code is part of the tcpip-stack project, which is a course
+ *               on network development.
+ *
+ * Revision History:
+ *
+ * Revision 0.1: 21/10/2026 Marko Trickovic
+ * Initial version with UDP sockets per interface and an epoll receive thread
+ * per node.
+ *
+ * Revision 0.2: 21/10/2026 Marko Trickovic
+ * Added TX queues flushed with sendmmsg, recvmmsg receive bursts, syscall
+ * counters and the COMM_SINGLE_IO flag.
+ *
+ * Revision 0.3: 21/10/2026 Marko Trickovic
+ * Added the COMM_URING flag and the TX pending glue it uses.
+ */
+
+#ifndef COMM_H
+#define COMM_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include "../graph/graph.h"
+#include "../pkt/pkt_queue.h"
+
+/** Frames queued on an interface before new ones are dropped. */
+#define COMM_RXQ_LIMIT  4096
+
+/** Frames read from one socket before the receive thread polls again. */
+#define COMM_RX_BUDGET  64
+
+/** Most segments in a frame sent or received. */
+#define COMM_MAX_IOV    64
+
+/** Socket buffer size asked for, the kernel may cap it. */
+#define COMM_SOCK_BUF   (4 << 20)
+
+/** Frames queued for sending on an interface before new ones are dropped. */
+#define COMM_TXQ_LIMIT  4096
+
+/** Most frames in one sendmmsg, a TX queue this long is flushed at once. */
+#define COMM_TX_BATCH   64
+
+/** Fewest buffers a receive burst offers to recvmmsg. */
+#define COMM_RX_MIN_BATCH   4
+
+/** Flag of comm_create: one sendmsg or recvmsg per frame, for comparison. */
+#define COMM_SINGLE_IO  0x1
+
+/** Flag of comm_create: one io_uring thread for the whole topology. */
+#define COMM_URING      0x2
+
+struct comm_;
+struct comm_rx_batch_;
+struct comm_uring_;
+
+/**
+ * @brief      The structure representing the transport state of one
+ *             interface. Each sits on its own cache lines since the receive
+ *             thread and the consumer of its queue run on different CPUs.
+ *
+ * @struct                comm_intf_t
+ *
+ * @param[in]  fd         UDP socket, connected to the neighbour's.
+ * @param[in]  port       Loopback port the socket is bound to.
+ * @param[in]  lock       Protects rxq.
+ * @param[in]  rx_cond    Signalled when frames are queued on rxq.
+ * @param[in]  rxq        Received frames.
+ * @param[in]  rx_pkts    Frames received.
+ * @param[in]  rx_errs    Frames lost to truncation, an empty pool or a full
+ *                        queue.
+ * @param[in]  tx_pkts    Frames sent.
+ * @param[in]  tx_errs    Frames that failed to send.
+ * @param[in]  rx_syscalls  Receive syscalls made on the socket.
+ * @param[in]  tx_syscalls  Send syscalls made on the socket.
+ * @param[in]  tx_lock    Protects txq.
+ * @param[in]  txq        Frames waiting for comm_flush.
+ * @param[in]  tx_glue    Glue on the pending list of the io_uring thread.
+ * @param[in]  tx_pending Whether tx_glue is on that list.
+ */
+typedef struct comm_intf_ {
+    int fd;
+    uint16_t port;
+    pthread_mutex_t lock;
+    pthread_cond_t rx_cond;
+    pkt_queue_t rxq;
+    uint64_t rx_pkts;
+    uint64_t rx_errs;
+    uint64_t tx_pkts;
+    uint64_t tx_errs;
+    uint64_t rx_syscalls;
+    uint64_t tx_syscalls;
+    pthread_mutex_t tx_lock;
+    pkt_queue_t txq;
+    glthread_node_t tx_glue;
+    int tx_pending;
+} __attribute__((aligned(64))) comm_intf_t;
+
+/**
+ * @brief      The structure representing the receive side of one node.
+ *
+ * @struct                comm_node_t
+ *
+ * @param[in]  node       Node.
+ * @param[in]  comm       Transport the node belongs to.
+ * @param[in]  epfd       epoll instance over the node's interface sockets.
+ * @param[in]  stop_fd    eventfd that tells the receive thread to exit.
+ * @param[in]  thread     Receive thread.
+ * @param[in]  running    Whether the receive thread was started.
+ * @param[in]  polls      epoll_wait calls that returned.
+ * @param[in]  batch      recvmmsg vectors of the receive thread.
+ */
+typedef struct comm_node_ {
+    node_t *node;
+    struct comm_ *comm;
+    int epfd;
+    int stop_fd;
+    pthread_t thread;
+    int running;
+    uint64_t polls;
+    struct comm_rx_batch_ *batch;
+} comm_node_t;
+
+/**
+ * @brief      The structure representing the transport of a topology.
+ *
+ * @struct                comm_t
+ *
+ * @param[in]  graph      Topology.
+ * @param[in]  pool       Pool frames are received into.
+ * @param[in]  max_frame  Largest frame received, in bytes.
+ * @param[in]  max_segs   Segments of a max_frame buffer.
+ * @param[in]  flags      COMM_* flags in effect.
+ * @param[in]  uring      io_uring backend, NULL with epoll.
+ * @param[in]  intfs      Interface state, indexed by ifindex.
+ * @param[in]  nintfs     Entries in intfs.
+ * @param[in]  nodes      Node state, in node list order.
+ * @param[in]  nnodes     Entries in nodes.
+ */
+typedef struct comm_ {
+    graph_t *graph;
+    pkt_pool_t *pool;
+    uint32_t max_frame;
+    uint32_t max_segs;
+    uint32_t flags;
+    struct comm_uring_ *uring;
+    comm_intf_t *intfs;
+    uint32_t nintfs;
+    comm_node_t *nodes;
+    uint32_t nnodes;
+} comm_t;
+
+/**
+ * @brief      Opens and connects a socket for every linked interface and an
+ *             epoll instance for every node, or the io_uring ring with
+ *             COMM_URING. No thread is started. When the ring cannot be set
+ *             up, for lack of kernel support or because frames span several
+ *             blocks, the transport falls back to epoll and COMM_URING is
+ *             cleared from comm->flags.
+ *
+ * @param[in]  graph      Topology, not changed while the transport exists.
+ * @param[in]  pool       A PKT_POOL_MT pool to receive into.
+ * @param[in]  max_frame  Largest frame received, 0 for one pool block.
+ * @param[in]  flags      COMM_SINGLE_IO, COMM_URING or 0.
+ *
+ * @return     The transport, or NULL with errno set.
+ */
+comm_t *comm_create(graph_t *graph, pkt_pool_t *pool, uint32_t max_frame,
+                    uint32_t flags);
+
+/**
+ * @brief      Starts the receive thread of every node.
+ *
+ * @param[in]  comm  Transport.
+ *
+ * @return     0 on success, -1 with errno set, in which case no thread runs.
+ */
+int comm_start(comm_t *comm);
+
+/**
+ * @brief      Stops and joins the receive threads. Queued frames stay queued.
+ *
+ * @param[in]  comm  Transport.
+ */
+void comm_stop(comm_t *comm);
+
+/**
+ * @brief      Stops the transport, closes its sockets and frees it along with
+ *             every queued frame.
+ *
+ * @param[in]  comm  Transport, may be NULL.
+ */
+void comm_destroy(comm_t *comm);
+
+/**
+ * @brief      Sends a frame out of an interface to its neighbour. The frame
+ *             is consumed whether or not it was sent.
+ *
+ * @param[in]  comm  Transport.
+ * @param[in]  intf  Interface of the sending node.
+ * @param[in]  pkt   Frame, not on any glthread.
+ *
+ * @return     0 on success, -1 with errno set.
+ */
+int comm_send(comm_t *comm, interface_t *intf, pkt_buf_t *pkt);
+
+/**
+ * @brief      Queues a frame for sending out of an interface, flushing the
+ *             queue once it holds COMM_TX_BATCH frames. A frame refused by a
+ *             full queue is freed and counted in tx_errs.
+ *
+ * @param[in]  comm  Transport.
+ * @param[in]  intf  Interface of the sending node.
+ * @param[in]  pkt   Frame, not on any glthread.
+ *
+ * @return     0 when the frame was queued, -1 when it was dropped.
+ */
+int comm_enqueue(comm_t *comm, interface_t *intf, pkt_buf_t *pkt);
+
+/**
+ * @brief      Sends the frames queued on an interface, up to COMM_TX_BATCH
+ *             per sendmmsg. Frames the socket has no room for stay queued.
+ *             With COMM_URING the queue is handed to the ring thread, which
+ *             sends it asynchronously.
+ *
+ * @param[in]  comm  Transport.
+ * @param[in]  intf  Interface of the sending node.
+ *
+ * @return     The number of frames sent, always 0 with COMM_URING.
+ */
+uint32_t comm_flush(comm_t *comm, interface_t *intf);
+
+/**
+ * @brief      Takes the oldest frame received on an interface.
+ *
+ * @param[in]  comm        Transport.
+ * @param[in]  intf        Interface.
+ * @param[in]  timeout_ms  How long to wait for a frame, 0 not to wait and -1
+ *                         to wait for ever.
+ *
+ * @return     The frame, or NULL when none arrived in time.
+ */
+pkt_buf_t *comm_recv(comm_t *comm, interface_t *intf, int timeout_ms);
+
+/**
+ * @brief      Moves every frame received on an interface to the tail of out,
+ *             taking the queue lock once.
+ *
+ * @param[in]  comm        Transport.
+ * @param[in]  intf        Interface.
+ * @param[out] out         Queue to move the frames to.
+ * @param[in]  timeout_ms  How long to wait for a first frame, as for
+ *                         comm_recv.
+ *
+ * @return     The number of frames moved.
+ */
+uint32_t comm_recv_burst(comm_t *comm, interface_t *intf, pkt_queue_t *out,
+                         int timeout_ms);
+
+/**
+ * @brief      Retrieves the transport state of an interface.
+ */
+static inline comm_intf_t *comm_get_intf(comm_t *comm, interface_t *intf)
+{
+    return &comm->intfs[intf->ifindex];
+}
+
+#endif    // COMM_H
@@ -0,0 +1,321 @@
+/******************************************************************************
+ * @file:        comm_netem.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        21/10/2026 09:00 PM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains link impairment emulation. A frame first
+ *               goes through the loss models, then waits for the link to
+ *               finish sending the frames ahead of it at the configured
+ *               rate, then gets its delay and jitter. Frames that take the
+ *               delay get due times that never decrease, and so do frames
+ *               that skip it, so each kind waits on its own FIFO that is
+ *               already in due order. Holding a frame is a tail insert and
+ *               releasing one takes the earlier of the two heads, both O(1)
+ *               however many frames are in flight. The generator is
+ *               splitmix64, and a direction's stream is derived from the
+ *               topology seed and the ifindex alone, so changing one link
+ *               does not shift the numbers another draws.
+ *
+ *               Functions in this file:
+ *                 - comm_netem_create
+ *                 - comm_netem_destroy
+ *                 - comm_netem_set
+ *                 - comm_netem_set_link
+ *                 - comm_netem_enqueue
+ *                 - comm_netem_dequeue
+ *                 - comm_netem_next
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 21/10/2026 Marko Trickovic
+ * Initial version.
+ *****************************************************************************/
+
+#ifndef COMM_NETEM_C
+#define COMM_NETEM_C
+
+#include <errno.h>
+#include <stdlib.h>
+#include "comm_netem.h"
+
+static inline uint64_t comm_netem_rand(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ull);
+
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+// Draws 32 random bits and compares them with a threshold; a threshold of
+// 2^32 always hits, 0 never does and draws nothing
+static inline int comm_netem_hit(comm_netem_intf_t *ni, uint64_t thr)
+{
+    return thr && (comm_netem_rand(&ni->rng) >> 32) < thr;
+}
+
+static inline uint64_t comm_netem_thr(double p)
+{
+    return (uint64_t)(p * 4294967296.0);
+}
+
+static inline int comm_netem_prob_ok(double p)
+{
+    return p >= 0.0 && p <= 1.0;
+}
+
+// Restarts the generator of ifindex from the seed
+static void comm_netem_reseed(comm_netem_t *nm, uint32_t ifindex)
+{
+    comm_netem_intf_t *ni = &nm->intfs[ifindex];
+
+    ni->rng = nm->seed ^ ((uint64_t)ifindex * 0xd1b54a32d192ed03ull);
+    comm_netem_rand(&ni->rng);
+    ni->ge_state = 0;
+}
+
+/**
+ * @brief      Creates the emulation of a topology.
+ *
+ * @param[in]  graph  Topology.
+ * @param[in]  seed   Seed.
+ *
+ * @return     The emulation, or NULL.
+ */
+comm_netem_t *comm_netem_create(graph_t *graph, uint64_t seed)
+{
+    comm_netem_t *nm;
+    uint32_t i;
+
+    nm = calloc(1, sizeof(*nm));
+    if (!nm)
+        return NULL;
+    nm->graph = graph;
+    nm->seed = seed;
+    nm->nintfs = graph->ifindex_next;
+    nm->intfs = calloc(nm->nintfs, sizeof(comm_netem_intf_t));
+    if (!nm->intfs) {
+        free(nm);
+        return NULL;
+    }
+
+    for (i = 0; i < nm->nintfs; i++) {
+        pkt_queue_init(&nm->intfs[i].q, PKT_QUEUE_UNBOUNDED);
+        pkt_queue_init(&nm->intfs[i].fast, PKT_QUEUE_UNBOUNDED);
+        nm->intfs[i].cfg.limit = COMM_NETEM_LIMIT;
+        comm_netem_reseed(nm, i);
+    }
+    return nm;
+}
+
+/**
+ * @brief      Frees the emulation and the frames it holds.
+ *
+ * @param[in]  nm  Emulation, may be NULL.
+ */
+void comm_netem_destroy(comm_netem_t *nm)
+{
+    uint32_t i;
+
+    if (!nm)
+        return;
+
+    for (i = 0; i < nm->nintfs; i++) {
+        pkt_queue_flush(&nm->intfs[i].q);
+        pkt_queue_flush(&nm->intfs[i].fast);
+    }
+    free(nm->intfs);
+    free(nm);
+}
+
+/**
+ * @brief      Configures one direction.
+ *
+ * @param[in]  nm    Emulation.
+ * @param[in]  intf  Interface frames leave by.
+ * @param[in]  cfg   Impairments, NULL for none.
+ *
+ * @return     0 on success, -1 with errno EINVAL.
+ */
+int comm_netem_set(comm_netem_t *nm, interface_t *intf,
+                   const comm_netem_cfg_t *cfg)
+{
+    comm_netem_intf_t *ni = comm_netem_get_intf(nm, intf);
+    static const comm_netem_cfg_t none;
+
+    if (!cfg)
+        cfg = &none;
+    if (!comm_netem_prob_ok(cfg->loss) || !comm_netem_prob_ok(cfg->ge_p) ||
+        !comm_netem_prob_ok(cfg->ge_r) || !comm_netem_prob_ok(cfg->ge_bad) ||
+        !comm_netem_prob_ok(cfg->ge_good) ||
+        !comm_netem_prob_ok(cfg->reorder)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    ni->cfg = *cfg;
+    if (!ni->cfg.limit)
+        ni->cfg.limit = COMM_NETEM_LIMIT;
+    ni->loss_thr = comm_netem_thr(cfg->loss);
+    ni->ge_p_thr = comm_netem_thr(cfg->ge_p);
+    ni->ge_r_thr = comm_netem_thr(cfg->ge_r);
+    ni->ge_bad_thr = comm_netem_thr(cfg->ge_bad);
+    ni->ge_good_thr = comm_netem_thr(cfg->ge_good);
+    ni->reorder_thr = comm_netem_thr(cfg->reorder);
+    comm_netem_reseed(nm, intf->ifindex);
+    return 0;
+}
+
+/**
+ * @brief      Configures both directions of a link.
+ *
+ * @param[in]  nm    Emulation.
+ * @param[in]  intf  Interface at either end.
+ * @param[in]  cfg   Impairments, NULL for none.
+ *
+ * @return     0 on success, -1 with errno EINVAL.
+ */
+int comm_netem_set_link(comm_netem_t *nm, interface_t *intf,
+                        const comm_netem_cfg_t *cfg)
+{
+    if (comm_netem_set(nm, intf, cfg) < 0)
+        return -1;
+    return intf->nbr ? comm_netem_set(nm, intf->nbr, cfg) : 0;
+}
+
+// Returns the held queue whose head is due first, NULL when both are empty
+static inline pkt_queue_t *comm_netem_head(comm_netem_intf_t *ni)
+{
+    if (!ni->fast.lst.head)
+        return ni->q.lst.head ? &ni->q : NULL;
+    if (!ni->q.lst.head)
+        return &ni->fast;
+    return PKT_BUF_FROM_GLUE(ni->fast.lst.head)->tstamp <=
+           PKT_BUF_FROM_GLUE(ni->q.lst.head)->tstamp ? &ni->fast : &ni->q;
+}
+
+// Tells whether the loss models take the frame
+static int comm_netem_lose(comm_netem_intf_t *ni)
+{
+    if (comm_netem_hit(ni, ni->loss_thr)) {
+        ni->lost++;
+        return 1;
+    }
+    if (!ni->ge_p_thr)
+        return 0;
+
+    if (ni->ge_state)
+        ni->ge_state = !comm_netem_hit(ni, ni->ge_r_thr);
+    else
+        ni->ge_state = comm_netem_hit(ni, ni->ge_p_thr);
+    if (comm_netem_hit(ni, ni->ge_state ? ni->ge_bad_thr : ni->ge_good_thr)) {
+        ni->ge_lost++;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief      Holds a frame until it is due, or loses it.
+ *
+ * @param[in]  nm      Emulation.
+ * @param[in]  intf    Interface the frame leaves by.
+ * @param[in]  pkt     Frame.
+ * @param[in]  now_ns  Current time.
+ *
+ * @return     0 when held, -1 when freed.
+ */
+int comm_netem_enqueue(comm_netem_t *nm, interface_t *intf, pkt_buf_t *pkt,
+                       uint64_t now_ns)
+{
+    comm_netem_intf_t *ni = comm_netem_get_intf(nm, intf);
+    const comm_netem_cfg_t *cfg = &ni->cfg;
+    uint64_t due, span;
+
+    ni->sent++;
+    if (comm_netem_lose(ni)) {
+        pkt_buf_free(pkt);
+        return -1;
+    }
+    if (ni->q.count + ni->fast.count >= cfg->limit) {
+        ni->overlimit++;
+        pkt_buf_free(pkt);
+        return -1;
+    }
+
+    // The frame is on the wire once the ones ahead of it are
+    due = now_ns;
+    if (cfg->rate_bps) {
+        if (ni->busy_until > due)
+            due = ni->busy_until;
+        due += (uint64_t)pkt->pkt_len * 8000000000ull / cfg->rate_bps;
+        ni->busy_until = due;
+    }
+
+    pkt->tstamp = due;
+    if (comm_netem_hit(ni, ni->reorder_thr)) {
+        ni->reordered++;
+        pkt_queue_push(&ni->fast, pkt);
+        return 0;
+    }
+
+    due += cfg->delay_ns;
+    if (cfg->jitter_ns) {
+        span = comm_netem_rand(&ni->rng) % (2 * cfg->jitter_ns + 1);
+        due = due + span > cfg->jitter_ns ? due + span - cfg->jitter_ns : 0;
+    }
+    // Jitter alone does not reorder
+    if (due < ni->last_due)
+        due = ni->last_due;
+    ni->last_due = due;
+    pkt->tstamp = due;
+    pkt_queue_push(&ni->q, pkt);
+    return 0;
+}
+
+/**
+ * @brief      Moves the frames due by now to out.
+ *
+ * @param[in]  nm      Emulation.
+ * @param[in]  intf    Interface the frames left by.
+ * @param[in]  now_ns  Current time.
+ * @param[out] out     Queue extended with the due frames.
+ *
+ * @return     The number of frames moved.
+ */
+uint32_t comm_netem_dequeue(comm_netem_t *nm, interface_t *intf,
+                            uint64_t now_ns, pkt_queue_t *out)
+{
+    comm_netem_intf_t *ni = comm_netem_get_intf(nm, intf);
+    pkt_queue_t *q;
+    uint32_t n = 0;
+
+    while (out->count < out->limit && (q = comm_netem_head(ni)) &&
+           PKT_BUF_FROM_GLUE(q->lst.head)->tstamp <= now_ns) {
+        pkt_queue_push(out, pkt_queue_pop(q));
+        n++;
+    }
+    ni->delivered += n;
+    return n;
+}
+
+/**
+ * @brief      Tells when the next frame is due.
+ *
+ * @param[in]  nm    Emulation.
+ * @param[in]  intf  Interface.
+ *
+ * @return     The due time, or UINT64_MAX.
+ */
+uint64_t comm_netem_next(comm_netem_t *nm, interface_t *intf)
+{
+    pkt_queue_t *q = comm_netem_head(comm_netem_get_intf(nm, intf));
+
+    return q ? PKT_BUF_FROM_GLUE(q->lst.head)->tstamp : UINT64_MAX;
+}
+
+#endif    // COMM_NETEM_C
@@ -0,0 +1,253 @@
+/* -----------------------------------------------------------------------------
+ * @file:        comm_netem.h
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        21/10/2026 09:00 PM
+ * @license:     MIT
+ * @description: This header file declares link impairment emulation, a stage
+ *               a frame passes through between being sent out of an
+ *               interface and being handed to the transport. Each direction
+ *               of each link can limit its rate, add propagation delay and
+ *               jitter, lose frames at random or in bursts after the
+ *               Gilbert-Elliott model, and let some frames skip the delay so
+ *               that they overtake the ones ahead of them. Frames wait on
+ *               time-ordered pkt_queue_t queues, due time in
+ *               pkt_buf_t.tstamp, and leave once the caller's clock has
+ *               reached that time. The clock is whatever the caller passes
+ *               in, so a simulation can run on virtual time, and all
+ *               randomness comes from a generator per direction seeded from
+ *               one topology seed, so a run is reproduced exactly by using
+ *               the same seed, clock and traffic.
+ *               The contents are organized into three groups:
+ *
+ *                 1. Structs:
+ *                    - struct comm_netem_cfg_t
+ *                    - struct comm_netem_intf_t
+ *                    - struct comm_netem_t
+ *
+ *                 2. Functions:
+ *                    - comm_netem_create
+ *                    - comm_netem_destroy
+ *                    - comm_netem_set
+ *                    - comm_netem_set_link
+ *                    - comm_netem_enqueue
+ *                    - comm_netem_dequeue
+ *                    - comm_netem_next
+ *                    - comm_netem_get_intf
+ *
+ *                 3. Macros:
+ *                    - COMM_NETEM_LIMIT
+ *
+ * @note:        This code is part of the tcpip-stack project, which is a course
+ *               on network development.
+ *
+ * Revision History:
+ *
+ * Revision 0.1: 21/10/2026 Marko Trickovic
+ * Initial version.
+ */
+
+#ifndef COMM_NETEM_H
+#define COMM_NETEM_H
+
+#include <stdint.h>
+#include "../graph/graph.h"
+#include "../pkt/pkt_queue.h"
+
+/** Frames held per direction when the configuration gives no limit. */
+#define COMM_NETEM_LIMIT        1000
+
+/**
+ * @brief      The structure representing the impairments of one direction of
+ *             a link. A zeroed one passes every frame through at once.
+ *             Probabilities are in [0, 1].
+ *
+ * @struct                comm_netem_cfg_t
+ *
+ * @param[in]  rate_bps   Link rate in bits per second, 0 for no limit.
+ * @param[in]  delay_ns   Propagation delay.
+ * @param[in]  jitter_ns  Delay varies uniformly within +/- jitter_ns; frames
+ *                        still leave in order unless reordered.
+ * @param[in]  loss       Probability a frame is lost, independent of others.
+ * @param[in]  ge_p       Gilbert-Elliott: probability to go from the good to
+ *                        the bad state, 0 for no burst loss.
+ * @param[in]  ge_r       Probability to go from the bad to the good state.
+ * @param[in]  ge_bad     Probability a frame is lost in the bad state.
+ * @param[in]  ge_good    Probability a frame is lost in the good state.
+ * @param[in]  reorder    Probability a frame skips delay and jitter.
+ * @param[in]  limit      Most frames held, 0 for COMM_NETEM_LIMIT.
+ */
+typedef struct comm_netem_cfg_ {
+    uint64_t rate_bps;
+    uint64_t delay_ns;
+    uint64_t jitter_ns;
+    double loss;
+    double ge_p;
+    double ge_r;
+    double ge_bad;
+    double ge_good;
+    double reorder;
+    uint32_t limit;
+} comm_netem_cfg_t;
+
+/**
+ * @brief      The structure representing one direction of a link, named by
+ *             the interface frames leave through. Probabilities are kept as
+ *             thresholds on 32 random bits.
+ *
+ * @struct                comm_netem_intf_t
+ *
+ * @param[in]  cfg        Configuration.
+ * @param[in]  loss_thr   cfg.loss as a threshold.
+ * @param[in]  ge_p_thr   cfg.ge_p as a threshold.
+ * @param[in]  ge_r_thr   cfg.ge_r as a threshold.
+ * @param[in]  ge_bad_thr cfg.ge_bad as a threshold.
+ * @param[in]  ge_good_thr cfg.ge_good as a threshold.
+ * @param[in]  reorder_thr cfg.reorder as a threshold.
+ * @param[in]  rng        Generator state.
+ * @param[in]  ge_state   1 in the bad state.
+ * @param[in]  busy_until When the link finishes sending the frames accepted.
+ * @param[in]  last_due   Latest due time given to a frame kept in order.
+ * @param[in]  q          Held frames that took the delay, earliest due
+ *                        first.
+ * @param[in]  fast       Held frames that skipped it, earliest due first.
+ * @param[in]  sent       Frames passed in, lost ones included.
+ * @param[in]  delivered  Frames that left the queue.
+ * @param[in]  lost       Frames lost at random.
+ * @param[in]  ge_lost    Frames lost by the Gilbert-Elliott model.
+ * @param[in]  reordered  Frames that skipped the delay.
+ * @param[in]  overlimit  Frames dropped because the queue was full.
+ */
+typedef struct comm_netem_intf_ {
+    comm_netem_cfg_t cfg;
+    uint64_t loss_thr;
+    uint64_t ge_p_thr;
+    uint64_t ge_r_thr;
+    uint64_t ge_bad_thr;
+    uint64_t ge_good_thr;
+    uint64_t reorder_thr;
+    uint64_t rng;
+    int ge_state;
+    uint64_t busy_until;
+    uint64_t last_due;
+    pkt_queue_t q;
+    pkt_queue_t fast;
+    uint64_t sent;
+    uint64_t delivered;
+    uint64_t lost;
+    uint64_t ge_lost;
+    uint64_t reordered;
+    uint64_t overlimit;
+} comm_netem_intf_t;
+
+/**
+ * @brief      The structure representing the impairments of a topology.
+ *
+ * @struct                comm_netem_t
+ *
+ * @param[in]  graph      Topology.
+ * @param[in]  seed       Seed every direction's generator derives from.
+ * @param[in]  intfs      Directions, indexed by the ifindex frames leave by.
+ * @param[in]  nintfs     Entries in intfs.
+ */
+typedef struct comm_netem_ {
+    graph_t *graph;
+    uint64_t seed;
+    comm_netem_intf_t *intfs;
+    uint32_t nintfs;
+} comm_netem_t;
+
+/**
+ * @brief      Creates the emulation of a topology with every link
+ *             unimpaired.
+ *
+ * @param[in]  graph  Topology, not changed while the emulation exists.
+ * @param[in]  seed   Seed of the generators.
+ *
+ * @return     The emulation, or NULL when out of memory.
+ */
+comm_netem_t *comm_netem_create(graph_t *graph, uint64_t seed);
+
+/**
+ * @brief      Frees the emulation along with every frame it holds.
+ *
+ * @param[in]  nm  Emulation, may be NULL.
+ */
+void comm_netem_destroy(comm_netem_t *nm);
+
+/**
+ * @brief      Configures the direction frames sent out of an interface take
+ *             and restarts its generator from the seed, so the same
+ *             configuration sequence always draws the same numbers. Frames
+ *             already held keep their due times.
+ *
+ * @param[in]  nm    Emulation.
+ * @param[in]  intf  Interface.
+ * @param[in]  cfg   Impairments, NULL for none.
+ *
+ * @return     0 on success, -1 with errno EINVAL for a probability outside
+ *             [0, 1].
+ */
+int comm_netem_set(comm_netem_t *nm, interface_t *intf,
+                   const comm_netem_cfg_t *cfg);
+
+/**
+ * @brief      Configures both directions of the link of an interface alike.
+ *
+ * @param[in]  nm    Emulation.
+ * @param[in]  intf  Interface at either end.
+ * @param[in]  cfg   Impairments, NULL for none.
+ *
+ * @return     0 on success, -1 with errno EINVAL.
+ */
+int comm_netem_set_link(comm_netem_t *nm, interface_t *intf,
+                        const comm_netem_cfg_t *cfg);
+
+/**
+ * @brief      Passes a frame sent out of an interface at time now to the
+ *             emulation, which either holds it until it is due or loses it.
+ *
+ * @param[in]  nm      Emulation.
+ * @param[in]  intf    Interface the frame leaves by.
+ * @param[in]  pkt     Frame, not on any glthread.
+ * @param[in]  now_ns  Current time.
+ *
+ * @return     0 when held, -1 when lost or over the limit and freed.
+ */
+int comm_netem_enqueue(comm_netem_t *nm, interface_t *intf, pkt_buf_t *pkt,
+                       uint64_t now_ns);
+
+/**
+ * @brief      Moves every frame due by now to the tail of out, in due time
+ *             order.
+ *
+ * @param[in]  nm      Emulation.
+ * @param[in]  intf    Interface the frames left by.
+ * @param[in]  now_ns  Current time.
+ * @param[out] out     Queue the due frames are added to.
+ *
+ * @return     The number of frames moved.
+ */
+uint32_t comm_netem_dequeue(comm_netem_t *nm, interface_t *intf,
+                            uint64_t now_ns, pkt_queue_t *out);
+
+/**
+ * @brief      Tells when the next frame sent out of an interface is due.
+ *
+ * @param[in]  nm    Emulation.
+ * @param[in]  intf  Interface.
+ *
+ * @return     The due time, or UINT64_MAX when nothing is held.
+ */
+uint64_t comm_netem_next(comm_netem_t *nm, interface_t *intf);
+
+/**
+ * @brief      Retrieves the direction frames sent out of an interface take.
+ */
+static inline comm_netem_intf_t *comm_netem_get_intf(comm_netem_t *nm,
+                                                     interface_t *intf)
+{
+    return &nm->intfs[intf->ifindex];
+}
+
+#endif    // COMM_NETEM_H
@@ -0,0 +1,443 @@
+/******************************************************************************
+ * @file:        comm_shm.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        21/10/2026 07:00 PM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the shared-memory link transport. The
+ *               mapping holds the comm_shm_t, the node states, the interface
+ *               states and the rings, in that order, each cache-line
+ *               aligned. Sending works as in comm_spsc.c, backlog first so
+ *               frames keep their order, but the backlog has no limit. A
+ *               waiter sets idle and then looks at its rings once more; a
+ *               sender publishes frames and then looks at idle, with a full
+ *               barrier on both sides, so at least one of them sees the
+ *               other and no wakeup is lost. Only the sender that clears
+ *               idle writes the eventfd, so a burst to an idle node costs
+ *               one write and frames to a busy node cost none. A waiter
+ *               also pushes its own backlogs and does not sleep while a
+ *               peer ring has room for them; a receiver that frees room
+ *               wakes the sender if it is idle with a backlog, by the same
+ *               barrier pairing.
+ *
+ *               Functions in this file:
+ *                 - comm_shm_create
+ *                 - comm_shm_destroy
+ *                 - comm_shm_send
+ *                 - comm_shm_send_burst
+ *                 - comm_shm_flush
+ *                 - comm_shm_recv
+ *                 - comm_shm_recv_burst
+ *                 - comm_shm_wait
+ *                 - comm_shm_get_node
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 21/10/2026 Marko Trickovic
+ * Initial version.
+ *
+ * Revision 0.2: 21/10/2026 Marko Trickovic
+ * Backlogs are drained while waiting and receivers wake backlogged senders.
+ *****************************************************************************/
+
+#ifndef COMM_SHM_C
+#define COMM_SHM_C
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include "comm_shm.h"
+
+#define COMM_SHM_ALIGN          64
+#define COMM_SHM_DRAIN_BURST    64
+
+static inline size_t comm_shm_align(size_t n)
+{
+    return (n + COMM_SHM_ALIGN - 1) & ~(size_t)(COMM_SHM_ALIGN - 1);
+}
+
+/**
+ * @brief      Maps the transport of a topology.
+ *
+ * @param[in]  graph      Topology.
+ * @param[in]  pool       A PKT_POOL_SHARED pool.
+ * @param[in]  ring_size  Slots per ring, 0 for the default.
+ *
+ * @return     The transport, or NULL with errno set.
+ */
+comm_shm_t *comm_shm_create(graph_t *graph, pkt_pool_t *pool,
+                            uint32_t ring_size)
+{
+    size_t ring_bytes, nodes_off, intfs_off, rings_off, size;
+    glthread_t *lst = &graph->node_list;
+    uint32_t nintfs = graph->ifindex_next, i, j;
+    comm_shm_node_t *cn;
+    comm_shm_intf_t *ci;
+    comm_shm_t *sh;
+    node_t *node;
+    void *mem;
+    int fd, err;
+
+    if (!ring_size)
+        ring_size = COMM_SHM_RING_SIZE;
+    ring_bytes = comm_shm_align(pkt_ring_memsize(ring_size));
+    if (!(pool->flags & PKT_POOL_SHARED) || ring_bytes == 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    nodes_off = comm_shm_align(sizeof(comm_shm_t));
+    intfs_off = nodes_off + graph->node_count * sizeof(comm_shm_node_t);
+    rings_off = intfs_off + nintfs * sizeof(comm_shm_intf_t);
+    size = rings_off + nintfs * ring_bytes;
+
+    fd = memfd_create("comm_shm", MFD_CLOEXEC);
+    if (fd < 0)
+        return NULL;
+    if (ftruncate(fd, (off_t)size) < 0) {
+        err = errno;
+        close(fd);
+        errno = err;
+        return NULL;
+    }
+    mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    err = errno;
+    close(fd);
+    if (mem == MAP_FAILED) {
+        errno = err;
+        return NULL;
+    }
+
+    // memfd pages start zeroed
+    sh = mem;
+    sh->graph = graph;
+    sh->pool = pool;
+    sh->map_size = size;
+    sh->nodes = (comm_shm_node_t *)((unsigned char *)mem + nodes_off);
+    sh->intfs = (comm_shm_intf_t *)((unsigned char *)mem + intfs_off);
+    sh->nintfs = nintfs;
+    for (i = 0; i < nintfs; i++)
+        pkt_queue_init(&sh->intfs[i].backlog, PKT_QUEUE_UNBOUNDED);
+
+    ITERATE_GL_THREADS_BEGIN(lst, node_t, node) {
+        cn = &sh->nodes[sh->nnodes++];
+        cn->node = node;
+        cn->efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (cn->efd < 0)
+            goto fail;
+        for (j = 0; j < node->intf_count; j++)
+            sh->intfs[node->intf[j].ifindex].owner = cn;
+    } ITERATE_GL_THREADS_ENDS;
+
+    // ifindex 0 is never assigned, every other one belongs to a link
+    for (i = 1; i < nintfs; i++)
+        sh->intfs[i].rx = pkt_ring_init((unsigned char *)mem + rings_off +
+                                        i * ring_bytes, ring_size);
+    for (i = 1; i < nintfs; i++) {
+        ci = comm_shm_get_intf(sh, graph->ifindex_tbl[i]->nbr);
+        sh->intfs[i].peer = ci->rx;
+        sh->intfs[i].peer_node = ci->owner;
+    }
+    return sh;
+
+fail:
+    err = errno;
+    comm_shm_destroy(sh);
+    errno = err;
+    return NULL;
+}
+
+/**
+ * @brief      Frees the frames the transport holds and unmaps it.
+ *
+ * @param[in]  sh  Transport, may be NULL.
+ */
+void comm_shm_destroy(comm_shm_t *sh)
+{
+    pkt_buf_t *pkt;
+    uint32_t i;
+
+    if (!sh)
+        return;
+
+    for (i = 1; i < sh->nintfs; i++) {
+        pkt_queue_flush(&sh->intfs[i].backlog);
+        while (sh->intfs[i].rx && (pkt = pkt_ring_pop(sh->intfs[i].rx)))
+            pkt_buf_free(pkt);
+    }
+    // A node whose eventfd failed is the last one counted
+    for (i = 0; i < sh->nnodes; i++)
+        if (sh->nodes[i].efd >= 0)
+            close(sh->nodes[i].efd);
+    munmap(sh, sh->map_size);
+}
+
+/**
+ * @brief      Wakes a node if it is idle.
+ *
+ * @param[in]  cn  Node, NULL for an unowned interface.
+ */
+static void comm_shm_wake(comm_shm_node_t *cn)
+{
+    // Pairs with the barrier in comm_shm_wait: the frames just published
+    // are seen by the waiter or its idle flag is seen here
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (!cn || !__atomic_load_n(&cn->idle, __ATOMIC_RELAXED))
+        return;
+    if (!__atomic_exchange_n(&cn->idle, 0, __ATOMIC_ACQ_REL))
+        return;
+    if (eventfd_write(cn->efd, 1) == 0)
+        __atomic_add_fetch(&cn->wakeups, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief      Wakes the node sending on an interface if it is idle with a
+ *             backlog, after room was made in the ring the backlog goes to.
+ *
+ * @param[in]  src  State of the sending interface.
+ */
+static void comm_shm_wake_sender(comm_shm_intf_t *src)
+{
+    // Pairs with the barrier in comm_shm_wait: the room just made is seen
+    // by the waiter or its idle flag, and the backlog before it, here
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (!__atomic_load_n(&src->owner->idle, __ATOMIC_ACQUIRE) ||
+        !__atomic_load_n(&src->backlog.count, __ATOMIC_RELAXED))
+        return;
+    comm_shm_wake(src->owner);
+}
+
+/**
+ * @brief      Moves backlogged frames to the neighbour's ring while it has
+ *             room.
+ *
+ * @param[in]  ci  Interface state.
+ *
+ * @return     The number of frames moved.
+ */
+static uint32_t comm_shm_drain(comm_shm_intf_t *ci)
+{
+    pkt_buf_t *pkts[COMM_SHM_DRAIN_BURST];
+    uint32_t room, n, i, moved = 0;
+
+    while (!pkt_queue_empty(&ci->backlog) && (room = pkt_ring_room(ci->peer))) {
+        n = ci->backlog.count;
+        if (n > room)
+            n = room;
+        if (n > COMM_SHM_DRAIN_BURST)
+            n = COMM_SHM_DRAIN_BURST;
+        for (i = 0; i < n; i++)
+            pkts[i] = pkt_queue_pop(&ci->backlog);
+        pkt_ring_push_burst(ci->peer, pkts, n);
+        moved += n;
+    }
+    ci->tx_pkts += moved;
+    return moved;
+}
+
+/**
+ * @brief      Sends n frames out of an interface.
+ *
+ * @param[in]  sh    Transport.
+ * @param[in]  intf  Interface of the sending node.
+ * @param[in]  pkts  Frames.
+ * @param[in]  n     Number of frames.
+ */
+void comm_shm_send_burst(comm_shm_t *sh, interface_t *intf,
+                         pkt_buf_t *const *pkts, uint32_t n)
+{
+    comm_shm_intf_t *ci = comm_shm_get_intf(sh, intf);
+    uint32_t moved = 0, done = 0, i;
+
+    if (!pkt_queue_empty(&ci->backlog))
+        moved = comm_shm_drain(ci);
+    if (pkt_queue_empty(&ci->backlog)) {
+        done = pkt_ring_push_burst(ci->peer, pkts, n);
+        ci->tx_pkts += done;
+    }
+    for (i = done; i < n; i++)
+        pkt_queue_push(&ci->backlog, pkts[i]);
+    ci->backlogged += n - done;
+
+    if (moved || done)
+        comm_shm_wake(ci->peer_node);
+}
+
+/**
+ * @brief      Sends a frame out of an interface.
+ *
+ * @param[in]  sh    Transport.
+ * @param[in]  intf  Interface of the sending node.
+ * @param[in]  pkt   Frame.
+ */
+void comm_shm_send(comm_shm_t *sh, interface_t *intf, pkt_buf_t *pkt)
+{
+    comm_shm_send_burst(sh, intf, &pkt, 1);
+}
+
+/**
+ * @brief      Moves the backlog of an interface to the neighbour's ring.
+ *
+ * @param[in]  sh    Transport.
+ * @param[in]  intf  Interface of the sending node.
+ *
+ * @return     The number of frames still on the backlog.
+ */
+uint32_t comm_shm_flush(comm_shm_t *sh, interface_t *intf)
+{
+    comm_shm_intf_t *ci = comm_shm_get_intf(sh, intf);
+
+    if (comm_shm_drain(ci))
+        comm_shm_wake(ci->peer_node);
+    return ci->backlog.count;
+}
+
+/**
+ * @brief      Takes the oldest frame received on an interface.
+ *
+ * @param[in]  sh    Transport.
+ * @param[in]  intf  Interface.
+ *
+ * @return     The frame, or NULL.
+ */
+pkt_buf_t *comm_shm_recv(comm_shm_t *sh, interface_t *intf)
+{
+    pkt_buf_t *pkt;
+
+    return comm_shm_recv_burst(sh, intf, &pkt, 1) ? pkt : NULL;
+}
+
+/**
+ * @brief      Takes up to max frames received on an interface.
+ *
+ * @param[in]  sh    Transport.
+ * @param[in]  intf  Interface.
+ * @param[out] pkts  Frames.
+ * @param[in]  max   Most frames wanted.
+ *
+ * @return     The number of frames taken.
+ */
+uint32_t comm_shm_recv_burst(comm_shm_t *sh, interface_t *intf,
+                             pkt_buf_t **pkts, uint32_t max)
+{
+    comm_shm_intf_t *ci = comm_shm_get_intf(sh, intf);
+    uint32_t n;
+
+    n = pkt_ring_pop_burst(ci->rx, pkts, max);
+    ci->rx_pkts += n;
+    if (n)
+        comm_shm_wake_sender(comm_shm_get_intf(sh, intf->nbr));
+    return n;
+}
+
+// Tells whether a frame waits on any interface of a node
+static int comm_shm_pending(comm_shm_t *sh, comm_shm_node_t *cn)
+{
+    uint32_t i;
+
+    for (i = 0; i < cn->node->intf_count; i++)
+        if (pkt_ring_count(sh->intfs[cn->node->intf[i].ifindex].rx))
+            return 1;
+    return 0;
+}
+
+// Moves what fits of every backlog of a node, returns 1 when a backlog is
+// left behind a ring that has room again
+static int comm_shm_drain_node(comm_shm_t *sh, comm_shm_node_t *cn)
+{
+    comm_shm_intf_t *ci;
+    uint32_t i;
+    int again = 0;
+
+    for (i = 0; i < cn->node->intf_count; i++) {
+        ci = &sh->intfs[cn->node->intf[i].ifindex];
+        if (pkt_queue_empty(&ci->backlog))
+            continue;
+        if (comm_shm_drain(ci))
+            comm_shm_wake(ci->peer_node);
+        if (!pkt_queue_empty(&ci->backlog) && pkt_ring_room(ci->peer))
+            again = 1;
+    }
+    return again;
+}
+
+static int64_t comm_shm_now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * @brief      Waits for a frame on any interface of a node, moving the
+ *             node's backlogs to their rings as room is made.
+ *
+ * @param[in]  sh          Transport.
+ * @param[in]  cn          Node.
+ * @param[in]  timeout_ms  Longest wait, -1 for no limit.
+ *
+ * @return     1 when a frame is waiting, 0 on timeout.
+ */
+int comm_shm_wait(comm_shm_t *sh, comm_shm_node_t *cn, int timeout_ms)
+{
+    struct pollfd pfd = { .fd = cn->efd, .events = POLLIN };
+    int64_t deadline, left = -1;
+    eventfd_t val;
+    int rc;
+
+    if (comm_shm_pending(sh, cn))
+        return 1;
+
+    deadline = comm_shm_now_ms() + timeout_ms;
+    do {
+        __atomic_store_n(&cn->idle, 1, __ATOMIC_RELEASE);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        rc = 1;
+        if (!comm_shm_drain_node(sh, cn) && !comm_shm_pending(sh, cn)) {
+            if (timeout_ms >= 0) {
+                left = deadline - comm_shm_now_ms();
+                if (left < 0)
+                    left = 0;
+            }
+            cn->sleeps++;
+            rc = poll(&pfd, 1, (int)left);
+            // A wakeup that lost the race with the check above is consumed
+            // by the next wait, which then returns at once
+            eventfd_read(cn->efd, &val);
+        }
+        __atomic_store_n(&cn->idle, 0, __ATOMIC_RELAXED);
+
+        if (comm_shm_pending(sh, cn))
+            return 1;
+        // Woken by room for a backlog, or by EINTR, it goes round again
+    } while (rc && (timeout_ms < 0 || comm_shm_now_ms() < deadline));
+    return 0;
+}
+
+/**
+ * @brief      Retrieves the state of a node.
+ *
+ * @param[in]  sh    Transport.
+ * @param[in]  node  Node.
+ *
+ * @return     The state, or NULL.
+ */
+comm_shm_node_t *comm_shm_get_node(comm_shm_t *sh, node_t *node)
+{
+    uint32_t i;
+
+    for (i = 0; i < sh->nnodes; i++)
+        if (sh->nodes[i].node == node)
+            return &sh->nodes[i];
+    return NULL;
+}
+
+#endif    // COMM_SHM_C
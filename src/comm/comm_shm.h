@@ -0,0 +1,255 @@
+/* -----------------------------------------------------------------------------
+ * @file:        comm_shm.h
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        21/10/2026 07:00 PM
+ * @license:     MIT
+ * @description: This header file declares the shared-memory link transport,
+ *               for topologies whose nodes are split over several processes.
+ *               The transport, its per-interface pkt_ring_t rings and the
+ *               per-node wakeup state are one MAP_SHARED memfd mapping, and
+ *               frames come from a PKT_POOL_SHARED pool, so a frame crosses
+ *               a process boundary by handing its pointer over. Both
+ *               mappings must be made before the node processes are forked
+ *               from the creator, which is what keeps every pointer valid in
+ *               each of them. A process that owns a node sends and receives
+ *               on its interfaces with no syscall while the neighbour is
+ *               busy; comm_shm_wait blocks on the node's eventfd, and a
+ *               sender only writes that eventfd when it finds the node
+ *               idle. A full ring never drops a frame: it waits on the
+ *               glthread backlog of the sending interface, which is bounded
+ *               only by the pool, and comm_shm_wait moves it on as the
+ *               receiver makes room.
+ *               The contents are organized into three groups:
+ *
+ *                 1. Structs:
+ *                    - struct comm_shm_node_t
+ *                    - struct comm_shm_intf_t
+ *                    - struct comm_shm_t
+ *
+ *                 2. Functions:
+ *                    - comm_shm_create
+ *                    - comm_shm_destroy
+ *                    - comm_shm_send
+ *                    - comm_shm_send_burst
+ *                    - comm_shm_flush
+ *                    - comm_shm_recv
+ *                    - comm_shm_recv_burst
+ *                    - comm_shm_wait
+ *                    - comm_shm_get_node
+ *                    - comm_shm_get_intf
+ *
+ *                 3. Macros:
+ *                    - COMM_SHM_RING_SIZE
+ *
+ * @note:        This code is part of the tcpip-stack project, which is a course
+ *               on network development.
+ *
+ * Revision History:
+ *
+ * Revision 0.1: 21/10/2026 Marko Trickovic
+ * Initial version.
+ *
+ * Revision 0.2: 21/10/2026 Marko Trickovic
+ * comm_shm_wait drains the node's backlogs.
+ */
+
+#ifndef COMM_SHM_H
+#define COMM_SHM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../graph/graph.h"
+#include "../pkt/pkt_queue.h"
+#include "../pkt/pkt_ring.h"
+
+/** Ring slots per interface when comm_shm_create is given 0. */
+#define COMM_SHM_RING_SIZE      1024
+
+/**
+ * @brief      The structure representing the wakeup state of a node. idle
+ *             is written by the node's process and by its neighbours, so it
+ *             sits on a line of its own.
+ *
+ * @struct                comm_shm_node_t
+ *
+ * @param[in]  node       Node.
+ * @param[in]  efd        Eventfd the node's process blocks on.
+ * @param[in]  sleeps     Times the node blocked in comm_shm_wait.
+ * @param[in]  idle       Set while the node is about to block or blocked.
+ * @param[in]  wakeups    Eventfd writes made to wake the node.
+ */
+typedef struct comm_shm_node_ {
+    node_t *node;
+    int efd;
+    uint64_t sleeps;
+    uint32_t idle __attribute__((aligned(64)));
+    uint64_t wakeups;
+} __attribute__((aligned(64))) comm_shm_node_t;
+
+/**
+ * @brief      The structure representing one interface. The receive side is
+ *             only touched by the process owning the interface's node, the
+ *             send side only by the same process when it sends, on another
+ *             line since the two run at different times.
+ *
+ * @struct                comm_shm_intf_t
+ *
+ * @param[in]  rx         Frames sent to this interface by its neighbour.
+ * @param[in]  owner      Node owning the interface.
+ * @param[in]  rx_pkts    Frames received.
+ * @param[in]  peer       Ring of the neighbour, where sent frames go.
+ * @param[in]  peer_node  Node owning the neighbour, woken when idle.
+ * @param[in]  backlog    Frames sent while peer was full, oldest first.
+ * @param[in]  tx_pkts    Frames handed to peer.
+ * @param[in]  backlogged Frames that had to wait on the backlog.
+ */
+typedef struct comm_shm_intf_ {
+    pkt_ring_t *rx;
+    comm_shm_node_t *owner;
+    uint64_t rx_pkts;
+    pkt_ring_t *peer __attribute__((aligned(64)));
+    comm_shm_node_t *peer_node;
+    pkt_queue_t backlog;
+    uint64_t tx_pkts;
+    uint64_t backlogged;
+} __attribute__((aligned(64))) comm_shm_intf_t;
+
+/**
+ * @brief      The structure representing the shared-memory transport of a
+ *             topology. It is the start of its own shared mapping.
+ *
+ * @struct                comm_shm_t
+ *
+ * @param[in]  graph      Topology.
+ * @param[in]  pool       PKT_POOL_SHARED pool frames come from.
+ * @param[in]  map_size   Bytes of the mapping.
+ * @param[in]  nodes      Node state, in node list order.
+ * @param[in]  nnodes     Entries in nodes.
+ * @param[in]  intfs      Interface state, indexed by ifindex.
+ * @param[in]  nintfs     Entries in intfs.
+ */
+typedef struct comm_shm_ {
+    graph_t *graph;
+    pkt_pool_t *pool;
+    size_t map_size;
+    comm_shm_node_t *nodes;
+    uint32_t nnodes;
+    comm_shm_intf_t *intfs;
+    uint32_t nintfs;
+} comm_shm_t;
+
+/**
+ * @brief      Maps the transport and creates a ring for every linked
+ *             interface and an eventfd for every node. Processes that run
+ *             nodes are forked after this call.
+ *
+ * @param[in]  graph      Topology, not changed while the transport exists.
+ * @param[in]  pool       A PKT_POOL_SHARED pool.
+ * @param[in]  ring_size  Slots per ring, 0 for COMM_SHM_RING_SIZE.
+ *
+ * @return     The transport, or NULL with errno set.
+ */
+comm_shm_t *comm_shm_create(graph_t *graph, pkt_pool_t *pool,
+                            uint32_t ring_size);
+
+/**
+ * @brief      Frees every frame in a ring or on a backlog and unmaps the
+ *             transport. Called by the creator once the other processes are
+ *             done with it.
+ *
+ * @param[in]  sh  Transport, may be NULL.
+ */
+void comm_shm_destroy(comm_shm_t *sh);
+
+/**
+ * @brief      Sends a frame out of an interface to its neighbour, waking the
+ *             neighbour's node if it is idle. The frame goes on the backlog
+ *             when the neighbour's ring is full.
+ *
+ * @param[in]  sh    Transport.
+ * @param[in]  intf  Interface of a node this process owns.
+ * @param[in]  pkt   Frame from the transport's pool, not on any glthread.
+ */
+void comm_shm_send(comm_shm_t *sh, interface_t *intf, pkt_buf_t *pkt);
+
+/**
+ * @brief      Sends n frames out of an interface, in order, with at most
+ *             one wakeup.
+ *
+ * @param[in]  sh    Transport.
+ * @param[in]  intf  Interface of a node this process owns.
+ * @param[in]  pkts  Frames, not on any glthread.
+ * @param[in]  n     Number of frames.
+ */
+void comm_shm_send_burst(comm_shm_t *sh, interface_t *intf,
+                         pkt_buf_t *const *pkts, uint32_t n);
+
+/**
+ * @brief      Moves as much of the backlog of an interface as fits to the
+ *             neighbour's ring.
+ *
+ * @param[in]  sh    Transport.
+ * @param[in]  intf  Interface of a node this process owns.
+ *
+ * @return     The number of frames still on the backlog.
+ */
+uint32_t comm_shm_flush(comm_shm_t *sh, interface_t *intf);
+
+/**
+ * @brief      Takes the oldest frame received on an interface.
+ *
+ * @param[in]  sh    Transport.
+ * @param[in]  intf  Interface of a node this process owns.
+ *
+ * @return     The frame, or NULL when none is waiting.
+ */
+pkt_buf_t *comm_shm_recv(comm_shm_t *sh, interface_t *intf);
+
+/**
+ * @brief      Takes up to max frames received on an interface.
+ *
+ * @param[in]  sh    Transport.
+ * @param[in]  intf  Interface of a node this process owns.
+ * @param[out] pkts  Frames, oldest first.
+ * @param[in]  max   Most frames wanted.
+ *
+ * @return     The number of frames taken.
+ */
+uint32_t comm_shm_recv_burst(comm_shm_t *sh, interface_t *intf,
+                             pkt_buf_t **pkts, uint32_t max);
+
+/**
+ * @brief      Waits until a frame is waiting on an interface of a node.
+ *             Returns at once, with no syscall, when one already is.
+ *             Meanwhile the node's backlogs are moved to their rings each
+ *             time the receivers make room, which wakes the node.
+ *
+ * @param[in]  sh          Transport.
+ * @param[in]  cn          Node this process owns.
+ * @param[in]  timeout_ms  Longest wait, -1 for no limit.
+ *
+ * @return     1 when a frame is waiting, 0 on timeout.
+ */
+int comm_shm_wait(comm_shm_t *sh, comm_shm_node_t *cn, int timeout_ms);
+
+/**
+ * @brief      Retrieves the state of a node.
+ *
+ * @param[in]  sh    Transport.
+ * @param[in]  node  Node.
+ *
+ * @return     The state, or NULL for a node of another topology.
+ */
+comm_shm_node_t *comm_shm_get_node(comm_shm_t *sh, node_t *node);
+
+/**
+ * @brief      Retrieves the transport state of an interface.
+ */
+static inline comm_shm_intf_t *comm_shm_get_intf(comm_shm_t *sh,
+                                                 interface_t *intf)
+{
+    return &sh->intfs[intf->ifindex];
+}
+
+#endif    // COMM_SHM_H
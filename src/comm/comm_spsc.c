@@ -0,0 +1,234 @@
+/******************************************************************************
+ * @file:        comm_spsc.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        21/10/2026 05:00 PM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the in-process link transport. A send
+ *               first moves whatever waits on the backlog, so frames keep
+ *               their order across a full ring, and only then pushes the new
+ *               frames; what does not fit is appended to the backlog. The
+ *               backlog is popped only as far as the ring has room, which the
+ *               producer learns with one read of the consumer index, so a
+ *               frame is never taken off the glthread before it has a slot.
+ *
+ *               Functions in this file:
+ *                 - comm_spsc_create
+ *                 - comm_spsc_destroy
+ *                 - comm_spsc_send
+ *                 - comm_spsc_send_burst
+ *                 - comm_spsc_flush
+ *                 - comm_spsc_recv
+ *                 - comm_spsc_recv_burst
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 21/10/2026 Marko Trickovic
+ * Initial version.
+ *****************************************************************************/
+
+#ifndef COMM_SPSC_C
+#define COMM_SPSC_C
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include "comm_spsc.h"
+
+#define COMM_SPSC_DRAIN_BURST   64
+
+/**
+ * @brief      Creates the transport of a topology.
+ *
+ * @param[in]  graph      Topology.
+ * @param[in]  ring_size  Slots per ring, 0 for the default.
+ *
+ * @return     The transport, or NULL with errno set.
+ */
+comm_spsc_t *comm_spsc_create(graph_t *graph, uint32_t ring_size)
+{
+    comm_spsc_t *sp;
+    uint32_t i;
+
+    if (!ring_size)
+        ring_size = COMM_SPSC_RING_SIZE;
+
+    sp = calloc(1, sizeof(*sp));
+    if (!sp)
+        return NULL;
+    sp->graph = graph;
+    sp->nintfs = graph->ifindex_next;
+    sp->intfs = aligned_alloc(64, sp->nintfs * sizeof(comm_spsc_intf_t));
+    if (!sp->intfs) {
+        free(sp);
+        errno = ENOMEM;
+        return NULL;
+    }
+    memset(sp->intfs, 0, sp->nintfs * sizeof(comm_spsc_intf_t));
+    for (i = 0; i < sp->nintfs; i++)
+        pkt_queue_init(&sp->intfs[i].backlog, COMM_SPSC_BACKLOG);
+
+    // ifindex 0 is never assigned, every other one belongs to a link
+    for (i = 1; i < sp->nintfs; i++) {
+        sp->intfs[i].rx = pkt_ring_create(ring_size);
+        if (!sp->intfs[i].rx) {
+            comm_spsc_destroy(sp);
+            errno = ENOMEM;
+            return NULL;
+        }
+    }
+    for (i = 1; i < sp->nintfs; i++)
+        sp->intfs[i].peer = comm_spsc_get_intf(sp,
+                                               graph->ifindex_tbl[i]->nbr)->rx;
+    return sp;
+}
+
+/**
+ * @brief      Frees the transport and every frame it holds.
+ *
+ * @param[in]  sp  Transport, may be NULL.
+ */
+void comm_spsc_destroy(comm_spsc_t *sp)
+{
+    uint32_t i;
+
+    if (!sp)
+        return;
+
+    for (i = 0; i < sp->nintfs; i++) {
+        pkt_queue_flush(&sp->intfs[i].backlog);
+        pkt_ring_destroy(sp->intfs[i].rx);
+    }
+    free(sp->intfs);
+    free(sp);
+}
+
+/**
+ * @brief      Moves backlogged frames to the neighbour's ring while it has
+ *             room.
+ *
+ * @param[in]  ci  Interface state.
+ */
+static void comm_spsc_drain(comm_spsc_intf_t *ci)
+{
+    pkt_buf_t *pkts[COMM_SPSC_DRAIN_BURST];
+    uint32_t room, n, i;
+
+    while (!pkt_queue_empty(&ci->backlog) && (room = pkt_ring_room(ci->peer))) {
+        n = ci->backlog.count;
+        if (n > room)
+            n = room;
+        if (n > COMM_SPSC_DRAIN_BURST)
+            n = COMM_SPSC_DRAIN_BURST;
+        for (i = 0; i < n; i++)
+            pkts[i] = pkt_queue_pop(&ci->backlog);
+        pkt_ring_push_burst(ci->peer, pkts, n);
+        ci->tx_pkts += n;
+    }
+}
+
+/**
+ * @brief      Sends n frames out of an interface.
+ *
+ * @param[in]  sp    Transport.
+ * @param[in]  intf  Interface of the sending node.
+ * @param[in]  pkts  Frames.
+ * @param[in]  n     Number of frames.
+ *
+ * @return     The number of frames accepted.
+ */
+uint32_t comm_spsc_send_burst(comm_spsc_t *sp, interface_t *intf,
+                              pkt_buf_t *const *pkts, uint32_t n)
+{
+    comm_spsc_intf_t *ci = comm_spsc_get_intf(sp, intf);
+    uint32_t done = 0, ok, i;
+
+    if (!pkt_queue_empty(&ci->backlog))
+        comm_spsc_drain(ci);
+    if (pkt_queue_empty(&ci->backlog)) {
+        done = pkt_ring_push_burst(ci->peer, pkts, n);
+        ci->tx_pkts += done;
+    }
+
+    for (ok = done, i = done; i < n; i++) {
+        if (pkt_queue_push(&ci->backlog, pkts[i]) < 0) {
+            pkt_buf_free(pkts[i]);
+            ci->tx_drops++;
+            continue;
+        }
+        ci->backlogged++;
+        ok++;
+    }
+    return ok;
+}
+
+/**
+ * @brief      Sends a frame out of an interface.
+ *
+ * @param[in]  sp    Transport.
+ * @param[in]  intf  Interface of the sending node.
+ * @param[in]  pkt   Frame.
+ *
+ * @return     0 on success, -1 when the frame was dropped.
+ */
+int comm_spsc_send(comm_spsc_t *sp, interface_t *intf, pkt_buf_t *pkt)
+{
+    return comm_spsc_send_burst(sp, intf, &pkt, 1) ? 0 : -1;
+}
+
+/**
+ * @brief      Moves the backlog of an interface to the neighbour's ring.
+ *
+ * @param[in]  sp    Transport.
+ * @param[in]  intf  Interface of the sending node.
+ *
+ * @return     The number of frames still on the backlog.
+ */
+uint32_t comm_spsc_flush(comm_spsc_t *sp, interface_t *intf)
+{
+    comm_spsc_intf_t *ci = comm_spsc_get_intf(sp, intf);
+
+    comm_spsc_drain(ci);
+    return ci->backlog.count;
+}
+
+/**
+ * @brief      Takes the oldest frame received on an interface.
+ *
+ * @param[in]  sp    Transport.
+ * @param[in]  intf  Interface.
+ *
+ * @return     The frame, or NULL.
+ */
+pkt_buf_t *comm_spsc_recv(comm_spsc_t *sp, interface_t *intf)
+{
+    pkt_buf_t *pkt;
+
+    return comm_spsc_recv_burst(sp, intf, &pkt, 1) ? pkt : NULL;
+}
+
+/**
+ * @brief      Takes up to max frames received on an interface.
+ *
+ * @param[in]  sp    Transport.
+ * @param[in]  intf  Interface.
+ * @param[out] pkts  Frames.
+ * @param[in]  max   Most frames wanted.
+ *
+ * @return     The number of frames taken.
+ */
+uint32_t comm_spsc_recv_burst(comm_spsc_t *sp, interface_t *intf,
+                              pkt_buf_t **pkts, uint32_t max)
+{
+    comm_spsc_intf_t *ci = comm_spsc_get_intf(sp, intf);
+    uint32_t n;
+
+    n = pkt_ring_pop_burst(ci->rx, pkts, max);
+    ci->rx_pkts += n;
+    return n;
+}
+
+#endif    // COMM_SPSC_C
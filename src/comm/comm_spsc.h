@@ -0,0 +1,190 @@
+/* -----------------------------------------------------------------------------
+ * @file:        comm_spsc.h
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        21/10/2026 05:00 PM
+ * @license:     MIT
+ * @description: This header file declares the in-process link transport,
+ *               for topologies whose nodes all run in one process. Every
+ *               interface owns a pkt_ring_t that frames sent by its
+ *               neighbour land in, so a frame crosses a link by handing its
+ *               pointer over: no copy, no syscall and no lock. When the ring
+ *               is full the sender keeps the frame on a glthread backlog of
+ *               its interface and moves it to the ring, ahead of any later
+ *               frame, once the receiver has made room. Each direction of a
+ *               link has one producer and one consumer, so at most one thread
+ *               may send out of an interface and one receive on it at a
+ *               time.
+ *               The contents are organized into three groups:
+ *
+ *                 1. Structs:
+ *                    - struct comm_spsc_intf_t
+ *                    - struct comm_spsc_t
+ *
+ *                 2. Functions:
+ *                    - comm_spsc_create
+ *                    - comm_spsc_destroy
+ *                    - comm_spsc_send
+ *                    - comm_spsc_send_burst
+ *                    - comm_spsc_flush
+ *                    - comm_spsc_recv
+ *                    - comm_spsc_recv_burst
+ *                    - comm_spsc_get_intf
+ *
+ *                 3. Macros:
+ *                    - COMM_SPSC_RING_SIZE
+ *                    - COMM_SPSC_BACKLOG
+ *
+ * @note:        This code is part of the tcpip-stack project, which is a course
+ *               on network development.
+ *
+ * Revision History:
+ *
+ * Revision 0.1: 21/10/2026 Marko Trickovic
+ * Initial version.
+ */
+
+#ifndef COMM_SPSC_H
+#define COMM_SPSC_H
+
+#include <stdint.h>
+#include "../graph/graph.h"
+#include "../pkt/pkt_queue.h"
+#include "../pkt/pkt_ring.h"
+
+/** Ring slots per interface when comm_spsc_create is given 0. */
+#define COMM_SPSC_RING_SIZE     1024
+
+/** Frames waiting on the backlog of an interface before new ones drop. */
+#define COMM_SPSC_BACKLOG       65536
+
+/**
+ * @brief      The structure representing one interface. The receive side
+ *             and the send side sit on separate cache lines since they are
+ *             touched by the threads at the two ends of different links.
+ *
+ * @struct                comm_spsc_intf_t
+ *
+ * @param[in]  rx         Frames sent to this interface by its neighbour.
+ * @param[in]  rx_pkts    Frames received.
+ * @param[in]  peer       Ring of the neighbour, where sent frames go.
+ * @param[in]  backlog    Frames sent while peer was full, oldest first.
+ * @param[in]  tx_pkts    Frames handed to peer.
+ * @param[in]  tx_drops   Frames dropped because the backlog was full.
+ * @param[in]  backlogged Frames that had to wait on the backlog.
+ */
+typedef struct comm_spsc_intf_ {
+    pkt_ring_t *rx;
+    uint64_t rx_pkts;
+    pkt_ring_t *peer __attribute__((aligned(64)));
+    pkt_queue_t backlog;
+    uint64_t tx_pkts;
+    uint64_t tx_drops;
+    uint64_t backlogged;
+} __attribute__((aligned(64))) comm_spsc_intf_t;
+
+/**
+ * @brief      The structure representing the in-process transport of a
+ *             topology.
+ *
+ * @struct                comm_spsc_t
+ *
+ * @param[in]  graph      Topology.
+ * @param[in]  intfs      Interface state, indexed by ifindex.
+ * @param[in]  nintfs     Entries in intfs.
+ */
+typedef struct comm_spsc_ {
+    graph_t *graph;
+    comm_spsc_intf_t *intfs;
+    uint32_t nintfs;
+} comm_spsc_t;
+
+/**
+ * @brief      Creates a ring for every linked interface.
+ *
+ * @param[in]  graph      Topology, not changed while the transport exists.
+ * @param[in]  ring_size  Slots per ring, 0 for COMM_SPSC_RING_SIZE.
+ *
+ * @return     The transport, or NULL with errno set.
+ */
+comm_spsc_t *comm_spsc_create(graph_t *graph, uint32_t ring_size);
+
+/**
+ * @brief      Frees the transport along with every frame in a ring or on a
+ *             backlog.
+ *
+ * @param[in]  sp  Transport, may be NULL.
+ */
+void comm_spsc_destroy(comm_spsc_t *sp);
+
+/**
+ * @brief      Sends a frame out of an interface to its neighbour. The frame
+ *             goes on the backlog when the neighbour's ring is full.
+ *
+ * @param[in]  sp    Transport.
+ * @param[in]  intf  Interface of the sending node.
+ * @param[in]  pkt   Frame, not on any glthread.
+ *
+ * @return     0 on success, -1 when the backlog was full and the frame was
+ *             freed.
+ */
+int comm_spsc_send(comm_spsc_t *sp, interface_t *intf, pkt_buf_t *pkt);
+
+/**
+ * @brief      Sends n frames out of an interface, in order.
+ *
+ * @param[in]  sp    Transport.
+ * @param[in]  intf  Interface of the sending node.
+ * @param[in]  pkts  Frames, not on any glthread.
+ * @param[in]  n     Number of frames.
+ *
+ * @return     The number of frames accepted, the rest were dropped.
+ */
+uint32_t comm_spsc_send_burst(comm_spsc_t *sp, interface_t *intf,
+                              pkt_buf_t *const *pkts, uint32_t n);
+
+/**
+ * @brief      Moves as much of the backlog of an interface as fits to the
+ *             neighbour's ring. Senders call it when they have nothing new
+ *             to send but frames may still be waiting.
+ *
+ * @param[in]  sp    Transport.
+ * @param[in]  intf  Interface of the sending node.
+ *
+ * @return     The number of frames still on the backlog.
+ */
+uint32_t comm_spsc_flush(comm_spsc_t *sp, interface_t *intf);
+
+/**
+ * @brief      Takes the oldest frame received on an interface.
+ *
+ * @param[in]  sp    Transport.
+ * @param[in]  intf  Interface.
+ *
+ * @return     The frame, or NULL when none is waiting.
+ */
+pkt_buf_t *comm_spsc_recv(comm_spsc_t *sp, interface_t *intf);
+
+/**
+ * @brief      Takes up to max frames received on an interface.
+ *
+ * @param[in]  sp    Transport.
+ * @param[in]  intf  Interface.
+ * @param[out] pkts  Frames, oldest first.
+ * @param[in]  max   Most frames wanted.
+ *
+ * @return     The number of frames taken.
+ */
+uint32_t comm_spsc_recv_burst(comm_spsc_t *sp, interface_t *intf,
+                              pkt_buf_t **pkts, uint32_t max);
+
+/**
+ * @brief      Retrieves the transport state of an interface.
+ */
+static inline comm_spsc_intf_t *comm_spsc_get_intf(comm_spsc_t *sp,
+                                                   interface_t *intf)
+{
+    return &sp->intfs[intf->ifindex];
+}
+
+#endif    // COMM_SPSC_H
@@ -0,0 +1,799 @@
+/******************************************************************************
+ * @file:        comm_uring.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        21/10/2026 03:00 PM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the io_uring backend of the link
+ *               transport. The ring thread loops over four steps: it reaps
+ *               completions, staging received frames per interface and
+ *               delivering each interface's frames under one lock; it hands
+ *               the buffer ids consumed by the kernel back with fresh pool
+ *               blocks and re-arms receives that ended; it drains the TX
+ *               queues of the interfaces that were kicked into SQEs; and it
+ *               submits everything and waits for completions with a single
+ *               io_uring_enter. Received frames land with their payload at
+ *               the pool headroom since each provided buffer starts
+ *               sizeof(struct io_uring_recvmsg_out) bytes before it.
+ *               Producers only write the kick eventfd when the thread has
+ *               declared itself idle, so a busy thread takes no wakeups.
+ *
+ *               Functions in this file:
+ *                 - comm_uring_create
+ *                 - comm_uring_start
+ *                 - comm_uring_stop
+ *                 - comm_uring_destroy
+ *                 - comm_uring_kick
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 21/10/2026 Marko Trickovic
+ * Initial version with multishot receive into provided pool blocks and
+ * batched fixed-buffer writes.
+ *****************************************************************************/
+
+#ifndef COMM_URING_C
+#define COMM_URING_C
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "comm_uring.h"
+
+/* Kinds of request, in the upper half of user_data. */
+#define COMM_URING_KICK     1
+#define COMM_URING_RX       2
+#define COMM_URING_TX       3
+#define COMM_URING_TIMER    4
+#define COMM_URING_CANCEL   5
+
+#define COMM_URING_UDATA(kind, idx)   ((uint64_t)(kind) << 32 | (uint32_t)(idx))
+
+/* Buffer group of the provided receive buffers. */
+#define COMM_URING_BGID     0
+
+/* A frame being sent and the interface to account it to. */
+typedef struct comm_uring_tx_ {
+    pkt_buf_t *pkt;
+    comm_intf_t *ci;
+} comm_uring_tx_t;
+
+/* Read by the kernel when a multishot recvmsg is armed, no name or control
+ * data is wanted so the payload follows the recvmsg_out header. */
+static struct msghdr comm_uring_rx_msg;
+
+/* How long the thread sleeps before retrying to refill an empty buffer
+ * ring when the pool has run dry. */
+static struct __kernel_timespec comm_uring_retry = { .tv_nsec = 1000000 };
+
+static int comm_uring_sys_setup(unsigned entries, struct io_uring_params *p)
+{
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int comm_uring_sys_enter(int fd, unsigned to_submit,
+                                unsigned min_complete, unsigned flags)
+{
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete,
+                        flags, NULL, 0);
+}
+
+static int comm_uring_sys_register(int fd, unsigned opcode, void *arg,
+                                   unsigned nr_args)
+{
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+/**
+ * @brief      Maps the submission and completion rings.
+ *
+ * @param[in]  ur  Backend.
+ * @param[in]  p   Parameters filled in by io_uring_setup.
+ *
+ * @return     0 on success, -1 with errno set.
+ */
+static int comm_uring_map(comm_uring_t *ur, const struct io_uring_params *p)
+{
+    ur->sq_size = p->sq_off.array + p->sq_entries * sizeof(unsigned);
+    ur->cq_size = p->cq_off.cqes + p->cq_entries * sizeof(struct io_uring_cqe);
+    if (p->features & IORING_FEAT_SINGLE_MMAP) {
+        if (ur->cq_size > ur->sq_size)
+            ur->sq_size = ur->cq_size;
+        ur->cq_size = ur->sq_size;
+    }
+
+    ur->sq_ring = mmap(NULL, ur->sq_size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, ur->fd, IORING_OFF_SQ_RING);
+    if (ur->sq_ring == MAP_FAILED) {
+        ur->sq_ring = NULL;
+        return -1;
+    }
+    if (p->features & IORING_FEAT_SINGLE_MMAP) {
+        ur->cq_ring = ur->sq_ring;
+    } else {
+        ur->cq_ring = mmap(NULL, ur->cq_size, PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_POPULATE, ur->fd,
+                           IORING_OFF_CQ_RING);
+        if (ur->cq_ring == MAP_FAILED) {
+            ur->cq_ring = NULL;
+            return -1;
+        }
+    }
+    ur->sqes_size = p->sq_entries * sizeof(struct io_uring_sqe);
+    ur->sqes = mmap(NULL, ur->sqes_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ur->fd, IORING_OFF_SQES);
+    if (ur->sqes == MAP_FAILED) {
+        ur->sqes = NULL;
+        return -1;
+    }
+
+    ur->sq_head = (unsigned *)((char *)ur->sq_ring + p->sq_off.head);
+    ur->sq_tail = (unsigned *)((char *)ur->sq_ring + p->sq_off.tail);
+    ur->sq_mask = (unsigned *)((char *)ur->sq_ring + p->sq_off.ring_mask);
+    ur->sq_array = (unsigned *)((char *)ur->sq_ring + p->sq_off.array);
+    ur->sq_entries = p->sq_entries;
+    ur->cq_head = (unsigned *)((char *)ur->cq_ring + p->cq_off.head);
+    ur->cq_tail = (unsigned *)((char *)ur->cq_ring + p->cq_off.tail);
+    ur->cq_mask = (unsigned *)((char *)ur->cq_ring + p->cq_off.ring_mask);
+    ur->cqes = (struct io_uring_cqe *)((char *)ur->cq_ring + p->cq_off.cqes);
+    return 0;
+}
+
+/**
+ * @brief      Submits the prepared entries and optionally waits for
+ *             completions.
+ *
+ * @param[in]  ur    Backend.
+ * @param[in]  wait  Completions to wait for, 0 not to wait.
+ *
+ * @return     The number of entries submitted, -1 with errno set.
+ */
+static int comm_uring_enter(comm_uring_t *ur, unsigned wait)
+{
+    int n;
+
+    if (!ur->to_submit && !wait)
+        return 0;
+
+    n = comm_uring_sys_enter(ur->fd, ur->to_submit, wait,
+                             wait ? IORING_ENTER_GETEVENTS : 0);
+    ur->enters++;
+    if (n < 0)
+        return -1;
+    ur->to_submit -= (unsigned)n;
+    return n;
+}
+
+/**
+ * @brief      Takes a cleared submission queue entry, submitting what is
+ *             queued first when the queue is full. Without SQPOLL the kernel
+ *             reads entries only in io_uring_enter, so the tail is moved
+ *             before the caller fills the entry in.
+ *
+ * @param[in]  ur  Backend.
+ *
+ * @return     The entry, or NULL when the queue stays full.
+ */
+static struct io_uring_sqe *comm_uring_sqe(comm_uring_t *ur)
+{
+    struct io_uring_sqe *sqe;
+    unsigned tail = *ur->sq_tail, idx;
+
+    if (tail - __atomic_load_n(ur->sq_head, __ATOMIC_ACQUIRE) >=
+        ur->sq_entries) {
+        comm_uring_enter(ur, 0);
+        if (tail - __atomic_load_n(ur->sq_head, __ATOMIC_ACQUIRE) >=
+            ur->sq_entries)
+            return NULL;
+    }
+
+    idx = tail & *ur->sq_mask;
+    sqe = &ur->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    ur->sq_array[idx] = idx;
+    __atomic_store_n(ur->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ur->to_submit++;
+    return sqe;
+}
+
+/**
+ * @brief      Arms a multishot recvmsg on the socket of an interface.
+ *
+ * @param[in]  ur       Backend.
+ * @param[in]  ifindex  Interface.
+ *
+ * @return     0 on success, -1 when the submission queue is full.
+ */
+static int comm_uring_arm_rx(comm_uring_t *ur, uint32_t ifindex)
+{
+    struct io_uring_sqe *sqe = comm_uring_sqe(ur);
+
+    if (!sqe)
+        return -1;
+    sqe->opcode = IORING_OP_RECVMSG;
+    sqe->fd = ur->comm->intfs[ifindex].fd;
+    sqe->addr = (uintptr_t)&comm_uring_rx_msg;
+    sqe->len = 1;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = COMM_URING_BGID;
+    sqe->user_data = COMM_URING_UDATA(COMM_URING_RX, ifindex);
+    ur->rx_armed++;
+    return 0;
+}
+
+/**
+ * @brief      Arms a read of the kick eventfd.
+ *
+ * @param[in]  ur  Backend.
+ */
+static void comm_uring_arm_kick(comm_uring_t *ur)
+{
+    struct io_uring_sqe *sqe = comm_uring_sqe(ur);
+
+    if (!sqe)
+        return;
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = ur->kick_fd;
+    sqe->addr = (uintptr_t)&ur->kick_val;
+    sqe->len = sizeof(ur->kick_val);
+    sqe->user_data = COMM_URING_UDATA(COMM_URING_KICK, 0);
+    ur->kick_armed = 1;
+}
+
+/**
+ * @brief      Arms a timeout that wakes the thread to retry refilling.
+ *
+ * @param[in]  ur  Backend.
+ */
+static void comm_uring_arm_timer(comm_uring_t *ur)
+{
+    struct io_uring_sqe *sqe = comm_uring_sqe(ur);
+
+    if (!sqe)
+        return;
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->addr = (uintptr_t)&comm_uring_retry;
+    sqe->len = 1;
+    sqe->user_data = COMM_URING_UDATA(COMM_URING_TIMER, 0);
+    ur->timer_armed = 1;
+}
+
+/**
+ * @brief      Gives the missing buffer ids fresh pool blocks, publishes them
+ *             to the kernel and re-arms the receives that ended once there
+ *             are buffers to receive into.
+ *
+ * @param[in]  ur  Backend.
+ */
+static void comm_uring_refill(comm_uring_t *ur)
+{
+    pkt_buf_t *pkts[64];
+    struct io_uring_buf *buf;
+    uint32_t n, i;
+    uint16_t bid;
+
+    while (ur->nmissing) {
+        n = pkt_buf_alloc_bulk(ur->comm->pool, pkts,
+                               ur->nmissing < 64 ? ur->nmissing : 64);
+        for (i = 0; i < n; i++) {
+            bid = ur->missing[--ur->nmissing];
+            ur->rx_bufs[bid] = pkts[i];
+            buf = &ur->br->bufs[ur->br_tail & (ur->nbufs - 1)];
+            buf->addr = (uintptr_t)(pkts[i]->data -
+                                    sizeof(struct io_uring_recvmsg_out));
+            buf->len = ur->comm->max_frame +
+                       sizeof(struct io_uring_recvmsg_out);
+            buf->bid = bid;
+            ur->br_tail++;
+        }
+        if (n < 64)
+            break;
+    }
+    __atomic_store_n(&ur->br->tail, ur->br_tail, __ATOMIC_RELEASE);
+
+    if (ur->nmissing == ur->nbufs) {
+        // The pool is dry, frames wait in the sockets until it is not
+        if (!ur->timer_armed)
+            comm_uring_arm_timer(ur);
+        return;
+    }
+    while (ur->nrearm && comm_uring_arm_rx(ur, ur->rearm[ur->nrearm - 1]) == 0)
+        ur->nrearm--;
+}
+
+/**
+ * @brief      Handles the completion of a multishot receive.
+ *
+ * @param[in]  ur       Backend.
+ * @param[in]  ifindex  Interface.
+ * @param[in]  res      Bytes written to the buffer, or -errno.
+ * @param[in]  flags    Completion flags.
+ * @param[in]  ntouched Entries in touched, updated.
+ */
+static void comm_uring_rx(comm_uring_t *ur, uint32_t ifindex, int res,
+                          uint32_t flags, uint32_t *ntouched)
+{
+    const struct io_uring_recvmsg_out *out;
+    pkt_queue_t *burst = &ur->bursts[ifindex];
+    pkt_buf_t *pkt;
+    uint16_t bid;
+
+    if (!(flags & IORING_CQE_F_MORE)) {
+        ur->rx_armed--;
+        ur->rearm[ur->nrearm++] = ifindex;
+    }
+    if (!(flags & IORING_CQE_F_BUFFER))
+        return;
+
+    bid = (uint16_t)(flags >> IORING_CQE_BUFFER_SHIFT);
+    pkt = ur->rx_bufs[bid];
+    ur->rx_bufs[bid] = NULL;
+    ur->missing[ur->nmissing++] = bid;
+
+    out = (const struct io_uring_recvmsg_out *)
+          (pkt->data - sizeof(struct io_uring_recvmsg_out));
+    // An interface is touched by its first frame of the pass, lost or not
+    if (pkt_queue_empty(burst) && !ur->rx_errs[ifindex])
+        ur->touched[(*ntouched)++] = ifindex;
+
+    if (res < (int)sizeof(*out) || (out->flags & MSG_TRUNC)) {
+        // Counted when the burst is delivered, so touched stays unique
+        pkt_buf_free(pkt);
+        ur->rx_errs[ifindex]++;
+        return;
+    }
+
+    pkt_buf_put(pkt, (uint32_t)res - sizeof(*out));
+    pkt_queue_push(burst, pkt);
+}
+
+/**
+ * @brief      Handles the completion of a send.
+ *
+ * @param[in]  ur    Backend.
+ * @param[in]  slot  Slot of the frame.
+ * @param[in]  res   Bytes sent, or -errno.
+ */
+static void comm_uring_tx_done(comm_uring_t *ur, uint32_t slot, int res)
+{
+    comm_uring_tx_t *tx = &ur->tx[slot];
+
+    __atomic_add_fetch(res < 0 ? &tx->ci->tx_errs : &tx->ci->tx_pkts, 1,
+                       __ATOMIC_RELAXED);
+    pkt_buf_free(tx->pkt);
+    tx->pkt = NULL;
+    ur->tx_free[ur->ntx_free++] = slot;
+    ur->tx_busy--;
+}
+
+/**
+ * @brief      Handles every completion posted so far, then delivers the
+ *             frames received to their interfaces.
+ *
+ * @param[in]  ur  Backend.
+ */
+static void comm_uring_reap(comm_uring_t *ur)
+{
+    unsigned head = *ur->cq_head, tail;
+    struct io_uring_cqe *cqe;
+    uint32_t ntouched = 0, i, ifindex;
+
+    tail = __atomic_load_n(ur->cq_tail, __ATOMIC_ACQUIRE);
+    for (; head != tail; head++) {
+        cqe = &ur->cqes[head & *ur->cq_mask];
+        switch (cqe->user_data >> 32) {
+        case COMM_URING_KICK:
+            ur->kick_armed = 0;
+            break;
+        case COMM_URING_RX:
+            comm_uring_rx(ur, (uint32_t)cqe->user_data, cqe->res, cqe->flags,
+                          &ntouched);
+            break;
+        case COMM_URING_TX:
+            comm_uring_tx_done(ur, (uint32_t)cqe->user_data, cqe->res);
+            break;
+        case COMM_URING_TIMER:
+            ur->timer_armed = 0;
+            break;
+        }
+    }
+    __atomic_store_n(ur->cq_head, head, __ATOMIC_RELEASE);
+
+    for (i = 0; i < ntouched; i++) {
+        ifindex = ur->touched[i];
+        comm_rx_deliver(&ur->comm->intfs[ifindex], &ur->bursts[ifindex],
+                        ur->rx_errs[ifindex]);
+        ur->rx_errs[ifindex] = 0;
+    }
+}
+
+/**
+ * @brief      Puts an interface on the pending list unless it is on it.
+ *
+ * @param[in]  ur  Backend.
+ * @param[in]  ci  Interface state.
+ */
+static void comm_uring_pend(comm_uring_t *ur, comm_intf_t *ci)
+{
+    pthread_mutex_lock(&ur->lock);
+    if (!ci->tx_pending) {
+        glthread_node_init((&ci->tx_glue));
+        glthread_add(&ur->pending, &ci->tx_glue);
+        ci->tx_pending = 1;
+        __atomic_store_n(&ur->npending, ur->npending + 1, __ATOMIC_SEQ_CST);
+    }
+    pthread_mutex_unlock(&ur->lock);
+}
+
+/**
+ * @brief      Turns the frames queued on the pending interfaces into send
+ *             entries. Interfaces left with frames, for want of slots or
+ *             entries, go back on the pending list.
+ *
+ * @param[in]  ur  Backend.
+ */
+static void comm_uring_drain_tx(comm_uring_t *ur)
+{
+    comm_t *comm = ur->comm;
+    struct io_uring_sqe *sqe;
+    glthread_node_t *glue;
+    comm_intf_t *ci;
+    pkt_buf_t *pkt;
+    uint32_t n = 0, i, slot;
+    int left;
+
+    // Taken off the list first, a producer may put them back at any time
+    pthread_mutex_lock(&ur->lock);
+    while ((glue = ur->pending.head)) {
+        glthread_remove(&ur->pending, glue);
+        ci = GLTHREAD_GET_USER_DATA_FROM_OFFSET(glue,
+                                                offset(comm_intf_t, tx_glue));
+        ci->tx_pending = 0;
+        ur->work[n++] = ci;
+    }
+    __atomic_store_n(&ur->npending, 0, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&ur->lock);
+
+    for (i = 0; i < n; i++) {
+        ci = ur->work[i];
+        pthread_mutex_lock(&ci->tx_lock);
+        while (!pkt_queue_empty(&ci->txq)) {
+            pkt = PKT_BUF_FROM_GLUE(ci->txq.lst.head);
+            if (pkt->nsegs > 1) {
+                // A chain would need a msghdr kept per slot, not supported
+                pkt_buf_free(pkt_queue_pop(&ci->txq));
+                __atomic_add_fetch(&ci->tx_errs, 1, __ATOMIC_RELAXED);
+                continue;
+            }
+            if (!ur->ntx_free || !(sqe = comm_uring_sqe(ur)))
+                break;
+
+            pkt_queue_pop(&ci->txq);
+            slot = ur->tx_free[--ur->ntx_free];
+            ur->tx_busy++;
+            ur->tx[slot].pkt = pkt;
+            ur->tx[slot].ci = ci;
+            if (ur->fixed && pkt->pool == comm->pool) {
+                sqe->opcode = IORING_OP_WRITE_FIXED;
+                sqe->buf_index = 0;
+            } else {
+                sqe->opcode = IORING_OP_SEND;
+            }
+            sqe->fd = ci->fd;
+            sqe->addr = (uintptr_t)pkt->data;
+            sqe->len = pkt->len;
+            sqe->user_data = COMM_URING_UDATA(COMM_URING_TX, slot);
+        }
+        left = !pkt_queue_empty(&ci->txq);
+        pthread_mutex_unlock(&ci->tx_lock);
+        if (left)
+            comm_uring_pend(ur, ci);
+    }
+}
+
+/**
+ * @brief      Ring thread.
+ *
+ * @param[in]  arg  Backend.
+ *
+ * @return     NULL.
+ */
+static void *comm_uring_thread(void *arg)
+{
+    comm_uring_t *ur = arg;
+    unsigned wait;
+
+    for (;;) {
+        comm_uring_reap(ur);
+        if (__atomic_load_n(&ur->stop, __ATOMIC_ACQUIRE))
+            return NULL;
+        comm_uring_refill(ur);
+        comm_uring_drain_tx(ur);
+        if (!ur->kick_armed)
+            comm_uring_arm_kick(ur);
+
+        // Idle is published before pending is checked, and producers
+        // check idle after publishing pending, so one of them sees the
+        // other and no kick is lost
+        if (__atomic_load_n(&ur->npending, __ATOMIC_SEQ_CST)) {
+            wait = !ur->ntx_free;
+        } else {
+            __atomic_store_n(&ur->idle, 1, __ATOMIC_SEQ_CST);
+            wait = !__atomic_load_n(&ur->npending, __ATOMIC_SEQ_CST);
+        }
+
+        if (comm_uring_enter(ur, wait) < 0 && errno != EINTR &&
+            errno != EAGAIN && errno != EBUSY)
+            return NULL;
+        __atomic_store_n(&ur->idle, 0, __ATOMIC_SEQ_CST);
+    }
+}
+
+/**
+ * @brief      Cancels every request in flight and reaps until the kernel
+ *             no longer holds any buffer or frame.
+ *
+ * @param[in]  ur  Backend.
+ */
+static void comm_uring_quiesce(comm_uring_t *ur)
+{
+    struct io_uring_sqe *sqe = comm_uring_sqe(ur);
+
+    if (!sqe)
+        return;
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY;
+    sqe->user_data = COMM_URING_UDATA(COMM_URING_CANCEL, 0);
+
+    ur->nrearm = 0;
+    while (ur->rx_armed || ur->kick_armed || ur->timer_armed || ur->tx_busy) {
+        if (comm_uring_enter(ur, 1) < 0 && errno != EINTR && errno != EAGAIN)
+            return;
+        comm_uring_reap(ur);
+    }
+}
+
+/**
+ * @brief      Sets up the ring and arms the receives.
+ *
+ * @param[in]  comm  Transport.
+ *
+ * @return     The backend, or NULL with errno set.
+ */
+comm_uring_t *comm_uring_create(comm_t *comm)
+{
+    pkt_pool_t *pool = comm->pool;
+    struct io_uring_buf_reg reg;
+    struct io_uring_params p;
+    struct iovec region;
+    comm_uring_t *ur;
+    unsigned head, tail;
+    uint32_t i;
+    int err;
+
+    if (comm->max_segs != 1 ||
+        pool->headroom < sizeof(struct io_uring_recvmsg_out)) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    ur = calloc(1, sizeof(*ur));
+    if (!ur)
+        return NULL;
+    ur->comm = comm;
+    ur->fd = -1;
+    ur->kick_fd = -1;
+    pthread_mutex_init(&ur->lock, NULL);
+    init_glthread(&ur->pending, offset(comm_intf_t, tx_glue));
+
+    memset(&p, 0, sizeof(p));
+    p.flags = IORING_SETUP_CQSIZE;
+    p.cq_entries = 4 * COMM_URING_SQ_ENTRIES;
+    ur->fd = comm_uring_sys_setup(COMM_URING_SQ_ENTRIES, &p);
+    if (ur->fd < 0)
+        goto fail;
+    if (!(p.features & IORING_FEAT_NODROP) ||
+        !(p.features & IORING_FEAT_FAST_POLL)) {
+        errno = EOPNOTSUPP;
+        goto fail;
+    }
+    if (comm_uring_map(ur, &p) < 0)
+        goto fail;
+
+    // Best effort, without it frames are sent with plain sends
+    region.iov_base = pool->blks;
+    region.iov_len = (size_t)pool->nblks * pool->blk_stride;
+    ur->fixed = comm_uring_sys_register(ur->fd, IORING_REGISTER_BUFFERS,
+                                        &region, 1) == 0;
+
+    // Half the pool at most, the rest is for frames in queues and in flight
+    for (ur->nbufs = COMM_URING_RX_BUFS; ur->nbufs > pool->nfree_blks / 2;
+         ur->nbufs >>= 1)
+        ;
+    if (!ur->nbufs) {
+        errno = EINVAL;
+        goto fail;
+    }
+    ur->br_size = (ur->nbufs * sizeof(struct io_uring_buf) + 4095) & ~4095UL;
+    ur->br = mmap(NULL, ur->br_size, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ur->br == MAP_FAILED) {
+        ur->br = NULL;
+        goto fail;
+    }
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (uintptr_t)ur->br;
+    reg.ring_entries = ur->nbufs;
+    reg.bgid = COMM_URING_BGID;
+    if (comm_uring_sys_register(ur->fd, IORING_REGISTER_PBUF_RING, &reg,
+                                1) < 0)
+        goto fail;
+
+    ur->rx_bufs = calloc(ur->nbufs, sizeof(*ur->rx_bufs));
+    ur->missing = calloc(ur->nbufs, sizeof(*ur->missing));
+    ur->rearm = calloc(comm->nintfs, sizeof(*ur->rearm));
+    ur->tx = calloc(COMM_URING_TX_SLOTS, sizeof(*ur->tx));
+    ur->tx_free = calloc(COMM_URING_TX_SLOTS, sizeof(*ur->tx_free));
+    ur->work = calloc(comm->nintfs, sizeof(*ur->work));
+    ur->bursts = calloc(comm->nintfs, sizeof(*ur->bursts));
+    ur->touched = calloc(comm->nintfs, sizeof(*ur->touched));
+    ur->rx_errs = calloc(comm->nintfs, sizeof(*ur->rx_errs));
+    ur->kick_fd = eventfd(0, EFD_CLOEXEC);
+    if (!ur->rx_bufs || !ur->missing || !ur->rearm || !ur->tx ||
+        !ur->tx_free || !ur->work || !ur->bursts || !ur->touched ||
+        !ur->rx_errs || ur->kick_fd < 0)
+        goto fail;
+
+    for (i = 0; i < comm->nintfs; i++)
+        pkt_queue_init(&ur->bursts[i], PKT_QUEUE_UNBOUNDED);
+    for (i = 0; i < COMM_URING_TX_SLOTS; i++)
+        ur->tx_free[ur->ntx_free++] = COMM_URING_TX_SLOTS - 1 - i;
+
+    // Every buffer id and interface starts out missing, refill sets them up
+    for (i = 0; i < ur->nbufs; i++)
+        ur->missing[ur->nmissing++] = (uint16_t)(ur->nbufs - 1 - i);
+    for (i = comm->nintfs; i-- > 1; )
+        ur->rearm[ur->nrearm++] = i;
+    comm_uring_refill(ur);
+    comm_uring_arm_kick(ur);
+    if (ur->nrearm || comm_uring_enter(ur, 0) < 0 || ur->to_submit)
+        goto fail;
+
+    // A kernel without multishot recvmsg fails the receives straight away
+    head = *ur->cq_head;
+    tail = __atomic_load_n(ur->cq_tail, __ATOMIC_ACQUIRE);
+    for (; head != tail; head++)
+        if (ur->cqes[head & *ur->cq_mask].user_data >> 32 == COMM_URING_RX &&
+            ur->cqes[head & *ur->cq_mask].res == -EINVAL) {
+            errno = EOPNOTSUPP;
+            goto fail;
+        }
+
+    return ur;
+
+fail:
+    err = errno;
+    comm_uring_destroy(ur);
+    errno = err;
+    return NULL;
+}
+
+/**
+ * @brief      Starts the ring thread.
+ *
+ * @param[in]  ur  Backend.
+ *
+ * @return     0 on success, -1 with errno set.
+ */
+int comm_uring_start(comm_uring_t *ur)
+{
+    int err;
+
+    if (ur->running)
+        return 0;
+
+    __atomic_store_n(&ur->stop, 0, __ATOMIC_RELEASE);
+    err = pthread_create(&ur->thread, NULL, comm_uring_thread, ur);
+    if (err) {
+        errno = err;
+        return -1;
+    }
+    ur->running = 1;
+    pthread_setname_np(ur->thread, "uring");
+    return 0;
+}
+
+/**
+ * @brief      Stops and joins the ring thread.
+ *
+ * @param[in]  ur  Backend.
+ */
+void comm_uring_stop(comm_uring_t *ur)
+{
+    if (!ur->running)
+        return;
+
+    __atomic_store_n(&ur->stop, 1, __ATOMIC_RELEASE);
+    eventfd_write(ur->kick_fd, 1);
+    pthread_join(ur->thread, NULL);
+    ur->running = 0;
+}
+
+/**
+ * @brief      Tears the backend down.
+ *
+ * @param[in]  ur  Backend, may be NULL.
+ */
+void comm_uring_destroy(comm_uring_t *ur)
+{
+    uint32_t i;
+
+    if (!ur)
+        return;
+
+    comm_uring_stop(ur);
+    if (ur->rx_armed || ur->kick_armed || ur->timer_armed || ur->tx_busy)
+        comm_uring_quiesce(ur);
+    if (ur->fd >= 0)
+        close(ur->fd);
+
+    if (ur->rx_bufs)
+        for (i = 0; i < ur->nbufs; i++)
+            pkt_buf_free(ur->rx_bufs[i]);
+    if (ur->tx)
+        for (i = 0; i < COMM_URING_TX_SLOTS; i++)
+            pkt_buf_free(ur->tx[i].pkt);
+    if (ur->bursts)
+        for (i = 0; i < ur->comm->nintfs; i++)
+            pkt_queue_flush(&ur->bursts[i]);
+
+    if (ur->sqes)
+        munmap(ur->sqes, ur->sqes_size);
+    if (ur->cq_ring && ur->cq_ring != ur->sq_ring)
+        munmap(ur->cq_ring, ur->cq_size);
+    if (ur->sq_ring)
+        munmap(ur->sq_ring, ur->sq_size);
+    if (ur->br)
+        munmap(ur->br, ur->br_size);
+    if (ur->kick_fd >= 0)
+        close(ur->kick_fd);
+    pthread_mutex_destroy(&ur->lock);
+    free(ur->rx_bufs);
+    free(ur->missing);
+    free(ur->rearm);
+    free(ur->tx);
+    free(ur->tx_free);
+    free(ur->work);
+    free(ur->bursts);
+    free(ur->rx_errs);
+    free(ur->touched);
+    free(ur);
+}
+
+/**
+ * @brief      Hands the TX queue of an interface to the ring thread.
+ *
+ * @param[in]  ur  Backend.
+ * @param[in]  ci  Interface state.
+ */
+void comm_uring_kick(comm_uring_t *ur, comm_intf_t *ci)
+{
+    comm_uring_pend(ur, ci);
+    if (__atomic_exchange_n(&ur->idle, 0, __ATOMIC_SEQ_CST)) {
+        __atomic_add_fetch(&ur->kicks, 1, __ATOMIC_RELAXED);
+        eventfd_write(ur->kick_fd, 1);
+    }
+}
+
+#endif    // COMM_URING_C
@@ -0,0 +1,235 @@
+/* -----------------------------------------------------------------------------
+ * @file:        comm_uring.h
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        21/10/2026 03:00 PM
+ * @license:     MIT
+ * @description: This header file declares the io_uring backend of the link
+ *               transport, selected with COMM_URING. One thread services
+ *               every interface of the topology through one ring: each
+ *               socket has a multishot recvmsg armed that picks its buffers
+ *               from a ring of pool blocks provided to the kernel, and
+ *               frames queued with comm_enqueue are drained from the TX
+ *               queues of the interfaces into write SQEs on the registered
+ *               block region, submitted together with one io_uring_enter.
+ *               The ring is driven through the raw syscalls, so no library
+ *               is needed, and comm_create falls back to epoll when the
+ *               kernel lacks any of the features used.
+ *               The contents are organized into three groups:
+ *
+ *                 1. Structs:
+ *                    - struct comm_uring_t
+ *
+ *                 2. Functions:
+ *                    - comm_uring_create
+ *                    - comm_uring_start
+ *                    - comm_uring_stop
+ *                    - comm_uring_destroy
+ *                    - comm_uring_kick
+ *                    - comm_rx_deliver
+ *
+ *                 3. Macros:
+ *                    - COMM_URING_SQ_ENTRIES
+ *                    - COMM_URING_RX_BUFS
+ *                    - COMM_URING_TX_SLOTS
+ *
+ * @note:        This code is part of the tcpip-stack project, which is a course
+ *               on network development.
+ *
+ * Revision History:
+ *
+ * Revision 0.1: 21/10/2026 Marko Trickovic
+ * Initial version with multishot receive into provided pool blocks and
+ * batched fixed-buffer writes.
+ */
+
+#ifndef COMM_URING_H
+#define COMM_URING_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include "comm.h"
+
+/** Submission queue entries, the completion queue is four times larger. */
+#define COMM_URING_SQ_ENTRIES   1024
+
+/** Most pool blocks provided to the kernel for receiving. */
+#define COMM_URING_RX_BUFS      1024
+
+/** Most frames being sent at once. */
+#define COMM_URING_TX_SLOTS     1024
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct io_uring_buf_ring;
+struct comm_uring_tx_;
+
+/**
+ * @brief      The structure representing the ring and the thread that
+ *             services it.
+ *
+ * @struct                comm_uring_t
+ *
+ * @param[in]  comm       Transport.
+ * @param[in]  fd         Ring.
+ * @param[in]  sq_ring    Mapping of the submission queue ring.
+ * @param[in]  sq_size    Bytes of sq_ring.
+ * @param[in]  sq_head    Consumer index of the submission queue.
+ * @param[in]  sq_tail    Producer index of the submission queue.
+ * @param[in]  sq_mask    Index mask of the submission queue.
+ * @param[in]  sq_array   Submission queue, indices into sqes.
+ * @param[in]  sqes       Mapping of the submission queue entries.
+ * @param[in]  sqes_size  Bytes of sqes.
+ * @param[in]  sq_entries Entries in the submission queue.
+ * @param[in]  to_submit  Entries prepared but not submitted yet.
+ * @param[in]  cq_ring    Mapping of the completion queue ring.
+ * @param[in]  cq_size    Bytes of cq_ring.
+ * @param[in]  cq_head    Consumer index of the completion queue.
+ * @param[in]  cq_tail    Producer index of the completion queue.
+ * @param[in]  cq_mask    Index mask of the completion queue.
+ * @param[in]  cqes       Completion queue.
+ * @param[in]  fixed      Whether the block region of the pool is registered.
+ * @param[in]  br         Ring of receive buffers provided to the kernel.
+ * @param[in]  br_size    Bytes of br.
+ * @param[in]  nbufs      Entries in br, a power of two.
+ * @param[in]  br_tail    Producer index of br.
+ * @param[in]  rx_bufs    Packet owning each buffer id, NULL while missing.
+ * @param[in]  missing    Buffer ids waiting for a block.
+ * @param[in]  nmissing   Entries in missing.
+ * @param[in]  rx_armed   Multishot receives in flight.
+ * @param[in]  rearm      ifindexes whose multishot receive ended.
+ * @param[in]  nrearm     Entries in rearm.
+ * @param[in]  tx         Frames being sent, by slot.
+ * @param[in]  tx_free    Free slots of tx.
+ * @param[in]  ntx_free   Entries in tx_free.
+ * @param[in]  tx_busy    Frames in flight.
+ * @param[in]  kick_fd    eventfd that wakes the thread.
+ * @param[in]  kick_val   Buffer the kick read lands in.
+ * @param[in]  kick_armed Whether a read of kick_fd is in flight.
+ * @param[in]  timer_armed Whether a refill retry timeout is in flight.
+ * @param[in]  idle       Set while the thread waits with nothing to send.
+ * @param[in]  stop       Tells the thread to exit.
+ * @param[in]  lock       Protects pending and npending.
+ * @param[in]  pending    Interfaces with frames to send.
+ * @param[in]  npending   Entries in pending.
+ * @param[in]  work       Interfaces taken off pending by the thread.
+ * @param[in]  bursts     Frames received in one pass, by ifindex.
+ * @param[in]  touched    ifindexes with a non-empty burst or a lost frame
+ *                        in the pass, each once.
+ * @param[in]  rx_errs    Frames lost in the pass, by ifindex.
+ * @param[in]  thread     Ring thread.
+ * @param[in]  running    Whether the thread was started.
+ * @param[in]  enters     io_uring_enter calls.
+ * @param[in]  kicks      eventfd writes made to wake the thread.
+ */
+typedef struct comm_uring_ {
+    comm_t *comm;
+    int fd;
+    void *sq_ring;
+    size_t sq_size;
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+    unsigned sq_entries;
+    unsigned to_submit;
+    void *cq_ring;
+    size_t cq_size;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_cqe *cqes;
+    int fixed;
+    struct io_uring_buf_ring *br;
+    size_t br_size;
+    uint32_t nbufs;
+    uint16_t br_tail;
+    pkt_buf_t **rx_bufs;
+    uint16_t *missing;
+    uint32_t nmissing;
+    uint32_t rx_armed;
+    uint32_t *rearm;
+    uint32_t nrearm;
+    struct comm_uring_tx_ *tx;
+    uint32_t *tx_free;
+    uint32_t ntx_free;
+    uint32_t tx_busy;
+    int kick_fd;
+    uint64_t kick_val;
+    int kick_armed;
+    int timer_armed;
+    int idle;
+    int stop;
+    pthread_mutex_t lock;
+    glthread_t pending;
+    uint32_t npending;
+    comm_intf_t **work;
+    pkt_queue_t *bursts;
+    uint32_t *touched;
+    uint32_t *rx_errs;
+    pthread_t thread;
+    int running;
+    uint64_t enters;
+    uint64_t kicks;
+} comm_uring_t;
+
+/**
+ * @brief      Sets up the ring, provides receive buffers and arms a
+ *             multishot receive on every interface socket.
+ *
+ * @param[in]  comm  Transport with its sockets open, max_segs of 1 and a pool
+ *                   headroom of at least 16 bytes.
+ *
+ * @return     The backend, or NULL with errno set when io_uring or one of
+ *             its features is unavailable.
+ */
+comm_uring_t *comm_uring_create(comm_t *comm);
+
+/**
+ * @brief      Starts the ring thread.
+ *
+ * @param[in]  ur  Backend.
+ *
+ * @return     0 on success, -1 with errno set.
+ */
+int comm_uring_start(comm_uring_t *ur);
+
+/**
+ * @brief      Stops and joins the ring thread. Armed receives stay armed and
+ *             their completions wait in the ring.
+ *
+ * @param[in]  ur  Backend.
+ */
+void comm_uring_stop(comm_uring_t *ur);
+
+/**
+ * @brief      Stops the thread, tears the ring down and returns its buffers
+ *             to the pool.
+ *
+ * @param[in]  ur  Backend, may be NULL.
+ */
+void comm_uring_destroy(comm_uring_t *ur);
+
+/**
+ * @brief      Hands the TX queue of an interface to the ring thread, waking
+ *             it only when it is idle.
+ *
+ * @param[in]  ur  Backend.
+ * @param[in]  ci  Interface state.
+ */
+void comm_uring_kick(comm_uring_t *ur, comm_intf_t *ci);
+
+/**
+ * @brief      Moves a burst of received frames to the queue of an interface
+ *             and wakes its consumer if the queue was empty. Defined in
+ *             comm.c and shared by both backends.
+ *
+ * @param[in]  ci     Interface state.
+ * @param[in]  burst  Received frames, empty afterwards.
+ * @param[in]  errs   Frames already lost in the burst.
+ */
+void comm_rx_deliver(comm_intf_t *ci, pkt_queue_t *burst, uint32_t errs);
+
+#endif    // COMM_URING_H
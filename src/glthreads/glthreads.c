@@ -13,6 +13,7 @@
  *
  *               Functions in this file:
  *                 - glthread_add_next
+ *                 - glthread_add_after
  *                 - glthread_add
  *                 - init_glthread
  *                 - glthread_remove
@@ -25,12 +26,24 @@
  *
  * Revision 0.2: 31/01/2024 Marko Trickovic
  * Added glthread_remove function for removing a node from the Linked List.
+ *
+ * Revision 0.3: 19/10/2026 Marko Trickovic
+ * Instrumented glthread_add, glthread_add_next and glthread_remove with the
+ * opt-in GLTHREAD_STATS hooks.
+ *
+ * Revision 0.4: 19/10/2026 Marko Trickovic
+ * glthread_remove unlinks the node through its own pointers in O(1) instead
+ * of searching the list, and now also fixes up the next node's left pointer.
+ *
+ * Revision 0.5: 19/10/2026 Marko Trickovic
+ * Added glthread_add_after, which appends while keeping the list length.
  *****************************************************************************/
 
 #ifndef GLTHREADS_C
 #define GLTHREADS_C
 
 #include "glthreads.h"
+#include "glthreads_stats.h"
 #include <stdlib.h>
 #include <stdio.h>
 
@@ -45,9 +58,12 @@ void glthread_add_next(glthread_node_t *curr_node, glthread_node_t *new_node)
     if (!curr_node || !new_node)
         return;
 
+    GLTHREAD_STATS_OP_BEGIN(t0);
+
     if (!curr_node->right) {
         curr_node->right = new_node;
         new_node->left = curr_node;
+        GLTHREAD_STATS_OP_END(GLTHREAD_OP_ADD_NEXT, t0);
         return;
     }
 
@@ -56,6 +72,35 @@ void glthread_add_next(glthread_node_t *curr_node, glthread_node_t *new_node)
     new_node->left = curr_node;
     new_node->right = temp;
     temp->left = new_node;
+
+    GLTHREAD_STATS_OP_END(GLTHREAD_OP_ADD_NEXT, t0);
+}
+
+/**
+ * @brief      Adds a node after a node of the Linked List, or at its head.
+ *
+ * @param      lst        Pointer to the Linked List.
+ * @param      curr_node  Node on lst, NULL to add at the head.
+ * @param      new_node   Detached node to add.
+ */
+void glthread_add_after(glthread_t *lst, glthread_node_t *curr_node,
+                        glthread_node_t *new_node)
+{
+    GLTHREAD_STATS_OP_BEGIN(t0);
+
+    new_node->left = curr_node;
+    if (curr_node) {
+        new_node->right = curr_node->right;
+        curr_node->right = new_node;
+    } else {
+        new_node->right = lst->head;
+        lst->head = new_node;
+    }
+    if (new_node->right)
+        new_node->right->left = new_node;
+
+    GLTHREAD_STATS_LIST_INC(lst);
+    GLTHREAD_STATS_OP_END(GLTHREAD_OP_ADD_AFTER, t0);
 }
 
 /**
@@ -66,55 +111,58 @@ void glthread_add_next(glthread_node_t *curr_node, glthread_node_t *new_node)
  */
 void glthread_add(glthread_t *lst, glthread_node_t *new_node)
 {
+    GLTHREAD_STATS_OP_BEGIN(t0);
+
     new_node->left = NULL;
-    new_node->right = NULL;
+    new_node->right = lst->head;
 
-    if (!lst->head) {
-        lst->head = new_node;
-        return;
-    }
+    // Linked directly rather than through glthread_add_next so that the
+    // instrumentation does not count one add as two operations
+    if (lst->head)
+        lst->head->left = new_node;
 
-    glthread_node_t *head = lst->head;
-    glthread_add_next(new_node, head);
     lst->head = new_node;
+
+    GLTHREAD_STATS_LIST_INC(lst);
+    GLTHREAD_STATS_OP_END(GLTHREAD_OP_ADD, t0);
 }
 
 /**
  * @brief      Removes a node from the Linked List.
  *
+ * @details    The node is unlinked through its own left and right pointers in
+ *             constant time and left detached (both pointers NULL). The node
+ *             must either be on lst or already be detached, in which case
+ *             nothing happens.
+ *
  * @param      lst             Pointer to the Linked List.
  * @param      node_to_delete  Node to be deleted.
  */
 void glthread_remove(glthread_t *lst, glthread_node_t *node_to_delete) {
-    glthread_node_t *tmp = NULL;
-    glthread_node_t *prev = NULL;
-    void *element_ptr = NULL;
-
-    ITERATE_GL_THREADS_BEGIN(lst, void, element_ptr)
-    {
-        tmp = (glthread_node_t *)((char *)element_ptr + lst->offset);
-
-        if (tmp == node_to_delete) {
-            // Found the node, remove it from the linked list
-            if (prev != NULL) {
-                // If the node is not the head of the list, update the previous node's 'right' pointer
-                prev->right = tmp->right;
-            } else {
-                // If the node is the head of the list, update the list's 'head' pointer
-                lst->head = tmp->right;
-                if (lst->head != NULL) {
-                    // If the list is not empty, update the left pointer of the new head
-                    lst->head->left = NULL;
-                }
-            }
-
-            break;
-        }
-
-        // Update 'prev' to keep track of the previous node
-        prev = tmp;
+    GLTHREAD_STATS_OP_BEGIN(t0);
+
+    if (node_to_delete->left) {
+        // If the node is not the head of the list, update the previous node's 'right' pointer
+        node_to_delete->left->right = node_to_delete->right;
+    } else if (lst->head == node_to_delete) {
+        // If the node is the head of the list, update the list's 'head' pointer
+        lst->head = node_to_delete->right;
+    } else {
+        // Detached node, it is not on any list
+        GLTHREAD_STATS_OP_END(GLTHREAD_OP_REMOVE, t0);
+        return;
     }
-    ITERATE_GL_THREADS_ENDS;
+
+    if (node_to_delete->right) {
+        // Update the left pointer of the next node
+        node_to_delete->right->left = node_to_delete->left;
+    }
+
+    node_to_delete->left = NULL;
+    node_to_delete->right = NULL;
+
+    GLTHREAD_STATS_LIST_DEC(lst);
+    GLTHREAD_STATS_OP_END(GLTHREAD_OP_REMOVE, t0);
 }
 
 /**
@@ -127,6 +175,7 @@ void init_glthread(glthread_t *lst, unsigned int offset)
 {
     lst->head = NULL;
     lst->offset = offset;
+    GLTHREAD_STATS_LIST_INIT(lst);
 }
 
 #endif    // GLTHREADS_C
@@ -35,6 +35,16 @@
  * Revision 0.2: 31/01/2024 Marko Trickovic
  * Added glthread_remove function, ITERATE_GL_THREADS_BEGIN, offset,
  * GLTHREAD_GET_USER_DATA_FROM_OFFSET and glthread_node_init macros.
+ *
+ * Revision 0.3: 19/10/2026 Marko Trickovic
+ * Added length and high-water mark fields to glthread_t, present only when
+ * compiled with GLTHREAD_STATS (see glthreads_stats.h).
+ *
+ * Revision 0.4: 19/10/2026 Marko Trickovic
+ * glthread_remove is O(1) and requires the node to be on the list or detached.
+ *
+ * Revision 0.5: 19/10/2026 Marko Trickovic
+ * Added glthread_add_after, the list-aware form of glthread_add_next.
  */
 
 #ifndef GLTHREADS_H
@@ -62,10 +72,16 @@ typedef struct glthread_node_ {
  *
  * @param[in] head        Pointer to the beginning of the Linked List.
  * @param[in] offset      Offset for each element in the list.
+ * @param[in] count       Current number of nodes (GLTHREAD_STATS only).
+ * @param[in] count_hwm   Highest number of nodes seen (GLTHREAD_STATS only).
  */
 typedef struct glthread_ {
     glthread_node_t *head;
     unsigned int offset;
+#ifdef GLTHREAD_STATS
+    unsigned int count;
+    unsigned int count_hwm;
+#endif
 } glthread_t;
 
 /**
@@ -76,6 +92,20 @@ typedef struct glthread_ {
  */
 void glthread_add_next(glthread_node_t *curr_node, glthread_node_t *new_node);
 
+/**
+ * @brief      Adds a node after a node of the Linked List, or at its head.
+ *
+ * @details    Unlike glthread_add_next it knows the list, so the node counts
+ *             towards the list's length. Passing the tail the caller keeps
+ *             appends in constant time.
+ *
+ * @param[in]  lst        Pointer to the Linked List.
+ * @param[in]  curr_node  Node on lst, NULL to add at the head.
+ * @param[in]  new_node   Detached node to add.
+ */
+void glthread_add_after(glthread_t *lst, glthread_node_t *curr_node,
+                        glthread_node_t *new_node);
+
 /**
  * @brief      Adds a node at the head of the Linked List.
  *
@@ -85,7 +115,10 @@ void glthread_add_next(glthread_node_t *curr_node, glthread_node_t *new_node);
 void glthread_add(glthread_t *lst, glthread_node_t *new_node);
 
 /**
- * @brief      Removes a node from the Linked List.
+ * @brief      Removes a node from the Linked List in constant time.
+ *
+ * @details    The node must be on lst or already detached (left and right
+ *             NULL). It is detached on return.
  *
  * @param      lst             Pointer to the Linked List.
  * @param      node_to_delete  Node to be deleted.
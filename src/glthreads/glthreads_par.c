@@ -0,0 +1,334 @@
+/******************************************************************************
+ * @file:        glthreads_par.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        20/10/2026 09:00 AM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the parallel iteration over glthreads.
+ *
+ *               The list length is not known up front, so the partitioning
+ *               walk records a cut every 'stride' nodes into an array of 2k
+ *               slots. Whenever the array fills up every other cut is dropped
+ *               and the stride doubles. After one walk there are between k and
+ *               2k cuts spaced evenly along the list, which become the ranges.
+ *
+ *               Workers pull range indices from a shared atomic counter, so
+ *               ranges finish in any order, but the per-range accumulators
+ *               are folded in list order afterwards.
+ *
+ *               Functions in this file:
+ *                 - glthread_pool_create
+ *                 - glthread_pool_destroy
+ *                 - glthread_pool_size
+ *                 - glthread_par_for_each
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 20/10/2026 Marko Trickovic
+ * Initial version with one-pass partitioning and a persistent worker pool.
+ *****************************************************************************/
+
+#ifndef GLTHREADS_PAR_C
+#define GLTHREADS_PAR_C
+
+#include "glthreads_par.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define GLTHREAD_PAR_ACC_ALIGN  64
+
+/**
+ * @brief      One parallel iteration in flight.
+ */
+typedef struct glthread_par_job_ {
+    glthread_node_t **cuts;
+    unsigned int nranges;
+    unsigned int next_range;
+    unsigned int offset;
+    glthread_par_fn_t fn;
+    void *arg;
+    char *accs;
+    size_t acc_stride;
+} glthread_par_job_t;
+
+struct glthread_pool_ {
+    pthread_mutex_t lock;
+    pthread_mutex_t submit_lock;
+    pthread_cond_t work_cv;
+    pthread_cond_t done_cv;
+    pthread_t *threads;
+    unsigned int nworkers;
+    unsigned int active;
+    uint64_t generation;
+    int shutdown;
+    glthread_par_job_t *job;
+};
+
+/**
+ * @brief      Takes ranges off a job until none are left.
+ *
+ * @param[in]  job  Job to work on.
+ */
+static void glthread_par_run(glthread_par_job_t *job)
+{
+    glthread_node_t *node, *end;
+    unsigned int r;
+    void *acc;
+
+    while ((r = __atomic_fetch_add(&job->next_range, 1, __ATOMIC_RELAXED))
+           < job->nranges) {
+        end = r + 1 < job->nranges ? job->cuts[r + 1] : NULL;
+        acc = job->accs + (size_t)r * job->acc_stride;
+
+        for (node = job->cuts[r]; node != end; node = node->right)
+            job->fn(GLTHREAD_GET_USER_DATA_FROM_OFFSET(node, job->offset),
+                    acc, job->arg);
+    }
+}
+
+/**
+ * @brief      Body of a pool worker: sleeps until a new job generation is
+ *             published, works on it and reports completion.
+ *
+ * @param[in]  arg  The pool.
+ */
+static void *glthread_pool_worker(void *arg)
+{
+    glthread_pool_t *pool = arg;
+    uint64_t seen = 0;
+    glthread_par_job_t *job;
+
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        while (pool->generation == seen && !pool->shutdown)
+            pthread_cond_wait(&pool->work_cv, &pool->lock);
+        if (pool->shutdown) {
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        seen = pool->generation;
+        job = pool->job;
+        pthread_mutex_unlock(&pool->lock);
+
+        glthread_par_run(job);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->active == 0)
+            pthread_cond_signal(&pool->done_cv);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+/**
+ * @brief      Starts a pool of worker threads.
+ *
+ * @param[in]  nworkers  Number of workers, 0 for one per online CPU minus
+ *                       the calling thread.
+ *
+ * @return     The pool, or NULL on failure.
+ */
+glthread_pool_t *glthread_pool_create(unsigned int nworkers)
+{
+    glthread_pool_t *pool;
+    long ncpu;
+    unsigned int i;
+
+    if (!nworkers) {
+        ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+        nworkers = ncpu > 1 ? (unsigned int)ncpu - 1 : 0;
+    }
+
+    pool = calloc(1, sizeof(*pool));
+    if (!pool)
+        return NULL;
+
+    pool->threads = calloc(nworkers ? nworkers : 1, sizeof(pthread_t));
+    if (!pool->threads) {
+        free(pool);
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_mutex_init(&pool->submit_lock, NULL);
+    pthread_cond_init(&pool->work_cv, NULL);
+    pthread_cond_init(&pool->done_cv, NULL);
+
+    for (i = 0; i < nworkers; i++) {
+        if (pthread_create(&pool->threads[i], NULL, glthread_pool_worker,
+                           pool))
+            break;
+    }
+    pool->nworkers = i;
+
+    return pool;
+}
+
+/**
+ * @brief      Stops and joins the workers and frees the pool.
+ *
+ * @param[in]  pool  Pool to destroy.
+ */
+void glthread_pool_destroy(glthread_pool_t *pool)
+{
+    unsigned int i;
+
+    if (!pool)
+        return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->work_cv);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (i = 0; i < pool->nworkers; i++)
+        pthread_join(pool->threads[i], NULL);
+
+    pthread_cond_destroy(&pool->work_cv);
+    pthread_cond_destroy(&pool->done_cv);
+    pthread_mutex_destroy(&pool->submit_lock);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->threads);
+    free(pool);
+}
+
+/**
+ * @brief      Returns the number of threads that take part in an iteration.
+ *
+ * @param[in]  pool  Worker pool.
+ *
+ * @return     Number of workers plus one.
+ */
+unsigned int glthread_pool_size(const glthread_pool_t *pool)
+{
+    return pool ? pool->nworkers + 1 : 1;
+}
+
+/**
+ * @brief      Cuts a list into evenly spaced ranges in a single walk.
+ *
+ * @param[in]  lst       Pointer to the Linked List.
+ * @param[out] cuts      First node of every range.
+ * @param[in]  max_cuts  Capacity of cuts, must be even.
+ *
+ * @return     Number of ranges, at most max_cuts.
+ */
+static unsigned int glthread_par_partition(glthread_t *lst,
+                                           glthread_node_t **cuts,
+                                           unsigned int max_cuts)
+{
+    glthread_node_t *node;
+    uint64_t pos = 0, stride = 1;
+    unsigned int n = 0, i;
+
+    for (node = lst->head; node; node = node->right, pos++) {
+        if (pos & (stride - 1))
+            continue;
+
+        if (n == max_cuts) {
+            // Cuts sit at multiples of stride, keep those at multiples of 2x
+            for (i = 0; i < n / 2; i++)
+                cuts[i] = cuts[2 * i];
+            n /= 2;
+            stride *= 2;
+            if (pos & (stride - 1))
+                continue;
+        }
+
+        cuts[n++] = node;
+    }
+
+    return n;
+}
+
+/**
+ * @brief      Runs fn on every element of a glthread in parallel.
+ *
+ * @param[in]  pool      Worker pool, NULL to run on the calling thread only.
+ * @param[in]  lst       Pointer to the Linked List.
+ * @param[in]  fn        Callback run on every element.
+ * @param[in]  arg       Opaque argument for fn and reduce.
+ * @param[out] result    Reduction target, may be NULL when acc_size is 0.
+ * @param[in]  acc_size  Size of one accumulator, 0 for none.
+ * @param[in]  reduce    Fold callback, may be NULL when acc_size is 0.
+ *
+ * @return     0 on success, -1 when out of memory.
+ */
+int glthread_par_for_each(glthread_pool_t *pool, glthread_t *lst,
+                          glthread_par_fn_t fn, void *arg,
+                          void *result, size_t acc_size,
+                          glthread_par_reduce_fn_t reduce)
+{
+    glthread_par_job_t job;
+    unsigned int max_cuts, r;
+
+    memset(&job, 0, sizeof(job));
+    max_cuts = 2 * GLTHREAD_PAR_RANGES_PER_THREAD * glthread_pool_size(pool);
+
+    job.cuts = malloc(max_cuts * sizeof(*job.cuts));
+    if (!job.cuts)
+        return -1;
+
+    // Accumulators get a cache line each so ranges never share one
+    job.acc_stride = (acc_size + GLTHREAD_PAR_ACC_ALIGN - 1) &
+                     ~(size_t)(GLTHREAD_PAR_ACC_ALIGN - 1);
+    if (job.acc_stride) {
+        job.accs = aligned_alloc(GLTHREAD_PAR_ACC_ALIGN,
+                                 max_cuts * job.acc_stride);
+        if (!job.accs) {
+            free(job.cuts);
+            return -1;
+        }
+        memset(job.accs, 0, max_cuts * job.acc_stride);
+    }
+
+    // Without helpers the partitioning walk would be pure overhead
+    if (pool && pool->nworkers) {
+        job.nranges = glthread_par_partition(lst, job.cuts, max_cuts);
+    } else {
+        job.cuts[0] = lst->head;
+        job.nranges = lst->head ? 1 : 0;
+    }
+    job.offset = lst->offset;
+    job.fn = fn;
+    job.arg = arg;
+
+    if (pool && pool->nworkers && job.nranges > 1) {
+        pthread_mutex_lock(&pool->submit_lock);
+
+        pthread_mutex_lock(&pool->lock);
+        pool->job = &job;
+        pool->active = pool->nworkers;
+        pool->generation++;
+        pthread_cond_broadcast(&pool->work_cv);
+        pthread_mutex_unlock(&pool->lock);
+
+        glthread_par_run(&job);
+
+        pthread_mutex_lock(&pool->lock);
+        while (pool->active)
+            pthread_cond_wait(&pool->done_cv, &pool->lock);
+        pool->job = NULL;
+        pthread_mutex_unlock(&pool->lock);
+
+        pthread_mutex_unlock(&pool->submit_lock);
+    } else {
+        glthread_par_run(&job);
+    }
+
+    if (reduce && acc_size) {
+        for (r = 0; r < job.nranges; r++)
+            reduce(result, job.accs + (size_t)r * job.acc_stride, arg);
+    }
+
+    free(job.accs);
+    free(job.cuts);
+    return 0;
+}
+
+#endif    // GLTHREADS_PAR_C
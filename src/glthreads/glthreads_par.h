@@ -0,0 +1,123 @@
+/* -----------------------------------------------------------------------------
+ * @file:        glthreads_par.h
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        20/10/2026 09:00 AM
+ * @license:     MIT
+ * @description: This header file declares the parallel iteration API for
+ *               glthreads. A glthread is cut into contiguous sub-ranges in a
+ *               single walk, the sub-ranges are handed out to a reusable pool
+ *               of worker threads, each sub-range accumulates into its own
+ *               private result and the results are reduced in list order once
+ *               every range is done. The contents are organized into two
+ *               groups:
+ *
+ *                 1. Types:
+ *                    - glthread_pool_t
+ *                    - glthread_par_fn_t
+ *                    - glthread_par_reduce_fn_t
+ *
+ *                 2. Functions:
+ *                    - glthread_pool_create
+ *                    - glthread_pool_destroy
+ *                    - glthread_pool_size
+ *                    - glthread_par_for_each
+ *
+ * @note:        This code is part of the tcpip-stack project, which is a course
+ *               on network development.
+ *
+ * Revision History:
+ *
+ * Revision 0.1: 20/10/2026 Marko Trickovic
+ * Initial version with one-pass partitioning and a persistent worker pool.
+ */
+
+#ifndef GLTHREADS_PAR_H
+#define GLTHREADS_PAR_H
+
+#include <stddef.h>
+#include "glthreads.h"
+
+/**
+ * @brief      Ranges created per participating thread. More ranges than
+ *             threads lets fast threads pick up the slack of slow ones.
+ */
+#define GLTHREAD_PAR_RANGES_PER_THREAD  4
+
+/**
+ * @brief      Opaque pool of persistent worker threads.
+ */
+typedef struct glthread_pool_ glthread_pool_t;
+
+/**
+ * @brief      Callback run on every element.
+ *
+ * @param[in]  elem  User struct containing the glthread node.
+ * @param[in]  acc   Private accumulator of the range the element is in.
+ * @param[in]  arg   Opaque argument passed to glthread_par_for_each.
+ */
+typedef void (*glthread_par_fn_t)(void *elem, void *acc, void *arg);
+
+/**
+ * @brief      Callback folding one range's accumulator into the result.
+ *
+ * @param[in,out] result  Final result.
+ * @param[in]     acc     Accumulator of one range.
+ * @param[in]     arg     Opaque argument passed to glthread_par_for_each.
+ */
+typedef void (*glthread_par_reduce_fn_t)(void *result, const void *acc,
+                                         void *arg);
+
+/**
+ * @brief      Starts a pool of worker threads.
+ *
+ * @param[in]  nworkers  Number of workers, 0 for one per online CPU minus
+ *                       the calling thread, which also takes part in every
+ *                       parallel iteration.
+ *
+ * @return     The pool, or NULL on failure.
+ */
+glthread_pool_t *glthread_pool_create(unsigned int nworkers);
+
+/**
+ * @brief      Stops and joins the workers and frees the pool.
+ *
+ * @param[in]  pool  Pool to destroy.
+ */
+void glthread_pool_destroy(glthread_pool_t *pool);
+
+/**
+ * @brief      Returns the number of threads that take part in an iteration,
+ *             the calling thread included.
+ *
+ * @param[in]  pool  Worker pool.
+ *
+ * @return     Number of workers plus one.
+ */
+unsigned int glthread_pool_size(const glthread_pool_t *pool);
+
+/**
+ * @brief      Runs fn on every element of a glthread in parallel.
+ *
+ * @details    Every range starts with a zero-filled accumulator of acc_size
+ *             bytes. When all ranges are done the accumulators are folded
+ *             into result with reduce, in list order, on the calling thread.
+ *             fn may modify the elements but must not link or unlink nodes,
+ *             and nobody else may modify the list during the call.
+ *
+ * @param[in]  pool      Worker pool, NULL to run on the calling thread only.
+ * @param[in]  lst       Pointer to the Linked List.
+ * @param[in]  fn        Callback run on every element.
+ * @param[in]  arg       Opaque argument for fn and reduce.
+ * @param[out] result    Reduction target, may be NULL when acc_size is 0.
+ * @param[in]  acc_size  Size of one accumulator, 0 for none.
+ * @param[in]  reduce    Fold callback, may be NULL when acc_size is 0.
+ *
+ * @return     0 on success, -1 when out of memory.
+ */
+int glthread_par_for_each(glthread_pool_t *pool, glthread_t *lst,
+                          glthread_par_fn_t fn, void *arg,
+                          void *result, size_t acc_size,
+                          glthread_par_reduce_fn_t reduce);
+
+#endif    // GLTHREADS_PAR_H
@@ -0,0 +1,356 @@
+/******************************************************************************
+ * @file:        glthreads_reloc.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        20/10/2026 02:00 PM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the relocatable glthread operations and the
+ *               file-backed arena. A link is the byte distance from the link
+ *               field to the target node, so storing and loading a link costs
+ *               one add. Nothing in the region refers to an absolute address,
+ *               which is what lets an arena file be mapped at any address and
+ *               used as is. The arena header sits at the start of the region
+ *               and records the bump pointer and a few root objects, stored as
+ *               offsets from the region base.
+ *
+ *               Functions in this file:
+ *                 - init_glthread_rel
+ *                 - glthread_rel_add
+ *                 - glthread_rel_add_next
+ *                 - glthread_rel_remove
+ *                 - glthread_arena_create
+ *                 - glthread_arena_open
+ *                 - glthread_arena_alloc
+ *                 - glthread_arena_set_root
+ *                 - glthread_arena_get_root
+ *                 - glthread_arena_sync
+ *                 - glthread_arena_close
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 20/10/2026 Marko Trickovic
+ * Initial version with self-relative links and file-backed arenas.
+ *****************************************************************************/
+
+#ifndef GLTHREADS_RELOC_C
+#define GLTHREADS_RELOC_C
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "glthreads_reloc.h"
+
+#define GLTHREAD_ARENA_MAGIC    0x414e455241544c47ull    // "GLTARENA"
+#define GLTHREAD_ARENA_VERSION  1
+#define GLTHREAD_ARENA_ALIGN    16
+
+/**
+ * @brief      The header at the start of every arena region. All positions
+ *             are offsets from the region base.
+ */
+typedef struct glthread_arena_hdr_ {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t hdr_size;
+    uint64_t size;
+    uint64_t used;
+    uint64_t roots[GLTHREAD_ARENA_ROOTS];
+} glthread_arena_hdr_t;
+
+#define GLTHREAD_ARENA_DATA_START                                          \
+    ((sizeof(glthread_arena_hdr_t) + GLTHREAD_ARENA_ALIGN - 1) &           \
+     ~(size_t)(GLTHREAD_ARENA_ALIGN - 1))
+
+/**
+ * @brief      Stores a link to target in the field at fieldptr.
+ */
+static inline void glthread_rel_set(int64_t *fieldptr,
+                                    glthread_rel_node_t *target)
+{
+    *fieldptr = target ? (int64_t)((char *)target - (char *)fieldptr) : 0;
+}
+
+/**
+ * @brief      Initializes head link and offset value.
+ *
+ * @param[in]  lst     Pointer to the relocatable Linked List.
+ * @param[in]  offset  Offset of the node in the user struct.
+ */
+void init_glthread_rel(glthread_rel_t *lst, unsigned int offset)
+{
+    lst->head = 0;
+    lst->offset = offset;
+}
+
+/**
+ * @brief      Adds a node at the head of the relocatable Linked List.
+ *
+ * @param[in]  lst       Pointer to the relocatable Linked List.
+ * @param[in]  new_node  Node to add, in the same region as lst.
+ */
+void glthread_rel_add(glthread_rel_t *lst, glthread_rel_node_t *new_node)
+{
+    glthread_rel_node_t *head = GLTHREAD_REL_GET(&lst->head);
+
+    new_node->left = 0;
+    glthread_rel_set(&new_node->right, head);
+    if (head)
+        glthread_rel_set(&head->left, new_node);
+    glthread_rel_set(&lst->head, new_node);
+}
+
+/**
+ * @brief      Adds a new node next to the current node.
+ *
+ * @param[in]  curr_node  Node already on a list.
+ * @param[in]  new_node   Node to add right of curr_node.
+ */
+void glthread_rel_add_next(glthread_rel_node_t *curr_node,
+                           glthread_rel_node_t *new_node)
+{
+    glthread_rel_node_t *right = GLTHREAD_REL_GET(&curr_node->right);
+
+    glthread_rel_set(&new_node->left, curr_node);
+    glthread_rel_set(&new_node->right, right);
+    if (right)
+        glthread_rel_set(&right->left, new_node);
+    glthread_rel_set(&curr_node->right, new_node);
+}
+
+/**
+ * @brief      Removes a node from the relocatable Linked List in O(1).
+ *
+ * @param[in]  lst             Pointer to the relocatable Linked List.
+ * @param[in]  node_to_delete  Node on lst, or a detached node.
+ */
+void glthread_rel_remove(glthread_rel_t *lst,
+                         glthread_rel_node_t *node_to_delete)
+{
+    glthread_rel_node_t *left = GLTHREAD_REL_GET(&node_to_delete->left);
+    glthread_rel_node_t *right = GLTHREAD_REL_GET(&node_to_delete->right);
+
+    if (left)
+        glthread_rel_set(&left->right, right);
+    else if (GLTHREAD_REL_GET(&lst->head) == node_to_delete)
+        glthread_rel_set(&lst->head, right);
+    else
+        return;    // detached
+
+    if (right)
+        glthread_rel_set(&right->left, left);
+
+    node_to_delete->left = 0;
+    node_to_delete->right = 0;
+}
+
+/**
+ * @brief      Maps size bytes of fd and fills in the arena.
+ */
+static int glthread_arena_map(glthread_arena_t *arena, int fd, size_t size,
+                              int flags)
+{
+    void *base;
+
+    base = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                (flags & GLTHREAD_ARENA_PRIVATE) ? MAP_PRIVATE : MAP_SHARED,
+                fd, 0);
+    if (base == MAP_FAILED)
+        return -1;
+
+    arena->base = base;
+    arena->size = size;
+    arena->fd = fd;
+    return 0;
+}
+
+/**
+ * @brief      Creates a new arena file of a fixed size and maps it shared.
+ *
+ * @param[out] arena  Arena to initialize.
+ * @param[in]  path   File to create or truncate.
+ * @param[in]  size   Size of the region, header included.
+ *
+ * @return     0 on success, -1 with errno set on failure.
+ */
+int glthread_arena_create(glthread_arena_t *arena, const char *path,
+                          size_t size)
+{
+    glthread_arena_hdr_t *hdr;
+    int fd, err;
+
+    if (size < GLTHREAD_ARENA_DATA_START) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return -1;
+
+    // The file stays sparse until objects are written
+    if (ftruncate(fd, (off_t)size) < 0 ||
+        glthread_arena_map(arena, fd, size, 0) < 0) {
+        err = errno;
+        close(fd);
+        errno = err;
+        return -1;
+    }
+
+    hdr = arena->base;
+    hdr->magic = GLTHREAD_ARENA_MAGIC;
+    hdr->version = GLTHREAD_ARENA_VERSION;
+    hdr->hdr_size = sizeof(*hdr);
+    hdr->size = size;
+    hdr->used = GLTHREAD_ARENA_DATA_START;
+    memset(hdr->roots, 0, sizeof(hdr->roots));
+
+    return 0;
+}
+
+/**
+ * @brief      Maps an existing arena file.
+ *
+ * @param[out] arena  Arena to initialize.
+ * @param[in]  path   Arena file.
+ * @param[in]  flags  0 or GLTHREAD_ARENA_PRIVATE.
+ *
+ * @return     0 on success, -1 with errno set on failure.
+ */
+int glthread_arena_open(glthread_arena_t *arena, const char *path, int flags)
+{
+    glthread_arena_hdr_t *hdr;
+    struct stat st;
+    int fd, err;
+
+    fd = open(path, (flags & GLTHREAD_ARENA_PRIVATE) ? O_RDONLY : O_RDWR);
+    if (fd < 0)
+        return -1;
+
+    if (fstat(fd, &st) < 0)
+        goto fail;
+    if ((size_t)st.st_size < GLTHREAD_ARENA_DATA_START) {
+        errno = EINVAL;
+        goto fail;
+    }
+    if (glthread_arena_map(arena, fd, (size_t)st.st_size, flags) < 0)
+        goto fail;
+
+    hdr = arena->base;
+    if (hdr->magic != GLTHREAD_ARENA_MAGIC ||
+        hdr->version != GLTHREAD_ARENA_VERSION ||
+        hdr->hdr_size != sizeof(*hdr) ||
+        hdr->size != (uint64_t)st.st_size ||
+        hdr->used < GLTHREAD_ARENA_DATA_START || hdr->used > hdr->size) {
+        munmap(arena->base, arena->size);
+        errno = EINVAL;
+        goto fail;
+    }
+
+    return 0;
+
+fail:
+    err = errno;
+    close(fd);
+    errno = err;
+    return -1;
+}
+
+/**
+ * @brief      Allocates zeroed, 16-byte aligned memory inside the arena.
+ *
+ * @param[in]  arena  Arena to allocate from.
+ * @param[in]  size   Bytes to allocate.
+ *
+ * @return     Pointer into the region, or NULL when the arena is full.
+ */
+void *glthread_arena_alloc(glthread_arena_t *arena, size_t size)
+{
+    glthread_arena_hdr_t *hdr = arena->base;
+    uint64_t start = hdr->used;
+
+    size = (size + GLTHREAD_ARENA_ALIGN - 1) &
+           ~(size_t)(GLTHREAD_ARENA_ALIGN - 1);
+    if (size > hdr->size - start)
+        return NULL;
+
+    // Fresh arena space is zero already; it is never handed out twice
+    hdr->used = start + size;
+    return (char *)arena->base + start;
+}
+
+/**
+ * @brief      Records a well-known object so it can be found after reopening.
+ *
+ * @param[in]  arena  Arena.
+ * @param[in]  slot   Root slot below GLTHREAD_ARENA_ROOTS.
+ * @param[in]  ptr    Object inside the arena, or NULL to clear the slot.
+ */
+void glthread_arena_set_root(glthread_arena_t *arena, unsigned int slot,
+                             void *ptr)
+{
+    glthread_arena_hdr_t *hdr = arena->base;
+
+    if (slot >= GLTHREAD_ARENA_ROOTS)
+        return;
+    hdr->roots[slot] = ptr ? (uint64_t)((char *)ptr - (char *)arena->base) : 0;
+}
+
+/**
+ * @brief      Looks up a root recorded with glthread_arena_set_root.
+ *
+ * @param[in]  arena  Arena.
+ * @param[in]  slot   Root slot below GLTHREAD_ARENA_ROOTS.
+ *
+ * @return     The object at its address in the current mapping, or NULL.
+ */
+void *glthread_arena_get_root(glthread_arena_t *arena, unsigned int slot)
+{
+    glthread_arena_hdr_t *hdr = arena->base;
+
+    if (slot >= GLTHREAD_ARENA_ROOTS || !hdr->roots[slot] ||
+        hdr->roots[slot] >= hdr->used)
+        return NULL;
+    return (char *)arena->base + hdr->roots[slot];
+}
+
+/**
+ * @brief      Flushes a shared arena to its file.
+ *
+ * @param[in]  arena  Arena.
+ *
+ * @return     0 on success, -1 with errno set on failure.
+ */
+int glthread_arena_sync(glthread_arena_t *arena)
+{
+    glthread_arena_hdr_t *hdr = arena->base;
+    long page = sysconf(_SC_PAGESIZE);
+    size_t len = (hdr->used + page - 1) & ~(size_t)(page - 1);
+
+    // Only the used prefix can be dirty
+    return msync(arena->base, len < arena->size ? len : arena->size, MS_SYNC);
+}
+
+/**
+ * @brief      Unmaps the arena and closes its file.
+ *
+ * @param[in]  arena  Arena.
+ */
+void glthread_arena_close(glthread_arena_t *arena)
+{
+    if (arena->base)
+        munmap(arena->base, arena->size);
+    if (arena->fd >= 0)
+        close(arena->fd);
+
+    arena->base = NULL;
+    arena->size = 0;
+    arena->fd = -1;
+}
+
+#endif    // GLTHREADS_RELOC_C
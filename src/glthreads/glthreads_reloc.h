@@ -0,0 +1,249 @@
+/* -----------------------------------------------------------------------------
+ * @file:        glthreads_reloc.h
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        20/10/2026 02:00 PM
+ * @license:     MIT
+ * @description: This header file declares position-independent glthreads and
+ *               the file-backed arena that holds them. A relocatable glthread
+ *               stores every link as a signed byte distance from the link
+ *               field itself to its target, so a whole region of linked
+ *               objects stays valid wherever it is mapped. An arena is such a
+ *               region backed by a file: objects are bump-allocated inside it,
+ *               and reopening the file with mmap brings every list back with
+ *               no pointer fixups and no per-object allocation. The contents
+ *               are organized into three groups:
+ *
+ *                 1. Structs:
+ *                    - struct glthread_rel_node_t
+ *                    - struct glthread_rel_t
+ *                    - struct glthread_arena_t
+ *
+ *                 2. Functions:
+ *                    - init_glthread_rel
+ *                    - glthread_rel_add
+ *                    - glthread_rel_add_next
+ *                    - glthread_rel_remove
+ *                    - glthread_arena_create
+ *                    - glthread_arena_open
+ *                    - glthread_arena_alloc
+ *                    - glthread_arena_set_root
+ *                    - glthread_arena_get_root
+ *                    - glthread_arena_sync
+ *                    - glthread_arena_close
+ *
+ *                 3. Macros:
+ *                    - GLTHREAD_REL_GET
+ *                    - ITERATE_GL_THREADS_REL_BEGIN
+ *                    - glthread_rel_node_init
+ *
+ * @note:        This code is part of the tcpip-stack project, which is a course
+ *               on network development.
+ *
+ * Revision History:
+ *
+ * Revision 0.1: 20/10/2026 Marko Trickovic
+ * Initial version with self-relative links and file-backed arenas.
+ */
+
+#ifndef GLTHREADS_RELOC_H
+#define GLTHREADS_RELOC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief      The structure representing a relocatable list node. Each link
+ *             holds the distance in bytes from the link field to the target
+ *             node, 0 meaning NULL.
+ *
+ * @struct                glthread_rel_node_t
+ *
+ * @param[in]  left       Relative link to the left node.
+ * @param[in]  right      Relative link to the right node.
+ */
+typedef struct glthread_rel_node_ {
+    int64_t left;
+    int64_t right;
+} glthread_rel_node_t;
+
+/**
+ * @brief      The structure representing a relocatable list. It must live in
+ *             the same region as its nodes.
+ *
+ * @struct                glthread_rel_t
+ *
+ * @param[in]  head       Relative link to the first node.
+ * @param[in]  offset     Offset of the node in the user struct.
+ */
+typedef struct glthread_rel_ {
+    int64_t head;
+    unsigned int offset;
+} glthread_rel_t;
+
+/** Number of root slots in an arena header. */
+#define GLTHREAD_ARENA_ROOTS    8
+
+/** Open the arena copy-on-write; changes are never written back. */
+#define GLTHREAD_ARENA_PRIVATE  0x1
+
+/**
+ * @brief      The structure representing an open arena.
+ *
+ * @struct                glthread_arena_t
+ *
+ * @param[in]  base       Start of the mapping, where the header lives.
+ * @param[in]  size       Size of the mapping in bytes.
+ * @param[in]  fd         Backing file descriptor.
+ */
+typedef struct glthread_arena_ {
+    void *base;
+    size_t size;
+    int fd;
+} glthread_arena_t;
+
+/**
+ * @brief      Resolves a relative link stored at a given field.
+ *
+ * @param[in]  fieldptr  Address of the int64_t link field.
+ *
+ * @return     Pointer to the target node, or NULL.
+ */
+#define GLTHREAD_REL_GET(fieldptr)                                        \
+    (*(fieldptr) ? (glthread_rel_node_t *)((char *)(fieldptr) + *(fieldptr)) \
+                 : (glthread_rel_node_t *)NULL)
+
+/**
+ * @brief      Macro to iterate over a relocatable Linked List. The current
+ *             node may be removed inside the loop.
+ *
+ * @param[in]  lstptr       Pointer to the relocatable Linked List.
+ * @param[in]  struct_type  The type of the structure containing the node.
+ * @param[out] ptr          Pointer to each element in turn.
+ */
+#define ITERATE_GL_THREADS_REL_BEGIN(lstptr, struct_type, ptr)            \
+{                                                                         \
+    glthread_rel_node_t *_current_node = NULL, *_next_node = NULL;        \
+    for (_current_node = GLTHREAD_REL_GET(&(lstptr)->head);               \
+         _current_node;                                                   \
+         _current_node = _next_node)                                      \
+    {                                                                     \
+        _next_node = GLTHREAD_REL_GET(&_current_node->right);             \
+        ptr = (struct_type *)((char *)_current_node - (lstptr)->offset);
+#define ITERATE_GL_THREADS_REL_ENDS }}
+
+/**
+ * @brief      Initialize a relocatable list node.
+ *
+ * @param[in]  node  Pointer to the node to be initialized.
+ */
+#define glthread_rel_node_init(node)    \
+    (node)->left = 0;                   \
+    (node)->right = 0;
+
+/**
+ * @brief      Initializes head link and offset value.
+ *
+ * @param[in]  lst     Pointer to the relocatable Linked List.
+ * @param[in]  offset  Offset of the node in the user struct.
+ */
+void init_glthread_rel(glthread_rel_t *lst, unsigned int offset);
+
+/**
+ * @brief      Adds a node at the head of the relocatable Linked List.
+ *
+ * @param[in]  lst       Pointer to the relocatable Linked List.
+ * @param[in]  new_node  Node to add, in the same region as lst.
+ */
+void glthread_rel_add(glthread_rel_t *lst, glthread_rel_node_t *new_node);
+
+/**
+ * @brief      Adds a new node next to the current node.
+ *
+ * @param[in]  curr_node  Node already on a list.
+ * @param[in]  new_node   Node to add right of curr_node.
+ */
+void glthread_rel_add_next(glthread_rel_node_t *curr_node,
+                           glthread_rel_node_t *new_node);
+
+/**
+ * @brief      Removes a node from the relocatable Linked List in O(1).
+ *
+ * @param[in]  lst             Pointer to the relocatable Linked List.
+ * @param[in]  node_to_delete  Node on lst, or a detached node.
+ */
+void glthread_rel_remove(glthread_rel_t *lst,
+                         glthread_rel_node_t *node_to_delete);
+
+/**
+ * @brief      Creates a new arena file of a fixed size and maps it shared,
+ *             so every change lands in the file.
+ *
+ * @param[out] arena  Arena to initialize.
+ * @param[in]  path   File to create or truncate.
+ * @param[in]  size   Size of the region, header included.
+ *
+ * @return     0 on success, -1 with errno set on failure.
+ */
+int glthread_arena_create(glthread_arena_t *arena, const char *path,
+                          size_t size);
+
+/**
+ * @brief      Maps an existing arena file.
+ *
+ * @param[out] arena  Arena to initialize.
+ * @param[in]  path   Arena file.
+ * @param[in]  flags  0 or GLTHREAD_ARENA_PRIVATE.
+ *
+ * @return     0 on success, -1 with errno set on failure (EINVAL when the
+ *             file is not an arena).
+ */
+int glthread_arena_open(glthread_arena_t *arena, const char *path, int flags);
+
+/**
+ * @brief      Allocates zeroed, 16-byte aligned memory inside the arena.
+ *
+ * @param[in]  arena  Arena to allocate from.
+ * @param[in]  size   Bytes to allocate.
+ *
+ * @return     Pointer into the region, or NULL when the arena is full.
+ */
+void *glthread_arena_alloc(glthread_arena_t *arena, size_t size);
+
+/**
+ * @brief      Records a well-known object so it can be found after reopening.
+ *
+ * @param[in]  arena  Arena.
+ * @param[in]  slot   Root slot below GLTHREAD_ARENA_ROOTS.
+ * @param[in]  ptr    Object inside the arena, or NULL to clear the slot.
+ */
+void glthread_arena_set_root(glthread_arena_t *arena, unsigned int slot,
+                             void *ptr);
+
+/**
+ * @brief      Looks up a root recorded with glthread_arena_set_root.
+ *
+ * @param[in]  arena  Arena.
+ * @param[in]  slot   Root slot below GLTHREAD_ARENA_ROOTS.
+ *
+ * @return     The object at its address in the current mapping, or NULL.
+ */
+void *glthread_arena_get_root(glthread_arena_t *arena, unsigned int slot);
+
+/**
+ * @brief      Flushes a shared arena to its file.
+ *
+ * @param[in]  arena  Arena.
+ *
+ * @return     0 on success, -1 with errno set on failure.
+ */
+int glthread_arena_sync(glthread_arena_t *arena);
+
+/**
+ * @brief      Unmaps the arena and closes its file.
+ *
+ * @param[in]  arena  Arena.
+ */
+void glthread_arena_close(glthread_arena_t *arena);
+
+#endif    // GLTHREADS_RELOC_H
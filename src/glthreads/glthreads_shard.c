@@ -0,0 +1,276 @@
+/******************************************************************************
+ * @file:        glthreads_shard.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        19/10/2026 04:00 PM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the per-CPU sharded glthread container.
+ *               At most one shard lock is held at any time, which keeps
+ *               stealing free of lock ordering problems: the stolen half is
+ *               cut out under the victim's lock and spliced onto the local
+ *               shard under the local lock afterwards.
+ *
+ *               Functions in this file:
+ *                 - glthread_sharded_init
+ *                 - glthread_sharded_destroy
+ *                 - glthread_sharded_local
+ *                 - glthread_sharded_push
+ *                 - glthread_sharded_pop
+ *                 - glthread_sharded_push_shard
+ *                 - glthread_sharded_pop_shard
+ *                 - glthread_sharded_count
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 19/10/2026 Marko Trickovic
+ * Initial version with per-CPU shards and half-list stealing.
+ *
+ * Revision 0.2: 19/10/2026 Marko Trickovic
+ * Stealing keeps the GLTHREAD_STATS length of both lists.
+ *****************************************************************************/
+
+#ifndef GLTHREADS_SHARD_C
+#define GLTHREADS_SHARD_C
+
+#define _GNU_SOURCE
+#include "glthreads_shard.h"
+#include "glthreads_stats.h"
+#include <sched.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/*
+ * count is written under the shard lock but read without it by thieves
+ * looking for a non-empty victim, hence the relaxed atomic accessors.
+ */
+#define SHARD_COUNT_LOAD(s)      __atomic_load_n(&(s)->count, __ATOMIC_RELAXED)
+#define SHARD_COUNT_STORE(s, v)  __atomic_store_n(&(s)->count, (v), \
+                                                  __ATOMIC_RELAXED)
+
+/**
+ * @brief      Initializes a sharded container.
+ *
+ * @param[out] sh       Container to initialize.
+ * @param[in]  offset   Offset of the glthread_node_t in the user struct.
+ * @param[in]  nshards  Number of shards, 0 for one per configured CPU.
+ *
+ * @return     0 on success, -1 when out of memory.
+ */
+int glthread_sharded_init(glthread_sharded_t *sh, unsigned int offset,
+                          unsigned int nshards)
+{
+    unsigned int i;
+    long ncpu;
+
+    if (!nshards) {
+        ncpu = sysconf(_SC_NPROCESSORS_CONF);
+        nshards = ncpu > 0 ? (unsigned int)ncpu : 1;
+    }
+
+    sh->shards = aligned_alloc(GLTHREAD_CACHE_LINE,
+                               nshards * sizeof(glthread_shard_t));
+    if (!sh->shards)
+        return -1;
+
+    sh->nshards = nshards;
+    sh->offset = offset;
+
+    for (i = 0; i < nshards; i++) {
+        pthread_mutex_init(&sh->shards[i].lock, NULL);
+        init_glthread(&sh->shards[i].list, offset);
+        sh->shards[i].count = 0;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief      Releases the shards. Nodes still held are not touched.
+ *
+ * @param[in]  sh  Container to destroy.
+ */
+void glthread_sharded_destroy(glthread_sharded_t *sh)
+{
+    unsigned int i;
+
+    for (i = 0; i < sh->nshards; i++)
+        pthread_mutex_destroy(&sh->shards[i].lock);
+
+    free(sh->shards);
+    sh->shards = NULL;
+    sh->nshards = 0;
+}
+
+/**
+ * @brief      Returns the shard index of the calling CPU.
+ *
+ * @param[in]  sh  Sharded container.
+ *
+ * @return     Index in [0, sh->nshards).
+ */
+unsigned int glthread_sharded_local(const glthread_sharded_t *sh)
+{
+    int cpu = sched_getcpu();
+
+    return cpu < 0 ? 0 : (unsigned int)cpu % sh->nshards;
+}
+
+/**
+ * @brief      Pushes a node onto a given shard.
+ *
+ * @param[in]  sh     Sharded container.
+ * @param[in]  shard  Shard index, taken modulo the number of shards.
+ * @param[in]  node   Detached node to push.
+ */
+void glthread_sharded_push_shard(glthread_sharded_t *sh, unsigned int shard,
+                                 glthread_node_t *node)
+{
+    glthread_shard_t *s = &sh->shards[shard % sh->nshards];
+
+    pthread_mutex_lock(&s->lock);
+    glthread_add(&s->list, node);
+    SHARD_COUNT_STORE(s, s->count + 1);
+    pthread_mutex_unlock(&s->lock);
+}
+
+/**
+ * @brief      Pushes a node onto the calling CPU's shard.
+ *
+ * @param[in]  sh    Sharded container.
+ * @param[in]  node  Detached node to push.
+ */
+void glthread_sharded_push(glthread_sharded_t *sh, glthread_node_t *node)
+{
+    glthread_sharded_push_shard(sh, glthread_sharded_local(sh), node);
+}
+
+/**
+ * @brief      Cuts the first half (rounded up) of a victim's list out and
+ *             returns its first node. The remaining stolen nodes are spliced
+ *             onto the thief's shard in one step.
+ *
+ * @param[in]  self    Shard of the thief.
+ * @param[in]  victim  Shard to steal from.
+ *
+ * @return     A detached node, or NULL when the victim turned out empty.
+ */
+static glthread_node_t *glthread_sharded_steal(glthread_shard_t *self,
+                                               glthread_shard_t *victim)
+{
+    glthread_node_t *first, *last, *rest;
+    unsigned int take, k;
+
+    pthread_mutex_lock(&victim->lock);
+
+    if (!victim->count) {
+        pthread_mutex_unlock(&victim->lock);
+        return NULL;
+    }
+
+    take = (victim->count + 1) / 2;
+    first = last = victim->list.head;
+    for (k = 1; k < take; k++)
+        last = last->right;
+
+    victim->list.head = last->right;
+    if (last->right)
+        last->right->left = NULL;
+    SHARD_COUNT_STORE(victim, victim->count - take);
+    GLTHREAD_STATS_LIST_SUB(&victim->list, take);
+
+    pthread_mutex_unlock(&victim->lock);
+
+    last->right = NULL;
+    rest = first->right;
+    first->right = NULL;
+
+    if (!rest)
+        return first;
+
+    rest->left = NULL;
+
+    pthread_mutex_lock(&self->lock);
+    last->right = self->list.head;
+    if (self->list.head)
+        self->list.head->left = last;
+    self->list.head = rest;
+    SHARD_COUNT_STORE(self, self->count + take - 1);
+    GLTHREAD_STATS_LIST_ADD(&self->list, take - 1);
+    pthread_mutex_unlock(&self->lock);
+
+    return first;
+}
+
+/**
+ * @brief      Pops a node as if running on a given shard's CPU.
+ *
+ * @param[in]  sh     Sharded container.
+ * @param[in]  shard  Shard index, taken modulo the number of shards.
+ *
+ * @return     A detached node, or NULL when every shard is empty.
+ */
+glthread_node_t *glthread_sharded_pop_shard(glthread_sharded_t *sh,
+                                            unsigned int shard)
+{
+    unsigned int self_idx = shard % sh->nshards, i;
+    glthread_shard_t *self = &sh->shards[self_idx], *victim;
+    glthread_node_t *node;
+
+    pthread_mutex_lock(&self->lock);
+    node = self->list.head;
+    if (node) {
+        glthread_remove(&self->list, node);
+        SHARD_COUNT_STORE(self, self->count - 1);
+    }
+    pthread_mutex_unlock(&self->lock);
+
+    if (node)
+        return node;
+
+    for (i = 1; i < sh->nshards; i++) {
+        victim = &sh->shards[(self_idx + i) % sh->nshards];
+        if (!SHARD_COUNT_LOAD(victim))
+            continue;
+
+        node = glthread_sharded_steal(self, victim);
+        if (node)
+            return node;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief      Pops a node, stealing from other shards when the calling CPU's
+ *             shard is empty.
+ *
+ * @param[in]  sh  Sharded container.
+ *
+ * @return     A detached node, or NULL when every shard is empty.
+ */
+glthread_node_t *glthread_sharded_pop(glthread_sharded_t *sh)
+{
+    return glthread_sharded_pop_shard(sh, glthread_sharded_local(sh));
+}
+
+/**
+ * @brief      Counts the nodes held by all shards.
+ *
+ * @param[in]  sh  Sharded container.
+ *
+ * @return     Number of nodes.
+ */
+unsigned int glthread_sharded_count(glthread_sharded_t *sh)
+{
+    unsigned int i, total = 0;
+
+    for (i = 0; i < sh->nshards; i++)
+        total += SHARD_COUNT_LOAD(&sh->shards[i]);
+
+    return total;
+}
+
+#endif    // GLTHREADS_SHARD_C
@@ -0,0 +1,156 @@
+/* -----------------------------------------------------------------------------
+ * @file:        glthreads_shard.h
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        19/10/2026 04:00 PM
+ * @license:     MIT
+ * @description: This header file declares a sharded glthread container for
+ *               object pools and work queues shared between threads. It holds
+ *               one glthread per CPU, each on its own cache line with its own
+ *               lock. Push always goes to the shard of the calling CPU. Pop
+ *               takes from the local shard and, when that is empty, steals
+ *               half of another shard's list in a single splice, so a
+ *               starving CPU refills itself without coming back for every
+ *               node. The contents are organized into two groups:
+ *
+ *                 1. Structs:
+ *                    - struct glthread_shard_t
+ *                    - struct glthread_sharded_t
+ *
+ *                 2. Functions:
+ *                    - glthread_sharded_init
+ *                    - glthread_sharded_destroy
+ *                    - glthread_sharded_push
+ *                    - glthread_sharded_pop
+ *                    - glthread_sharded_push_shard
+ *                    - glthread_sharded_pop_shard
+ *                    - glthread_sharded_count
+ *                    - glthread_sharded_local
+ *
+ * @note:        This code is part of the tcpip-stack project, which is a course
+ *               on network development.
+ *
+ * Revision History:
+ *
+ * Revision 0.1: 19/10/2026 Marko Trickovic
+ * Initial version with per-CPU shards and half-list stealing.
+ */
+
+#ifndef GLTHREADS_SHARD_H
+#define GLTHREADS_SHARD_H
+
+#include <pthread.h>
+#include "glthreads.h"
+
+#define GLTHREAD_CACHE_LINE 64
+
+/**
+ * @brief      The structure representing one shard.
+ *
+ * @struct                glthread_shard_t
+ *
+ * @param[in]  lock       Protects list and count.
+ * @param[in]  list       Nodes held by this shard.
+ * @param[in]  count      Number of nodes on list.
+ */
+typedef struct glthread_shard_ {
+    pthread_mutex_t lock;
+    glthread_t list;
+    unsigned int count;
+} __attribute__((aligned(GLTHREAD_CACHE_LINE))) glthread_shard_t;
+
+/**
+ * @brief      The structure representing a sharded container.
+ *
+ * @struct                glthread_sharded_t
+ *
+ * @param[in]  shards     Array of nshards cache-line aligned shards.
+ * @param[in]  nshards    Number of shards.
+ * @param[in]  offset     Offset of the glthread_node_t in the user struct.
+ */
+typedef struct glthread_sharded_ {
+    glthread_shard_t *shards;
+    unsigned int nshards;
+    unsigned int offset;
+} glthread_sharded_t;
+
+/**
+ * @brief      Initializes a sharded container.
+ *
+ * @param[out] sh       Container to initialize.
+ * @param[in]  offset   Offset of the glthread_node_t in the user struct.
+ * @param[in]  nshards  Number of shards, 0 for one per configured CPU.
+ *
+ * @return     0 on success, -1 when out of memory.
+ */
+int glthread_sharded_init(glthread_sharded_t *sh, unsigned int offset,
+                          unsigned int nshards);
+
+/**
+ * @brief      Releases the shards. Nodes still held are not touched.
+ *
+ * @param[in]  sh  Container to destroy.
+ */
+void glthread_sharded_destroy(glthread_sharded_t *sh);
+
+/**
+ * @brief      Returns the shard index of the calling CPU.
+ *
+ * @param[in]  sh  Sharded container.
+ *
+ * @return     Index in [0, sh->nshards).
+ */
+unsigned int glthread_sharded_local(const glthread_sharded_t *sh);
+
+/**
+ * @brief      Pushes a node onto the calling CPU's shard.
+ *
+ * @param[in]  sh    Sharded container.
+ * @param[in]  node  Detached node to push.
+ */
+void glthread_sharded_push(glthread_sharded_t *sh, glthread_node_t *node);
+
+/**
+ * @brief      Pops a node, stealing from other shards when the calling CPU's
+ *             shard is empty.
+ *
+ * @param[in]  sh  Sharded container.
+ *
+ * @return     A detached node, or NULL when every shard is empty.
+ */
+glthread_node_t *glthread_sharded_pop(glthread_sharded_t *sh);
+
+/**
+ * @brief      Pushes a node onto a given shard.
+ *
+ * @param[in]  sh     Sharded container.
+ * @param[in]  shard  Shard index, taken modulo the number of shards.
+ * @param[in]  node   Detached node to push.
+ */
+void glthread_sharded_push_shard(glthread_sharded_t *sh, unsigned int shard,
+                                 glthread_node_t *node);
+
+/**
+ * @brief      Pops a node as if running on a given shard's CPU.
+ *
+ * @param[in]  sh     Sharded container.
+ * @param[in]  shard  Shard index, taken modulo the number of shards.
+ *
+ * @return     A detached node, or NULL when every shard is empty.
+ */
+glthread_node_t *glthread_sharded_pop_shard(glthread_sharded_t *sh,
+                                            unsigned int shard);
+
+/**
+ * @brief      Counts the nodes held by all shards.
+ *
+ * @details    The shards are read one after another without a global lock,
+ *             so the result is only exact when nobody is pushing or popping.
+ *
+ * @param[in]  sh  Sharded container.
+ *
+ * @return     Number of nodes.
+ */
+unsigned int glthread_sharded_count(glthread_sharded_t *sh);
+
+#endif    // GLTHREADS_SHARD_H
@@ -0,0 +1,218 @@
+/******************************************************************************
+ * @file:        glthreads_stats.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        19/10/2026 10:00 AM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the opt-in instrumentation layer for
+ *               glthreads. Each thread records into its own counter block,
+ *               allocated on first use and registered in a global list so
+ *               that a snapshot can sum all of them without any locking on
+ *               the recording path. The whole file compiles to nothing unless
+ *               GLTHREAD_STATS is defined.
+ *
+ *               Functions in this file:
+ *                 - glthread_stats_record
+ *                 - glthread_stats_snapshot
+ *                 - glthread_stats_reset
+ *                 - glthread_stats_dump
+ *                 - glthread_stats_dump_list
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 19/10/2026 Marko Trickovic
+ * Initial version with per-thread operation counters and cycle histograms.
+ *****************************************************************************/
+
+#ifndef GLTHREADS_STATS_C
+#define GLTHREADS_STATS_C
+
+#include "glthreads_stats.h"
+
+#ifdef GLTHREAD_STATS
+
+#include <pthread.h>
+#include <stdlib.h>
+
+/**
+ * @brief      Counter block owned by one thread. Blocks are never freed so
+ *             that counters of finished threads still show up in snapshots.
+ */
+typedef struct glthread_stats_block_ {
+    glthread_stats_t stats;
+    struct glthread_stats_block_ *next;
+} glthread_stats_block_t;
+
+static pthread_mutex_t stats_registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static glthread_stats_block_t *stats_registry;
+static __thread glthread_stats_block_t *stats_local;
+
+static const char *const stats_op_names[GLTHREAD_OP_MAX] = {
+    [GLTHREAD_OP_ADD]       = "glthread_add",
+    [GLTHREAD_OP_ADD_NEXT]  = "glthread_add_next",
+    [GLTHREAD_OP_ADD_AFTER] = "glthread_add_after",
+    [GLTHREAD_OP_REMOVE]    = "glthread_remove",
+};
+
+/**
+ * @brief      Allocates and registers the counter block of the calling thread.
+ *
+ * @return     The new block, or NULL when out of memory.
+ */
+static glthread_stats_block_t *glthread_stats_register(void)
+{
+    glthread_stats_block_t *blk = calloc(1, sizeof(*blk));
+
+    if (!blk)
+        return NULL;
+
+    pthread_mutex_lock(&stats_registry_lock);
+    blk->next = stats_registry;
+    stats_registry = blk;
+    pthread_mutex_unlock(&stats_registry_lock);
+
+    stats_local = blk;
+    return blk;
+}
+
+/**
+ * @brief      Maps a cycle count to its log2 histogram bucket.
+ *
+ * @param[in]  cycles  Cycles an operation took.
+ *
+ * @return     Bucket index in [0, GLTHREAD_STATS_HIST_BUCKETS).
+ */
+static inline unsigned int glthread_stats_bucket(uint64_t cycles)
+{
+    unsigned int b = 63 - __builtin_clzll(cycles | 1);
+
+    return b < GLTHREAD_STATS_HIST_BUCKETS ? b
+                                           : GLTHREAD_STATS_HIST_BUCKETS - 1;
+}
+
+/*
+ * Counters are only ever written by their owning thread, the relaxed atomic
+ * accessors merely keep concurrent snapshots free of torn reads.
+ */
+#define STATS_LOAD(p)       __atomic_load_n((p), __ATOMIC_RELAXED)
+#define STATS_STORE(p, v)   __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#define STATS_ADD(p, v)     STATS_STORE((p), STATS_LOAD(p) + (v))
+
+/**
+ * @brief      Records one operation into the calling thread's counters.
+ *
+ * @param[in]  op      Operation that was performed.
+ * @param[in]  cycles  Cycles the operation took.
+ */
+void glthread_stats_record(glthread_op_t op, uint64_t cycles)
+{
+    glthread_stats_block_t *blk = stats_local;
+
+    if (!blk && !(blk = glthread_stats_register()))
+        return;
+
+    STATS_ADD(&blk->stats.ops[op], 1);
+    STATS_ADD(&blk->stats.cycles[op], cycles);
+    STATS_ADD(&blk->stats.hist[op][glthread_stats_bucket(cycles)], 1);
+}
+
+/**
+ * @brief      Sums the counters of every thread that has recorded an
+ *             operation so far.
+ *
+ * @param[out] out  Destination for the aggregated counters.
+ */
+void glthread_stats_snapshot(glthread_stats_t *out)
+{
+    glthread_stats_block_t *blk;
+    unsigned int op, b;
+
+    memset(out, 0, sizeof(*out));
+
+    pthread_mutex_lock(&stats_registry_lock);
+    for (blk = stats_registry; blk; blk = blk->next) {
+        for (op = 0; op < GLTHREAD_OP_MAX; op++) {
+            out->ops[op] += STATS_LOAD(&blk->stats.ops[op]);
+            out->cycles[op] += STATS_LOAD(&blk->stats.cycles[op]);
+            for (b = 0; b < GLTHREAD_STATS_HIST_BUCKETS; b++)
+                out->hist[op][b] += STATS_LOAD(&blk->stats.hist[op][b]);
+        }
+        out->threads++;
+    }
+    pthread_mutex_unlock(&stats_registry_lock);
+}
+
+/**
+ * @brief      Clears the counters of every registered thread.
+ *
+ * @details    Counters a thread records while the reset is running may be
+ *             lost, which is acceptable for statistics.
+ */
+void glthread_stats_reset(void)
+{
+    glthread_stats_block_t *blk;
+    unsigned int op, b;
+
+    pthread_mutex_lock(&stats_registry_lock);
+    for (blk = stats_registry; blk; blk = blk->next) {
+        for (op = 0; op < GLTHREAD_OP_MAX; op++) {
+            STATS_STORE(&blk->stats.ops[op], 0);
+            STATS_STORE(&blk->stats.cycles[op], 0);
+            for (b = 0; b < GLTHREAD_STATS_HIST_BUCKETS; b++)
+                STATS_STORE(&blk->stats.hist[op][b], 0);
+        }
+    }
+    pthread_mutex_unlock(&stats_registry_lock);
+}
+
+/**
+ * @brief      Prints aggregated operation counts, average cycles and the
+ *             non-empty histogram buckets.
+ *
+ * @param[in]  fp  Stream to print to.
+ */
+void glthread_stats_dump(FILE *fp)
+{
+    glthread_stats_t s;
+    unsigned int op, b;
+
+    glthread_stats_snapshot(&s);
+
+    fprintf(fp, "glthread stats (%u threads)\n", s.threads);
+    fprintf(fp, "%-20s %14s %12s\n", "operation", "calls", "avg cycles");
+
+    for (op = 0; op < GLTHREAD_OP_MAX; op++) {
+        fprintf(fp, "%-20s %14llu %12.1f\n", stats_op_names[op],
+                (unsigned long long)s.ops[op],
+                s.ops[op] ? (double)s.cycles[op] / (double)s.ops[op] : 0.0);
+
+        for (b = 0; b < GLTHREAD_STATS_HIST_BUCKETS; b++) {
+            if (!s.hist[op][b])
+                continue;
+            fprintf(fp, "    [%10llu, %10llu) %14llu\n",
+                    1ull << b, 1ull << (b + 1),
+                    (unsigned long long)s.hist[op][b]);
+        }
+    }
+}
+
+/**
+ * @brief      Prints the current length and high-water mark of a list.
+ *
+ * @param[in]  fp    Stream to print to.
+ * @param[in]  name  Label printed in front of the numbers.
+ * @param[in]  lst   Pointer to the Linked List.
+ */
+void glthread_stats_dump_list(FILE *fp, const char *name,
+                              const glthread_t *lst)
+{
+    fprintf(fp, "%s: length %u, high-water mark %u\n",
+            name, lst->count, lst->count_hwm);
+}
+
+#endif    // GLTHREAD_STATS
+
+#endif    // GLTHREADS_STATS_C
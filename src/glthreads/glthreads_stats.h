@@ -0,0 +1,227 @@
+/* -----------------------------------------------------------------------------
+ * @file:        glthreads_stats.h
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        19/10/2026 10:00 AM
+ * @license:     MIT
+ * @description: This header file declares the opt-in instrumentation layer for
+ *               glthreads. When the project is compiled with GLTHREAD_STATS
+ *               defined, every glthread_add, glthread_add_next,
+ *               glthread_add_after and glthread_remove call is counted and
+ *               timed in cycles into per-thread counters, and every
+ *               glthread_t tracks its current length and high-water mark.
+ *               The length follows glthread_add, glthread_add_after and
+ *               glthread_remove; glthread_add_next has no list to count
+ *               into, and code that links nodes by hand keeps the length
+ *               with the GLTHREAD_STATS_LIST_* hooks. Chains with no
+ *               glthread_t, such as packet segments, have no length. Without
+ *               GLTHREAD_STATS all of the hooks below expand to nothing. The
+ *               contents are organized into three groups:
+ *
+ *                 1. Structs:
+ *                    - struct glthread_stats_t
+ *
+ *                 2. Functions:
+ *                    - glthread_stats_snapshot
+ *                    - glthread_stats_reset
+ *                    - glthread_stats_dump
+ *                    - glthread_stats_dump_list
+ *
+ *                 3. Macros:
+ *                    - GLTHREAD_STATS_OP_BEGIN
+ *                    - GLTHREAD_STATS_OP_END
+ *                    - GLTHREAD_STATS_LIST_INC
+ *                    - GLTHREAD_STATS_LIST_DEC
+ *                    - GLTHREAD_STATS_LIST_ADD
+ *                    - GLTHREAD_STATS_LIST_SUB
+ *                    - GLTHREAD_STATS_LIST_INIT
+ *
+ * @note:        This code is part of the tcpip-stack project, which is a course
+ *               on network development.
+ *
+ * Revision History:
+ *
+ * Revision 0.1: 19/10/2026 Marko Trickovic
+ * Initial version with per-thread operation counters and cycle histograms.
+ *
+ * Revision 0.2: 19/10/2026 Marko Trickovic
+ * Counted glthread_add_after and added hooks for moving several nodes.
+ */
+
+#ifndef GLTHREADS_STATS_H
+#define GLTHREADS_STATS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "glthreads.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+/**
+ * @brief      Operations that are counted by the instrumentation layer.
+ */
+typedef enum {
+    GLTHREAD_OP_ADD,
+    GLTHREAD_OP_ADD_NEXT,
+    GLTHREAD_OP_ADD_AFTER,
+    GLTHREAD_OP_REMOVE,
+    GLTHREAD_OP_MAX
+} glthread_op_t;
+
+/**
+ * @brief      Number of log2 buckets in each cycle histogram. Bucket i counts
+ *             calls that took [2^i, 2^(i+1)) cycles, the last bucket also
+ *             collects everything slower.
+ */
+#define GLTHREAD_STATS_HIST_BUCKETS 32
+
+/**
+ * @brief      The structure representing a set of operation counters.
+ *
+ * @struct                glthread_stats_t
+ *
+ * @param[out] ops        Number of calls per operation.
+ * @param[out] cycles     Total cycles spent per operation.
+ * @param[out] hist       Cycle histogram per operation.
+ * @param[out] threads    Number of threads that contributed to a snapshot.
+ */
+typedef struct glthread_stats_ {
+    uint64_t ops[GLTHREAD_OP_MAX];
+    uint64_t cycles[GLTHREAD_OP_MAX];
+    uint64_t hist[GLTHREAD_OP_MAX][GLTHREAD_STATS_HIST_BUCKETS];
+    unsigned int threads;
+} glthread_stats_t;
+
+#ifdef GLTHREAD_STATS
+
+/**
+ * @brief      Reads the cheapest available cycle counter.
+ *
+ * @return     Current value of the time stamp counter, or nanoseconds on
+ *             platforms without one.
+ */
+static inline uint64_t glthread_stats_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/**
+ * @brief      Records one operation into the calling thread's counters.
+ *
+ * @param[in]  op      Operation that was performed.
+ * @param[in]  cycles  Cycles the operation took.
+ */
+void glthread_stats_record(glthread_op_t op, uint64_t cycles);
+
+/**
+ * @brief      Sums the counters of every thread that has recorded an
+ *             operation so far.
+ *
+ * @param[out] out  Destination for the aggregated counters.
+ */
+void glthread_stats_snapshot(glthread_stats_t *out);
+
+/**
+ * @brief      Clears the counters of every registered thread.
+ */
+void glthread_stats_reset(void);
+
+/**
+ * @brief      Prints aggregated operation counts, average cycles and the
+ *             non-empty histogram buckets.
+ *
+ * @param[in]  fp  Stream to print to.
+ */
+void glthread_stats_dump(FILE *fp);
+
+/**
+ * @brief      Prints the current length and high-water mark of a list.
+ *
+ * @param[in]  fp    Stream to print to.
+ * @param[in]  name  Label printed in front of the numbers.
+ * @param[in]  lst   Pointer to the Linked List.
+ */
+void glthread_stats_dump_list(FILE *fp, const char *name,
+                              const glthread_t *lst);
+
+#define GLTHREAD_STATS_OP_BEGIN(var)                                      \
+    uint64_t var = glthread_stats_cycles()
+
+#define GLTHREAD_STATS_OP_END(op, var)                                    \
+    glthread_stats_record((op), glthread_stats_cycles() - (var))
+
+#define GLTHREAD_STATS_LIST_INIT(lstptr)                                  \
+    do {                                                                  \
+        (lstptr)->count = 0;                                              \
+        (lstptr)->count_hwm = 0;                                          \
+    } while (0)
+
+#define GLTHREAD_STATS_LIST_INC(lstptr)                                   \
+    do {                                                                  \
+        if (++(lstptr)->count > (lstptr)->count_hwm)                      \
+            (lstptr)->count_hwm = (lstptr)->count;                        \
+    } while (0)
+
+#define GLTHREAD_STATS_LIST_DEC(lstptr)                                   \
+    do {                                                                  \
+        if ((lstptr)->count)                                              \
+            (lstptr)->count--;                                            \
+    } while (0)
+
+#define GLTHREAD_STATS_LIST_ADD(lstptr, n)                                \
+    do {                                                                  \
+        (lstptr)->count += (n);                                           \
+        if ((lstptr)->count > (lstptr)->count_hwm)                        \
+            (lstptr)->count_hwm = (lstptr)->count;                        \
+    } while (0)
+
+#define GLTHREAD_STATS_LIST_SUB(lstptr, n)                                \
+    do {                                                                  \
+        (lstptr)->count = (lstptr)->count > (n)                           \
+                              ? (lstptr)->count - (n) : 0;                \
+    } while (0)
+
+#else    // GLTHREAD_STATS
+
+static inline void glthread_stats_snapshot(glthread_stats_t *out)
+{
+    memset(out, 0, sizeof(*out));
+}
+
+static inline void glthread_stats_reset(void) {}
+
+static inline void glthread_stats_dump(FILE *fp)
+{
+    (void)fp;
+}
+
+static inline void glthread_stats_dump_list(FILE *fp, const char *name,
+                                            const glthread_t *lst)
+{
+    (void)fp;
+    (void)name;
+    (void)lst;
+}
+
+#define GLTHREAD_STATS_OP_BEGIN(var)
+#define GLTHREAD_STATS_OP_END(op, var)
+#define GLTHREAD_STATS_LIST_INIT(lstptr)
+#define GLTHREAD_STATS_LIST_INC(lstptr)
+#define GLTHREAD_STATS_LIST_DEC(lstptr)
+#define GLTHREAD_STATS_LIST_ADD(lstptr, n)
+#define GLTHREAD_STATS_LIST_SUB(lstptr, n)
+
+#endif    // GLTHREAD_STATS
+
+#endif    // GLTHREADS_STATS_H
@@ -0,0 +1,490 @@
+/******************************************************************************
+ * @file:        graph.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        20/10/2026 04:00 PM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the network topology graph. Nodes and links
+ *               are carved from cache-line aligned blocks owned by the graph,
+ *               so building a topology costs one allocation per few hundred
+ *               nodes and neighbouring nodes end up next to each other in
+ *               memory. Node names are hashed into an open addressing table
+ *               that doubles when half full; interface names are hashed into
+ *               a fixed table inside each node; interfaces are indexed by
+ *               ifindex in a table that doubles as links are added. Nodes and
+ *               links live until the graph is destroyed.
+ *
+ *               Functions in this file:
+ *                 - create_new_graph
+ *                 - create_graph_node
+ *                 - graph_reserve
+ *                 - insert_link_between_two_nodes
+ *                 - get_node_by_node_name
+ *                 - get_node_intf_by_name
+ *                 - dump_graph
+ *                 - dump_node
+ *                 - dump_interface
+ *                 - destroy_graph
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 20/10/2026 Marko Trickovic
+ * Initial version with split hot/cold node layout and O(1) interface lookup.
+ *
+ * Revision 0.2: 20/10/2026 Marko Trickovic
+ * Added graph_reserve for bulk loading.
+ *****************************************************************************/
+
+#ifndef GRAPH_C
+#define GRAPH_C
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "graph.h"
+
+#define GRAPH_BLOCK_HDR         64
+#define GRAPH_NODES_PER_BLOCK   256
+#define GRAPH_LINKS_PER_BLOCK   1024
+#define GRAPH_NAME_TBL_MIN      64
+#define GRAPH_IFINDEX_TBL_MIN   64
+
+/**
+ * @brief      FNV-1a hash of a name of at most max bytes.
+ */
+static inline uint32_t graph_name_hash(const char *name, size_t max)
+{
+    uint32_t h = 2166136261u;
+
+    while (max-- && *name) {
+        h ^= (unsigned char)*name++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/**
+ * @brief      Tells whether a name is non-empty and fits a buffer of size
+ *             bytes with its terminator.
+ */
+static inline int graph_name_fits(const char *name, size_t size)
+{
+    return name && name[0] && strnlen(name, size) < size;
+}
+
+/**
+ * @brief      Allocates a block for count objects of size bytes each and
+ *             chains it onto the graph.
+ *
+ * @return     The first object, or NULL when out of memory.
+ */
+static void *graph_block_alloc(graph_t *graph, size_t size, uint32_t count)
+{
+    graph_block_t *block;
+    size_t bytes = GRAPH_BLOCK_HDR + size * count;
+
+    // aligned_alloc wants a multiple of the alignment
+    block = aligned_alloc(64, (bytes + 63) & ~(size_t)63);
+    if (!block)
+        return NULL;
+
+    block->next = graph->blocks;
+    graph->blocks = block;
+    return (char *)block + GRAPH_BLOCK_HDR;
+}
+
+/**
+ * @brief      Inserts a node into the name table, which must have room.
+ */
+static void graph_name_tbl_insert(node_t **tbl, uint32_t size, node_t *node)
+{
+    uint32_t i = graph_name_hash(node->node_name, NODE_NAME_SIZE) & (size - 1);
+
+    while (tbl[i])
+        i = (i + 1) & (size - 1);
+    tbl[i] = node;
+}
+
+/**
+ * @brief      Grows the name table by doubling until count more nodes fit
+ *             with the table at most half full.
+ *
+ * @return     0 on success, -1 when out of memory.
+ */
+static int graph_name_tbl_reserve(graph_t *graph, uint32_t count)
+{
+    node_t **tbl, **old = graph->name_tbl;
+    uint64_t need = ((uint64_t)graph->node_count + count) * 2;
+    uint32_t size, i;
+
+    if (need <= graph->name_tbl_size)
+        return 0;
+
+    size = graph->name_tbl_size ? graph->name_tbl_size : GRAPH_NAME_TBL_MIN;
+    while (size < need)
+        size *= 2;
+    tbl = calloc(size, sizeof(*tbl));
+    if (!tbl)
+        return -1;
+
+    for (i = 0; i < graph->name_tbl_size; i++)
+        if (old[i])
+            graph_name_tbl_insert(tbl, size, old[i]);
+
+    free(old);
+    graph->name_tbl = tbl;
+    graph->name_tbl_size = size;
+    return 0;
+}
+
+/**
+ * @brief      Makes room for count more entries in the ifindex table.
+ *
+ * @return     0 on success, -1 when out of memory.
+ */
+static int graph_ifindex_reserve(graph_t *graph, uint64_t count)
+{
+    interface_t **tbl;
+    uint64_t cap = graph->ifindex_cap;
+
+    if (graph->ifindex_next + count <= cap)
+        return 0;
+
+    while (graph->ifindex_next + count > cap)
+        cap = cap ? cap * 2 : GRAPH_IFINDEX_TBL_MIN;
+
+    tbl = realloc(graph->ifindex_tbl, cap * sizeof(*tbl));
+    if (!tbl)
+        return -1;
+
+    graph->ifindex_tbl = tbl;
+    graph->ifindex_cap = (uint32_t)cap;
+    return 0;
+}
+
+/**
+ * @brief      Returns the hash bucket holding if_name on node, or the empty
+ *             bucket where it would go.
+ */
+static uint32_t node_intf_hash_find(node_t *node, const char *if_name)
+{
+    uint32_t i = graph_name_hash(if_name, IF_NAME_SIZE) % NODE_INTF_HASH_SIZE;
+    uint8_t slot;
+
+    while ((slot = node->intf_hash[i])) {
+        if (!strncmp(node->intf_cfg[slot - 1].if_name, if_name, IF_NAME_SIZE))
+            break;
+        i = (i + 1) % NODE_INTF_HASH_SIZE;
+    }
+    return i;
+}
+
+/**
+ * @brief      Claims the next interface slot of a node under a name the
+ *             caller has checked is free.
+ */
+static interface_t *node_intf_claim(node_t *node, const char *if_name,
+                                    uint32_t ifindex)
+{
+    uint32_t slot = node->intf_count++;
+    interface_t *intf = &node->intf[slot];
+
+    strncpy(node->intf_cfg[slot].if_name, if_name, IF_NAME_SIZE);
+    node->intf_hash[node_intf_hash_find(node, if_name)] = (uint8_t)(slot + 1);
+
+    intf->att_node = node;
+    intf->ifindex = ifindex;
+    return intf;
+}
+
+/**
+ * @brief      Creates an empty graph.
+ *
+ * @param[in]  topology_name  Name of the topology, truncated to fit.
+ *
+ * @return     The new graph, or NULL when out of memory.
+ */
+graph_t *create_new_graph(const char *topology_name)
+{
+    graph_t *graph = calloc(1, sizeof(*graph));
+
+    if (!graph)
+        return NULL;
+
+    strncpy(graph->topology_name, topology_name, TOPO_NAME_SIZE - 1);
+    init_glthread(&graph->node_list, offset(node_t, graph_glue));
+    graph->ifindex_next = 1;    // 0 is never a valid ifindex
+
+    if (graph_ifindex_reserve(graph, 0) < 0) {
+        free(graph);
+        return NULL;
+    }
+    graph->ifindex_tbl[0] = NULL;
+
+    return graph;
+}
+
+/**
+ * @brief      Creates a node and appends it to the graph's node list.
+ *
+ * @param[in]  graph      Graph to add the node to.
+ * @param[in]  node_name  Node name, shorter than NODE_NAME_SIZE.
+ *
+ * @return     The new node, or NULL on failure.
+ */
+node_t *create_graph_node(graph_t *graph, const char *node_name)
+{
+    node_t *node;
+
+    if (!graph_name_fits(node_name, NODE_NAME_SIZE) ||
+        get_node_by_node_name(graph, node_name))
+        return NULL;
+
+    if (graph_name_tbl_reserve(graph, 1) < 0)
+        return NULL;
+
+    if (!graph->node_avail) {
+        graph->node_free = graph_block_alloc(graph, sizeof(node_t),
+                                             GRAPH_NODES_PER_BLOCK);
+        if (!graph->node_free)
+            return NULL;
+        graph->node_avail = GRAPH_NODES_PER_BLOCK;
+    }
+    node = graph->node_free++;
+    graph->node_avail--;
+
+    memset(node, 0, sizeof(*node));
+    memcpy(node->node_name, node_name, strlen(node_name) + 1);
+    node->node_id = graph->node_count++;
+    node->graph = graph;
+
+    graph_name_tbl_insert(graph->name_tbl, graph->name_tbl_size, node);
+
+    // Append so that the list walks nodes in creation, i.e. memory, order
+    glthread_add_after(&graph->node_list, graph->node_tail, &node->graph_glue);
+    graph->node_tail = &node->graph_glue;
+
+    return node;
+}
+
+/**
+ * @brief      Preallocates room for more nodes and links.
+ *
+ * @param[in]  graph   Graph to grow.
+ * @param[in]  nnodes  Nodes about to be created.
+ * @param[in]  nlinks  Links about to be inserted.
+ *
+ * @return     0 on success, -1 when out of memory.
+ */
+int graph_reserve(graph_t *graph, uint32_t nnodes, uint32_t nlinks)
+{
+    void *block;
+
+    if (graph_name_tbl_reserve(graph, nnodes) < 0 ||
+        graph_ifindex_reserve(graph, 2 * (uint64_t)nlinks) < 0)
+        return -1;
+
+    // The rest of the current blocks is dropped, at most one block's worth
+    if (nnodes > graph->node_avail) {
+        block = graph_block_alloc(graph, sizeof(node_t), nnodes);
+        if (!block)
+            return -1;
+        graph->node_free = block;
+        graph->node_avail = nnodes;
+    }
+
+    if (nlinks > graph->link_avail) {
+        block = graph_block_alloc(graph, sizeof(link_t), nlinks);
+        if (!block)
+            return -1;
+        graph->link_free = block;
+        graph->link_avail = nlinks;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief      Creates one interface on each node and links them.
+ *
+ * @param[in]  node1         First node.
+ * @param[in]  node2         Second node, in the same graph.
+ * @param[in]  from_if_name  Name of the new interface on node1.
+ * @param[in]  to_if_name    Name of the new interface on node2.
+ * @param[in]  cost          Link cost.
+ *
+ * @return     0 on success, -1 on failure with nothing changed.
+ */
+int insert_link_between_two_nodes(node_t *node1, node_t *node2,
+                                  const char *from_if_name,
+                                  const char *to_if_name, unsigned int cost)
+{
+    graph_t *graph = node1->graph;
+    interface_t *intf1, *intf2;
+    link_t *link;
+
+    if (!graph_name_fits(from_if_name, IF_NAME_SIZE) ||
+        !graph_name_fits(to_if_name, IF_NAME_SIZE) || node2->graph != graph)
+        return -1;
+
+    // Check everything up front so that a failure leaves both nodes alone
+    if (node1 == node2) {
+        if (node1->intf_count + 2 > MAX_INTF_PER_NODE ||
+            !strncmp(from_if_name, to_if_name, IF_NAME_SIZE))
+            return -1;
+    } else if (get_node_intf_available_slot(node1) < 0 ||
+               get_node_intf_available_slot(node2) < 0) {
+        return -1;
+    }
+
+    if (get_node_intf_by_name(node1, from_if_name) ||
+        get_node_intf_by_name(node2, to_if_name))
+        return -1;
+
+    if (graph_ifindex_reserve(graph, 2) < 0)
+        return -1;
+
+    if (!graph->link_avail) {
+        graph->link_free = graph_block_alloc(graph, sizeof(link_t),
+                                             GRAPH_LINKS_PER_BLOCK);
+        if (!graph->link_free)
+            return -1;
+        graph->link_avail = GRAPH_LINKS_PER_BLOCK;
+    }
+    link = graph->link_free++;
+    graph->link_avail--;
+
+    intf1 = node_intf_claim(node1, from_if_name, graph->ifindex_next++);
+    intf2 = node_intf_claim(node2, to_if_name, graph->ifindex_next++);
+    graph->ifindex_tbl[intf1->ifindex] = intf1;
+    graph->ifindex_tbl[intf2->ifindex] = intf2;
+
+    link->intf1 = intf1;
+    link->intf2 = intf2;
+    link->cost = cost;
+
+    intf1->nbr = intf2;
+    intf1->link = link;
+    intf1->cost = cost;
+    intf2->nbr = intf1;
+    intf2->link = link;
+    intf2->cost = cost;
+
+    return 0;
+}
+
+/**
+ * @brief      Looks up a node by name in O(1).
+ *
+ * @param[in]  graph      Graph to search.
+ * @param[in]  node_name  Node name.
+ *
+ * @return     The node, or NULL.
+ */
+node_t *get_node_by_node_name(graph_t *graph, const char *node_name)
+{
+    uint32_t mask = graph->name_tbl_size - 1, i;
+    node_t *node;
+
+    if (!graph->name_tbl_size)
+        return NULL;
+
+    i = graph_name_hash(node_name, NODE_NAME_SIZE) & mask;
+    while ((node = graph->name_tbl[i])) {
+        if (!strncmp(node->node_name, node_name, NODE_NAME_SIZE))
+            return node;
+        i = (i + 1) & mask;
+    }
+    return NULL;
+}
+
+/**
+ * @brief      Looks up an interface of a node by name in O(1).
+ *
+ * @param[in]  node     Node to search.
+ * @param[in]  if_name  Interface name.
+ *
+ * @return     The interface, or NULL.
+ */
+interface_t *get_node_intf_by_name(node_t *node, const char *if_name)
+{
+    uint8_t slot = node->intf_hash[node_intf_hash_find(node, if_name)];
+
+    return slot ? &node->intf[slot - 1] : NULL;
+}
+
+/**
+ * @brief      Prints every node of the graph to stdout.
+ *
+ * @param[in]  graph  Graph to print.
+ */
+void dump_graph(graph_t *graph)
+{
+    glthread_t *lst = &graph->node_list;
+    node_t *node;
+
+    printf("Topology Name = %s\n", graph->topology_name);
+
+    ITERATE_GL_THREADS_BEGIN(lst, node_t, node) {
+        dump_node(node);
+    } ITERATE_GL_THREADS_ENDS;
+}
+
+/**
+ * @brief      Prints a node and its interfaces to stdout.
+ *
+ * @param[in]  node  Node to print.
+ */
+void dump_node(node_t *node)
+{
+    interface_t *intf;
+
+    printf("Node Name = %s :\n", node->node_name);
+
+    ITERATE_NODE_INTERFACES_BEGIN(node, intf) {
+        dump_interface(intf);
+    } ITERATE_NODE_INTERFACES_ENDS;
+}
+
+/**
+ * @brief      Prints an interface to stdout.
+ *
+ * @param[in]  intf  Interface to print.
+ */
+void dump_interface(interface_t *intf)
+{
+    node_t *nbr = get_nbr_node(intf);
+
+    printf(" Interface Name = %s, ifindex = %u\n", get_intf_name(intf),
+           intf->ifindex);
+    printf("\tNbr Node %s, Local Node : %s, cost = %u\n",
+           nbr ? nbr->node_name : "Nil", intf->att_node->node_name,
+           intf->cost);
+}
+
+/**
+ * @brief      Frees the graph with all of its nodes and links.
+ *
+ * @param[in]  graph  Graph to free, may be NULL.
+ */
+void destroy_graph(graph_t *graph)
+{
+    graph_block_t *block, *next;
+
+    if (!graph)
+        return;
+
+    for (block = graph->blocks; block; block = next) {
+        next = block->next;
+        free(block);
+    }
+
+    free(graph->name_tbl);
+    free(graph->ifindex_tbl);
+    free(graph);
+}
+
+#endif    // GRAPH_C
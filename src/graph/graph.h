@@ -0,0 +1,365 @@
+/* -----------------------------------------------------------------------------
+ * @file:        graph.h
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        20/10/2026 04:00 PM
+ * @license:     MIT
+ * @description: This header file declares the network topology graph: nodes,
+ *               their interfaces and the links between interfaces. Nodes are
+ *               kept on a glthread in creation order. A node's interfaces sit
+ *               in a fixed array inside the node, and the fields used when
+ *               forwarding come first so that walking a node's neighbours
+ *               touches a few contiguous cache lines; names and other
+ *               configuration follow in a cold section. Interfaces can be
+ *               looked up in O(1) by name, through a small per-node hash, and
+ *               by ifindex, through a graph-wide table. The contents are
+ *               organized into three groups:
+ *
+ *                 1. Structs:
+ *                    - struct interface_t
+ *                    - struct intf_cfg_t
+ *                    - struct link_t
+ *                    - struct node_t
+ *                    - struct graph_t
+ *
+ *                 2. Functions:
+ *                    - create_new_graph
+ *                    - create_graph_node
+ *                    - graph_reserve
+ *                    - insert_link_between_two_nodes
+ *                    - get_node_by_node_name
+ *                    - get_node_intf_by_name
+ *                    - get_intf_by_ifindex
+ *                    - get_nbr_node
+ *                    - get_node_intf_available_slot
+ *                    - get_intf_name
+ *                    - dump_graph
+ *                    - dump_node
+ *                    - dump_interface
+ *                    - destroy_graph
+ *
+ *                 3. Macros:
+ *                    - NODE_NAME_SIZE
+ *                    - IF_NAME_SIZE
+ *                    - MAX_INTF_PER_NODE
+ *                    - ITERATE_NODE_INTERFACES_BEGIN
+ *
+ * @note:        This code is part of the tcpip-stack project, which is a course
+ *               on network development.
+ *
+ * Revision History:
+ *
+ * Revision 0.1: 20/10/2026 Marko Trickovic
+ * Initial version with split hot/cold node layout and O(1) interface lookup.
+ *
+ * Revision 0.2: 20/10/2026 Marko Trickovic
+ * Added graph_reserve for bulk loading.
+ */
+
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include <stdint.h>
+#include "../glthreads/glthreads.h"
+
+#define NODE_NAME_SIZE      16
+#define IF_NAME_SIZE        16
+#define TOPO_NAME_SIZE      32
+
+/** Interfaces per node; may be overridden at build time, at most 255. */
+#ifndef MAX_INTF_PER_NODE
+#define MAX_INTF_PER_NODE   16
+#endif
+
+#if MAX_INTF_PER_NODE > 255
+#error "MAX_INTF_PER_NODE must fit the uint8_t interface name hash"
+#endif
+
+/** Buckets of the per-node interface name hash, half of them stay empty. */
+#define NODE_INTF_HASH_SIZE (2 * MAX_INTF_PER_NODE)
+
+struct node_;
+struct link_;
+struct graph_;
+
+/**
+ * @brief      The structure representing the forwarding view of an interface.
+ *
+ * @struct                interface_t
+ *
+ * @param[in]  att_node   Node owning the interface.
+ * @param[in]  nbr        Interface at the other end of the link.
+ * @param[in]  link       Link the interface is attached to.
+ * @param[in]  ifindex    Graph-wide interface index, starting at 1.
+ * @param[in]  cost       Link cost, copied from the link.
+ */
+typedef struct interface_ {
+    struct node_ *att_node;
+    struct interface_ *nbr;
+    struct link_ *link;
+    uint32_t ifindex;
+    uint32_t cost;
+} interface_t;
+
+/**
+ * @brief      The structure representing the configuration of an interface,
+ *             kept apart from interface_t.
+ *
+ * @struct                intf_cfg_t
+ *
+ * @param[in]  if_name    Interface name, unique within the node.
+ */
+typedef struct intf_cfg_ {
+    char if_name[IF_NAME_SIZE];
+} intf_cfg_t;
+
+/**
+ * @brief      The structure representing a link between two interfaces.
+ *
+ * @struct                link_t
+ *
+ * @param[in]  intf1      First end.
+ * @param[in]  intf2      Second end.
+ * @param[in]  cost       Link cost.
+ */
+typedef struct link_ {
+    interface_t *intf1;
+    interface_t *intf2;
+    unsigned int cost;
+} link_t;
+
+/**
+ * @brief      The structure representing a network node. The hot section is
+ *             laid out first; intf[i] and intf_cfg[i] describe the same
+ *             interface.
+ *
+ * @struct                node_t
+ *
+ * @param[in]  graph_glue  Glue onto graph_t.node_list.
+ * @param[in]  node_id     Creation order index within the graph.
+ * @param[in]  intf_count  Interfaces in use, intf[0..intf_count).
+ * @param[in]  intf        Interfaces.
+ * @param[in]  node_name   Node name, unique within the graph.
+ * @param[in]  graph       Graph owning the node.
+ * @param[in]  intf_hash   Interface name hash, slot + 1 or 0 when empty.
+ * @param[in]  intf_cfg    Interface configuration.
+ */
+typedef struct node_ {
+    glthread_node_t graph_glue;
+    uint32_t node_id;
+    uint32_t intf_count;
+    interface_t intf[MAX_INTF_PER_NODE];
+
+    char node_name[NODE_NAME_SIZE];
+    struct graph_ *graph;
+    uint8_t intf_hash[NODE_INTF_HASH_SIZE];
+    intf_cfg_t intf_cfg[MAX_INTF_PER_NODE];
+} __attribute__((aligned(64))) node_t;
+
+/**
+ * @brief      The structure representing a block of memory nodes and links
+ *             are carved from.
+ */
+typedef struct graph_block_ {
+    struct graph_block_ *next;
+} graph_block_t;
+
+/**
+ * @brief      The structure representing a network topology.
+ *
+ * @struct                graph_t
+ *
+ * @param[in]  topology_name  Name of the topology.
+ * @param[in]  node_list      Nodes in creation order.
+ * @param[in]  node_tail      Last node on node_list.
+ * @param[in]  node_count     Number of nodes.
+ * @param[in]  ifindex_tbl    Interfaces indexed by ifindex.
+ * @param[in]  ifindex_next   Next ifindex to hand out.
+ * @param[in]  ifindex_cap    Capacity of ifindex_tbl.
+ * @param[in]  name_tbl       Open addressing hash of nodes by name.
+ * @param[in]  name_tbl_size  Buckets in name_tbl, a power of two.
+ * @param[in]  blocks         Memory blocks owned by the graph.
+ * @param[in]  node_free      Next unused node in the current node block.
+ * @param[in]  node_avail     Unused nodes left in the current node block.
+ * @param[in]  link_free      Next unused link in the current link block.
+ * @param[in]  link_avail     Unused links left in the current link block.
+ */
+typedef struct graph_ {
+    char topology_name[TOPO_NAME_SIZE];
+    glthread_t node_list;
+    glthread_node_t *node_tail;
+    uint32_t node_count;
+
+    interface_t **ifindex_tbl;
+    uint32_t ifindex_next;
+    uint32_t ifindex_cap;
+
+    node_t **name_tbl;
+    uint32_t name_tbl_size;
+
+    graph_block_t *blocks;
+    node_t *node_free;
+    uint32_t node_avail;
+    link_t *link_free;
+    uint32_t link_avail;
+} graph_t;
+
+/**
+ * @brief      Macro to iterate over the interfaces of a node.
+ *
+ * @param[in]  nodeptr  Pointer to the node.
+ * @param[out] intfptr  Pointer to each interface in turn.
+ */
+#define ITERATE_NODE_INTERFACES_BEGIN(nodeptr, intfptr)                   \
+{                                                                         \
+    interface_t *_intf_end = (nodeptr)->intf + (nodeptr)->intf_count;     \
+    for (intfptr = (nodeptr)->intf; intfptr < _intf_end; intfptr++) {
+#define ITERATE_NODE_INTERFACES_ENDS }}
+
+/**
+ * @brief      Creates an empty graph.
+ *
+ * @param[in]  topology_name  Name of the topology, truncated to fit.
+ *
+ * @return     The new graph, or NULL when out of memory.
+ */
+graph_t *create_new_graph(const char *topology_name);
+
+/**
+ * @brief      Creates a node and appends it to the graph's node list.
+ *
+ * @param[in]  graph      Graph to add the node to.
+ * @param[in]  node_name  Node name, shorter than NODE_NAME_SIZE.
+ *
+ * @return     The new node, or NULL when the name is too long or taken, or
+ *             when out of memory.
+ */
+node_t *create_graph_node(graph_t *graph, const char *node_name);
+
+/**
+ * @brief      Preallocates room for more nodes and links, so that bulk loading
+ *             does not rehash the name table or grow the ifindex table as it
+ *             goes, and nodes come from a single block.
+ *
+ * @param[in]  graph   Graph to grow.
+ * @param[in]  nnodes  Nodes about to be created.
+ * @param[in]  nlinks  Links about to be inserted.
+ *
+ * @return     0 on success, -1 when out of memory.
+ */
+int graph_reserve(graph_t *graph, uint32_t nnodes, uint32_t nlinks);
+
+/**
+ * @brief      Creates one interface on each node and links them.
+ *
+ * @param[in]  node1         First node.
+ * @param[in]  node2         Second node, in the same graph.
+ * @param[in]  from_if_name  Name of the new interface on node1.
+ * @param[in]  to_if_name    Name of the new interface on node2.
+ * @param[in]  cost          Link cost.
+ *
+ * @return     0 on success, -1 when a node has no free interface slot, a name
+ *             is too long or taken, or when out of memory. Nothing is changed
+ *             on failure.
+ */
+int insert_link_between_two_nodes(node_t *node1, node_t *node2,
+                                  const char *from_if_name,
+                                  const char *to_if_name, unsigned int cost);
+
+/**
+ * @brief      Looks up a node by name in O(1).
+ *
+ * @param[in]  graph      Graph to search.
+ * @param[in]  node_name  Node name.
+ *
+ * @return     The node, or NULL.
+ */
+node_t *get_node_by_node_name(graph_t *graph, const char *node_name);
+
+/**
+ * @brief      Looks up an interface of a node by name in O(1).
+ *
+ * @param[in]  node     Node to search.
+ * @param[in]  if_name  Interface name.
+ *
+ * @return     The interface, or NULL.
+ */
+interface_t *get_node_intf_by_name(node_t *node, const char *if_name);
+
+/**
+ * @brief      Looks up an interface by ifindex in O(1).
+ *
+ * @param[in]  graph    Graph to search.
+ * @param[in]  ifindex  Interface index.
+ *
+ * @return     The interface, or NULL.
+ */
+static inline interface_t *get_intf_by_ifindex(graph_t *graph,
+                                               uint32_t ifindex)
+{
+    return ifindex < graph->ifindex_next ? graph->ifindex_tbl[ifindex] : NULL;
+}
+
+/**
+ * @brief      Returns the node at the other end of an interface's link.
+ *
+ * @param[in]  intf  Interface.
+ *
+ * @return     The neighbour node, or NULL when not linked.
+ */
+static inline node_t *get_nbr_node(interface_t *intf)
+{
+    return intf->nbr ? intf->nbr->att_node : NULL;
+}
+
+/**
+ * @brief      Returns the slot the next interface of a node will use.
+ *
+ * @param[in]  node  Node.
+ *
+ * @return     The slot, or -1 when every slot is in use.
+ */
+static inline int get_node_intf_available_slot(node_t *node)
+{
+    return node->intf_count < MAX_INTF_PER_NODE ? (int)node->intf_count : -1;
+}
+
+/**
+ * @brief      Returns the name of an interface from the cold section.
+ *
+ * @param[in]  intf  Interface.
+ */
+static inline const char *get_intf_name(const interface_t *intf)
+{
+    return intf->att_node->intf_cfg[intf - intf->att_node->intf].if_name;
+}
+
+/**
+ * @brief      Prints every node of the graph to stdout.
+ *
+ * @param[in]  graph  Graph to print.
+ */
+void dump_graph(graph_t *graph);
+
+/**
+ * @brief      Prints a node and its interfaces to stdout.
+ *
+ * @param[in]  node  Node to print.
+ */
+void dump_node(node_t *node);
+
+/**
+ * @brief      Prints an interface to stdout.
+ *
+ * @param[in]  intf  Interface to print.
+ */
+void dump_interface(interface_t *intf);
+
+/**
+ * @brief      Frees the graph with all of its nodes and links.
+ *
+ * @param[in]  graph  Graph to free, may be NULL.
+ */
+void destroy_graph(graph_t *graph);
+
+#endif    // GRAPH_H
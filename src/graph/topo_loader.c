@@ -0,0 +1,319 @@
+/******************************************************************************
+ * @file:        topo_loader.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        20/10/2026 06:00 PM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the topology file loader. The file is read
+ *               in TOPO_LOAD_BUF_SIZE chunks into one buffer and each complete
+ *               line is split into fields in place, so nothing is allocated
+ *               per line; a partial line at the end of a chunk is moved to the
+ *               front before the next read. The topology line sizes the graph
+ *               up front through graph_reserve, which hands out every node from
+ *               one block and keeps the name and ifindex tables from growing
+ *               while loading. Links find their nodes through an array indexed
+ *               by node id rather than by name.
+ *
+ *               Functions in this file:
+ *                 - load_topology
+ *                 - load_topology_file
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 20/10/2026 Marko Trickovic
+ * Initial version with a single-pass chunked parser.
+ *****************************************************************************/
+
+#ifndef TOPO_LOADER_C
+#define TOPO_LOADER_C
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include "topo_loader.h"
+
+#define TOPO_LOAD_MAX_FIELDS    6
+
+/**
+ * @brief      The structure holding the state of one load.
+ */
+typedef struct topo_loader_ {
+    graph_t *graph;
+    node_t **by_id;
+    uint32_t nnodes;
+    unsigned long line;
+    topo_load_err_t *err;
+} topo_loader_t;
+
+/**
+ * @brief      Records a failure at the current line.
+ *
+ * @return     -1
+ */
+static int topo_fail(topo_loader_t *ld, const char *msg)
+{
+    if (ld->err) {
+        ld->err->line = ld->line;
+        strncpy(ld->err->msg, msg, sizeof(ld->err->msg) - 1);
+        ld->err->msg[sizeof(ld->err->msg) - 1] = '\0';
+    }
+    return -1;
+}
+
+static inline int topo_is_blank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+/**
+ * @brief      Splits [p, end) into blank separated fields, terminating each
+ *             in place. *end must be writable.
+ *
+ * @return     Number of fields, or max + 1 when there are more than max.
+ */
+static int topo_split(char *p, char *end, char **fields, int max)
+{
+    int n = 0;
+
+    *end = '\0';
+    for (;;) {
+        while (p < end && topo_is_blank(*p))
+            p++;
+        if (p == end)
+            return n;
+        if (n == max)
+            return max + 1;
+
+        fields[n++] = p;
+        while (p < end && !topo_is_blank(*p))
+            p++;
+        *p = '\0';
+        if (p < end)
+            p++;
+    }
+}
+
+/**
+ * @brief      Parses a decimal uint32_t.
+ *
+ * @return     0 on success, -1 when s is not a number or out of range.
+ */
+static int topo_parse_u32(const char *s, uint32_t *out)
+{
+    uint64_t v = 0;
+
+    if (!*s)
+        return -1;
+    for (; *s; s++) {
+        if (*s < '0' || *s > '9')
+            return -1;
+        v = v * 10 + (uint64_t)(*s - '0');
+        if (v > UINT32_MAX)
+            return -1;
+    }
+    *out = (uint32_t)v;
+    return 0;
+}
+
+/**
+ * @brief      Resolves a node id field to a declared node.
+ */
+static node_t *topo_node(topo_loader_t *ld, const char *field)
+{
+    uint32_t id;
+
+    if (topo_parse_u32(field, &id) < 0 || id >= ld->nnodes)
+        return NULL;
+    return ld->by_id[id];
+}
+
+static int topo_line_topology(topo_loader_t *ld, char **f, int n)
+{
+    uint32_t nlinks = 0;
+
+    if (ld->graph)
+        return topo_fail(ld, "duplicate topology line");
+    if (n != 3 && n != 4)
+        return topo_fail(ld, "expected: topology <name> <nnodes> [<nlinks>]");
+    if (topo_parse_u32(f[2], &ld->nnodes) < 0 || !ld->nnodes ||
+        (n == 4 && topo_parse_u32(f[3], &nlinks) < 0))
+        return topo_fail(ld, "invalid node or link count");
+
+    ld->graph = create_new_graph(f[1]);
+    ld->by_id = calloc(ld->nnodes, sizeof(*ld->by_id));
+    if (!ld->graph || !ld->by_id ||
+        graph_reserve(ld->graph, ld->nnodes, nlinks) < 0)
+        return topo_fail(ld, "out of memory");
+
+    return 0;
+}
+
+static int topo_line_node(topo_loader_t *ld, char **f, int n)
+{
+    uint32_t id;
+
+    if (n != 3)
+        return topo_fail(ld, "expected: node <id> <name>");
+    if (topo_parse_u32(f[1], &id) < 0 || id >= ld->nnodes)
+        return topo_fail(ld, "node id out of range");
+    if (ld->by_id[id])
+        return topo_fail(ld, "duplicate node id");
+
+    ld->by_id[id] = create_graph_node(ld->graph, f[2]);
+    if (!ld->by_id[id])
+        return topo_fail(ld, "invalid or duplicate node name");
+
+    return 0;
+}
+
+static int topo_line_link(topo_loader_t *ld, char **f, int n)
+{
+    node_t *node1, *node2;
+    uint32_t cost;
+
+    if (n != 6)
+        return topo_fail(ld, "expected: link <id1> <if1> <id2> <if2> <cost>");
+
+    node1 = topo_node(ld, f[1]);
+    node2 = topo_node(ld, f[3]);
+    if (!node1 || !node2)
+        return topo_fail(ld, "link to an undeclared node");
+    if (topo_parse_u32(f[5], &cost) < 0)
+        return topo_fail(ld, "invalid link cost");
+
+    if (insert_link_between_two_nodes(node1, node2, f[2], f[4], cost) < 0)
+        return topo_fail(ld, "invalid interface name or no free interface");
+
+    return 0;
+}
+
+/**
+ * @brief      Handles the line [p, end).
+ *
+ * @return     0 on success, -1 on failure.
+ */
+static int topo_line(topo_loader_t *ld, char *p, char *end)
+{
+    char *f[TOPO_LOAD_MAX_FIELDS];
+    int n;
+
+    n = topo_split(p, end, f, TOPO_LOAD_MAX_FIELDS);
+    if (!n || f[0][0] == '#')
+        return 0;
+    if (n > TOPO_LOAD_MAX_FIELDS)
+        return topo_fail(ld, "too many fields");
+
+    // Links outnumber nodes, test them first
+    if (!strcmp(f[0], "link"))
+        return ld->graph ? topo_line_link(ld, f, n)
+                         : topo_fail(ld, "link before topology line");
+    if (!strcmp(f[0], "node"))
+        return ld->graph ? topo_line_node(ld, f, n)
+                         : topo_fail(ld, "node before topology line");
+    if (!strcmp(f[0], "topology"))
+        return topo_line_topology(ld, f, n);
+
+    return topo_fail(ld, "unknown keyword");
+}
+
+/**
+ * @brief      Builds a graph from a topology file stream in one pass.
+ *
+ * @param[in]  fp   Stream to read until EOF.
+ * @param[out] err  Filled in on failure, may be NULL.
+ *
+ * @return     The new graph, or NULL on failure.
+ */
+graph_t *load_topology(FILE *fp, topo_load_err_t *err)
+{
+    topo_loader_t ld = { .err = err };
+    char *buf, *p, *nl, *end;
+    size_t have = 0, n;
+    int rc = 0;
+
+    // One extra byte so that the last field of a full buffer can be ended
+    buf = malloc(TOPO_LOAD_BUF_SIZE + 1);
+    if (!buf) {
+        topo_fail(&ld, "out of memory");
+        return NULL;
+    }
+
+    for (;;) {
+        n = fread(buf + have, 1, TOPO_LOAD_BUF_SIZE - have, fp);
+        have += n;
+        p = buf;
+        end = buf + have;
+
+        while (!rc && (nl = memchr(p, '\n', (size_t)(end - p)))) {
+            ld.line++;
+            rc = topo_line(&ld, p, nl);
+            p = nl + 1;
+        }
+        if (rc)
+            break;
+
+        if (!n) {
+            // EOF or error: the rest is a last line without a newline
+            if (ferror(fp)) {
+                rc = topo_fail(&ld, strerror(errno));
+            } else if (p < end) {
+                ld.line++;
+                rc = topo_line(&ld, p, end);
+            }
+            break;
+        }
+
+        have = (size_t)(end - p);
+        if (have == TOPO_LOAD_BUF_SIZE) {
+            ld.line++;
+            rc = topo_fail(&ld, "line too long");
+            break;
+        }
+        memmove(buf, p, have);
+    }
+
+    if (!rc && !ld.graph) {
+        ld.line = 0;
+        rc = topo_fail(&ld, "missing topology line");
+    }
+
+    free(buf);
+    free(ld.by_id);
+    if (rc) {
+        destroy_graph(ld.graph);
+        return NULL;
+    }
+    return ld.graph;
+}
+
+/**
+ * @brief      Builds a graph from a topology file.
+ *
+ * @param[in]  path  Topology file.
+ * @param[out] err   Filled in on failure, may be NULL.
+ *
+ * @return     The new graph, or NULL on failure.
+ */
+graph_t *load_topology_file(const char *path, topo_load_err_t *err)
+{
+    graph_t *graph;
+    FILE *fp = fopen(path, "r");
+
+    if (!fp) {
+        if (err) {
+            err->line = 0;
+            strncpy(err->msg, strerror(errno), sizeof(err->msg) - 1);
+            err->msg[sizeof(err->msg) - 1] = '\0';
+        }
+        return NULL;
+    }
+
+    graph = load_topology(fp, err);
+    fclose(fp);
+    return graph;
+}
+
+#endif    // TOPO_LOADER_C
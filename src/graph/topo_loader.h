@@ -0,0 +1,82 @@
+/* -----------------------------------------------------------------------------
+ * @file:        topo_loader.h
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        20/10/2026 06:00 PM
+ * @license:     MIT
+ * @description: This header file declares the topology file loader. A topology
+ *               file is line oriented text; blank lines and lines starting
+ *               with '#' are ignored, fields are separated by blanks:
+ *
+ *                 topology <name> <nnodes> [<nlinks>]
+ *                 node <id> <name>
+ *                 link <id1> <if_name1> <id2> <if_name2> <cost>
+ *
+ *               The topology line comes first. Node ids are 0 to nnodes - 1
+ *               and only name nodes within the file; a link refers to nodes
+ *               declared above it. nlinks is a hint used to preallocate.
+ *               The contents are organized into three groups:
+ *
+ *                 1. Structs:
+ *                    - struct topo_load_err_t
+ *
+ *                 2. Functions:
+ *                    - load_topology
+ *                    - load_topology_file
+ *
+ *                 3. Macros:
+ *                    - TOPO_LOAD_BUF_SIZE
+ *
+ * @note:        This code is part of the tcpip-stack project, which is a course
+ *               on network development.
+ *
+ * Revision History:
+ *
+ * Revision 0.1: 20/10/2026 Marko Trickovic
+ * Initial version with a single-pass chunked parser.
+ */
+
+#ifndef TOPO_LOADER_H
+#define TOPO_LOADER_H
+
+#include <stdio.h>
+#include "graph.h"
+
+/** Read size of the parser, also the longest accepted line. */
+#define TOPO_LOAD_BUF_SIZE  (1 << 16)
+
+/**
+ * @brief      The structure describing why a load failed.
+ *
+ * @struct                topo_load_err_t
+ *
+ * @param[in]  line       Line number of the offending line, 1-based, or 0
+ *                        when the failure is not tied to a line.
+ * @param[in]  msg        Human readable reason.
+ */
+typedef struct topo_load_err_ {
+    unsigned long line;
+    char msg[64];
+} topo_load_err_t;
+
+/**
+ * @brief      Builds a graph from a topology file stream in one pass.
+ *
+ * @param[in]  fp   Stream to read until EOF.
+ * @param[out] err  Filled in on failure, may be NULL.
+ *
+ * @return     The new graph, or NULL on failure.
+ */
+graph_t *load_topology(FILE *fp, topo_load_err_t *err);
+
+/**
+ * @brief      Builds a graph from a topology file.
+ *
+ * @param[in]  path  Topology file.
+ * @param[out] err   Filled in on failure, may be NULL.
+ *
+ * @return     The new graph, or NULL on failure.
+ */
+graph_t *load_topology_file(const char *path, topo_load_err_t *err);
+
+#endif    // TOPO_LOADER_H
@@ -0,0 +1,453 @@
+/******************************************************************************
+ * @file:        topologies.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        20/10/2026 08:00 PM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the topology builders. Every generator
+ *               checks its parameters and the resulting node degree first,
+ *               then reserves the exact number of nodes and links so that the
+ *               graph is built from single blocks without rehashing. Nodes
+ *               are created in index order, which is also the order of the
+ *               graph's node list. Randomness comes from a splitmix64 stream
+ *               seeded by the caller, so topologies are reproducible.
+ *
+ *               Functions in this file:
+ *                 - build_first_topo
+ *                 - build_line_topo
+ *                 - build_ring_topo
+ *                 - build_full_mesh_topo
+ *                 - build_grid_topo
+ *                 - build_fat_tree_topo
+ *                 - build_random_regular_topo
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 20/10/2026 Marko Trickovic
+ * Initial version.
+ *****************************************************************************/
+
+#ifndef TOPOLOGIES_C
+#define TOPOLOGIES_C
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "topologies.h"
+
+#define TOPO_RR_ATTEMPTS    64
+#define TOPO_RR_REPAIRS     64
+
+/**
+ * @brief      The structure holding a topology under construction.
+ */
+typedef struct topo_build_ {
+    graph_t *graph;
+    node_t **nodes;
+    uint32_t nnodes;
+} topo_build_t;
+
+static inline uint64_t topo_rand(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ull);
+
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief      Creates the graph and the node index for nnodes nodes and
+ *             reserves room for nlinks links.
+ *
+ * @return     0 on success, -1 on failure with nothing left allocated.
+ */
+static int topo_begin(topo_build_t *tb, const char *name, uint64_t nnodes,
+                      uint64_t nlinks)
+{
+    tb->graph = NULL;
+    tb->nodes = NULL;
+    tb->nnodes = 0;
+
+    if (!nnodes || nnodes > UINT32_MAX || nlinks > UINT32_MAX / 2)
+        return -1;
+
+    tb->graph = create_new_graph(name);
+    tb->nodes = malloc(nnodes * sizeof(*tb->nodes));
+    if (!tb->graph || !tb->nodes ||
+        graph_reserve(tb->graph, (uint32_t)nnodes, (uint32_t)nlinks) < 0) {
+        destroy_graph(tb->graph);
+        free(tb->nodes);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief      Finishes a build, keeping the graph on success.
+ *
+ * @return     The graph, or NULL when rc is not 0.
+ */
+static graph_t *topo_end(topo_build_t *tb, int rc)
+{
+    free(tb->nodes);
+    if (rc) {
+        destroy_graph(tb->graph);
+        return NULL;
+    }
+    return tb->graph;
+}
+
+/**
+ * @brief      Creates the next node under a name made from fmt.
+ *
+ * @return     0 on success, -1 on failure.
+ */
+static int topo_node(topo_build_t *tb, const char *fmt, uint32_t a,
+                     uint32_t b, uint32_t c)
+{
+    char name[NODE_NAME_SIZE];
+    node_t *node;
+
+    snprintf(name, sizeof(name), fmt, a, b, c);
+    node = create_graph_node(tb->graph, name);
+    if (!node)
+        return -1;
+
+    tb->nodes[tb->nnodes++] = node;
+    return 0;
+}
+
+/**
+ * @brief      Creates nodes R<first>..R<first + count - 1>.
+ */
+static int topo_nodes(topo_build_t *tb, uint32_t count)
+{
+    uint32_t i;
+
+    for (i = 0; i < count; i++)
+        if (topo_node(tb, "R%u", tb->nnodes, 0, 0) < 0)
+            return -1;
+    return 0;
+}
+
+/**
+ * @brief      Writes eth<slot> into buf.
+ */
+static inline void topo_intf_name(char *buf, uint32_t slot)
+{
+    char digits[4];
+    int n = 0;
+
+    buf[0] = 'e';
+    buf[1] = 't';
+    buf[2] = 'h';
+    do {
+        digits[n++] = (char)('0' + slot % 10);
+        slot /= 10;
+    } while (slot);
+
+    buf += 3;
+    while (n)
+        *buf++ = digits[--n];
+    *buf = '\0';
+}
+
+/**
+ * @brief      Links nodes a and b of the build on their next free slots.
+ *
+ * @return     0 on success, -1 on failure.
+ */
+static int topo_link(topo_build_t *tb, uint32_t a, uint32_t b)
+{
+    char name_a[IF_NAME_SIZE], name_b[IF_NAME_SIZE];
+    node_t *na = tb->nodes[a], *nb = tb->nodes[b];
+
+    topo_intf_name(name_a, na->intf_count);
+    topo_intf_name(name_b, nb->intf_count + (na == nb));
+    return insert_link_between_two_nodes(na, nb, name_a, name_b, 1);
+}
+
+/**
+ * @brief      Tells whether a and b are distinct and not linked yet.
+ */
+static int topo_can_link(topo_build_t *tb, uint32_t a, uint32_t b)
+{
+    node_t *nb = tb->nodes[b];
+    interface_t *intf;
+
+    if (a == b)
+        return 0;
+
+    ITERATE_NODE_INTERFACES_BEGIN(tb->nodes[a], intf) {
+        if (get_nbr_node(intf) == nb)
+            return 0;
+    } ITERATE_NODE_INTERFACES_ENDS;
+
+    return 1;
+}
+
+/**
+ * @brief      Builds three routers connected in a triangle.
+ *
+ * @return     The topology, or NULL on failure.
+ */
+graph_t *build_first_topo(void)
+{
+    graph_t *topo = create_new_graph("Hello World Generic Graph");
+    node_t *R0_re, *R1_re, *R2_re;
+
+    if (!topo)
+        return NULL;
+
+    R0_re = create_graph_node(topo, "R0_re");
+    R1_re = create_graph_node(topo, "R1_re");
+    R2_re = create_graph_node(topo, "R2_re");
+
+    if (!R0_re || !R1_re || !R2_re ||
+        insert_link_between_two_nodes(R0_re, R1_re, "eth0/0", "eth0/1", 1) ||
+        insert_link_between_two_nodes(R1_re, R2_re, "eth0/2", "eth0/3", 1) ||
+        insert_link_between_two_nodes(R0_re, R2_re, "eth0/4", "eth0/5", 1)) {
+        destroy_graph(topo);
+        return NULL;
+    }
+
+    return topo;
+}
+
+/**
+ * @brief      Builds n nodes R0..Rn-1 where Ri is linked to Ri+1.
+ *
+ * @param[in]  n  Number of nodes, at least 1.
+ *
+ * @return     The topology, or NULL on failure.
+ */
+graph_t *build_line_topo(uint32_t n)
+{
+    topo_build_t tb;
+    uint32_t i;
+    int rc;
+
+    if ((n > 2 && MAX_INTF_PER_NODE < 2) ||
+        topo_begin(&tb, "line", n, n - 1) < 0)
+        return NULL;
+
+    rc = topo_nodes(&tb, n);
+    for (i = 0; !rc && i + 1 < n; i++)
+        rc = topo_link(&tb, i, i + 1);
+
+    return topo_end(&tb, rc);
+}
+
+/**
+ * @brief      Builds a line of n nodes and links the last node to the first.
+ *
+ * @param[in]  n  Number of nodes, at least 3.
+ *
+ * @return     The topology, or NULL on failure.
+ */
+graph_t *build_ring_topo(uint32_t n)
+{
+    topo_build_t tb;
+    uint32_t i;
+    int rc;
+
+    if (n < 3 || MAX_INTF_PER_NODE < 2 || topo_begin(&tb, "ring", n, n) < 0)
+        return NULL;
+
+    rc = topo_nodes(&tb, n);
+    for (i = 0; !rc && i < n; i++)
+        rc = topo_link(&tb, i, (i + 1) % n);
+
+    return topo_end(&tb, rc);
+}
+
+/**
+ * @brief      Builds n nodes with a link between every pair.
+ *
+ * @param[in]  n  Number of nodes, at least 1 and at most
+ *                MAX_INTF_PER_NODE + 1.
+ *
+ * @return     The topology, or NULL on failure.
+ */
+graph_t *build_full_mesh_topo(uint32_t n)
+{
+    topo_build_t tb;
+    uint32_t i, j;
+    int rc;
+
+    if (!n || n - 1 > MAX_INTF_PER_NODE ||
+        topo_begin(&tb, "full_mesh", n, (uint64_t)n * (n - 1) / 2) < 0)
+        return NULL;
+
+    rc = topo_nodes(&tb, n);
+    for (i = 0; !rc && i < n; i++)
+        for (j = i + 1; !rc && j < n; j++)
+            rc = topo_link(&tb, i, j);
+
+    return topo_end(&tb, rc);
+}
+
+/**
+ * @brief      Builds a rows x cols grid where node R(r * cols + c) is linked
+ *             to its right and lower neighbours.
+ *
+ * @param[in]  rows  Number of rows, at least 1.
+ * @param[in]  cols  Number of columns, at least 1.
+ *
+ * @return     The topology, or NULL on failure.
+ */
+graph_t *build_grid_topo(uint32_t rows, uint32_t cols)
+{
+    uint64_t nlinks = (uint64_t)rows * (cols - 1) + (uint64_t)cols * (rows - 1);
+    uint32_t degree = (rows > 2 ? 2 : rows - 1) + (cols > 2 ? 2 : cols - 1);
+    topo_build_t tb;
+    uint32_t r, c, i;
+    int rc;
+
+    if (!rows || !cols || degree > MAX_INTF_PER_NODE ||
+        topo_begin(&tb, "grid", (uint64_t)rows * cols, nlinks) < 0)
+        return NULL;
+
+    rc = topo_nodes(&tb, rows * cols);
+    for (r = 0; !rc && r < rows; r++) {
+        for (c = 0; !rc && c < cols; c++) {
+            i = r * cols + c;
+            if (c + 1 < cols)
+                rc = topo_link(&tb, i, i + 1);
+            if (!rc && r + 1 < rows)
+                rc = topo_link(&tb, i, i + cols);
+        }
+    }
+
+    return topo_end(&tb, rc);
+}
+
+/**
+ * @brief      Builds a k-ary fat tree.
+ *
+ * @param[in]  k  Switch radix, even, at least 2 and at most
+ *                MAX_INTF_PER_NODE.
+ *
+ * @return     The topology, or NULL on failure.
+ */
+graph_t *build_fat_tree_topo(uint32_t k)
+{
+    uint32_t h, ncore, pod, i, j, agg, edge;
+    uint64_t nnodes, nlinks;
+    topo_build_t tb;
+    int rc = 0;
+
+    if (k < 2 || k % 2 || k > MAX_INTF_PER_NODE)
+        return NULL;
+
+    h = k / 2;
+    ncore = h * h;
+    nnodes = ncore + (uint64_t)k * k + (uint64_t)k * h * h;
+    nlinks = 3ull * k * h * h;
+    if (topo_begin(&tb, "fat_tree", nnodes, nlinks) < 0)
+        return NULL;
+
+    for (i = 0; !rc && i < ncore; i++)
+        rc = topo_node(&tb, "c%u", i, 0, 0);
+
+    // Per pod: aggregation switches, then edge switches with their hosts
+    for (pod = 0; !rc && pod < k; pod++) {
+        agg = tb.nnodes;
+        for (i = 0; !rc && i < h; i++)
+            rc = topo_node(&tb, "a%u.%u", pod, i, 0);
+        for (i = 0; !rc && i < h; i++)
+            rc = topo_node(&tb, "e%u.%u", pod, i, 0);
+        for (i = 0; !rc && i < h; i++)
+            for (j = 0; !rc && j < h; j++)
+                rc = topo_node(&tb, "h%u.%u.%u", pod, i, j);
+        edge = agg + h;
+
+        for (i = 0; !rc && i < h; i++)
+            for (j = 0; !rc && j < h; j++)
+                rc = topo_link(&tb, i * h + j, agg + i);
+        for (i = 0; !rc && i < h; i++)
+            for (j = 0; !rc && j < h; j++)
+                rc = topo_link(&tb, agg + i, edge + j);
+        for (i = 0; !rc && i < h; i++)
+            for (j = 0; !rc && j < h; j++)
+                rc = topo_link(&tb, edge + i, edge + h + i * h + j);
+    }
+
+    return topo_end(&tb, rc);
+}
+
+/**
+ * @brief      Builds a random d-regular graph on n nodes.
+ *
+ * @param[in]  n     Number of nodes.
+ * @param[in]  d     Degree, below n and at most MAX_INTF_PER_NODE; n * d
+ *                   must be even.
+ * @param[in]  seed  Seed of the pseudo-random generator.
+ *
+ * @return     The topology, or NULL on failure.
+ */
+graph_t *build_random_regular_topo(uint32_t n, uint32_t d, uint64_t seed)
+{
+    uint64_t m = (uint64_t)n * d, p, q, left, state = seed;
+    uint32_t *stubs, tmp, attempt, tries;
+    topo_build_t tb;
+    int rc = -1;
+
+    if (!n || d >= n || d > MAX_INTF_PER_NODE || m % 2)
+        return NULL;
+
+    stubs = malloc((m ? m : 1) * sizeof(*stubs));
+    if (!stubs)
+        return NULL;
+
+    for (attempt = 0; rc && attempt < TOPO_RR_ATTEMPTS; attempt++) {
+        if (topo_begin(&tb, "random_regular", n, m / 2) < 0)
+            break;
+
+        rc = topo_nodes(&tb, n);
+        if (rc) {
+            topo_end(&tb, rc);
+            break;
+        }
+
+        // Node i owns d stubs; a shuffle pairs them up at random
+        for (p = 0; p < m; p++)
+            stubs[p] = (uint32_t)(p / d);
+        for (p = m; p > 1; p--) {
+            q = topo_rand(&state) % p;
+            tmp = stubs[p - 1];
+            stubs[p - 1] = stubs[q];
+            stubs[q] = tmp;
+        }
+
+        for (p = 0; !rc && p < m; p += 2) {
+            // Repair a self or parallel link by trading the second stub
+            // with one further on, which only changes pairs not made yet
+            left = m - p - 2;
+            for (tries = 0; !topo_can_link(&tb, stubs[p], stubs[p + 1]);
+                 tries++) {
+                if (!left || tries == TOPO_RR_REPAIRS) {
+                    rc = -1;
+                    break;
+                }
+                q = p + 2 + topo_rand(&state) % left;
+                tmp = stubs[p + 1];
+                stubs[p + 1] = stubs[q];
+                stubs[q] = tmp;
+            }
+            if (!rc)
+                rc = topo_link(&tb, stubs[p], stubs[p + 1]);
+        }
+
+        topo_end(&tb, rc);
+    }
+
+    free(stubs);
+    return rc ? NULL : tb.graph;
+}
+
+#endif    // TOPOLOGIES_C
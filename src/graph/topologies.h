@@ -0,0 +1,123 @@
+/* -----------------------------------------------------------------------------
+ * @file:        topologies.h
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        20/10/2026 08:00 PM
+ * @license:     MIT
+ * @description: This header file declares the topology builders: the fixed
+ *               topology of the course and generators of arbitrary size for
+ *               scale tests and benchmarks. Generated topologies are built in
+ *               memory on a reserved graph, link cost is 1 and a node's
+ *               interfaces are named eth0, eth1, ... in the order they were
+ *               created. A generator returns NULL, building nothing, when the
+ *               parameters are invalid or a node would need more than
+ *               MAX_INTF_PER_NODE interfaces. The same parameters always give
+ *               the same topology. The contents are organized into three
+ *               groups:
+ *
+ *                 1. Structs:
+ *                    - none
+ *
+ *                 2. Functions:
+ *                    - build_first_topo
+ *                    - build_line_topo
+ *                    - build_ring_topo
+ *                    - build_full_mesh_topo
+ *                    - build_grid_topo
+ *                    - build_fat_tree_topo
+ *                    - build_random_regular_topo
+ *
+ *                 3. Macros:
+ *                    - none
+ *
+ * @note:        This code is part of the tcpip-stack project, which is a course
+ *               on network development.
+ *
+ * Revision History:
+ *
+ * Revision 0.1: 20/10/2026 Marko Trickovic
+ * Initial version.
+ */
+
+#ifndef TOPOLOGIES_H
+#define TOPOLOGIES_H
+
+#include <stdint.h>
+#include "graph.h"
+
+/**
+ * @brief      Builds three routers connected in a triangle.
+ *
+ * @return     The topology, or NULL on failure.
+ */
+graph_t *build_first_topo(void);
+
+/**
+ * @brief      Builds n nodes R0..Rn-1 where Ri is linked to Ri+1.
+ *
+ * @param[in]  n  Number of nodes, at least 1.
+ *
+ * @return     The topology, or NULL on failure.
+ */
+graph_t *build_line_topo(uint32_t n);
+
+/**
+ * @brief      Builds a line of n nodes and links the last node to the first.
+ *
+ * @param[in]  n  Number of nodes, at least 3.
+ *
+ * @return     The topology, or NULL on failure.
+ */
+graph_t *build_ring_topo(uint32_t n);
+
+/**
+ * @brief      Builds n nodes with a link between every pair.
+ *
+ * @param[in]  n  Number of nodes, at least 1 and at most
+ *                MAX_INTF_PER_NODE + 1.
+ *
+ * @return     The topology, or NULL on failure.
+ */
+graph_t *build_full_mesh_topo(uint32_t n);
+
+/**
+ * @brief      Builds a rows x cols grid where node R(r * cols + c) is linked
+ *             to its right and lower neighbours.
+ *
+ * @param[in]  rows  Number of rows, at least 1.
+ * @param[in]  cols  Number of columns, at least 1.
+ *
+ * @return     The topology, or NULL on failure.
+ */
+graph_t *build_grid_topo(uint32_t rows, uint32_t cols);
+
+/**
+ * @brief      Builds a k-ary fat tree: (k/2)^2 core switches c<i>, k pods of
+ *             k/2 aggregation switches a<pod>.<i> and k/2 edge switches
+ *             e<pod>.<i>, and k/2 hosts h<pod>.<edge>.<i> on each edge
+ *             switch. Aggregation switch i of every pod is linked to core
+ *             switches i*k/2 .. i*k/2 + k/2 - 1, and every aggregation switch
+ *             to every edge switch of its pod.
+ *
+ * @param[in]  k  Switch radix, even, at least 2 and at most
+ *                MAX_INTF_PER_NODE.
+ *
+ * @return     The topology, or NULL on failure.
+ */
+graph_t *build_fat_tree_topo(uint32_t k);
+
+/**
+ * @brief      Builds a random d-regular graph on n nodes without self links
+ *             or parallel links, by random pairing of interface stubs with
+ *             local repair.
+ *
+ * @param[in]  n     Number of nodes.
+ * @param[in]  d     Degree, below n and at most MAX_INTF_PER_NODE; n * d
+ *                   must be even.
+ * @param[in]  seed  Seed of the pseudo-random generator.
+ *
+ * @return     The topology, or NULL on failure.
+ */
+graph_t *build_random_regular_topo(uint32_t n, uint32_t d, uint64_t seed);
+
+#endif    // TOPOLOGIES_H
@@ -0,0 +1,440 @@
+/******************************************************************************
+ * @file:        l2_switch.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        22/10/2026 07:00 AM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the forwarding path of the learning
+ *               switch. Flooding walks the set bits of the VLAN's flood
+ *               bitmap a word at a time, so its cost follows the ports that
+ *               get the frame and not the ports of the switch. Each clone is
+ *               made for the port before the current one, which leaves the
+ *               frame itself for the last port without counting the bits
+ *               first. Frames are retagged only when the port they leave
+ *               by wants the other form; a flood that needs both forms
+ *               copies the frame once, for the group wanting the other
+ *               form, never once per port.
+ *
+ *               Functions in this file:
+ *                 - l2_switch_create
+ *                 - l2_switch_destroy
+ *                 - l2_switch_port_set
+ *                 - l2_switch_port_mode
+ *                 - l2_switch_vlan_add
+ *                 - l2_switch_vlan_del
+ *                 - l2_switch_input
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 22/10/2026 Marko Trickovic
+ * Initial version.
+ *
+ * Revision 0.2: 22/10/2026 Marko Trickovic
+ * Frames are tagged and untagged in place for access and trunk ports.
+ *****************************************************************************/
+
+#ifndef L2_SWITCH_C
+#define L2_SWITCH_C
+
+#include <errno.h>
+#include <stdlib.h>
+#include "l2_switch.h"
+#include "../net/ethernet.h"
+
+#define L2_SWITCH_NO_PORT   UINT32_MAX
+
+// Recomputes the flood and tagged bitmaps of a VLAN from its members and
+// their ports
+static void l2_switch_refresh(l2_switch_t *sw, uint16_t vlan)
+{
+    const uint64_t *members = sw->members + (size_t)vlan * sw->words;
+    uint64_t *flood = sw->flood + (size_t)vlan * sw->words;
+    uint64_t *tagged = sw->tagged + (size_t)vlan * sw->words;
+    l2_port_t *port;
+    uint32_t w, p;
+    uint64_t bits;
+
+    for (w = 0; w < sw->words; w++) {
+        flood[w] = 0;
+        tagged[w] = 0;
+        for (bits = members[w]; bits; bits &= bits - 1) {
+            p = w * 64 + (uint32_t)__builtin_ctzll(bits);
+            port = &sw->ports[p];
+            if (!port->up)
+                continue;
+            flood[w] |= 1ull << (p % 64);
+            if (port->mode == L2_PORT_TRUNK && port->pvid != vlan)
+                tagged[w] |= 1ull << (p % 64);
+        }
+    }
+}
+
+// Recomputes the bitmaps of every VLAN a port is a member of
+static void l2_switch_refresh_port(l2_switch_t *sw, uint32_t port)
+{
+    uint32_t v;
+
+    for (v = 1; v < L2_SWITCH_VLANS; v++) {
+        if (l2_switch_is_member(sw, (uint16_t)v, port))
+            l2_switch_refresh(sw, (uint16_t)v);
+    }
+}
+
+// Inserts or strips the tag of a frame so that it is tagged when want is
+static inline int l2_switch_retag(l2_switch_t *sw, pkt_buf_t *pkt,
+                                  uint16_t vlan, int tagged, int want)
+{
+    if (tagged == want)
+        return 0;
+
+    if (want) {
+        if (!ethernet_vlan_push(pkt, vlan))
+            return -1;
+        sw->pushes++;
+    } else {
+        if (ethernet_vlan_pop(pkt) < 0)
+            return -1;
+        sw->pops++;
+    }
+    return 0;
+}
+
+static inline void l2_switch_tx(l2_switch_t *sw, uint32_t in, uint16_t vlan,
+                                uint32_t out, pkt_buf_t *pkt)
+{
+    pkt->vlan = vlan;
+    pkt->rx_ifindex = in;
+    pkt->tx_ifindex = out;
+    if (pkt_queue_push(&sw->ports[out].txq, pkt) < 0) {
+        pkt_buf_free(pkt);
+        sw->drops++;
+    }
+}
+
+// Sends a frame out of every port of the flood bitmap of its VLAN but the
+// one it came in by that sends the VLAN tagged, or untagged
+static void l2_switch_replicate(l2_switch_t *sw, uint16_t vlan, uint32_t in,
+                                int tagged, pkt_buf_t *pkt)
+{
+    const uint64_t *flood = l2_switch_flood_map(sw, vlan);
+    const uint64_t *tmap = l2_switch_tagged_map(sw, vlan);
+    uint32_t prev = L2_SWITCH_NO_PORT, w;
+    pkt_buf_t *clone;
+    uint64_t bits;
+
+    for (w = 0; w < sw->words; w++) {
+        bits = flood[w] & (tagged ? tmap[w] : ~tmap[w]);
+        if (w == in / 64)
+            bits &= ~(1ull << (in % 64));
+        for (; bits; bits &= bits - 1) {
+            if (prev != L2_SWITCH_NO_PORT) {
+                clone = pkt_buf_clone(pkt);
+                if (clone) {
+                    sw->clones++;
+                    l2_switch_tx(sw, in, vlan, prev, clone);
+                } else {
+                    sw->drops++;
+                }
+            }
+            prev = w * 64 + (uint32_t)__builtin_ctzll(bits);
+        }
+    }
+
+    if (prev == L2_SWITCH_NO_PORT)
+        pkt_buf_free(pkt);
+    else
+        l2_switch_tx(sw, in, vlan, prev, pkt);
+}
+
+// Floods a frame, tagged or not as it came in, to the ports sending its
+// form as it is and to the others retagged
+static void l2_switch_flood(l2_switch_t *sw, uint16_t vlan, uint32_t in,
+                            int tagged, pkt_buf_t *pkt)
+{
+    const uint64_t *flood = l2_switch_flood_map(sw, vlan);
+    const uint64_t *tmap = l2_switch_tagged_map(sw, vlan);
+    uint64_t as_tagged = 0, as_untagged = 0, bits;
+    int same, other;
+    pkt_buf_t *v;
+    uint32_t w;
+
+    for (w = 0; w < sw->words; w++) {
+        bits = flood[w];
+        if (w == in / 64)
+            bits &= ~(1ull << (in % 64));
+        as_tagged |= bits & tmap[w];
+        as_untagged |= bits & ~tmap[w];
+    }
+    same = tagged ? !!as_tagged : !!as_untagged;
+    other = tagged ? !!as_untagged : !!as_tagged;
+
+    if (!same && !other) {
+        pkt_buf_free(pkt);
+        return;
+    }
+    sw->floods++;
+
+    if (other) {
+        // The other form needs its own bytes only when this one is sent too
+        v = same ? pkt_buf_copy(pkt) : pkt;
+        if (v && l2_switch_retag(sw, v, vlan, tagged, !tagged) == 0) {
+            l2_switch_replicate(sw, vlan, in, !tagged, v);
+        } else {
+            if (v)
+                pkt_buf_free(v);
+            sw->drops++;
+        }
+        if (!same)
+            return;
+    }
+    l2_switch_replicate(sw, vlan, in, tagged, pkt);
+}
+
+/**
+ * @brief      Creates a switch.
+ *
+ * @param[in]  nports     Ports.
+ * @param[in]  max_macs   Addresses the MAC table can hold.
+ * @param[in]  txq_limit  Frames queued per port.
+ *
+ * @return     The switch, or NULL with errno set.
+ */
+l2_switch_t *l2_switch_create(uint32_t nports, uint32_t max_macs,
+                              uint32_t txq_limit)
+{
+    l2_switch_t *sw;
+    uint32_t i;
+
+    if (!nports || nports > L2_SWITCH_MAX_PORTS) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!txq_limit)
+        txq_limit = L2_SWITCH_TXQ_LIMIT;
+
+    sw = calloc(1, sizeof(*sw));
+    if (!sw) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    sw->nports = nports;
+    sw->words = (nports + 63) / 64;
+    sw->macs = mac_table_create(max_macs, 0);
+    sw->members = calloc((size_t)L2_SWITCH_VLANS * sw->words,
+                         sizeof(uint64_t));
+    sw->flood = calloc((size_t)L2_SWITCH_VLANS * sw->words,
+                       sizeof(uint64_t));
+    sw->tagged = calloc((size_t)L2_SWITCH_VLANS * sw->words,
+                        sizeof(uint64_t));
+    sw->ports = calloc(nports, sizeof(l2_port_t));
+    if (!sw->macs || !sw->members || !sw->flood || !sw->tagged ||
+        !sw->ports) {
+        l2_switch_destroy(sw);
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    for (i = 0; i < nports; i++)
+        pkt_queue_init(&sw->ports[i].txq, txq_limit);
+    return sw;
+}
+
+/**
+ * @brief      Frees the switch and its queued frames.
+ *
+ * @param[in]  sw  Switch, may be NULL.
+ */
+void l2_switch_destroy(l2_switch_t *sw)
+{
+    uint32_t i;
+
+    if (!sw)
+        return;
+
+    if (sw->ports) {
+        for (i = 0; i < sw->nports; i++)
+            pkt_queue_flush(&sw->ports[i].txq);
+    }
+    free(sw->ports);
+    free(sw->tagged);
+    free(sw->flood);
+    free(sw->members);
+    mac_table_destroy(sw->macs);
+    free(sw);
+}
+
+/**
+ * @brief      Brings a port up or down and sets its VLAN.
+ *
+ * @param[in]  sw    Switch.
+ * @param[in]  port  Port.
+ * @param[in]  up    1 for up, 0 for down.
+ * @param[in]  pvid  VLAN of untagged frames.
+ *
+ * @return     0, or -1 with errno EINVAL.
+ */
+int l2_switch_port_set(l2_switch_t *sw, uint32_t port, int up, uint16_t pvid)
+{
+    l2_port_t *p;
+
+    if (port >= sw->nports || pvid >= L2_SWITCH_VLANS) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    p = &sw->ports[port];
+    if (p->up == !!up && p->pvid == pvid)
+        return 0;
+
+    p->up = (uint8_t)!!up;
+    p->pvid = pvid;
+    l2_switch_refresh_port(sw, port);
+    return 0;
+}
+
+/**
+ * @brief      Makes a port an access or a trunk port.
+ *
+ * @param[in]  sw    Switch.
+ * @param[in]  port  Port.
+ * @param[in]  mode  L2_PORT_ACCESS or L2_PORT_TRUNK.
+ *
+ * @return     0, or -1 with errno EINVAL.
+ */
+int l2_switch_port_mode(l2_switch_t *sw, uint32_t port, uint8_t mode)
+{
+    if (port >= sw->nports ||
+        (mode != L2_PORT_ACCESS && mode != L2_PORT_TRUNK)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (sw->ports[port].mode == mode)
+        return 0;
+
+    sw->ports[port].mode = mode;
+    l2_switch_refresh_port(sw, port);
+    return 0;
+}
+
+/**
+ * @brief      Makes a port a member of a VLAN.
+ *
+ * @param[in]  sw    Switch.
+ * @param[in]  vlan  VLAN.
+ * @param[in]  port  Port.
+ *
+ * @return     0, or -1 with errno EINVAL.
+ */
+int l2_switch_vlan_add(l2_switch_t *sw, uint16_t vlan, uint32_t port)
+{
+    if (!vlan || vlan >= L2_SWITCH_VLANS || port >= sw->nports) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    sw->members[(size_t)vlan * sw->words + port / 64] |= 1ull << (port % 64);
+    l2_switch_refresh(sw, vlan);
+    return 0;
+}
+
+/**
+ * @brief      Removes a port from a VLAN.
+ *
+ * @param[in]  sw    Switch.
+ * @param[in]  vlan  VLAN.
+ * @param[in]  port  Port.
+ *
+ * @return     0, or -1 with errno EINVAL.
+ */
+int l2_switch_vlan_del(l2_switch_t *sw, uint16_t vlan, uint32_t port)
+{
+    if (!vlan || vlan >= L2_SWITCH_VLANS || port >= sw->nports) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    sw->members[(size_t)vlan * sw->words + port / 64] &= ~(1ull << (port % 64));
+    l2_switch_refresh(sw, vlan);
+    return 0;
+}
+
+/**
+ * @brief      Forwards frames received on a port.
+ *
+ * @param[in]  sw    Switch.
+ * @param[in]  port  Port the frames came in by.
+ * @param[in]  pkts  Frames.
+ * @param[in]  n     Frames in pkts.
+ */
+void l2_switch_input(l2_switch_t *sw, uint32_t port, pkt_buf_t **pkts,
+                     uint32_t n)
+{
+    ethernet_frame_t frame;
+    pkt_buf_t *pkt;
+    uint32_t i, out;
+    uint16_t vlan;
+    int tagged;
+
+    for (i = 0; i < n; i++) {
+        pkt = pkts[i];
+        if (port >= sw->nports || !sw->ports[port].up ||
+            ethernet_parse(pkt, &frame) < 0)
+            goto drop;
+
+        tagged = frame.vlan != NULL;
+        if (tagged && frame.vid) {
+            if (sw->ports[port].mode != L2_PORT_TRUNK)
+                goto drop;
+            vlan = frame.vid;
+        } else {
+            vlan = sw->ports[port].pvid;
+        }
+        if (!vlan || !l2_switch_is_member(sw, vlan, port))
+            goto drop;
+
+        // A priority tag names no VLAN; the frame goes on as untagged
+        if (tagged && !frame.vid) {
+            if (ethernet_vlan_pop(pkt) < 0)
+                goto drop;
+            sw->pops++;
+            tagged = 0;
+            frame.eth = (ethernet_hdr_t *)pkt->data;
+        }
+
+        // A full table only means the replies are flooded
+        if (!ethernet_is_mcast(frame.eth->src))
+            mac_table_learn(sw->macs, vlan, frame.eth->src, port);
+
+        out = ethernet_is_mcast(frame.eth->dst) ? MAC_TABLE_MISS :
+              mac_table_lookup(sw->macs, vlan, frame.eth->dst);
+        if (out == MAC_TABLE_MISS) {
+            l2_switch_flood(sw, vlan, port, tagged, pkt);
+            continue;
+        }
+        if (out == port) {
+            pkt_buf_free(pkt);
+            sw->filtered++;
+            continue;
+        }
+        // Learnt on a port since gone down or out of the VLAN
+        if (!((l2_switch_flood_map(sw, vlan)[out / 64] >> (out % 64)) & 1))
+            goto drop;
+        if (l2_switch_retag(sw, pkt, vlan, tagged,
+                            (l2_switch_tagged_map(sw, vlan)[out / 64] >>
+                             (out % 64)) & 1) < 0)
+            goto drop;
+        sw->unicasts++;
+        l2_switch_tx(sw, port, vlan, out, pkt);
+        continue;
+
+drop:
+        pkt_buf_free(pkt);
+        sw->drops++;
+    }
+}
+
+#endif    // L2_SWITCH_C
@@ -0,0 +1,279 @@
+/* -----------------------------------------------------------------------------
+ * @file:        l2_switch.h
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        22/10/2026 07:00 AM
+ * @license:     MIT
+ * @description: This header file declares the forwarding path of a learning
+ *               switch. Ports are numbered from 0, usually after the
+ *               interfaces of a node. Every VLAN has a bitmap of its member
+ *               ports and a flood bitmap of the members that are up; the
+ *               flood bitmap is recomputed only when a membership or a port
+ *               changes, never per frame. A frame's source is learnt into
+ *               a mac_table_t; a known unicast destination sends it out of
+ *               one port, anything else is flooded to every port set in the
+ *               flood bitmap of its VLAN but the one it came in by. Flooded
+ *               copies are clones sharing the frame's data block, the last
+ *               port getting the frame itself, so replicating a frame costs
+ *               one descriptor per port and no byte is copied. Frames leave
+ *               by the transmit queue of their port, for the caller to take.
+ *               Access ports take untagged frames into their pvid; trunk
+ *               ports also take frames tagged with any VLAN they are in and
+ *               send every VLAN but their pvid tagged. Which members send a
+ *               VLAN tagged is kept in a second bitmap next to the flood
+ *               bitmap, so a frame is tagged or untagged on its way out
+ *               with one bit test, in place by ethernet_vlan_push or
+ *               ethernet_vlan_pop. A flooded frame is retagged once for the
+ *               members that need the other form, then cloned within each
+ *               group.
+ *               The contents are organized into three groups:
+ *
+ *                 1. Structs:
+ *                    - struct l2_port_t
+ *                    - struct l2_switch_t
+ *
+ *                 2. Functions:
+ *                    - l2_switch_create
+ *                    - l2_switch_destroy
+ *                    - l2_switch_port_set
+ *                    - l2_switch_port_mode
+ *                    - l2_switch_vlan_add
+ *                    - l2_switch_vlan_del
+ *                    - l2_switch_input
+ *                    - l2_switch_is_member
+ *                    - l2_switch_flood_map
+ *                    - l2_switch_tagged_map
+ *
+ *                 3. Macros:
+ *                    - L2_SWITCH_MAX_PORTS
+ *                    - L2_SWITCH_VLANS
+ *                    - L2_SWITCH_TXQ_LIMIT
+ *                    - L2_PORT_ACCESS
+ *                    - L2_PORT_TRUNK
+ *
+ * @note:        This code is part of the tcpip-stack project, which is a course
+ *               on network development.
+ *
+ * Revision History:
+ *
+ * Revision 0.1: 22/10/2026 Marko Trickovic
+ * Initial version.
+ *
+ * Revision 0.2: 22/10/2026 Marko Trickovic
+ * Added access and trunk ports with in-place 802.1Q tagging.
+ */
+
+#ifndef L2_SWITCH_H
+#define L2_SWITCH_H
+
+#include <stdint.h>
+#include "mac_table.h"
+#include "../pkt/pkt_queue.h"
+
+/** Most ports of a switch. */
+#define L2_SWITCH_MAX_PORTS     256
+
+/** VLAN identifiers, 1 to L2_SWITCH_VLANS - 1 being usable. */
+#define L2_SWITCH_VLANS         4096
+
+/** Frames queued for transmission per port when none is given. */
+#define L2_SWITCH_TXQ_LIMIT     1024
+
+/** Port taking and sending untagged frames only. */
+#define L2_PORT_ACCESS          0
+
+/** Port taking tagged frames and sending all but its pvid tagged. */
+#define L2_PORT_TRUNK           1
+
+/**
+ * @brief      The structure representing a port.
+ *
+ * @struct                l2_port_t
+ *
+ * @param[in]  up         1 while the port forwards.
+ * @param[in]  mode       L2_PORT_ACCESS or L2_PORT_TRUNK.
+ * @param[in]  pvid       VLAN of untagged frames coming in, 0 to drop them.
+ *                        A trunk sends it untagged.
+ * @param[in]  txq        Frames to send, for the caller to take.
+ */
+typedef struct l2_port_ {
+    uint8_t up;
+    uint8_t mode;
+    uint16_t pvid;
+    pkt_queue_t txq;
+} l2_port_t;
+
+/**
+ * @brief      The structure representing a switch.
+ *
+ * @struct                l2_switch_t
+ *
+ * @param[in]  macs       Learnt addresses.
+ * @param[in]  nports     Ports.
+ * @param[in]  words      64-bit words in a port bitmap.
+ * @param[in]  members    Member ports of VLAN v at members + v * words.
+ * @param[in]  flood      Member ports of VLAN v that are up, laid out the
+ *                        same way.
+ * @param[in]  tagged     Ports of flood that send VLAN v tagged, laid out
+ *                        the same way.
+ * @param[in]  ports      Ports.
+ * @param[in]  unicasts   Frames sent out of the one port of their address.
+ * @param[in]  floods     Frames flooded.
+ * @param[in]  clones     Clones made for flooding.
+ * @param[in]  pushes     Tags inserted on the way out.
+ * @param[in]  pops       Tags stripped, on the way out or from priority
+ *                        tagged frames coming in.
+ * @param[in]  filtered   Frames for an address behind the port they came
+ *                        in by, not sent.
+ * @param[in]  drops      Frames dropped: malformed, from a port that is down
+ *                        or not in their VLAN, tagged on an access port,
+ *                        short of headroom for a tag or refused by a full
+ *                        queue.
+ */
+typedef struct l2_switch_ {
+    mac_table_t *macs;
+    uint32_t nports;
+    uint32_t words;
+    uint64_t *members;
+    uint64_t *flood;
+    uint64_t *tagged;
+    l2_port_t *ports;
+    uint64_t unicasts;
+    uint64_t floods;
+    uint64_t clones;
+    uint64_t pushes;
+    uint64_t pops;
+    uint64_t filtered;
+    uint64_t drops;
+} l2_switch_t;
+
+/**
+ * @brief      Creates a switch with every port down, an access port and in
+ *             no VLAN.
+ *
+ * @param[in]  nports     Ports, 1 to L2_SWITCH_MAX_PORTS.
+ * @param[in]  max_macs   Addresses the MAC table can hold.
+ * @param[in]  txq_limit  Frames queued per port, 0 for L2_SWITCH_TXQ_LIMIT.
+ *
+ * @return     The switch, or NULL with errno EINVAL for a bad port count or
+ *             ENOMEM.
+ */
+l2_switch_t *l2_switch_create(uint32_t nports, uint32_t max_macs,
+                              uint32_t txq_limit);
+
+/**
+ * @brief      Frees the switch and the frames still queued on its ports.
+ *
+ * @param[in]  sw  Switch, may be NULL.
+ */
+void l2_switch_destroy(l2_switch_t *sw);
+
+/**
+ * @brief      Brings a port up or down and sets the VLAN of the untagged
+ *             frames it receives. Recomputes the bitmaps of the VLANs the
+ *             port is a member of.
+ *
+ * @param[in]  sw    Switch.
+ * @param[in]  port  Port.
+ * @param[in]  up    1 for up, 0 for down.
+ * @param[in]  pvid  VLAN of untagged frames, 0 to drop them.
+ *
+ * @return     0, or -1 with errno EINVAL.
+ */
+int l2_switch_port_set(l2_switch_t *sw, uint32_t port, int up, uint16_t pvid);
+
+/**
+ * @brief      Makes a port an access or a trunk port. Recomputes the
+ *             bitmaps of the VLANs the port is a member of.
+ *
+ * @param[in]  sw    Switch.
+ * @param[in]  port  Port.
+ * @param[in]  mode  L2_PORT_ACCESS or L2_PORT_TRUNK.
+ *
+ * @return     0, or -1 with errno EINVAL.
+ */
+int l2_switch_port_mode(l2_switch_t *sw, uint32_t port, uint8_t mode);
+
+/**
+ * @brief      Makes a port a member of a VLAN and recomputes the VLAN's
+ *             flood bitmap.
+ *
+ * @param[in]  sw    Switch.
+ * @param[in]  vlan  VLAN, 1 to L2_SWITCH_VLANS - 1.
+ * @param[in]  port  Port.
+ *
+ * @return     0, or -1 with errno EINVAL.
+ */
+int l2_switch_vlan_add(l2_switch_t *sw, uint16_t vlan, uint32_t port);
+
+/**
+ * @brief      Removes a port from a VLAN and recomputes the VLAN's flood
+ *             bitmap.
+ *
+ * @param[in]  sw    Switch.
+ * @param[in]  vlan  VLAN.
+ * @param[in]  port  Port.
+ *
+ * @return     0, or -1 with errno EINVAL.
+ */
+int l2_switch_vlan_del(l2_switch_t *sw, uint16_t vlan, uint32_t port);
+
+/**
+ * @brief      Forwards frames received on a port. Frames keep their
+ *             headers but for the tag, inserted or stripped as the port
+ *             they leave by needs; vlan is set to the VLAN each was
+ *             forwarded in and rx_ifindex and tx_ifindex to the ports.
+ *
+ * @param[in]  sw    Switch.
+ * @param[in]  port  Port the frames came in by.
+ * @param[in]  pkts  Frames, data on the Ethernet header, not on any
+ *                   glthread. They belong to the switch afterwards.
+ * @param[in]  n     Frames in pkts.
+ */
+void l2_switch_input(l2_switch_t *sw, uint32_t port, pkt_buf_t **pkts,
+                     uint32_t n);
+
+/**
+ * @brief      Tells whether a port is a member of a VLAN.
+ *
+ * @param[in]  sw    Switch.
+ * @param[in]  vlan  VLAN, below L2_SWITCH_VLANS.
+ * @param[in]  port  Port, below nports.
+ *
+ * @return     1 for a member, 0 otherwise.
+ */
+static inline int l2_switch_is_member(const l2_switch_t *sw, uint16_t vlan,
+                                      uint32_t port)
+{
+    return (sw->members[vlan * sw->words + port / 64] >> (port % 64)) & 1;
+}
+
+/**
+ * @brief      Returns the flood bitmap of a VLAN.
+ *
+ * @param[in]  sw    Switch.
+ * @param[in]  vlan  VLAN, below L2_SWITCH_VLANS.
+ *
+ * @return     sw->words words, bit p % 64 of word p / 64 set for port p.
+ */
+static inline const uint64_t *l2_switch_flood_map(const l2_switch_t *sw,
+                                                  uint16_t vlan)
+{
+    return sw->flood + (size_t)vlan * sw->words;
+}
+
+/**
+ * @brief      Returns the bitmap of the ports sending a VLAN tagged.
+ *
+ * @param[in]  sw    Switch.
+ * @param[in]  vlan  VLAN, below L2_SWITCH_VLANS.
+ *
+ * @return     sw->words words, a subset of l2_switch_flood_map.
+ */
+static inline const uint64_t *l2_switch_tagged_map(const l2_switch_t *sw,
+                                                   uint16_t vlan)
+{
+    return sw->tagged + (size_t)vlan * sw->words;
+}
+
+#endif    // L2_SWITCH_H
@@ -0,0 +1,289 @@
+/******************************************************************************
+ * @file:        mac_table.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        22/10/2026 05:00 AM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the MAC learning table. Keys are hashed
+ *               with a Fibonacci multiply and the top bits picked, which
+ *               spreads addresses of one vendor prefix as well as anything
+ *               slower would. The index is kept at most half full so that
+ *               probe sequences stay short. An entry on the list of the
+ *               current tick is not moved again, so a busy address costs a
+ *               single compare to refresh.
+ *
+ *               Functions in this file:
+ *                 - mac_table_create
+ *                 - mac_table_destroy
+ *                 - mac_table_learn
+ *                 - mac_table_lookup
+ *                 - mac_table_delete
+ *                 - mac_table_advance
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 22/10/2026 Marko Trickovic
+ * Initial version.
+ *****************************************************************************/
+
+#ifndef MAC_TABLE_C
+#define MAC_TABLE_C
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mac_table.h"
+
+#define MAC_TABLE_EMPTY     UINT64_MAX
+
+static inline uint64_t mac_table_home(const mac_table_t *tbl, uint64_t key)
+{
+    return (key * 0x9e3779b97f4a7c15ull) >> tbl->shift;
+}
+
+// Returns the slot holding key, or mask + 1 when there is none
+static inline uint64_t mac_table_find(const mac_table_t *tbl, uint64_t key)
+{
+    uint64_t i = mac_table_home(tbl, key);
+
+    for (;; i = (i + 1) & tbl->mask) {
+        if (tbl->slots[i].key == key)
+            return i;
+        if (tbl->slots[i].key == MAC_TABLE_EMPTY)
+            return tbl->mask + 1;
+    }
+}
+
+// Empties slot i, moving back every later slot of the probe run that would
+// no longer be found past the hole
+static void mac_table_unlink(mac_table_t *tbl, uint64_t i)
+{
+    mac_slot_t *slots = tbl->slots;
+    uint64_t j = i, home;
+
+    for (;;) {
+        j = (j + 1) & tbl->mask;
+        if (slots[j].key == MAC_TABLE_EMPTY)
+            break;
+        home = mac_table_home(tbl, slots[j].key);
+        // Stays when its home lies cyclically in (i, j]
+        if (((j - home) & tbl->mask) < ((j - i) & tbl->mask))
+            continue;
+        slots[i] = slots[j];
+        i = j;
+    }
+    slots[i].key = MAC_TABLE_EMPTY;
+}
+
+static inline void mac_table_release(mac_table_t *tbl, mac_entry_t *e)
+{
+    glthread_add(&tbl->free, &e->glue);
+    tbl->count--;
+}
+
+/**
+ * @brief      Creates an empty table.
+ *
+ * @param[in]  max_entries  Addresses the table can hold.
+ * @param[in]  age_ticks    Aging time in ticks, 0 for the default.
+ *
+ * @return     The table, or NULL.
+ */
+mac_table_t *mac_table_create(uint32_t max_entries, uint32_t age_ticks)
+{
+    mac_table_t *tbl;
+    uint64_t nslots = 2, bits = 1;
+    uint32_t i;
+
+    if (!max_entries)
+        return NULL;
+    if (!age_ticks)
+        age_ticks = MAC_TABLE_AGE_TICKS;
+    while (nslots < 2ull * max_entries) {
+        nslots <<= 1;
+        bits++;
+    }
+
+    tbl = calloc(1, sizeof(*tbl));
+    if (!tbl)
+        return NULL;
+    tbl->slots = malloc(nslots * sizeof(mac_slot_t));
+    tbl->entries = malloc((size_t)max_entries * sizeof(mac_entry_t));
+    tbl->wheel = calloc(age_ticks, sizeof(glthread_t));
+    if (!tbl->slots || !tbl->entries || !tbl->wheel) {
+        mac_table_destroy(tbl);
+        return NULL;
+    }
+
+    memset(tbl->slots, 0xff, nslots * sizeof(mac_slot_t));
+    tbl->mask = nslots - 1;
+    tbl->shift = (uint32_t)(64 - bits);
+    tbl->max_entries = max_entries;
+    tbl->age_ticks = age_ticks;
+
+    init_glthread(&tbl->free, offsetof(mac_entry_t, glue));
+    for (i = 0; i < age_ticks; i++)
+        init_glthread(&tbl->wheel[i], offsetof(mac_entry_t, glue));
+    // Pushed last to first so that entries are handed out in array order
+    for (i = max_entries; i-- > 0;)
+        glthread_add(&tbl->free, &tbl->entries[i].glue);
+    return tbl;
+}
+
+/**
+ * @brief      Frees the table.
+ *
+ * @param[in]  tbl  Table, may be NULL.
+ */
+void mac_table_destroy(mac_table_t *tbl)
+{
+    if (!tbl)
+        return;
+
+    free(tbl->wheel);
+    free(tbl->entries);
+    free(tbl->slots);
+    free(tbl);
+}
+
+/**
+ * @brief      Learns that an address is behind a port.
+ *
+ * @param[in]  tbl      Table.
+ * @param[in]  vlan     VLAN identifier.
+ * @param[in]  mac      Address.
+ * @param[in]  ifindex  Port.
+ *
+ * @return     0, or -1 with errno set.
+ */
+int mac_table_learn(mac_table_t *tbl, uint16_t vlan, const uint8_t *mac,
+                    uint32_t ifindex)
+{
+    uint64_t key = mac_table_key(vlan, mac), i;
+    glthread_node_t *node;
+    mac_entry_t *e;
+    mac_slot_t *s;
+
+    for (i = mac_table_home(tbl, key);; i = (i + 1) & tbl->mask) {
+        s = &tbl->slots[i];
+        if (s->key == MAC_TABLE_EMPTY)
+            break;
+        if (s->key != key)
+            continue;
+
+        if (s->ifindex != ifindex) {
+            s->ifindex = ifindex;
+            tbl->moves++;
+        }
+        e = &tbl->entries[s->entry];
+        if (e->tick != tbl->now) {
+            glthread_remove(&tbl->wheel[e->tick % tbl->age_ticks], &e->glue);
+            glthread_add(&tbl->wheel[tbl->now % tbl->age_ticks], &e->glue);
+            e->tick = tbl->now;
+        }
+        return 0;
+    }
+
+    node = tbl->free.head;
+    if (!node) {
+        errno = ENOSPC;
+        return -1;
+    }
+    glthread_remove(&tbl->free, node);
+    e = (mac_entry_t *)GLTHREAD_GET_USER_DATA_FROM_OFFSET(node,
+                                                          tbl->free.offset);
+    e->key = key;
+    e->tick = tbl->now;
+    glthread_add(&tbl->wheel[tbl->now % tbl->age_ticks], &e->glue);
+
+    s->key = key;
+    s->entry = (uint32_t)(e - tbl->entries);
+    s->ifindex = ifindex;
+    tbl->count++;
+    tbl->learns++;
+    return 0;
+}
+
+/**
+ * @brief      Finds the port of an address.
+ *
+ * @param[in]  tbl   Table.
+ * @param[in]  vlan  VLAN identifier.
+ * @param[in]  mac   Address.
+ *
+ * @return     The port, or MAC_TABLE_MISS.
+ */
+uint32_t mac_table_lookup(const mac_table_t *tbl, uint16_t vlan,
+                          const uint8_t *mac)
+{
+    uint64_t i = mac_table_find(tbl, mac_table_key(vlan, mac));
+
+    return i > tbl->mask ? MAC_TABLE_MISS : tbl->slots[i].ifindex;
+}
+
+/**
+ * @brief      Forgets an address.
+ *
+ * @param[in]  tbl   Table.
+ * @param[in]  vlan  VLAN identifier.
+ * @param[in]  mac   Address.
+ *
+ * @return     0, or -1 when it is not in the table.
+ */
+int mac_table_delete(mac_table_t *tbl, uint16_t vlan, const uint8_t *mac)
+{
+    uint64_t i = mac_table_find(tbl, mac_table_key(vlan, mac));
+    mac_entry_t *e;
+
+    if (i > tbl->mask)
+        return -1;
+
+    e = &tbl->entries[tbl->slots[i].entry];
+    glthread_remove(&tbl->wheel[e->tick % tbl->age_ticks], &e->glue);
+    mac_table_unlink(tbl, i);
+    mac_table_release(tbl, e);
+    return 0;
+}
+
+/**
+ * @brief      Moves the clock forward and ages addresses out.
+ *
+ * @param[in]  tbl  Table.
+ * @param[in]  now  New tick.
+ *
+ * @return     The number of addresses removed.
+ */
+uint32_t mac_table_advance(mac_table_t *tbl, uint32_t now)
+{
+    uint32_t steps = now - tbl->now, tick = tbl->now, aged = 0;
+    glthread_node_t *node;
+    glthread_t *lst;
+    mac_entry_t *e;
+
+    // Past age_ticks every list has expired once, which is all there is
+    if (steps > tbl->age_ticks)
+        steps = tbl->age_ticks;
+
+    while (steps--) {
+        // Entries of tick t - age_ticks expire at tick t and share its list
+        lst = &tbl->wheel[++tick % tbl->age_ticks];
+        while ((node = lst->head)) {
+            glthread_remove(lst, node);
+            e = (mac_entry_t *)GLTHREAD_GET_USER_DATA_FROM_OFFSET(node,
+                                                                  lst->offset);
+            mac_table_unlink(tbl, mac_table_find(tbl, e->key));
+            mac_table_release(tbl, e);
+            aged++;
+        }
+    }
+
+    tbl->now = now;
+    tbl->aged += aged;
+    return aged;
+}
+
+#endif    // MAC_TABLE_C
@@ -0,0 +1,209 @@
+/* -----------------------------------------------------------------------------
+ * @file:        mac_table.h
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        22/10/2026 05:00 AM
+ * @license:     MIT
+ * @description: This header file declares the MAC learning table of a
+ *               switch, keyed on VLAN and MAC address. The index is an open
+ *               addressing hash table with linear probing whose slots hold
+ *               the key and the port themselves, so a lookup usually reads
+ *               a single cache line; removal shifts the following slots back
+ *               rather than leaving tombstones. Entries come from a
+ *               preallocated array and embed a glthread_node_t that puts
+ *               them on one list of a timer wheel, one list per tick of the
+ *               aging time. Learning an address, new or seen before, moves
+ *               its entry to the list of the current tick, and advancing the
+ *               clock frees the lists whose tick has expired in one go. No
+ *               entry that is still valid is ever looked at, whatever the
+ *               table holds. Learn, refresh, lookup and delete are O(1).
+ *               The contents are organized into three groups:
+ *
+ *                 1. Structs:
+ *                    - struct mac_entry_t
+ *                    - struct mac_slot_t
+ *                    - struct mac_table_t
+ *
+ *                 2. Functions:
+ *                    - mac_table_create
+ *                    - mac_table_destroy
+ *                    - mac_table_learn
+ *                    - mac_table_lookup
+ *                    - mac_table_delete
+ *                    - mac_table_advance
+ *                    - mac_table_key
+ *
+ *                 3. Macros:
+ *                    - MAC_TABLE_MISS
+ *                    - MAC_TABLE_AGE_TICKS
+ *
+ * @note:        This code is part of the tcpip-stack project, which is a course
+ *               on network development.
+ *
+ * Revision History:
+ *
+ * Revision 0.1: 22/10/2026 Marko Trickovic
+ * Initial version.
+ */
+
+#ifndef MAC_TABLE_H
+#define MAC_TABLE_H
+
+#include <stdint.h>
+#include "../glthreads/glthreads.h"
+
+/** Port returned for an address that is not in the table. */
+#define MAC_TABLE_MISS          UINT32_MAX
+
+/** Aging time in ticks when none is given, 300 one-second ticks. */
+#define MAC_TABLE_AGE_TICKS     300
+
+/**
+ * @brief      The structure representing a learnt address.
+ *
+ * @struct                mac_entry_t
+ *
+ * @param[in]  glue       Links the entry on the aging list of its tick, or
+ *                        on the free list.
+ * @param[in]  key        VLAN and address, see mac_table_key.
+ * @param[in]  tick       Tick the address was last learnt at.
+ */
+typedef struct mac_entry_ {
+    glthread_node_t glue;
+    uint64_t key;
+    uint32_t tick;
+} mac_entry_t;
+
+/**
+ * @brief      The structure representing a slot of the index.
+ *
+ * @struct                mac_slot_t
+ *
+ * @param[in]  key        VLAN and address, UINT64_MAX when empty.
+ * @param[in]  entry      Index of the entry.
+ * @param[in]  ifindex    Port the address was learnt on.
+ */
+typedef struct mac_slot_ {
+    uint64_t key;
+    uint32_t entry;
+    uint32_t ifindex;
+} mac_slot_t;
+
+/**
+ * @brief      The structure representing a MAC table.
+ *
+ * @struct                mac_table_t
+ *
+ * @param[in]  slots      Index, a power of two at least twice max_entries.
+ * @param[in]  mask       Slots minus one.
+ * @param[in]  shift      64 minus the bits of mask.
+ * @param[in]  count      Entries in use.
+ * @param[in]  max_entries Entries the table can hold.
+ * @param[in]  entries    Entries.
+ * @param[in]  free       Unused entries.
+ * @param[in]  wheel      Aging lists, entry of tick t on t % age_ticks.
+ * @param[in]  age_ticks  Ticks an address stays without being learnt again.
+ * @param[in]  now        Current tick.
+ * @param[in]  learns     New addresses learnt.
+ * @param[in]  moves      Addresses learnt again on another port.
+ * @param[in]  aged       Addresses removed by aging.
+ */
+typedef struct mac_table_ {
+    mac_slot_t *slots;
+    uint64_t mask;
+    uint32_t shift;
+    uint32_t count;
+    uint32_t max_entries;
+    mac_entry_t *entries;
+    glthread_t free;
+    glthread_t *wheel;
+    uint32_t age_ticks;
+    uint32_t now;
+    uint64_t learns;
+    uint64_t moves;
+    uint64_t aged;
+} mac_table_t;
+
+/**
+ * @brief      Creates an empty table, the clock at tick 0.
+ *
+ * @param[in]  max_entries  Addresses the table can hold.
+ * @param[in]  age_ticks    Aging time in ticks, 0 for MAC_TABLE_AGE_TICKS.
+ *
+ * @return     The table, or NULL when max_entries is 0 or out of memory.
+ */
+mac_table_t *mac_table_create(uint32_t max_entries, uint32_t age_ticks);
+
+/**
+ * @brief      Frees the table.
+ *
+ * @param[in]  tbl  Table, may be NULL.
+ */
+void mac_table_destroy(mac_table_t *tbl);
+
+/**
+ * @brief      Learns that an address is behind a port, adding it or
+ *             refreshing it and moving it to that port.
+ *
+ * @param[in]  tbl      Table.
+ * @param[in]  vlan     VLAN identifier.
+ * @param[in]  mac      Address.
+ * @param[in]  ifindex  Port, not MAC_TABLE_MISS.
+ *
+ * @return     0, or -1 with errno ENOSPC when the address is new and the
+ *             table full.
+ */
+int mac_table_learn(mac_table_t *tbl, uint16_t vlan, const uint8_t *mac,
+                    uint32_t ifindex);
+
+/**
+ * @brief      Finds the port of an address without refreshing it.
+ *
+ * @param[in]  tbl   Table.
+ * @param[in]  vlan  VLAN identifier.
+ * @param[in]  mac   Address.
+ *
+ * @return     The port, or MAC_TABLE_MISS.
+ */
+uint32_t mac_table_lookup(const mac_table_t *tbl, uint16_t vlan,
+                          const uint8_t *mac);
+
+/**
+ * @brief      Forgets an address.
+ *
+ * @param[in]  tbl   Table.
+ * @param[in]  vlan  VLAN identifier.
+ * @param[in]  mac   Address.
+ *
+ * @return     0, or -1 when the address is not in the table.
+ */
+int mac_table_delete(mac_table_t *tbl, uint16_t vlan, const uint8_t *mac);
+
+/**
+ * @brief      Moves the clock forward and removes the addresses not learnt
+ *             for age_ticks ticks, one aging list per tick passed.
+ *
+ * @param[in]  tbl  Table.
+ * @param[in]  now  New tick, not before the current one.
+ *
+ * @return     The number of addresses removed.
+ */
+uint32_t mac_table_advance(mac_table_t *tbl, uint32_t now);
+
+/**
+ * @brief      Packs a VLAN and an address into a key, the VLAN in the top
+ *             16 bits.
+ *
+ * @param[in]  vlan  VLAN identifier, below 4096.
+ * @param[in]  mac   Address.
+ *
+ * @return     The key.
+ */
+static inline uint64_t mac_table_key(uint16_t vlan, const uint8_t *mac)
+{
+    return (uint64_t)vlan << 48 | (uint64_t)mac[0] << 40 |
+           (uint64_t)mac[1] << 32 | (uint64_t)mac[2] << 24 |
+           (uint64_t)mac[3] << 16 | (uint64_t)mac[4] << 8 | mac[5];
+}
+
+#endif    // MAC_TABLE_H
@@ -0,0 +1,41 @@
+/******************************************************************************
+ * @file:        main.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        20/10/2026 04:00 PM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the entry point of the tcpip-stack
+ *               executable. It builds the first topology of the course, three
+ *               routers connected in a triangle, and prints it.
+ *
+ *               Functions in this file:
+ *                 - main
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 20/10/2026 Marko Trickovic
+ * Initial version.
+ *
+ * Revision 0.2: 20/10/2026 Marko Trickovic
+ * Moved build_first_topo to graph/topologies.c.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include "graph/topologies.h"
+
+int main(void)
+{
+    graph_t *topo = build_first_topo();
+
+    if (!topo) {
+        fprintf(stderr, "failed to build the topology\n");
+        return 1;
+    }
+
+    dump_graph(topo);
+    destroy_graph(topo);
+    return 0;
+}
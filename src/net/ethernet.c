@@ -0,0 +1,206 @@
+/******************************************************************************
+ * @file:        ethernet.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        22/10/2026 03:00 AM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the in-place Ethernet parser and builder.
+ *               EtherTypes are compared in network byte order against
+ *               constants, so the hot path never swaps bytes for a frame it
+ *               does not keep. Tags are pushed and popped with a memmove
+ *               of the 12 address bytes alone, so the cost does not grow
+ *               with the frame.
+ *
+ *               Functions in this file:
+ *                 - ethernet_parse
+ *                 - ethernet_build
+ *                 - ethernet_demux
+ *                 - ethernet_vlan_push
+ *                 - ethernet_vlan_pop
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 22/10/2026 Marko Trickovic
+ * Initial version.
+ *
+ * Revision 0.2: 22/10/2026 Marko Trickovic
+ * Added ethernet_vlan_push and ethernet_vlan_pop.
+ *****************************************************************************/
+
+#ifndef ETHERNET_C
+#define ETHERNET_C
+
+#include "ethernet.h"
+
+/**
+ * @brief      Parses the header of a frame in place.
+ *
+ * @param[in]  pkt    Frame.
+ * @param[out] frame  Views of the header.
+ *
+ * @return     0, or -1 when the frame is too short.
+ */
+int ethernet_parse(pkt_buf_t *pkt, ethernet_frame_t *frame)
+{
+    ethernet_hdr_t *eth = ethernet_hdr(pkt);
+    ethernet_vlan_hdr_t *vlan;
+
+    if (!eth)
+        return -1;
+
+    if (eth->type != htons(ETHERNET_TYPE_VLAN)) {
+        frame->eth = eth;
+        frame->vlan = NULL;
+        frame->payload = pkt->data + ETHERNET_HDR_LEN;
+        frame->type = ntohs(eth->type);
+        frame->vid = 0;
+        frame->hlen = ETHERNET_HDR_LEN;
+        return 0;
+    }
+
+    if (ETHERNET_VLAN_HDR_LEN <= pkt->len)
+        vlan = (ethernet_vlan_hdr_t *)pkt->data;
+    else
+        vlan = (ethernet_vlan_hdr_t *)pkt_buf_may_pull(pkt,
+                                                       ETHERNET_VLAN_HDR_LEN);
+    if (!vlan)
+        return -1;
+
+    frame->eth = (ethernet_hdr_t *)vlan;
+    frame->vlan = vlan;
+    frame->payload = pkt->data + ETHERNET_VLAN_HDR_LEN;
+    frame->type = ntohs(vlan->type);
+    frame->vid = ntohs(vlan->tci) & ETHERNET_VID_MASK;
+    frame->hlen = ETHERNET_VLAN_HDR_LEN;
+    return 0;
+}
+
+/**
+ * @brief      Prepends an untagged header in the headroom.
+ *
+ * @param[in]  pkt   Packet.
+ * @param[in]  dst   Destination address.
+ * @param[in]  src   Source address.
+ * @param[in]  type  EtherType.
+ *
+ * @return     The header, or NULL.
+ */
+ethernet_hdr_t *ethernet_build(pkt_buf_t *pkt, const uint8_t *dst,
+                               const uint8_t *src, uint16_t type)
+{
+    ethernet_hdr_t *eth;
+
+    // Clones share the block, headroom included
+    if (pkt_buf_is_shared(pkt) && pkt_buf_make_writable(pkt) < 0)
+        return NULL;
+
+    eth = (ethernet_hdr_t *)pkt_buf_push(pkt, ETHERNET_HDR_LEN);
+    if (!eth)
+        return NULL;
+
+    ethernet_rewrite(eth, dst, src);
+    eth->type = htons(type);
+    return eth;
+}
+
+/**
+ * @brief      Empties a receive queue into per-EtherType queues.
+ *
+ * @param[in]  rxq   Frames received.
+ * @param[in]  mac   Address of the receiving interface.
+ * @param[in]  ip4q  IPv4 frames.
+ * @param[in]  arpq  ARP frames.
+ *
+ * @return     The number of frames freed.
+ */
+uint32_t ethernet_demux(pkt_queue_t *rxq, const uint8_t *mac,
+                        pkt_queue_t *ip4q, pkt_queue_t *arpq)
+{
+    ethernet_frame_t frame;
+    pkt_queue_t *q;
+    uint32_t drops = 0;
+    pkt_buf_t *pkt;
+
+    while ((pkt = pkt_queue_pop(rxq))) {
+        q = NULL;
+        if (!ethernet_parse(pkt, &frame) &&
+            (ethernet_is_mcast(frame.eth->dst) ||
+             !memcmp(frame.eth->dst, mac, ETHERNET_ADDR_LEN))) {
+            if (frame.type == ETHERNET_TYPE_IP4)
+                q = ip4q;
+            else if (frame.type == ETHERNET_TYPE_ARP)
+                q = arpq;
+        }
+
+        if (q) {
+            pkt->vlan = frame.vid;
+            if (!pkt_queue_push(q, pkt))
+                continue;
+        }
+        pkt_buf_free(pkt);
+        drops++;
+    }
+    return drops;
+}
+
+/**
+ * @brief      Inserts an 802.1Q tag.
+ *
+ * @param[in]  pkt  Frame.
+ * @param[in]  tci  Tag control field.
+ *
+ * @return     The tagged header, or NULL.
+ */
+ethernet_vlan_hdr_t *ethernet_vlan_push(pkt_buf_t *pkt, uint16_t tci)
+{
+    ethernet_vlan_hdr_t *vlan;
+    unsigned char *p;
+
+    if (!ethernet_hdr(pkt))
+        return NULL;
+    if (pkt_buf_is_shared(pkt) && pkt_buf_make_writable(pkt) < 0)
+        return NULL;
+
+    p = pkt_buf_push(pkt, ETHERNET_VLAN_TAG_LEN);
+    if (!p)
+        return NULL;
+
+    // The old EtherType stays put and becomes the type after the tag
+    memmove(p, p + ETHERNET_VLAN_TAG_LEN, 2 * ETHERNET_ADDR_LEN);
+    vlan = (ethernet_vlan_hdr_t *)p;
+    vlan->tpid = htons(ETHERNET_TYPE_VLAN);
+    vlan->tci = htons(tci);
+    return vlan;
+}
+
+/**
+ * @brief      Strips the 802.1Q tag of a frame.
+ *
+ * @param[in]  pkt  Frame.
+ *
+ * @return     The tag control field, or -1.
+ */
+int ethernet_vlan_pop(pkt_buf_t *pkt)
+{
+    ethernet_frame_t frame;
+    uint16_t tci;
+
+    if (ethernet_parse(pkt, &frame) < 0 || !frame.vlan)
+        return -1;
+    if (pkt_buf_is_shared(pkt)) {
+        if (pkt_buf_make_writable(pkt) < 0)
+            return -1;
+        frame.vlan = (ethernet_vlan_hdr_t *)pkt->data;
+    }
+
+    tci = ntohs(frame.vlan->tci);
+    memmove(pkt->data + ETHERNET_VLAN_TAG_LEN, pkt->data,
+            2 * ETHERNET_ADDR_LEN);
+    pkt_buf_pull(pkt, ETHERNET_VLAN_TAG_LEN);
+    return tci;
+}
+
+#endif    // ETHERNET_C
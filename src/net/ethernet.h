@@ -0,0 +1,271 @@
+/* -----------------------------------------------------------------------------
+ * @file:        ethernet.h
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        22/10/2026 03:00 AM
+ * @license:     MIT
+ * @description: This header file declares the Ethernet header layouts and
+ *               the functions that parse and build them in place. A header
+ *               is never copied out of the packet: ethernet_parse returns
+ *               pointers into the first segment, which the caller reads and
+ *               rewrites through the packed structs below, and
+ *               ethernet_build writes a new header into the headroom in
+ *               front of the payload. The sizes and field offsets of the
+ *               structs are checked at compile time, so a layout that does
+ *               not match the wire format fails the build. Multi-byte fields
+ *               are in network byte order. Frames travel between stages on
+ *               pkt_queue_t, linked through the glthread_node_t of each
+ *               pkt_buf_t; ethernet_demux sorts a receive queue into one
+ *               queue per EtherType that way. ethernet_vlan_push and
+ *               ethernet_vlan_pop insert and strip an 802.1Q tag by moving
+ *               the 12 address bytes into or out of the headroom; the
+ *               payload stays where it is whatever its length.
+ *               The contents are organized into three groups:
+ *
+ *                 1. Structs:
+ *                    - struct ethernet_hdr_t
+ *                    - struct ethernet_vlan_hdr_t
+ *                    - struct ethernet_frame_t
+ *
+ *                 2. Functions:
+ *                    - ethernet_parse
+ *                    - ethernet_build
+ *                    - ethernet_demux
+ *                    - ethernet_vlan_push
+ *                    - ethernet_vlan_pop
+ *                    - ethernet_hdr
+ *                    - ethernet_rewrite
+ *                    - ethernet_is_mcast
+ *
+ *                 3. Macros:
+ *                    - ETHERNET_ADDR_LEN
+ *                    - ETHERNET_HDR_LEN
+ *                    - ETHERNET_VLAN_HDR_LEN
+ *                    - ETHERNET_VLAN_TAG_LEN
+ *                    - ETHERNET_TYPE_IP4
+ *                    - ETHERNET_TYPE_ARP
+ *                    - ETHERNET_TYPE_VLAN
+ *                    - ETHERNET_VID_MASK
+ *
+ * @note:        This code is part of the tcpip-stack project, which is a course
+ *               on network development.
+ *
+ * Revision History:
+ *
+ * Revision 0.1: 22/10/2026 Marko Trickovic
+ * Initial version.
+ *
+ * Revision 0.2: 22/10/2026 Marko Trickovic
+ * Added in-place 802.1Q tag push and pop.
+ */
+
+#ifndef ETHERNET_H
+#define ETHERNET_H
+
+#include <arpa/inet.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "../pkt/pkt_queue.h"
+
+#define ETHERNET_ADDR_LEN       6
+#define ETHERNET_HDR_LEN        14
+#define ETHERNET_VLAN_HDR_LEN   18
+
+/** Bytes an 802.1Q tag adds to a header. */
+#define ETHERNET_VLAN_TAG_LEN   (ETHERNET_VLAN_HDR_LEN - ETHERNET_HDR_LEN)
+
+#define ETHERNET_TYPE_IP4       0x0800
+#define ETHERNET_TYPE_ARP       0x0806
+#define ETHERNET_TYPE_VLAN      0x8100
+
+/** VLAN identifier bits of a tag control field. */
+#define ETHERNET_VID_MASK       0x0fff
+
+/**
+ * @brief      The structure representing an untagged Ethernet header.
+ *
+ * @struct                ethernet_hdr_t
+ *
+ * @param[in]  dst        Destination address.
+ * @param[in]  src        Source address.
+ * @param[in]  type       EtherType.
+ */
+typedef struct ethernet_hdr_ {
+    uint8_t dst[ETHERNET_ADDR_LEN];
+    uint8_t src[ETHERNET_ADDR_LEN];
+    uint16_t type;
+} __attribute__((packed)) ethernet_hdr_t;
+
+/**
+ * @brief      The structure representing an Ethernet header with one
+ *             802.1Q tag.
+ *
+ * @struct                ethernet_vlan_hdr_t
+ *
+ * @param[in]  dst        Destination address.
+ * @param[in]  src        Source address.
+ * @param[in]  tpid       ETHERNET_TYPE_VLAN.
+ * @param[in]  tci        Priority, drop eligibility and VLAN identifier.
+ * @param[in]  type       EtherType of the payload.
+ */
+typedef struct ethernet_vlan_hdr_ {
+    uint8_t dst[ETHERNET_ADDR_LEN];
+    uint8_t src[ETHERNET_ADDR_LEN];
+    uint16_t tpid;
+    uint16_t tci;
+    uint16_t type;
+} __attribute__((packed)) ethernet_vlan_hdr_t;
+
+_Static_assert(sizeof(ethernet_hdr_t) == ETHERNET_HDR_LEN,
+               "ethernet_hdr_t must match the wire header");
+_Static_assert(offsetof(ethernet_hdr_t, src) == 6 &&
+               offsetof(ethernet_hdr_t, type) == 12,
+               "ethernet_hdr_t fields must sit at their wire offsets");
+_Static_assert(sizeof(ethernet_vlan_hdr_t) == ETHERNET_VLAN_HDR_LEN,
+               "ethernet_vlan_hdr_t must match the wire header");
+_Static_assert(offsetof(ethernet_vlan_hdr_t, src) == 6 &&
+               offsetof(ethernet_vlan_hdr_t, tpid) == 12 &&
+               offsetof(ethernet_vlan_hdr_t, tci) == 14 &&
+               offsetof(ethernet_vlan_hdr_t, type) == 16,
+               "ethernet_vlan_hdr_t fields must sit at their wire offsets");
+
+/**
+ * @brief      The structure representing a parsed frame. Every pointer
+ *             points into the packet and stays valid until its first
+ *             segment is changed.
+ *
+ * @struct                ethernet_frame_t
+ *
+ * @param[in]  eth        Header, on the first byte of the frame.
+ * @param[in]  vlan       The same header seen with its tag, NULL when the
+ *                        frame is untagged.
+ * @param[in]  payload    First byte after the header.
+ * @param[in]  type       EtherType of the payload, host byte order.
+ * @param[in]  vid        VLAN identifier, 0 when untagged.
+ * @param[in]  hlen       Header length, ETHERNET_HDR_LEN or
+ *                        ETHERNET_VLAN_HDR_LEN.
+ */
+typedef struct ethernet_frame_ {
+    ethernet_hdr_t *eth;
+    ethernet_vlan_hdr_t *vlan;
+    unsigned char *payload;
+    uint16_t type;
+    uint16_t vid;
+    uint16_t hlen;
+} ethernet_frame_t;
+
+/**
+ * @brief      Parses the header of a frame in place, pulling it into the
+ *             first segment when it is split.
+ *
+ * @param[in]  pkt    Frame, data on the Ethernet header.
+ * @param[out] frame  Views of the header.
+ *
+ * @return     0, or -1 when the frame is too short for its header.
+ */
+int ethernet_parse(pkt_buf_t *pkt, ethernet_frame_t *frame);
+
+/**
+ * @brief      Prepends an untagged header in the headroom of the packet.
+ *             The payload is not moved.
+ *
+ * @param[in]  pkt   Packet, data on the payload. A shared first segment is
+ *                   made private first.
+ * @param[in]  dst   Destination address.
+ * @param[in]  src   Source address.
+ * @param[in]  type  EtherType, host byte order.
+ *
+ * @return     The header, now the first byte of the packet, or NULL when the
+ *             headroom is shorter than ETHERNET_HDR_LEN or no private copy
+ *             could be made.
+ */
+ethernet_hdr_t *ethernet_build(pkt_buf_t *pkt, const uint8_t *dst,
+                               const uint8_t *src, uint16_t type);
+
+/**
+ * @brief      Empties a receive queue into per-EtherType queues. Frames
+ *             that are unicast to another address, too short or of any
+ *             other type are freed. Each frame keeps its header and gets
+ *             the VLAN identifier of its tag, 0 when untagged, in vlan.
+ *
+ * @param[in]  rxq   Frames received.
+ * @param[in]  mac   Address of the receiving interface.
+ * @param[in]  ip4q  Queue for IPv4 frames.
+ * @param[in]  arpq  Queue for ARP frames.
+ *
+ * @return     The number of frames freed, including those a full queue
+ *             refused.
+ */
+uint32_t ethernet_demux(pkt_queue_t *rxq, const uint8_t *mac,
+                        pkt_queue_t *ip4q, pkt_queue_t *arpq);
+
+/**
+ * @brief      Inserts an 802.1Q tag after the addresses of an untagged
+ *             frame. The addresses move ETHERNET_VLAN_TAG_LEN bytes into
+ *             the headroom; nothing after them is moved.
+ *
+ * @param[in]  pkt  Frame, data on the Ethernet header. A shared first
+ *                  segment is made private first.
+ * @param[in]  tci  Tag control field, host byte order.
+ *
+ * @return     The tagged header, or NULL when the frame is too short, the
+ *             headroom is shorter than ETHERNET_VLAN_TAG_LEN or no private
+ *             copy could be made.
+ */
+ethernet_vlan_hdr_t *ethernet_vlan_push(pkt_buf_t *pkt, uint16_t tci);
+
+/**
+ * @brief      Strips the 802.1Q tag of a frame. The addresses move over the
+ *             tag, which goes back to the headroom; nothing after them is
+ *             moved.
+ *
+ * @param[in]  pkt  Frame, data on the Ethernet header. A shared first
+ *                  segment is made private first.
+ *
+ * @return     The tag control field, host byte order, or -1 when the frame
+ *             is not tagged or no private copy could be made.
+ */
+int ethernet_vlan_pop(pkt_buf_t *pkt);
+
+/**
+ * @brief      Returns the untagged header view of a frame.
+ *
+ * @param[in]  pkt  Frame, data on the Ethernet header.
+ *
+ * @return     The header, or NULL when the frame is too short.
+ */
+static inline ethernet_hdr_t *ethernet_hdr(pkt_buf_t *pkt)
+{
+    if (ETHERNET_HDR_LEN <= pkt->len)
+        return (ethernet_hdr_t *)pkt->data;
+    return (ethernet_hdr_t *)pkt_buf_may_pull(pkt, ETHERNET_HDR_LEN);
+}
+
+/**
+ * @brief      Rewrites the addresses of a header in place.
+ *
+ * @param[in]  eth  Header.
+ * @param[in]  dst  New destination address.
+ * @param[in]  src  New source address.
+ */
+static inline void ethernet_rewrite(ethernet_hdr_t *eth, const uint8_t *dst,
+                                    const uint8_t *src)
+{
+    memcpy(eth->dst, dst, ETHERNET_ADDR_LEN);
+    memcpy(eth->src, src, ETHERNET_ADDR_LEN);
+}
+
+/**
+ * @brief      Tells group addresses, broadcast included, from unicast ones.
+ *
+ * @param[in]  addr  Address.
+ *
+ * @return     1 for a group address, 0 for a unicast one.
+ */
+static inline int ethernet_is_mcast(const uint8_t *addr)
+{
+    return addr[0] & 1;
+}
+
+#endif    // ETHERNET_H
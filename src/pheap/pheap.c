@@ -0,0 +1,258 @@
+/******************************************************************************
+ * @file:        pheap.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        20/10/2026 11:00 AM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the intrusive pairing heap. Children of a
+ *               node form a doubly linked sibling list, where the leftmost
+ *               child's left pointer points back to the parent. That is what
+ *               lets decrease-key and remove cut a subtree out in O(1).
+ *               delete-min uses the standard two-pass pairing: siblings are
+ *               linked in pairs left to right, then the pairs are folded
+ *               right to left. Both passes are iterative, so a long sibling
+ *               list cannot overflow the stack.
+ *
+ *               Functions in this file:
+ *                 - init_pheap
+ *                 - pheap_insert
+ *                 - pheap_meld
+ *                 - pheap_delete_min
+ *                 - pheap_decrease_key
+ *                 - pheap_remove
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 20/10/2026 Marko Trickovic
+ * Initial version with two-pass pairing delete-min.
+ *****************************************************************************/
+
+#ifndef PHEAP_C
+#define PHEAP_C
+
+#include "pheap.h"
+
+/**
+ * @brief      Compares the user structs two heap nodes are embedded in.
+ */
+static inline int pheap_less(const pheap_t *heap, const pheap_node_t *a,
+                             const pheap_node_t *b)
+{
+    return heap->cmp(PHEAP_GET_USER_DATA_FROM_OFFSET(a, heap->offset),
+                     PHEAP_GET_USER_DATA_FROM_OFFSET(b, heap->offset)) < 0;
+}
+
+/**
+ * @brief      Links two trees, making the larger root the leftmost child of
+ *             the smaller one. Sibling pointers of both roots are ignored.
+ *
+ * @return     Root of the combined tree.
+ */
+static inline pheap_node_t *pheap_link(const pheap_t *heap, pheap_node_t *a,
+                                       pheap_node_t *b)
+{
+    pheap_node_t *tmp;
+
+    if (pheap_less(heap, b, a)) {
+        tmp = a;
+        a = b;
+        b = tmp;
+    }
+
+    b->left = a;
+    b->right = a->child;
+    if (a->child)
+        a->child->left = b;
+    a->child = b;
+
+    return a;
+}
+
+/**
+ * @brief      Unlinks a non-root node, together with its subtree, from its
+ *             parent and siblings.
+ */
+static inline void pheap_cut(pheap_node_t *node)
+{
+    if (node->left->child == node)
+        node->left->child = node->right;
+    else
+        node->left->right = node->right;
+
+    if (node->right)
+        node->right->left = node->left;
+
+    node->left = NULL;
+    node->right = NULL;
+}
+
+/**
+ * @brief      Combines a sibling list into a single tree with two-pass
+ *             pairing.
+ *
+ * @param[in]  heap   Heap the nodes belong to.
+ * @param[in]  first  Leftmost sibling, may be NULL.
+ *
+ * @return     Root of the combined tree with clear sibling pointers.
+ */
+static pheap_node_t *pheap_merge_pairs(const pheap_t *heap,
+                                       pheap_node_t *first)
+{
+    pheap_node_t *a, *b, *next, *stack = NULL, *root;
+
+    // First pass: link pairs left to right, pushing each result on a stack
+    // threaded through the right pointers
+    while (first) {
+        a = first;
+        b = a->right;
+
+        if (!b) {
+            a->left = NULL;
+            a->right = stack;
+            stack = a;
+            break;
+        }
+
+        next = b->right;
+        a->left = a->right = NULL;
+        b->left = b->right = NULL;
+
+        a = pheap_link(heap, a, b);
+        a->right = stack;
+        stack = a;
+
+        first = next;
+    }
+
+    if (!stack)
+        return NULL;
+
+    // Second pass: fold the pairs right to left, i.e. in stack order
+    root = stack;
+    stack = stack->right;
+    root->right = NULL;
+
+    while (stack) {
+        next = stack->right;
+        stack->right = NULL;
+        root = pheap_link(heap, root, stack);
+        stack = next;
+    }
+
+    root->left = NULL;
+    return root;
+}
+
+/**
+ * @brief      Initializes an empty heap.
+ *
+ * @param[out] heap    Heap to initialize.
+ * @param[in]  offset  Offset of the pheap_node_t in the user struct.
+ * @param[in]  cmp     Ordering callback.
+ */
+void init_pheap(pheap_t *heap, unsigned int offset, pheap_cmp_fn_t cmp)
+{
+    heap->root = NULL;
+    heap->offset = offset;
+    heap->cmp = cmp;
+    heap->count = 0;
+}
+
+/**
+ * @brief      Inserts a node in O(1).
+ *
+ * @param[in]  heap  Heap to insert into.
+ * @param[in]  node  Node not currently in any heap.
+ */
+void pheap_insert(pheap_t *heap, pheap_node_t *node)
+{
+    pheap_node_init(node);
+
+    heap->root = heap->root ? pheap_link(heap, heap->root, node) : node;
+    heap->count++;
+}
+
+/**
+ * @brief      Moves every node of src into dst in O(1).
+ *
+ * @param[in]  dst  Heap receiving the nodes.
+ * @param[in]  src  Heap giving up its nodes.
+ */
+void pheap_meld(pheap_t *dst, pheap_t *src)
+{
+    if (!src->root)
+        return;
+
+    dst->root = dst->root ? pheap_link(dst, dst->root, src->root)
+                          : src->root;
+    dst->count += src->count;
+
+    src->root = NULL;
+    src->count = 0;
+}
+
+/**
+ * @brief      Removes and returns the node with the smallest key.
+ *
+ * @param[in]  heap  Heap to take from.
+ *
+ * @return     The detached node, or NULL when the heap is empty.
+ */
+pheap_node_t *pheap_delete_min(pheap_t *heap)
+{
+    pheap_node_t *min = heap->root;
+
+    if (!min)
+        return NULL;
+
+    heap->root = pheap_merge_pairs(heap, min->child);
+    heap->count--;
+
+    pheap_node_init(min);
+    return min;
+}
+
+/**
+ * @brief      Restores the heap order after the key of a node was lowered.
+ *
+ * @param[in]  heap  Heap containing node.
+ * @param[in]  node  Node whose key the caller has just decreased.
+ */
+void pheap_decrease_key(pheap_t *heap, pheap_node_t *node)
+{
+    if (node == heap->root)
+        return;
+
+    // The subtree below node is still heap ordered, move it as a whole
+    pheap_cut(node);
+    heap->root = pheap_link(heap, heap->root, node);
+}
+
+/**
+ * @brief      Removes an arbitrary node.
+ *
+ * @param[in]  heap  Heap containing node.
+ * @param[in]  node  Node to remove.
+ */
+void pheap_remove(pheap_t *heap, pheap_node_t *node)
+{
+    pheap_node_t *sub;
+
+    if (node == heap->root) {
+        pheap_delete_min(heap);
+        return;
+    }
+
+    pheap_cut(node);
+    sub = pheap_merge_pairs(heap, node->child);
+    if (sub)
+        heap->root = pheap_link(heap, heap->root, sub);
+    heap->count--;
+
+    pheap_node_init(node);
+}
+
+#endif    // PHEAP_C
@@ -0,0 +1,174 @@
+/* -----------------------------------------------------------------------------
+ * @file:        pheap.h
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        20/10/2026 11:00 AM
+ * @license:     MIT
+ * @description: This header file declares an intrusive pairing heap, a
+ *               priority queue for event scheduling and SPF candidate sets.
+ *               Like glthreads, the node is embedded in the user struct and the
+ *               heap stores the offset of that node, so the user struct is
+ *               recovered by pointer arithmetic and the heap never allocates.
+ *               Insert, meld and decrease-key are O(1), delete-min and remove
+ *               are amortized O(log n). The contents are organized into three
+ *               groups:
+ *
+ *                 1. Structs:
+ *                    - struct pheap_node_t
+ *                    - struct pheap_t
+ *
+ *                 2. Functions:
+ *                    - init_pheap
+ *                    - pheap_insert
+ *                    - pheap_meld
+ *                    - pheap_delete_min
+ *                    - pheap_decrease_key
+ *                    - pheap_remove
+ *
+ *                 3. Macros:
+ *                    - pheap_node_init
+ *                    - pheap_is_empty
+ *                    - pheap_min
+ *                    - PHEAP_GET_USER_DATA_FROM_OFFSET
+ *
+ * @note:        This code is part of the tcpip-stack project, which is a course
+ *               on network development.
+ *
+ * Revision History:
+ *
+ * Revision 0.1: 20/10/2026 Marko Trickovic
+ * Initial version with two-pass pairing delete-min.
+ */
+
+#ifndef PHEAP_H
+#define PHEAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief      The structure representing a pairing heap node.
+ *
+ * @struct                pheap_node_t
+ *
+ * @param[in]  child      Leftmost child.
+ * @param[in]  right      Next sibling.
+ * @param[in]  left       Previous sibling, or the parent for a leftmost child.
+ */
+typedef struct pheap_node_ {
+    struct pheap_node_ *child;
+    struct pheap_node_ *right;
+    struct pheap_node_ *left;
+} pheap_node_t;
+
+/**
+ * @brief      Ordering callback on user structs.
+ *
+ * @return     Negative when a must come out of the heap before b, zero when
+ *             equal, positive otherwise.
+ */
+typedef int (*pheap_cmp_fn_t)(const void *a, const void *b);
+
+/**
+ * @brief      The structure representing a pairing heap.
+ *
+ * @struct                pheap_t
+ *
+ * @param[in]  root       Node with the smallest key, NULL when empty.
+ * @param[in]  offset     Offset of the pheap_node_t in the user struct.
+ * @param[in]  cmp        Ordering callback.
+ * @param[in]  count      Number of nodes in the heap.
+ */
+typedef struct pheap_ {
+    pheap_node_t *root;
+    unsigned int offset;
+    pheap_cmp_fn_t cmp;
+    size_t count;
+} pheap_t;
+
+/**
+ * @brief      Initializes an empty heap.
+ *
+ * @param[out] heap    Heap to initialize.
+ * @param[in]  offset  Offset of the pheap_node_t in the user struct.
+ * @param[in]  cmp     Ordering callback.
+ */
+void init_pheap(pheap_t *heap, unsigned int offset, pheap_cmp_fn_t cmp);
+
+/**
+ * @brief      Inserts a node in O(1).
+ *
+ * @param[in]  heap  Heap to insert into.
+ * @param[in]  node  Node not currently in any heap.
+ */
+void pheap_insert(pheap_t *heap, pheap_node_t *node);
+
+/**
+ * @brief      Moves every node of src into dst in O(1). Both heaps must use
+ *             the same offset and ordering; src is left empty.
+ *
+ * @param[in]  dst  Heap receiving the nodes.
+ * @param[in]  src  Heap giving up its nodes.
+ */
+void pheap_meld(pheap_t *dst, pheap_t *src);
+
+/**
+ * @brief      Removes and returns the node with the smallest key.
+ *
+ * @param[in]  heap  Heap to take from.
+ *
+ * @return     The detached node, or NULL when the heap is empty.
+ */
+pheap_node_t *pheap_delete_min(pheap_t *heap);
+
+/**
+ * @brief      Restores the heap order after the key of a node was lowered.
+ *
+ * @param[in]  heap  Heap containing node.
+ * @param[in]  node  Node whose key the caller has just decreased.
+ */
+void pheap_decrease_key(pheap_t *heap, pheap_node_t *node);
+
+/**
+ * @brief      Removes an arbitrary node.
+ *
+ * @param[in]  heap  Heap containing node.
+ * @param[in]  node  Node to remove.
+ */
+void pheap_remove(pheap_t *heap, pheap_node_t *node);
+
+/**
+ * @brief      Initialize a pairing heap node.
+ *
+ * @param[in]  node  Pointer to the node to be initialized.
+ */
+#define pheap_node_init(node)       \
+    (node)->child = NULL;           \
+    (node)->right = NULL;           \
+    (node)->left = NULL;
+
+/**
+ * @brief      Tells whether a heap holds no nodes.
+ *
+ * @param[in]  heap  Pointer to the heap.
+ */
+#define pheap_is_empty(heap)    ((heap)->root == NULL)
+
+/**
+ * @brief      Returns the node with the smallest key without removing it.
+ *
+ * @param[in]  heap  Pointer to the heap.
+ */
+#define pheap_min(heap)         ((heap)->root)
+
+/**
+ * @brief      Retrieves the user data pointer from a heap node pointer and
+ *             offset.
+ *
+ * @param[in]  nodeptr  Pointer to the heap node.
+ * @param[in]  offset   Offset of the node in the user struct.
+ */
+#define PHEAP_GET_USER_DATA_FROM_OFFSET(nodeptr, offset)  \
+    (void *)((char *)(nodeptr) - offset)
+
+#endif    // PHEAP_H
@@ -0,0 +1,688 @@
+/******************************************************************************
+ * @file:        pkt_buf.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        21/10/2026 09:00 AM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the packet buffer pool. All descriptors are
+ *               one array and all blocks one cache-line aligned region, both
+ *               allocated when the pool is created, and free ones sit on two
+ *               glthreads used as stacks, so the most recently freed and thus
+ *               cache-warm buffer is handed out next. Allocation and free are
+ *               a glthread pop and push each. The free lists and block
+ *               reference counts are only locked and atomic in a PKT_POOL_MT
+ *               pool; a single-threaded pool pays for neither. Operations on whole
+ *               packets walk the segment chain, which for the common single
+ *               segment packet is one iteration. A PKT_POOL_SHARED pool puts
+ *               the pool itself, the descriptors and the blocks in one
+ *               memfd mapping so that every pointer in it, free list glue
+ *               included, is valid in each process forked from the creator.
+ *
+ *               Functions in this file:
+ *                 - pkt_pool_create
+ *                 - pkt_pool_destroy
+ *                 - pkt_buf_alloc
+ *                 - pkt_buf_alloc_len
+ *                 - pkt_buf_alloc_bulk
+ *                 - pkt_buf_free
+ *                 - pkt_buf_clone
+ *                 - pkt_buf_copy
+ *                 - pkt_buf_make_writable
+ *                 - pkt_buf_append
+ *                 - pkt_buf_trim
+ *                 - pkt_buf_may_pull
+ *                 - pkt_buf_to_iovec
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 21/10/2026 Marko Trickovic
+ * Initial version with headroom, clones and pooled free lists.
+ *
+ * Revision 0.2: 21/10/2026 Marko Trickovic
+ * Added segment chains: pkt_buf_alloc_len, pkt_buf_append, pkt_buf_trim,
+ * pkt_buf_may_pull and pkt_buf_to_iovec; free, clone, copy and
+ * make_writable now cover every segment.
+ *
+ * Revision 0.3: 21/10/2026 Marko Trickovic
+ * Added pkt_buf_alloc_bulk.
+ *
+ * Revision 0.4: 21/10/2026 Marko Trickovic
+ * The pool records its block count.
+ *
+ * Revision 0.5: 21/10/2026 Marko Trickovic
+ * Added shared pools mapped from a memfd.
+ *****************************************************************************/
+
+#ifndef PKT_BUF_C
+#define PKT_BUF_C
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "pkt_buf.h"
+
+#define PKT_BLK_ALIGN   64
+#define PKT_HUGE_PAGE   (2u << 20)
+
+static inline void pkt_pool_lock(pkt_pool_t *pool)
+{
+    if (pool->flags & PKT_POOL_MT)
+        pthread_mutex_lock(&pool->lock);
+}
+
+static inline void pkt_pool_unlock(pkt_pool_t *pool)
+{
+    if (pool->flags & PKT_POOL_MT)
+        pthread_mutex_unlock(&pool->lock);
+}
+
+// Pops the head of a free list, the caller holds the pool lock
+static inline glthread_node_t *pkt_pool_pop(glthread_t *lst)
+{
+    glthread_node_t *node = lst->head;
+
+    if (node)
+        glthread_remove(lst, node);
+    return node;
+}
+
+static inline pkt_blk_t *pkt_blk_at(pkt_pool_t *pool, uint32_t i)
+{
+    return (pkt_blk_t *)(pool->blks + (size_t)i * pool->blk_stride);
+}
+
+static inline void pkt_blk_get(pkt_pool_t *pool, pkt_blk_t *blk)
+{
+    if (pool->flags & PKT_POOL_MT)
+        __atomic_add_fetch(&blk->refcnt, 1, __ATOMIC_RELAXED);
+    else
+        blk->refcnt++;
+}
+
+// Drops a reference and returns the number left
+static inline uint32_t pkt_blk_put(pkt_pool_t *pool, pkt_blk_t *blk)
+{
+    if (pool->flags & PKT_POOL_MT)
+        return __atomic_sub_fetch(&blk->refcnt, 1, __ATOMIC_ACQ_REL);
+    return --blk->refcnt;
+}
+
+/**
+ * @brief      Takes a descriptor and, when with_blk, a block from the pool.
+ *             Either both are taken or neither.
+ *
+ * @param[in]  pool      Pool.
+ * @param[in]  with_blk  Also take a block.
+ * @param[out] blk       The block, when with_blk.
+ *
+ * @return     The descriptor, or NULL when the pool is exhausted.
+ */
+static pkt_buf_t *pkt_pool_take(pkt_pool_t *pool, int with_blk,
+                                pkt_blk_t **blk)
+{
+    glthread_node_t *node = NULL;
+
+    pkt_pool_lock(pool);
+    if (pool->nfree_bufs && (!with_blk || pool->nfree_blks)) {
+        node = pkt_pool_pop(&pool->free_bufs);
+        pool->nfree_bufs--;
+        if (with_blk) {
+            *blk = GLTHREAD_GET_USER_DATA_FROM_OFFSET(
+                pkt_pool_pop(&pool->free_blks), offset(pkt_blk_t, glue));
+            pool->nfree_blks--;
+        }
+    }
+    pkt_pool_unlock(pool);
+
+    return node ? PKT_BUF_FROM_GLUE(node) : NULL;
+}
+
+/**
+ * @brief      Allocates a pool, its descriptors and its blocks from the heap.
+ *
+ * @param[in]  nbufs      Descriptors.
+ * @param[in]  blks_size  Bytes of block storage.
+ *
+ * @return     The zeroed pool with bufs and blks set, or NULL.
+ */
+static pkt_pool_t *pkt_pool_alloc_private(uint64_t nbufs, size_t blks_size)
+{
+    pkt_pool_t *pool;
+
+    pool = calloc(1, sizeof(*pool));
+    if (!pool)
+        return NULL;
+
+    pool->bufs = calloc(nbufs, sizeof(pkt_buf_t));
+    if (blks_size >= PKT_HUGE_PAGE) {
+        // Large regions ask for transparent huge pages, since a packet per
+        // block touches a new 4K page nearly every time
+        blks_size = (blks_size + PKT_HUGE_PAGE - 1) &
+                    ~(size_t)(PKT_HUGE_PAGE - 1);
+        pool->blks = aligned_alloc(PKT_HUGE_PAGE, blks_size);
+        if (pool->blks)
+            madvise(pool->blks, blks_size, MADV_HUGEPAGE);
+    } else {
+        pool->blks = aligned_alloc(PKT_BLK_ALIGN, blks_size);
+    }
+    if (!pool->bufs || !pool->blks) {
+        free(pool->bufs);
+        free(pool->blks);
+        free(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+/**
+ * @brief      Maps a pool, its descriptors and its blocks as one shared memfd
+ *             region. The memory comes back zeroed.
+ *
+ * @param[in]  nbufs      Descriptors.
+ * @param[in]  blks_size  Bytes of block storage.
+ *
+ * @return     The pool with bufs, blks and map_size set, or NULL.
+ */
+static pkt_pool_t *pkt_pool_map_shared(uint64_t nbufs, size_t blks_size)
+{
+    size_t bufs_off, blks_off, size;
+    pkt_pool_t *pool;
+    void *mem;
+    int fd;
+
+    bufs_off = (sizeof(pkt_pool_t) + PKT_BLK_ALIGN - 1) &
+               ~(size_t)(PKT_BLK_ALIGN - 1);
+    blks_off = (bufs_off + nbufs * sizeof(pkt_buf_t) + PKT_BLK_ALIGN - 1) &
+               ~(size_t)(PKT_BLK_ALIGN - 1);
+    size = blks_off + blks_size;
+
+    fd = memfd_create("pkt_pool", MFD_CLOEXEC);
+    if (fd < 0)
+        return NULL;
+    if (ftruncate(fd, (off_t)size) < 0) {
+        close(fd);
+        return NULL;
+    }
+    // The mapping keeps the memory alive, the descriptor is not needed
+    mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED)
+        return NULL;
+
+    pool = mem;
+    pool->bufs = (pkt_buf_t *)((unsigned char *)mem + bufs_off);
+    pool->blks = (unsigned char *)mem + blks_off;
+    pool->map_size = size;
+    return pool;
+}
+
+/**
+ * @brief      Creates a pool.
+ *
+ * @param[in]  nblks     Number of data blocks.
+ * @param[in]  blk_size  Bytes of packet data per block, headroom included.
+ * @param[in]  headroom  Headroom of a freshly allocated packet.
+ * @param[in]  flags     0, PKT_POOL_MT or PKT_POOL_SHARED.
+ *
+ * @return     The pool, or NULL on failure.
+ */
+pkt_pool_t *pkt_pool_create(uint32_t nblks, uint32_t blk_size,
+                            uint32_t headroom, uint32_t flags)
+{
+    uint64_t nbufs = (uint64_t)nblks * PKT_POOL_DESCS_PER_BLK;
+    pthread_mutexattr_t mattr;
+    pkt_pool_t *pool;
+    size_t blk_stride, blks_size;
+    uint64_t i;
+
+    if (!nblks || !blk_size || headroom > blk_size || nbufs > UINT32_MAX)
+        return NULL;
+
+    blk_stride = (sizeof(pkt_blk_t) + blk_size + PKT_BLK_ALIGN - 1) &
+                 ~(size_t)(PKT_BLK_ALIGN - 1);
+    blks_size = nblks * blk_stride;
+    if (flags & PKT_POOL_SHARED) {
+        pool = pkt_pool_map_shared(nbufs, blks_size);
+        flags |= PKT_POOL_MT;
+    } else {
+        pool = pkt_pool_alloc_private(nbufs, blks_size);
+    }
+    if (!pool)
+        return NULL;
+
+    pool->blk_size = blk_size;
+    pool->headroom = headroom;
+    pool->flags = flags;
+    pool->blk_stride = blk_stride;
+    pthread_mutexattr_init(&mattr);
+    if (flags & PKT_POOL_SHARED)
+        pthread_mutexattr_setpshared(&mattr, PTHREAD_PROCESS_SHARED);
+    pthread_mutex_init(&pool->lock, &mattr);
+    pthread_mutexattr_destroy(&mattr);
+    init_glthread(&pool->free_bufs, offset(pkt_buf_t, glue));
+    init_glthread(&pool->free_blks, offset(pkt_blk_t, glue));
+
+    // Pushed in reverse so that the first allocations walk memory forwards
+    for (i = nbufs; i-- > 0; ) {
+        pool->bufs[i].pool = pool;
+        glthread_node_init((&pool->bufs[i].glue));
+        glthread_add(&pool->free_bufs, &pool->bufs[i].glue);
+    }
+    for (i = nblks; i-- > 0; ) {
+        pkt_blk_t *blk = pkt_blk_at(pool, (uint32_t)i);
+
+        blk->refcnt = 0;
+        glthread_node_init((&blk->glue));
+        glthread_add(&pool->free_blks, &blk->glue);
+    }
+    pool->nfree_bufs = (uint32_t)nbufs;
+    pool->nfree_blks = nblks;
+    pool->nblks = nblks;
+
+    return pool;
+}
+
+/**
+ * @brief      Frees a pool.
+ *
+ * @param[in]  pool  Pool to free, may be NULL.
+ */
+void pkt_pool_destroy(pkt_pool_t *pool)
+{
+    if (!pool)
+        return;
+
+    pthread_mutex_destroy(&pool->lock);
+    if (pool->map_size) {
+        munmap(pool, pool->map_size);
+        return;
+    }
+    free(pool->bufs);
+    free(pool->blks);
+    free(pool);
+}
+
+/**
+ * @brief      Sets up a descriptor as a packet of one segment.
+ *
+ * @param[in]  seg   Descriptor.
+ * @param[in]  blk   Block holding the bytes, with a reference for seg.
+ * @param[in]  data  First byte.
+ * @param[in]  len   Bytes.
+ */
+static inline void pkt_seg_init(pkt_buf_t *seg, pkt_blk_t *blk,
+                                unsigned char *data, uint32_t len)
+{
+    seg->blk = blk;
+    seg->data = data;
+    seg->len = len;
+    seg->pkt_len = len;
+    glthread_node_init((&seg->seg_glue));
+    seg->last = seg;
+    seg->nsegs = 1;
+}
+
+/**
+ * @brief      Allocates an empty packet with the pool's default headroom.
+ *
+ * @param[in]  pool  Pool to allocate from.
+ *
+ * @return     The packet, or NULL when the pool is exhausted.
+ */
+pkt_buf_t *pkt_buf_alloc(pkt_pool_t *pool)
+{
+    pkt_blk_t *blk = NULL;
+    pkt_buf_t *pkt = pkt_pool_take(pool, 1, &blk);
+
+    if (!pkt)
+        return NULL;
+
+    blk->refcnt = 1;
+    pkt_seg_init(pkt, blk, blk->data + pool->headroom, 0);
+    return pkt;
+}
+
+/**
+ * @brief      Allocates a packet of len bytes in as many segments as it takes.
+ *
+ * @param[in]  pool  Pool to allocate from.
+ * @param[in]  len   Bytes in the packet.
+ *
+ * @return     The packet, or NULL when the pool is exhausted.
+ */
+pkt_buf_t *pkt_buf_alloc_len(pkt_pool_t *pool, uint32_t len)
+{
+    pkt_buf_t *pkt = pkt_buf_alloc(pool), *seg;
+    uint32_t n;
+
+    if (!pkt)
+        return NULL;
+
+    n = len < pkt_buf_tailroom(pkt) ? len : pkt_buf_tailroom(pkt);
+    pkt_buf_put(pkt, n);
+    len -= n;
+
+    while (len) {
+        seg = pkt_buf_alloc(pool);
+        if (!seg) {
+            pkt_buf_free(pkt);
+            return NULL;
+        }
+        n = len < pool->blk_size ? len : pool->blk_size;
+        pkt_seg_init(seg, seg->blk, seg->blk->data, n);
+        pkt_buf_append(pkt, seg);
+        len -= n;
+    }
+    return pkt;
+}
+
+/**
+ * @brief      Allocates up to n empty packets, taking the pool lock once.
+ *
+ * @param[in]  pool  Pool to allocate from.
+ * @param[out] pkts  The packets.
+ * @param[in]  n     Packets wanted.
+ *
+ * @return     The number of packets allocated.
+ */
+uint32_t pkt_buf_alloc_bulk(pkt_pool_t *pool, pkt_buf_t **pkts, uint32_t n)
+{
+    pkt_blk_t *blk;
+    uint32_t i;
+
+    pkt_pool_lock(pool);
+    if (n > pool->nfree_bufs)
+        n = pool->nfree_bufs;
+    if (n > pool->nfree_blks)
+        n = pool->nfree_blks;
+    for (i = 0; i < n; i++) {
+        pkts[i] = PKT_BUF_FROM_GLUE(pkt_pool_pop(&pool->free_bufs));
+        blk = GLTHREAD_GET_USER_DATA_FROM_OFFSET(
+            pkt_pool_pop(&pool->free_blks), offset(pkt_blk_t, glue));
+        blk->refcnt = 1;
+        pkt_seg_init(pkts[i], blk, blk->data + pool->headroom, 0);
+    }
+    pool->nfree_bufs -= n;
+    pool->nfree_blks -= n;
+    pkt_pool_unlock(pool);
+
+    return n;
+}
+
+/**
+ * @brief      Frees every segment of a packet, and their blocks when no clone
+ *             still uses them.
+ *
+ * @param[in]  pkt  Packet to free, may be NULL.
+ */
+void pkt_buf_free(pkt_buf_t *pkt)
+{
+    pkt_pool_t *pool;
+    pkt_buf_t *seg;
+
+    if (!pkt)
+        return;
+
+    pool = pkt->pool;
+    pkt_pool_lock(pool);
+    ITERATE_PKT_SEGS_BEGIN(pkt, seg) {
+        if (pkt_blk_put(pool, seg->blk) == 0) {
+            glthread_add(&pool->free_blks, &seg->blk->glue);
+            pool->nfree_blks++;
+        }
+        glthread_add(&pool->free_bufs, &seg->glue);
+        pool->nfree_bufs++;
+    } ITERATE_PKT_SEGS_ENDS;
+    pkt_pool_unlock(pool);
+}
+
+/**
+ * @brief      Creates a packet sharing the bytes of every segment of pkt.
+ *
+ * @param[in]  pkt  Packet to clone.
+ *
+ * @return     The clone, or NULL when the pool has no free descriptor.
+ */
+pkt_buf_t *pkt_buf_clone(pkt_buf_t *pkt)
+{
+    pkt_buf_t *clone = NULL, *seg, *c;
+
+    ITERATE_PKT_SEGS_BEGIN(pkt, seg) {
+        c = pkt_pool_take(pkt->pool, 0, NULL);
+        if (!c) {
+            pkt_buf_free(clone);
+            return NULL;
+        }
+        pkt_blk_get(pkt->pool, seg->blk);
+        pkt_seg_init(c, seg->blk, seg->data, seg->len);
+        if (clone)
+            pkt_buf_append(clone, c);
+        else
+            clone = c;
+    } ITERATE_PKT_SEGS_ENDS;
+
+    return clone;
+}
+
+/**
+ * @brief      Creates a packet with its own copy of the bytes of pkt.
+ *
+ * @param[in]  pkt  Packet to copy.
+ *
+ * @return     The copy, or NULL when the pool is exhausted.
+ */
+pkt_buf_t *pkt_buf_copy(pkt_buf_t *pkt)
+{
+    pkt_buf_t *copy = NULL, *seg, *c;
+    pkt_blk_t *blk = NULL;
+
+    ITERATE_PKT_SEGS_BEGIN(pkt, seg) {
+        c = pkt_pool_take(pkt->pool, 1, &blk);
+        if (!c) {
+            pkt_buf_free(copy);
+            return NULL;
+        }
+        blk->refcnt = 1;
+        pkt_seg_init(c, blk, blk->data + pkt_buf_headroom(seg), seg->len);
+        memcpy(c->data, seg->data, seg->len);
+        if (copy)
+            pkt_buf_append(copy, c);
+        else
+            copy = c;
+    } ITERATE_PKT_SEGS_ENDS;
+
+    return copy;
+}
+
+/**
+ * @brief      Gives one segment its own block if it shares one.
+ *
+ * @param[in]  seg  Segment.
+ *
+ * @return     0 on success, -1 when the pool has no free block.
+ */
+static int pkt_seg_make_writable(pkt_buf_t *seg)
+{
+    pkt_pool_t *pool = seg->pool;
+    pkt_blk_t *blk = NULL;
+    glthread_node_t *node;
+    unsigned char *data;
+
+    if (!pkt_buf_is_shared(seg))
+        return 0;
+
+    pkt_pool_lock(pool);
+    node = pkt_pool_pop(&pool->free_blks);
+    if (node)
+        pool->nfree_blks--;
+    pkt_pool_unlock(pool);
+    if (!node)
+        return -1;
+
+    blk = GLTHREAD_GET_USER_DATA_FROM_OFFSET(node, offset(pkt_blk_t, glue));
+    blk->refcnt = 1;
+    data = blk->data + pkt_buf_headroom(seg);
+    memcpy(data, seg->data, seg->len);
+
+    // Another holder may have dropped its reference since the check above,
+    // in which case this one is the last and the old block goes back
+    if (pkt_blk_put(pool, seg->blk) == 0) {
+        pkt_pool_lock(pool);
+        glthread_add(&pool->free_blks, &seg->blk->glue);
+        pool->nfree_blks++;
+        pkt_pool_unlock(pool);
+    }
+    seg->blk = blk;
+    seg->data = data;
+    return 0;
+}
+
+/**
+ * @brief      Gives every segment of pkt its own block if it shares one.
+ *
+ * @param[in]  pkt  Packet.
+ *
+ * @return     0 on success, -1 when the pool has no free block.
+ */
+int pkt_buf_make_writable(pkt_buf_t *pkt)
+{
+    pkt_buf_t *seg;
+
+    ITERATE_PKT_SEGS_BEGIN(pkt, seg) {
+        if (pkt_seg_make_writable(seg) < 0)
+            return -1;
+    } ITERATE_PKT_SEGS_ENDS;
+
+    return 0;
+}
+
+/**
+ * @brief      Links the segments of seg after those of pkt, without copying.
+ *
+ * @param[in]  pkt  Packet to extend.
+ * @param[in]  seg  Packet to append.
+ */
+void pkt_buf_append(pkt_buf_t *pkt, pkt_buf_t *seg)
+{
+    glthread_add_next(&pkt->last->seg_glue, &seg->seg_glue);
+    pkt->last = seg->last;
+    pkt->pkt_len += seg->pkt_len;
+    pkt->nsegs += seg->nsegs;
+}
+
+/**
+ * @brief      Shrinks the packet at the end to len bytes, freeing the segments
+ *             past it.
+ *
+ * @param[in]  pkt  Packet.
+ * @param[in]  len  New length.
+ */
+void pkt_buf_trim(pkt_buf_t *pkt, uint32_t len)
+{
+    pkt_buf_t *seg, *rest;
+    uint32_t nsegs = 0;
+
+    if (len >= pkt->pkt_len)
+        return;
+
+    pkt->pkt_len = len;
+    ITERATE_PKT_SEGS_BEGIN(pkt, seg) {
+        nsegs++;
+        if (len <= seg->len)
+            break;
+        len -= seg->len;
+    } ITERATE_PKT_SEGS_ENDS;
+
+    seg->len = len;
+    rest = PKT_BUF_FROM_SEG_GLUE(seg->seg_glue.right);
+    if (rest) {
+        seg->seg_glue.right = NULL;
+        rest->seg_glue.left = NULL;
+        pkt_buf_free(rest);
+    }
+    pkt->last = seg;
+    pkt->nsegs = nsegs;
+}
+
+/**
+ * @brief      Makes the first len bytes of the packet contiguous in the first
+ *             segment.
+ *
+ * @param[in]  pkt  Packet.
+ * @param[in]  len  Bytes needed.
+ *
+ * @return     The first byte, or NULL on failure.
+ */
+unsigned char *pkt_buf_may_pull(pkt_buf_t *pkt, uint32_t len)
+{
+    pkt_buf_t *seg, *next;
+    uint32_t need, n;
+
+    if (len <= pkt->len)
+        return pkt->data;
+    if (len > pkt->pkt_len)
+        return NULL;
+
+    need = len - pkt->len;
+    if (need > pkt_buf_tailroom(pkt) || pkt_seg_make_writable(pkt) < 0)
+        return NULL;
+
+    // Bytes are moved from the front of the next segment, which is unlinked
+    // and freed once it is empty, so it is always the one after pkt
+    while (need) {
+        seg = PKT_BUF_FROM_SEG_GLUE(pkt->seg_glue.right);
+        n = need < seg->len ? need : seg->len;
+        memcpy(pkt->data + pkt->len, seg->data, n);
+        pkt->len += n;
+        seg->data += n;
+        seg->len -= n;
+        need -= n;
+
+        if (seg->len)
+            continue;
+
+        next = PKT_BUF_FROM_SEG_GLUE(seg->seg_glue.right);
+        pkt->seg_glue.right = seg->seg_glue.right;
+        if (next)
+            next->seg_glue.left = &pkt->seg_glue;
+        else
+            pkt->last = pkt;
+        pkt->nsegs--;
+        glthread_node_init((&seg->seg_glue));
+        pkt_buf_free(seg);
+    }
+    return pkt->data;
+}
+
+/**
+ * @brief      Describes the segments of the packet as an iovec.
+ *
+ * @param[in]  pkt  Packet.
+ * @param[out] iov  One entry per segment.
+ * @param[in]  max  Entries in iov.
+ *
+ * @return     The number of entries, or -1 when there are more than max.
+ */
+int pkt_buf_to_iovec(const pkt_buf_t *pkt, struct iovec *iov, int max)
+{
+    pkt_buf_t *seg;
+    int n = 0;
+
+    if ((int)pkt->nsegs > max)
+        return -1;
+
+    ITERATE_PKT_SEGS_BEGIN((pkt_buf_t *)pkt, seg) {
+        iov[n].iov_base = seg->data;
+        iov[n].iov_len = seg->len;
+        n++;
+    } ITERATE_PKT_SEGS_ENDS;
+
+    return n;
+}
+
+#endif    // PKT_BUF_C
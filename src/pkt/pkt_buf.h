@@ -0,0 +1,462 @@
+/* -----------------------------------------------------------------------------
+ * @file:        pkt_buf.h
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        21/10/2026 09:00 AM
+ * @license:     MIT
+ * @description: This header file declares pooled packet buffers. A packet is a
+ *               descriptor (pkt_buf_t) pointing into a data block
+ *               (pkt_blk_t). The packet starts some headroom bytes into the
+ *               block so that lower layer headers are prepended by moving the
+ *               data pointer back (push) and stripped by moving it forward
+ *               (pull), with no memmove. Clones are descriptors sharing a
+ *               block, which is reference counted; a clone must be made
+ *               writable before its bytes are changed. Descriptors embed a
+ *               glthread_node_t so that packets can be queued on glthreads.
+ *               Descriptors and blocks come from fixed free lists in a pool.
+ *               A packet larger than a block, e.g. a jumbo frame or a
+ *               reassembled datagram, is a chain of segments linked through
+ *               a second glthread_node_t; headers are read from the first
+ *               segment and the chain is handed to sockets as an iovec, so
+ *               the packet is never linearized. A PKT_POOL_SHARED pool
+ *               lives in one shared memfd mapping, so processes forked after
+ *               it is created see every descriptor and block at the same
+ *               address and may pass packets between them by pointer.
+ *               The contents are organized into three groups:
+ *
+ *                 1. Structs:
+ *                    - struct pkt_blk_t
+ *                    - struct pkt_buf_t
+ *                    - struct pkt_pool_t
+ *
+ *                 2. Functions:
+ *                    - pkt_pool_create
+ *                    - pkt_pool_destroy
+ *                    - pkt_buf_alloc
+ *                    - pkt_buf_alloc_len
+ *                    - pkt_buf_alloc_bulk
+ *                    - pkt_buf_free
+ *                    - pkt_buf_clone
+ *                    - pkt_buf_copy
+ *                    - pkt_buf_make_writable
+ *                    - pkt_buf_append
+ *                    - pkt_buf_trim
+ *                    - pkt_buf_may_pull
+ *                    - pkt_buf_to_iovec
+ *                    - pkt_buf_push
+ *                    - pkt_buf_pull
+ *                    - pkt_buf_put
+ *                    - pkt_buf_headroom
+ *                    - pkt_buf_tailroom
+ *                    - pkt_buf_is_shared
+ *
+ *                 3. Macros:
+ *                    - PKT_POOL_MT
+ *                    - PKT_POOL_SHARED
+ *                    - PKT_POOL_DESCS_PER_BLK
+ *                    - PKT_BUF_FROM_GLUE
+ *                    - PKT_BUF_FROM_SEG_GLUE
+ *                    - ITERATE_PKT_SEGS_BEGIN
+ *                    - ITERATE_PKT_SEGS_ENDS
+ *
+ * @note:        This code is part of the tcpip-stack project, which is a course
+ *               on network development.
+ *
+ * Revision History:
+ *
+ * Revision 0.1: 21/10/2026 Marko Trickovic
+ * Initial version with headroom, clones and pooled free lists.
+ *
+ * Revision 0.2: 21/10/2026 Marko Trickovic
+ * Added segment chains for packets larger than a block, with iovec export,
+ * copy-free append and trim, and pkt_buf_may_pull for split headers.
+ *
+ * Revision 0.3: 21/10/2026 Marko Trickovic
+ * Added pkt_buf_alloc_bulk for batched receive.
+ *
+ * Revision 0.4: 21/10/2026 Marko Trickovic
+ * Added nblks to pkt_pool_t so the block region can be registered with the
+ * kernel.
+ *
+ * Revision 0.5: 21/10/2026 Marko Trickovic
+ * Added PKT_POOL_SHARED for pools shared between forked processes.
+ *
+ * Revision 0.6: 21/10/2026 Marko Trickovic
+ * Added a time stamp to pkt_buf_t.
+ *
+ * Revision 0.7: 21/10/2026 Marko Trickovic
+ * Added the interface, adjacency and VLAN fields a forwarding path sets.
+ */
+
+#ifndef PKT_BUF_H
+#define PKT_BUF_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/uio.h>
+#include "../glthreads/glthreads.h"
+
+/** Pool flag: buffers are allocated, freed and cloned from several threads. */
+#define PKT_POOL_MT             0x1
+
+/**
+ * Pool flag: the pool, its descriptors and its blocks are one MAP_SHARED
+ * memfd mapping with a process-shared lock, for processes forked after the
+ * pool is created. Implies PKT_POOL_MT.
+ */
+#define PKT_POOL_SHARED         0x2
+
+/** Descriptors per data block in a pool, leaving room for clones. */
+#define PKT_POOL_DESCS_PER_BLK  4
+
+struct pkt_pool_;
+
+/**
+ * @brief      The structure representing a data block. The header takes one
+ *             cache line so that data is cache-line aligned.
+ *
+ * @struct                pkt_blk_t
+ *
+ * @param[in]  glue       Glue onto the pool's free list.
+ * @param[in]  refcnt     Descriptors pointing into the block.
+ * @param[in]  data       Packet bytes, pool->blk_size of them.
+ */
+typedef struct pkt_blk_ {
+    glthread_node_t glue;
+    uint32_t refcnt;
+    unsigned char pad[64 - sizeof(glthread_node_t) - sizeof(uint32_t)];
+    unsigned char data[];
+} pkt_blk_t;
+
+/**
+ * @brief      The structure representing a packet, or one segment of it. The
+ *             first segment stands for the whole packet; pkt_len, last and
+ *             nsegs are only kept up to date there.
+ *
+ * @struct                pkt_buf_t
+ *
+ * @param[in]  glue       Glue for queueing the packet, or onto the pool's free
+ *                        list while free.
+ * @param[in]  data       First byte of the segment.
+ * @param[in]  len        Bytes in the segment.
+ * @param[in]  pkt_len    Bytes in the whole packet.
+ * @param[in]  blk        Block holding the bytes.
+ * @param[in]  pool       Pool the descriptor and block came from.
+ * @param[in]  seg_glue   Links the segments in order, first segment first.
+ * @param[in]  last       Last segment, the packet itself when it has one.
+ * @param[in]  nsegs      Number of segments.
+ * @param[in]  tstamp     Time in ns for whoever holds the packet, e.g. when
+ *                        a delayed frame is due; not set by the pool.
+ * @param[in]  rx_ifindex Interface the packet came in by.
+ * @param[in]  tx_ifindex Interface the packet leaves by.
+ * @param[in]  adj_index  Adjacency the route lookup chose.
+ * @param[in]  vlan       VLAN the packet belongs to, 0 for none. The
+ *                        forwarding fields are not set by the pool either.
+ */
+typedef struct pkt_buf_ {
+    glthread_node_t glue;
+    unsigned char *data;
+    uint32_t len;
+    uint32_t pkt_len;
+    pkt_blk_t *blk;
+    struct pkt_pool_ *pool;
+    glthread_node_t seg_glue;
+    struct pkt_buf_ *last;
+    uint32_t nsegs;
+    uint64_t tstamp;
+    uint32_t rx_ifindex;
+    uint32_t tx_ifindex;
+    uint32_t adj_index;
+    uint16_t vlan;
+} pkt_buf_t;
+
+/**
+ * @brief      The structure representing a pool of descriptors and blocks.
+ *
+ * @struct                pkt_pool_t
+ *
+ * @param[in]  free_bufs   Free descriptors.
+ * @param[in]  free_blks   Free blocks.
+ * @param[in]  nfree_bufs  Number of free descriptors.
+ * @param[in]  nfree_blks  Number of free blocks.
+ * @param[in]  blk_size    Bytes of packet data per block.
+ * @param[in]  headroom    Headroom of a freshly allocated packet.
+ * @param[in]  flags       PKT_POOL_* flags.
+ * @param[in]  lock        Protects the free lists with PKT_POOL_MT.
+ * @param[in]  bufs        Descriptor storage.
+ * @param[in]  blks        Block storage.
+ * @param[in]  blk_stride  Bytes from one block to the next.
+ * @param[in]  nblks       Blocks in blks.
+ * @param[in]  map_size    Bytes of the mapping holding a PKT_POOL_SHARED
+ *                         pool, 0 otherwise.
+ */
+typedef struct pkt_pool_ {
+    glthread_t free_bufs;
+    glthread_t free_blks;
+    uint32_t nfree_bufs;
+    uint32_t nfree_blks;
+    uint32_t blk_size;
+    uint32_t headroom;
+    uint32_t flags;
+    pthread_mutex_t lock;
+    pkt_buf_t *bufs;
+    unsigned char *blks;
+    size_t blk_stride;
+    uint32_t nblks;
+    size_t map_size;
+} pkt_pool_t;
+
+/**
+ * @brief      Retrieves the packet from a pointer to its glue.
+ *
+ * @param[in]  nodeptr  Pointer to pkt_buf_t.glue.
+ */
+#define PKT_BUF_FROM_GLUE(nodeptr)  \
+    ((pkt_buf_t *)GLTHREAD_GET_USER_DATA_FROM_OFFSET(nodeptr, offset(pkt_buf_t, glue)))
+
+/**
+ * @brief      Retrieves the segment from a pointer to its seg_glue.
+ *
+ * @param[in]  nodeptr  Pointer to pkt_buf_t.seg_glue, may be NULL.
+ */
+#define PKT_BUF_FROM_SEG_GLUE(nodeptr)  \
+    ((nodeptr) ? (pkt_buf_t *)GLTHREAD_GET_USER_DATA_FROM_OFFSET(nodeptr, \
+                     offset(pkt_buf_t, seg_glue)) : NULL)
+
+/**
+ * @brief      Macro to iterate over the segments of a packet in order. The
+ *             current segment may be freed in the body.
+ *
+ * @param[in]  pktptr  Pointer to the packet.
+ * @param[out] segptr  Pointer to each segment.
+ */
+#define ITERATE_PKT_SEGS_BEGIN(pktptr, segptr)                            \
+{                                                                         \
+    pkt_buf_t *_next_seg = NULL;                                          \
+    for (segptr = (pktptr); segptr; segptr = _next_seg) {                 \
+        _next_seg = PKT_BUF_FROM_SEG_GLUE(segptr->seg_glue.right);
+#define ITERATE_PKT_SEGS_ENDS }}
+
+/**
+ * @brief      Creates a pool.
+ *
+ * @param[in]  nblks     Number of data blocks; the pool has
+ *                       PKT_POOL_DESCS_PER_BLK times as many descriptors.
+ * @param[in]  blk_size  Bytes of packet data per block, headroom included.
+ * @param[in]  headroom  Headroom of a freshly allocated packet.
+ * @param[in]  flags     0, PKT_POOL_MT or PKT_POOL_SHARED.
+ *
+ * @return     The pool, or NULL when out of memory or headroom > blk_size.
+ */
+pkt_pool_t *pkt_pool_create(uint32_t nblks, uint32_t blk_size,
+                            uint32_t headroom, uint32_t flags);
+
+/**
+ * @brief      Frees a pool. Every packet must have been freed.
+ *
+ * @param[in]  pool  Pool to free, may be NULL.
+ */
+void pkt_pool_destroy(pkt_pool_t *pool);
+
+/**
+ * @brief      Allocates an empty packet with the pool's default headroom.
+ *
+ * @param[in]  pool  Pool to allocate from.
+ *
+ * @return     The packet, or NULL when the pool is exhausted.
+ */
+pkt_buf_t *pkt_buf_alloc(pkt_pool_t *pool);
+
+/**
+ * @brief      Allocates a packet of len bytes with the pool's default headroom,
+ *             in as many segments as it takes, e.g. to receive into through
+ *             pkt_buf_to_iovec. Segments after the first have no headroom.
+ *
+ * @param[in]  pool  Pool to allocate from.
+ * @param[in]  len   Bytes in the packet.
+ *
+ * @return     The packet, or NULL when the pool is exhausted.
+ */
+pkt_buf_t *pkt_buf_alloc_len(pkt_pool_t *pool, uint32_t len);
+
+/**
+ * @brief      Allocates up to n empty packets with the pool's default
+ *             headroom, taking the pool lock once.
+ *
+ * @param[in]  pool  Pool to allocate from.
+ * @param[out] pkts  The packets.
+ * @param[in]  n     Packets wanted.
+ *
+ * @return     The number of packets allocated, fewer than n when the pool
+ *             runs out.
+ */
+uint32_t pkt_buf_alloc_bulk(pkt_pool_t *pool, pkt_buf_t **pkts, uint32_t n);
+
+/**
+ * @brief      Frees every segment of a packet, and their blocks when no clone
+ *             still uses them. The packet must not be on any glthread.
+ *
+ * @param[in]  pkt  Packet to free, may be NULL.
+ */
+void pkt_buf_free(pkt_buf_t *pkt);
+
+/**
+ * @brief      Creates a packet sharing the bytes of every segment of pkt.
+ *
+ * @param[in]  pkt  Packet to clone.
+ *
+ * @return     The clone, or NULL when the pool has no free descriptor.
+ */
+pkt_buf_t *pkt_buf_clone(pkt_buf_t *pkt);
+
+/**
+ * @brief      Creates a packet with its own copy of the bytes of pkt, with the
+ *             same segments and headroom.
+ *
+ * @param[in]  pkt  Packet to copy.
+ *
+ * @return     The copy, or NULL when the pool is exhausted.
+ */
+pkt_buf_t *pkt_buf_copy(pkt_buf_t *pkt);
+
+/**
+ * @brief      Gives every segment of pkt its own block if it shares one, so
+ *             that its bytes, headroom and tailroom may be written.
+ *
+ * @param[in]  pkt  Packet.
+ *
+ * @return     0 on success, -1 when the pool has no free block.
+ */
+int pkt_buf_make_writable(pkt_buf_t *pkt);
+
+/**
+ * @brief      Links the segments of seg after those of pkt, without copying.
+ *             seg is part of pkt afterwards and must not be used on its own.
+ *
+ * @param[in]  pkt  Packet to extend.
+ * @param[in]  seg  Packet to append, not on any glthread.
+ */
+void pkt_buf_append(pkt_buf_t *pkt, pkt_buf_t *seg);
+
+/**
+ * @brief      Shrinks the packet at the end to len bytes, freeing the segments
+ *             past it; does nothing when it is not longer than that.
+ *
+ * @param[in]  pkt  Packet.
+ * @param[in]  len  New length.
+ */
+void pkt_buf_trim(pkt_buf_t *pkt, uint32_t len);
+
+/**
+ * @brief      Makes the first len bytes of the packet contiguous in the first
+ *             segment, moving bytes over from the next segments only when the
+ *             headers are split across them.
+ *
+ * @param[in]  pkt  Packet.
+ * @param[in]  len  Bytes needed.
+ *
+ * @return     The first byte, or NULL when the packet is shorter than len, or
+ *             the first segment has too little tailroom or cannot be made
+ *             writable.
+ */
+unsigned char *pkt_buf_may_pull(pkt_buf_t *pkt, uint32_t len);
+
+/**
+ * @brief      Describes the segments of the packet as an iovec.
+ *
+ * @param[in]  pkt  Packet.
+ * @param[out] iov  One entry per segment.
+ * @param[in]  max  Entries in iov.
+ *
+ * @return     The number of entries, or -1 when the packet has more than max
+ *             segments.
+ */
+int pkt_buf_to_iovec(const pkt_buf_t *pkt, struct iovec *iov, int max);
+
+/**
+ * @brief      Returns the bytes available in front of the packet.
+ */
+static inline uint32_t pkt_buf_headroom(const pkt_buf_t *pkt)
+{
+    return (uint32_t)(pkt->data - pkt->blk->data);
+}
+
+/**
+ * @brief      Returns the bytes available after the segment.
+ */
+static inline uint32_t pkt_buf_tailroom(const pkt_buf_t *pkt)
+{
+    return pkt->pool->blk_size - pkt_buf_headroom(pkt) - pkt->len;
+}
+
+/**
+ * @brief      Tells whether the packet's block is shared with a clone.
+ */
+static inline int pkt_buf_is_shared(const pkt_buf_t *pkt)
+{
+    return __atomic_load_n(&pkt->blk->refcnt, __ATOMIC_RELAXED) > 1;
+}
+
+/**
+ * @brief      Grows the packet at the front, e.g. to prepend a header.
+ *
+ * @param[in]  pkt  Packet, first segment not shared.
+ * @param[in]  len  Bytes to add.
+ *
+ * @return     The new first byte, or NULL when the headroom is too small.
+ */
+static inline unsigned char *pkt_buf_push(pkt_buf_t *pkt, uint32_t len)
+{
+    if (len > pkt_buf_headroom(pkt))
+        return NULL;
+
+    pkt->data -= len;
+    pkt->len += len;
+    pkt->pkt_len += len;
+    return pkt->data;
+}
+
+/**
+ * @brief      Shrinks the packet at the front, e.g. to strip a header. Only
+ *             bytes of the first segment can be removed, see pkt_buf_may_pull.
+ *
+ * @param[in]  pkt  Packet.
+ * @param[in]  len  Bytes to remove.
+ *
+ * @return     The new first byte, or NULL when the first segment is shorter
+ *             than len.
+ */
+static inline unsigned char *pkt_buf_pull(pkt_buf_t *pkt, uint32_t len)
+{
+    if (len > pkt->len)
+        return NULL;
+
+    pkt->data += len;
+    pkt->len -= len;
+    pkt->pkt_len -= len;
+    return pkt->data;
+}
+
+/**
+ * @brief      Grows the packet at the end, e.g. to append payload.
+ *
+ * @param[in]  pkt  Packet, last segment not shared.
+ * @param[in]  len  Bytes to add.
+ *
+ * @return     The first added byte, or NULL when the tailroom of the last
+ *             segment is too small.
+ */
+static inline unsigned char *pkt_buf_put(pkt_buf_t *pkt, uint32_t len)
+{
+    pkt_buf_t *last = pkt->last;
+    unsigned char *tail = last->data + last->len;
+
+    if (len > pkt_buf_tailroom(last))
+        return NULL;
+
+    last->len += len;
+    pkt->pkt_len += len;
+    return tail;
+}
+
+#endif    // PKT_BUF_H
@@ -0,0 +1,139 @@
+/******************************************************************************
+ * @file:        pkt_queue.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        21/10/2026 11:00 AM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the packet queue operations. The tail is
+ *               linked with glthread_add_after, and the head is unlinked by
+ *               hand rather than through glthread_remove since the node is
+ *               known to be first; the GLTHREAD_STATS hooks keep the list
+ *               length for both and for splices.
+ *
+ *               Functions in this file:
+ *                 - pkt_queue_init
+ *                 - pkt_queue_push
+ *                 - pkt_queue_pop
+ *                 - pkt_queue_splice
+ *                 - pkt_queue_flush
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 21/10/2026 Marko Trickovic
+ * Initial version.
+ *
+ * Revision 0.2: 21/10/2026 Marko Trickovic
+ * The list length of GLTHREAD_STATS builds follows the queue.
+ *****************************************************************************/
+
+#ifndef PKT_QUEUE_C
+#define PKT_QUEUE_C
+
+#include "pkt_queue.h"
+#include "../glthreads/glthreads_stats.h"
+
+/**
+ * @brief      Initializes an empty queue.
+ *
+ * @param[in]  q      Queue.
+ * @param[in]  limit  Most packets queued at once.
+ */
+void pkt_queue_init(pkt_queue_t *q, uint32_t limit)
+{
+    init_glthread(&q->lst, offset(pkt_buf_t, glue));
+    q->tail = NULL;
+    q->count = 0;
+    q->limit = limit;
+    q->drops = 0;
+}
+
+/**
+ * @brief      Adds a packet at the tail.
+ *
+ * @param[in]  q    Queue.
+ * @param[in]  pkt  Packet.
+ *
+ * @return     0 on success, -1 when the queue is full.
+ */
+int pkt_queue_push(pkt_queue_t *q, pkt_buf_t *pkt)
+{
+    if (q->count >= q->limit) {
+        q->drops++;
+        return -1;
+    }
+
+    glthread_add_after(&q->lst, q->tail, &pkt->glue);
+    q->tail = &pkt->glue;
+    q->count++;
+    return 0;
+}
+
+/**
+ * @brief      Removes the packet at the head.
+ *
+ * @param[in]  q  Queue.
+ *
+ * @return     The packet, or NULL when the queue is empty.
+ */
+pkt_buf_t *pkt_queue_pop(pkt_queue_t *q)
+{
+    glthread_node_t *node = q->lst.head;
+
+    if (!node)
+        return NULL;
+
+    q->lst.head = node->right;
+    if (node->right)
+        node->right->left = NULL;
+    else
+        q->tail = NULL;
+    node->right = NULL;
+    q->count--;
+    GLTHREAD_STATS_LIST_DEC(&q->lst);
+    return PKT_BUF_FROM_GLUE(node);
+}
+
+/**
+ * @brief      Moves every packet of src to the tail of dst.
+ *
+ * @param[in]  dst  Queue to extend.
+ * @param[in]  src  Queue to empty.
+ */
+void pkt_queue_splice(pkt_queue_t *dst, pkt_queue_t *src)
+{
+    if (!src->lst.head)
+        return;
+
+    if (dst->tail) {
+        dst->tail->right = src->lst.head;
+        src->lst.head->left = dst->tail;
+    } else {
+        dst->lst.head = src->lst.head;
+    }
+    dst->tail = src->tail;
+    dst->count += src->count;
+    GLTHREAD_STATS_LIST_ADD(&dst->lst, src->count);
+    GLTHREAD_STATS_LIST_SUB(&src->lst, src->count);
+
+    src->lst.head = NULL;
+    src->tail = NULL;
+    src->count = 0;
+}
+
+/**
+ * @brief      Frees every packet in the queue.
+ *
+ * @param[in]  q  Queue.
+ */
+void pkt_queue_flush(pkt_queue_t *q)
+{
+    pkt_buf_t *pkt;
+
+    while ((pkt = pkt_queue_pop(q)))
+        pkt_buf_free(pkt);
+}
+
+#endif    // PKT_QUEUE_C
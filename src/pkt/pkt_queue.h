@@ -0,0 +1,119 @@
+/* -----------------------------------------------------------------------------
+ * @file:        pkt_queue.h
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        21/10/2026 11:00 AM
+ * @license:     MIT
+ * @description: This header file declares the packet queue, a FIFO of
+ *               pkt_buf_t linked through their glue. The glthread keeps the
+ *               head; the queue adds a tail pointer so that enqueue,
+ *               dequeue and splicing a whole queue onto another are all
+ *               O(1). A queue may be bounded, in which case packets beyond
+ *               the limit are refused and counted as drops. Queues are not
+ *               locked; callers sharing one between threads lock around it.
+ *               The contents are organized into three groups:
+ *
+ *                 1. Structs:
+ *                    - struct pkt_queue_t
+ *
+ *                 2. Functions:
+ *                    - pkt_queue_init
+ *                    - pkt_queue_push
+ *                    - pkt_queue_pop
+ *                    - pkt_queue_splice
+ *                    - pkt_queue_flush
+ *                    - pkt_queue_empty
+ *
+ *                 3. Macros:
+ *                    - PKT_QUEUE_UNBOUNDED
+ *
+ * @note:        This code is part of the tcpip-stack project, which is a course
+ *               on network development.
+ *
+ * Revision History:
+ *
+ * Revision 0.1: 21/10/2026 Marko Trickovic
+ * Initial version.
+ */
+
+#ifndef PKT_QUEUE_H
+#define PKT_QUEUE_H
+
+#include <stdint.h>
+#include "pkt_buf.h"
+
+/** Limit of a queue that never refuses a packet. */
+#define PKT_QUEUE_UNBOUNDED     UINT32_MAX
+
+/**
+ * @brief      The structure representing a packet queue.
+ *
+ * @struct                pkt_queue_t
+ *
+ * @param[in]  lst        Packets, oldest at the head.
+ * @param[in]  tail       Glue of the newest packet, NULL when empty.
+ * @param[in]  count      Packets queued.
+ * @param[in]  limit      Most packets queued at once.
+ * @param[in]  drops      Packets refused because the queue was full.
+ */
+typedef struct pkt_queue_ {
+    glthread_t lst;
+    glthread_node_t *tail;
+    uint32_t count;
+    uint32_t limit;
+    uint64_t drops;
+} pkt_queue_t;
+
+/**
+ * @brief      Initializes an empty queue.
+ *
+ * @param[in]  q      Queue.
+ * @param[in]  limit  Most packets queued at once, or PKT_QUEUE_UNBOUNDED.
+ */
+void pkt_queue_init(pkt_queue_t *q, uint32_t limit);
+
+/**
+ * @brief      Adds a packet at the tail. A refused packet is left to the
+ *             caller, which usually frees it.
+ *
+ * @param[in]  q    Queue.
+ * @param[in]  pkt  Packet, not on any glthread.
+ *
+ * @return     0 on success, -1 when the queue is full.
+ */
+int pkt_queue_push(pkt_queue_t *q, pkt_buf_t *pkt);
+
+/**
+ * @brief      Removes the packet at the head.
+ *
+ * @param[in]  q  Queue.
+ *
+ * @return     The packet, or NULL when the queue is empty.
+ */
+pkt_buf_t *pkt_queue_pop(pkt_queue_t *q);
+
+/**
+ * @brief      Moves every packet of src to the tail of dst in O(1), ignoring
+ *             the limit of dst. src is empty afterwards.
+ *
+ * @param[in]  dst  Queue to extend.
+ * @param[in]  src  Queue to empty.
+ */
+void pkt_queue_splice(pkt_queue_t *dst, pkt_queue_t *src);
+
+/**
+ * @brief      Frees every packet in the queue.
+ *
+ * @param[in]  q  Queue.
+ */
+void pkt_queue_flush(pkt_queue_t *q);
+
+/**
+ * @brief      Tells whether the queue is empty.
+ */
+static inline int pkt_queue_empty(const pkt_queue_t *q)
+{
+    return q->count == 0;
+}
+
+#endif    // PKT_QUEUE_H
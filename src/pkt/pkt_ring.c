@@ -0,0 +1,117 @@
+/******************************************************************************
+ * @file:        pkt_ring.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        21/10/2026 05:00 PM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the packet ring set-up. Push and pop are
+ *               inline in the header since they sit on the forwarding path;
+ *               the slots are allocated right behind the ring so that one
+ *               allocation holds everything. pkt_ring_init lays out the
+ *               same thing in memory the caller owns.
+ *
+ *               Functions in this file:
+ *                 - pkt_ring_create
+ *                 - pkt_ring_destroy
+ *                 - pkt_ring_memsize
+ *                 - pkt_ring_init
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 21/10/2026 Marko Trickovic
+ * Initial version.
+ *
+ * Revision 0.2: 21/10/2026 Marko Trickovic
+ * Added pkt_ring_memsize and pkt_ring_init.
+ *****************************************************************************/
+
+#ifndef PKT_RING_C
+#define PKT_RING_C
+
+#include <stdlib.h>
+#include <string.h>
+#include "pkt_ring.h"
+
+/**
+ * @brief      Creates an empty ring.
+ *
+ * @param[in]  size  Slots, rounded up to a power of two.
+ *
+ * @return     The ring, or NULL.
+ */
+pkt_ring_t *pkt_ring_create(uint32_t size)
+{
+    size_t bytes = pkt_ring_memsize(size);
+    void *mem;
+
+    if (!bytes)
+        return NULL;
+    // aligned_alloc wants a multiple of the alignment
+    bytes = (bytes + PKT_RING_CACHE_LINE - 1) &
+            ~(size_t)(PKT_RING_CACHE_LINE - 1);
+    mem = aligned_alloc(PKT_RING_CACHE_LINE, bytes);
+    if (!mem)
+        return NULL;
+    return pkt_ring_init(mem, size);
+}
+
+/**
+ * @brief      Frees the ring and the packets in it.
+ *
+ * @param[in]  ring  Ring, may be NULL.
+ */
+void pkt_ring_destroy(pkt_ring_t *ring)
+{
+    pkt_buf_t *pkt;
+
+    if (!ring)
+        return;
+
+    while ((pkt = pkt_ring_pop(ring)))
+        pkt_buf_free(pkt);
+    free(ring);
+}
+
+/**
+ * @brief      Bytes a ring takes.
+ *
+ * @param[in]  size  Slots, rounded up to a power of two.
+ *
+ * @return     The size, or 0 for a bad size.
+ */
+size_t pkt_ring_memsize(uint32_t size)
+{
+    size_t slots = 1;
+
+    if (!size || size > (1u << 31))
+        return 0;
+    while (slots < size)
+        slots <<= 1;
+    return sizeof(pkt_ring_t) + slots * sizeof(pkt_buf_t *);
+}
+
+/**
+ * @brief      Lays out an empty ring at mem.
+ *
+ * @param[in]  mem   pkt_ring_memsize(size) aligned bytes.
+ * @param[in]  size  Slots, rounded up to a power of two.
+ *
+ * @return     The ring, or NULL for a bad size.
+ */
+pkt_ring_t *pkt_ring_init(void *mem, uint32_t size)
+{
+    size_t bytes = pkt_ring_memsize(size);
+    pkt_ring_t *ring = mem;
+
+    if (!bytes)
+        return NULL;
+    memset(ring, 0, sizeof(*ring));
+    ring->mask = (uint32_t)((bytes - sizeof(*ring)) / sizeof(pkt_buf_t *)) - 1;
+    ring->slots = (pkt_buf_t **)(ring + 1);
+    return ring;
+}
+
+#endif    // PKT_RING_C
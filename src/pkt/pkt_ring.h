@@ -0,0 +1,218 @@
+/* -----------------------------------------------------------------------------
+ * @file:        pkt_ring.h
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        21/10/2026 05:00 PM
+ * @license:     MIT
+ * @description: This header file declares the packet ring, a bounded
+ *               single-producer single-consumer FIFO of pkt_buf_t pointers
+ *               that needs no lock. The producer index, the consumer index
+ *               and the read-only geometry each sit on their own cache line,
+ *               and each side keeps a private copy of the other side's index
+ *               so it only reads the shared one when its copy says the ring
+ *               is full or empty. Exactly one thread may push and exactly one
+ *               may pop at a time; they may be the same thread. A ring can
+ *               also be laid out in memory the caller provides, e.g. a
+ *               region shared with forked processes.
+ *               The contents are organized into three groups:
+ *
+ *                 1. Structs:
+ *                    - struct pkt_ring_t
+ *
+ *                 2. Functions:
+ *                    - pkt_ring_create
+ *                    - pkt_ring_destroy
+ *                    - pkt_ring_memsize
+ *                    - pkt_ring_init
+ *                    - pkt_ring_push_burst
+ *                    - pkt_ring_pop_burst
+ *                    - pkt_ring_push
+ *                    - pkt_ring_pop
+ *                    - pkt_ring_room
+ *                    - pkt_ring_count
+ *
+ *                 3. Macros:
+ *                    - PKT_RING_CACHE_LINE
+ *
+ * @note:        This code is part of the tcpip-stack project, which is a course
+ *               on network development.
+ *
+ * Revision History:
+ *
+ * Revision 0.1: 21/10/2026 Marko Trickovic
+ * Initial version.
+ *
+ * Revision 0.2: 21/10/2026 Marko Trickovic
+ * Added pkt_ring_memsize and pkt_ring_init for rings in caller memory.
+ */
+
+#ifndef PKT_RING_H
+#define PKT_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "pkt_buf.h"
+
+/** Alignment that keeps the producer and consumer state apart. */
+#define PKT_RING_CACHE_LINE     64
+
+/**
+ * @brief      The structure representing a packet ring.
+ *
+ * @struct                pkt_ring_t
+ *
+ * @param[in]  mask       Slots minus one, slots being a power of two.
+ * @param[in]  slots      Packet pointers.
+ * @param[in]  tail       Next slot the producer fills, written by it only.
+ * @param[in]  head_cache Producer's copy of head.
+ * @param[in]  head       Next slot the consumer empties, written by it only.
+ * @param[in]  tail_cache Consumer's copy of tail.
+ */
+typedef struct pkt_ring_ {
+    uint32_t mask;
+    pkt_buf_t **slots;
+    uint32_t tail __attribute__((aligned(PKT_RING_CACHE_LINE)));
+    uint32_t head_cache;
+    uint32_t head __attribute__((aligned(PKT_RING_CACHE_LINE)));
+    uint32_t tail_cache;
+} __attribute__((aligned(PKT_RING_CACHE_LINE))) pkt_ring_t;
+
+/**
+ * @brief      Creates an empty ring.
+ *
+ * @param[in]  size  Slots, rounded up to a power of two.
+ *
+ * @return     The ring, or NULL on allocation failure or a size of 0 or
+ *             above 2^31.
+ */
+pkt_ring_t *pkt_ring_create(uint32_t size);
+
+/**
+ * @brief      Frees the ring along with every packet still in it.
+ *
+ * @param[in]  ring  Ring, may be NULL.
+ */
+void pkt_ring_destroy(pkt_ring_t *ring);
+
+/**
+ * @brief      Bytes a ring of size slots takes, slots included.
+ *
+ * @param[in]  size  Slots, rounded up to a power of two.
+ *
+ * @return     The size, or 0 for a size of 0 or above 2^31.
+ */
+size_t pkt_ring_memsize(uint32_t size);
+
+/**
+ * @brief      Lays out an empty ring in caller memory. The ring is not
+ *             freed by pkt_ring_destroy; the caller drains it with
+ *             pkt_ring_pop and releases the memory itself.
+ *
+ * @param[in]  mem   pkt_ring_memsize(size) bytes aligned to
+ *                   PKT_RING_CACHE_LINE.
+ * @param[in]  size  Slots, rounded up to a power of two.
+ *
+ * @return     The ring, at mem, or NULL for a bad size.
+ */
+pkt_ring_t *pkt_ring_init(void *mem, uint32_t size);
+
+/**
+ * @brief      Adds up to n packets at the tail, producer side only.
+ *
+ * @param[in]  ring  Ring.
+ * @param[in]  pkts  Packets, in order.
+ * @param[in]  n     Number of packets.
+ *
+ * @return     The number added, the first ones of pkts; the rest are left
+ *             to the caller.
+ */
+static inline uint32_t pkt_ring_push_burst(pkt_ring_t *ring,
+                                           pkt_buf_t *const *pkts, uint32_t n)
+{
+    uint32_t tail = ring->tail, room, i;
+
+    room = ring->mask + 1 - (tail - ring->head_cache);
+    if (room < n) {
+        ring->head_cache = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        room = ring->mask + 1 - (tail - ring->head_cache);
+        if (room < n)
+            n = room;
+    }
+    for (i = 0; i < n; i++)
+        ring->slots[(tail + i) & ring->mask] = pkts[i];
+    if (n)
+        __atomic_store_n(&ring->tail, tail + n, __ATOMIC_RELEASE);
+    return n;
+}
+
+/**
+ * @brief      Removes up to max packets from the head, consumer side only.
+ *
+ * @param[in]  ring  Ring.
+ * @param[out] pkts  Packets, in order.
+ * @param[in]  max   Most packets wanted.
+ *
+ * @return     The number removed.
+ */
+static inline uint32_t pkt_ring_pop_burst(pkt_ring_t *ring, pkt_buf_t **pkts,
+                                          uint32_t max)
+{
+    uint32_t head = ring->head, avail, i;
+
+    avail = ring->tail_cache - head;
+    if (avail < max) {
+        ring->tail_cache = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+        avail = ring->tail_cache - head;
+        if (avail < max)
+            max = avail;
+    }
+    for (i = 0; i < max; i++)
+        pkts[i] = ring->slots[(head + i) & ring->mask];
+    if (max)
+        __atomic_store_n(&ring->head, head + max, __ATOMIC_RELEASE);
+    return max;
+}
+
+/**
+ * @brief      Adds a packet at the tail, producer side only.
+ *
+ * @return     0 on success, -1 when the ring is full.
+ */
+static inline int pkt_ring_push(pkt_ring_t *ring, pkt_buf_t *pkt)
+{
+    return pkt_ring_push_burst(ring, &pkt, 1) ? 0 : -1;
+}
+
+/**
+ * @brief      Removes the packet at the head, consumer side only.
+ *
+ * @return     The packet, or NULL when the ring is empty.
+ */
+static inline pkt_buf_t *pkt_ring_pop(pkt_ring_t *ring)
+{
+    pkt_buf_t *pkt;
+
+    return pkt_ring_pop_burst(ring, &pkt, 1) ? pkt : NULL;
+}
+
+/**
+ * @brief      Free slots as seen by the producer, producer side only. At
+ *             least that many packets can be pushed next.
+ */
+static inline uint32_t pkt_ring_room(pkt_ring_t *ring)
+{
+    ring->head_cache = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    return ring->mask + 1 - (ring->tail - ring->head_cache);
+}
+
+/**
+ * @brief      Number of packets in the ring, exact only when neither side
+ *             is running.
+ */
+static inline uint32_t pkt_ring_count(const pkt_ring_t *ring)
+{
+    return __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) -
+           __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+}
+
+#endif    // PKT_RING_H
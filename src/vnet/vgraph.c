@@ -0,0 +1,258 @@
+/******************************************************************************
+ * @file:        vgraph.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        21/10/2026 11:00 PM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the vector packet processing graph. A
+ *               node's pending bit is cleared before it runs and its frame
+ *               emptied after, which is safe because only nodes added before
+ *               it can send it packets and none of them runs meanwhile. A
+ *               node whose frame fills up while an earlier node is running
+ *               is dispatched from inside vgraph_enqueue; its cycles are
+ *               taken back out of the running node's count through
+ *               vgraph_t.nested.
+ *
+ *               Functions in this file:
+ *                 - vgraph_create
+ *                 - vgraph_destroy
+ *                 - vgraph_add_node
+ *                 - vgraph_add_next
+ *                 - vgraph_find_node
+ *                 - vgraph_input
+ *                 - vgraph_dispatch
+ *                 - vgraph_run
+ *                 - vgraph_dump
+ *                 - vgraph_clear_stats
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 21/10/2026 Marko Trickovic
+ * Initial version.
+ *****************************************************************************/
+
+#ifndef VGRAPH_C
+#define VGRAPH_C
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "vgraph.h"
+
+/**
+ * @brief      Creates an empty graph.
+ *
+ * @return     The graph, or NULL.
+ */
+vgraph_t *vgraph_create(void)
+{
+    vgraph_t *vg;
+
+    if (posix_memalign((void **)&vg, 64, sizeof(*vg)))
+        return NULL;
+    memset(vg, 0, sizeof(*vg));
+    return vg;
+}
+
+/**
+ * @brief      Frees the graph and the packets waiting in it.
+ *
+ * @param[in]  vg  Graph, may be NULL.
+ */
+void vgraph_destroy(vgraph_t *vg)
+{
+    uint32_t i, j;
+
+    if (!vg)
+        return;
+
+    for (i = 0; i < vg->nnodes; i++)
+        for (j = 0; j < vg->nodes[i].frame.n; j++)
+            pkt_buf_free(vg->nodes[i].frame.pkts[j]);
+    free(vg);
+}
+
+/**
+ * @brief      Adds a node.
+ *
+ * @param[in]  vg    Graph.
+ * @param[in]  name  Node name.
+ * @param[in]  fn    Processing function.
+ * @param[in]  ctx   Caller data.
+ *
+ * @return     The node's index, or -1.
+ */
+int vgraph_add_node(vgraph_t *vg, const char *name, vgraph_node_fn_t fn,
+                    void *ctx)
+{
+    vgraph_node_t *node;
+
+    if (vg->nnodes == VGRAPH_MAX_NODES)
+        return -1;
+
+    node = &vg->nodes[vg->nnodes];
+    node->fn = fn;
+    node->ctx = ctx;
+    node->index = vg->nnodes;
+    strncpy(node->name, name, VGRAPH_NAME_SIZE - 1);
+    return (int)vg->nnodes++;
+}
+
+/**
+ * @brief      Adds an edge.
+ *
+ * @param[in]  vg    Graph.
+ * @param[in]  from  Index of the sending node.
+ * @param[in]  to    Index of the receiving node.
+ *
+ * @return     The next slot, or -1 with errno set.
+ */
+int vgraph_add_next(vgraph_t *vg, uint32_t from, uint32_t to)
+{
+    vgraph_node_t *node;
+
+    if (to >= vg->nnodes || from >= to) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    node = &vg->nodes[from];
+    if (node->n_next == VGRAPH_MAX_NEXT) {
+        errno = ENOSPC;
+        return -1;
+    }
+    node->next[node->n_next] = to;
+    return (int)node->n_next++;
+}
+
+/**
+ * @brief      Looks up a node by name.
+ *
+ * @param[in]  vg    Graph.
+ * @param[in]  name  Node name.
+ *
+ * @return     The node's index, or -1.
+ */
+int vgraph_find_node(vgraph_t *vg, const char *name)
+{
+    uint32_t i;
+
+    for (i = 0; i < vg->nnodes; i++)
+        if (!strncmp(vg->nodes[i].name, name, VGRAPH_NAME_SIZE))
+            return (int)i;
+    return -1;
+}
+
+/**
+ * @brief      Hands packets to a node.
+ *
+ * @param[in]  vg     Graph.
+ * @param[in]  index  Node index.
+ * @param[in]  pkts   Packets.
+ * @param[in]  n      Packets in pkts.
+ */
+void vgraph_input(vgraph_t *vg, uint32_t index, pkt_buf_t **pkts,
+                  uint32_t n)
+{
+    vgraph_node_t *node = &vg->nodes[index];
+    uint32_t room;
+
+    while (n) {
+        if (node->frame.n == VGRAPH_FRAME_SIZE)
+            vgraph_dispatch(vg, node);
+        room = VGRAPH_FRAME_SIZE - node->frame.n;
+        if (room > n)
+            room = n;
+        memcpy(&node->frame.pkts[node->frame.n], pkts, room * sizeof(*pkts));
+        node->frame.n += room;
+        vg->pending |= 1u << index;
+        pkts += room;
+        n -= room;
+    }
+}
+
+/**
+ * @brief      Runs a node on its waiting packets.
+ *
+ * @param[in]  vg    Graph.
+ * @param[in]  node  Node.
+ */
+void vgraph_dispatch(vgraph_t *vg, vgraph_node_t *node)
+{
+    uint32_t n = node->frame.n;
+    uint64_t outer = vg->nested, t;
+
+    if (!n)
+        return;
+
+    vg->pending &= ~(1u << node->index);
+    vg->nested = 0;
+    t = vgraph_cycles();
+    node->fn(vg, node, node->frame.pkts, n);
+    t = vgraph_cycles() - t;
+    node->frame.n = 0;
+
+    node->calls++;
+    node->pkts += n;
+    node->cycles += t - vg->nested;
+    vg->nested = outer + t;
+}
+
+/**
+ * @brief      Runs the graph until no packet waits.
+ *
+ * @param[in]  vg  Graph.
+ */
+void vgraph_run(vgraph_t *vg)
+{
+    while (vg->pending) {
+        vgraph_dispatch(vg, &vg->nodes[__builtin_ctz(vg->pending)]);
+        vg->nested = 0;
+    }
+}
+
+/**
+ * @brief      Prints the node counters.
+ *
+ * @param[in]  vg  Graph.
+ */
+void vgraph_dump(vgraph_t *vg)
+{
+    vgraph_node_t *node;
+    uint32_t i;
+
+    printf("%-*s %12s %12s %10s %12s %10s\n", VGRAPH_NAME_SIZE, "Node",
+           "Calls", "Packets", "Pkts/call", "Cycles/pkt", "Errors");
+    for (i = 0; i < vg->nnodes; i++) {
+        node = &vg->nodes[i];
+        printf("%-*s %12llu %12llu %10.1f %12.1f %10llu\n", VGRAPH_NAME_SIZE,
+               node->name, (unsigned long long)node->calls,
+               (unsigned long long)node->pkts,
+               node->calls ? (double)node->pkts / node->calls : 0.0,
+               node->pkts ? (double)node->cycles / node->pkts : 0.0,
+               (unsigned long long)node->errors);
+    }
+}
+
+/**
+ * @brief      Zeroes the node counters.
+ *
+ * @param[in]  vg  Graph.
+ */
+void vgraph_clear_stats(vgraph_t *vg)
+{
+    uint32_t i;
+
+    for (i = 0; i < vg->nnodes; i++) {
+        vg->nodes[i].calls = 0;
+        vg->nodes[i].pkts = 0;
+        vg->nodes[i].cycles = 0;
+        vg->nodes[i].errors = 0;
+    }
+}
+
+#endif    // VGRAPH_C
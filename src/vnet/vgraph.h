@@ -0,0 +1,280 @@
+/* -----------------------------------------------------------------------------
+ * @file:        vgraph.h
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        21/10/2026 11:00 PM
+ * @license:     MIT
+ * @description: This header file declares the vector packet processing
+ *               graph. A graph node is a function that is handed a vector
+ *               of up to VGRAPH_FRAME_SIZE packets at once and sends each of
+ *               them on to one of its next nodes, where it waits in that
+ *               node's pending frame until the node runs. Running a whole
+ *               vector through one node before moving to the next keeps
+ *               that node's code and data in cache for every packet after
+ *               the first. Edges only go from a node to one added after it,
+ *               so running the pending nodes in the order they were added
+ *               visits each at most once per pass and never re-enters a
+ *               node. Every node counts the vectors and packets it was
+ *               given and the cycles it spent on them, its next nodes'
+ *               cycles excluded.
+ *               The contents are organized into three groups:
+ *
+ *                 1. Structs:
+ *                    - struct vgraph_frame_t
+ *                    - struct vgraph_node_t
+ *                    - struct vgraph_t
+ *
+ *                 2. Functions:
+ *                    - vgraph_create
+ *                    - vgraph_destroy
+ *                    - vgraph_add_node
+ *                    - vgraph_add_next
+ *                    - vgraph_find_node
+ *                    - vgraph_input
+ *                    - vgraph_dispatch
+ *                    - vgraph_run
+ *                    - vgraph_dump
+ *                    - vgraph_clear_stats
+ *                    - vgraph_enqueue
+ *                    - vgraph_cycles
+ *
+ *                 3. Macros:
+ *                    - VGRAPH_FRAME_SIZE
+ *                    - VGRAPH_MAX_NODES
+ *                    - VGRAPH_MAX_NEXT
+ *                    - VGRAPH_NAME_SIZE
+ *
+ * @note:        This code is part of the tcpip-stack project, which is a course
+ *               on network development.
+ *
+ * Revision History:
+ *
+ * Revision 0.1: 21/10/2026 Marko Trickovic
+ * Initial version.
+ */
+
+#ifndef VGRAPH_H
+#define VGRAPH_H
+
+#include <stdint.h>
+#include "../pkt/pkt_buf.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+/** Most packets handed to a node at once. */
+#define VGRAPH_FRAME_SIZE   256
+
+/** Most nodes in a graph, one bit each in vgraph_t.pending. */
+#define VGRAPH_MAX_NODES    32
+
+/** Most next nodes of one node. */
+#define VGRAPH_MAX_NEXT     8
+
+#define VGRAPH_NAME_SIZE    24
+
+struct vgraph_;
+struct vgraph_node_;
+
+/**
+ * @brief      Processes a vector of packets, handing each one to a next node
+ *             with vgraph_enqueue or freeing it.
+ */
+typedef void (*vgraph_node_fn_t)(struct vgraph_ *vg,
+                                 struct vgraph_node_ *node,
+                                 pkt_buf_t **pkts, uint32_t n);
+
+/**
+ * @brief      The structure representing the packets waiting for a node.
+ *
+ * @struct                vgraph_frame_t
+ *
+ * @param[in]  n          Packets in pkts.
+ * @param[in]  pkts       Packets in arrival order.
+ */
+typedef struct vgraph_frame_ {
+    uint32_t n;
+    pkt_buf_t *pkts[VGRAPH_FRAME_SIZE];
+} vgraph_frame_t;
+
+/**
+ * @brief      The structure representing a graph node. The counters are
+ *             only written by the thread running the graph.
+ *
+ * @struct                vgraph_node_t
+ *
+ * @param[in]  fn         Processing function.
+ * @param[in]  ctx        Caller data for fn.
+ * @param[in]  index      Position in the graph, also its bit in pending.
+ * @param[in]  n_next     Next nodes in use.
+ * @param[in]  next       Graph indexes of the next nodes, by next slot.
+ * @param[in]  calls      Vectors processed.
+ * @param[in]  pkts       Packets processed.
+ * @param[in]  cycles     Cycles spent in fn, next nodes excluded.
+ * @param[in]  errors     Packets the node dropped, counted by fn.
+ * @param[in]  name       Node name.
+ * @param[in]  frame      Packets waiting for the node.
+ */
+typedef struct vgraph_node_ {
+    vgraph_node_fn_t fn;
+    void *ctx;
+    uint32_t index;
+    uint32_t n_next;
+    uint32_t next[VGRAPH_MAX_NEXT];
+    uint64_t calls;
+    uint64_t pkts;
+    uint64_t cycles;
+    uint64_t errors;
+    char name[VGRAPH_NAME_SIZE];
+    vgraph_frame_t frame;
+} __attribute__((aligned(64))) vgraph_node_t;
+
+/**
+ * @brief      The structure representing a graph.
+ *
+ * @struct                vgraph_t
+ *
+ * @param[in]  pending    Bit i set when nodes[i] has packets waiting.
+ * @param[in]  nested     Cycles spent in nodes dispatched from inside the
+ *                        node running now.
+ * @param[in]  nnodes     Nodes in use.
+ * @param[in]  nodes      Nodes in the order they were added.
+ */
+typedef struct vgraph_ {
+    uint32_t pending;
+    uint64_t nested;
+    uint32_t nnodes;
+    vgraph_node_t nodes[VGRAPH_MAX_NODES];
+} vgraph_t;
+
+/**
+ * @brief      Creates an empty graph.
+ *
+ * @return     The graph, or NULL when out of memory.
+ */
+vgraph_t *vgraph_create(void);
+
+/**
+ * @brief      Frees the graph along with every packet waiting in it.
+ *
+ * @param[in]  vg  Graph, may be NULL.
+ */
+void vgraph_destroy(vgraph_t *vg);
+
+/**
+ * @brief      Adds a node after every node already in the graph.
+ *
+ * @param[in]  vg    Graph.
+ * @param[in]  name  Node name, truncated to fit.
+ * @param[in]  fn    Processing function.
+ * @param[in]  ctx   Caller data for fn.
+ *
+ * @return     The node's index, or -1 when the graph is full.
+ */
+int vgraph_add_node(vgraph_t *vg, const char *name, vgraph_node_fn_t fn,
+                    void *ctx);
+
+/**
+ * @brief      Adds an edge from one node to one added after it.
+ *
+ * @param[in]  vg    Graph.
+ * @param[in]  from  Index of the node sending packets.
+ * @param[in]  to    Index of the node receiving them, greater than from.
+ *
+ * @return     The next slot to pass to vgraph_enqueue, or -1 with errno
+ *             EINVAL for a bad index or a backward edge, ENOSPC when from
+ *             has VGRAPH_MAX_NEXT next nodes.
+ */
+int vgraph_add_next(vgraph_t *vg, uint32_t from, uint32_t to);
+
+/**
+ * @brief      Looks up a node by name.
+ *
+ * @param[in]  vg    Graph.
+ * @param[in]  name  Node name.
+ *
+ * @return     The node's index, or -1.
+ */
+int vgraph_find_node(vgraph_t *vg, const char *name);
+
+/**
+ * @brief      Hands packets to a node without running the graph.
+ *
+ * @param[in]  vg     Graph.
+ * @param[in]  index  Node index.
+ * @param[in]  pkts   Packets.
+ * @param[in]  n      Packets in pkts.
+ */
+void vgraph_input(vgraph_t *vg, uint32_t index, pkt_buf_t **pkts,
+                  uint32_t n);
+
+/**
+ * @brief      Runs a node on the packets waiting for it, if any.
+ *
+ * @param[in]  vg    Graph.
+ * @param[in]  node  Node.
+ */
+void vgraph_dispatch(vgraph_t *vg, vgraph_node_t *node);
+
+/**
+ * @brief      Runs the nodes with packets waiting, in graph order, until
+ *             no packet waits anywhere.
+ *
+ * @param[in]  vg  Graph.
+ */
+void vgraph_run(vgraph_t *vg);
+
+/**
+ * @brief      Prints the counters of every node to stdout.
+ *
+ * @param[in]  vg  Graph.
+ */
+void vgraph_dump(vgraph_t *vg);
+
+/**
+ * @brief      Zeroes the counters of every node.
+ *
+ * @param[in]  vg  Graph.
+ */
+void vgraph_clear_stats(vgraph_t *vg);
+
+/**
+ * @brief      Reads the cycle counter the node counters use.
+ *
+ * @return     Time stamp counter, or nanoseconds on platforms without one.
+ */
+static inline uint64_t vgraph_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/**
+ * @brief      Sends a packet from a node to one of its next nodes, which
+ *             runs at once if its frame is already full.
+ *
+ * @param[in]  vg    Graph.
+ * @param[in]  node  Node sending the packet.
+ * @param[in]  slot  Next slot from vgraph_add_next.
+ * @param[in]  pkt   Packet.
+ */
+static inline void vgraph_enqueue(vgraph_t *vg, vgraph_node_t *node,
+                                  uint32_t slot, pkt_buf_t *pkt)
+{
+    vgraph_node_t *to = &vg->nodes[node->next[slot]];
+
+    if (to->frame.n == VGRAPH_FRAME_SIZE)
+        vgraph_dispatch(vg, to);
+    to->frame.pkts[to->frame.n++] = pkt;
+    vg->pending |= 1u << to->index;
+}
+
+#endif    // VGRAPH_H
@@ -0,0 +1,576 @@
+/******************************************************************************
+ * @file:        vnet.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        21/10/2026 11:00 PM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the forwarding nodes of a router. Every
+ *               node keeps next slot 0 for error-drop. Headers are read and
+ *               written in place, Ethernet through the views of ethernet.h
+ *               and the rest at fixed offsets from pkt_buf_t.data; a
+ *               node that writes first gives the packet its own block if a
+ *               clone shares it. ethernet-input prefetches the headers two
+ *               packets ahead, the first touch of each packet. The TTL
+ *               decrement updates the header checksum incrementally rather
+ *               than summing the header again. Routes are kept longest
+ *               prefix first and ip4-lookup takes the first that matches.
+ *
+ *               Functions in this file:
+ *                 - vnet_create
+ *                 - vnet_destroy
+ *                 - vnet_intf_set
+ *                 - vnet_route_add
+ *                 - vnet_input
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 21/10/2026 Marko Trickovic
+ * Initial version.
+ *
+ * Revision 0.2: 22/10/2026 Marko Trickovic
+ * Ethernet headers are accessed through the views of ethernet.h.
+ *
+ * Revision 0.3: 22/10/2026 Marko Trickovic
+ * vlan-input strips tags with ethernet_vlan_pop.
+ *****************************************************************************/
+
+#ifndef VNET_C
+#define VNET_C
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include "vnet.h"
+#include "../net/ethernet.h"
+
+#define VNET_ARP_LEN        28
+#define VNET_IP4_HLEN       20
+
+#define VNET_ARP_REQUEST    1
+#define VNET_ARP_REPLY      2
+
+// Next slots; error-drop is slot 0 of every node
+#define VNET_NEXT_DROP      0
+
+enum { ETH_NEXT_VLAN = 1, ETH_NEXT_ARP, ETH_NEXT_IP4 };
+enum { VLAN_NEXT_ARP = 1, VLAN_NEXT_IP4 };
+enum { ARP_NEXT_OUTPUT = 1 };
+enum { IP4_NEXT_LOOKUP = 1 };
+enum { LOOKUP_NEXT_REWRITE = 1 };
+enum { REWRITE_NEXT_OUTPUT = 1 };
+
+static inline uint16_t vnet_rd16(const unsigned char *p)
+{
+    return (uint16_t)(p[0] << 8 | p[1]);
+}
+
+static inline uint32_t vnet_rd32(const unsigned char *p)
+{
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 |
+           (uint32_t)p[2] << 8 | p[3];
+}
+
+static inline void vnet_wr16(unsigned char *p, uint16_t v)
+{
+    p[0] = (unsigned char)(v >> 8);
+    p[1] = (unsigned char)v;
+}
+
+static inline void vnet_wr32(unsigned char *p, uint32_t v)
+{
+    p[0] = (unsigned char)(v >> 24);
+    p[1] = (unsigned char)(v >> 16);
+    p[2] = (unsigned char)(v >> 8);
+    p[3] = (unsigned char)v;
+}
+
+// Returns the first len bytes of the packet in one piece, or NULL
+static inline unsigned char *vnet_hdr(pkt_buf_t *pkt, uint32_t len)
+{
+    return len <= pkt->len ? pkt->data : pkt_buf_may_pull(pkt, len);
+}
+
+// Gives the packet its own block before its headers are written
+static inline int vnet_writable(pkt_buf_t *pkt)
+{
+    return pkt_buf_is_shared(pkt) ? pkt_buf_make_writable(pkt) : 0;
+}
+
+static inline void vnet_drop(vgraph_t *vg, vgraph_node_t *node,
+                             pkt_buf_t *pkt)
+{
+    node->errors++;
+    vgraph_enqueue(vg, node, VNET_NEXT_DROP, pkt);
+}
+
+// One's complement sum of the header, 0 when its checksum is right
+static uint16_t vnet_ip4_csum(const unsigned char *ip, uint32_t len)
+{
+    uint32_t sum = 0, i;
+
+    for (i = 0; i < len; i += 2)
+        sum += vnet_rd16(ip + i);
+    while (sum >> 16)
+        sum = (sum & 0xffff) + (sum >> 16);
+    return (uint16_t)~sum;
+}
+
+static void vnet_eth_input(vgraph_t *vg, vgraph_node_t *node,
+                           pkt_buf_t **pkts, uint32_t n)
+{
+    vnet_t *vn = node->ctx;
+    ethernet_hdr_t *eth;
+    vnet_intf_t *ni;
+    pkt_buf_t *pkt;
+    uint32_t i;
+
+    for (i = 0; i < n; i++) {
+        pkt = pkts[i];
+        if (i + 2 < n)
+            __builtin_prefetch(pkts[i + 2]->data);
+
+        ni = &vn->intfs[pkt->rx_ifindex];
+        eth = ethernet_hdr(pkt);
+        // Unicast frames must be for the interface's own address
+        if (!eth || !ni->up ||
+            (!ethernet_is_mcast(eth->dst) &&
+             memcmp(eth->dst, ni->mac, VNET_MAC_LEN))) {
+            vnet_drop(vg, node, pkt);
+            continue;
+        }
+
+        switch (ntohs(eth->type)) {
+        case ETHERNET_TYPE_IP4:
+            vgraph_enqueue(vg, node, ETH_NEXT_IP4, pkt);
+            break;
+        case ETHERNET_TYPE_ARP:
+            vgraph_enqueue(vg, node, ETH_NEXT_ARP, pkt);
+            break;
+        case ETHERNET_TYPE_VLAN:
+            vgraph_enqueue(vg, node, ETH_NEXT_VLAN, pkt);
+            break;
+        default:
+            vnet_drop(vg, node, pkt);
+        }
+    }
+}
+
+static void vnet_vlan_input(vgraph_t *vg, vgraph_node_t *node,
+                            pkt_buf_t **pkts, uint32_t n)
+{
+    ethernet_hdr_t *eth;
+    pkt_buf_t *pkt;
+    uint16_t type;
+    uint32_t i;
+    int tci;
+
+    for (i = 0; i < n; i++) {
+        pkt = pkts[i];
+        // Strips the tag by moving the addresses over it
+        tci = ethernet_vlan_pop(pkt);
+        if (tci < 0) {
+            vnet_drop(vg, node, pkt);
+            continue;
+        }
+
+        eth = (ethernet_hdr_t *)pkt->data;
+        pkt->vlan = (uint16_t)(tci & ETHERNET_VID_MASK);
+        type = ntohs(eth->type);
+
+        if (type == ETHERNET_TYPE_IP4)
+            vgraph_enqueue(vg, node, VLAN_NEXT_IP4, pkt);
+        else if (type == ETHERNET_TYPE_ARP)
+            vgraph_enqueue(vg, node, VLAN_NEXT_ARP, pkt);
+        else
+            vnet_drop(vg, node, pkt);
+    }
+}
+
+static void vnet_arp_input(vgraph_t *vg, vgraph_node_t *node,
+                           pkt_buf_t **pkts, uint32_t n)
+{
+    vnet_t *vn = node->ctx;
+    unsigned char *eth, *arp;
+    vnet_intf_t *ni;
+    pkt_buf_t *pkt;
+    uint32_t i;
+
+    for (i = 0; i < n; i++) {
+        pkt = pkts[i];
+        ni = &vn->intfs[pkt->rx_ifindex];
+        eth = vnet_hdr(pkt, ETHERNET_HDR_LEN + VNET_ARP_LEN);
+        if (!eth) {
+            vnet_drop(vg, node, pkt);
+            continue;
+        }
+        arp = eth + ETHERNET_HDR_LEN;
+        if (vnet_rd16(arp) != 1 ||
+            vnet_rd16(arp + 2) != ETHERNET_TYPE_IP4 || arp[4] != 6 ||
+            arp[5] != 4 || vnet_rd16(arp + 6) != VNET_ARP_REQUEST ||
+            vnet_rd32(arp + 24) != ni->ip4 || vnet_writable(pkt) < 0) {
+            vnet_drop(vg, node, pkt);
+            continue;
+        }
+
+        // Answer in place: the sender becomes the target
+        eth = pkt->data;
+        arp = eth + ETHERNET_HDR_LEN;
+        vnet_wr16(arp + 6, VNET_ARP_REPLY);
+        memcpy(arp + 18, arp + 8, VNET_MAC_LEN + 4);
+        memcpy(arp + 8, ni->mac, VNET_MAC_LEN);
+        vnet_wr32(arp + 14, ni->ip4);
+        memcpy(eth, arp + 18, VNET_MAC_LEN);
+        memcpy(eth + 6, ni->mac, VNET_MAC_LEN);
+
+        pkt->tx_ifindex = pkt->rx_ifindex;
+        vgraph_enqueue(vg, node, ARP_NEXT_OUTPUT, pkt);
+    }
+}
+
+static void vnet_ip4_input(vgraph_t *vg, vgraph_node_t *node,
+                           pkt_buf_t **pkts, uint32_t n)
+{
+    unsigned char *eth, *ip;
+    uint32_t i, ihl, tot;
+    pkt_buf_t *pkt;
+
+    for (i = 0; i < n; i++) {
+        pkt = pkts[i];
+        eth = vnet_hdr(pkt, ETHERNET_HDR_LEN + VNET_IP4_HLEN);
+        if (!eth)
+            goto drop;
+
+        ip = eth + ETHERNET_HDR_LEN;
+        ihl = (ip[0] & 0xf) * 4u;
+        if ((ip[0] >> 4) != 4 || ihl < VNET_IP4_HLEN)
+            goto drop;
+        if (ihl > VNET_IP4_HLEN) {
+            eth = vnet_hdr(pkt, ETHERNET_HDR_LEN + ihl);
+            if (!eth)
+                goto drop;
+            ip = eth + ETHERNET_HDR_LEN;
+        }
+
+        tot = vnet_rd16(ip + 2);
+        if (tot < ihl || tot > pkt->pkt_len - ETHERNET_HDR_LEN ||
+            vnet_ip4_csum(ip, ihl) || ip[8] <= 1)
+            goto drop;
+
+        // Ethernet padding is not part of the datagram
+        pkt_buf_trim(pkt, ETHERNET_HDR_LEN + tot);
+        vgraph_enqueue(vg, node, IP4_NEXT_LOOKUP, pkt);
+        continue;
+drop:
+        vnet_drop(vg, node, pkt);
+    }
+}
+
+static inline const vnet_route_t *vnet_route_lookup(const vnet_t *vn,
+                                                    uint32_t dst)
+{
+    const vnet_route_t *r = vn->routes, *end = r + vn->nroutes;
+
+    for (; r < end; r++)
+        if ((dst & r->mask) == r->prefix)
+            return r;
+    return NULL;
+}
+
+static void vnet_ip4_lookup(vgraph_t *vg, vgraph_node_t *node,
+                            pkt_buf_t **pkts, uint32_t n)
+{
+    vnet_t *vn = node->ctx;
+    const vnet_route_t *r;
+    pkt_buf_t *pkt;
+    uint32_t i;
+
+    for (i = 0; i < n; i++) {
+        pkt = pkts[i];
+        r = vnet_route_lookup(vn, vnet_rd32(pkt->data + ETHERNET_HDR_LEN +
+                                            16));
+        // Nothing above IP is implemented, so local packets end here too
+        if (!r || r->adj == VNET_ADJ_LOCAL) {
+            vnet_drop(vg, node, pkt);
+            continue;
+        }
+        pkt->adj_index = r->adj;
+        vgraph_enqueue(vg, node, LOOKUP_NEXT_REWRITE, pkt);
+    }
+}
+
+static void vnet_ip4_rewrite(vgraph_t *vg, vgraph_node_t *node,
+                             pkt_buf_t **pkts, uint32_t n)
+{
+    vnet_t *vn = node->ctx;
+    const vnet_adj_t *adj;
+    ethernet_hdr_t *eth;
+    unsigned char *ip;
+    pkt_buf_t *pkt;
+    uint32_t i, sum;
+
+    for (i = 0; i < n; i++) {
+        pkt = pkts[i];
+        if (vnet_writable(pkt) < 0) {
+            vnet_drop(vg, node, pkt);
+            continue;
+        }
+
+        adj = &vn->adjs[pkt->adj_index];
+        eth = (ethernet_hdr_t *)pkt->data;
+        ip = pkt->data + ETHERNET_HDR_LEN;
+
+        // TTL is the high byte of its 16-bit word, RFC 1624
+        ip[8]--;
+        sum = vnet_rd16(ip + 10) + 0x0100;
+        vnet_wr16(ip + 10, (uint16_t)(sum + (sum >= 0xffff)));
+
+        ethernet_rewrite(eth, adj->mac, vn->intfs[adj->ifindex].mac);
+        pkt->tx_ifindex = adj->ifindex;
+        vgraph_enqueue(vg, node, REWRITE_NEXT_OUTPUT, pkt);
+    }
+}
+
+static void vnet_intf_output(vgraph_t *vg, vgraph_node_t *node,
+                             pkt_buf_t **pkts, uint32_t n)
+{
+    vnet_t *vn = node->ctx;
+    uint32_t i;
+
+    (void)vg;
+    for (i = 0; i < n; i++) {
+        if (pkt_queue_push(&vn->intfs[pkts[i]->tx_ifindex].txq, pkts[i]) < 0) {
+            node->errors++;
+            pkt_buf_free(pkts[i]);
+        }
+    }
+}
+
+static void vnet_error_drop(vgraph_t *vg, vgraph_node_t *node,
+                            pkt_buf_t **pkts, uint32_t n)
+{
+    uint32_t i;
+
+    (void)vg;
+    (void)node;
+    for (i = 0; i < n; i++)
+        pkt_buf_free(pkts[i]);
+}
+
+static const struct {
+    const char *name;
+    vgraph_node_fn_t fn;
+    vnet_node_id_t next[4];
+} vnet_nodes[VNET_NODE_MAX] = {
+    [VNET_NODE_ETH_INPUT]   = { "ethernet-input", vnet_eth_input,
+        { VNET_NODE_DROP, VNET_NODE_VLAN_INPUT, VNET_NODE_ARP_INPUT,
+          VNET_NODE_IP4_INPUT } },
+    [VNET_NODE_VLAN_INPUT]  = { "vlan-input", vnet_vlan_input,
+        { VNET_NODE_DROP, VNET_NODE_ARP_INPUT, VNET_NODE_IP4_INPUT } },
+    [VNET_NODE_ARP_INPUT]   = { "arp-input", vnet_arp_input,
+        { VNET_NODE_DROP, VNET_NODE_INTF_OUTPUT } },
+    [VNET_NODE_IP4_INPUT]   = { "ip4-input", vnet_ip4_input,
+        { VNET_NODE_DROP, VNET_NODE_IP4_LOOKUP } },
+    [VNET_NODE_IP4_LOOKUP]  = { "ip4-lookup", vnet_ip4_lookup,
+        { VNET_NODE_DROP, VNET_NODE_IP4_REWRITE } },
+    [VNET_NODE_IP4_REWRITE] = { "ip4-rewrite", vnet_ip4_rewrite,
+        { VNET_NODE_DROP, VNET_NODE_INTF_OUTPUT } },
+    [VNET_NODE_INTF_OUTPUT] = { "interface-output", vnet_intf_output, { 0 } },
+    [VNET_NODE_DROP]        = { "error-drop", vnet_error_drop, { 0 } },
+};
+
+/**
+ * @brief      Creates the forwarding path of a node.
+ *
+ * @param[in]  node       Router node.
+ * @param[in]  txq_limit  Frames queued per interface, 0 for the default.
+ *
+ * @return     The forwarding path, or NULL.
+ */
+vnet_t *vnet_create(node_t *node, uint32_t txq_limit)
+{
+    vnet_t *vn;
+    uint32_t i, j;
+
+    if (!txq_limit)
+        txq_limit = VNET_TXQ_LIMIT;
+
+    vn = calloc(1, sizeof(*vn));
+    if (!vn)
+        return NULL;
+    vn->node = node;
+    vn->nintfs = node->graph->ifindex_next;
+    vn->intfs = calloc(vn->nintfs, sizeof(vnet_intf_t));
+    vn->vg = vgraph_create();
+    if (!vn->intfs || !vn->vg) {
+        vnet_destroy(vn);
+        return NULL;
+    }
+    for (i = 0; i < vn->nintfs; i++)
+        pkt_queue_init(&vn->intfs[i].txq, txq_limit);
+
+    // Nodes are added in vnet_node_id_t order, and the table lists each
+    // node's next nodes in next slot order
+    for (i = 0; i < VNET_NODE_MAX; i++)
+        vgraph_add_node(vn->vg, vnet_nodes[i].name, vnet_nodes[i].fn, vn);
+    for (i = 0; i < VNET_NODE_MAX; i++)
+        for (j = 0; j < 4 && vnet_nodes[i].next[j]; j++)
+            vgraph_add_next(vn->vg, i, vnet_nodes[i].next[j]);
+    return vn;
+}
+
+/**
+ * @brief      Frees the forwarding path and the frames it holds.
+ *
+ * @param[in]  vn  Forwarding path, may be NULL.
+ */
+void vnet_destroy(vnet_t *vn)
+{
+    uint32_t i;
+
+    if (!vn)
+        return;
+
+    vgraph_destroy(vn->vg);
+    if (vn->intfs)
+        for (i = 0; i < vn->nintfs; i++)
+            pkt_queue_flush(&vn->intfs[i].txq);
+    free(vn->intfs);
+    free(vn->routes);
+    free(vn->adjs);
+    free(vn);
+}
+
+static inline int vnet_owns(const vnet_t *vn, const interface_t *intf)
+{
+    return intf && intf->att_node == vn->node && intf->ifindex < vn->nintfs;
+}
+
+static inline uint32_t vnet_mask(uint8_t plen)
+{
+    return plen ? ~0u << (32 - plen) : 0;
+}
+
+// Inserts a route after every route with a longer or equal prefix
+static int vnet_route_insert(vnet_t *vn, uint32_t prefix, uint8_t plen,
+                             uint32_t adj)
+{
+    vnet_route_t *routes;
+    uint32_t cap, i;
+
+    if (vn->nroutes == vn->routes_cap) {
+        cap = vn->routes_cap ? 2 * vn->routes_cap : 16;
+        routes = realloc(vn->routes, cap * sizeof(*routes));
+        if (!routes) {
+            errno = ENOMEM;
+            return -1;
+        }
+        vn->routes = routes;
+        vn->routes_cap = cap;
+    }
+
+    for (i = vn->nroutes; i > 0 && vn->routes[i - 1].plen < plen; i--)
+        vn->routes[i] = vn->routes[i - 1];
+    vn->routes[i].mask = vnet_mask(plen);
+    vn->routes[i].prefix = prefix & vn->routes[i].mask;
+    vn->routes[i].adj = adj;
+    vn->routes[i].plen = plen;
+    vn->nroutes++;
+    return 0;
+}
+
+/**
+ * @brief      Configures an interface.
+ *
+ * @param[in]  vn    Forwarding path.
+ * @param[in]  intf  Interface.
+ * @param[in]  mac   MAC address.
+ * @param[in]  ip4   IPv4 address.
+ * @param[in]  plen  Prefix length.
+ *
+ * @return     0 on success, -1 with errno set.
+ */
+int vnet_intf_set(vnet_t *vn, interface_t *intf, const uint8_t *mac,
+                  uint32_t ip4, uint8_t plen)
+{
+    vnet_intf_t *ni;
+
+    if (!vnet_owns(vn, intf) || plen > 32) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (vnet_route_insert(vn, ip4, 32, VNET_ADJ_LOCAL) < 0)
+        return -1;
+
+    ni = vnet_get_intf(vn, intf);
+    memcpy(ni->mac, mac, VNET_MAC_LEN);
+    ni->ip4 = ip4;
+    ni->plen = plen;
+    ni->up = 1;
+    return 0;
+}
+
+/**
+ * @brief      Adds a route.
+ *
+ * @param[in]  vn      Forwarding path.
+ * @param[in]  prefix  Network address.
+ * @param[in]  plen    Prefix length.
+ * @param[in]  intf    Interface to send by.
+ * @param[in]  nh_mac  MAC address of the next hop.
+ *
+ * @return     0 on success, -1 with errno set.
+ */
+int vnet_route_add(vnet_t *vn, uint32_t prefix, uint8_t plen,
+                   interface_t *intf, const uint8_t *nh_mac)
+{
+    vnet_adj_t *adjs;
+    uint32_t cap;
+
+    if (!vnet_owns(vn, intf) || plen > 32) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (vn->nadjs == vn->adjs_cap) {
+        cap = vn->adjs_cap ? 2 * vn->adjs_cap : 16;
+        adjs = realloc(vn->adjs, cap * sizeof(*adjs));
+        if (!adjs) {
+            errno = ENOMEM;
+            return -1;
+        }
+        vn->adjs = adjs;
+        vn->adjs_cap = cap;
+    }
+    if (vnet_route_insert(vn, prefix, plen, vn->nadjs) < 0)
+        return -1;
+
+    vn->adjs[vn->nadjs].ifindex = intf->ifindex;
+    memcpy(vn->adjs[vn->nadjs].mac, nh_mac, VNET_MAC_LEN);
+    vn->nadjs++;
+    return 0;
+}
+
+/**
+ * @brief      Runs received frames through the graph.
+ *
+ * @param[in]  vn    Forwarding path.
+ * @param[in]  intf  Interface the frames came in by.
+ * @param[in]  pkts  Frames.
+ * @param[in]  n     Frames in pkts.
+ */
+void vnet_input(vnet_t *vn, interface_t *intf, pkt_buf_t **pkts, uint32_t n)
+{
+    uint32_t i;
+
+    for (i = 0; i < n; i++) {
+        pkts[i]->rx_ifindex = intf->ifindex;
+        pkts[i]->vlan = 0;
+    }
+    vgraph_input(vn->vg, VNET_NODE_ETH_INPUT, pkts, n);
+    vgraph_run(vn->vg);
+}
+
+#endif    // VNET_C
@@ -0,0 +1,232 @@
+/* -----------------------------------------------------------------------------
+ * @file:        vnet.h
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        21/10/2026 11:00 PM
+ * @license:     MIT
+ * @description: This header file declares the forwarding path of a router
+ *               node, built as a vgraph_t of the nodes
+ *
+ *                 ethernet-input -> vlan-input -> arp-input -> ip4-input ->
+ *                 ip4-lookup -> ip4-rewrite -> interface-output, error-drop
+ *
+ *               Frames received on an interface enter at ethernet-input with
+ *               pkt_buf_t.data on the Ethernet header, are dispatched on the
+ *               EtherType, have an 802.1Q tag stripped, ARP requests for an
+ *               interface address are answered in place, and IPv4 packets
+ *               are checked, looked up longest prefix first, get their TTL
+ *               and checksum updated and their MAC addresses rewritten, and
+ *               are queued on the transmit queue of the outgoing interface
+ *               for the caller to hand to a link transport. Anything else
+ *               ends at error-drop, counted as an error of the node that
+ *               dropped it. Addresses are given in host byte order.
+ *               The contents are organized into three groups:
+ *
+ *                 1. Structs:
+ *                    - enum vnet_node_id_t
+ *                    - struct vnet_intf_t
+ *                    - struct vnet_adj_t
+ *                    - struct vnet_route_t
+ *                    - struct vnet_t
+ *
+ *                 2. Functions:
+ *                    - vnet_create
+ *                    - vnet_destroy
+ *                    - vnet_intf_set
+ *                    - vnet_route_add
+ *                    - vnet_input
+ *                    - vnet_get_intf
+ *
+ *                 3. Macros:
+ *                    - VNET_MAC_LEN
+ *                    - VNET_TXQ_LIMIT
+ *                    - VNET_ADJ_LOCAL
+ *
+ * @note:        This code is part of the tcpip-stack project, which is a course
+ *               on network development.
+ *
+ * Revision History:
+ *
+ * Revision 0.1: 21/10/2026 Marko Trickovic
+ * Initial version.
+ */
+
+#ifndef VNET_H
+#define VNET_H
+
+#include <stdint.h>
+#include "vgraph.h"
+#include "../graph/graph.h"
+#include "../pkt/pkt_queue.h"
+
+#define VNET_MAC_LEN        6
+
+/** Frames queued for transmission per interface when none is given. */
+#define VNET_TXQ_LIMIT      1024
+
+/** Adjacency of a route to an address of the router itself. */
+#define VNET_ADJ_LOCAL      UINT32_MAX
+
+/**
+ * @brief      Graph indexes of the forwarding nodes, in graph order.
+ */
+typedef enum vnet_node_id_ {
+    VNET_NODE_ETH_INPUT,
+    VNET_NODE_VLAN_INPUT,
+    VNET_NODE_ARP_INPUT,
+    VNET_NODE_IP4_INPUT,
+    VNET_NODE_IP4_LOOKUP,
+    VNET_NODE_IP4_REWRITE,
+    VNET_NODE_INTF_OUTPUT,
+    VNET_NODE_DROP,
+    VNET_NODE_MAX
+} vnet_node_id_t;
+
+/**
+ * @brief      The structure representing the addressing of an interface.
+ *
+ * @struct                vnet_intf_t
+ *
+ * @param[in]  mac        MAC address.
+ * @param[in]  up         1 once configured; frames in by an interface that
+ *                        is not are dropped.
+ * @param[in]  plen       Prefix length of the subnet.
+ * @param[in]  ip4        IPv4 address.
+ * @param[in]  txq        Frames to send, for the caller to take.
+ */
+typedef struct vnet_intf_ {
+    uint8_t mac[VNET_MAC_LEN];
+    uint8_t up;
+    uint8_t plen;
+    uint32_t ip4;
+    pkt_queue_t txq;
+} vnet_intf_t;
+
+/**
+ * @brief      The structure representing a next hop.
+ *
+ * @struct                vnet_adj_t
+ *
+ * @param[in]  ifindex    Interface to send by.
+ * @param[in]  mac        MAC address of the next hop.
+ */
+typedef struct vnet_adj_ {
+    uint32_t ifindex;
+    uint8_t mac[VNET_MAC_LEN];
+} vnet_adj_t;
+
+/**
+ * @brief      The structure representing a route.
+ *
+ * @struct                vnet_route_t
+ *
+ * @param[in]  prefix     Network address, host bits clear.
+ * @param[in]  mask       Network mask.
+ * @param[in]  adj        Index into vnet_t.adjs, or VNET_ADJ_LOCAL.
+ * @param[in]  plen       Prefix length.
+ */
+typedef struct vnet_route_ {
+    uint32_t prefix;
+    uint32_t mask;
+    uint32_t adj;
+    uint8_t plen;
+} vnet_route_t;
+
+/**
+ * @brief      The structure representing the forwarding path of a node.
+ *
+ * @struct                vnet_t
+ *
+ * @param[in]  vg         Graph of the forwarding nodes.
+ * @param[in]  node       Router node.
+ * @param[in]  intfs      Interface addressing, indexed by ifindex.
+ * @param[in]  nintfs     Entries in intfs.
+ * @param[in]  routes     Routes, longest prefix first.
+ * @param[in]  nroutes    Routes in use.
+ * @param[in]  routes_cap Capacity of routes.
+ * @param[in]  adjs       Next hops.
+ * @param[in]  nadjs      Next hops in use.
+ * @param[in]  adjs_cap   Capacity of adjs.
+ */
+typedef struct vnet_ {
+    vgraph_t *vg;
+    node_t *node;
+    vnet_intf_t *intfs;
+    uint32_t nintfs;
+    vnet_route_t *routes;
+    uint32_t nroutes;
+    uint32_t routes_cap;
+    vnet_adj_t *adjs;
+    uint32_t nadjs;
+    uint32_t adjs_cap;
+} vnet_t;
+
+/**
+ * @brief      Creates the forwarding path of a node with no interface
+ *             configured and no route.
+ *
+ * @param[in]  node       Router node, its graph not changed while the
+ *                        forwarding path exists.
+ * @param[in]  txq_limit  Frames queued per interface, 0 for VNET_TXQ_LIMIT.
+ *
+ * @return     The forwarding path, or NULL when out of memory.
+ */
+vnet_t *vnet_create(node_t *node, uint32_t txq_limit);
+
+/**
+ * @brief      Frees the forwarding path along with every frame it holds.
+ *
+ * @param[in]  vn  Forwarding path, may be NULL.
+ */
+void vnet_destroy(vnet_t *vn);
+
+/**
+ * @brief      Configures an interface and adds a local route to its address.
+ *
+ * @param[in]  vn    Forwarding path.
+ * @param[in]  intf  Interface of the router node.
+ * @param[in]  mac   MAC address.
+ * @param[in]  ip4   IPv4 address.
+ * @param[in]  plen  Prefix length of the subnet.
+ *
+ * @return     0 on success, -1 with errno EINVAL for an interface of
+ *             another node or plen over 32, ENOMEM.
+ */
+int vnet_intf_set(vnet_t *vn, interface_t *intf, const uint8_t *mac,
+                  uint32_t ip4, uint8_t plen);
+
+/**
+ * @brief      Adds a route through a next hop.
+ *
+ * @param[in]  vn      Forwarding path.
+ * @param[in]  prefix  Network address, host bits are ignored.
+ * @param[in]  plen    Prefix length.
+ * @param[in]  intf    Interface of the router node to send by.
+ * @param[in]  nh_mac  MAC address of the next hop.
+ *
+ * @return     0 on success, -1 with errno EINVAL or ENOMEM.
+ */
+int vnet_route_add(vnet_t *vn, uint32_t prefix, uint8_t plen,
+                   interface_t *intf, const uint8_t *nh_mac);
+
+/**
+ * @brief      Runs frames received on an interface through the graph. When
+ *             it returns, every frame has been queued on an interface or
+ *             freed.
+ *
+ * @param[in]  vn    Forwarding path.
+ * @param[in]  intf  Interface the frames came in by.
+ * @param[in]  pkts  Frames, data on the Ethernet header, not on any glthread.
+ * @param[in]  n     Frames in pkts.
+ */
+void vnet_input(vnet_t *vn, interface_t *intf, pkt_buf_t **pkts, uint32_t n);
+
+/**
+ * @brief      Retrieves the addressing and transmit queue of an interface.
+ */
+static inline vnet_intf_t *vnet_get_intf(vnet_t *vn, interface_t *intf)
+{
+    return &vn->intfs[intf->ifindex];
+}
+
+#endif    // VNET_H
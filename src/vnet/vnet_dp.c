@@ -0,0 +1,328 @@
+/******************************************************************************
+ * @file:        vnet_dp.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        22/10/2026 01:00 AM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the multi-worker dataplane. Staging on
+ *               the dispatching side takes no lock, and a flush splices each
+ *               staged queue onto the inbox in O(1) unless the inbox would
+ *               go over its limit. A worker only signals the dispatcher's
+ *               condition when it has caught up, and the dispatcher only
+ *               signals a worker that sleeps, so a loaded dataplane takes
+ *               no futex calls. The flow hash ends with the murmur3
+ *               finalizer because workers are picked by the high bits.
+ *
+ *               Functions in this file:
+ *                 - vnet_dp_create
+ *                 - vnet_dp_destroy
+ *                 - vnet_dp_flow_hash
+ *                 - vnet_dp_dispatch
+ *                 - vnet_dp_flush
+ *                 - vnet_dp_wait
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 22/10/2026 Marko Trickovic
+ * Initial version.
+ *****************************************************************************/
+
+#ifndef VNET_DP_C
+#define VNET_DP_C
+
+#define _GNU_SOURCE
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include "vnet_dp.h"
+
+static void *vnet_dp_worker(void *arg)
+{
+    vnet_dp_worker_t *w = arg;
+    vnet_dp_t *dp = w->dp;
+    pkt_buf_t *vec[VNET_DP_VECTOR];
+    pkt_queue_t work;
+    uint32_t n;
+
+    pkt_queue_init(&work, PKT_QUEUE_UNBOUNDED);
+    for (;;) {
+        pthread_mutex_lock(&w->lock);
+        while (!w->inbox.count && !w->stop) {
+            w->sleeping = 1;
+            pthread_cond_wait(&w->wake, &w->lock);
+            w->sleeping = 0;
+        }
+        if (w->stop) {
+            pthread_mutex_unlock(&w->lock);
+            break;
+        }
+        pkt_queue_splice(&work, &w->inbox);
+        w->batches++;
+        pthread_mutex_unlock(&w->lock);
+
+        // Run to completion, a vector at a time
+        while (work.count) {
+            n = 0;
+            while (n < VNET_DP_VECTOR && work.count)
+                vec[n++] = pkt_queue_pop(&work);
+            dp->fn(dp->arg, w->id, vec, n);
+
+            pthread_mutex_lock(&w->lock);
+            w->done += n;
+            if (w->done == w->queued)
+                pthread_cond_signal(&w->idle);
+            pthread_mutex_unlock(&w->lock);
+        }
+    }
+    return NULL;
+}
+
+// Pins thread tid to the id-th CPU of the process mask, returns the CPU
+static int vnet_dp_pin(pthread_t tid, uint32_t id)
+{
+    cpu_set_t allowed, one;
+    int count, cpu, i = 0;
+
+    if (sched_getaffinity(0, sizeof(allowed), &allowed))
+        return -1;
+    count = CPU_COUNT(&allowed);
+    if (!count)
+        return -1;
+
+    id %= (uint32_t)count;
+    for (cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, &allowed) || (uint32_t)i++ != id)
+            continue;
+        CPU_ZERO(&one);
+        CPU_SET(cpu, &one);
+        return pthread_setaffinity_np(tid, sizeof(one), &one) ? -1 : cpu;
+    }
+    return -1;
+}
+
+/**
+ * @brief      Starts the workers.
+ *
+ * @param[in]  nworkers  Workers, 0 for one per CPU.
+ * @param[in]  fn        Worker function.
+ * @param[in]  arg       Caller data.
+ * @param[in]  qlimit    Frames waiting per worker, 0 for the default.
+ *
+ * @return     The dataplane, or NULL.
+ */
+vnet_dp_t *vnet_dp_create(uint32_t nworkers, vnet_dp_fn_t fn, void *arg,
+                          uint32_t qlimit)
+{
+    cpu_set_t allowed;
+    vnet_dp_worker_t *w;
+    vnet_dp_t *dp;
+    uint32_t i;
+
+    if (!nworkers) {
+        nworkers = 1;
+        if (!sched_getaffinity(0, sizeof(allowed), &allowed) &&
+            CPU_COUNT(&allowed) > 0)
+            nworkers = (uint32_t)CPU_COUNT(&allowed);
+    }
+    if (!qlimit)
+        qlimit = VNET_DP_QLIMIT;
+
+    dp = calloc(1, sizeof(*dp));
+    if (!dp)
+        return NULL;
+    if (posix_memalign((void **)&dp->workers, 64,
+                       nworkers * sizeof(vnet_dp_worker_t))) {
+        free(dp);
+        return NULL;
+    }
+    memset(dp->workers, 0, nworkers * sizeof(vnet_dp_worker_t));
+    dp->fn = fn;
+    dp->arg = arg;
+
+    for (i = 0; i < nworkers; i++) {
+        w = &dp->workers[i];
+        pkt_queue_init(&w->stage, PKT_QUEUE_UNBOUNDED);
+        pkt_queue_init(&w->inbox, qlimit);
+        pthread_mutex_init(&w->lock, NULL);
+        pthread_cond_init(&w->wake, NULL);
+        pthread_cond_init(&w->idle, NULL);
+        w->dp = dp;
+        w->id = i;
+        if (pthread_create(&w->tid, NULL, vnet_dp_worker, w)) {
+            pthread_cond_destroy(&w->idle);
+            pthread_cond_destroy(&w->wake);
+            pthread_mutex_destroy(&w->lock);
+            break;
+        }
+        w->cpu = vnet_dp_pin(w->tid, i);
+    }
+    dp->nworkers = i;
+
+    if (!dp->nworkers) {
+        free(dp->workers);
+        free(dp);
+        return NULL;
+    }
+    return dp;
+}
+
+/**
+ * @brief      Stops the workers and frees the dataplane.
+ *
+ * @param[in]  dp  Dataplane, may be NULL.
+ */
+void vnet_dp_destroy(vnet_dp_t *dp)
+{
+    vnet_dp_worker_t *w;
+    uint32_t i;
+
+    if (!dp)
+        return;
+
+    for (i = 0; i < dp->nworkers; i++) {
+        w = &dp->workers[i];
+        pthread_mutex_lock(&w->lock);
+        w->stop = 1;
+        pthread_cond_signal(&w->wake);
+        pthread_mutex_unlock(&w->lock);
+    }
+    for (i = 0; i < dp->nworkers; i++) {
+        w = &dp->workers[i];
+        pthread_join(w->tid, NULL);
+        pkt_queue_flush(&w->stage);
+        pkt_queue_flush(&w->inbox);
+        pthread_cond_destroy(&w->idle);
+        pthread_cond_destroy(&w->wake);
+        pthread_mutex_destroy(&w->lock);
+    }
+    free(dp->workers);
+    free(dp);
+}
+
+static inline uint32_t vnet_dp_mix(uint32_t h)
+{
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    return h ^ (h >> 16);
+}
+
+static inline uint32_t vnet_dp_rd32(const unsigned char *p)
+{
+    uint32_t v;
+
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/**
+ * @brief      Hashes the flow of a frame.
+ *
+ * @param[in]  pkt  Frame.
+ *
+ * @return     The hash.
+ */
+uint32_t vnet_dp_flow_hash(const pkt_buf_t *pkt)
+{
+    const unsigned char *p = pkt->data, *ip;
+    uint32_t len = pkt->len, l2 = 14, ihl, h;
+
+    if (len >= 18 && p[12] == 0x81 && p[13] == 0x00)
+        l2 = 18;
+    if (len >= l2 + 20 && p[l2 - 2] == 0x08 && p[l2 - 1] == 0x00 &&
+        (p[l2] >> 4) == 4) {
+        ip = p + l2;
+        ihl = (ip[0] & 0xf) * 4u;
+        h = vnet_dp_rd32(ip + 12) * 0x9e3779b1u ^ vnet_dp_rd32(ip + 16) ^
+            (uint32_t)ip[9] << 24;
+        // Only the first fragment has the ports, so fragments use none
+        if ((ip[9] == 6 || ip[9] == 17) && !(ip[6] & 0x3f) && !ip[7] &&
+            len >= l2 + ihl + 4)
+            h = h * 0x9e3779b1u ^ vnet_dp_rd32(ip + ihl);
+        return vnet_dp_mix(h);
+    }
+
+    if (len < 14)
+        return 0;
+    h = vnet_dp_rd32(p) ^ vnet_dp_rd32(p + 4) * 0x9e3779b1u ^
+        vnet_dp_rd32(p + 8) ^ (uint32_t)(p[12] << 8 | p[13]);
+    return vnet_dp_mix(h);
+}
+
+/**
+ * @brief      Stages frames for their workers.
+ *
+ * @param[in]  dp    Dataplane.
+ * @param[in]  pkts  Frames.
+ * @param[in]  n     Frames in pkts.
+ */
+void vnet_dp_dispatch(vnet_dp_t *dp, pkt_buf_t **pkts, uint32_t n)
+{
+    uint32_t i;
+
+    for (i = 0; i < n; i++) {
+        if (i + 2 < n)
+            __builtin_prefetch(pkts[i + 2]->data);
+        pkt_queue_push(&dp->workers[vnet_dp_worker_of(dp,
+                           vnet_dp_flow_hash(pkts[i]))].stage, pkts[i]);
+    }
+}
+
+/**
+ * @brief      Hands the staged frames to the workers.
+ *
+ * @param[in]  dp  Dataplane.
+ */
+void vnet_dp_flush(vnet_dp_t *dp)
+{
+    vnet_dp_worker_t *w;
+    uint32_t i, room;
+
+    for (i = 0; i < dp->nworkers; i++) {
+        w = &dp->workers[i];
+        if (!w->stage.count)
+            continue;
+
+        pthread_mutex_lock(&w->lock);
+        room = w->inbox.limit - w->inbox.count;
+        if (w->stage.count <= room) {
+            w->queued += w->stage.count;
+            pkt_queue_splice(&w->inbox, &w->stage);
+        } else {
+            // Keep the oldest frames so that each flow stays in order
+            w->queued += room;
+            while (room--)
+                pkt_queue_push(&w->inbox, pkt_queue_pop(&w->stage));
+            w->drops += w->stage.count;
+        }
+        if (w->sleeping)
+            pthread_cond_signal(&w->wake);
+        pthread_mutex_unlock(&w->lock);
+        pkt_queue_flush(&w->stage);
+    }
+}
+
+/**
+ * @brief      Waits until the workers have caught up.
+ *
+ * @param[in]  dp  Dataplane.
+ */
+void vnet_dp_wait(vnet_dp_t *dp)
+{
+    vnet_dp_worker_t *w;
+    uint32_t i;
+
+    for (i = 0; i < dp->nworkers; i++) {
+        w = &dp->workers[i];
+        pthread_mutex_lock(&w->lock);
+        while (w->done != w->queued)
+            pthread_cond_wait(&w->idle, &w->lock);
+        pthread_mutex_unlock(&w->lock);
+    }
+}
+
+#endif    // VNET_DP_C
@@ -0,0 +1,210 @@
+/* -----------------------------------------------------------------------------
+ * @file:        vnet_dp.h
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        22/10/2026 01:00 AM
+ * @license:     MIT
+ * @description: This header file declares the multi-worker dataplane. One
+ *               thread receives frames and hands them to vnet_dp_dispatch,
+ *               which hashes each frame's flow, the IPv4 addresses,
+ *               protocol and ports or the MAC addresses of anything else,
+ *               and stages it for the worker the hash picks. vnet_dp_flush
+ *               moves every staged batch onto its worker's inbox, a
+ *               pkt_queue_t under the worker's lock, with one lock round
+ *               trip per worker. Each worker thread is pinned to its own CPU
+ *               and takes its whole inbox at once, then runs the frames to
+ *               completion through the caller's function in vectors of up
+ *               to VNET_DP_VECTOR. A flow always goes to the same worker and
+ *               every queue is FIFO, so frames of one flow are processed in
+ *               the order they were dispatched.
+ *               The contents are organized into three groups:
+ *
+ *                 1. Structs:
+ *                    - struct vnet_dp_worker_t
+ *                    - struct vnet_dp_t
+ *
+ *                 2. Functions:
+ *                    - vnet_dp_create
+ *                    - vnet_dp_destroy
+ *                    - vnet_dp_flow_hash
+ *                    - vnet_dp_dispatch
+ *                    - vnet_dp_flush
+ *                    - vnet_dp_wait
+ *                    - vnet_dp_worker_of
+ *
+ *                 3. Macros:
+ *                    - VNET_DP_VECTOR
+ *                    - VNET_DP_QLIMIT
+ *
+ * @note:        This code is part of the tcpip-stack project, which is a course
+ *               on network development.
+ *
+ * Revision History:
+ *
+ * Revision 0.1: 22/10/2026 Marko Trickovic
+ * Initial version.
+ */
+
+#ifndef VNET_DP_H
+#define VNET_DP_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include "../pkt/pkt_queue.h"
+
+/** Most frames handed to the worker function at once. */
+#define VNET_DP_VECTOR      256
+
+/** Frames waiting per worker when none is given. */
+#define VNET_DP_QLIMIT      8192
+
+struct vnet_dp_;
+
+/**
+ * @brief      Processes frames on a worker. The frames belong to the
+ *             function afterwards, which must free or keep them.
+ *
+ * @param[in]  arg     Caller data from vnet_dp_create.
+ * @param[in]  worker  Index of the worker, 0 up to nworkers - 1.
+ * @param[in]  pkts    Frames in dispatch order within each flow.
+ * @param[in]  n       Frames in pkts.
+ */
+typedef void (*vnet_dp_fn_t)(void *arg, uint32_t worker, pkt_buf_t **pkts,
+                             uint32_t n);
+
+/**
+ * @brief      The structure representing a worker. The dispatching thread
+ *             owns stage; inbox, sleeping and the counters under lock are
+ *             shared with the worker.
+ *
+ * @struct                vnet_dp_worker_t
+ *
+ * @param[in]  stage      Frames dispatched since the last flush.
+ * @param[in]  lock       Protects the fields below it.
+ * @param[in]  wake       Signalled when frames arrive or on shutdown.
+ * @param[in]  idle       Signalled when the worker has caught up.
+ * @param[in]  inbox      Frames waiting for the worker.
+ * @param[in]  sleeping   1 while the worker waits on wake.
+ * @param[in]  stop       Asks the worker to exit.
+ * @param[in]  queued     Frames put on the inbox so far.
+ * @param[in]  done       Frames processed so far.
+ * @param[in]  drops      Frames dropped because the inbox was full.
+ * @param[in]  batches    Times the worker took its inbox.
+ * @param[in]  dp         Dataplane.
+ * @param[in]  id         Worker index.
+ * @param[in]  cpu        CPU the worker is pinned to, -1 when it is not.
+ * @param[in]  tid        Thread.
+ */
+typedef struct vnet_dp_worker_ {
+    pkt_queue_t stage;
+
+    pthread_mutex_t lock __attribute__((aligned(64)));
+    pthread_cond_t wake;
+    pthread_cond_t idle;
+    pkt_queue_t inbox;
+    int sleeping;
+    int stop;
+    uint64_t queued;
+    uint64_t done;
+    uint64_t drops;
+    uint64_t batches;
+
+    struct vnet_dp_ *dp;
+    uint32_t id;
+    int cpu;
+    pthread_t tid;
+} __attribute__((aligned(64))) vnet_dp_worker_t;
+
+/**
+ * @brief      The structure representing a dataplane.
+ *
+ * @struct                vnet_dp_t
+ *
+ * @param[in]  fn         Worker function.
+ * @param[in]  arg        Caller data for fn.
+ * @param[in]  nworkers   Workers running.
+ * @param[in]  workers    Workers.
+ */
+typedef struct vnet_dp_ {
+    vnet_dp_fn_t fn;
+    void *arg;
+    uint32_t nworkers;
+    vnet_dp_worker_t *workers;
+} vnet_dp_t;
+
+/**
+ * @brief      Starts the workers, worker i pinned to the i-th CPU the
+ *             process may run on, wrapping around when there are more
+ *             workers than CPUs.
+ *
+ * @param[in]  nworkers  Workers, 0 for one per CPU the process may run on.
+ * @param[in]  fn        Worker function.
+ * @param[in]  arg       Caller data for fn.
+ * @param[in]  qlimit    Frames waiting per worker, 0 for VNET_DP_QLIMIT.
+ *
+ * @return     The dataplane, or NULL when out of memory or no thread could
+ *             be started.
+ */
+vnet_dp_t *vnet_dp_create(uint32_t nworkers, vnet_dp_fn_t fn, void *arg,
+                          uint32_t qlimit);
+
+/**
+ * @brief      Stops and joins the workers, frees the frames they did not
+ *             get to and the dataplane.
+ *
+ * @param[in]  dp  Dataplane, may be NULL.
+ */
+void vnet_dp_destroy(vnet_dp_t *dp);
+
+/**
+ * @brief      Hashes the flow of a frame: source and destination address,
+ *             protocol and, for unfragmented TCP and UDP, ports of IPv4,
+ *             after an 802.1Q tag if there is one; the MAC addresses and
+ *             EtherType of anything else.
+ *
+ * @param[in]  pkt  Frame, data on the Ethernet header.
+ *
+ * @return     The hash.
+ */
+uint32_t vnet_dp_flow_hash(const pkt_buf_t *pkt);
+
+/**
+ * @brief      Stages frames for the workers their flows map to. Only one
+ *             thread may dispatch and flush.
+ *
+ * @param[in]  dp    Dataplane.
+ * @param[in]  pkts  Frames, not on any glthread, from a PKT_POOL_MT pool.
+ * @param[in]  n     Frames in pkts.
+ */
+void vnet_dp_dispatch(vnet_dp_t *dp, pkt_buf_t **pkts, uint32_t n);
+
+/**
+ * @brief      Hands the staged frames to the workers and wakes the ones
+ *             that sleep.
+ *
+ * @param[in]  dp  Dataplane.
+ */
+void vnet_dp_flush(vnet_dp_t *dp);
+
+/**
+ * @brief      Waits until the workers have processed every frame flushed
+ *             to them.
+ *
+ * @param[in]  dp  Dataplane.
+ */
+void vnet_dp_wait(vnet_dp_t *dp);
+
+/**
+ * @brief      Maps a flow hash to a worker without a division.
+ *
+ * @param[in]  dp    Dataplane.
+ * @param[in]  hash  Flow hash.
+ *
+ * @return     The worker index.
+ */
+static inline uint32_t vnet_dp_worker_of(const vnet_dp_t *dp, uint32_t hash)
+{
+    return (uint32_t)(((uint64_t)hash * dp->nworkers) >> 32);
+}
+
+#endif    // VNET_DP_H
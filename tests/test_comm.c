@@ -0,0 +1,351 @@
+#include <errno.h>
+#include <string.h>
+#include "unity.h"
+#include "../src/comm/comm.h"
+#include "../src/graph/topologies.h"
+
+#define TEST_BLKS       64
+#define TEST_BLK_SIZE   512
+#define TEST_HEADROOM   64
+#define TEST_WAIT_MS    2000
+
+static graph_t *topo;
+static pkt_pool_t *pool;
+static comm_t *comm;
+
+void setUp(void)
+{
+    topo = build_line_topo(3);
+    pool = pkt_pool_create(TEST_BLKS, TEST_BLK_SIZE, TEST_HEADROOM,
+                           PKT_POOL_MT);
+    TEST_ASSERT_NOT_NULL(topo);
+    TEST_ASSERT_NOT_NULL(pool);
+    comm = NULL;
+}
+
+void tearDown(void)
+{
+    comm_destroy(comm);
+    TEST_ASSERT_EQUAL_UINT32(TEST_BLKS, pool->nfree_blks);
+    pkt_pool_destroy(pool);
+    destroy_graph(topo);
+}
+
+static interface_t *intf_of(const char *node, const char *if_name)
+{
+    return get_node_intf_by_name(get_node_by_node_name(topo, node), if_name);
+}
+
+// Sends len bytes of a pattern out of intf
+static void send_pattern(interface_t *intf, uint32_t len, unsigned char seed)
+{
+    pkt_buf_t *pkt = pkt_buf_alloc_len(pool, len), *seg;
+    uint32_t off = 0, i;
+
+    TEST_ASSERT_NOT_NULL(pkt);
+    ITERATE_PKT_SEGS_BEGIN(pkt, seg) {
+        for (i = 0; i < seg->len; i++)
+            seg->data[i] = (unsigned char)(seed + off++);
+    } ITERATE_PKT_SEGS_ENDS;
+    TEST_ASSERT_EQUAL_INT(0, comm_send(comm, intf, pkt));
+}
+
+static void check_pattern(pkt_buf_t *pkt, uint32_t len, unsigned char seed)
+{
+    pkt_buf_t *seg;
+    uint32_t off = 0, i;
+
+    TEST_ASSERT_NOT_NULL(pkt);
+    TEST_ASSERT_EQUAL_UINT32(len, pkt->pkt_len);
+    ITERATE_PKT_SEGS_BEGIN(pkt, seg) {
+        for (i = 0; i < seg->len; i++)
+            TEST_ASSERT_EQUAL_UINT8((unsigned char)(seed + off++),
+                                    seg->data[i]);
+    } ITERATE_PKT_SEGS_ENDS;
+}
+
+void test_frames_cross_links_both_ways(void)
+{
+    interface_t *r0 = intf_of("R0", "eth0"), *r1_left = intf_of("R1", "eth0");
+    interface_t *r1_right = intf_of("R1", "eth1"), *r2 = intf_of("R2", "eth0");
+    pkt_buf_t *pkt;
+
+    comm = comm_create(topo, pool, 0, 0);
+    TEST_ASSERT_NOT_NULL(comm);
+    TEST_ASSERT_EQUAL_INT(0, comm_start(comm));
+
+    send_pattern(r0, 60, 1);
+    send_pattern(r2, 100, 2);
+    send_pattern(r1_left, 70, 3);
+
+    // R1 receives from both neighbours, each on the right interface
+    pkt = comm_recv(comm, r1_left, TEST_WAIT_MS);
+    check_pattern(pkt, 60, 1);
+    pkt_buf_free(pkt);
+    pkt = comm_recv(comm, r1_right, TEST_WAIT_MS);
+    check_pattern(pkt, 100, 2);
+    pkt_buf_free(pkt);
+    pkt = comm_recv(comm, r0, TEST_WAIT_MS);
+    check_pattern(pkt, 70, 3);
+    pkt_buf_free(pkt);
+
+    TEST_ASSERT_NULL(comm_recv(comm, r1_left, 0));
+    TEST_ASSERT_NULL(comm_recv(comm, r2, 10));
+    TEST_ASSERT_EQUAL_UINT64(1, comm_get_intf(comm, r1_left)->rx_pkts);
+    TEST_ASSERT_EQUAL_UINT64(1, comm_get_intf(comm, r0)->tx_pkts);
+}
+
+void test_burst_keeps_order_and_restarts(void)
+{
+    interface_t *r0 = intf_of("R0", "eth0"), *r1 = intf_of("R1", "eth0");
+    pkt_queue_t out;
+    pkt_buf_t *pkt;
+    uint32_t n = 0, i;
+
+    comm = comm_create(topo, pool, 0, 0);
+    TEST_ASSERT_NOT_NULL(comm);
+    TEST_ASSERT_EQUAL_INT(0, comm_start(comm));
+    pkt_queue_init(&out, PKT_QUEUE_UNBOUNDED);
+
+    for (i = 0; i < 32; i++)
+        send_pattern(r0, 64, (unsigned char)i);
+    while (n < 32 && comm_recv_burst(comm, r1, &out, TEST_WAIT_MS))
+        n = out.count;
+    TEST_ASSERT_EQUAL_UINT32(32, out.count);
+    for (i = 0; i < 32; i++) {
+        pkt = pkt_queue_pop(&out);
+        check_pattern(pkt, 64, (unsigned char)i);
+        pkt_buf_free(pkt);
+    }
+
+    // Stopped, frames wait in the socket until the thread runs again
+    comm_stop(comm);
+    send_pattern(r0, 64, 7);
+    TEST_ASSERT_NULL(comm_recv(comm, r1, 50));
+    TEST_ASSERT_EQUAL_INT(0, comm_start(comm));
+    pkt = comm_recv(comm, r1, TEST_WAIT_MS);
+    check_pattern(pkt, 64, 7);
+    pkt_buf_free(pkt);
+}
+
+void test_jumbo_frames_arrive_as_chains(void)
+{
+    interface_t *r0 = intf_of("R0", "eth0"), *r1 = intf_of("R1", "eth0");
+    pkt_buf_t *pkt;
+
+    comm = comm_create(topo, pool, 9000, 0);
+    TEST_ASSERT_NOT_NULL(comm);
+    TEST_ASSERT_EQUAL_INT(0, comm_start(comm));
+
+    send_pattern(r0, 9000, 5);
+    pkt = comm_recv(comm, r1, TEST_WAIT_MS);
+    check_pattern(pkt, 9000, 5);
+    TEST_ASSERT_TRUE(pkt->nsegs > 1);
+    pkt_buf_free(pkt);
+
+    // A short frame only keeps the segments it needs
+    send_pattern(r0, 10, 6);
+    pkt = comm_recv(comm, r1, TEST_WAIT_MS);
+    check_pattern(pkt, 10, 6);
+    TEST_ASSERT_EQUAL_UINT32(1, pkt->nsegs);
+    pkt_buf_free(pkt);
+}
+
+void test_oversized_frames_and_bad_pools_are_refused(void)
+{
+    interface_t *r0 = intf_of("R0", "eth0"), *r1 = intf_of("R1", "eth0");
+    pkt_pool_t *st_pool = pkt_pool_create(4, 256, 0, 0);
+    pkt_buf_t *pkt;
+
+    TEST_ASSERT_NULL(comm_create(topo, st_pool, 0, 0));
+    TEST_ASSERT_EQUAL_INT(EINVAL, errno);
+    pkt_pool_destroy(st_pool);
+
+    comm = comm_create(topo, pool, 0, 0);
+    TEST_ASSERT_NOT_NULL(comm);
+    TEST_ASSERT_EQUAL_INT(0, comm_start(comm));
+
+    // Larger than one block, the receiver truncates and drops it
+    send_pattern(r0, 1000, 0);
+    send_pattern(r0, 20, 9);
+    pkt = comm_recv(comm, r1, TEST_WAIT_MS);
+    check_pattern(pkt, 20, 9);
+    pkt_buf_free(pkt);
+    TEST_ASSERT_EQUAL_UINT64(1, comm_get_intf(comm, r1)->rx_errs);
+}
+
+// Queues n frames on R0 and checks they leave in the given number of syscalls
+static void check_queued_send(uint32_t flags, uint32_t n, uint64_t syscalls)
+{
+    interface_t *r0 = intf_of("R0", "eth0"), *r1 = intf_of("R1", "eth0");
+    comm_intf_t *ci;
+    pkt_queue_t out;
+    pkt_buf_t *pkt;
+    uint32_t got = 0, i;
+
+    comm = comm_create(topo, pool, 0, flags);
+    TEST_ASSERT_NOT_NULL(comm);
+    TEST_ASSERT_EQUAL_INT(0, comm_start(comm));
+    ci = comm_get_intf(comm, r0);
+    pkt_queue_init(&out, PKT_QUEUE_UNBOUNDED);
+
+    // Below COMM_TX_BATCH nothing leaves until the queue is flushed
+    for (i = 0; i < n; i++) {
+        pkt = pkt_buf_alloc(pool);
+        TEST_ASSERT_NOT_NULL(pkt);
+        memset(pkt_buf_put(pkt, 64), (int)i, 64);
+        TEST_ASSERT_EQUAL_INT(0, comm_enqueue(comm, r0, pkt));
+    }
+    TEST_ASSERT_EQUAL_UINT32(n, ci->txq.count);
+    TEST_ASSERT_NULL(comm_recv(comm, r1, 20));
+
+    TEST_ASSERT_EQUAL_UINT32(n, comm_flush(comm, r0));
+    TEST_ASSERT_TRUE(pkt_queue_empty(&ci->txq));
+    TEST_ASSERT_EQUAL_UINT64(syscalls, ci->tx_syscalls);
+    TEST_ASSERT_EQUAL_UINT64(n, ci->tx_pkts);
+
+    while (got < n && comm_recv_burst(comm, r1, &out, TEST_WAIT_MS))
+        got = out.count;
+    TEST_ASSERT_EQUAL_UINT32(n, out.count);
+    for (i = 0; i < n; i++) {
+        pkt = pkt_queue_pop(&out);
+        TEST_ASSERT_EQUAL_UINT32(64, pkt->pkt_len);
+        TEST_ASSERT_EQUAL_UINT8(i, pkt->data[63]);
+        pkt_buf_free(pkt);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, comm_flush(comm, r0));
+}
+
+void test_queued_frames_leave_in_one_sendmmsg(void)
+{
+    check_queued_send(0, 24, 1);
+}
+
+void test_single_io_sends_one_frame_per_syscall(void)
+{
+    check_queued_send(COMM_SINGLE_IO, 24, 24);
+}
+
+void test_uring_moves_frames_both_ways(void)
+{
+    interface_t *r0 = intf_of("R0", "eth0"), *r1 = intf_of("R1", "eth0");
+    interface_t *r2 = intf_of("R2", "eth0");
+    pkt_queue_t out;
+    pkt_buf_t *pkt;
+    uint32_t got = 0, i;
+
+    comm = comm_create(topo, pool, 0, COMM_URING);
+    TEST_ASSERT_NOT_NULL(comm);
+    if (!(comm->flags & COMM_URING))
+        TEST_IGNORE_MESSAGE("io_uring unavailable, fell back to epoll");
+    TEST_ASSERT_EQUAL_INT(0, comm_start(comm));
+    pkt_queue_init(&out, PKT_QUEUE_UNBOUNDED);
+
+    for (i = 0; i < 16; i++) {
+        pkt = pkt_buf_alloc(pool);
+        TEST_ASSERT_NOT_NULL(pkt);
+        memset(pkt_buf_put(pkt, 64), (int)i, 64);
+        TEST_ASSERT_EQUAL_INT(0, comm_enqueue(comm, r0, pkt));
+    }
+    comm_flush(comm, r0);
+    while (got < 16 && comm_recv_burst(comm, r1, &out, TEST_WAIT_MS))
+        got = out.count;
+    TEST_ASSERT_EQUAL_UINT32(16, out.count);
+    for (i = 0; i < 16; i++) {
+        pkt = pkt_queue_pop(&out);
+        TEST_ASSERT_EQUAL_UINT32(64, pkt->pkt_len);
+        TEST_ASSERT_EQUAL_UINT8(i, pkt->data[0]);
+        pkt_buf_free(pkt);
+    }
+
+    // comm_send bypasses the ring, the receive side is still the ring's
+    send_pattern(r2, 100, 2);
+    pkt = comm_recv(comm, intf_of("R1", "eth1"), TEST_WAIT_MS);
+    check_pattern(pkt, 100, 2);
+    pkt_buf_free(pkt);
+
+    // Stopped, completions wait in the ring until the thread runs again
+    comm_stop(comm);
+    send_pattern(r1, 70, 3);
+    TEST_ASSERT_NULL(comm_recv(comm, r0, 50));
+    TEST_ASSERT_EQUAL_INT(0, comm_start(comm));
+    pkt = comm_recv(comm, r0, TEST_WAIT_MS);
+    check_pattern(pkt, 70, 3);
+    pkt_buf_free(pkt);
+
+    // Larger than max_frame, truncated by the kernel and dropped
+    send_pattern(r0, 1000, 0);
+    send_pattern(r0, 20, 9);
+    pkt = comm_recv(comm, r1, TEST_WAIT_MS);
+    check_pattern(pkt, 20, 9);
+    pkt_buf_free(pkt);
+    TEST_ASSERT_EQUAL_UINT64(1, comm_get_intf(comm, r1)->rx_errs);
+
+    // Only the two comm_send calls made a send syscall of their own
+    TEST_ASSERT_EQUAL_UINT64(18, comm_get_intf(comm, r0)->tx_pkts);
+    TEST_ASSERT_EQUAL_UINT64(2, comm_get_intf(comm, r0)->tx_syscalls);
+}
+
+void test_uring_truncated_frames_between_good_ones(void)
+{
+    interface_t *r0 = intf_of("R0", "eth0"), *r1 = intf_of("R1", "eth0");
+    pkt_buf_t *pkt;
+    uint32_t i;
+
+    comm = comm_create(topo, pool, 0, COMM_URING);
+    TEST_ASSERT_NOT_NULL(comm);
+    if (!(comm->flags & COMM_URING))
+        TEST_IGNORE_MESSAGE("io_uring unavailable, fell back to epoll");
+    TEST_ASSERT_EQUAL_INT(0, comm_start(comm));
+
+    // Truncated and good frames alternate within one pass over the ring,
+    // which must still deliver to each interface once
+    comm_stop(comm);
+    for (i = 0; i < 40; i++) {
+        send_pattern(r0, 1000, 0);
+        send_pattern(r0, 20, (unsigned char)i);
+    }
+    TEST_ASSERT_EQUAL_INT(0, comm_start(comm));
+
+    for (i = 0; i < 40; i++) {
+        pkt = comm_recv(comm, r1, TEST_WAIT_MS);
+        check_pattern(pkt, 20, (unsigned char)i);
+        pkt_buf_free(pkt);
+    }
+    TEST_ASSERT_EQUAL_UINT64(40, comm_get_intf(comm, r1)->rx_errs);
+    TEST_ASSERT_EQUAL_UINT64(40, comm_get_intf(comm, r1)->rx_pkts);
+}
+
+void test_uring_falls_back_to_epoll_for_chains(void)
+{
+    interface_t *r0 = intf_of("R0", "eth0"), *r1 = intf_of("R1", "eth0");
+    pkt_buf_t *pkt;
+
+    comm = comm_create(topo, pool, 9000, COMM_URING);
+    TEST_ASSERT_NOT_NULL(comm);
+    TEST_ASSERT_NULL(comm->uring);
+    TEST_ASSERT_EQUAL_UINT32(0, comm->flags & COMM_URING);
+    TEST_ASSERT_EQUAL_INT(0, comm_start(comm));
+
+    send_pattern(r0, 9000, 5);
+    pkt = comm_recv(comm, r1, TEST_WAIT_MS);
+    check_pattern(pkt, 9000, 5);
+    pkt_buf_free(pkt);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_frames_cross_links_both_ways);
+    RUN_TEST(test_burst_keeps_order_and_restarts);
+    RUN_TEST(test_jumbo_frames_arrive_as_chains);
+    RUN_TEST(test_oversized_frames_and_bad_pools_are_refused);
+    RUN_TEST(test_queued_frames_leave_in_one_sendmmsg);
+    RUN_TEST(test_single_io_sends_one_frame_per_syscall);
+    RUN_TEST(test_uring_moves_frames_both_ways);
+    RUN_TEST(test_uring_truncated_frames_between_good_ones);
+    RUN_TEST(test_uring_falls_back_to_epoll_for_chains);
+
+    return UNITY_END();
+}
@@ -0,0 +1,264 @@
+#include <errno.h>
+#include <string.h>
+#include "unity.h"
+#include "../src/comm/comm_netem.h"
+#include "../src/graph/topologies.h"
+
+#define TEST_BLKS       2048
+#define TEST_BLK_SIZE   256
+#define TEST_HEADROOM   32
+#define TEST_SEED       42
+#define US              1000ull
+#define MS              1000000ull
+
+static graph_t *topo;
+static pkt_pool_t *pool;
+static comm_netem_t *nm;
+static interface_t *tx;
+
+void setUp(void)
+{
+    topo = build_line_topo(2);
+    pool = pkt_pool_create(TEST_BLKS, TEST_BLK_SIZE, TEST_HEADROOM, 0);
+    TEST_ASSERT_NOT_NULL(topo);
+    TEST_ASSERT_NOT_NULL(pool);
+    nm = comm_netem_create(topo, TEST_SEED);
+    TEST_ASSERT_NOT_NULL(nm);
+    tx = get_node_intf_by_name(get_node_by_node_name(topo, "R0"), "eth0");
+}
+
+void tearDown(void)
+{
+    comm_netem_destroy(nm);
+    TEST_ASSERT_EQUAL_UINT32(TEST_BLKS, pool->nfree_blks);
+    pkt_pool_destroy(pool);
+    destroy_graph(topo);
+}
+
+// Allocates a frame of len bytes starting with a 32-bit sequence number
+static pkt_buf_t *make_pkt(uint32_t seq, uint32_t len)
+{
+    pkt_buf_t *pkt = pkt_buf_alloc(pool);
+
+    TEST_ASSERT_NOT_NULL(pkt);
+    memset(pkt_buf_put(pkt, len), 0, len);
+    memcpy(pkt->data, &seq, sizeof(seq));
+    return pkt;
+}
+
+static uint32_t seq_of(const pkt_buf_t *pkt)
+{
+    uint32_t seq;
+
+    memcpy(&seq, pkt->data, sizeof(seq));
+    return seq;
+}
+
+// Sends n frames, one per ns from where the last run stopped, takes each
+// as it comes out and records which ones got through
+static uint32_t run_loss(comm_netem_t *em, uint32_t n, unsigned char *passed)
+{
+    static uint64_t now;
+    pkt_queue_t out;
+    uint32_t i, got = 0;
+
+    pkt_queue_init(&out, PKT_QUEUE_UNBOUNDED);
+    for (i = 0; i < n; i++, now++) {
+        passed[i] = comm_netem_enqueue(em, tx, make_pkt(i, 64), now) == 0;
+        got += comm_netem_dequeue(em, tx, now, &out);
+        pkt_queue_flush(&out);
+    }
+    return got;
+}
+
+void test_unimpaired_link_passes_at_once(void)
+{
+    pkt_queue_t out;
+
+    pkt_queue_init(&out, PKT_QUEUE_UNBOUNDED);
+    TEST_ASSERT_EQUAL_UINT64(UINT64_MAX, comm_netem_next(nm, tx));
+    TEST_ASSERT_EQUAL_INT(0, comm_netem_enqueue(nm, tx, make_pkt(0, 64), 5));
+    TEST_ASSERT_EQUAL_UINT64(5, comm_netem_next(nm, tx));
+    TEST_ASSERT_EQUAL_UINT32(1, comm_netem_dequeue(nm, tx, 5, &out));
+    pkt_queue_flush(&out);
+}
+
+void test_rate_and_delay(void)
+{
+    comm_netem_cfg_t cfg = { .rate_bps = 8000000, .delay_ns = MS };
+    pkt_queue_t out;
+    uint32_t i;
+
+    TEST_ASSERT_EQUAL_INT(0, comm_netem_set(nm, tx, &cfg));
+    pkt_queue_init(&out, PKT_QUEUE_UNBOUNDED);
+
+    // 100 bytes at 1 byte per microsecond, sent back to back
+    for (i = 0; i < 3; i++)
+        comm_netem_enqueue(nm, tx, make_pkt(i, 100), 0);
+    TEST_ASSERT_EQUAL_UINT64(MS + 100 * US, comm_netem_next(nm, tx));
+    TEST_ASSERT_EQUAL_UINT32(0, comm_netem_dequeue(nm, tx, MS + 99 * US,
+                                                   &out));
+    TEST_ASSERT_EQUAL_UINT32(2, comm_netem_dequeue(nm, tx, MS + 200 * US,
+                                                   &out));
+    TEST_ASSERT_EQUAL_UINT64(MS + 300 * US, comm_netem_next(nm, tx));
+
+    // A frame sent after the link went idle is not held up by the others
+    comm_netem_enqueue(nm, tx, make_pkt(3, 100), 10 * MS);
+    TEST_ASSERT_EQUAL_UINT32(1, comm_netem_dequeue(nm, tx, 2 * MS, &out));
+    TEST_ASSERT_EQUAL_UINT64(11 * MS + 100 * US, comm_netem_next(nm, tx));
+    TEST_ASSERT_EQUAL_UINT32(1, comm_netem_dequeue(nm, tx, 12 * MS, &out));
+
+    for (i = 0; i < 4; i++) {
+        pkt_buf_t *pkt = pkt_queue_pop(&out);
+
+        TEST_ASSERT_EQUAL_UINT32(i, seq_of(pkt));
+        pkt_buf_free(pkt);
+    }
+}
+
+void test_jitter_keeps_order(void)
+{
+    comm_netem_cfg_t cfg = { .delay_ns = MS, .jitter_ns = 500 * US };
+    uint64_t last = 0, min = UINT64_MAX, max = 0, due;
+    pkt_queue_t out;
+    pkt_buf_t *pkt;
+    uint32_t i;
+
+    comm_netem_set(nm, tx, &cfg);
+    pkt_queue_init(&out, PKT_QUEUE_UNBOUNDED);
+    for (i = 0; i < 1000; i++) {
+        comm_netem_enqueue(nm, tx, make_pkt(i, 64), i * 100 * US);
+        due = comm_netem_get_intf(nm, tx)->last_due - i * 100 * US;
+        min = due < min ? due : min;
+        max = due > max ? due : max;
+    }
+    TEST_ASSERT_TRUE(min >= 500 * US && min < 600 * US);
+    TEST_ASSERT_TRUE(max > 1400 * US && max <= 1500 * US);
+
+    comm_netem_dequeue(nm, tx, UINT64_MAX, &out);
+    for (i = 0; i < 1000; i++) {
+        pkt = pkt_queue_pop(&out);
+        TEST_ASSERT_EQUAL_UINT32(i, seq_of(pkt));
+        TEST_ASSERT_TRUE(pkt->tstamp >= last);
+        last = pkt->tstamp;
+        pkt_buf_free(pkt);
+    }
+}
+
+void test_reordered_frames_overtake(void)
+{
+    comm_netem_cfg_t cfg = { .delay_ns = MS, .reorder = 0.25 };
+    comm_netem_intf_t *ni = comm_netem_get_intf(nm, tx);
+    uint32_t i, inversions = 0, prev = 0;
+    uint64_t last = 0;
+    pkt_queue_t out;
+    pkt_buf_t *pkt;
+
+    comm_netem_set(nm, tx, &cfg);
+    pkt_queue_init(&out, PKT_QUEUE_UNBOUNDED);
+    for (i = 0; i < 1000; i++)
+        comm_netem_enqueue(nm, tx, make_pkt(i, 64), i * 10 * US);
+    TEST_ASSERT_TRUE(ni->reordered > 200 && ni->reordered < 300);
+
+    TEST_ASSERT_EQUAL_UINT32(1000, comm_netem_dequeue(nm, tx, UINT64_MAX,
+                                                      &out));
+    for (i = 0; i < 1000; i++) {
+        pkt = pkt_queue_pop(&out);
+        TEST_ASSERT_TRUE(pkt->tstamp >= last);
+        if (i && seq_of(pkt) < prev)
+            inversions++;
+        last = pkt->tstamp;
+        prev = seq_of(pkt);
+        pkt_buf_free(pkt);
+    }
+    TEST_ASSERT_TRUE(inversions > 0);
+}
+
+void test_random_and_burst_loss(void)
+{
+    static unsigned char passed[100000];
+    comm_netem_cfg_t cfg = { .loss = 0.1 };
+    comm_netem_intf_t *ni = comm_netem_get_intf(nm, tx);
+    uint32_t got, i, bursts = 0, burst_lost = 0;
+
+    comm_netem_set(nm, tx, &cfg);
+    got = run_loss(nm, 100000, passed);
+    TEST_ASSERT_TRUE(ni->lost > 9000 && ni->lost < 11000);
+    TEST_ASSERT_EQUAL_UINT32(100000 - ni->lost, got);
+
+    // Mean loss p / (p + r) = 1/31, in bursts of 1/r = 3.3 frames on average
+    cfg = (comm_netem_cfg_t){ .ge_p = 0.01, .ge_r = 0.3, .ge_bad = 1.0 };
+    comm_netem_set(nm, tx, &cfg);
+    ni->lost = 0;
+    run_loss(nm, 100000, passed);
+    TEST_ASSERT_EQUAL_UINT64(0, ni->lost);
+    TEST_ASSERT_TRUE(ni->ge_lost > 2500 && ni->ge_lost < 4000);
+    for (i = 0; i < 100000; i++) {
+        if (passed[i])
+            continue;
+        burst_lost++;
+        if (!i || passed[i - 1])
+            bursts++;
+    }
+    TEST_ASSERT_EQUAL_UINT64(ni->ge_lost, burst_lost);
+    TEST_ASSERT_TRUE(burst_lost > 25 * bursts / 10);
+}
+
+void test_same_seed_same_run(void)
+{
+    static unsigned char a[10000], b[10000];
+    comm_netem_cfg_t cfg = { .loss = 0.2, .ge_p = 0.05, .ge_r = 0.5,
+                             .ge_bad = 0.8 };
+    comm_netem_t *other;
+
+    comm_netem_set(nm, tx, &cfg);
+    run_loss(nm, 10000, a);
+
+    other = comm_netem_create(topo, TEST_SEED);
+    comm_netem_set(other, tx, &cfg);
+    run_loss(other, 10000, b);
+    TEST_ASSERT_EQUAL_MEMORY(a, b, sizeof(a));
+    comm_netem_destroy(other);
+
+    // Reconfiguring restarts the draws, another seed changes them
+    comm_netem_set(nm, tx, &cfg);
+    run_loss(nm, 10000, b);
+    TEST_ASSERT_EQUAL_MEMORY(a, b, sizeof(a));
+
+    other = comm_netem_create(topo, TEST_SEED + 1);
+    comm_netem_set(other, tx, &cfg);
+    run_loss(other, 10000, b);
+    TEST_ASSERT_TRUE(memcmp(a, b, sizeof(a)) != 0);
+    comm_netem_destroy(other);
+}
+
+void test_limit_and_bad_config(void)
+{
+    comm_netem_cfg_t cfg = { .delay_ns = MS, .limit = 4 };
+    uint32_t i;
+
+    comm_netem_set_link(nm, tx, &cfg);
+    TEST_ASSERT_EQUAL_UINT32(4, comm_netem_get_intf(nm, tx->nbr)->cfg.limit);
+    for (i = 0; i < 4; i++)
+        TEST_ASSERT_EQUAL_INT(0, comm_netem_enqueue(nm, tx, make_pkt(i, 64),
+                                                    0));
+    TEST_ASSERT_EQUAL_INT(-1, comm_netem_enqueue(nm, tx, make_pkt(4, 64), 0));
+    TEST_ASSERT_EQUAL_UINT64(1, comm_netem_get_intf(nm, tx)->overlimit);
+
+    cfg.loss = 1.5;
+    TEST_ASSERT_EQUAL_INT(-1, comm_netem_set(nm, tx, &cfg));
+    TEST_ASSERT_EQUAL_INT(EINVAL, errno);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_unimpaired_link_passes_at_once);
+    RUN_TEST(test_rate_and_delay);
+    RUN_TEST(test_jitter_keeps_order);
+    RUN_TEST(test_reordered_frames_overtake);
+    RUN_TEST(test_random_and_burst_loss);
+    RUN_TEST(test_same_seed_same_run);
+    RUN_TEST(test_limit_and_bad_config);
+    return UNITY_END();
+}
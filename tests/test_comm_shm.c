@@ -0,0 +1,263 @@
+#include <errno.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "unity.h"
+#include "../src/comm/comm_shm.h"
+#include "../src/graph/topologies.h"
+
+#define TEST_BLKS       256
+#define TEST_BLK_SIZE   128
+#define TEST_HEADROOM   32
+#define TEST_WAIT_MS    2000
+#define TEST_FRAMES     5000
+
+static graph_t *topo;
+static pkt_pool_t *pool;
+static comm_shm_t *sh;
+
+void setUp(void)
+{
+    topo = build_line_topo(2);
+    pool = pkt_pool_create(TEST_BLKS, TEST_BLK_SIZE, TEST_HEADROOM,
+                           PKT_POOL_SHARED);
+    TEST_ASSERT_NOT_NULL(topo);
+    TEST_ASSERT_NOT_NULL(pool);
+    sh = NULL;
+}
+
+void tearDown(void)
+{
+    comm_shm_destroy(sh);
+    TEST_ASSERT_EQUAL_UINT32(TEST_BLKS, pool->nfree_blks);
+    pkt_pool_destroy(pool);
+    destroy_graph(topo);
+}
+
+static interface_t *intf_of(const char *node, const char *if_name)
+{
+    return get_node_intf_by_name(get_node_by_node_name(topo, node), if_name);
+}
+
+// Allocates a packet holding a 32-bit sequence number
+static pkt_buf_t *make_pkt(uint32_t seq)
+{
+    pkt_buf_t *pkt = pkt_buf_alloc(pool);
+
+    if (pkt)
+        memcpy(pkt_buf_put(pkt, sizeof(seq)), &seq, sizeof(seq));
+    return pkt;
+}
+
+static uint32_t seq_of(const pkt_buf_t *pkt)
+{
+    uint32_t seq;
+
+    memcpy(&seq, pkt->data, sizeof(seq));
+    return seq;
+}
+
+// Runs R1 in a child process: every frame goes back out of the interface
+// it came in on, until an empty frame arrives
+static void echo_node(void)
+{
+    comm_shm_node_t *cn = comm_shm_get_node(sh, get_node_by_node_name(topo,
+                                                                      "R1"));
+    interface_t *intf = intf_of("R1", "eth0");
+    pkt_buf_t *pkts[32];
+    uint32_t n, i;
+
+    while (comm_shm_wait(sh, cn, TEST_WAIT_MS)) {
+        n = comm_shm_recv_burst(sh, intf, pkts, 32);
+        for (i = 0; i < n; i++) {
+            if (!pkts[i]->len) {
+                pkt_buf_free(pkts[i]);
+                comm_shm_send_burst(sh, intf, pkts, i);
+                while (comm_shm_flush(sh, intf))
+                    usleep(100);
+                _exit(0);
+            }
+        }
+        comm_shm_send_burst(sh, intf, pkts, n);
+    }
+    _exit(1);
+}
+
+void test_create_needs_shared_pool(void)
+{
+    pkt_pool_t *private = pkt_pool_create(4, TEST_BLK_SIZE, TEST_HEADROOM,
+                                          PKT_POOL_MT);
+
+    TEST_ASSERT_NULL(comm_shm_create(topo, private, 0));
+    TEST_ASSERT_EQUAL_INT(EINVAL, errno);
+    pkt_pool_destroy(private);
+}
+
+void test_frames_cross_processes_in_order(void)
+{
+    interface_t *intf = intf_of("R0", "eth0");
+    comm_shm_node_t *cn;
+    pkt_buf_t *pkt;
+    uint32_t sent = 0, got = 0;
+    int status;
+    pid_t pid;
+
+    sh = comm_shm_create(topo, pool, 64);
+    TEST_ASSERT_NOT_NULL(sh);
+    cn = comm_shm_get_node(sh, get_node_by_node_name(topo, "R0"));
+    TEST_ASSERT_NOT_NULL(cn);
+
+    pid = fork();
+    TEST_ASSERT_TRUE(pid >= 0);
+    if (!pid)
+        echo_node();
+
+    // Fewer frames in flight than a ring holds, so neither side backlogs
+    // and every wait is ended by frames arriving
+    while (got < TEST_FRAMES) {
+        while (sent < TEST_FRAMES && sent - got < 48)
+            comm_shm_send(sh, intf, make_pkt(sent++));
+        comm_shm_flush(sh, intf);
+        TEST_ASSERT_TRUE(comm_shm_wait(sh, cn, TEST_WAIT_MS));
+        while ((pkt = comm_shm_recv(sh, intf))) {
+            TEST_ASSERT_EQUAL_UINT32(got++, seq_of(pkt));
+            pkt_buf_free(pkt);
+        }
+    }
+
+    pkt = pkt_buf_alloc(pool);
+    comm_shm_send(sh, intf, pkt);
+    TEST_ASSERT_EQUAL_INT(pid, waitpid(pid, &status, 0));
+    TEST_ASSERT_TRUE(WIFEXITED(status));
+    TEST_ASSERT_EQUAL_INT(0, WEXITSTATUS(status));
+
+    // Frames freed by the child went back to the one shared pool
+    TEST_ASSERT_EQUAL_UINT32(TEST_BLKS, pool->nfree_blks);
+    TEST_ASSERT_EQUAL_UINT64(TEST_FRAMES + 1,
+                             comm_shm_get_intf(sh, intf)->tx_pkts);
+}
+
+void test_full_ring_backlogs_without_dropping(void)
+{
+    interface_t *out = intf_of("R0", "eth0"), *in = intf_of("R1", "eth0");
+    comm_shm_intf_t *ci;
+    pkt_buf_t *pkts[8];
+    uint32_t i, n, got = 0;
+
+    sh = comm_shm_create(topo, pool, 4);
+    TEST_ASSERT_NOT_NULL(sh);
+    ci = comm_shm_get_intf(sh, out);
+
+    for (i = 0; i < 100; i++)
+        comm_shm_send(sh, out, make_pkt(i));
+    TEST_ASSERT_EQUAL_UINT32(96, ci->backlog.count);
+    TEST_ASSERT_EQUAL_UINT64(96, ci->backlogged);
+
+    while (got < 100) {
+        comm_shm_flush(sh, out);
+        n = comm_shm_recv_burst(sh, in, pkts, 8);
+        TEST_ASSERT_NOT_EQUAL(0, n);
+        for (i = 0; i < n; i++, got++) {
+            TEST_ASSERT_EQUAL_UINT32(got, seq_of(pkts[i]));
+            pkt_buf_free(pkts[i]);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT64(100, ci->tx_pkts);
+}
+
+// Runs R1 in a child process that only receives, checking the order, and
+// exits 0 once count frames came in
+static void sink_node(uint32_t count)
+{
+    comm_shm_node_t *cn = comm_shm_get_node(sh, get_node_by_node_name(topo,
+                                                                      "R1"));
+    interface_t *intf = intf_of("R1", "eth0");
+    pkt_buf_t *pkt;
+    uint32_t got = 0;
+
+    while (got < count && comm_shm_wait(sh, cn, TEST_WAIT_MS)) {
+        while ((pkt = comm_shm_recv(sh, intf))) {
+            if (seq_of(pkt) != got++)
+                _exit(1);
+            pkt_buf_free(pkt);
+        }
+    }
+    _exit(got == count ? 0 : 1);
+}
+
+void test_backlog_drains_while_sender_waits(void)
+{
+    interface_t *intf = intf_of("R0", "eth0");
+    comm_shm_node_t *cn;
+    comm_shm_intf_t *ci;
+    uint32_t i;
+    int status;
+    pid_t pid;
+
+    sh = comm_shm_create(topo, pool, 16);
+    TEST_ASSERT_NOT_NULL(sh);
+    cn = comm_shm_get_node(sh, get_node_by_node_name(topo, "R0"));
+    ci = comm_shm_get_intf(sh, intf);
+
+    pid = fork();
+    TEST_ASSERT_TRUE(pid >= 0);
+    if (!pid)
+        sink_node(200);
+
+    // Traffic goes one way only, so no frame arriving ends the waits: the
+    // backlog moves on because the sink wakes R0 as it empties the ring
+    for (i = 0; i < 200; i++)
+        comm_shm_send(sh, intf, make_pkt(i));
+    TEST_ASSERT_TRUE(ci->backlogged >= 200 - 16);
+    for (i = 0; i < 20 && !pkt_queue_empty(&ci->backlog); i++)
+        TEST_ASSERT_EQUAL_INT(0, comm_shm_wait(sh, cn, 100));
+    TEST_ASSERT_EQUAL_UINT32(0, ci->backlog.count);
+
+    TEST_ASSERT_EQUAL_INT(pid, waitpid(pid, &status, 0));
+    TEST_ASSERT_TRUE(WIFEXITED(status));
+    TEST_ASSERT_EQUAL_INT(0, WEXITSTATUS(status));
+    TEST_ASSERT_EQUAL_UINT64(200, ci->tx_pkts);
+}
+
+void test_wakeup_only_when_idle(void)
+{
+    comm_shm_node_t *cn;
+    int status;
+    pid_t pid;
+
+    sh = comm_shm_create(topo, pool, 0);
+    TEST_ASSERT_NOT_NULL(sh);
+    cn = comm_shm_get_node(sh, get_node_by_node_name(topo, "R1"));
+
+    // A node that is not waiting is never signalled
+    comm_shm_send(sh, intf_of("R0", "eth0"), make_pkt(0));
+    TEST_ASSERT_EQUAL_UINT64(0, cn->wakeups);
+    TEST_ASSERT_EQUAL_INT(1, comm_shm_wait(sh, cn, 0));
+    TEST_ASSERT_EQUAL_UINT64(0, cn->sleeps);
+    pkt_buf_free(comm_shm_recv(sh, intf_of("R1", "eth0")));
+    TEST_ASSERT_EQUAL_INT(0, comm_shm_wait(sh, cn, 10));
+    TEST_ASSERT_EQUAL_UINT64(1, cn->sleeps);
+
+    // One blocked in another process is, once
+    pid = fork();
+    TEST_ASSERT_TRUE(pid >= 0);
+    if (!pid)
+        _exit(comm_shm_wait(sh, cn, TEST_WAIT_MS) ? 0 : 1);
+    while (!__atomic_load_n(&cn->idle, __ATOMIC_ACQUIRE))
+        usleep(1000);
+    comm_shm_send(sh, intf_of("R0", "eth0"), make_pkt(1));
+    TEST_ASSERT_EQUAL_INT(pid, waitpid(pid, &status, 0));
+    TEST_ASSERT_EQUAL_INT(0, WEXITSTATUS(status));
+    TEST_ASSERT_EQUAL_UINT64(1, cn->wakeups);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_create_needs_shared_pool);
+    RUN_TEST(test_frames_cross_processes_in_order);
+    RUN_TEST(test_full_ring_backlogs_without_dropping);
+    RUN_TEST(test_backlog_drains_while_sender_waits);
+    RUN_TEST(test_wakeup_only_when_idle);
+    return UNITY_END();
+}
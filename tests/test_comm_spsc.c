@@ -0,0 +1,137 @@
+#include "unity.h"
+#include "../src/comm/comm_spsc.h"
+#include "../src/graph/topologies.h"
+
+#define TEST_BLKS       64
+#define TEST_BLK_SIZE   128
+#define TEST_HEADROOM   32
+
+static graph_t *topo;
+static pkt_pool_t *pool;
+static comm_spsc_t *sp;
+
+void setUp(void)
+{
+    topo = build_line_topo(3);
+    pool = pkt_pool_create(TEST_BLKS, TEST_BLK_SIZE, TEST_HEADROOM, 0);
+    TEST_ASSERT_NOT_NULL(topo);
+    TEST_ASSERT_NOT_NULL(pool);
+    sp = NULL;
+}
+
+void tearDown(void)
+{
+    comm_spsc_destroy(sp);
+    TEST_ASSERT_EQUAL_UINT32(TEST_BLKS, pool->nfree_blks);
+    pkt_pool_destroy(pool);
+    destroy_graph(topo);
+}
+
+static interface_t *intf_of(const char *node, const char *if_name)
+{
+    return get_node_intf_by_name(get_node_by_node_name(topo, node), if_name);
+}
+
+// Allocates a packet holding one byte
+static pkt_buf_t *make_pkt(unsigned char val)
+{
+    pkt_buf_t *pkt = pkt_buf_alloc(pool);
+
+    TEST_ASSERT_NOT_NULL(pkt);
+    *pkt_buf_put(pkt, 1) = val;
+    return pkt;
+}
+
+void test_frames_cross_links_both_ways(void)
+{
+    pkt_buf_t *pkt, *sent;
+
+    sp = comm_spsc_create(topo, 0);
+    TEST_ASSERT_NOT_NULL(sp);
+
+    // The very buffer that was sent comes out at the neighbour
+    sent = make_pkt(1);
+    TEST_ASSERT_EQUAL_INT(0, comm_spsc_send(sp, intf_of("R0", "eth0"), sent));
+    TEST_ASSERT_NULL(comm_spsc_recv(sp, intf_of("R0", "eth0")));
+    TEST_ASSERT_NULL(comm_spsc_recv(sp, intf_of("R1", "eth1")));
+    pkt = comm_spsc_recv(sp, intf_of("R1", "eth0"));
+    TEST_ASSERT_EQUAL_PTR(sent, pkt);
+    pkt_buf_free(pkt);
+
+    TEST_ASSERT_EQUAL_INT(0, comm_spsc_send(sp, intf_of("R2", "eth0"),
+                                            make_pkt(2)));
+    pkt = comm_spsc_recv(sp, intf_of("R1", "eth1"));
+    TEST_ASSERT_NOT_NULL(pkt);
+    TEST_ASSERT_EQUAL_UINT8(2, pkt->data[0]);
+    pkt_buf_free(pkt);
+
+    TEST_ASSERT_EQUAL_UINT64(1, comm_spsc_get_intf(sp,
+                                intf_of("R0", "eth0"))->tx_pkts);
+    TEST_ASSERT_EQUAL_UINT64(1, comm_spsc_get_intf(sp,
+                                intf_of("R1", "eth1"))->rx_pkts);
+}
+
+void test_full_ring_spills_to_backlog_in_order(void)
+{
+    interface_t *out = intf_of("R0", "eth0"), *in = intf_of("R1", "eth0");
+    pkt_buf_t *pkts[16];
+    comm_spsc_intf_t *ci;
+    uint32_t i, n, got = 0;
+
+    sp = comm_spsc_create(topo, 4);
+    TEST_ASSERT_NOT_NULL(sp);
+    ci = comm_spsc_get_intf(sp, out);
+
+    for (i = 0; i < 6; i++)
+        pkts[i] = make_pkt((unsigned char)i);
+    TEST_ASSERT_EQUAL_UINT32(6, comm_spsc_send_burst(sp, out, pkts, 6));
+    TEST_ASSERT_EQUAL_UINT32(2, ci->backlog.count);
+    TEST_ASSERT_EQUAL_UINT64(2, ci->backlogged);
+
+    // A later frame queues behind the backlog rather than overtaking it
+    n = comm_spsc_recv_burst(sp, in, pkts, 1);
+    TEST_ASSERT_EQUAL_UINT32(1, n);
+    pkt_buf_free(pkts[0]);
+    got++;
+    TEST_ASSERT_EQUAL_INT(0, comm_spsc_send(sp, out, make_pkt(6)));
+    TEST_ASSERT_EQUAL_UINT32(2, ci->backlog.count);
+
+    while (got < 7) {
+        comm_spsc_flush(sp, out);
+        n = comm_spsc_recv_burst(sp, in, pkts, 16);
+        TEST_ASSERT_NOT_EQUAL(0, n);
+        for (i = 0; i < n; i++, got++) {
+            TEST_ASSERT_EQUAL_UINT8(got, pkts[i]->data[0]);
+            pkt_buf_free(pkts[i]);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, comm_spsc_flush(sp, out));
+    TEST_ASSERT_EQUAL_UINT64(7, ci->tx_pkts);
+    TEST_ASSERT_EQUAL_UINT64(0, ci->tx_drops);
+}
+
+void test_destroy_frees_rings_and_backlogs(void)
+{
+    uint32_t i;
+
+    sp = comm_spsc_create(topo, 2);
+    TEST_ASSERT_NOT_NULL(sp);
+
+    // Two frames in each ring, the rest waits on the senders' backlogs
+    for (i = 0; i < 5; i++) {
+        comm_spsc_send(sp, intf_of("R0", "eth0"), make_pkt(0));
+        comm_spsc_send(sp, intf_of("R1", "eth1"), make_pkt(1));
+    }
+    TEST_ASSERT_EQUAL_UINT32(3, comm_spsc_get_intf(sp,
+                                intf_of("R1", "eth1"))->backlog.count);
+    TEST_ASSERT_EQUAL_UINT32(TEST_BLKS - 10, pool->nfree_blks);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_frames_cross_links_both_ways);
+    RUN_TEST(test_full_ring_spills_to_backlog_in_order);
+    RUN_TEST(test_destroy_frees_rings_and_backlogs);
+    return UNITY_END();
+}
@@ -0,0 +1,230 @@
+#include <string.h>
+#include "unity.h"
+#include "../src/net/ethernet.h"
+
+#define TEST_BLKS       64
+#define TEST_HEADROOM   32
+
+static const uint8_t mac_a[6] = { 0x02, 0, 0, 0, 0, 0x0a };
+static const uint8_t mac_b[6] = { 0x02, 0, 0, 0, 0, 0x0b };
+static const uint8_t bcast[6] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+
+static pkt_pool_t *pool;
+
+void setUp(void)
+{
+    pool = pkt_pool_create(TEST_BLKS, 128, TEST_HEADROOM, 0);
+    TEST_ASSERT_NOT_NULL(pool);
+}
+
+void tearDown(void)
+{
+    TEST_ASSERT_EQUAL_UINT32(TEST_BLKS, pool->nfree_blks);
+    pkt_pool_destroy(pool);
+}
+
+// Builds a 60-byte frame to dst, tagged with vid unless it is 0
+static pkt_buf_t *make_frame(const uint8_t *dst, uint16_t type, uint16_t vid)
+{
+    pkt_buf_t *pkt = pkt_buf_alloc(pool);
+    unsigned char *p;
+
+    TEST_ASSERT_NOT_NULL(pkt);
+    p = pkt_buf_put(pkt, 60);
+    memset(p, 0, 60);
+    memcpy(p, dst, 6);
+    memcpy(p + 6, mac_b, 6);
+    if (vid) {
+        p[12] = 0x81;
+        p[14] = (unsigned char)(0x20 | vid >> 8);
+        p[15] = (unsigned char)vid;
+        p += 4;
+    }
+    p[12] = (unsigned char)(type >> 8);
+    p[13] = (unsigned char)type;
+    return pkt;
+}
+
+void test_parse_untagged(void)
+{
+    pkt_buf_t *pkt = make_frame(mac_a, ETHERNET_TYPE_IP4, 0);
+    ethernet_frame_t frame;
+
+    TEST_ASSERT_EQUAL_INT(0, ethernet_parse(pkt, &frame));
+    TEST_ASSERT_EQUAL_PTR(pkt->data, frame.eth);
+    TEST_ASSERT_NULL(frame.vlan);
+    TEST_ASSERT_EQUAL_PTR(pkt->data + 14, frame.payload);
+    TEST_ASSERT_EQUAL_HEX16(ETHERNET_TYPE_IP4, frame.type);
+    TEST_ASSERT_EQUAL_UINT16(ETHERNET_HDR_LEN, frame.hlen);
+    TEST_ASSERT_EQUAL_MEMORY(mac_b, frame.eth->src, 6);
+
+    // Writes through the view land in the packet
+    ethernet_rewrite(frame.eth, mac_b, mac_a);
+    TEST_ASSERT_EQUAL_MEMORY(mac_b, pkt->data, 6);
+    TEST_ASSERT_EQUAL_MEMORY(mac_a, pkt->data + 6, 6);
+    pkt_buf_free(pkt);
+}
+
+void test_parse_tagged(void)
+{
+    pkt_buf_t *pkt = make_frame(mac_a, ETHERNET_TYPE_ARP, 100);
+    ethernet_frame_t frame;
+
+    TEST_ASSERT_EQUAL_INT(0, ethernet_parse(pkt, &frame));
+    TEST_ASSERT_EQUAL_PTR(pkt->data, frame.vlan);
+    TEST_ASSERT_EQUAL_PTR(pkt->data + 18, frame.payload);
+    TEST_ASSERT_EQUAL_HEX16(ETHERNET_TYPE_ARP, frame.type);
+    TEST_ASSERT_EQUAL_UINT16(100, frame.vid);
+    TEST_ASSERT_EQUAL_HEX16(ETHERNET_TYPE_VLAN, ntohs(frame.vlan->tpid));
+    pkt_buf_free(pkt);
+}
+
+void test_parse_short_and_split(void)
+{
+    pkt_buf_t *pkt = make_frame(mac_a, ETHERNET_TYPE_IP4, 100);
+    pkt_buf_t *seg = pkt_buf_alloc(pool);
+    ethernet_frame_t frame;
+
+    // The tag and type are in a second segment
+    TEST_ASSERT_NOT_NULL(seg);
+    memcpy(pkt_buf_put(seg, 50), pkt->data + 10, 50);
+    pkt_buf_trim(pkt, 10);
+    pkt_buf_append(pkt, seg);
+    TEST_ASSERT_EQUAL_INT(0, ethernet_parse(pkt, &frame));
+    TEST_ASSERT_EQUAL_UINT16(100, frame.vid);
+    TEST_ASSERT_EQUAL_HEX16(ETHERNET_TYPE_IP4, frame.type);
+    TEST_ASSERT_TRUE(pkt->len >= ETHERNET_VLAN_HDR_LEN);
+    pkt_buf_free(pkt);
+
+    pkt = make_frame(mac_a, ETHERNET_TYPE_IP4, 100);
+    pkt_buf_trim(pkt, 16);
+    TEST_ASSERT_EQUAL_INT(-1, ethernet_parse(pkt, &frame));
+    pkt_buf_trim(pkt, 13);
+    TEST_ASSERT_NULL(ethernet_hdr(pkt));
+    pkt_buf_free(pkt);
+}
+
+void test_build_in_headroom(void)
+{
+    pkt_buf_t *pkt = pkt_buf_alloc(pool), *clone;
+    unsigned char *payload;
+    ethernet_hdr_t *eth;
+
+    TEST_ASSERT_NOT_NULL(pkt);
+    payload = pkt_buf_put(pkt, 46);
+    memset(payload, 0x5a, 46);
+
+    eth = ethernet_build(pkt, mac_a, mac_b, ETHERNET_TYPE_IP4);
+    TEST_ASSERT_NOT_NULL(eth);
+    TEST_ASSERT_EQUAL_PTR(payload - ETHERNET_HDR_LEN, eth);
+    TEST_ASSERT_EQUAL_PTR(pkt->data, eth);
+    TEST_ASSERT_EQUAL_UINT32(60, pkt->pkt_len);
+    TEST_ASSERT_EQUAL_HEX8(0x08, pkt->data[12]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, pkt->data[13]);
+    TEST_ASSERT_EQUAL_HEX8(0x5a, pkt->data[14]);
+
+    // A clone gets its own block rather than writing into shared headroom
+    pkt_buf_pull(pkt, ETHERNET_HDR_LEN);
+    clone = pkt_buf_clone(pkt);
+    TEST_ASSERT_NOT_NULL(clone);
+    eth = ethernet_build(clone, bcast, mac_b, ETHERNET_TYPE_ARP);
+    TEST_ASSERT_NOT_NULL(eth);
+    TEST_ASSERT_EQUAL_HEX8(0x08, pkt->data[-2]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, pkt->data[-1]);
+    TEST_ASSERT_EQUAL_HEX8(0x06, clone->data[13]);
+    pkt_buf_free(clone);
+
+    // Without headroom nothing is written
+    pkt_buf_push(pkt, pkt_buf_headroom(pkt));
+    TEST_ASSERT_NULL(ethernet_build(pkt, mac_a, mac_b, ETHERNET_TYPE_IP4));
+    pkt_buf_free(pkt);
+}
+
+void test_vlan_push_pop(void)
+{
+    pkt_buf_t *pkt = make_frame(mac_a, ETHERNET_TYPE_IP4, 0), *clone;
+    unsigned char *payload = pkt->data + ETHERNET_HDR_LEN;
+    ethernet_vlan_hdr_t *vlan;
+    ethernet_frame_t frame;
+
+    TEST_ASSERT_EQUAL_INT(-1, ethernet_vlan_pop(pkt));
+
+    vlan = ethernet_vlan_push(pkt, 0x2000 | 42);
+    TEST_ASSERT_NOT_NULL(vlan);
+    TEST_ASSERT_EQUAL_PTR(pkt->data, vlan);
+    TEST_ASSERT_EQUAL_UINT32(64, pkt->pkt_len);
+    TEST_ASSERT_EQUAL_INT(0, ethernet_parse(pkt, &frame));
+    TEST_ASSERT_EQUAL_UINT16(42, frame.vid);
+    TEST_ASSERT_EQUAL_HEX16(ETHERNET_TYPE_IP4, frame.type);
+    TEST_ASSERT_EQUAL_MEMORY(mac_a, frame.eth->dst, 6);
+    TEST_ASSERT_EQUAL_MEMORY(mac_b, frame.eth->src, 6);
+    // The payload did not move
+    TEST_ASSERT_EQUAL_PTR(payload, frame.payload);
+
+    TEST_ASSERT_EQUAL_INT(0x2000 | 42, ethernet_vlan_pop(pkt));
+    TEST_ASSERT_EQUAL_PTR(payload - ETHERNET_HDR_LEN, pkt->data);
+    TEST_ASSERT_EQUAL_UINT32(60, pkt->pkt_len);
+    TEST_ASSERT_EQUAL_INT(0, ethernet_parse(pkt, &frame));
+    TEST_ASSERT_NULL(frame.vlan);
+    TEST_ASSERT_EQUAL_MEMORY(mac_b, frame.eth->src, 6);
+
+    // A clone is tagged in its own block
+    clone = pkt_buf_clone(pkt);
+    TEST_ASSERT_NOT_NULL(clone);
+    TEST_ASSERT_NOT_NULL(ethernet_vlan_push(clone, 7));
+    TEST_ASSERT_FALSE(pkt_buf_is_shared(pkt));
+    TEST_ASSERT_EQUAL_HEX8(0x08, pkt->data[12]);
+    TEST_ASSERT_EQUAL_HEX8(0x81, clone->data[12]);
+    pkt_buf_free(clone);
+
+    // Without headroom nothing is written: the frame moved to the front
+    memmove(pkt->data - TEST_HEADROOM, pkt->data, 60);
+    pkt_buf_push(pkt, TEST_HEADROOM);
+    pkt_buf_trim(pkt, 60);
+    TEST_ASSERT_NULL(ethernet_vlan_push(pkt, 7));
+    TEST_ASSERT_EQUAL_MEMORY(mac_a, pkt->data, 6);
+    pkt_buf_free(pkt);
+}
+
+void test_demux(void)
+{
+    pkt_queue_t rxq, ip4q, arpq;
+    pkt_buf_t *pkt;
+
+    pkt_queue_init(&rxq, PKT_QUEUE_UNBOUNDED);
+    pkt_queue_init(&ip4q, PKT_QUEUE_UNBOUNDED);
+    pkt_queue_init(&arpq, 1);
+    pkt_queue_push(&rxq, make_frame(mac_a, ETHERNET_TYPE_IP4, 0));
+    pkt_queue_push(&rxq, make_frame(bcast, ETHERNET_TYPE_ARP, 0));
+    pkt_queue_push(&rxq, make_frame(mac_a, ETHERNET_TYPE_IP4, 7));
+    pkt_queue_push(&rxq, make_frame(mac_b, ETHERNET_TYPE_IP4, 0));
+    pkt_queue_push(&rxq, make_frame(mac_a, 0x86dd, 0));
+    pkt_queue_push(&rxq, make_frame(bcast, ETHERNET_TYPE_ARP, 0));
+
+    // Another host's unicast, IPv6 and the ARP frame over the limit go
+    TEST_ASSERT_EQUAL_UINT32(3, ethernet_demux(&rxq, mac_a, &ip4q, &arpq));
+    TEST_ASSERT_TRUE(pkt_queue_empty(&rxq));
+    TEST_ASSERT_EQUAL_UINT32(2, ip4q.count);
+    TEST_ASSERT_EQUAL_UINT32(1, arpq.count);
+
+    pkt = pkt_queue_pop(&ip4q);
+    TEST_ASSERT_EQUAL_UINT16(0, pkt->vlan);
+    pkt_buf_free(pkt);
+    pkt = pkt_queue_pop(&ip4q);
+    TEST_ASSERT_EQUAL_UINT16(7, pkt->vlan);
+    TEST_ASSERT_EQUAL_HEX8(0x81, pkt->data[12]);
+    pkt_buf_free(pkt);
+    pkt_queue_flush(&arpq);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_parse_untagged);
+    RUN_TEST(test_parse_tagged);
+    RUN_TEST(test_parse_short_and_split);
+    RUN_TEST(test_build_in_headroom);
+    RUN_TEST(test_vlan_push_pop);
+    RUN_TEST(test_demux);
+    return UNITY_END();
+}
@@ -1,4 +1,5 @@
 #include "unity.h"
+#include "unity_perf.h"
 #include "../src/glthreads/glthreads.h"
 
 // Define a structure for testing purposes
@@ -69,6 +70,27 @@ void test_glthread_add_next(void)
     TEST_ASSERT_EQUAL_PTR(&node2, node3.left);
 }
 
+void test_glthread_add_after(void)
+{
+    TestData node1 = {1, {NULL, NULL}};
+    TestData node2 = {2, {NULL, NULL}};
+    TestData node3 = {3, {NULL, NULL}};
+
+    // No node to add after, so node1 becomes the head
+    glthread_add_after(&linkedList, NULL, &node1.glnode);
+    TEST_ASSERT_EQUAL_PTR(&node1.glnode, linkedList.head);
+    TEST_ASSERT_NULL(node1.glnode.left);
+
+    // Appending at the tail, then between the two
+    glthread_add_after(&linkedList, &node1.glnode, &node3.glnode);
+    glthread_add_after(&linkedList, &node1.glnode, &node2.glnode);
+    TEST_ASSERT_EQUAL_PTR(&node2.glnode, node1.glnode.right);
+    TEST_ASSERT_EQUAL_PTR(&node1.glnode, node2.glnode.left);
+    TEST_ASSERT_EQUAL_PTR(&node3.glnode, node2.glnode.right);
+    TEST_ASSERT_EQUAL_PTR(&node2.glnode, node3.glnode.left);
+    TEST_ASSERT_NULL(node3.glnode.right);
+}
+
 void test_glthread_add(void)
 {
     glthread_t lst;
@@ -125,14 +147,127 @@ void test_glthread_remove(void) {
     TEST_ASSERT_NULL(linkedList.head);  // List should be empty
 }
 
+void test_glthread_remove_fixes_both_neighbours(void)
+{
+    TestData node1 = {1, {NULL, NULL}};
+    TestData node2 = {2, {NULL, NULL}};
+    TestData node3 = {3, {NULL, NULL}};
+
+    glthread_add(&linkedList, &node1.glnode);
+    glthread_add(&linkedList, &node2.glnode);
+    glthread_add(&linkedList, &node3.glnode);
+
+    // List is node3 <-> node2 <-> node1, take out the middle
+    glthread_remove(&linkedList, &node2.glnode);
+    TEST_ASSERT_EQUAL_PTR(&node1.glnode, node3.glnode.right);
+    TEST_ASSERT_EQUAL_PTR(&node3.glnode, node1.glnode.left);
+    TEST_ASSERT_NULL(node2.glnode.left);
+    TEST_ASSERT_NULL(node2.glnode.right);
+
+    // Removing a detached node leaves the list alone
+    glthread_remove(&linkedList, &node2.glnode);
+    TEST_ASSERT_EQUAL_PTR(&node3.glnode, linkedList.head);
+    TEST_ASSERT_EQUAL_PTR(&node1.glnode, node3.glnode.right);
+}
+
+// Performance budgets. The lists are long enough that an O(n) operation
+// costs thousands of ns/op, far beyond the budgets even in unoptimized builds.
+#define PERF_NODES 10000
+
+typedef struct {
+    TestData nodes[PERF_NODES];
+    unsigned int order[PERF_NODES];
+    glthread_t lst;
+} PerfContext;
+
+static PerfContext perf;
+
+static void perf_setup_empty(void *ctx)
+{
+    PerfContext *p = ctx;
+    unsigned int i;
+
+    init_glthread(&p->lst, offset(TestData, glnode));
+    for (i = 0; i < PERF_NODES; i++) {
+        p->nodes[i].data = (int)i;
+        glthread_node_init((&p->nodes[i].glnode));
+    }
+}
+
+static void perf_setup_full(void *ctx)
+{
+    PerfContext *p = ctx;
+    unsigned int i;
+
+    perf_setup_empty(ctx);
+    for (i = 0; i < PERF_NODES; i++)
+        glthread_add(&p->lst, &p->nodes[i].glnode);
+}
+
+static void perf_body_add(void *ctx)
+{
+    PerfContext *p = ctx;
+    unsigned int i;
+
+    for (i = 0; i < PERF_NODES; i++)
+        glthread_add(&p->lst, &p->nodes[i].glnode);
+}
+
+static void perf_body_remove(void *ctx)
+{
+    PerfContext *p = ctx;
+    unsigned int i;
+
+    for (i = 0; i < PERF_NODES; i++)
+        glthread_remove(&p->lst, &p->nodes[p->order[i]].glnode);
+}
+
+void test_glthread_add_perf(void)
+{
+    UnityPerfSpec spec = {
+        .name = "glthread_add",
+        .setup = perf_setup_empty,
+        .body = perf_body_add,
+        .ctx = &perf,
+        .ops = PERF_NODES,
+        .budget_ns = 100.0,
+    };
+
+    TEST_ASSERT_PERF(&spec);
+}
+
+void test_glthread_remove_perf(void)
+{
+    UnityPerfSpec spec = {
+        .name = "glthread_remove",
+        .setup = perf_setup_full,
+        .body = perf_body_remove,
+        .ctx = &perf,
+        .ops = PERF_NODES,
+        .budget_ns = 100.0,
+    };
+    unsigned int i;
+
+    // Remove in a scattered order, oldest nodes (at the tail) included
+    for (i = 0; i < PERF_NODES; i++)
+        perf.order[i] = (i * 7919u) % PERF_NODES;
+
+    TEST_ASSERT_PERF(&spec);
+    TEST_ASSERT_NULL(perf.lst.head);
+}
+
 int main(void)
 {
     UNITY_BEGIN();
 
     RUN_TEST(test_init_glthread);
     RUN_TEST(test_glthread_add_next);
+    RUN_TEST(test_glthread_add_after);
     RUN_TEST(test_glthread_add);
     RUN_TEST(test_glthread_remove);
+    RUN_TEST(test_glthread_remove_fixes_both_neighbours);
+    RUN_TEST(test_glthread_add_perf);
+    RUN_TEST(test_glthread_remove_perf);
 
     return UNITY_END();
 }
@@ -0,0 +1,157 @@
+#include "unity.h"
+#include "../src/glthreads/glthreads.h"
+#include "../src/glthreads/glthreads_par.h"
+
+// Define a structure for testing purposes
+typedef struct {
+    unsigned int data;
+    unsigned int visits;
+    glthread_node_t glnode;
+} TestData;
+
+// Accumulator used by the tests: element count, sum and order check
+typedef struct {
+    unsigned long long count;
+    unsigned long long sum;
+    unsigned int first;
+    unsigned int last;
+    int ordered;
+} TestAcc;
+
+#define NODES 100000
+
+static TestData nodes[NODES];
+static glthread_t linkedList;
+static glthread_pool_t *pool;
+
+static void visit(void *elem, void *acc, void *arg)
+{
+    TestData *d = elem;
+    TestAcc *a = acc;
+
+    (void)arg;
+    d->visits++;
+
+    // The list is built so that data increases by one along each range
+    if (!a->count)
+        a->first = d->data;
+    a->last = d->data;
+    a->count++;
+    a->sum += d->data;
+}
+
+static void reduce(void *result, const void *acc, void *arg)
+{
+    TestAcc *r = result;
+    const TestAcc *a = acc;
+
+    (void)arg;
+    if (!a->count)
+        return;
+
+    // Ranges must arrive in list order with no gaps between them
+    if (r->count && a->first != r->last + 1)
+        r->ordered = 0;
+    if (!r->count)
+        r->first = a->first;
+
+    r->last = a->last;
+    r->count += a->count;
+    r->sum += a->sum;
+}
+
+static void build_list(unsigned int n)
+{
+    unsigned int i;
+
+    init_glthread(&linkedList, offset(TestData, glnode));
+
+    // glthread_add pushes at the head, so add in reverse to get 0..n-1
+    for (i = n; i > 0; i--) {
+        nodes[i - 1].data = i - 1;
+        nodes[i - 1].visits = 0;
+        glthread_add(&linkedList, &nodes[i - 1].glnode);
+    }
+}
+
+void setUp(void)
+{
+    pool = glthread_pool_create(3);
+}
+
+void tearDown(void)
+{
+    glthread_pool_destroy(pool);
+}
+
+void test_pool_size_includes_caller(void)
+{
+    TEST_ASSERT_EQUAL_UINT(4, glthread_pool_size(pool));
+    TEST_ASSERT_EQUAL_UINT(1, glthread_pool_size(NULL));
+}
+
+void test_every_element_visited_once_and_reduced_in_order(void)
+{
+    TestAcc result = {0, 0, 0, 0, 1};
+    unsigned int i;
+
+    build_list(NODES);
+
+    TEST_ASSERT_EQUAL_INT(0, glthread_par_for_each(pool, &linkedList, visit,
+                                                   NULL, &result,
+                                                   sizeof(TestAcc), reduce));
+
+    for (i = 0; i < NODES; i++)
+        TEST_ASSERT_EQUAL_UINT(1, nodes[i].visits);
+
+    TEST_ASSERT_EQUAL_UINT64(NODES, result.count);
+    TEST_ASSERT_EQUAL_UINT64((unsigned long long)NODES * (NODES - 1) / 2,
+                             result.sum);
+    TEST_ASSERT_EQUAL_UINT(0, result.first);
+    TEST_ASSERT_EQUAL_UINT(NODES - 1, result.last);
+    TEST_ASSERT_TRUE(result.ordered);
+}
+
+void test_pool_is_reusable_and_handles_short_lists(void)
+{
+    TestAcc result;
+    unsigned int n;
+
+    // Shorter, equal to and a little longer than the number of ranges
+    for (n = 0; n < 70; n++) {
+        TestAcc init = {0, 0, 0, 0, 1};
+
+        result = init;
+        build_list(n);
+        TEST_ASSERT_EQUAL_INT(0, glthread_par_for_each(pool, &linkedList,
+                                                       visit, NULL, &result,
+                                                       sizeof(TestAcc),
+                                                       reduce));
+        TEST_ASSERT_EQUAL_UINT64(n, result.count);
+        TEST_ASSERT_TRUE(result.ordered);
+    }
+}
+
+void test_runs_without_pool(void)
+{
+    TestAcc result = {0, 0, 0, 0, 1};
+
+    build_list(1000);
+    TEST_ASSERT_EQUAL_INT(0, glthread_par_for_each(NULL, &linkedList, visit,
+                                                   NULL, &result,
+                                                   sizeof(TestAcc), reduce));
+    TEST_ASSERT_EQUAL_UINT64(1000, result.count);
+    TEST_ASSERT_EQUAL_UINT64(999ull * 1000 / 2, result.sum);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_pool_size_includes_caller);
+    RUN_TEST(test_every_element_visited_once_and_reduced_in_order);
+    RUN_TEST(test_pool_is_reusable_and_handles_short_lists);
+    RUN_TEST(test_runs_without_pool);
+
+    return UNITY_END();
+}
@@ -0,0 +1,178 @@
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "unity.h"
+#include "../src/glthreads/glthreads_reloc.h"
+
+// Define a structure for testing purposes
+typedef struct {
+    int data;
+    glthread_rel_node_t glnode;
+} TestData;
+
+#define NODES       1000
+#define ARENA_SIZE  (1 << 20)
+
+static char path[] = "/tmp/test_glthreads_reloc_XXXXXX";
+static glthread_arena_t arena;
+
+// Builds NODES elements in list order 0..NODES-1 and closes the arena
+static void build_arena(void)
+{
+    glthread_rel_t *lst;
+    TestData *d, *prev = NULL;
+    int i;
+
+    TEST_ASSERT_EQUAL_INT(0, glthread_arena_create(&arena, path, ARENA_SIZE));
+    lst = glthread_arena_alloc(&arena, sizeof(*lst));
+    TEST_ASSERT_NOT_NULL(lst);
+    init_glthread_rel(lst, offsetof(TestData, glnode));
+    glthread_arena_set_root(&arena, 0, lst);
+
+    for (i = 0; i < NODES; i++) {
+        d = glthread_arena_alloc(&arena, sizeof(*d));
+        TEST_ASSERT_NOT_NULL(d);
+        d->data = i;
+        glthread_rel_node_init((&d->glnode));
+        if (prev)
+            glthread_rel_add_next(&prev->glnode, &d->glnode);
+        else
+            glthread_rel_add(lst, &d->glnode);
+        prev = d;
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, glthread_arena_sync(&arena));
+    glthread_arena_close(&arena);
+}
+
+static int count_in_order(glthread_rel_t *lst)
+{
+    TestData *d;
+    int expect = 0;
+
+    ITERATE_GL_THREADS_REL_BEGIN(lst, TestData, d) {
+        if (d->data != expect)
+            return -1;
+        expect++;
+    } ITERATE_GL_THREADS_REL_ENDS;
+
+    return expect;
+}
+
+void setUp(void)
+{
+    int fd = mkstemp(path);
+
+    TEST_ASSERT_TRUE(fd >= 0);
+    close(fd);
+}
+
+void tearDown(void)
+{
+    unlink(path);
+    memcpy(path + sizeof(path) - 7, "XXXXXX", 6);    // template for mkstemp
+}
+
+void test_arena_survives_remap_at_another_address(void)
+{
+    glthread_arena_t a, b;
+    glthread_rel_t *la, *lb;
+
+    build_arena();
+
+    // Keep both mappings alive so they cannot share an address
+    TEST_ASSERT_EQUAL_INT(0, glthread_arena_open(&a, path, 0));
+    TEST_ASSERT_EQUAL_INT(0, glthread_arena_open(&b, path,
+                                                 GLTHREAD_ARENA_PRIVATE));
+    TEST_ASSERT_TRUE(a.base != b.base);
+
+    la = glthread_arena_get_root(&a, 0);
+    lb = glthread_arena_get_root(&b, 0);
+    TEST_ASSERT_NOT_NULL(la);
+    TEST_ASSERT_NOT_NULL(lb);
+    TEST_ASSERT_EQUAL_INT(NODES, count_in_order(la));
+    TEST_ASSERT_EQUAL_INT(NODES, count_in_order(lb));
+    TEST_ASSERT_NULL(glthread_arena_get_root(&a, 1));
+
+    glthread_arena_close(&a);
+    glthread_arena_close(&b);
+}
+
+void test_remove_persists_and_private_changes_do_not(void)
+{
+    glthread_rel_t *lst;
+    TestData *d;
+    int n = 0;
+
+    build_arena();
+
+    // Remove every odd element through a private mapping first
+    TEST_ASSERT_EQUAL_INT(0, glthread_arena_open(&arena, path,
+                                                 GLTHREAD_ARENA_PRIVATE));
+    lst = glthread_arena_get_root(&arena, 0);
+    ITERATE_GL_THREADS_REL_BEGIN(lst, TestData, d) {
+        if (d->data & 1)
+            glthread_rel_remove(lst, &d->glnode);
+    } ITERATE_GL_THREADS_REL_ENDS;
+    glthread_arena_close(&arena);
+
+    TEST_ASSERT_EQUAL_INT(0, glthread_arena_open(&arena, path, 0));
+    lst = glthread_arena_get_root(&arena, 0);
+    TEST_ASSERT_EQUAL_INT(NODES, count_in_order(lst));
+
+    // Now through a shared mapping, including the head and the tail
+    ITERATE_GL_THREADS_REL_BEGIN(lst, TestData, d) {
+        if (d->data & 1 || d->data == 0 || d->data == NODES - 2)
+            glthread_rel_remove(lst, &d->glnode);
+    } ITERATE_GL_THREADS_REL_ENDS;
+    glthread_rel_remove(lst, &d->glnode);    // detached, no effect
+    glthread_arena_close(&arena);
+
+    TEST_ASSERT_EQUAL_INT(0, glthread_arena_open(&arena, path, 0));
+    lst = glthread_arena_get_root(&arena, 0);
+    ITERATE_GL_THREADS_REL_BEGIN(lst, TestData, d) {
+        TEST_ASSERT_EQUAL_INT(2 * (n + 1), d->data);
+        n++;
+    } ITERATE_GL_THREADS_REL_ENDS;
+    TEST_ASSERT_EQUAL_INT(NODES / 2 - 2, n);
+    glthread_arena_close(&arena);
+}
+
+void test_alloc_fails_when_full(void)
+{
+    void *p;
+    int n = 0;
+
+    TEST_ASSERT_EQUAL_INT(0, glthread_arena_create(&arena, path, 4096));
+    while ((p = glthread_arena_alloc(&arena, 100)))
+        n++;
+    TEST_ASSERT_TRUE(n > 0 && n < 4096 / 100);
+    TEST_ASSERT_NULL(glthread_arena_alloc(&arena, 1 << 20));
+    glthread_arena_close(&arena);
+}
+
+void test_open_rejects_foreign_file(void)
+{
+    FILE *fp = fopen(path, "w");
+
+    TEST_ASSERT_NOT_NULL(fp);
+    fprintf(fp, "%0512d", 0);
+    fclose(fp);
+
+    TEST_ASSERT_EQUAL_INT(-1, glthread_arena_open(&arena, path, 0));
+    TEST_ASSERT_EQUAL_INT(EINVAL, errno);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_arena_survives_remap_at_another_address);
+    RUN_TEST(test_remove_persists_and_private_changes_do_not);
+    RUN_TEST(test_alloc_fails_when_full);
+    RUN_TEST(test_open_rejects_foreign_file);
+
+    return UNITY_END();
+}
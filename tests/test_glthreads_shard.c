@@ -0,0 +1,130 @@
+#include <pthread.h>
+#include "unity.h"
+#include "../src/glthreads/glthreads.h"
+#include "../src/glthreads/glthreads_shard.h"
+
+// Define a structure for testing purposes
+typedef struct {
+    int data;
+    glthread_node_t glnode;
+} TestData;
+
+#define NODES 64
+
+static glthread_sharded_t pool;
+static TestData nodes[NODES];
+
+static TestData *to_data(glthread_node_t *node)
+{
+    return node ? (TestData *)GLTHREAD_GET_USER_DATA_FROM_OFFSET(
+                                  node, offset(TestData, glnode))
+                : NULL;
+}
+
+void setUp(void)
+{
+    int i;
+
+    TEST_ASSERT_EQUAL_INT(0, glthread_sharded_init(&pool,
+                                                   offset(TestData, glnode),
+                                                   4));
+    for (i = 0; i < NODES; i++) {
+        nodes[i].data = i;
+        glthread_node_init((&nodes[i].glnode));
+    }
+}
+
+void tearDown(void)
+{
+    glthread_sharded_destroy(&pool);
+}
+
+void test_shards_are_cache_line_aligned(void)
+{
+    TEST_ASSERT_EQUAL_UINT(0, (uintptr_t)pool.shards % GLTHREAD_CACHE_LINE);
+    TEST_ASSERT_EQUAL_UINT(0, sizeof(glthread_shard_t) % GLTHREAD_CACHE_LINE);
+}
+
+void test_pop_returns_local_nodes_first(void)
+{
+    glthread_sharded_push_shard(&pool, 0, &nodes[0].glnode);
+    glthread_sharded_push_shard(&pool, 1, &nodes[1].glnode);
+
+    TEST_ASSERT_EQUAL_PTR(&nodes[1], to_data(glthread_sharded_pop_shard(&pool, 1)));
+    TEST_ASSERT_EQUAL_PTR(&nodes[0], to_data(glthread_sharded_pop_shard(&pool, 0)));
+    TEST_ASSERT_NULL(glthread_sharded_pop_shard(&pool, 2));
+}
+
+void test_pop_steals_half_of_a_victim(void)
+{
+    glthread_node_t *node;
+    int i;
+
+    for (i = 0; i < 10; i++)
+        glthread_sharded_push_shard(&pool, 2, &nodes[i].glnode);
+
+    // Shard 0 is empty: it takes 5 nodes, returns one and keeps four
+    node = glthread_sharded_pop_shard(&pool, 0);
+    TEST_ASSERT_NOT_NULL(node);
+    TEST_ASSERT_NULL(node->left);
+    TEST_ASSERT_NULL(node->right);
+    TEST_ASSERT_EQUAL_UINT(4, pool.shards[0].count);
+    TEST_ASSERT_EQUAL_UINT(5, pool.shards[2].count);
+    TEST_ASSERT_EQUAL_UINT(9, glthread_sharded_count(&pool));
+
+    // Both lists must still be well formed
+    TEST_ASSERT_NULL(pool.shards[0].list.head->left);
+    TEST_ASSERT_NULL(pool.shards[2].list.head->left);
+
+    // Drain everything, each node comes back exactly once
+    for (i = 0; i < 9; i++)
+        TEST_ASSERT_NOT_NULL(glthread_sharded_pop_shard(&pool, 0));
+    TEST_ASSERT_NULL(glthread_sharded_pop_shard(&pool, 0));
+    TEST_ASSERT_EQUAL_UINT(0, glthread_sharded_count(&pool));
+}
+
+#define WORKERS 4
+#define ROUNDS  20000
+
+static void *pool_worker(void *arg)
+{
+    glthread_node_t *node;
+    int i;
+
+    (void)arg;
+    for (i = 0; i < ROUNDS; i++) {
+        node = glthread_sharded_pop(&pool);
+        if (node)
+            glthread_sharded_push(&pool, node);
+    }
+
+    return NULL;
+}
+
+void test_concurrent_push_pop_keeps_every_node(void)
+{
+    pthread_t tid[WORKERS];
+    int i;
+
+    for (i = 0; i < NODES; i++)
+        glthread_sharded_push_shard(&pool, (unsigned int)i, &nodes[i].glnode);
+
+    for (i = 0; i < WORKERS; i++)
+        pthread_create(&tid[i], NULL, pool_worker, NULL);
+    for (i = 0; i < WORKERS; i++)
+        pthread_join(tid[i], NULL);
+
+    TEST_ASSERT_EQUAL_UINT(NODES, glthread_sharded_count(&pool));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_shards_are_cache_line_aligned);
+    RUN_TEST(test_pop_returns_local_nodes_first);
+    RUN_TEST(test_pop_steals_half_of_a_victim);
+    RUN_TEST(test_concurrent_push_pop_keeps_every_node);
+
+    return UNITY_END();
+}
@@ -0,0 +1,170 @@
+#include <pthread.h>
+#include "unity.h"
+#include "../src/glthreads/glthreads.h"
+#include "../src/glthreads/glthreads_stats.h"
+#include "../src/pkt/pkt_queue.h"
+
+// Define a structure for testing purposes
+typedef struct {
+    int data;
+    glthread_node_t glnode;
+} TestData;
+
+// Set up a linked list for testing
+static glthread_t linkedList;
+
+void setUp(void)
+{
+    init_glthread(&linkedList, offset(TestData, glnode));
+    glthread_stats_reset();
+}
+
+void tearDown(void)
+{
+    // Clean up after each test
+}
+
+void test_list_length_and_high_water_mark(void)
+{
+    TestData node1 = {1, {NULL, NULL}};
+    TestData node2 = {2, {NULL, NULL}};
+    TestData node3 = {3, {NULL, NULL}};
+
+    TEST_ASSERT_EQUAL_UINT(0, linkedList.count);
+    TEST_ASSERT_EQUAL_UINT(0, linkedList.count_hwm);
+
+    glthread_add(&linkedList, &node1.glnode);
+    glthread_add(&linkedList, &node2.glnode);
+    glthread_add(&linkedList, &node3.glnode);
+    TEST_ASSERT_EQUAL_UINT(3, linkedList.count);
+    TEST_ASSERT_EQUAL_UINT(3, linkedList.count_hwm);
+
+    glthread_remove(&linkedList, &node2.glnode);
+    glthread_remove(&linkedList, &node3.glnode);
+    TEST_ASSERT_EQUAL_UINT(1, linkedList.count);
+    TEST_ASSERT_EQUAL_UINT(3, linkedList.count_hwm);
+
+    // Removing a node that is not on the list must not change the length
+    glthread_remove(&linkedList, &node2.glnode);
+    TEST_ASSERT_EQUAL_UINT(1, linkedList.count);
+}
+
+void test_appended_nodes_count_towards_the_length(void)
+{
+    TestData nodes[4] = {{0}};
+    glthread_node_t *tail = NULL;
+    glthread_stats_t s;
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        glthread_add_after(&linkedList, tail, &nodes[i].glnode);
+        tail = &nodes[i].glnode;
+    }
+    glthread_remove(&linkedList, &nodes[0].glnode);
+    TEST_ASSERT_EQUAL_UINT(3, linkedList.count);
+    TEST_ASSERT_EQUAL_UINT(4, linkedList.count_hwm);
+
+    glthread_stats_snapshot(&s);
+    TEST_ASSERT_EQUAL_UINT64(4, s.ops[GLTHREAD_OP_ADD_AFTER]);
+    TEST_ASSERT_EQUAL_UINT64(0, s.ops[GLTHREAD_OP_ADD_NEXT]);
+}
+
+void test_packet_queue_keeps_the_length(void)
+{
+    pkt_pool_t *pool = pkt_pool_create(8, 128, 0, 0);
+    pkt_queue_t a, b;
+    int i;
+
+    TEST_ASSERT_NOT_NULL(pool);
+    pkt_queue_init(&a, PKT_QUEUE_UNBOUNDED);
+    pkt_queue_init(&b, PKT_QUEUE_UNBOUNDED);
+    for (i = 0; i < 3; i++)
+        pkt_queue_push(&a, pkt_buf_alloc(pool));
+    pkt_queue_push(&b, pkt_buf_alloc(pool));
+
+    // Popped by hand and spliced in one step, both still counted
+    pkt_buf_free(pkt_queue_pop(&a));
+    pkt_queue_splice(&b, &a);
+    TEST_ASSERT_EQUAL_UINT(0, a.lst.count);
+    TEST_ASSERT_EQUAL_UINT(3, a.lst.count_hwm);
+    TEST_ASSERT_EQUAL_UINT(b.count, b.lst.count);
+    TEST_ASSERT_EQUAL_UINT(3, b.lst.count_hwm);
+
+    pkt_queue_flush(&b);
+    TEST_ASSERT_EQUAL_UINT(0, b.lst.count);
+    pkt_pool_destroy(pool);
+}
+
+void test_operation_counters(void)
+{
+    TestData node1 = {1, {NULL, NULL}};
+    TestData node2 = {2, {NULL, NULL}};
+    glthread_stats_t s;
+    uint64_t hist_total = 0;
+    unsigned int b;
+
+    glthread_add(&linkedList, &node1.glnode);
+    glthread_add_next(&node1.glnode, &node2.glnode);
+    glthread_remove(&linkedList, &node1.glnode);
+
+    glthread_stats_snapshot(&s);
+
+    // glthread_add must not count its internal linking as an add_next
+    TEST_ASSERT_EQUAL_UINT64(1, s.ops[GLTHREAD_OP_ADD]);
+    TEST_ASSERT_EQUAL_UINT64(1, s.ops[GLTHREAD_OP_ADD_NEXT]);
+    TEST_ASSERT_EQUAL_UINT64(1, s.ops[GLTHREAD_OP_REMOVE]);
+
+    for (b = 0; b < GLTHREAD_STATS_HIST_BUCKETS; b++)
+        hist_total += s.hist[GLTHREAD_OP_ADD][b];
+    TEST_ASSERT_EQUAL_UINT64(1, hist_total);
+
+    glthread_stats_reset();
+    glthread_stats_snapshot(&s);
+    TEST_ASSERT_EQUAL_UINT64(0, s.ops[GLTHREAD_OP_ADD]);
+    TEST_ASSERT_EQUAL_UINT64(0, s.ops[GLTHREAD_OP_REMOVE]);
+}
+
+#define WORKER_NODES 1000
+
+static void *add_worker(void *arg)
+{
+    TestData *nodes = arg;
+    glthread_t lst;
+    int i;
+
+    init_glthread(&lst, offset(TestData, glnode));
+    for (i = 0; i < WORKER_NODES; i++)
+        glthread_add(&lst, &nodes[i].glnode);
+
+    return NULL;
+}
+
+void test_counters_are_summed_across_threads(void)
+{
+    static TestData nodes[2][WORKER_NODES];
+    pthread_t tid[2];
+    glthread_stats_t s;
+    int i;
+
+    for (i = 0; i < 2; i++)
+        pthread_create(&tid[i], NULL, add_worker, nodes[i]);
+    for (i = 0; i < 2; i++)
+        pthread_join(tid[i], NULL);
+
+    glthread_stats_snapshot(&s);
+    TEST_ASSERT_EQUAL_UINT64(2 * WORKER_NODES, s.ops[GLTHREAD_OP_ADD]);
+    TEST_ASSERT_TRUE(s.threads >= 2);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_list_length_and_high_water_mark);
+    RUN_TEST(test_appended_nodes_count_towards_the_length);
+    RUN_TEST(test_packet_queue_keeps_the_length);
+    RUN_TEST(test_operation_counters);
+    RUN_TEST(test_counters_are_summed_across_threads);
+
+    return UNITY_END();
+}
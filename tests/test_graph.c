@@ -0,0 +1,128 @@
+#include <stdio.h>
+#include "unity.h"
+#include "../src/graph/graph.h"
+
+static graph_t *topo;
+
+void setUp(void)
+{
+    topo = create_new_graph("test");
+    TEST_ASSERT_NOT_NULL(topo);
+}
+
+void tearDown(void)
+{
+    destroy_graph(topo);
+}
+
+void test_nodes_are_listed_in_creation_order(void)
+{
+    glthread_t *lst = &topo->node_list;
+    char name[NODE_NAME_SIZE];
+    node_t *node;
+    uint32_t i = 0;
+
+    // Enough nodes to span several blocks and grow the name table
+    for (i = 0; i < 1000; i++) {
+        snprintf(name, sizeof(name), "R%u", i);
+        TEST_ASSERT_NOT_NULL(create_graph_node(topo, name));
+    }
+    TEST_ASSERT_EQUAL_UINT32(1000, topo->node_count);
+
+    i = 0;
+    ITERATE_GL_THREADS_BEGIN(lst, node_t, node) {
+        TEST_ASSERT_EQUAL_UINT32(i, node->node_id);
+        TEST_ASSERT_EQUAL_PTR(node, get_node_by_node_name(topo,
+                                                          node->node_name));
+        i++;
+    } ITERATE_GL_THREADS_ENDS;
+    TEST_ASSERT_EQUAL_UINT32(1000, i);
+
+    TEST_ASSERT_NULL(get_node_by_node_name(topo, "R1000"));
+}
+
+void test_node_names_must_be_unique_and_fit(void)
+{
+    TEST_ASSERT_NOT_NULL(create_graph_node(topo, "R0_re"));
+    TEST_ASSERT_NULL(create_graph_node(topo, "R0_re"));
+    TEST_ASSERT_NULL(create_graph_node(topo, ""));
+    TEST_ASSERT_NULL(create_graph_node(topo, "0123456789abcdef"));
+    TEST_ASSERT_EQUAL_UINT32(1, topo->node_count);
+}
+
+void test_link_connects_interfaces(void)
+{
+    node_t *R0 = create_graph_node(topo, "R0_re");
+    node_t *R1 = create_graph_node(topo, "R1_re");
+    interface_t *i0, *i1;
+
+    TEST_ASSERT_EQUAL_INT(0, insert_link_between_two_nodes(R0, R1, "eth0/0",
+                                                           "eth0/1", 7));
+
+    i0 = get_node_intf_by_name(R0, "eth0/0");
+    i1 = get_node_intf_by_name(R1, "eth0/1");
+    TEST_ASSERT_NOT_NULL(i0);
+    TEST_ASSERT_NOT_NULL(i1);
+    TEST_ASSERT_NULL(get_node_intf_by_name(R0, "eth0/1"));
+
+    TEST_ASSERT_EQUAL_PTR(R1, get_nbr_node(i0));
+    TEST_ASSERT_EQUAL_PTR(R0, get_nbr_node(i1));
+    TEST_ASSERT_EQUAL_PTR(i0->link, i1->link);
+    TEST_ASSERT_EQUAL_UINT(7, i0->link->cost);
+    TEST_ASSERT_EQUAL_UINT32(7, i1->cost);
+    TEST_ASSERT_EQUAL_STRING("eth0/1", get_intf_name(i1));
+
+    TEST_ASSERT_EQUAL_PTR(i0, get_intf_by_ifindex(topo, i0->ifindex));
+    TEST_ASSERT_EQUAL_PTR(i1, get_intf_by_ifindex(topo, i1->ifindex));
+    TEST_ASSERT_NULL(get_intf_by_ifindex(topo, 0));
+    TEST_ASSERT_NULL(get_intf_by_ifindex(topo, 3));
+
+    // Interface names are per node
+    TEST_ASSERT_EQUAL_INT(-1, insert_link_between_two_nodes(R0, R1, "eth0/0",
+                                                            "eth0/2", 1));
+    TEST_ASSERT_EQUAL_INT(0, insert_link_between_two_nodes(R0, R1, "eth0/1",
+                                                           "eth0/0", 1));
+}
+
+void test_link_fails_cleanly_when_out_of_slots(void)
+{
+    node_t *hub = create_graph_node(topo, "hub");
+    node_t *leaf = create_graph_node(topo, "leaf");
+    node_t *spare = create_graph_node(topo, "spare");
+    char if_name[IF_NAME_SIZE];
+    int i;
+
+    for (i = 0; i < MAX_INTF_PER_NODE; i++) {
+        snprintf(if_name, sizeof(if_name), "eth%d", i);
+        TEST_ASSERT_EQUAL_INT(0, insert_link_between_two_nodes(hub, leaf,
+                                                               if_name,
+                                                               if_name, 1));
+    }
+    TEST_ASSERT_EQUAL_INT(-1, get_node_intf_available_slot(hub));
+
+    // A failed link leaves the node with a free slot untouched
+    TEST_ASSERT_EQUAL_INT(-1, insert_link_between_two_nodes(spare, hub, "x",
+                                                            "y", 1));
+    TEST_ASSERT_EQUAL_UINT32(0, spare->intf_count);
+    TEST_ASSERT_NULL(get_node_intf_by_name(spare, "x"));
+    TEST_ASSERT_EQUAL_UINT32(2 * MAX_INTF_PER_NODE + 1, topo->ifindex_next);
+
+    // Name lookups still work with every slot in use
+    for (i = 0; i < MAX_INTF_PER_NODE; i++) {
+        snprintf(if_name, sizeof(if_name), "eth%d", i);
+        TEST_ASSERT_EQUAL_PTR(&hub->intf[i], get_node_intf_by_name(hub,
+                                                                   if_name));
+    }
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_nodes_are_listed_in_creation_order);
+    RUN_TEST(test_node_names_must_be_unique_and_fit);
+    RUN_TEST(test_link_connects_interfaces);
+    RUN_TEST(test_link_fails_cleanly_when_out_of_slots);
+
+    return UNITY_END();
+}
@@ -0,0 +1,296 @@
+#include <errno.h>
+#include <string.h>
+#include "unity.h"
+#include "../src/l2/l2_switch.h"
+#include "../src/net/ethernet.h"
+
+#define TEST_BLKS       64
+#define TEST_PORTS      70
+
+static const uint8_t mac_a[6] = { 0x02, 0, 0, 0, 0, 0x0a };
+static const uint8_t mac_b[6] = { 0x02, 0, 0, 0, 0, 0x0b };
+static const uint8_t bcast[6] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+
+static pkt_pool_t *pool;
+static l2_switch_t *sw;
+
+void setUp(void)
+{
+    uint32_t p;
+
+    pool = pkt_pool_create(TEST_BLKS, 128, 32, 0);
+    TEST_ASSERT_NOT_NULL(pool);
+    sw = l2_switch_create(TEST_PORTS, 1024, 16);
+    TEST_ASSERT_NOT_NULL(sw);
+
+    // VLAN 10 on ports 0, 1, 2 and 65, VLAN 20 on ports 3 and 66
+    for (p = 0; p < TEST_PORTS; p++)
+        TEST_ASSERT_EQUAL_INT(0, l2_switch_port_set(sw, p, 1, 10));
+    TEST_ASSERT_EQUAL_INT(0, l2_switch_vlan_add(sw, 10, 0));
+    TEST_ASSERT_EQUAL_INT(0, l2_switch_vlan_add(sw, 10, 1));
+    TEST_ASSERT_EQUAL_INT(0, l2_switch_vlan_add(sw, 10, 2));
+    TEST_ASSERT_EQUAL_INT(0, l2_switch_vlan_add(sw, 10, 65));
+    TEST_ASSERT_EQUAL_INT(0, l2_switch_vlan_add(sw, 20, 3));
+    TEST_ASSERT_EQUAL_INT(0, l2_switch_vlan_add(sw, 20, 66));
+    TEST_ASSERT_EQUAL_INT(0, l2_switch_port_set(sw, 3, 1, 20));
+    TEST_ASSERT_EQUAL_INT(0, l2_switch_port_set(sw, 66, 1, 20));
+}
+
+void tearDown(void)
+{
+    l2_switch_destroy(sw);
+    TEST_ASSERT_EQUAL_UINT32(TEST_BLKS, pool->nfree_blks);
+    pkt_pool_destroy(pool);
+}
+
+// Builds a 60-byte untagged frame
+static pkt_buf_t *make_frame(const uint8_t *dst, const uint8_t *src)
+{
+    pkt_buf_t *pkt = pkt_buf_alloc(pool);
+    unsigned char *p;
+
+    TEST_ASSERT_NOT_NULL(pkt);
+    p = pkt_buf_put(pkt, 60);
+    TEST_ASSERT_NOT_NULL(p);
+    memset(p, 0, 60);
+    memcpy(p, dst, 6);
+    memcpy(p + 6, src, 6);
+    p[12] = 0x08;
+    return pkt;
+}
+
+static void input(uint32_t port, const uint8_t *dst, const uint8_t *src)
+{
+    pkt_buf_t *pkt = make_frame(dst, src);
+
+    l2_switch_input(sw, port, &pkt, 1);
+}
+
+// Sends a frame tagged with vid, which may be 0 for a priority tag
+static void input_tagged(uint32_t port, const uint8_t *dst,
+                         const uint8_t *src, uint16_t vid)
+{
+    pkt_buf_t *pkt = make_frame(dst, src);
+
+    TEST_ASSERT_NOT_NULL(ethernet_vlan_push(pkt, vid));
+    l2_switch_input(sw, port, &pkt, 1);
+}
+
+// Takes the frame queued on a port, checking its tag
+static void expect_frame(uint32_t port, int vid)
+{
+    pkt_buf_t *pkt = pkt_queue_pop(&sw->ports[port].txq);
+    ethernet_frame_t frame;
+
+    TEST_ASSERT_NOT_NULL(pkt);
+    TEST_ASSERT_EQUAL_INT(0, ethernet_parse(pkt, &frame));
+    if (vid < 0) {
+        TEST_ASSERT_NULL(frame.vlan);
+    } else {
+        TEST_ASSERT_NOT_NULL(frame.vlan);
+        TEST_ASSERT_EQUAL_UINT16(vid, frame.vid);
+    }
+    TEST_ASSERT_EQUAL_HEX16(ETHERNET_TYPE_IP4, frame.type);
+    TEST_ASSERT_EQUAL_UINT32(port, pkt->tx_ifindex);
+    pkt_buf_free(pkt);
+}
+
+static uint32_t queued(uint32_t port)
+{
+    return sw->ports[port].txq.count;
+}
+
+void test_flood_to_vlan_members(void)
+{
+    pkt_buf_t *p1, *p2, *p65;
+
+    input(0, bcast, mac_a);
+    TEST_ASSERT_EQUAL_UINT32(0, queued(0));
+    TEST_ASSERT_EQUAL_UINT32(1, queued(1));
+    TEST_ASSERT_EQUAL_UINT32(1, queued(2));
+    TEST_ASSERT_EQUAL_UINT32(1, queued(65));
+    TEST_ASSERT_EQUAL_UINT32(0, queued(3));
+    TEST_ASSERT_EQUAL_UINT32(0, queued(66));
+    TEST_ASSERT_EQUAL_UINT64(1, sw->floods);
+    TEST_ASSERT_EQUAL_UINT64(2, sw->clones);
+
+    // One data block for the three copies
+    TEST_ASSERT_EQUAL_UINT32(TEST_BLKS - 1, pool->nfree_blks);
+    p1 = pkt_queue_pop(&sw->ports[1].txq);
+    p2 = pkt_queue_pop(&sw->ports[2].txq);
+    p65 = pkt_queue_pop(&sw->ports[65].txq);
+    TEST_ASSERT_EQUAL_PTR(p1->data, p2->data);
+    TEST_ASSERT_EQUAL_PTR(p1->data, p65->data);
+    TEST_ASSERT_TRUE(pkt_buf_is_shared(p65));
+    TEST_ASSERT_EQUAL_UINT32(65, p65->tx_ifindex);
+    TEST_ASSERT_EQUAL_UINT32(0, p65->rx_ifindex);
+    TEST_ASSERT_EQUAL_UINT16(10, p65->vlan);
+    pkt_buf_free(p1);
+    pkt_buf_free(p2);
+    pkt_buf_free(p65);
+}
+
+void test_learnt_unicast(void)
+{
+    // Unknown: flooded, and mac_a is learnt on port 0
+    input(0, mac_b, mac_a);
+    TEST_ASSERT_EQUAL_UINT32(1, queued(2));
+
+    // The reply goes to port 0 only, and mac_b is learnt on port 2
+    input(2, mac_a, mac_b);
+    TEST_ASSERT_EQUAL_UINT32(1, queued(0));
+    TEST_ASSERT_EQUAL_UINT32(1, queued(1));
+    TEST_ASSERT_EQUAL_UINT64(1, sw->unicasts);
+
+    input(0, mac_b, mac_a);
+    TEST_ASSERT_EQUAL_UINT32(2, queued(2));
+    TEST_ASSERT_EQUAL_UINT32(1, queued(1));
+
+    // Both behind port 0: nothing to send
+    input(0, mac_a, mac_b);
+    TEST_ASSERT_EQUAL_UINT64(1, sw->filtered);
+    TEST_ASSERT_EQUAL_UINT32(1, queued(0));
+}
+
+void test_membership_changes_flood_map(void)
+{
+    const uint64_t *map = l2_switch_flood_map(sw, 10);
+
+    TEST_ASSERT_EQUAL_HEX64(0x7, map[0]);
+    TEST_ASSERT_EQUAL_HEX64(0x2, map[1]);
+
+    TEST_ASSERT_EQUAL_INT(0, l2_switch_port_set(sw, 1, 0, 10));
+    TEST_ASSERT_EQUAL_INT(0, l2_switch_vlan_del(sw, 10, 65));
+    TEST_ASSERT_EQUAL_HEX64(0x5, map[0]);
+    TEST_ASSERT_EQUAL_HEX64(0x0, map[1]);
+    TEST_ASSERT_TRUE(l2_switch_is_member(sw, 10, 1));
+
+    input(0, bcast, mac_a);
+    TEST_ASSERT_EQUAL_UINT32(0, queued(1));
+    TEST_ASSERT_EQUAL_UINT32(1, queued(2));
+    TEST_ASSERT_EQUAL_UINT64(0, sw->clones);
+
+    // Learnt behind port 2, which then goes down
+    input(2, mac_a, mac_b);
+    TEST_ASSERT_EQUAL_INT(0, l2_switch_port_set(sw, 2, 0, 10));
+    input(0, mac_b, mac_a);
+    TEST_ASSERT_EQUAL_UINT64(1, sw->drops);
+
+    TEST_ASSERT_EQUAL_INT(0, l2_switch_port_set(sw, 1, 1, 10));
+    TEST_ASSERT_EQUAL_HEX64(0x3, map[0]);
+}
+
+void test_ingress_checks(void)
+{
+    pkt_buf_t *pkt;
+
+    // Port 3 classifies untagged frames into VLAN 20: port 66 only
+    input(3, bcast, mac_a);
+    TEST_ASSERT_EQUAL_UINT32(1, queued(66));
+    TEST_ASSERT_EQUAL_UINT32(0, queued(1));
+    TEST_ASSERT_EQUAL_UINT32(MAC_TABLE_MISS,
+                             mac_table_lookup(sw->macs, 10, mac_a));
+    TEST_ASSERT_EQUAL_UINT32(3, mac_table_lookup(sw->macs, 20, mac_a));
+
+    // Port 4 is up but in no VLAN, port 5 is down
+    input(4, bcast, mac_a);
+    TEST_ASSERT_EQUAL_INT(0, l2_switch_port_set(sw, 5, 0, 10));
+    input(5, bcast, mac_a);
+    TEST_ASSERT_EQUAL_UINT64(2, sw->drops);
+
+    // Too short for a header
+    pkt = pkt_buf_alloc(pool);
+    TEST_ASSERT_NOT_NULL(pkt_buf_put(pkt, 10));
+    l2_switch_input(sw, 0, &pkt, 1);
+    TEST_ASSERT_EQUAL_UINT64(3, sw->drops);
+}
+
+void test_trunk_tagging(void)
+{
+    // Port 4 trunks VLANs 10 and 20 tagged, port 5 trunks them with 20
+    // native
+    TEST_ASSERT_EQUAL_INT(0, l2_switch_port_mode(sw, 4, L2_PORT_TRUNK));
+    TEST_ASSERT_EQUAL_INT(0, l2_switch_port_set(sw, 4, 1, 0));
+    TEST_ASSERT_EQUAL_INT(0, l2_switch_port_mode(sw, 5, L2_PORT_TRUNK));
+    TEST_ASSERT_EQUAL_INT(0, l2_switch_port_set(sw, 5, 1, 20));
+    TEST_ASSERT_EQUAL_INT(0, l2_switch_vlan_add(sw, 10, 4));
+    TEST_ASSERT_EQUAL_INT(0, l2_switch_vlan_add(sw, 20, 4));
+    TEST_ASSERT_EQUAL_INT(0, l2_switch_vlan_add(sw, 10, 5));
+    TEST_ASSERT_EQUAL_INT(0, l2_switch_vlan_add(sw, 20, 5));
+    TEST_ASSERT_EQUAL_HEX64(0x30, l2_switch_tagged_map(sw, 10)[0]);
+    TEST_ASSERT_EQUAL_HEX64(0x10, l2_switch_tagged_map(sw, 20)[0]);
+
+    // From an access port: one copy tagged for both trunks, clones of the
+    // frame for the access ports
+    input(0, bcast, mac_a);
+    TEST_ASSERT_EQUAL_UINT64(1, sw->pushes);
+    TEST_ASSERT_EQUAL_UINT64(3, sw->clones);
+    TEST_ASSERT_EQUAL_UINT32(TEST_BLKS - 2, pool->nfree_blks);
+    expect_frame(1, -1);
+    expect_frame(2, -1);
+    expect_frame(65, -1);
+    expect_frame(4, 10);
+    expect_frame(5, 10);
+
+    // From a trunk: the tag comes off in place for the only other kind
+    input_tagged(4, bcast, mac_b, 20);
+    TEST_ASSERT_EQUAL_UINT64(1, sw->pops);
+    expect_frame(3, -1);
+    expect_frame(66, -1);
+    expect_frame(5, -1);
+
+    // Known unicast, popped and pushed on the way
+    input_tagged(4, mac_a, mac_b, 10);
+    expect_frame(0, -1);
+    input(0, mac_b, mac_a);
+    expect_frame(4, 10);
+    TEST_ASSERT_EQUAL_UINT64(2, sw->pops);
+    TEST_ASSERT_EQUAL_UINT64(2, sw->pushes);
+    TEST_ASSERT_EQUAL_UINT64(2, sw->unicasts);
+
+    // Untagged on a trunk is its native VLAN
+    input(5, mac_b, mac_a);
+    TEST_ASSERT_EQUAL_UINT32(5, mac_table_lookup(sw->macs, 20, mac_a));
+    expect_frame(4, 20);
+}
+
+void test_access_ingress(void)
+{
+    // Tagged frames are not taken by access ports
+    input_tagged(0, bcast, mac_a, 10);
+    TEST_ASSERT_EQUAL_UINT64(1, sw->drops);
+    TEST_ASSERT_EQUAL_UINT32(0, queued(1));
+
+    // A priority tag is stripped and the frame goes into the pvid
+    input_tagged(0, bcast, mac_a, 0);
+    TEST_ASSERT_EQUAL_UINT64(1, sw->pops);
+    expect_frame(1, -1);
+    expect_frame(2, -1);
+    expect_frame(65, -1);
+}
+
+void test_bad_arguments(void)
+{
+    TEST_ASSERT_NULL(l2_switch_create(0, 16, 0));
+    TEST_ASSERT_EQUAL_INT(EINVAL, errno);
+    TEST_ASSERT_NULL(l2_switch_create(L2_SWITCH_MAX_PORTS + 1, 16, 0));
+    TEST_ASSERT_EQUAL_INT(-1, l2_switch_vlan_add(sw, 0, 1));
+    TEST_ASSERT_EQUAL_INT(-1, l2_switch_vlan_add(sw, L2_SWITCH_VLANS, 1));
+    TEST_ASSERT_EQUAL_INT(-1, l2_switch_vlan_add(sw, 10, TEST_PORTS));
+    TEST_ASSERT_EQUAL_INT(-1, l2_switch_port_set(sw, TEST_PORTS, 1, 10));
+    TEST_ASSERT_EQUAL_INT(-1, l2_switch_port_mode(sw, 0, 2));
+    TEST_ASSERT_EQUAL_INT(EINVAL, errno);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_flood_to_vlan_members);
+    RUN_TEST(test_learnt_unicast);
+    RUN_TEST(test_membership_changes_flood_map);
+    RUN_TEST(test_ingress_checks);
+    RUN_TEST(test_trunk_tagging);
+    RUN_TEST(test_access_ingress);
+    RUN_TEST(test_bad_arguments);
+    return UNITY_END();
+}
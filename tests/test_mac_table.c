@@ -0,0 +1,140 @@
+#include <errno.h>
+#include <string.h>
+#include "unity.h"
+#include "../src/l2/mac_table.h"
+
+#define TEST_ENTRIES    4096
+#define TEST_AGE        10
+
+static mac_table_t *tbl;
+
+void setUp(void)
+{
+    tbl = mac_table_create(TEST_ENTRIES, TEST_AGE);
+    TEST_ASSERT_NOT_NULL(tbl);
+}
+
+void tearDown(void)
+{
+    mac_table_destroy(tbl);
+}
+
+// Address number i, all of one vendor prefix
+static const uint8_t *mac_of(uint32_t i)
+{
+    static uint8_t mac[6];
+
+    mac[0] = 0x00;
+    mac[1] = 0x1b;
+    mac[2] = 0x21;
+    mac[3] = (uint8_t)(i >> 16);
+    mac[4] = (uint8_t)(i >> 8);
+    mac[5] = (uint8_t)i;
+    return mac;
+}
+
+void test_learn_and_lookup(void)
+{
+    TEST_ASSERT_EQUAL_UINT32(MAC_TABLE_MISS,
+                             mac_table_lookup(tbl, 1, mac_of(1)));
+    TEST_ASSERT_EQUAL_INT(0, mac_table_learn(tbl, 1, mac_of(1), 3));
+    TEST_ASSERT_EQUAL_INT(0, mac_table_learn(tbl, 2, mac_of(1), 4));
+    TEST_ASSERT_EQUAL_UINT32(3, mac_table_lookup(tbl, 1, mac_of(1)));
+    TEST_ASSERT_EQUAL_UINT32(4, mac_table_lookup(tbl, 2, mac_of(1)));
+    TEST_ASSERT_EQUAL_UINT32(MAC_TABLE_MISS,
+                             mac_table_lookup(tbl, 3, mac_of(1)));
+
+    // Seen again on another port: the address moved
+    TEST_ASSERT_EQUAL_INT(0, mac_table_learn(tbl, 1, mac_of(1), 5));
+    TEST_ASSERT_EQUAL_UINT32(5, mac_table_lookup(tbl, 1, mac_of(1)));
+    TEST_ASSERT_EQUAL_UINT32(2, tbl->count);
+    TEST_ASSERT_EQUAL_UINT64(2, tbl->learns);
+    TEST_ASSERT_EQUAL_UINT64(1, tbl->moves);
+}
+
+void test_full_table(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < TEST_ENTRIES; i++)
+        TEST_ASSERT_EQUAL_INT(0, mac_table_learn(tbl, 0, mac_of(i), i));
+    TEST_ASSERT_EQUAL_INT(-1, mac_table_learn(tbl, 0, mac_of(i), i));
+    TEST_ASSERT_EQUAL_INT(ENOSPC, errno);
+
+    // Known addresses can still be refreshed
+    TEST_ASSERT_EQUAL_INT(0, mac_table_learn(tbl, 0, mac_of(7), 1));
+    TEST_ASSERT_EQUAL_INT(0, mac_table_delete(tbl, 0, mac_of(7)));
+    TEST_ASSERT_EQUAL_INT(-1, mac_table_delete(tbl, 0, mac_of(7)));
+    TEST_ASSERT_EQUAL_INT(0, mac_table_learn(tbl, 0, mac_of(i), i));
+}
+
+void test_delete_keeps_probe_runs(void)
+{
+    uint32_t i, j;
+
+    for (i = 0; i < TEST_ENTRIES; i++)
+        TEST_ASSERT_EQUAL_INT(0, mac_table_learn(tbl, 0, mac_of(i), i));
+
+    // Every other address goes, the rest must still be found
+    for (i = 0; i < TEST_ENTRIES; i += 2)
+        TEST_ASSERT_EQUAL_INT(0, mac_table_delete(tbl, 0, mac_of(i)));
+    for (i = 0; i < TEST_ENTRIES; i++) {
+        j = mac_table_lookup(tbl, 0, mac_of(i));
+        TEST_ASSERT_EQUAL_UINT32(i & 1 ? i : MAC_TABLE_MISS, j);
+    }
+    TEST_ASSERT_EQUAL_UINT32(TEST_ENTRIES / 2, tbl->count);
+}
+
+void test_aging(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < 100; i++)
+        TEST_ASSERT_EQUAL_INT(0, mac_table_learn(tbl, 0, mac_of(i), 1));
+    TEST_ASSERT_EQUAL_UINT32(0, mac_table_advance(tbl, 4));
+    for (i = 0; i < 100; i++)
+        TEST_ASSERT_EQUAL_INT(0, mac_table_learn(tbl, 1, mac_of(i), 1));
+
+    // Half the tick-0 addresses are seen again at tick 5
+    TEST_ASSERT_EQUAL_UINT32(0, mac_table_advance(tbl, 5));
+    for (i = 0; i < 100; i += 2)
+        TEST_ASSERT_EQUAL_INT(0, mac_table_learn(tbl, 0, mac_of(i), 1));
+
+    TEST_ASSERT_EQUAL_UINT32(0, mac_table_advance(tbl, TEST_AGE - 1));
+    TEST_ASSERT_EQUAL_UINT32(50, mac_table_advance(tbl, TEST_AGE));
+    TEST_ASSERT_EQUAL_UINT32(MAC_TABLE_MISS,
+                             mac_table_lookup(tbl, 0, mac_of(1)));
+    TEST_ASSERT_EQUAL_UINT32(1, mac_table_lookup(tbl, 0, mac_of(0)));
+
+    TEST_ASSERT_EQUAL_UINT32(100, mac_table_advance(tbl, 4 + TEST_AGE));
+    TEST_ASSERT_EQUAL_UINT32(50, mac_table_advance(tbl, 1000));
+    TEST_ASSERT_EQUAL_UINT32(0, tbl->count);
+    TEST_ASSERT_EQUAL_UINT64(200, tbl->aged);
+}
+
+void test_entries_are_reused(void)
+{
+    uint32_t round, i;
+
+    // Far more addresses than entries pass through the table
+    for (round = 0; round < 8; round++) {
+        for (i = 0; i < TEST_ENTRIES; i++)
+            TEST_ASSERT_EQUAL_INT(0, mac_table_learn(tbl, (uint16_t)round,
+                                                     mac_of(i), i));
+        TEST_ASSERT_EQUAL_UINT32(TEST_ENTRIES,
+                                 mac_table_advance(tbl,
+                                                   (round + 1) * TEST_AGE));
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, tbl->count);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_learn_and_lookup);
+    RUN_TEST(test_full_table);
+    RUN_TEST(test_delete_keeps_probe_runs);
+    RUN_TEST(test_aging);
+    RUN_TEST(test_entries_are_reused);
+    return UNITY_END();
+}
@@ -0,0 +1,153 @@
+#include <stdlib.h>
+#include "unity.h"
+#include "../src/pheap/pheap.h"
+
+// Define a structure for testing purposes
+typedef struct {
+    int key;
+    pheap_node_t hnode;
+} TestData;
+
+#define NODES 1000
+
+static pheap_t heap;
+static TestData nodes[NODES];
+
+static int cmp_key(const void *a, const void *b)
+{
+    const TestData *x = a, *y = b;
+
+    return (x->key > y->key) - (x->key < y->key);
+}
+
+static TestData *pop(pheap_t *h)
+{
+    pheap_node_t *n = pheap_delete_min(h);
+
+    return n ? (TestData *)PHEAP_GET_USER_DATA_FROM_OFFSET(
+                   n, offsetof(TestData, hnode))
+             : NULL;
+}
+
+void setUp(void)
+{
+    init_pheap(&heap, offsetof(TestData, hnode), cmp_key);
+}
+
+void tearDown(void)
+{
+    // Clean up after each test
+}
+
+void test_empty_heap(void)
+{
+    TEST_ASSERT_TRUE(pheap_is_empty(&heap));
+    TEST_ASSERT_NULL(pheap_min(&heap));
+    TEST_ASSERT_NULL(pheap_delete_min(&heap));
+}
+
+void test_delete_min_returns_sorted_order(void)
+{
+    int i, prev = -1;
+    TestData *d;
+
+    srand(1);
+    for (i = 0; i < NODES; i++) {
+        nodes[i].key = rand() % 500;
+        pheap_insert(&heap, &nodes[i].hnode);
+    }
+    TEST_ASSERT_EQUAL_size_t(NODES, heap.count);
+
+    for (i = 0; i < NODES; i++) {
+        d = pop(&heap);
+        TEST_ASSERT_NOT_NULL(d);
+        TEST_ASSERT_TRUE(d->key >= prev);
+        prev = d->key;
+    }
+
+    TEST_ASSERT_TRUE(pheap_is_empty(&heap));
+    TEST_ASSERT_EQUAL_size_t(0, heap.count);
+}
+
+void test_decrease_key_moves_node_to_front(void)
+{
+    int i;
+
+    for (i = 0; i < 100; i++) {
+        nodes[i].key = 1000 + i;
+        pheap_insert(&heap, &nodes[i].hnode);
+    }
+
+    // Pop a few to build a real tree, then lower a deep node's key
+    TEST_ASSERT_EQUAL_INT(1000, pop(&heap)->key);
+    TEST_ASSERT_EQUAL_INT(1001, pop(&heap)->key);
+
+    nodes[77].key = 5;
+    pheap_decrease_key(&heap, &nodes[77].hnode);
+    nodes[50].key = 7;
+    pheap_decrease_key(&heap, &nodes[50].hnode);
+
+    TEST_ASSERT_EQUAL_PTR(&nodes[77], pop(&heap));
+    TEST_ASSERT_EQUAL_PTR(&nodes[50], pop(&heap));
+    TEST_ASSERT_EQUAL_INT(1002, pop(&heap)->key);
+}
+
+void test_remove_arbitrary_nodes(void)
+{
+    int i, prev = -1, popped = 0;
+    TestData *d;
+
+    for (i = 0; i < 200; i++) {
+        nodes[i].key = (i * 37) % 200;
+        pheap_insert(&heap, &nodes[i].hnode);
+    }
+    pop(&heap);    // force pairing so removed nodes have children
+
+    // Remove every node with an odd key
+    for (i = 0; i < 200; i++)
+        if (nodes[i].key & 1)
+            pheap_remove(&heap, &nodes[i].hnode);
+
+    TEST_ASSERT_EQUAL_size_t(99, heap.count);
+    while ((d = pop(&heap))) {
+        TEST_ASSERT_EQUAL_INT(0, d->key & 1);
+        TEST_ASSERT_TRUE(d->key > prev);
+        prev = d->key;
+        popped++;
+    }
+    TEST_ASSERT_EQUAL_INT(99, popped);
+}
+
+void test_meld(void)
+{
+    pheap_t other;
+    int i;
+
+    init_pheap(&other, offsetof(TestData, hnode), cmp_key);
+    for (i = 0; i < 10; i++) {
+        nodes[i].key = 2 * i;
+        pheap_insert(&heap, &nodes[i].hnode);
+        nodes[10 + i].key = 2 * i + 1;
+        pheap_insert(&other, &nodes[10 + i].hnode);
+    }
+
+    pheap_meld(&heap, &other);
+    TEST_ASSERT_TRUE(pheap_is_empty(&other));
+    TEST_ASSERT_EQUAL_size_t(20, heap.count);
+
+    for (i = 0; i < 20; i++)
+        TEST_ASSERT_EQUAL_INT(i, pop(&heap)->key);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_empty_heap);
+    RUN_TEST(test_delete_min_returns_sorted_order);
+    RUN_TEST(test_decrease_key_moves_node_to_front);
+    RUN_TEST(test_remove_arbitrary_nodes);
+    RUN_TEST(test_meld);
+
+    return UNITY_END();
+}
@@ -0,0 +1,340 @@
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "unity.h"
+#include "../src/pkt/pkt_buf.h"
+
+#define TEST_BLKS       8
+#define TEST_BLK_SIZE   256
+#define TEST_HEADROOM   64
+
+static pkt_pool_t *pool;
+
+void setUp(void)
+{
+    pool = pkt_pool_create(TEST_BLKS, TEST_BLK_SIZE, TEST_HEADROOM, 0);
+    TEST_ASSERT_NOT_NULL(pool);
+}
+
+void tearDown(void)
+{
+    TEST_ASSERT_EQUAL_UINT32(TEST_BLKS, pool->nfree_blks);
+    TEST_ASSERT_EQUAL_UINT32(TEST_BLKS * PKT_POOL_DESCS_PER_BLK,
+                             pool->nfree_bufs);
+    pkt_pool_destroy(pool);
+}
+
+void test_push_pull_in_place(void)
+{
+    pkt_buf_t *pkt = pkt_buf_alloc(pool);
+    unsigned char *payload, *hdr;
+
+    TEST_ASSERT_NOT_NULL(pkt);
+    TEST_ASSERT_EQUAL_UINT32(0, pkt->len);
+    TEST_ASSERT_EQUAL_UINT32(TEST_HEADROOM, pkt_buf_headroom(pkt));
+    TEST_ASSERT_EQUAL_UINT32(TEST_BLK_SIZE - TEST_HEADROOM,
+                             pkt_buf_tailroom(pkt));
+    TEST_ASSERT_EQUAL_UINT32(0, (uintptr_t)pkt->blk->data % 64);
+
+    payload = pkt_buf_put(pkt, 100);
+    memset(payload, 0xab, 100);
+
+    // Headers go in front of the payload, which never moves
+    hdr = pkt_buf_push(pkt, 20);
+    TEST_ASSERT_EQUAL_PTR(payload - 20, hdr);
+    memset(hdr, 0x45, 20);
+    hdr = pkt_buf_push(pkt, 14);
+    TEST_ASSERT_EQUAL_PTR(payload - 34, hdr);
+    TEST_ASSERT_EQUAL_UINT32(134, pkt->len);
+    TEST_ASSERT_EQUAL_UINT32(TEST_HEADROOM - 34, pkt_buf_headroom(pkt));
+
+    TEST_ASSERT_EQUAL_PTR(payload - 20, pkt_buf_pull(pkt, 14));
+    TEST_ASSERT_EQUAL_HEX8(0x45, pkt->data[0]);
+    TEST_ASSERT_EQUAL_PTR(payload, pkt_buf_pull(pkt, 20));
+    TEST_ASSERT_EQUAL_HEX8(0xab, pkt->data[99]);
+
+    pkt_buf_trim(pkt, 60);
+    TEST_ASSERT_EQUAL_UINT32(60, pkt->len);
+    pkt_buf_trim(pkt, 80);
+    TEST_ASSERT_EQUAL_UINT32(60, pkt->len);
+
+    pkt_buf_free(pkt);
+}
+
+void test_limits(void)
+{
+    pkt_buf_t *pkt = pkt_buf_alloc(pool);
+
+    TEST_ASSERT_NULL(pkt_buf_push(pkt, TEST_HEADROOM + 1));
+    TEST_ASSERT_NOT_NULL(pkt_buf_push(pkt, TEST_HEADROOM));
+    TEST_ASSERT_NULL(pkt_buf_push(pkt, 1));
+
+    TEST_ASSERT_NULL(pkt_buf_put(pkt, TEST_BLK_SIZE - TEST_HEADROOM + 1));
+    TEST_ASSERT_NOT_NULL(pkt_buf_put(pkt, TEST_BLK_SIZE - TEST_HEADROOM));
+    TEST_ASSERT_EQUAL_UINT32(TEST_BLK_SIZE, pkt->len);
+    TEST_ASSERT_NULL(pkt_buf_put(pkt, 1));
+
+    TEST_ASSERT_NULL(pkt_buf_pull(pkt, TEST_BLK_SIZE + 1));
+    TEST_ASSERT_NOT_NULL(pkt_buf_pull(pkt, TEST_BLK_SIZE));
+    TEST_ASSERT_EQUAL_UINT32(0, pkt->len);
+
+    pkt_buf_free(pkt);
+
+    TEST_ASSERT_NULL(pkt_pool_create(4, 64, 65, 0));
+}
+
+void test_clone_shares_and_make_writable_splits(void)
+{
+    pkt_buf_t *pkt = pkt_buf_alloc(pool), *clone, *copy;
+
+    memcpy(pkt_buf_put(pkt, 5), "hello", 5);
+
+    clone = pkt_buf_clone(pkt);
+    TEST_ASSERT_NOT_NULL(clone);
+    TEST_ASSERT_EQUAL_PTR(pkt->blk, clone->blk);
+    TEST_ASSERT_EQUAL_PTR(pkt->data, clone->data);
+    TEST_ASSERT_TRUE(pkt_buf_is_shared(pkt));
+    TEST_ASSERT_EQUAL_UINT32(TEST_BLKS - 1, pool->nfree_blks);
+
+    // Pulling a clone moves only its own view
+    pkt_buf_pull(clone, 1);
+    TEST_ASSERT_EQUAL_UINT32(5, pkt->len);
+
+    TEST_ASSERT_EQUAL_INT(0, pkt_buf_make_writable(clone));
+    TEST_ASSERT_FALSE(pkt_buf_is_shared(pkt));
+    TEST_ASSERT_FALSE(pkt_buf_is_shared(clone));
+    TEST_ASSERT_TRUE(pkt->blk != clone->blk);
+    TEST_ASSERT_EQUAL_UINT32(TEST_HEADROOM + 1, pkt_buf_headroom(clone));
+    clone->data[0] = 'E';
+    TEST_ASSERT_EQUAL_MEMORY("hello", pkt->data, 5);
+    TEST_ASSERT_EQUAL_MEMORY("Ello", clone->data, 4);
+
+    copy = pkt_buf_copy(pkt);
+    TEST_ASSERT_NOT_NULL(copy);
+    TEST_ASSERT_TRUE(copy->blk != pkt->blk);
+    TEST_ASSERT_EQUAL_UINT32(pkt_buf_headroom(pkt), pkt_buf_headroom(copy));
+    TEST_ASSERT_EQUAL_MEMORY("hello", copy->data, 5);
+
+    // The block outlives the packet it was allocated for
+    pkt_buf_free(clone);
+    clone = pkt_buf_clone(copy);
+    pkt_buf_free(copy);
+    TEST_ASSERT_EQUAL_MEMORY("hello", clone->data, 5);
+    TEST_ASSERT_EQUAL_INT(0, pkt_buf_make_writable(clone));
+
+    pkt_buf_free(clone);
+    pkt_buf_free(pkt);
+}
+
+void test_exhaustion_and_queueing(void)
+{
+    pkt_buf_t *pkts[TEST_BLKS], *pkt;
+    glthread_t queue, *lst = &queue;
+    uint32_t i, n = 0;
+
+    init_glthread(&queue, offset(pkt_buf_t, glue));
+    for (i = 0; i < TEST_BLKS; i++) {
+        pkts[i] = pkt_buf_alloc(pool);
+        TEST_ASSERT_NOT_NULL(pkts[i]);
+        glthread_add(&queue, &pkts[i]->glue);
+    }
+    TEST_ASSERT_NULL(pkt_buf_alloc(pool));
+
+    // Out of blocks, clones still have descriptors but copies fail
+    pkt = pkt_buf_clone(pkts[0]);
+    TEST_ASSERT_NOT_NULL(pkt);
+    TEST_ASSERT_NULL(pkt_buf_copy(pkts[0]));
+    TEST_ASSERT_EQUAL_INT(-1, pkt_buf_make_writable(pkt));
+    pkt_buf_free(pkt);
+
+    ITERATE_GL_THREADS_BEGIN(lst, pkt_buf_t, pkt) {
+        glthread_remove(&queue, &pkt->glue);
+        pkt_buf_free(pkt);
+        n++;
+    } ITERATE_GL_THREADS_ENDS;
+    TEST_ASSERT_EQUAL_UINT32(TEST_BLKS, n);
+    TEST_ASSERT_NULL(queue.head);
+}
+
+// Fills the packet with its byte offsets, across segments
+static void fill_pattern(pkt_buf_t *pkt)
+{
+    pkt_buf_t *seg;
+    uint32_t off = 0, i;
+
+    ITERATE_PKT_SEGS_BEGIN(pkt, seg) {
+        for (i = 0; i < seg->len; i++)
+            seg->data[i] = (unsigned char)(off++ % 251);
+    } ITERATE_PKT_SEGS_ENDS;
+}
+
+// Checks the packet holds its byte offsets, through its iovec
+static void check_pattern(pkt_buf_t *pkt)
+{
+    struct iovec iov[TEST_BLKS];
+    uint32_t off = 0, total = 0;
+    int n, i;
+    size_t j;
+
+    n = pkt_buf_to_iovec(pkt, iov, TEST_BLKS);
+    TEST_ASSERT_EQUAL_INT((int)pkt->nsegs, n);
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < iov[i].iov_len; j++)
+            TEST_ASSERT_EQUAL_UINT8(off++ % 251,
+                                    ((unsigned char *)iov[i].iov_base)[j]);
+        total += (uint32_t)iov[i].iov_len;
+    }
+    TEST_ASSERT_EQUAL_UINT32(pkt->pkt_len, total);
+}
+
+void test_chain_alloc_iovec_and_clone(void)
+{
+    uint32_t len = 600, first = TEST_BLK_SIZE - TEST_HEADROOM;
+    pkt_buf_t *pkt = pkt_buf_alloc_len(pool, len), *clone, *copy;
+    struct iovec iov[2];
+
+    TEST_ASSERT_NOT_NULL(pkt);
+    TEST_ASSERT_EQUAL_UINT32(len, pkt->pkt_len);
+    TEST_ASSERT_EQUAL_UINT32(first, pkt->len);
+    TEST_ASSERT_EQUAL_UINT32(1 + (len - first + TEST_BLK_SIZE - 1) /
+                                 TEST_BLK_SIZE, pkt->nsegs);
+    TEST_ASSERT_EQUAL_UINT32((len - first) % TEST_BLK_SIZE, pkt->last->len);
+    fill_pattern(pkt);
+    check_pattern(pkt);
+    TEST_ASSERT_EQUAL_INT(-1, pkt_buf_to_iovec(pkt, iov, 2));
+
+    // Headers still go in front of the first segment
+    TEST_ASSERT_NOT_NULL(pkt_buf_push(pkt, 14));
+    TEST_ASSERT_EQUAL_UINT32(len + 14, pkt->pkt_len);
+    pkt_buf_pull(pkt, 14);
+
+    clone = pkt_buf_clone(pkt);
+    TEST_ASSERT_NOT_NULL(clone);
+    TEST_ASSERT_EQUAL_UINT32(pkt->nsegs, clone->nsegs);
+    TEST_ASSERT_EQUAL_PTR(pkt->last->blk, clone->last->blk);
+    check_pattern(clone);
+
+    copy = pkt_buf_copy(clone);
+    TEST_ASSERT_NOT_NULL(copy);
+    TEST_ASSERT_TRUE(copy->last->blk != pkt->last->blk);
+    check_pattern(copy);
+
+    // Too few blocks left for a private copy of every segment
+    TEST_ASSERT_EQUAL_INT(-1, pkt_buf_make_writable(clone));
+    check_pattern(clone);
+    TEST_ASSERT_NULL(pkt_buf_alloc_len(pool, len));
+
+    pkt_buf_free(copy);
+    pkt_buf_free(clone);
+    pkt_buf_free(pkt);
+}
+
+void test_append_trim_and_may_pull(void)
+{
+    pkt_buf_t *pkt = pkt_buf_alloc(pool), *seg;
+    uint32_t i;
+
+    // Reassemble a datagram from small fragments without copying
+    memcpy(pkt_buf_put(pkt, 10), "0123456789", 10);
+    for (i = 0; i < 3; i++) {
+        seg = pkt_buf_alloc(pool);
+        memcpy(pkt_buf_put(seg, 10), "abcdefghij", 10);
+        pkt_buf_append(pkt, seg);
+        TEST_ASSERT_EQUAL_PTR(seg, pkt->last);
+    }
+    TEST_ASSERT_EQUAL_UINT32(4, pkt->nsegs);
+    TEST_ASSERT_EQUAL_UINT32(40, pkt->pkt_len);
+
+    // A header split across the first three segments is gathered into
+    // the first, emptied segments are released
+    TEST_ASSERT_NULL(pkt_buf_may_pull(pkt, 41));
+    TEST_ASSERT_NOT_NULL(pkt_buf_may_pull(pkt, 25));
+    TEST_ASSERT_EQUAL_UINT32(25, pkt->len);
+    TEST_ASSERT_EQUAL_UINT32(40, pkt->pkt_len);
+    TEST_ASSERT_EQUAL_UINT32(3, pkt->nsegs);
+    TEST_ASSERT_EQUAL_MEMORY("0123456789abcdefghijabcde", pkt->data, 25);
+    TEST_ASSERT_EQUAL_UINT32(TEST_BLKS - 3, pool->nfree_blks);
+    TEST_ASSERT_NOT_NULL(pkt_buf_pull(pkt, 25));
+    TEST_ASSERT_EQUAL_UINT32(15, pkt->pkt_len);
+
+    // Trimming into the second segment frees the third
+    pkt_buf_trim(pkt, 3);
+    TEST_ASSERT_EQUAL_UINT32(3, pkt->pkt_len);
+    TEST_ASSERT_EQUAL_UINT32(2, pkt->nsegs);
+    TEST_ASSERT_EQUAL_UINT32(3, pkt->last->len);
+    TEST_ASSERT_EQUAL_MEMORY("fgh", pkt->last->data, 3);
+    TEST_ASSERT_EQUAL_UINT32(TEST_BLKS - 2, pool->nfree_blks);
+
+    // Appending now goes to the new last segment
+    memcpy(pkt_buf_put(pkt, 2), "XY", 2);
+    TEST_ASSERT_EQUAL_MEMORY("fghXY", pkt->last->data, 5);
+    TEST_ASSERT_EQUAL_UINT32(5, pkt->pkt_len);
+
+    pkt_buf_trim(pkt, 0);
+    TEST_ASSERT_EQUAL_UINT32(1, pkt->nsegs);
+    TEST_ASSERT_EQUAL_PTR(pkt, pkt->last);
+
+    pkt_buf_free(pkt);
+}
+
+void test_alloc_bulk_stops_at_exhaustion(void)
+{
+    pkt_buf_t *pkts[TEST_BLKS + 2];
+    uint32_t n, i;
+
+    n = pkt_buf_alloc_bulk(pool, pkts, TEST_BLKS + 2);
+    TEST_ASSERT_EQUAL_UINT32(TEST_BLKS, n);
+    TEST_ASSERT_EQUAL_UINT32(0, pkt_buf_alloc_bulk(pool, &pkts[n], 1));
+    for (i = 0; i < n; i++) {
+        TEST_ASSERT_EQUAL_UINT32(0, pkts[i]->len);
+        TEST_ASSERT_EQUAL_UINT32(1, pkts[i]->nsegs);
+        TEST_ASSERT_EQUAL_UINT32(TEST_HEADROOM, pkt_buf_headroom(pkts[i]));
+        TEST_ASSERT_FALSE(pkt_buf_is_shared(pkts[i]));
+        pkt_buf_free(pkts[i]);
+    }
+}
+
+void test_shared_pool_crosses_fork(void)
+{
+    pkt_pool_t *shared;
+    pkt_buf_t *pkt;
+    int status;
+    pid_t pid;
+
+    shared = pkt_pool_create(TEST_BLKS, TEST_BLK_SIZE, TEST_HEADROOM,
+                             PKT_POOL_SHARED);
+    TEST_ASSERT_NOT_NULL(shared);
+    TEST_ASSERT_TRUE(shared->flags & PKT_POOL_MT);
+    pkt = pkt_buf_alloc(shared);
+    memset(pkt_buf_put(pkt, 4), 0x11, 4);
+
+    // The child writes into the parent's packet and frees it
+    pid = fork();
+    TEST_ASSERT_TRUE(pid >= 0);
+    if (!pid) {
+        pkt->data[0] = 0x22;
+        pkt_buf_free(pkt);
+        _exit(0);
+    }
+    TEST_ASSERT_EQUAL_INT(pid, waitpid(pid, &status, 0));
+    TEST_ASSERT_EQUAL_HEX8(0x22, pkt->data[0]);
+    TEST_ASSERT_EQUAL_UINT32(TEST_BLKS, shared->nfree_blks);
+
+    pkt_pool_destroy(shared);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_push_pull_in_place);
+    RUN_TEST(test_limits);
+    RUN_TEST(test_clone_shares_and_make_writable_splits);
+    RUN_TEST(test_exhaustion_and_queueing);
+    RUN_TEST(test_chain_alloc_iovec_and_clone);
+    RUN_TEST(test_append_trim_and_may_pull);
+    RUN_TEST(test_alloc_bulk_stops_at_exhaustion);
+    RUN_TEST(test_shared_pool_crosses_fork);
+
+    return UNITY_END();
+}
@@ -0,0 +1,117 @@
+#include "unity.h"
+#include "../src/pkt/pkt_queue.h"
+
+static pkt_pool_t *pool;
+
+void setUp(void)
+{
+    pool = pkt_pool_create(16, 128, 32, 0);
+    TEST_ASSERT_NOT_NULL(pool);
+}
+
+void tearDown(void)
+{
+    TEST_ASSERT_EQUAL_UINT32(16, pool->nfree_blks);
+    pkt_pool_destroy(pool);
+}
+
+// Allocates a packet holding one byte
+static pkt_buf_t *make_pkt(unsigned char val)
+{
+    pkt_buf_t *pkt = pkt_buf_alloc(pool);
+
+    TEST_ASSERT_NOT_NULL(pkt);
+    *pkt_buf_put(pkt, 1) = val;
+    return pkt;
+}
+
+void test_fifo_order(void)
+{
+    pkt_queue_t q;
+    pkt_buf_t *pkt;
+    unsigned char i;
+
+    pkt_queue_init(&q, PKT_QUEUE_UNBOUNDED);
+    TEST_ASSERT_TRUE(pkt_queue_empty(&q));
+    TEST_ASSERT_NULL(pkt_queue_pop(&q));
+
+    for (i = 0; i < 5; i++)
+        TEST_ASSERT_EQUAL_INT(0, pkt_queue_push(&q, make_pkt(i)));
+    TEST_ASSERT_EQUAL_UINT32(5, q.count);
+
+    for (i = 0; i < 3; i++) {
+        pkt = pkt_queue_pop(&q);
+        TEST_ASSERT_EQUAL_UINT8(i, pkt->data[0]);
+        pkt_buf_free(pkt);
+    }
+
+    // Pushing after a partial drain keeps the order
+    pkt_queue_push(&q, make_pkt(5));
+    for (i = 3; i < 6; i++) {
+        pkt = pkt_queue_pop(&q);
+        TEST_ASSERT_EQUAL_UINT8(i, pkt->data[0]);
+        pkt_buf_free(pkt);
+    }
+    TEST_ASSERT_TRUE(pkt_queue_empty(&q));
+    TEST_ASSERT_NULL(q.tail);
+}
+
+void test_limit_counts_drops(void)
+{
+    pkt_queue_t q;
+    pkt_buf_t *pkt;
+
+    pkt_queue_init(&q, 2);
+    TEST_ASSERT_EQUAL_INT(0, pkt_queue_push(&q, make_pkt(0)));
+    TEST_ASSERT_EQUAL_INT(0, pkt_queue_push(&q, make_pkt(1)));
+
+    pkt = make_pkt(2);
+    TEST_ASSERT_EQUAL_INT(-1, pkt_queue_push(&q, pkt));
+    TEST_ASSERT_EQUAL_UINT64(1, q.drops);
+    TEST_ASSERT_EQUAL_UINT32(2, q.count);
+    pkt_buf_free(pkt);
+
+    pkt_queue_flush(&q);
+    TEST_ASSERT_TRUE(pkt_queue_empty(&q));
+}
+
+void test_splice(void)
+{
+    pkt_queue_t a, b;
+    pkt_buf_t *pkt;
+    unsigned char i;
+
+    pkt_queue_init(&a, PKT_QUEUE_UNBOUNDED);
+    pkt_queue_init(&b, PKT_QUEUE_UNBOUNDED);
+
+    // Into an empty queue, then onto a non-empty one
+    pkt_queue_push(&b, make_pkt(0));
+    pkt_queue_push(&b, make_pkt(1));
+    pkt_queue_splice(&a, &b);
+    TEST_ASSERT_TRUE(pkt_queue_empty(&b));
+    pkt_queue_splice(&a, &b);
+
+    pkt_queue_push(&b, make_pkt(2));
+    pkt_queue_push(&b, make_pkt(3));
+    pkt_queue_splice(&a, &b);
+    TEST_ASSERT_EQUAL_UINT32(4, a.count);
+    TEST_ASSERT_NULL(b.lst.head);
+
+    for (i = 0; i < 4; i++) {
+        pkt = pkt_queue_pop(&a);
+        TEST_ASSERT_EQUAL_UINT8(i, pkt->data[0]);
+        pkt_buf_free(pkt);
+    }
+    TEST_ASSERT_TRUE(pkt_queue_empty(&a));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_fifo_order);
+    RUN_TEST(test_limit_counts_drops);
+    RUN_TEST(test_splice);
+
+    return UNITY_END();
+}
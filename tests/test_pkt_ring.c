@@ -0,0 +1,156 @@
+#include <pthread.h>
+#include <sched.h>
+#include "unity.h"
+#include "../src/pkt/pkt_ring.h"
+
+#define STRESS_PKTS     200000
+
+static pkt_pool_t *pool;
+
+void setUp(void)
+{
+    pool = pkt_pool_create(64, 128, 32, PKT_POOL_MT);
+    TEST_ASSERT_NOT_NULL(pool);
+}
+
+void tearDown(void)
+{
+    TEST_ASSERT_EQUAL_UINT32(64, pool->nfree_blks);
+    pkt_pool_destroy(pool);
+}
+
+// Allocates a packet holding one byte
+static pkt_buf_t *make_pkt(unsigned char val)
+{
+    pkt_buf_t *pkt = pkt_buf_alloc(pool);
+
+    TEST_ASSERT_NOT_NULL(pkt);
+    *pkt_buf_put(pkt, 1) = val;
+    return pkt;
+}
+
+void test_size_rounds_up_to_power_of_two(void)
+{
+    pkt_ring_t *ring;
+
+    TEST_ASSERT_NULL(pkt_ring_create(0));
+
+    ring = pkt_ring_create(5);
+    TEST_ASSERT_NOT_NULL(ring);
+    TEST_ASSERT_EQUAL_UINT32(7, ring->mask);
+    TEST_ASSERT_EQUAL_UINT32(8, pkt_ring_room(ring));
+    TEST_ASSERT_EQUAL_UINT32(0, (uintptr_t)ring % PKT_RING_CACHE_LINE);
+    pkt_ring_destroy(ring);
+}
+
+void test_fifo_order_full_and_empty(void)
+{
+    pkt_ring_t *ring = pkt_ring_create(4);
+    pkt_buf_t *pkt;
+    unsigned char i;
+
+    TEST_ASSERT_NULL(pkt_ring_pop(ring));
+    for (i = 0; i < 4; i++)
+        TEST_ASSERT_EQUAL_INT(0, pkt_ring_push(ring, make_pkt(i)));
+    TEST_ASSERT_EQUAL_UINT32(4, pkt_ring_count(ring));
+    TEST_ASSERT_EQUAL_UINT32(0, pkt_ring_room(ring));
+
+    pkt = make_pkt(4);
+    TEST_ASSERT_EQUAL_INT(-1, pkt_ring_push(ring, pkt));
+    pkt_buf_free(pkt);
+
+    for (i = 0; i < 4; i++) {
+        pkt = pkt_ring_pop(ring);
+        TEST_ASSERT_EQUAL_UINT8(i, pkt->data[0]);
+        pkt_buf_free(pkt);
+    }
+    TEST_ASSERT_NULL(pkt_ring_pop(ring));
+    pkt_ring_destroy(ring);
+}
+
+void test_bursts_wrap_around(void)
+{
+    pkt_ring_t *ring = pkt_ring_create(8);
+    pkt_buf_t *in[6], *out[8];
+    unsigned char next = 0, expect = 0;
+    uint32_t round, i, n;
+
+    // Partial bursts move the indexes across the end of the slots many times
+    for (round = 0; round < 20; round++) {
+        for (i = 0; i < 6; i++)
+            in[i] = make_pkt(next++);
+        TEST_ASSERT_EQUAL_UINT32(6, pkt_ring_push_burst(ring, in, 6));
+
+        n = pkt_ring_pop_burst(ring, out, 8);
+        TEST_ASSERT_EQUAL_UINT32(6, n);
+        for (i = 0; i < n; i++) {
+            TEST_ASSERT_EQUAL_UINT8(expect++, out[i]->data[0]);
+            pkt_buf_free(out[i]);
+        }
+    }
+
+    // A burst larger than the room is cut short, the rest stays with us
+    for (i = 0; i < 6; i++)
+        in[i] = make_pkt(i);
+    TEST_ASSERT_EQUAL_UINT32(6, pkt_ring_push_burst(ring, in, 6));
+    for (i = 0; i < 6; i++)
+        in[i] = make_pkt(i);
+    TEST_ASSERT_EQUAL_UINT32(2, pkt_ring_push_burst(ring, in, 6));
+    for (i = 2; i < 6; i++)
+        pkt_buf_free(in[i]);
+
+    // Destroy frees what is left
+    pkt_ring_destroy(ring);
+}
+
+static void *consumer(void *arg)
+{
+    pkt_ring_t *ring = arg;
+    pkt_buf_t *pkts[16];
+    uint32_t got = 0, n, i, bad = 0;
+
+    while (got < STRESS_PKTS) {
+        n = pkt_ring_pop_burst(ring, pkts, 16);
+        for (i = 0; i < n; i++, got++) {
+            if (pkts[i]->data[0] != (unsigned char)got)
+                bad++;
+            pkt_buf_free(pkts[i]);
+        }
+        if (!n)
+            sched_yield();
+    }
+    return (void *)(uintptr_t)bad;
+}
+
+void test_two_threads_keep_order(void)
+{
+    pkt_ring_t *ring = pkt_ring_create(16);
+    pthread_t tid;
+    pkt_buf_t *pkt;
+    void *bad;
+    uint32_t i;
+
+    pthread_create(&tid, NULL, consumer, ring);
+    for (i = 0; i < STRESS_PKTS; i++) {
+        while (!(pkt = pkt_buf_alloc(pool)))
+            sched_yield();
+        *pkt_buf_put(pkt, 1) = (unsigned char)i;
+        while (pkt_ring_push(ring, pkt) < 0)
+            sched_yield();
+    }
+    pthread_join(tid, &bad);
+
+    TEST_ASSERT_EQUAL_UINT32(0, (uintptr_t)bad);
+    TEST_ASSERT_EQUAL_UINT32(0, pkt_ring_count(ring));
+    pkt_ring_destroy(ring);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_size_rounds_up_to_power_of_two);
+    RUN_TEST(test_fifo_order_full_and_empty);
+    RUN_TEST(test_bursts_wrap_around);
+    RUN_TEST(test_two_threads_keep_order);
+    return UNITY_END();
+}
@@ -0,0 +1,148 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+#include "../src/graph/topo_loader.h"
+
+static graph_t *topo;
+static topo_load_err_t err;
+
+static graph_t *load_string(const char *text)
+{
+    FILE *fp = fmemopen((void *)text, strlen(text), "r");
+    graph_t *graph;
+
+    TEST_ASSERT_NOT_NULL(fp);
+    graph = load_topology(fp, &err);
+    fclose(fp);
+    return graph;
+}
+
+void setUp(void)
+{
+    topo = NULL;
+    memset(&err, 0, sizeof(err));
+}
+
+void tearDown(void)
+{
+    destroy_graph(topo);
+}
+
+void test_load_first_topology(void)
+{
+    interface_t *intf;
+
+    topo = load_string("# three routers in a triangle\n"
+                       "topology hello 3 3\n"
+                       "\n"
+                       "node 0 R0_re\n"
+                       "node 1 R1_re\r\n"
+                       "node 2\tR2_re\n"
+                       "link 0 eth0/0 1 eth0/1 1\n"
+                       "link 1 eth0/2 2 eth0/3 1\n"
+                       "  link 0 eth0/4   2 eth0/5 9");    // no final newline
+    TEST_ASSERT_NOT_NULL(topo);
+    TEST_ASSERT_EQUAL_STRING("hello", topo->topology_name);
+    TEST_ASSERT_EQUAL_UINT32(3, topo->node_count);
+    TEST_ASSERT_EQUAL_UINT32(7, topo->ifindex_next);
+
+    intf = get_node_intf_by_name(get_node_by_node_name(topo, "R0_re"),
+                                 "eth0/4");
+    TEST_ASSERT_NOT_NULL(intf);
+    TEST_ASSERT_EQUAL_STRING("R2_re", get_nbr_node(intf)->node_name);
+    TEST_ASSERT_EQUAL_UINT32(9, intf->cost);
+    TEST_ASSERT_EQUAL_STRING("eth0/5", get_intf_name(intf->nbr));
+}
+
+void test_lines_spanning_chunks(void)
+{
+    size_t cap = 4 * TOPO_LOAD_BUF_SIZE, len = 0;
+    char *text = malloc(cap);
+    glthread_t *lst;
+    node_t *node;
+    uint32_t i, n = 0, links = 0;
+
+    TEST_ASSERT_NOT_NULL(text);
+
+    // Odd line lengths so that chunk boundaries fall mid-line
+    len += sprintf(text + len, "topology big 6000\n");
+    for (i = 0; i < 6000 && len < cap - 64; i++)
+        len += sprintf(text + len, "node %u n%u%s\n", i, i,
+                       (i % 3) ? "" : "\t ");
+    n = i;
+    for (i = 0; i + 1 < n && len < cap - 64; i++, links++)
+        len += sprintf(text + len, "link %u a %u b %u\n", i, i + 1, i % 7);
+    TEST_ASSERT_EQUAL_UINT32(6000, n);
+    TEST_ASSERT_EQUAL_UINT32(n - 1, links);
+    TEST_ASSERT_TRUE(len > 2 * TOPO_LOAD_BUF_SIZE);
+
+    topo = load_string(text);
+    free(text);
+    TEST_ASSERT_NOT_NULL(topo);
+    TEST_ASSERT_EQUAL_UINT32(n, topo->node_count);
+    TEST_ASSERT_EQUAL_UINT32(2 * links + 1, topo->ifindex_next);
+
+    i = 0;
+    lst = &topo->node_list;
+    ITERATE_GL_THREADS_BEGIN(lst, node_t, node) {
+        TEST_ASSERT_EQUAL_UINT32(i, node->node_id);
+        i++;
+    } ITERATE_GL_THREADS_ENDS;
+    TEST_ASSERT_EQUAL_UINT32(n, i);
+}
+
+void test_errors_report_the_line(void)
+{
+    TEST_ASSERT_NULL(load_string("node 0 R0\n"));
+    TEST_ASSERT_EQUAL_UINT(1, err.line);
+    TEST_ASSERT_EQUAL_STRING("node before topology line", err.msg);
+
+    TEST_ASSERT_NULL(load_string("topology t 2\nnode 0 a\nnode 2 b\n"));
+    TEST_ASSERT_EQUAL_UINT(3, err.line);
+    TEST_ASSERT_EQUAL_STRING("node id out of range", err.msg);
+
+    TEST_ASSERT_NULL(load_string("topology t 2\nnode 0 a\n\n"
+                                 "link 0 e0 1 e1 1\n"));
+    TEST_ASSERT_EQUAL_UINT(4, err.line);
+    TEST_ASSERT_EQUAL_STRING("link to an undeclared node", err.msg);
+
+    TEST_ASSERT_NULL(load_string("topology t 2\nnode 0 a\nnode 1 b\n"
+                                 "link 0 e0 1 e1 1\nlink 0 e0 1 e2 1\n"));
+    TEST_ASSERT_EQUAL_UINT(5, err.line);
+
+    TEST_ASSERT_NULL(load_string("topology t 1\nrouter 0 a\n"));
+    TEST_ASSERT_EQUAL_UINT(2, err.line);
+    TEST_ASSERT_EQUAL_STRING("unknown keyword", err.msg);
+
+    TEST_ASSERT_NULL(load_string("# empty\n"));
+    TEST_ASSERT_EQUAL_UINT(0, err.line);
+    TEST_ASSERT_EQUAL_STRING("missing topology line", err.msg);
+}
+
+void test_line_too_long(void)
+{
+    char *text = malloc(TOPO_LOAD_BUF_SIZE + 64);
+
+    TEST_ASSERT_NOT_NULL(text);
+    strcpy(text, "topology t 1\n# ");
+    memset(text + 15, 'x', TOPO_LOAD_BUF_SIZE);
+    strcpy(text + 15 + TOPO_LOAD_BUF_SIZE, "\n");
+
+    TEST_ASSERT_NULL(load_string(text));
+    free(text);
+    TEST_ASSERT_EQUAL_UINT(2, err.line);
+    TEST_ASSERT_EQUAL_STRING("line too long", err.msg);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_load_first_topology);
+    RUN_TEST(test_lines_spanning_chunks);
+    RUN_TEST(test_errors_report_the_line);
+    RUN_TEST(test_line_too_long);
+
+    return UNITY_END();
+}
@@ -0,0 +1,156 @@
+#include "unity.h"
+#include "../src/graph/topologies.h"
+
+static graph_t *topo;
+
+// Number of links, i.e. half the number of interfaces
+static uint32_t count_links(graph_t *graph)
+{
+    return (graph->ifindex_next - 1) / 2;
+}
+
+// Checks every node has a degree within [min, max], with no self or
+// parallel links, and returns the sum of degrees
+static uint32_t check_degrees(graph_t *graph, uint32_t min, uint32_t max)
+{
+    glthread_t *lst = &graph->node_list;
+    interface_t *a, *b;
+    node_t *node;
+    uint32_t sum = 0;
+
+    ITERATE_GL_THREADS_BEGIN(lst, node_t, node) {
+        TEST_ASSERT_TRUE(node->intf_count >= min);
+        TEST_ASSERT_TRUE(node->intf_count <= max);
+        sum += node->intf_count;
+
+        ITERATE_NODE_INTERFACES_BEGIN(node, a) {
+            TEST_ASSERT_TRUE(get_nbr_node(a) != node);
+            for (b = a + 1; b < node->intf + node->intf_count; b++)
+                TEST_ASSERT_TRUE(get_nbr_node(a) != get_nbr_node(b));
+        } ITERATE_NODE_INTERFACES_ENDS;
+    } ITERATE_GL_THREADS_ENDS;
+
+    return sum;
+}
+
+void setUp(void)
+{
+    topo = NULL;
+}
+
+void tearDown(void)
+{
+    destroy_graph(topo);
+}
+
+void test_first_topo(void)
+{
+    topo = build_first_topo();
+    TEST_ASSERT_NOT_NULL(topo);
+    TEST_ASSERT_EQUAL_UINT32(3, topo->node_count);
+    TEST_ASSERT_EQUAL_UINT32(3, count_links(topo));
+    check_degrees(topo, 2, 2);
+}
+
+void test_line_and_ring(void)
+{
+    node_t *last;
+
+    topo = build_line_topo(1000);
+    TEST_ASSERT_NOT_NULL(topo);
+    TEST_ASSERT_EQUAL_UINT32(999, count_links(topo));
+    check_degrees(topo, 1, 2);
+    last = get_node_by_node_name(topo, "R999");
+    TEST_ASSERT_EQUAL_STRING("R998",
+                             get_nbr_node(get_node_intf_by_name(last, "eth0"))
+                                 ->node_name);
+    destroy_graph(topo);
+
+    topo = build_ring_topo(1000);
+    TEST_ASSERT_NOT_NULL(topo);
+    TEST_ASSERT_EQUAL_UINT32(1000, count_links(topo));
+    check_degrees(topo, 2, 2);
+
+    TEST_ASSERT_NULL(build_ring_topo(2));
+    TEST_ASSERT_NULL(build_line_topo(0));
+}
+
+void test_full_mesh_respects_interface_limit(void)
+{
+    topo = build_full_mesh_topo(MAX_INTF_PER_NODE + 1);
+    TEST_ASSERT_NOT_NULL(topo);
+    TEST_ASSERT_EQUAL_UINT32((MAX_INTF_PER_NODE + 1) * MAX_INTF_PER_NODE / 2,
+                             count_links(topo));
+    check_degrees(topo, MAX_INTF_PER_NODE, MAX_INTF_PER_NODE);
+
+    TEST_ASSERT_NULL(build_full_mesh_topo(MAX_INTF_PER_NODE + 2));
+}
+
+void test_grid(void)
+{
+    topo = build_grid_topo(30, 40);
+    TEST_ASSERT_NOT_NULL(topo);
+    TEST_ASSERT_EQUAL_UINT32(1200, topo->node_count);
+    TEST_ASSERT_EQUAL_UINT32(30 * 39 + 40 * 29, count_links(topo));
+    check_degrees(topo, 2, 4);
+
+    // R41 is in row 1, column 1: up, left, right and down
+    TEST_ASSERT_EQUAL_UINT32(4, get_node_by_node_name(topo, "R41")->intf_count);
+}
+
+void test_fat_tree(void)
+{
+    uint32_t k = 4;
+
+    topo = build_fat_tree_topo(k);
+    TEST_ASSERT_NOT_NULL(topo);
+    TEST_ASSERT_EQUAL_UINT32(5 * k * k / 4 + k * k * k / 4, topo->node_count);
+    TEST_ASSERT_EQUAL_UINT32(3 * k * k * k / 4, count_links(topo));
+    check_degrees(topo, 1, k);
+
+    TEST_ASSERT_EQUAL_UINT32(k, get_node_by_node_name(topo, "c3")->intf_count);
+    TEST_ASSERT_EQUAL_UINT32(k, get_node_by_node_name(topo, "a3.1")->intf_count);
+    TEST_ASSERT_EQUAL_UINT32(k, get_node_by_node_name(topo, "e0.0")->intf_count);
+    TEST_ASSERT_EQUAL_STRING("e2.1", get_nbr_node(
+        get_node_by_node_name(topo, "h2.1.0")->intf)->node_name);
+
+    TEST_ASSERT_NULL(build_fat_tree_topo(3));
+    TEST_ASSERT_NULL(build_fat_tree_topo(MAX_INTF_PER_NODE + 2));
+}
+
+void test_random_regular_is_simple_and_reproducible(void)
+{
+    graph_t *again;
+    uint32_t i;
+
+    topo = build_random_regular_topo(2000, 6, 42);
+    TEST_ASSERT_NOT_NULL(topo);
+    TEST_ASSERT_EQUAL_UINT32(6000, count_links(topo));
+    check_degrees(topo, 6, 6);
+
+    again = build_random_regular_topo(2000, 6, 42);
+    TEST_ASSERT_NOT_NULL(again);
+    for (i = 1; i < topo->ifindex_next; i++)
+        TEST_ASSERT_EQUAL_UINT32(
+            get_nbr_node(get_intf_by_ifindex(topo, i))->node_id,
+            get_nbr_node(get_intf_by_ifindex(again, i))->node_id);
+    destroy_graph(again);
+
+    TEST_ASSERT_NULL(build_random_regular_topo(5, 3, 1));      // odd n * d
+    TEST_ASSERT_NULL(build_random_regular_topo(4, 4, 1));      // d >= n
+    TEST_ASSERT_NULL(build_random_regular_topo(100, MAX_INTF_PER_NODE + 1, 1));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_first_topo);
+    RUN_TEST(test_line_and_ring);
+    RUN_TEST(test_full_mesh_respects_interface_limit);
+    RUN_TEST(test_grid);
+    RUN_TEST(test_fat_tree);
+    RUN_TEST(test_random_regular_is_simple_and_reproducible);
+
+    return UNITY_END();
+}
@@ -0,0 +1,176 @@
+#include <errno.h>
+#include <string.h>
+#include "unity.h"
+#include "../src/vnet/vgraph.h"
+
+#define TEST_BLKS       1024
+
+static pkt_pool_t *pool;
+static vgraph_t *vg;
+static uint32_t seen[3];
+static uint32_t biggest[3];
+static uint32_t last_seq[3];
+static int in_order;
+
+void setUp(void)
+{
+    pool = pkt_pool_create(TEST_BLKS, 128, 32, 0);
+    vg = vgraph_create();
+    TEST_ASSERT_NOT_NULL(pool);
+    TEST_ASSERT_NOT_NULL(vg);
+    memset(seen, 0, sizeof(seen));
+    memset(biggest, 0, sizeof(biggest));
+    memset(last_seq, 0, sizeof(last_seq));
+    in_order = 1;
+}
+
+void tearDown(void)
+{
+    vgraph_destroy(vg);
+    TEST_ASSERT_EQUAL_UINT32(TEST_BLKS, pool->nfree_blks);
+    pkt_pool_destroy(pool);
+}
+
+// Records what node ctx saw; split and pass must see the sequence numbers
+// go up, the sink gets odd ones before even ones
+static void note(vgraph_node_t *node, pkt_buf_t **pkts, uint32_t n)
+{
+    uint32_t id = (uint32_t)(uintptr_t)node->ctx, i;
+
+    seen[id] += n;
+    if (n > biggest[id])
+        biggest[id] = n;
+    for (i = 0; i < n && id < 2; i++) {
+        if (pkts[i]->tstamp + 1 <= last_seq[id])
+            in_order = 0;
+        last_seq[id] = (uint32_t)pkts[i]->tstamp + 1;
+    }
+}
+
+// Sends even packets to next slot 0 and odd ones to slot 1
+static void split_fn(vgraph_t *g, vgraph_node_t *node, pkt_buf_t **pkts,
+                     uint32_t n)
+{
+    uint32_t i;
+
+    note(node, pkts, n);
+    for (i = 0; i < n; i++)
+        vgraph_enqueue(g, node, pkts[i]->tstamp & 1, pkts[i]);
+}
+
+// Forwards everything to next slot 0
+static void pass_fn(vgraph_t *g, vgraph_node_t *node, pkt_buf_t **pkts,
+                    uint32_t n)
+{
+    uint32_t i;
+
+    note(node, pkts, n);
+    for (i = 0; i < n; i++)
+        vgraph_enqueue(g, node, 0, pkts[i]);
+}
+
+static void sink_fn(vgraph_t *g, vgraph_node_t *node, pkt_buf_t **pkts,
+                    uint32_t n)
+{
+    uint32_t i;
+
+    (void)g;
+    note(node, pkts, n);
+    for (i = 0; i < n; i++)
+        pkt_buf_free(pkts[i]);
+}
+
+// Builds split -> pass -> sink with a shortcut split -> sink
+static void build(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, vgraph_add_node(vg, "split", split_fn,
+                                             (void *)0));
+    TEST_ASSERT_EQUAL_INT(1, vgraph_add_node(vg, "pass", pass_fn,
+                                             (void *)1));
+    TEST_ASSERT_EQUAL_INT(2, vgraph_add_node(vg, "sink", sink_fn,
+                                             (void *)2));
+    TEST_ASSERT_EQUAL_INT(0, vgraph_add_next(vg, 0, 1));
+    TEST_ASSERT_EQUAL_INT(1, vgraph_add_next(vg, 0, 2));
+    TEST_ASSERT_EQUAL_INT(0, vgraph_add_next(vg, 1, 2));
+}
+
+static void input(uint32_t first, uint32_t n)
+{
+    pkt_buf_t *pkts[1000];
+    uint32_t i;
+
+    for (i = 0; i < n; i++) {
+        pkts[i] = pkt_buf_alloc(pool);
+        TEST_ASSERT_NOT_NULL(pkts[i]);
+        pkts[i]->tstamp = first + i;
+    }
+    vgraph_input(vg, 0, pkts, n);
+}
+
+void test_edges_only_go_forward(void)
+{
+    build();
+    TEST_ASSERT_EQUAL_INT(-1, vgraph_add_next(vg, 2, 1));
+    TEST_ASSERT_EQUAL_INT(EINVAL, errno);
+    TEST_ASSERT_EQUAL_INT(-1, vgraph_add_next(vg, 1, 1));
+    TEST_ASSERT_EQUAL_INT(-1, vgraph_add_next(vg, 0, 3));
+    TEST_ASSERT_EQUAL_INT(2, vgraph_find_node(vg, "sink"));
+    TEST_ASSERT_EQUAL_INT(-1, vgraph_find_node(vg, "none"));
+}
+
+void test_vectors_run_in_graph_order(void)
+{
+    build();
+    input(0, 100);
+    TEST_ASSERT_EQUAL_UINT32(1, vg->pending);
+    vgraph_run(vg);
+    TEST_ASSERT_EQUAL_UINT32(0, vg->pending);
+
+    // One vector per node: the sink runs once, after both paths fed it
+    TEST_ASSERT_EQUAL_UINT64(1, vg->nodes[0].calls);
+    TEST_ASSERT_EQUAL_UINT64(1, vg->nodes[1].calls);
+    TEST_ASSERT_EQUAL_UINT64(1, vg->nodes[2].calls);
+    TEST_ASSERT_EQUAL_UINT32(100, seen[0]);
+    TEST_ASSERT_EQUAL_UINT32(50, seen[1]);
+    TEST_ASSERT_EQUAL_UINT32(100, seen[2]);
+    TEST_ASSERT_EQUAL_UINT64(100, vg->nodes[2].pkts);
+}
+
+void test_full_frames_are_dispatched_early(void)
+{
+    uint32_t i;
+
+    build();
+    input(0, 1000);
+    vgraph_run(vg);
+
+    for (i = 0; i < 3; i++)
+        TEST_ASSERT_TRUE(biggest[i] <= VGRAPH_FRAME_SIZE);
+    TEST_ASSERT_EQUAL_UINT32(1000, seen[0]);
+    TEST_ASSERT_EQUAL_UINT32(500, seen[1]);
+    TEST_ASSERT_EQUAL_UINT32(1000, seen[2]);
+    TEST_ASSERT_EQUAL_UINT64(4, vg->nodes[0].calls);
+    TEST_ASSERT_TRUE(in_order);
+    TEST_ASSERT_TRUE(vg->nodes[0].cycles > 0);
+}
+
+void test_destroy_frees_waiting_packets(void)
+{
+    build();
+    input(0, 300);
+    vgraph_dispatch(vg, &vg->nodes[0]);
+    TEST_ASSERT_EQUAL_UINT32(6, vg->pending);
+
+    vgraph_clear_stats(vg);
+    TEST_ASSERT_EQUAL_UINT64(0, vg->nodes[0].calls);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_edges_only_go_forward);
+    RUN_TEST(test_vectors_run_in_graph_order);
+    RUN_TEST(test_full_frames_are_dispatched_early);
+    RUN_TEST(test_destroy_frees_waiting_packets);
+    return UNITY_END();
+}
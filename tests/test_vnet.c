@@ -0,0 +1,266 @@
+#include <string.h>
+#include "unity.h"
+#include "../src/vnet/vnet.h"
+#include "../src/graph/topologies.h"
+
+#define TEST_BLKS       512
+#define TEST_HEADROOM   64
+#define IP(a, b, c, d)  ((uint32_t)(a) << 24 | (b) << 16 | (c) << 8 | (d))
+
+static const uint8_t mac0[6] = { 0x02, 0, 0, 0, 1, 0 };
+static const uint8_t mac1[6] = { 0x02, 0, 0, 0, 1, 1 };
+static const uint8_t peer0[6] = { 0x02, 0, 0, 0, 0, 1 };
+static const uint8_t peer2[6] = { 0x02, 0, 0, 0, 2, 0 };
+
+static graph_t *topo;
+static pkt_pool_t *pool;
+static vnet_t *vn;
+static interface_t *eth0, *eth1;
+
+void setUp(void)
+{
+    node_t *r1;
+
+    topo = build_line_topo(3);
+    pool = pkt_pool_create(TEST_BLKS, 256, TEST_HEADROOM, 0);
+    TEST_ASSERT_NOT_NULL(topo);
+    TEST_ASSERT_NOT_NULL(pool);
+    r1 = get_node_by_node_name(topo, "R1");
+    eth0 = get_node_intf_by_name(r1, "eth0");
+    eth1 = get_node_intf_by_name(r1, "eth1");
+
+    vn = vnet_create(r1, 0);
+    TEST_ASSERT_NOT_NULL(vn);
+    TEST_ASSERT_EQUAL_INT(0, vnet_intf_set(vn, eth0, mac0, IP(10, 0, 0, 1),
+                                           24));
+    TEST_ASSERT_EQUAL_INT(0, vnet_intf_set(vn, eth1, mac1, IP(10, 0, 1, 1),
+                                           24));
+    TEST_ASSERT_EQUAL_INT(0, vnet_route_add(vn, IP(10, 2, 0, 0), 16, eth1,
+                                            peer2));
+    TEST_ASSERT_EQUAL_INT(0, vnet_route_add(vn, IP(10, 0, 0, 0), 8, eth0,
+                                            peer0));
+}
+
+void tearDown(void)
+{
+    vnet_destroy(vn);
+    TEST_ASSERT_EQUAL_UINT32(TEST_BLKS, pool->nfree_blks);
+    pkt_pool_destroy(pool);
+    destroy_graph(topo);
+}
+
+static void put16(unsigned char *p, uint16_t v)
+{
+    p[0] = (unsigned char)(v >> 8);
+    p[1] = (unsigned char)v;
+}
+
+static void put32(unsigned char *p, uint32_t v)
+{
+    put16(p, (uint16_t)(v >> 16));
+    put16(p + 2, (uint16_t)v);
+}
+
+static uint16_t get16(const unsigned char *p)
+{
+    return (uint16_t)(p[0] << 8 | p[1]);
+}
+
+static uint16_t csum(const unsigned char *p, uint32_t len)
+{
+    uint32_t sum = 0, i;
+
+    for (i = 0; i < len; i += 2)
+        sum += get16(p + i);
+    while (sum >> 16)
+        sum = (sum & 0xffff) + (sum >> 16);
+    return (uint16_t)~sum;
+}
+
+// Builds a 64-byte IPv4 frame to dst, tagged with vlan unless it is 0
+static pkt_buf_t *make_ip4(const uint8_t *dmac, uint32_t dst, uint8_t ttl,
+                           uint16_t vlan)
+{
+    pkt_buf_t *pkt = pkt_buf_alloc(pool);
+    uint32_t l2 = vlan ? 18 : 14;
+    unsigned char *p, *ip;
+
+    TEST_ASSERT_NOT_NULL(pkt);
+    p = pkt_buf_put(pkt, 64);
+    memset(p, 0, 64);
+    memcpy(p, dmac, 6);
+    memcpy(p + 6, peer0, 6);
+    if (vlan) {
+        put16(p + 12, 0x8100);
+        put16(p + 14, vlan);
+    }
+    put16(p + l2 - 2, 0x0800);
+
+    ip = p + l2;
+    ip[0] = 0x45;
+    put16(ip + 2, 28);
+    ip[8] = ttl;
+    ip[9] = 17;
+    put32(ip + 12, IP(10, 0, 0, 2));
+    put32(ip + 16, dst);
+    put16(ip + 10, csum(ip, 20));
+    return pkt;
+}
+
+static pkt_buf_t *make_arp(uint32_t target)
+{
+    static const uint8_t bcast[6] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+    pkt_buf_t *pkt = pkt_buf_alloc(pool);
+    unsigned char *p, *arp;
+
+    TEST_ASSERT_NOT_NULL(pkt);
+    p = pkt_buf_put(pkt, 60);
+    memset(p, 0, 60);
+    memcpy(p, bcast, 6);
+    memcpy(p + 6, peer0, 6);
+    put16(p + 12, 0x0806);
+    arp = p + 14;
+    put16(arp, 1);
+    put16(arp + 2, 0x0800);
+    arp[4] = 6;
+    arp[5] = 4;
+    put16(arp + 6, 1);
+    memcpy(arp + 8, peer0, 6);
+    put32(arp + 14, IP(10, 0, 0, 2));
+    put32(arp + 24, target);
+    return pkt;
+}
+
+static uint64_t errors(vnet_node_id_t id)
+{
+    return vn->vg->nodes[id].errors;
+}
+
+void test_forwards_ip4_with_rewrite(void)
+{
+    vnet_intf_t *out = vnet_get_intf(vn, eth1);
+    pkt_buf_t *pkts[3], *pkt;
+    unsigned char *ip;
+    uint32_t i;
+
+    for (i = 0; i < 3; i++)
+        pkts[i] = make_ip4(mac0, IP(10, 2, 3, (uint8_t)i), 64, 0);
+    vnet_input(vn, eth0, pkts, 3);
+    TEST_ASSERT_EQUAL_UINT32(3, out->txq.count);
+
+    for (i = 0; i < 3; i++) {
+        pkt = pkt_queue_pop(&out->txq);
+        ip = pkt->data + 14;
+        TEST_ASSERT_EQUAL_MEMORY(peer2, pkt->data, 6);
+        TEST_ASSERT_EQUAL_MEMORY(mac1, pkt->data + 6, 6);
+        TEST_ASSERT_EQUAL_UINT8(63, ip[8]);
+        TEST_ASSERT_EQUAL_UINT16(0, csum(ip, 20));
+        TEST_ASSERT_EQUAL_UINT8(i, ip[19]);
+        // Padding up to 64 bytes was trimmed off
+        TEST_ASSERT_EQUAL_UINT32(14 + 28, pkt->pkt_len);
+        TEST_ASSERT_EQUAL_UINT32(eth1->ifindex, pkt->tx_ifindex);
+        pkt_buf_free(pkt);
+    }
+    TEST_ASSERT_EQUAL_UINT64(3, vn->vg->nodes[VNET_NODE_IP4_REWRITE].pkts);
+    TEST_ASSERT_EQUAL_UINT64(0, vn->vg->nodes[VNET_NODE_DROP].pkts);
+}
+
+void test_longest_prefix_wins(void)
+{
+    vnet_intf_t *in = vnet_get_intf(vn, eth0);
+    pkt_buf_t *pkts[2], *pkt;
+
+    pkts[0] = make_ip4(mac0, IP(10, 2, 0, 9), 64, 0);
+    pkts[1] = make_ip4(mac0, IP(10, 3, 0, 9), 64, 0);
+    vnet_input(vn, eth0, pkts, 2);
+    TEST_ASSERT_EQUAL_UINT32(1, vnet_get_intf(vn, eth1)->txq.count);
+    TEST_ASSERT_EQUAL_UINT32(1, in->txq.count);
+
+    pkt = pkt_queue_pop(&in->txq);
+    TEST_ASSERT_EQUAL_MEMORY(peer0, pkt->data, 6);
+    TEST_ASSERT_EQUAL_MEMORY(mac0, pkt->data + 6, 6);
+    pkt_buf_free(pkt);
+}
+
+void test_vlan_tag_is_stripped(void)
+{
+    vnet_intf_t *out = vnet_get_intf(vn, eth1);
+    pkt_buf_t *pkt = make_ip4(mac0, IP(10, 2, 0, 1), 64, 100);
+
+    vnet_input(vn, eth0, &pkt, 1);
+    TEST_ASSERT_EQUAL_UINT32(1, out->txq.count);
+    pkt = pkt_queue_pop(&out->txq);
+    TEST_ASSERT_EQUAL_UINT16(100, pkt->vlan);
+    TEST_ASSERT_EQUAL_UINT16(0x0800, get16(pkt->data + 12));
+    TEST_ASSERT_EQUAL_MEMORY(mac1, pkt->data + 6, 6);
+    TEST_ASSERT_EQUAL_UINT16(0, csum(pkt->data + 14, 20));
+    TEST_ASSERT_EQUAL_UINT32(TEST_HEADROOM + 4, pkt_buf_headroom(pkt));
+    pkt_buf_free(pkt);
+}
+
+void test_arp_request_is_answered(void)
+{
+    vnet_intf_t *in = vnet_get_intf(vn, eth0);
+    pkt_buf_t *pkts[2], *pkt;
+    unsigned char *arp;
+
+    pkts[0] = make_arp(IP(10, 0, 0, 1));
+    pkts[1] = make_arp(IP(10, 0, 0, 7));
+    vnet_input(vn, eth0, pkts, 2);
+    TEST_ASSERT_EQUAL_UINT32(1, in->txq.count);
+    TEST_ASSERT_EQUAL_UINT64(1, errors(VNET_NODE_ARP_INPUT));
+
+    pkt = pkt_queue_pop(&in->txq);
+    arp = pkt->data + 14;
+    TEST_ASSERT_EQUAL_MEMORY(peer0, pkt->data, 6);
+    TEST_ASSERT_EQUAL_MEMORY(mac0, pkt->data + 6, 6);
+    TEST_ASSERT_EQUAL_UINT16(2, get16(arp + 6));
+    TEST_ASSERT_EQUAL_MEMORY(mac0, arp + 8, 6);
+    TEST_ASSERT_EQUAL_MEMORY(peer0, arp + 18, 6);
+    TEST_ASSERT_EQUAL_UINT16(0x0a00, get16(arp + 14));
+    TEST_ASSERT_EQUAL_UINT16(0x0002, get16(arp + 26));
+    pkt_buf_free(pkt);
+}
+
+void test_bad_frames_are_dropped(void)
+{
+    static const uint8_t other[6] = { 0x02, 9, 9, 9, 9, 9 };
+    pkt_buf_t *pkts[6];
+
+    pkts[0] = make_ip4(other, IP(10, 2, 0, 1), 64, 0);
+    pkts[1] = make_ip4(mac0, IP(10, 2, 0, 1), 1, 0);
+    pkts[2] = make_ip4(mac0, IP(10, 2, 0, 1), 64, 0);
+    pkts[2]->data[14 + 10] ^= 1;
+    pkts[3] = make_ip4(mac0, IP(192, 168, 0, 1), 64, 0);
+    pkts[4] = make_ip4(mac0, IP(10, 0, 1, 1), 64, 0);
+    pkts[5] = make_ip4(mac0, IP(10, 2, 0, 1), 64, 0);
+    vnet_input(vn, eth1, pkts, 6);
+
+    // Frames to mac0 came in by eth1, whose address is mac1
+    TEST_ASSERT_EQUAL_UINT64(6, errors(VNET_NODE_ETH_INPUT));
+    TEST_ASSERT_EQUAL_UINT64(6, vn->vg->nodes[VNET_NODE_DROP].pkts);
+
+    pkts[0] = make_ip4(other, IP(10, 2, 0, 1), 64, 0);
+    pkts[1] = make_ip4(mac0, IP(10, 2, 0, 1), 1, 0);
+    pkts[2] = make_ip4(mac0, IP(10, 2, 0, 1), 64, 0);
+    pkts[2]->data[14 + 10] ^= 1;
+    pkts[3] = make_ip4(mac0, IP(192, 168, 0, 1), 64, 0);
+    pkts[4] = make_ip4(mac0, IP(10, 0, 1, 1), 64, 0);
+    pkts[5] = make_ip4(mac0, IP(10, 2, 0, 1), 64, 0);
+    vnet_input(vn, eth0, pkts, 6);
+    TEST_ASSERT_EQUAL_UINT64(7, errors(VNET_NODE_ETH_INPUT));
+    TEST_ASSERT_EQUAL_UINT64(2, errors(VNET_NODE_IP4_INPUT));
+    TEST_ASSERT_EQUAL_UINT64(2, errors(VNET_NODE_IP4_LOOKUP));
+    TEST_ASSERT_EQUAL_UINT32(1, vnet_get_intf(vn, eth1)->txq.count);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_forwards_ip4_with_rewrite);
+    RUN_TEST(test_longest_prefix_wins);
+    RUN_TEST(test_vlan_tag_is_stripped);
+    RUN_TEST(test_arp_request_is_answered);
+    RUN_TEST(test_bad_frames_are_dropped);
+    return UNITY_END();
+}
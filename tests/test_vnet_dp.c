@@ -0,0 +1,189 @@
+#include <string.h>
+#include "unity.h"
+#include "../src/vnet/vnet_dp.h"
+
+#define TEST_BLKS       1024
+#define TEST_FLOWS      64
+#define TEST_WORKERS    4
+#define TEST_ROUND      256
+
+static pkt_pool_t *pool;
+static vnet_dp_t *dp;
+static uint32_t flow_worker[TEST_FLOWS];
+static uint32_t flow_next[TEST_FLOWS];
+static uint32_t flow_seq[TEST_FLOWS];
+static uint32_t worker_pkts[TEST_WORKERS];
+static int in_order;
+
+void setUp(void)
+{
+    pool = pkt_pool_create(TEST_BLKS, 128, 32, PKT_POOL_MT);
+    TEST_ASSERT_NOT_NULL(pool);
+    dp = NULL;
+    memset(flow_worker, 0xff, sizeof(flow_worker));
+    memset(flow_next, 0, sizeof(flow_next));
+    memset(flow_seq, 0, sizeof(flow_seq));
+    memset(worker_pkts, 0, sizeof(worker_pkts));
+    in_order = 1;
+}
+
+void tearDown(void)
+{
+    vnet_dp_destroy(dp);
+    TEST_ASSERT_EQUAL_UINT32(TEST_BLKS, pool->nfree_blks);
+    pkt_pool_destroy(pool);
+}
+
+static void put16(unsigned char *p, uint16_t v)
+{
+    p[0] = (unsigned char)(v >> 8);
+    p[1] = (unsigned char)v;
+}
+
+// Builds a 64-byte UDP frame of flow, tagged with vlan unless it is 0
+static pkt_buf_t *make_udp(uint32_t flow, uint16_t vlan, uint16_t frag)
+{
+    pkt_buf_t *pkt = pkt_buf_alloc(pool);
+    unsigned char *p, *ip;
+
+    TEST_ASSERT_NOT_NULL(pkt);
+    p = pkt_buf_put(pkt, 64);
+    memset(p, 0, 64);
+    p[0] = 0x02;
+    p[6] = 0x02;
+    ip = p + 14;
+    if (vlan) {
+        put16(p + 12, 0x8100);
+        put16(p + 14, vlan);
+        ip += 4;
+    }
+    put16(ip - 2, 0x0800);
+    ip[0] = 0x45;
+    put16(ip + 6, frag);
+    ip[8] = 64;
+    ip[9] = 17;
+    ip[12] = 10;
+    ip[15] = 2;
+    ip[16] = 10;
+    ip[19] = 1;
+    put16(ip + 20, (uint16_t)(1024 + flow));
+    put16(ip + 22, 53);
+    return pkt;
+}
+
+static uint32_t hash_of(pkt_buf_t *pkt)
+{
+    uint32_t h = vnet_dp_flow_hash(pkt);
+
+    pkt_buf_free(pkt);
+    return h;
+}
+
+// Checks that each flow stays on one worker and its sequence numbers go up
+static void check_fn(void *arg, uint32_t worker, pkt_buf_t **pkts, uint32_t n)
+{
+    uint32_t i, flow;
+
+    (void)arg;
+    for (i = 0; i < n; i++) {
+        flow = (uint32_t)(pkts[i]->tstamp >> 32);
+        if (flow_worker[flow] == UINT32_MAX)
+            flow_worker[flow] = worker;
+        if (flow_worker[flow] != worker ||
+            (uint32_t)pkts[i]->tstamp != flow_next[flow])
+            in_order = 0;
+        flow_next[flow] = (uint32_t)pkts[i]->tstamp + 1;
+        worker_pkts[worker]++;
+        pkt_buf_free(pkts[i]);
+    }
+}
+
+void test_flow_hash(void)
+{
+    uint32_t h = hash_of(make_udp(1, 0, 0));
+
+    TEST_ASSERT_EQUAL_UINT32(h, hash_of(make_udp(1, 0, 0)));
+    TEST_ASSERT_EQUAL_UINT32(h, hash_of(make_udp(1, 100, 0)));
+    TEST_ASSERT_NOT_EQUAL(h, hash_of(make_udp(2, 0, 0)));
+
+    // Fragments leave the ports out, whatever is at their offset
+    TEST_ASSERT_EQUAL_UINT32(hash_of(make_udp(1, 0, 0x2000)),
+                             hash_of(make_udp(2, 0, 0x2000)));
+    TEST_ASSERT_EQUAL_UINT32(hash_of(make_udp(1, 0, 0x0010)),
+                             hash_of(make_udp(2, 0, 0x0010)));
+}
+
+void test_flow_hash_non_ip(void)
+{
+    pkt_buf_t *a = make_udp(1, 0, 0), *b = make_udp(1, 0, 0);
+
+    put16(a->data + 12, 0x0806);
+    put16(b->data + 12, 0x0806);
+    b->data[11] = 1;
+    TEST_ASSERT_NOT_EQUAL(hash_of(a), hash_of(b));
+}
+
+void test_flows_keep_order(void)
+{
+    pkt_buf_t *pkts[TEST_ROUND];
+    uint32_t round, i, flow, total = 0;
+
+    dp = vnet_dp_create(TEST_WORKERS, check_fn, NULL, 0);
+    TEST_ASSERT_NOT_NULL(dp);
+    TEST_ASSERT_EQUAL_UINT32(TEST_WORKERS, dp->nworkers);
+
+    for (round = 0; round < 40; round++) {
+        for (i = 0; i < TEST_ROUND; i++) {
+            flow = (i * 7 + round) % TEST_FLOWS;
+            pkts[i] = make_udp(flow, flow & 1 ? 100 : 0, 0);
+            pkts[i]->tstamp = (uint64_t)flow << 32 | flow_seq[flow]++;
+        }
+        vnet_dp_dispatch(dp, pkts, TEST_ROUND);
+        vnet_dp_flush(dp);
+        if (round & 1)
+            vnet_dp_wait(dp);
+    }
+    vnet_dp_wait(dp);
+
+    TEST_ASSERT_TRUE(in_order);
+    for (i = 0; i < TEST_WORKERS; i++) {
+        TEST_ASSERT_TRUE(worker_pkts[i] > 0);
+        TEST_ASSERT_EQUAL_UINT64(0, dp->workers[i].drops);
+        TEST_ASSERT_EQUAL_UINT64(dp->workers[i].queued,
+                                 dp->workers[i].done);
+        total += worker_pkts[i];
+    }
+    TEST_ASSERT_EQUAL_UINT32(40 * TEST_ROUND, total);
+}
+
+void test_full_inbox_drops(void)
+{
+    pkt_buf_t *pkts[100];
+    uint32_t i;
+
+    dp = vnet_dp_create(1, check_fn, NULL, 16);
+    TEST_ASSERT_NOT_NULL(dp);
+    for (i = 0; i < 100; i++) {
+        pkts[i] = make_udp(0, 0, 0);
+        pkts[i]->tstamp = i;
+    }
+    vnet_dp_dispatch(dp, pkts, 100);
+    vnet_dp_flush(dp);
+    vnet_dp_wait(dp);
+
+    // The oldest frames made it, in order
+    TEST_ASSERT_TRUE(in_order);
+    TEST_ASSERT_EQUAL_UINT32(16, worker_pkts[0]);
+    TEST_ASSERT_EQUAL_UINT32(16, flow_next[0]);
+    TEST_ASSERT_EQUAL_UINT64(84, dp->workers[0].drops);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_flow_hash);
+    RUN_TEST(test_flow_hash_non_ip);
+    RUN_TEST(test_flows_keep_order);
+    RUN_TEST(test_full_inbox_drops);
+    return UNITY_END();
+}
@@ -0,0 +1,213 @@
+/******************************************************************************
+ * @file:        unity_perf.c
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        19/10/2026 02:00 PM
+ * @license:     MIT
+ * @language:    C
+ * @platform:    x86_64
+ * @description: This file contains the Unity performance budget extension.
+ *               The median over several samples is used rather than the mean
+ *               so that a single preempted sample on a busy machine does not
+ *               fail the suite.
+ *
+ *               Functions in this file:
+ *                 - UnityPerfMeasure
+ *                 - UnityPerfAssert
+ *
+ * @note:        This code is part of the tcpip-stack project, a course on
+ *               network development.
+ *
+ * Revision 0.1: 19/10/2026 Marko Trickovic
+ * Initial version with median budgets and baseline comparison.
+ *****************************************************************************/
+
+#ifndef UNITY_PERF_C
+#define UNITY_PERF_C
+
+#include "unity_perf.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define UNITY_PERF_MAX_SAMPLES      101
+#define UNITY_PERF_MAX_NAME         128
+#define UNITY_PERF_MAX_BASELINES    256
+
+static char perf_message[256];
+
+static uint64_t UnityPerfNow(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int UnityPerfEnvSet(const char *name)
+{
+    const char *v = getenv(name);
+
+    return v && *v && strcmp(v, "0");
+}
+
+static int UnityPerfCompare(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief      Runs a measurement and returns the median cost.
+ *
+ * @param[in]  spec  Measurement to run.
+ *
+ * @return     Median nanoseconds per operation over all samples.
+ */
+double UnityPerfMeasure(const UnityPerfSpec *spec)
+{
+    double ns_op[UNITY_PERF_MAX_SAMPLES];
+    unsigned int samples = spec->samples ? spec->samples
+                                         : UNITY_PERF_DEFAULT_SAMPLES;
+    unsigned int i;
+    uint64_t t0;
+
+    if (samples > UNITY_PERF_MAX_SAMPLES)
+        samples = UNITY_PERF_MAX_SAMPLES;
+
+    // One untimed warm-up run to fault in memory and train predictors
+    if (spec->setup)
+        spec->setup(spec->ctx);
+    spec->body(spec->ctx);
+
+    for (i = 0; i < samples; i++) {
+        if (spec->setup)
+            spec->setup(spec->ctx);
+
+        t0 = UnityPerfNow();
+        spec->body(spec->ctx);
+        ns_op[i] = (double)(UnityPerfNow() - t0) / (double)spec->ops;
+    }
+
+    qsort(ns_op, samples, sizeof(ns_op[0]), UnityPerfCompare);
+    return ns_op[samples / 2];
+}
+
+/**
+ * @brief      Looks a measurement up in the baseline file.
+ *
+ * @param[in]  path  Baseline file.
+ * @param[in]  name  Measurement name.
+ * @param[out] value Stored median ns/op.
+ *
+ * @return     1 when found, 0 otherwise.
+ */
+static int UnityPerfBaselineLoad(const char *path, const char *name,
+                                 double *value)
+{
+    char key[UNITY_PERF_MAX_NAME];
+    double v;
+    FILE *fp = fopen(path, "r");
+    int found = 0;
+
+    if (!fp)
+        return 0;
+
+    while (fscanf(fp, "%127s %lf", key, &v) == 2) {
+        if (!strcmp(key, name)) {
+            *value = v;
+            found = 1;
+        }
+    }
+
+    fclose(fp);
+    return found;
+}
+
+/**
+ * @brief      Stores a measurement in the baseline file, replacing any
+ *             previous value for the same name.
+ *
+ * @param[in]  path  Baseline file.
+ * @param[in]  name  Measurement name.
+ * @param[in]  value Median ns/op to store.
+ */
+static void UnityPerfBaselineStore(const char *path, const char *name,
+                                   double value)
+{
+    static char keys[UNITY_PERF_MAX_BASELINES][UNITY_PERF_MAX_NAME];
+    static double values[UNITY_PERF_MAX_BASELINES];
+    unsigned int n = 0, i;
+    FILE *fp = fopen(path, "r");
+
+    if (fp) {
+        while (n < UNITY_PERF_MAX_BASELINES &&
+               fscanf(fp, "%127s %lf", keys[n], &values[n]) == 2) {
+            if (strcmp(keys[n], name))
+                n++;
+        }
+        fclose(fp);
+    }
+
+    if (n < UNITY_PERF_MAX_BASELINES) {
+        snprintf(keys[n], UNITY_PERF_MAX_NAME, "%s", name);
+        values[n++] = value;
+    }
+
+    fp = fopen(path, "w");
+    if (!fp)
+        return;
+
+    for (i = 0; i < n; i++)
+        fprintf(fp, "%s %.3f\n", keys[i], values[i]);
+    fclose(fp);
+}
+
+/**
+ * @brief      Runs a measurement and fails the current test when it is over
+ *             budget or regressed against the baseline.
+ *
+ * @param[in]  spec  Measurement to run.
+ * @param[in]  line  Source line reported on failure.
+ */
+void UnityPerfAssert(const UnityPerfSpec *spec, const UNITY_LINE_TYPE line)
+{
+    const char *baseline_path = getenv("UNITY_PERF_BASELINE");
+    double tolerance = spec->tolerance > 0.0 ? spec->tolerance
+                                             : UNITY_PERF_DEFAULT_TOLERANCE;
+    double median, baseline;
+
+    if (UnityPerfEnvSet("UNITY_PERF_DISABLE"))
+        UnityIgnore("performance tests disabled", line);
+
+    median = UnityPerfMeasure(spec);
+
+    if (spec->budget_ns > 0.0 && median > spec->budget_ns) {
+        snprintf(perf_message, sizeof(perf_message),
+                 "%s: median %.2f ns/op exceeds budget of %.2f ns/op",
+                 spec->name, median, spec->budget_ns);
+        UnityFail(perf_message, line);
+    }
+
+    if (baseline_path && *baseline_path) {
+        if (UnityPerfEnvSet("UNITY_PERF_RECORD")) {
+            UnityPerfBaselineStore(baseline_path, spec->name, median);
+        } else if (UnityPerfBaselineLoad(baseline_path, spec->name,
+                                         &baseline) &&
+                   median > baseline * (1.0 + tolerance)) {
+            snprintf(perf_message, sizeof(perf_message),
+                     "%s: median %.2f ns/op regressed more than %.0f%% from "
+                     "baseline %.2f ns/op", spec->name, median,
+                     tolerance * 100.0, baseline);
+            UnityFail(perf_message, line);
+        }
+    }
+
+    snprintf(perf_message, sizeof(perf_message), "%s: median %.2f ns/op",
+             spec->name, median);
+    UnityMessage(perf_message, line);
+}
+
+#endif    // UNITY_PERF_C
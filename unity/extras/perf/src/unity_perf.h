@@ -0,0 +1,109 @@
+/* -----------------------------------------------------------------------------
+ * @file:        unity_perf.h
+ * @author:      Marko Trickovic (contact@markotrickovic.com)
+ * @website:     www.markotrickovic.com
+ * @date:        19/10/2026 02:00 PM
+ * @license:     MIT
+ * @description: This header file declares a small Unity extension for
+ *               performance budget assertions. A test describes the operation
+ *               it wants to time, the extension runs it over a number of
+ *               samples and fails the test when the median cost per operation
+ *               is over budget or has regressed beyond a tolerance from a
+ *               stored baseline. The contents are organized into three groups:
+ *
+ *                 1. Structs:
+ *                    - struct UnityPerfSpec
+ *
+ *                 2. Functions:
+ *                    - UnityPerfMeasure
+ *                    - UnityPerfAssert
+ *
+ *                 3. Macros:
+ *                    - TEST_ASSERT_PERF
+ *
+ *               The behaviour can be steered through the environment:
+ *
+ *                 - UNITY_PERF_BASELINE=<file>  compare against, or record
+ *                                               into, a baseline file with one
+ *                                               "<name> <median ns/op>" line
+ *                                               per measurement
+ *                 - UNITY_PERF_RECORD=1         write the measured medians to
+ *                                               the baseline file instead of
+ *                                               comparing against it
+ *                 - UNITY_PERF_DISABLE=1        ignore every performance test,
+ *                                               e.g. under valgrind
+ *
+ * @note:        This code is part of the tcpip-stack project, which is a course
+ *               on network development.
+ *
+ * Revision History:
+ *
+ * Revision 0.1: 19/10/2026 Marko Trickovic
+ * Initial version with median budgets and baseline comparison.
+ */
+
+#ifndef UNITY_PERF_H
+#define UNITY_PERF_H
+
+#include <stdint.h>
+#include "unity.h"
+
+/** Samples taken per measurement unless the spec asks for more. */
+#define UNITY_PERF_DEFAULT_SAMPLES      15
+
+/** Allowed regression over the baseline unless the spec says otherwise. */
+#define UNITY_PERF_DEFAULT_TOLERANCE    0.5
+
+/**
+ * @brief      Description of one performance measurement.
+ *
+ * @struct                UnityPerfSpec
+ *
+ * @param[in]  name       Unique name, used as the key in the baseline file.
+ * @param[in]  setup      Untimed preparation run before every sample, or NULL.
+ * @param[in]  body       Timed code; performs ops operations per call.
+ * @param[in]  ctx        Opaque pointer passed to setup and body.
+ * @param[in]  ops        Operations performed by one call of body.
+ * @param[in]  samples    Number of timed samples, 0 for the default.
+ * @param[in]  budget_ns  Upper bound for the median ns/op, 0 for none.
+ * @param[in]  tolerance  Allowed relative regression over the baseline,
+ *                        0 for the default.
+ */
+typedef struct UnityPerfSpec_ {
+    const char *name;
+    void (*setup)(void *ctx);
+    void (*body)(void *ctx);
+    void *ctx;
+    uint64_t ops;
+    unsigned int samples;
+    double budget_ns;
+    double tolerance;
+} UnityPerfSpec;
+
+/**
+ * @brief      Runs a measurement and returns the median cost.
+ *
+ * @param[in]  spec  Measurement to run.
+ *
+ * @return     Median nanoseconds per operation over all samples.
+ */
+double UnityPerfMeasure(const UnityPerfSpec *spec);
+
+/**
+ * @brief      Runs a measurement and fails the current test when it is over
+ *             budget or regressed against the baseline.
+ *
+ * @param[in]  spec  Measurement to run.
+ * @param[in]  line  Source line reported on failure.
+ */
+void UnityPerfAssert(const UnityPerfSpec *spec, const UNITY_LINE_TYPE line);
+
+/**
+ * @brief      Asserts that the operation described by a UnityPerfSpec stays
+ *             within its budget and baseline.
+ *
+ * @param[in]  spec  Pointer to the measurement description.
+ */
+#define TEST_ASSERT_PERF(spec)  UnityPerfAssert((spec), __LINE__)
+
+#endif    // UNITY_PERF_H